@@ -91,6 +91,294 @@ CREATE FUNCTION pgstrom.pgstrom_device_preserved_meminfo()
 CREATE VIEW pgstrom.device_preserved_meminfo
   AS SELECT * FROM pgstrom.pgstrom_device_preserved_meminfo();
 
+CREATE TYPE pgstrom.__pgstrom_program_cache_info AS (
+  lookups        int8,
+  hits           int8,
+  hit_ratio      float8,
+  varlena_misses int8,
+  num_entries    int8,
+  num_pending    int8,
+  num_building   int8,
+  num_builds     int8,
+  avg_queue_time float8,
+  avg_build_time float8,
+  total_size     int8,
+  stats_reset    timestamp with time zone
+);
+CREATE FUNCTION pgstrom.pgstrom_program_cache_info()
+  RETURNS pgstrom.__pgstrom_program_cache_info
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C VOLATILE;
+CREATE VIEW pgstrom.program_cache_info
+  AS SELECT * FROM pgstrom.pgstrom_program_cache_info();
+
+CREATE TYPE pgstrom.__pgstrom_program_build_info AS (
+  program_id     int8,
+  state          text,
+  priority       text,
+  source_length  int8,
+  enqueue_time   timestamp with time zone,
+  build_start    timestamp with time zone,
+  queue_time     float8,
+  build_time     float8
+);
+CREATE FUNCTION pgstrom.pgstrom_program_build_info()
+  RETURNS SETOF pgstrom.__pgstrom_program_build_info
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C VOLATILE;
+CREATE VIEW pgstrom.program_build_info
+  AS SELECT * FROM pgstrom.pgstrom_program_build_info();
+
+CREATE FUNCTION pgstrom.program_cache_reset()
+  RETURNS void
+  AS 'MODULE_PATHNAME','pgstrom_program_cache_reset'
+  LANGUAGE C VOLATILE;
+REVOKE ALL ON FUNCTION pgstrom.program_cache_reset() FROM PUBLIC;
+
+CREATE FUNCTION pgstrom.program_cache_prewarm(text, regtype[] = '{}')
+  RETURNS int4
+  AS 'MODULE_PATHNAME','pgstrom_program_cache_prewarm'
+  LANGUAGE C STRICT VOLATILE;
+
+CREATE TYPE pgstrom.__pgstrom_stat_device AS (
+  device_nr       int4,
+  running_tasks   int8,
+  tasks           int8,
+  kernels         int8,
+  bytes_htod      int8,
+  bytes_dtoh      int8,
+  cpu_fallbacks   int8,
+  program_lookups int8,
+  program_hits    int8,
+  normal_usage    int8,
+  managed_usage   int8,
+  iomap_usage     int8,
+  total_memsz     int8,
+  stats_reset     timestamp with time zone
+);
+CREATE FUNCTION pgstrom.pgstrom_stat_device()
+  RETURNS SETOF pgstrom.__pgstrom_stat_device
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C VOLATILE;
+CREATE VIEW pgstrom.stat_device
+  AS SELECT * FROM pgstrom.pgstrom_stat_device();
+
+CREATE TYPE pgstrom.__pgstrom_stat_activity AS (
+  pid             int4,
+  usesysid        oid,
+  device_nr       int4,
+  gpu_start       timestamp with time zone,
+  running_tasks   int8,
+  tasks           int8,
+  kernels         int8,
+  bytes_htod      int8,
+  bytes_dtoh      int8,
+  cpu_fallbacks   int8,
+  program_lookups int8,
+  program_hits    int8
+);
+CREATE FUNCTION pgstrom.pgstrom_stat_activity()
+  RETURNS SETOF pgstrom.__pgstrom_stat_activity
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C VOLATILE;
+CREATE VIEW pgstrom.stat_activity
+  AS SELECT * FROM pgstrom.pgstrom_stat_activity();
+
+CREATE FUNCTION pgstrom.stat_reset()
+  RETURNS void
+  AS 'MODULE_PATHNAME','pgstrom_stat_reset'
+  LANGUAGE C VOLATILE;
+REVOKE ALL ON FUNCTION pgstrom.stat_reset() FROM PUBLIC;
+
+--
+-- Cost feedback and calibration of GPU cost parameters
+--
+CREATE TYPE pgstrom.__pgstrom_cost_feedback AS (
+  ts              timestamp with time zone,
+  datid           oid,
+  device_nr       int4,
+  node            text,
+  nloops          float8,
+  plan_rows       float8,
+  actual_rows     float8,
+  startup_cost    float8,
+  total_cost      float8,
+  actual_time     float8,
+  gpu_time        float8,
+  chunks          int8,
+  source_rows     int8,
+  kernels         int8,
+  bytes_htod      int8,
+  bytes_dtoh      int8
+);
+CREATE FUNCTION pgstrom.pgstrom_cost_feedback_info()
+  RETURNS SETOF pgstrom.__pgstrom_cost_feedback
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C VOLATILE;
+CREATE VIEW pgstrom.cost_feedback
+  AS SELECT * FROM pgstrom.pgstrom_cost_feedback_info();
+
+CREATE FUNCTION pgstrom.cost_feedback_reset()
+  RETURNS void
+  AS 'MODULE_PATHNAME','pgstrom_cost_feedback_reset'
+  LANGUAGE C VOLATILE;
+REVOKE ALL ON FUNCTION pgstrom.cost_feedback_reset() FROM PUBLIC;
+
+CREATE TYPE pgstrom.__pgstrom_cost_feedback_fit AS (
+  device_nr       int4,
+  nsamples        int8,
+  kernel_ms       float8,
+  dma_mbps        float8,
+  row_ns          float8,
+  chunk_ms        float8
+);
+CREATE FUNCTION pgstrom.cost_feedback_fit(timestamp with time zone = NULL)
+  RETURNS SETOF pgstrom.__pgstrom_cost_feedback_fit
+  AS 'MODULE_PATHNAME','pgstrom_cost_feedback_fit'
+  LANGUAGE C CALLED ON NULL INPUT VOLATILE;
+
+CREATE TABLE pgstrom.cost_calibration (
+  device_nr         int4 PRIMARY KEY,
+  nsamples          int8,
+  kernel_ms         float8,     -- per kernel launch
+  dma_mbps          float8,     -- throughput of DMA
+  row_ns            float8,     -- per source row
+  build_ms          float8,     -- average build time of GPU programs
+                                -- (just for reference)
+  cost_per_ms       float8,     -- planner's cost unit per millisecond
+  gpu_setup_cost    float8,
+  gpu_dma_cost      float8,
+  gpu_operator_cost float8,
+  calibrated_at     timestamp with time zone
+);
+SELECT pg_catalog.pg_extension_config_dump('pgstrom.cost_calibration', '');
+
+--
+-- cost_calibrate - runs the calibration benchmark
+--
+-- It scans the benchmark tables of narrow and wide rows in some sizes by
+-- GpuScan, then fits the per-device coefficients by the cost feedback.
+-- Ratio of the planner's cost and the execution time of the same scan by
+-- CPU converts the coefficients into the GPU cost parameters; the time per
+-- kernel launch into gpu_setup_cost. The build time of GPU programs is kept
+-- just for reference, because the program cache builds them only once.
+-- If apply is true, the average of the parameters over the devices is set
+-- on the current database, and the current session.
+--
+CREATE FUNCTION pgstrom.cost_calibrate(nrows bigint = 4000000,
+                                       apply bool = false)
+  RETURNS SETOF pgstrom.cost_calibration
+AS $$
+DECLARE
+    t_start     timestamptz := clock_timestamp();
+    plan        json;
+    cost_unit   float8;
+    build_time  float8;
+    nloaded     bigint := 0;
+    sz          bigint;
+    tbl         text;
+    r           record;
+BEGIN
+    IF nrows < 10000 THEN
+        RAISE EXCEPTION 'nrows must be 10000 or larger';
+    END IF;
+    IF NOT current_setting('pg_strom.cost_feedback')::bool THEN
+        RAISE EXCEPTION 'pg_strom.cost_feedback is disabled';
+    END IF;
+    PERFORM set_config('max_parallel_workers_per_gather', '0', true);
+    PERFORM set_config('pg_strom.enable_gpupreagg', 'off', true);
+
+    CREATE TEMP TABLE __pgstrom_calib_narrow (id int8, x float8);
+    CREATE TEMP TABLE __pgstrom_calib_wide (id int8, x float8, pad text);
+    FOREACH sz IN ARRAY ARRAY[nrows / 64, nrows / 8, nrows]
+    LOOP
+        INSERT INTO __pgstrom_calib_narrow
+            SELECT i, random() FROM generate_series(nloaded + 1, sz) i;
+        INSERT INTO __pgstrom_calib_wide
+            SELECT i, random(), repeat('x', 200)
+              FROM generate_series(nloaded / 4 + 1, sz / 4) i;
+        nloaded := sz;
+        ANALYZE __pgstrom_calib_narrow;
+        ANALYZE __pgstrom_calib_wide;
+
+        FOREACH tbl IN ARRAY ARRAY['__pgstrom_calib_narrow',
+                                   '__pgstrom_calib_wide']
+        LOOP
+            -- planner's cost per millisecond by CPU, on the largest one
+            IF sz = nrows AND tbl = '__pgstrom_calib_narrow' THEN
+                PERFORM set_config('pg_strom.enabled', 'off', true);
+                PERFORM set_config('enable_seqscan', 'on', true);
+                FOR i IN 1 .. 2 LOOP
+                    EXECUTE format('EXPLAIN (ANALYZE, FORMAT JSON) '
+                                   'SELECT count(*) FROM %I WHERE x < 0.5',
+                                   tbl) INTO plan;
+                END LOOP;
+                cost_unit := (plan->0->'Plan'->>'Total Cost')::float8 /
+                    nullif((plan->0->'Plan'->>'Actual Total Time')::float8, 0);
+            END IF;
+            -- GpuScan runs to be recorded on the cost feedback
+            PERFORM set_config('pg_strom.enabled', 'on', true);
+            PERFORM set_config('enable_seqscan', 'off', true);
+            FOR i IN 1 .. 2 LOOP
+                EXECUTE format('EXPLAIN (ANALYZE, FORMAT JSON) '
+                               'SELECT count(*) FROM %I WHERE x < 0.5',
+                               tbl) INTO plan;
+            END LOOP;
+        END LOOP;
+    END LOOP;
+    DROP TABLE __pgstrom_calib_narrow;
+    DROP TABLE __pgstrom_calib_wide;
+
+    IF cost_unit IS NULL THEN
+        RAISE EXCEPTION 'unable to measure the cost per millisecond';
+    END IF;
+    SELECT avg_build_time INTO build_time FROM pgstrom.program_cache_info;
+
+    FOR r IN SELECT * FROM pgstrom.cost_feedback_fit(t_start)
+    LOOP
+        INSERT INTO pgstrom.cost_calibration
+            VALUES (r.device_nr, r.nsamples,
+                    r.kernel_ms, r.dma_mbps, r.row_ns, build_time, cost_unit,
+                    r.kernel_ms * cost_unit,
+                    r.chunk_ms * cost_unit,
+                    r.row_ns / 1000000.0 * cost_unit,
+                    now())
+            ON CONFLICT (device_nr) DO UPDATE
+               SET nsamples          = EXCLUDED.nsamples,
+                   kernel_ms         = EXCLUDED.kernel_ms,
+                   dma_mbps          = EXCLUDED.dma_mbps,
+                   row_ns            = EXCLUDED.row_ns,
+                   build_ms          = EXCLUDED.build_ms,
+                   cost_per_ms       = EXCLUDED.cost_per_ms,
+                   gpu_setup_cost    = EXCLUDED.gpu_setup_cost,
+                   gpu_dma_cost      = EXCLUDED.gpu_dma_cost,
+                   gpu_operator_cost = EXCLUDED.gpu_operator_cost,
+                   calibrated_at     = EXCLUDED.calibrated_at;
+    END LOOP;
+    IF NOT FOUND THEN
+        RAISE EXCEPTION 'no GpuScan was recorded on the cost feedback';
+    END IF;
+
+    IF apply THEN
+        FOR r IN SELECT 'pg_strom.gpu_setup_cost' AS name,
+                        avg(gpu_setup_cost) AS value
+                   FROM pgstrom.cost_calibration
+                 UNION ALL
+                 SELECT 'pg_strom.gpu_dma_cost', avg(gpu_dma_cost)
+                   FROM pgstrom.cost_calibration
+                 UNION ALL
+                 SELECT 'pg_strom.gpu_operator_cost', avg(gpu_operator_cost)
+                   FROM pgstrom.cost_calibration
+        LOOP
+            EXECUTE format('ALTER DATABASE %I SET %s = %s',
+                           current_database(), r.name, r.value);
+            PERFORM set_config(r.name, r.value::text, false);
+        END LOOP;
+    END IF;
+    RETURN QUERY SELECT * FROM pgstrom.cost_calibration ORDER BY device_nr;
+END;
+$$ LANGUAGE plpgsql;
+
 --
 -- Functions/Languages to support PL/CUDA
 --
@@ -225,6 +513,16 @@ CREATE FUNCTION public.gstore_fdw_rawsize(reggstore)
   AS 'MODULE_PATHNAME','pgstrom_gstore_fdw_rawsize'
   LANGUAGE C STRICT;
 
+CREATE FUNCTION public.gstore_fdw_compaction(reggstore)
+  RETURNS bool
+  AS 'MODULE_PATHNAME','pgstrom_gstore_fdw_compaction'
+  LANGUAGE C STRICT VOLATILE;
+
+CREATE FUNCTION public.gstore_fdw_reload(reggstore)
+  RETURNS bool
+  AS 'MODULE_PATHNAME','pgstrom_gstore_fdw_reload'
+  LANGUAGE C STRICT VOLATILE;
+
 CREATE FUNCTION public.gstore_export_ipchandle(reggstore)
   RETURNS bytea
   AS 'MODULE_PATHNAME','pgstrom_gstore_export_ipchandle'
@@ -248,6 +546,22 @@ CREATE FUNCTION pgstrom.gstore_fdw_chunk_info()
 CREATE VIEW pgstrom.gstore_fdw_chunk_info AS
   SELECT * FROM pgstrom.gstore_fdw_chunk_info();
 
+CREATE TYPE pgstrom.__gstore_fdw_shard_info AS (
+  database_oid	oid,
+  table_oid		regclass,
+  revision		int,
+  shard_id		int,
+  device		int,
+  nitems		bigint,
+  rawsize		bigint
+);
+CREATE FUNCTION pgstrom.gstore_fdw_shard_info()
+  RETURNS SETOF pgstrom.__gstore_fdw_shard_info
+  AS 'MODULE_PATHNAME','pgstrom_gstore_fdw_shard_info'
+  LANGUAGE C VOLATILE;
+CREATE VIEW pgstrom.gstore_fdw_shard_info AS
+  SELECT * FROM pgstrom.gstore_fdw_shard_info();
+
 CREATE FUNCTION public.lo_import_gpu(int, bytea, bigint, bigint, oid=0)
   RETURNS oid
   AS 'MODULE_PATHNAME','pgstrom_lo_import_gpu'
@@ -258,6 +572,38 @@ CREATE FUNCTION public.lo_export_gpu(oid, int, bytea, bigint, bigint)
   AS 'MODULE_PATHNAME','pgstrom_lo_export_gpu'
   LANGUAGE C STRICT VOLATILE;
 
+--
+-- Regular expression compiled to DFA
+--
+CREATE TYPE pgstrom.__regex_dfa_bench AS (
+  nstates		int,
+  nclasses		int,
+  nmatched_dfa	bigint,
+  nmatched_pg	bigint,
+  dfa_ms		float8,
+  pg_ms			float8
+);
+CREATE FUNCTION pgstrom.regex_dfa_bench(text[], text, bool=false, int=1)
+  RETURNS pgstrom.__regex_dfa_bench
+  AS 'MODULE_PATHNAME','pgstrom_regex_dfa_bench'
+  LANGUAGE C STRICT VOLATILE;
+
+--
+-- jsonb device library check
+--
+CREATE FUNCTION pgstrom.jsonb_devlib_check(jsonb, text[])
+  RETURNS text
+  AS 'MODULE_PATHNAME','pgstrom_jsonb_devlib_check'
+  LANGUAGE C STRICT IMMUTABLE;
+
+--
+-- numeric device library check
+--
+CREATE FUNCTION pgstrom.numeric_devlib_check(text, numeric, numeric)
+  RETURNS numeric
+  AS 'MODULE_PATHNAME','pgstrom_numeric_devlib_check'
+  LANGUAGE C STRICT IMMUTABLE;
+
 --
 -- Type re-interpretation routines
 --
@@ -350,6 +696,21 @@ CREATE FUNCTION pgstrom.favg_numeric_final(float8[])
   AS 'MODULE_PATHNAME', 'pgstrom_final_avg_numeric_final'
   LANGUAGE C STRICT PARALLEL SAFE;
 
+CREATE FUNCTION pgstrom.pavg(int8,numeric)
+  RETURNS numeric[]
+  AS 'MODULE_PATHNAME','pgstrom_partial_avg_numeric'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.favg_accum(numeric[], numeric[])
+  RETURNS numeric[]
+  AS 'MODULE_PATHNAME', 'pgstrom_final_avg_exact_numeric_accum'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.favg_final(numeric[])
+  RETURNS numeric
+  AS 'MODULE_PATHNAME', 'pgstrom_final_avg_exact_numeric_final'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
 CREATE AGGREGATE pgstrom.favg(int8[])
 (
   sfunc = pgstrom.favg_accum,
@@ -374,6 +735,14 @@ CREATE AGGREGATE pgstrom.favg_numeric(float8[])
   parallel = safe
 );
 
+CREATE AGGREGATE pgstrom.favg(numeric[])
+(
+  sfunc = pgstrom.favg_accum,
+  stype = numeric[],
+  finalfunc = pgstrom.favg_final,
+  parallel = safe
+);
+
 -- PMIN()/PMAX()
 CREATE FUNCTION pgstrom.pmin(int4)
   RETURNS int4
@@ -809,38 +1178,38 @@ CREATE AGGREGATE pgstrom.regr_syy(float8[])
 CREATE FUNCTION pgstrom.array_matrix_accum(internal, variadic bool[])
   RETURNS internal
   AS 'MODULE_PATHNAME','array_matrix_accum'
-  LANGUAGE C CALLED ON NULL INPUT;
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
 
 CREATE FUNCTION pgstrom.array_matrix_accum(internal, variadic int2[])
   RETURNS internal
   AS 'MODULE_PATHNAME','array_matrix_accum'
-  LANGUAGE C CALLED ON NULL INPUT;
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
 
 CREATE FUNCTION pgstrom.array_matrix_accum(internal, variadic int4[])
   RETURNS internal
   AS 'MODULE_PATHNAME','array_matrix_accum'
-  LANGUAGE C CALLED ON NULL INPUT;
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
 
 CREATE FUNCTION pgstrom.array_matrix_accum(internal, variadic int8[])
   RETURNS internal
   AS 'MODULE_PATHNAME','array_matrix_accum'
-  LANGUAGE C CALLED ON NULL INPUT;
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
 
 CREATE FUNCTION pgstrom.array_matrix_accum(internal, variadic real[])
   RETURNS internal
   AS 'MODULE_PATHNAME','array_matrix_accum'
-  LANGUAGE C CALLED ON NULL INPUT;
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
 
 CREATE FUNCTION pgstrom.array_matrix_accum(internal, variadic float[])
   RETURNS internal
   AS 'MODULE_PATHNAME','array_matrix_accum'
-  LANGUAGE C CALLED ON NULL INPUT;
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
 
 -- varbit as matrix of int4[]
 CREATE FUNCTION pgstrom.array_matrix_accum_varbit(internal, bit)
   RETURNS internal
   AS 'MODULE_PATHNAME','array_matrix_accum_varbit'
-  LANGUAGE C CALLED ON NULL INPUT;
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
 
 -- type case varbit <--> int4[]
 CREATE FUNCTION pgstrom.varbit_to_int4_array(bit)
@@ -861,84 +1230,128 @@ CREATE CAST (int4[] AS bit)
   WITH FUNCTION pgstrom.int4_array_to_varbit(int4[])
   AS ASSIGNMENT;
 
+-- combine/serialize functions of array_matrix
+CREATE FUNCTION pgstrom.array_matrix_combine(internal, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME','array_matrix_combine'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.array_matrix_serialize(internal)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','array_matrix_serialize'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.array_matrix_deserialize(bytea, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME','array_matrix_deserialize'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
 -- final functions of array_matrix
 CREATE FUNCTION pgstrom.array_matrix_final_bool(internal)
   RETURNS bool[]
   AS 'MODULE_PATHNAME','array_matrix_final_bool'
-  LANGUAGE C CALLED ON NULL INPUT;
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
 
 CREATE FUNCTION pgstrom.array_matrix_final_int2(internal)
   RETURNS int2[]
   AS 'MODULE_PATHNAME','array_matrix_final_int2'
-  LANGUAGE C CALLED ON NULL INPUT;
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
 
 CREATE FUNCTION pgstrom.array_matrix_final_int4(internal)
   RETURNS int4[]
   AS 'MODULE_PATHNAME','array_matrix_final_int4'
-  LANGUAGE C CALLED ON NULL INPUT;
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
 
 CREATE FUNCTION pgstrom.array_matrix_final_int8(internal)
   RETURNS int8[]
   AS 'MODULE_PATHNAME','array_matrix_final_int8'
-  LANGUAGE C CALLED ON NULL INPUT;
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
 
 CREATE FUNCTION pgstrom.array_matrix_final_float4(internal)
   RETURNS float4[]
   AS 'MODULE_PATHNAME','array_matrix_final_float4'
-  LANGUAGE C CALLED ON NULL INPUT;
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
 
 CREATE FUNCTION pgstrom.array_matrix_final_float8(internal)
   RETURNS float8[]
   AS 'MODULE_PATHNAME','array_matrix_final_float8'
-  LANGUAGE C CALLED ON NULL INPUT;
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
 
 CREATE AGGREGATE pg_catalog.array_matrix(variadic bool[])
 (
   sfunc = pgstrom.array_matrix_accum,
   stype = internal,
-  finalfunc = pgstrom.array_matrix_final_bool
+  finalfunc = pgstrom.array_matrix_final_bool,
+  combinefunc = pgstrom.array_matrix_combine,
+  serialfunc = pgstrom.array_matrix_serialize,
+  deserialfunc = pgstrom.array_matrix_deserialize,
+  parallel = safe
 );
 
 CREATE AGGREGATE pg_catalog.array_matrix(variadic int2[])
 (
   sfunc = pgstrom.array_matrix_accum,
   stype = internal,
-  finalfunc = pgstrom.array_matrix_final_int2
+  finalfunc = pgstrom.array_matrix_final_int2,
+  combinefunc = pgstrom.array_matrix_combine,
+  serialfunc = pgstrom.array_matrix_serialize,
+  deserialfunc = pgstrom.array_matrix_deserialize,
+  parallel = safe
 );
 
 CREATE AGGREGATE pg_catalog.array_matrix(variadic int4[])
 (
   sfunc = pgstrom.array_matrix_accum,
   stype = internal,
-  finalfunc = pgstrom.array_matrix_final_int4
+  finalfunc = pgstrom.array_matrix_final_int4,
+  combinefunc = pgstrom.array_matrix_combine,
+  serialfunc = pgstrom.array_matrix_serialize,
+  deserialfunc = pgstrom.array_matrix_deserialize,
+  parallel = safe
 );
 
 CREATE AGGREGATE pg_catalog.array_matrix(variadic int8[])
 (
   sfunc = pgstrom.array_matrix_accum,
   stype = internal,
-  finalfunc = pgstrom.array_matrix_final_int8
+  finalfunc = pgstrom.array_matrix_final_int8,
+  combinefunc = pgstrom.array_matrix_combine,
+  serialfunc = pgstrom.array_matrix_serialize,
+  deserialfunc = pgstrom.array_matrix_deserialize,
+  parallel = safe
 );
 
 CREATE AGGREGATE pg_catalog.array_matrix(variadic float4[])
 (
   sfunc = pgstrom.array_matrix_accum,
   stype = internal,
-  finalfunc = pgstrom.array_matrix_final_float4
+  finalfunc = pgstrom.array_matrix_final_float4,
+  combinefunc = pgstrom.array_matrix_combine,
+  serialfunc = pgstrom.array_matrix_serialize,
+  deserialfunc = pgstrom.array_matrix_deserialize,
+  parallel = safe
 );
 
 CREATE AGGREGATE pg_catalog.array_matrix(variadic float8[])
 (
   sfunc = pgstrom.array_matrix_accum,
   stype = internal,
-  finalfunc = pgstrom.array_matrix_final_float8
+  finalfunc = pgstrom.array_matrix_final_float8,
+  combinefunc = pgstrom.array_matrix_combine,
+  serialfunc = pgstrom.array_matrix_serialize,
+  deserialfunc = pgstrom.array_matrix_deserialize,
+  parallel = safe
 );
 
 CREATE AGGREGATE pg_catalog.array_matrix(bit)
 (
   sfunc = pgstrom.array_matrix_accum_varbit,
   stype = internal,
-  finalfunc = pgstrom.array_matrix_final_int4
+  finalfunc = pgstrom.array_matrix_final_int4,
+  combinefunc = pgstrom.array_matrix_combine,
+  serialfunc = pgstrom.array_matrix_serialize,
+  deserialfunc = pgstrom.array_matrix_deserialize,
+  parallel = safe
 );
 
 CREATE FUNCTION pg_catalog.array_matrix_validation(anyarray)
@@ -2250,6 +2663,34 @@ CREATE AGGREGATE pg_catalog.stddev(float2) (
   initcond = "{0,0,0}"
 );
 
+--
+-- float2 array support
+--
+CREATE FUNCTION pgstrom.float4(float2[])
+  RETURNS float4[]
+  AS 'MODULE_PATHNAME','pgstrom_float2_array_to_float4_array'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION pgstrom.float2(float4[])
+  RETURNS float2[]
+  AS 'MODULE_PATHNAME','pgstrom_float4_array_to_float2_array'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE CAST (float2[] AS float4[])
+  WITH FUNCTION pgstrom.float4(float2[])
+  AS IMPLICIT;
+CREATE CAST (float4[] AS float2[])
+  WITH FUNCTION pgstrom.float2(float4[])
+  AS IMPLICIT;
+
+CREATE FUNCTION pg_catalog.float2_dot_product(float2[], float2[])
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_float2_array_dot_product'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION pg_catalog.float2_l2_distance(float2[], float2[])
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_float2_array_l2_distance'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
 --
 -- Index Support
 --
@@ -2374,3 +2815,12 @@ CREATE FUNCTION pgstrom.random_daterange(float=0.0,
   RETURNS daterange
   AS 'MODULE_PATHNAME','pgstrom_random_daterange'
   LANGUAGE C CALLED ON NULL INPUT;
+
+CREATE FUNCTION pgstrom.generate_table(text[],     -- column specs
+                                       bigint,     -- number of rows
+                                       bigint=0,   -- seed
+                                       int=0,      -- partition number
+                                       int=1)      -- number of partitions
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME','pgstrom_generate_table'
+  LANGUAGE C STRICT PARALLEL SAFE;
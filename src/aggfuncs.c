@@ -29,6 +29,9 @@ Datum pgstrom_final_avg_int8_final(PG_FUNCTION_ARGS);
 Datum pgstrom_final_avg_float8_accum(PG_FUNCTION_ARGS);
 Datum pgstrom_final_avg_float8_final(PG_FUNCTION_ARGS);
 Datum pgstrom_final_avg_numeric_final(PG_FUNCTION_ARGS);
+Datum pgstrom_partial_avg_numeric(PG_FUNCTION_ARGS);
+Datum pgstrom_final_avg_exact_numeric_accum(PG_FUNCTION_ARGS);
+Datum pgstrom_final_avg_exact_numeric_final(PG_FUNCTION_ARGS);
 Datum pgstrom_partial_min_any(PG_FUNCTION_ARGS);
 Datum pgstrom_partial_max_any(PG_FUNCTION_ARGS);
 Datum pgstrom_partial_sum_any(PG_FUNCTION_ARGS);
@@ -203,6 +206,83 @@ pgstrom_final_avg_numeric_final(PG_FUNCTION_ARGS)
 }
 PG_FUNCTION_INFO_V1(pgstrom_final_avg_numeric_final);
 
+/*
+ * AVG(numeric) with the exact partial sum; see make_altfunc_numeric_fixed_sum
+ */
+Datum
+pgstrom_partial_avg_numeric(PG_FUNCTION_ARGS)
+{
+	ArrayType  *result;
+	Datum		items[2];
+
+	items[0] = DirectFunctionCall1(int8_numeric,
+								   PG_GETARG_DATUM(0));	/* nrows(int8) */
+	items[1] = PG_GETARG_DATUM(1);	/* p_sum(numeric) */
+	result = construct_array(items, 2, NUMERICOID, -1, false, 'i');
+	PG_RETURN_ARRAYTYPE_P(result);
+}
+PG_FUNCTION_INFO_V1(pgstrom_partial_avg_numeric);
+
+Datum
+pgstrom_final_avg_exact_numeric_accum(PG_FUNCTION_ARGS)
+{
+	MemoryContext	aggcxt;
+	MemoryContext	oldcxt;
+	ArrayType	   *xarray;
+	ArrayType	   *yarray;
+	Datum			items[2];
+	bool			isnull;
+	int				i;
+
+	if (!AggCheckCallContext(fcinfo, &aggcxt))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+	if (PG_ARGISNULL(1))
+		elog(ERROR, "Null state was supplied");
+
+	if (PG_ARGISNULL(0))
+	{
+		oldcxt = MemoryContextSwitchTo(aggcxt);
+		xarray = PG_GETARG_ARRAYTYPE_P_COPY(1);
+		MemoryContextSwitchTo(oldcxt);
+	}
+	else
+	{
+		/* numeric is variable length, so a new state is constructed */
+		xarray = PG_GETARG_ARRAYTYPE_P(0);
+		yarray = PG_GETARG_ARRAYTYPE_P(1);
+		for (i=0; i < 2; i++)
+		{
+			items[i] = DirectFunctionCall2(numeric_add,
+									numeric_array_ref(xarray, i+1, &isnull),
+									numeric_array_ref(yarray, i+1, &isnull));
+		}
+		oldcxt = MemoryContextSwitchTo(aggcxt);
+		xarray = construct_array(items, 2, NUMERICOID, -1, false, 'i');
+		MemoryContextSwitchTo(oldcxt);
+	}
+	PG_RETURN_POINTER(xarray);
+}
+PG_FUNCTION_INFO_V1(pgstrom_final_avg_exact_numeric_accum);
+
+Datum
+pgstrom_final_avg_exact_numeric_final(PG_FUNCTION_ARGS)
+{
+	ArrayType	   *xarray = PG_GETARG_ARRAYTYPE_P(0);
+	Datum			nrows, sum;
+	bool			isnull;
+
+	nrows = numeric_array_ref(xarray, 1, &isnull);
+	sum   = numeric_array_ref(xarray, 2, &isnull);
+	/* same as numeric_avg, if no rows */
+	if (DatumGetBool(DirectFunctionCall2(numeric_eq, nrows,
+										 DirectFunctionCall1(int8_numeric,
+															 Int64GetDatum(0)))))
+		PG_RETURN_NULL();
+
+	return DirectFunctionCall2(numeric_div, sum, nrows);
+}
+PG_FUNCTION_INFO_V1(pgstrom_final_avg_exact_numeric_final);
+
 /*
  * pgstrom.pmin(anyelement)
  */
@@ -23,6 +23,20 @@ static bool		devtype_info_is_built;
 static List	   *devtype_info_slot[128];
 static List	   *devfunc_info_slot[1024];
 bool			pgstrom_enable_numeric_type;	/* GUC */
+static int		pgstrom_saop_hashed_threshold;	/* GUC */
+static bool		pgstrom_enable_codegen_cse;		/* GUC */
+
+/*
+ * codegen_cse_item - a common sub-expression hoisted to per-row variable
+ */
+typedef struct
+{
+	Node	   *expr;		/* the common sub-expression */
+	int			nrefs;		/* number of references */
+	bool		uncond;		/* referenced at unconditional position */
+	char	   *code;		/* code to calculate the expression */
+	int			width;		/* estimated varlena width, if any */
+} codegen_cse_item;
 
 static pg_crc32 generic_devtype_hashfunc(devtype_info *dtype,
 										 pg_crc32 hash,
@@ -192,6 +206,10 @@ static struct {
 				 NULL, NULL, NULL,
 				 DEVKERNEL_NEEDS_TEXTLIB, 0,
 				 generic_devtype_hashfunc),
+	DEVTYPE_DECL("jsonb",   "JSONBOID",   "varlena *",
+				 NULL, NULL, NULL,
+				 DEVKERNEL_NEEDS_JSONLIB | DEVKERNEL_NEEDS_TEXTLIB, 0,
+				 generic_devtype_hashfunc),
 	/*
 	 * range types
 	 */
@@ -470,6 +488,8 @@ pg_numeric_devtype_hashfunc(devtype_info *dtype,
 		if (dummy.e.errcode != StromError_Success)
 			elog(ERROR, "failed on hash calculation of device numeric: %s",
 				 DatumGetCString(DirectFunctionCall1(numeric_out, datum)));
+		/* see pg_numeric_comp_crc32 on the device side */
+		temp = pg_numeric_normalize(temp);
 		COMP_LEGACY_CRC32(hash, &temp.value, sizeof(temp.value));
 	}
 	return hash;
@@ -594,6 +614,39 @@ vlbuf_estimate_textcat(devfunc_info *dfunc, Expr **args, int *vl_width)
 	return maxlen;
 }
 
+/*
+ * vlbuf_estimate_jsonb
+ *
+ * A field or an element fetched from jsonb is never larger than the source
+ * document, except for the header to wrap up a scalar value, or digits of
+ * numeric expanded to cstring. Unlike textcat, the source document is
+ * usually a column without maximum length, so we use the average width
+ * by the table statistics. Device code falls back to CPU if the value is
+ * larger than the estimation.
+ */
+#define JSONB_DEFAULT_VARLENA_SZ	256
+static int
+vlbuf_estimate_jsonb(devfunc_info *dfunc, Expr **args, int *vl_width)
+{
+	Expr   *json = args[0];
+	int		maxlen;
+
+	if (IsA(json, Const))
+	{
+		Const  *con = (Const *) json;
+
+		if (con->constisnull)
+			return 0;
+		maxlen = VARSIZE_ANY_EXHDR(con->constvalue);
+	}
+	else if (vl_width[0] > 0)
+		maxlen = vl_width[0];
+	else
+		maxlen = JSONB_DEFAULT_VARLENA_SZ;
+
+	return maxlen + 2 * sizeof(JEntry);
+}
+
 /*
 static int
 vlbuf_estimate_text_substr(devfunc_info *dfunc, Expr **args, int *vl_width)
@@ -634,6 +687,7 @@ vlbuf_estimate_text_substr(devfunc_info *dfunc, Expr **args, int *vl_width)
  * 'y' : this function needs cuda_misc.h
  * 'r' : this function needs cuda_rangetype.h
  * 'E' : this function needs cuda_time_extract.h
+ * 'j' : this function needs cuda_jsonlib.h
  *
  * class character:
  * 'r' : right operator that takes an argument (deprecated)
@@ -1349,6 +1403,32 @@ static devfunc_catalog_t devfunc_common_catalog[] = {
 	  999, vlbuf_estimate_textcat, "s/f:textcat" },
 //	{ "substring",	3, {TEXTOID,INT4OID,INT4OID},
 //	  999, vlbuf_estimate_text_substr, "sc/f:text_substr" },
+
+	/*
+	 * jsonb functions
+	 */
+	{ "jsonb_object_field",  2, {JSONBOID, TEXTOID},
+	  200, vlbuf_estimate_jsonb, "j/f:jsonb_object_field" },
+	{ "jsonb_object_field_text", 2, {JSONBOID, TEXTOID},
+	  200, vlbuf_estimate_jsonb, "j/f:jsonb_object_field_text" },
+	{ "jsonb_array_element", 2, {JSONBOID, INT4OID},
+	  200, vlbuf_estimate_jsonb, "j/f:jsonb_array_element" },
+	{ "jsonb_array_element_text", 2, {JSONBOID, INT4OID},
+	  200, vlbuf_estimate_jsonb, "j/f:jsonb_array_element_text" },
+	{ "jsonb_extract_path", 2, {JSONBOID, TEXTARRAYOID},
+	  300, vlbuf_estimate_jsonb, "j/f:jsonb_extract_path" },
+	{ "jsonb_extract_path_text", 2, {JSONBOID, TEXTARRAYOID},
+	  300, vlbuf_estimate_jsonb, "j/f:jsonb_extract_path_text" },
+	{ "jsonb_exists",        2, {JSONBOID, TEXTOID},
+	  200, NULL, "j/f:jsonb_exists" },
+	/* cast of scalar jsonb (PG11 or later) */
+	{ "bool",    1, {JSONBOID}, 100, NULL, "j/f:jsonb_bool" },
+	{ "numeric", 1, {JSONBOID}, 100, NULL, "jn/f:jsonb_numeric" },
+	{ "int2",    1, {JSONBOID}, 100, NULL, "jn/f:jsonb_int2" },
+	{ "int4",    1, {JSONBOID}, 100, NULL, "jn/f:jsonb_int4" },
+	{ "int8",    1, {JSONBOID}, 100, NULL, "jn/f:jsonb_int8" },
+	{ "float4",  1, {JSONBOID}, 100, NULL, "jn/f:jsonb_float4" },
+	{ "float8",  1, {JSONBOID}, 100, NULL, "jn/f:jsonb_float8" },
 };
 
 /*
@@ -1832,6 +1912,9 @@ __construct_devfunc_info(devfunc_info *entry,
 				case 'E':
 					flags |= DEVKERNEL_NEEDS_TIME_EXTRACT;
 					break;
+				case 'j':
+					flags |= DEVKERNEL_NEEDS_JSONLIB;
+					break;
 				default:
 					elog(NOTICE,
 						 "Bug? unkwnon devfunc property: %c",
@@ -2313,6 +2396,238 @@ skip:
 		pgstrom_devtype_track(context, (devtype_info *) lfirst(lc));
 }
 
+/*
+ * Strategy to evaluate ScalarArrayOpExpr with a constant array
+ *
+ * If a scalar is compared with a large constant array by the equality
+ * operator (or its negator on ALL), it is more reasonable to build
+ * a hash-set on the kern_parambuf preliminary, than linear search on
+ * the array for each row. (utils/saop_bench shows the hash-set is
+ * competitive to the linear search at 32 elements, and faster than the
+ * binary search on the sorted array at any length.)
+ */
+#define SAOP_STRATEGY__LINEAR		0
+#define SAOP_STRATEGY__HASHED		1
+
+static int
+scalar_array_op_strategy(ScalarArrayOpExpr *opexpr, int *p_nitems)
+{
+	Node	   *sexpr = linitial(opexpr->args);
+	Const	   *acon = lsecond(opexpr->args);
+	Oid			elemtype;
+	Oid			eqopr;
+	ArrayType  *array;
+	int			nitems;
+
+	if (!IsA(acon, Const) || acon->constisnull)
+		return SAOP_STRATEGY__LINEAR;
+	/* only integer comparable types whose equality is bitwise */
+	elemtype = get_element_type(acon->consttype);
+	if (elemtype != exprType(sexpr))
+		return SAOP_STRATEGY__LINEAR;
+	switch (elemtype)
+	{
+		case INT2OID:
+		case INT4OID:
+		case INT8OID:
+		case DATEOID:
+		case TIMEOID:
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+			break;
+		default:
+			return SAOP_STRATEGY__LINEAR;
+	}
+	/* IN (...) or NOT IN (...) */
+	eqopr = lookup_type_cache(elemtype, TYPECACHE_EQ_OPR)->eq_opr;
+	if (!OidIsValid(eqopr) ||
+		eqopr != (opexpr->useOr ? opexpr->opno : get_negator(opexpr->opno)))
+		return SAOP_STRATEGY__LINEAR;
+
+	array = DatumGetArrayTypeP(acon->constvalue);
+	nitems = ArrayGetNItems(ARR_NDIM(array), ARR_DIMS(array));
+	if (p_nitems)
+		*p_nitems = nitems;
+	if (pgstrom_saop_hashed_threshold > 0 &&
+		nitems >= pgstrom_saop_hashed_threshold)
+		return SAOP_STRATEGY__HASHED;
+	return SAOP_STRATEGY__LINEAR;
+}
+
+static int
+scalar_array_op_compare(const void *__a, const void *__b)
+{
+	int64		a = *((const int64 *) __a);
+	int64		b = *((const int64 *) __b);
+
+	if (a < b)
+		return -1;
+	if (a > b)
+		return 1;
+	return 0;
+}
+
+/*
+ * build_scalar_array_op_const
+ *
+ * It builds a Const node of hash-set (in bytea) of the non-NULL distinct
+ * elements of the constant array. *p_has_nulls informs
+ * whether the original array contains NULL.
+ */
+static Const *
+build_scalar_array_op_const(ScalarArrayOpExpr *opexpr, int strategy,
+							bool *p_has_nulls)
+{
+	Const	   *acon = lsecond(opexpr->args);
+	ArrayType  *array = DatumGetArrayTypeP(acon->constvalue);
+	Oid			elemtype = ARR_ELEMTYPE(array);
+	int16		typlen;
+	bool		typbyval;
+	char		typalign;
+	Datum	   *elems;
+	bool	   *nulls;
+	int64	   *values;
+	int			i, j, nitems;
+	bool		has_nulls = false;
+
+	get_typlenbyvalalign(elemtype, &typlen, &typbyval, &typalign);
+	deconstruct_array(array, elemtype, typlen, typbyval, typalign,
+					  &elems, &nulls, &nitems);
+	values = palloc(sizeof(int64) * Max(nitems, 1));
+	for (i=0, j=0; i < nitems; i++)
+	{
+		if (nulls[i])
+			has_nulls = true;
+		else if (typlen == sizeof(int16))
+			values[j++] = DatumGetInt16(elems[i]);
+		else if (typlen == sizeof(int32))
+			values[j++] = DatumGetInt32(elems[i]);
+		else if (typlen == sizeof(int64))
+			values[j++] = DatumGetInt64(elems[i]);
+		else
+			elog(ERROR, "Bug? unexpected type length: %d", typlen);
+	}
+	/* sort and remove duplications */
+	qsort(values, j, sizeof(int64), scalar_array_op_compare);
+	for (i=1, nitems=(j > 0 ? 1 : 0); i < j; i++)
+	{
+		if (values[i] != values[nitems - 1])
+			values[nitems++] = values[i];
+	}
+	*p_has_nulls = has_nulls;
+
+	if (strategy == SAOP_STRATEGY__HASHED)
+	{
+		kern_array_hashset *hset;
+		cl_uint		nslots = 8;
+		cl_long		empty = PG_INT64_MIN;
+		size_t		length;
+
+		while (nslots < 2 * nitems)
+			nslots <<= 1;
+		/* smallest value not in the set is the mark of empty slot */
+		for (i=0; i < nitems && values[i] == empty; i++)
+			empty++;
+
+		length = offsetof(kern_array_hashset, slots[nslots]);
+		hset = palloc(length);
+		SET_VARSIZE(hset, length);
+		hset->nslots = nslots;
+		hset->nitems = nitems;
+		hset->empty = empty;
+		for (i=0; i < nslots; i++)
+			hset->slots[i] = empty;
+		for (i=0; i < nitems; i++)
+		{
+			cl_uint		k = array_hashset_hash(values[i]) & (nslots - 1);
+
+			while (hset->slots[k] != empty)
+				k = (k + 1) & (nslots - 1);
+			hset->slots[k] = values[i];
+		}
+		return makeConst(BYTEAOID, -1, InvalidOid, -1,
+						 PointerGetDatum(hset), false, false);
+	}
+	elog(ERROR, "Bug? unexpected ScalarArrayOpExpr strategy: %d", strategy);
+}
+
+/*
+ * build_regex_dfa_const
+ *
+ * It returns a Const of the DFA compiled from the regular expression, if
+ * expression is regular expression operators (~, !~, ~* and !~*) towards
+ * a constant pattern, and the pattern is supported by the DFA compiler.
+ */
+static Const *
+build_regex_dfa_const(Expr *expr, Expr **p_arg, bool *p_negate)
+{
+	Oid			func_oid;
+	Oid			collid;
+	List	   *args;
+	Expr	   *arg;
+	Const	   *pattern;
+	bool		icase;
+	bool		negate;
+	bytea	   *dfa;
+
+	if (IsA(expr, OpExpr))
+	{
+		func_oid = get_opcode(((OpExpr *) expr)->opno);
+		args = ((OpExpr *) expr)->args;
+		collid = ((OpExpr *) expr)->inputcollid;
+	}
+	else if (IsA(expr, FuncExpr))
+	{
+		func_oid = ((FuncExpr *) expr)->funcid;
+		args = ((FuncExpr *) expr)->args;
+		collid = ((FuncExpr *) expr)->inputcollid;
+	}
+	else
+		return NULL;
+
+	switch (func_oid)
+	{
+		case F_TEXTREGEXEQ:
+			icase = false;
+			negate = false;
+			break;
+		case F_TEXTREGEXNE:
+			icase = false;
+			negate = true;
+			break;
+		case F_TEXTICREGEXEQ:
+			icase = true;
+			negate = false;
+			break;
+		case F_TEXTICREGEXNE:
+			icase = true;
+			negate = true;
+			break;
+		default:
+			return NULL;
+	}
+	if (list_length(args) != 2)
+		return NULL;
+	arg = linitial(args);
+	pattern = lsecond(args);
+	if (exprType((Node *) arg) != TEXTOID ||
+		!IsA(pattern, Const) ||
+		pattern->consttype != TEXTOID ||
+		pattern->constisnull)
+		return NULL;
+
+	dfa = pgstrom_regex_dfa_compile(DatumGetTextPP(pattern->constvalue),
+									icase, collid);
+	if (!dfa)
+		return NULL;
+	if (p_arg)
+		*p_arg = arg;
+	if (p_negate)
+		*p_negate = negate;
+	return makeConst(BYTEAOID, -1, InvalidOid, -1,
+					 PointerGetDatum(dfa), false, false);
+}
+
 /*
  * codegen_expression_walker - main logic of run-time code generator
  */
@@ -2327,10 +2642,32 @@ codegen_expression_walker(codegen_context *context,
 	devfunc_info   *dfunc;
 	ListCell	   *cell;
 	int				varlena_sz = -1;
+	Const		   *dfa_con;
+	Expr		   *dfa_arg;
+	bool			dfa_negate;
 
 	if (node == NULL)
 		return;
 
+	/* common sub-expression is already calculated? */
+	if (context->cse_items != NIL)
+	{
+		cl_uint		index = 1;
+
+		foreach (cell, context->cse_items)
+		{
+			codegen_cse_item *item = lfirst(cell);
+
+			if (equal(node, item->expr))
+			{
+				appendStringInfo(&context->str, "KCSE_%u", index);
+				varlena_sz = item->width;
+				goto out;
+			}
+			index++;
+		}
+	}
+
 	if (IsA(node, Const))
 	{
 		Const  *con = (Const *) node;
@@ -2466,6 +2803,29 @@ codegen_expression_walker(codegen_context *context,
 		else
 			varlena_sz = 0;
 	}
+	else if ((IsA(node, FuncExpr) || IsA(node, OpExpr)) &&
+			 (dfa_con = build_regex_dfa_const((Expr *) node,
+											  &dfa_arg,
+											  &dfa_negate)) != NULL)
+	{
+		cl_uint		index;
+
+		/* regular expression by DFA on the kern_parambuf */
+		dtype = pgstrom_devtype_lookup_and_track(BOOLOID, context);
+		if (!pgstrom_devtype_lookup_and_track(TEXTOID, context) ||
+			!pgstrom_devtype_lookup_and_track(BYTEAOID, context))
+			elog(ERROR, "codegen: failed to lookup device type: text/bytea");
+		context->extra_flags |= DEVKERNEL_NEEDS_TEXTLIB;
+		appendStringInfo(&context->str, "pgfn_textregex_dfa(kcxt, ");
+		codegen_expression_walker(context, (Node *) dfa_arg, NULL);
+
+		context->used_params = lappend(context->used_params, dfa_con);
+		index = list_length(context->used_params) - 1;
+		context->param_refs = bms_add_member(context->param_refs, index);
+		appendStringInfo(&context->str, ", KPARAM_%u, %s)",
+						 index, dfa_negate ? "true" : "false");
+		varlena_sz = 0;
+	}
 	else if (IsA(node, FuncExpr))
 	{
 		FuncExpr   *func = (FuncExpr *) node;
@@ -2786,6 +3146,7 @@ codegen_expression_walker(codegen_context *context,
 		ScalarArrayOpExpr *opexpr = (ScalarArrayOpExpr *) node;
 		Oid		func_oid = get_opcode(opexpr->opno);
 		Node   *expr;
+		int		strategy;
 
 		dfunc = pgstrom_devfunc_lookup(func_oid,
 									   get_func_rettype(func_oid),
@@ -2798,19 +3159,48 @@ codegen_expression_walker(codegen_context *context,
 		Assert(dfunc->func_rettype->type_oid == BOOLOID &&
 			   list_length(dfunc->func_args) == 2);
 
-		appendStringInfo(&context->str, "PG_SCALAR_ARRAY_OP(kcxt, pgfn_%s, ",
-						 dfunc->func_devname);
-		expr = linitial(opexpr->args);
-		codegen_expression_walker(context, expr, NULL);
-		appendStringInfo(&context->str, ", ");
-		expr = lsecond(opexpr->args);
-		codegen_expression_walker(context, expr, NULL);
-		/* type of array element */
-		dtype = lsecond(dfunc->func_args);
-		appendStringInfo(&context->str, ", %s, %d, %d)",
-						 opexpr->useOr ? "true" : "false",
-						 dtype->type_length,
-						 dtype->type_align);
+		strategy = scalar_array_op_strategy(opexpr, NULL);
+		if (strategy != SAOP_STRATEGY__LINEAR)
+		{
+			Const  *con;
+			bool	has_nulls;
+			cl_uint	index;
+
+			/* hash-set on the kern_parambuf */
+			con = build_scalar_array_op_const(opexpr, strategy, &has_nulls);
+			if (!pgstrom_devtype_lookup_and_track(con->consttype, context))
+				elog(ERROR, "codegen: faied to lookup device type: %s",
+					 format_type_be(con->consttype));
+			appendStringInfo(&context->str, "PG_SCALAR_ARRAY_HASHED(kcxt, ");
+			expr = linitial(opexpr->args);
+			codegen_expression_walker(context, expr, NULL);
+
+			context->used_params = lappend(context->used_params, con);
+			index = list_length(context->used_params) - 1;
+			context->param_refs =
+				bms_add_member(context->param_refs, index);
+			appendStringInfo(&context->str, ", KPARAM_%u, %s, %s)",
+							 index,
+							 opexpr->useOr ? "true" : "false",
+							 has_nulls ? "true" : "false");
+		}
+		else
+		{
+			appendStringInfo(&context->str,
+							 "PG_SCALAR_ARRAY_OP(kcxt, pgfn_%s, ",
+							 dfunc->func_devname);
+			expr = linitial(opexpr->args);
+			codegen_expression_walker(context, expr, NULL);
+			appendStringInfo(&context->str, ", ");
+			expr = lsecond(opexpr->args);
+			codegen_expression_walker(context, expr, NULL);
+			/* type of array element */
+			dtype = lsecond(dfunc->func_args);
+			appendStringInfo(&context->str, ", %s, %d, %d)",
+							 opexpr->useOr ? "true" : "false",
+							 dtype->type_length,
+							 dtype->type_align);
+		}
 		varlena_sz = 0;
 	}
 	else
@@ -2863,8 +3253,9 @@ codegen_function_expression(codegen_context *context,
 	return varlena_sz;
 }
 
-char *
-pgstrom_codegen_expression(Node *expr, codegen_context *context)
+static char *
+__pgstrom_codegen_expression(Node *expr, codegen_context *context,
+							 int *p_width)
 {
 	codegen_context	walker_context;
 	int			width;
@@ -2883,6 +3274,7 @@ pgstrom_codegen_expression(Node *expr, codegen_context *context)
 	walker_context.pseudo_tlist = context->pseudo_tlist;
 	walker_context.extra_flags = context->extra_flags;
 	walker_context.varlena_bufsz = context->varlena_bufsz;
+	walker_context.cse_items = context->cse_items;
 
 	if (IsA(expr, List))
 	{
@@ -2925,9 +3317,229 @@ pgstrom_codegen_expression(Node *expr, codegen_context *context)
 
 		context->varlena_bufsz += MAXALIGN(dtype->extra_sz);
 	}
+	if (p_width)
+		*p_width = width;
 	return walker_context.str.data;
 }
 
+char *
+pgstrom_codegen_expression(Node *expr, codegen_context *context)
+{
+	return __pgstrom_codegen_expression(expr, context, NULL);
+}
+
+/*
+ * codegen_cse_collect
+ *
+ * It walks on the expression tree to count references of the sub-
+ * expressions. Arguments of AND/OR (except for the first one), CASE
+ * and COALESCE are evaluated only on demand, so sub-expressions there
+ * are marked as conditional. A sub-expression is hoisted only if it is
+ * evaluated unconditionally at least once, not to evaluate expressions
+ * which were never evaluated originally (e.g, division by zero guarded
+ * by CASE WHEN).
+ * Inner sub-expressions are appended prior to the outer one, so the
+ * resulting list is in the order of calculation.
+ */
+static void
+codegen_cse_collect(Node *node, List **p_items, bool conditional)
+{
+	codegen_cse_item *item;
+	ListCell   *lc;
+
+	if (!node)
+		return;
+	if (IsA(node, FuncExpr) ||
+		IsA(node, OpExpr) ||
+		IsA(node, DistinctExpr))
+	{
+		List	   *args;
+
+		foreach (lc, *p_items)
+		{
+			item = lfirst(lc);
+			if (equal(node, item->expr))
+			{
+				item->nrefs++;
+				if (!conditional)
+					item->uncond = true;
+				return;
+			}
+		}
+		if (IsA(node, FuncExpr))
+			args = ((FuncExpr *) node)->args;
+		else
+			args = ((OpExpr *) node)->args;
+		foreach (lc, args)
+			codegen_cse_collect(lfirst(lc), p_items, conditional);
+
+		item = palloc0(sizeof(codegen_cse_item));
+		item->expr = node;
+		item->nrefs = 1;
+		item->uncond = !conditional;
+		*p_items = lappend(*p_items, item);
+	}
+	else if (IsA(node, RelabelType))
+	{
+		codegen_cse_collect((Node *)((RelabelType *) node)->arg,
+							p_items, conditional);
+	}
+	else if (IsA(node, NullTest))
+	{
+		codegen_cse_collect((Node *)((NullTest *) node)->arg,
+							p_items, conditional);
+	}
+	else if (IsA(node, BooleanTest))
+	{
+		codegen_cse_collect((Node *)((BooleanTest *) node)->arg,
+							p_items, conditional);
+	}
+	else if (IsA(node, BoolExpr))
+	{
+		BoolExpr   *b = (BoolExpr *) node;
+
+		foreach (lc, b->args)
+			codegen_cse_collect(lfirst(lc), p_items,
+								conditional || lc != list_head(b->args));
+	}
+	else if (IsA(node, CoalesceExpr))
+	{
+		CoalesceExpr *coalesce = (CoalesceExpr *) node;
+
+		foreach (lc, coalesce->args)
+			codegen_cse_collect(lfirst(lc), p_items,
+								conditional || lc != list_head(coalesce->args));
+	}
+	else if (IsA(node, MinMaxExpr))
+	{
+		foreach (lc, ((MinMaxExpr *) node)->args)
+			codegen_cse_collect(lfirst(lc), p_items, conditional);
+	}
+	else if (IsA(node, CaseExpr))
+	{
+		CaseExpr   *caseexpr = (CaseExpr *) node;
+
+		codegen_cse_collect((Node *) caseexpr->arg, p_items, conditional);
+		foreach (lc, caseexpr->args)
+		{
+			CaseWhen   *casewhen = lfirst(lc);
+
+			if (!caseexpr->arg)
+				codegen_cse_collect((Node *) casewhen->expr, p_items,
+									conditional ||
+									lc != list_head(caseexpr->args));
+			else
+			{
+				/* CASE x WHEN ... shall not hoist CaseTestExpr */
+				OpExpr	   *op_expr = (OpExpr *) casewhen->expr;
+
+				if (IsA(op_expr, OpExpr) &&
+					list_length(op_expr->args) == 2)
+				{
+					if (!IsA(linitial(op_expr->args), CaseTestExpr))
+						codegen_cse_collect(linitial(op_expr->args),
+											p_items, true);
+					if (!IsA(lsecond(op_expr->args), CaseTestExpr))
+						codegen_cse_collect(lsecond(op_expr->args),
+											p_items, true);
+				}
+			}
+			codegen_cse_collect((Node *) casewhen->result, p_items, true);
+		}
+		codegen_cse_collect((Node *) caseexpr->defresult, p_items, true);
+	}
+	else if (IsA(node, ScalarArrayOpExpr))
+	{
+		ScalarArrayOpExpr *opexpr = (ScalarArrayOpExpr *) node;
+
+		codegen_cse_collect(linitial(opexpr->args), p_items, conditional);
+		codegen_cse_collect(lsecond(opexpr->args), p_items, true);
+	}
+	/* elsewhere, Var, Const, Param and so on are not a candidate */
+}
+
+/*
+ * pgstrom_codegen_cse_setup
+ *
+ * It picks up sub-expressions which appear multiple times in the supplied
+ * expressions (e.g, projection of a kernel function), then construct code
+ * to calculate them once per row. Expressions generated after this call
+ * reference the KCSE_%u variables instead, until the caller resets it by
+ * pgstrom_codegen_cse_reset().
+ */
+void
+pgstrom_codegen_cse_setup(codegen_context *context, List *exprs)
+{
+	List	   *candidates = NIL;
+	ListCell   *lc;
+
+	context->cse_items = NIL;
+	if (!pgstrom_enable_codegen_cse)
+		return;
+
+	foreach (lc, exprs)
+		codegen_cse_collect(lfirst(lc), &candidates, false);
+	foreach (lc, candidates)
+	{
+		codegen_cse_item *item = lfirst(lc);
+
+		if (item->nrefs < 2 || !item->uncond)
+			continue;
+		/* inner sub-expressions are already in the cse_items */
+		item->code = __pgstrom_codegen_expression(item->expr, context,
+												  &item->width);
+		context->cse_items = lappend(context->cse_items, item);
+	}
+	list_free(candidates);
+}
+
+/*
+ * pgstrom_codegen_cse_declarations
+ *
+ * It writes out declarations and calculations of the common sub-
+ * expressions. Caller has to put them after the load of KVAR_xx.
+ */
+void
+pgstrom_codegen_cse_declarations(StringInfo buf, codegen_context *context)
+{
+	ListCell	   *lc;
+	devtype_info   *dtype;
+	cl_uint			index;
+
+	if (context->cse_items == NIL)
+		return;
+
+	appendStringInfoString(buf, "\n  /* common sub-expressions */\n");
+	index = 1;
+	foreach (lc, context->cse_items)
+	{
+		codegen_cse_item *item = lfirst(lc);
+		Oid			type_oid = exprType(item->expr);
+
+		dtype = pgstrom_devtype_lookup(type_oid);
+		if (!dtype)
+			elog(ERROR, "failed to lookup device type: %s",
+				 format_type_be(type_oid));
+		appendStringInfo(buf, "  pg_%s_t KCSE_%u;\n",
+						 dtype->type_name, index);
+		index++;
+	}
+	index = 1;
+	foreach (lc, context->cse_items)
+	{
+		codegen_cse_item *item = lfirst(lc);
+
+		appendStringInfo(buf, "  KCSE_%u = %s;\n", index, item->code);
+		index++;
+	}
+}
+
+void
+pgstrom_codegen_cse_reset(codegen_context *context)
+{
+	context->cse_items = NIL;
+}
+
 /*
  * pgstrom_codegen_param_declarations
  */
@@ -2978,6 +3590,32 @@ pgstrom_codegen_param_declarations(StringInfo buf, codegen_context *context)
 	}
 }
 
+/*
+ * pgstrom_codegen_devfunc_needs
+ *
+ * It writes out DEVFUNC_NEEDS__xxx for each device function tracked in
+ * the codegen_context. Device libraries (cuda_timelib.h, cuda_numeric.h
+ * and cuda_textlib.h) build only the functions declared here and the ones
+ * they depend on, once PGSTROM_DEVFUNC_PRUNED is defined, because NVRTC
+ * compile time is proportional to the amount of the source code rather
+ * than the functions actually used.
+ * Caller has to put them on the kern_define, prior to the device libraries.
+ */
+void
+pgstrom_codegen_devfunc_needs(StringInfo buf, codegen_context *context)
+{
+	ListCell	   *lc;
+
+	appendStringInfoString(buf, "#define PGSTROM_DEVFUNC_PRUNED 1\n");
+	foreach (lc, context->func_defs)
+	{
+		devfunc_info   *dfunc = lfirst(lc);
+
+		appendStringInfo(buf, "#define DEVFUNC_NEEDS__%s\n",
+						 dfunc->func_devname);
+	}
+}
+
 /*
  * device_expression_walker
  */
@@ -2994,6 +3632,7 @@ device_expression_walker(device_expression_walker_context *con,
 						 Expr *expr, int *p_varlena_sz)
 {
 	int			varlena_sz = -1;	/* estimated length, if varlena */
+	Expr	   *dfa_arg;
 
 	if (!expr)
 	{
@@ -3069,6 +3708,16 @@ device_expression_walker(device_expression_walker_context *con,
 		else
 			varlena_sz = 0;
 	}
+	else if ((IsA(expr, FuncExpr) || IsA(expr, OpExpr)) &&
+			 build_regex_dfa_const(expr, &dfa_arg, NULL) != NULL)
+	{
+		/* regular expression is compiled to DFA, with constant pattern */
+		if (!device_expression_walker(con, dfa_arg, NULL))
+			return false;
+		/* same as LIKE operators */
+		con->devcost += 9999;
+		varlena_sz = 0;
+	}
 	else if (IsA(expr, FuncExpr))
 	{
 		FuncExpr   *func = (FuncExpr *) expr;
@@ -3302,6 +3951,7 @@ device_expression_walker(device_expression_walker_context *con,
 		devfunc_info   *dfunc;
 		devtype_info   *dtype;
 		Oid				func_oid = get_opcode(opexpr->opno);
+		int				nitems = 0;
 
 		dfunc = pgstrom_devfunc_lookup(func_oid,
 									   get_func_rettype(func_oid),
@@ -3330,8 +3980,17 @@ device_expression_walker(device_expression_walker_context *con,
 		 * cost for PG_SCALAR_ARRAY_OP - It repeats invocation of the operator
 		 * function for each array elements. Tentatively, we assume an array
 		 * has 32 elements in average.
+		 * Elsewhere, a constant array is looked up by the hash-set.
 		 */
-		con->devcost += 32 * dfunc->func_devcost;
+		switch (scalar_array_op_strategy(opexpr, &nitems))
+		{
+			case SAOP_STRATEGY__HASHED:
+				con->devcost += 2 * dfunc->func_devcost;
+				break;
+			default:
+				con->devcost += 32 * dfunc->func_devcost;
+				break;
+		}
 		varlena_sz = 0;
 		return true;
 	}
@@ -3459,4 +4118,24 @@ pgstrom_init_codegen(void)
 							 NULL,
 							 guc_assign_cache_invalidator,
 							 NULL);
+	/* pg_strom.scalar_array_op_hashed_threshold */
+	DefineCustomIntVariable("pg_strom.scalar_array_op_hashed_threshold",
+							"Min number of constant array elements to evaluate ScalarArrayOpExpr by hash-set",
+							NULL,
+							&pgstrom_saop_hashed_threshold,
+							32,
+							0,
+							INT_MAX,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+	/* pg_strom.enable_codegen_cse */
+	DefineCustomBoolVariable("pg_strom.enable_codegen_cse",
+							 "Enables to calculate common sub-expressions once per row",
+							 NULL,
+							 &pgstrom_enable_codegen_cse,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 }
@@ -387,8 +387,31 @@ typedef struct
 		(kcxt)->kparams = (__kparams);						\
 		assert((cl_ulong)(__kparams) == MAXALIGN(__kparams)); \
 		(kcxt)->vlpos = (kcxt)->vlbuf;						\
+		__DEBUG_FORCE_CPU_FALLBACK((kcxt),StromKernel_##kfunction); \
 	} while(0)
 
+/*
+ * pg_strom.debug_force_cpu_fallback makes the kernels which read the source
+ * rows return CpuReCheck error at the beginning, to run the CPU fallback
+ * code for all the rows. Reduction kernels of GpuPreAgg and GpuSort work
+ * as usual, because they read the results of the former kernels.
+ */
+#ifdef PGSTROM_DEBUG_FORCE_CPU_FALLBACK
+#define __DEBUG_FORCE_CPU_FALLBACK(kcxt,kernel)				\
+	do {													\
+		if ((kernel) == StromKernel_gpuscan_exec_quals_row ||	\
+			(kernel) == StromKernel_gpuscan_exec_quals_block ||	\
+			(kernel) == StromKernel_gpuscan_exec_quals_column ||\
+			(kernel) == StromKernel_gpujoin_main ||			\
+			(kernel) == StromKernel_gpupreagg_setup_row ||	\
+			(kernel) == StromKernel_gpupreagg_setup_block ||	\
+			(kernel) == StromKernel_gpupreagg_setup_column)	\
+			STROM_SET_ERROR(&(kcxt)->e, StromError_CpuReCheck); \
+	} while(0)
+#else
+#define __DEBUG_FORCE_CPU_FALLBACK(kcxt,kernel)		do {} while(0)
+#endif
+
 #define PTR_ON_VLBUF(kcxt,ptr,len)							\
 	((char *)(ptr) >= (kcxt)->vlbuf &&						\
 	 (char *)(ptr) + (len) <= (kcxt)->vlbuf + KERN_CONTEXT_VARLENA_BUFSZ)
@@ -990,6 +1013,39 @@ pointer_on_kparams(void *ptr, kern_parambuf *kparams)
 					   (char *)ptr <  (char *)kparams + kparams->length);
 }
 
+/*
+ * kern_array_hashset
+ *
+ * A hash-set of the distinct elements of a constant array, built by the
+ * code generator and delivered on the kern_parambuf as bytea, to evaluate
+ * ScalarArrayOpExpr with a large IN-list. Elements are sign-extended to
+ * 64bit, and open-addressing with linear probing is used.
+ */
+typedef struct
+{
+	cl_uint		vl_len_;		/* varlena header (only 4B) */
+	cl_uint		nslots;			/* number of slots; power of 2 */
+	cl_uint		nitems;			/* number of distinct elements */
+	cl_uint		__padding;
+	cl_long		empty;			/* mark of the empty slot */
+	cl_long		slots[FLEXIBLE_ARRAY_MEMBER];
+} kern_array_hashset;
+
+STATIC_INLINE(cl_uint)
+array_hashset_hash(cl_long value)
+{
+	cl_ulong	k = (cl_ulong) value;
+
+	/* finalizer of MurmurHash3 */
+	k ^= k >> 33;
+	k *= 0xff51afd7ed558ccdUL;
+	k ^= k >> 33;
+	k *= 0xc4ceb9fe1a85ec53UL;
+	k ^= k >> 33;
+
+	return (cl_uint) k;
+}
+
 /*
  * GstoreIpcHandle
  *
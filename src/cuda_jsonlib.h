@@ -0,0 +1,858 @@
+/*
+ * cuda_jsonlib.h
+ *
+ * Collection of jsonb functions and operators for CUDA GPU devices
+ * --
+ * Copyright 2011-2019 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2019 (C) The PG-Strom Development Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#ifndef CUDA_JSONLIB_H
+#define CUDA_JSONLIB_H
+
+#ifndef PG_STROM_H
+/* definitions at utils/jsonb.h */
+typedef cl_uint		JEntry;
+
+#define JENTRY_OFFLENMASK		0x0FFFFFFF
+#define JENTRY_TYPEMASK			0x70000000
+#define JENTRY_HAS_OFF			0x80000000
+
+#define JENTRY_ISSTRING			0x00000000
+#define JENTRY_ISNUMERIC		0x10000000
+#define JENTRY_ISBOOL_FALSE		0x20000000
+#define JENTRY_ISBOOL_TRUE		0x30000000
+#define JENTRY_ISNULL			0x40000000
+#define JENTRY_ISCONTAINER		0x50000000
+
+#define JBE_OFFLENFLD(je_)		((je_) & JENTRY_OFFLENMASK)
+#define JBE_HAS_OFF(je_)		(((je_) & JENTRY_HAS_OFF) != 0)
+
+#define JB_OFFSET_STRIDE		32
+
+#define JB_CMASK				0x0FFFFFFF
+#define JB_FSCALAR				0x10000000
+#define JB_FOBJECT				0x20000000
+#define JB_FARRAY				0x40000000
+#endif	/* PG_STROM_H */
+
+/*
+ * kern_jsonb_value - reference to a value in the jsonb container
+ *
+ * NOTE: jsonb datum on the device memory may have short (1-byte) varlena
+ * header, thus, JEntry and the container header are not always aligned.
+ * All the routines below fetch them by bytes.
+ */
+typedef struct
+{
+	cl_uint		type;		/* one of JENTRY_IS* */
+	const char *data;		/* head of the value (container or string) */
+	cl_uint		len;		/* length of the value */
+} kern_jsonb_value;
+
+STATIC_INLINE(cl_uint)
+__jsonb_fetch_uint32(const char *addr)
+{
+	cl_uint		value;
+
+	memcpy(&value, addr, sizeof(cl_uint));
+	return value;
+}
+
+/* memcmp() is not available on the device */
+STATIC_INLINE(cl_int)
+__jsonb_memcmp(const char *s1, const char *s2, cl_uint len)
+{
+	cl_uint		i;
+
+	for (i=0; i < len; i++)
+	{
+		cl_int	diff = (cl_int)((cl_uchar) s1[i]) - (cl_int)((cl_uchar) s2[i]);
+
+		if (diff != 0)
+			return diff;
+	}
+	return 0;
+}
+
+/* see getJsonbOffset() */
+STATIC_INLINE(cl_uint)
+__jsonb_get_offset(const char *children, cl_uint index)
+{
+	cl_uint		offset = 0;
+	cl_int		i;
+
+	for (i = (cl_int) index - 1; i >= 0; i--)
+	{
+		JEntry	entry = __jsonb_fetch_uint32(children + sizeof(JEntry) * i);
+
+		offset += JBE_OFFLENFLD(entry);
+		if (JBE_HAS_OFF(entry))
+			break;
+	}
+	return offset;
+}
+
+/* see getJsonbLength() */
+STATIC_INLINE(cl_uint)
+__jsonb_get_length(const char *children, cl_uint index)
+{
+	JEntry		entry = __jsonb_fetch_uint32(children + sizeof(JEntry) * index);
+
+	if (JBE_HAS_OFF(entry))
+		return JBE_OFFLENFLD(entry) - __jsonb_get_offset(children, index);
+	return JBE_OFFLENFLD(entry);
+}
+
+/*
+ * __jsonb_fetch_value - see fillJsonbValue()
+ */
+STATIC_FUNCTION(void)
+__jsonb_fetch_value(const char *jc, cl_uint index,
+					kern_jsonb_value *jval)
+{
+	cl_uint		header = __jsonb_fetch_uint32(jc);
+	cl_uint		nchildren = (header & JB_CMASK);
+	const char *children = jc + sizeof(cl_uint);
+	const char *base;
+	JEntry		entry;
+	cl_uint		offset;
+
+	if ((header & JB_FOBJECT) != 0)
+		nchildren *= 2;
+	base = children + sizeof(JEntry) * nchildren;
+	entry = __jsonb_fetch_uint32(children + sizeof(JEntry) * index);
+	offset = __jsonb_get_offset(children, index);
+
+	jval->type = (entry & JENTRY_TYPEMASK);
+	if (jval->type == JENTRY_ISNUMERIC ||
+		jval->type == JENTRY_ISCONTAINER)
+	{
+		/* remove alignment padding */
+		jval->data = base + INTALIGN(offset);
+		jval->len = __jsonb_get_length(children, index)
+			- (INTALIGN(offset) - offset);
+	}
+	else
+	{
+		jval->data = base + offset;
+		jval->len = __jsonb_get_length(children, index);
+	}
+}
+
+/*
+ * __jsonb_find_key - see findJsonbValueFromContainer() with JB_FOBJECT
+ */
+STATIC_FUNCTION(cl_bool)
+__jsonb_find_key(const char *jc, const char *key, cl_uint keylen,
+				 kern_jsonb_value *jval)
+{
+	cl_uint		header = __jsonb_fetch_uint32(jc);
+	cl_uint		count = (header & JB_CMASK);
+	const char *children = jc + sizeof(cl_uint);
+	const char *base = children + sizeof(JEntry) * 2 * count;
+	cl_uint		stopLow = 0;
+	cl_uint		stopHigh = count;
+
+	if ((header & JB_FOBJECT) == 0)
+		return false;
+	/* keys are sorted by the length, then binary comparison */
+	while (stopLow < stopHigh)
+	{
+		cl_uint		stopMiddle = stopLow + (stopHigh - stopLow) / 2;
+		cl_uint		len = __jsonb_get_length(children, stopMiddle);
+		cl_int		diff;
+
+		if (len == keylen)
+			diff = __jsonb_memcmp(base + __jsonb_get_offset(children,
+															stopMiddle),
+								  key, keylen);
+		else
+			diff = (len > keylen ? 1 : -1);
+
+		if (diff == 0)
+		{
+			__jsonb_fetch_value(jc, stopMiddle + count, jval);
+			return true;
+		}
+		else if (diff < 0)
+			stopLow = stopMiddle + 1;
+		else
+			stopHigh = stopMiddle;
+	}
+	return false;
+}
+
+/*
+ * __jsonb_find_index - see getIthJsonbValueFromContainer()
+ *
+ * Negative index counts from the tail of array.
+ */
+STATIC_FUNCTION(cl_bool)
+__jsonb_find_index(const char *jc, cl_long index,
+				   kern_jsonb_value *jval)
+{
+	cl_uint		header = __jsonb_fetch_uint32(jc);
+	cl_uint		nelements = (header & JB_CMASK);
+
+	if ((header & JB_FARRAY) == 0)
+		return false;
+	if (index < 0)
+	{
+		if (-index > nelements)
+			return false;
+		index += nelements;
+	}
+	if (index >= nelements)
+		return false;
+	__jsonb_fetch_value(jc, index, jval);
+	return true;
+}
+
+/*
+ * __jsonb_exists - see jsonb_exists()
+ *
+ * A key of the top-level object, or a string element of the top-level
+ * array (including raw scalar), matches.
+ */
+STATIC_FUNCTION(cl_bool)
+__jsonb_exists(const char *jc, const char *key, cl_uint keylen)
+{
+	kern_jsonb_value jval;
+	cl_uint		header = __jsonb_fetch_uint32(jc);
+	cl_uint		i, count = (header & JB_CMASK);
+
+	if ((header & JB_FOBJECT) != 0)
+		return __jsonb_find_key(jc, key, keylen, &jval);
+	for (i=0; i < count; i++)
+	{
+		__jsonb_fetch_value(jc, i, &jval);
+		if (jval.type == JENTRY_ISSTRING &&
+			jval.len == keylen &&
+			__jsonb_memcmp(jval.data, key, keylen) == 0)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * __jsonb_parse_index - see get_jsonb_path_all(); strtol() compatible
+ * parsing of the path element towards arrays
+ */
+STATIC_FUNCTION(cl_bool)
+__jsonb_parse_index(const char *str, cl_uint len, cl_long *p_index)
+{
+	const char *end = str + len;
+	cl_bool		negative = false;
+	cl_long		value = 0;
+
+	while (str < end && (*str == ' '  || *str == '\t' || *str == '\n' ||
+						 *str == '\r' || *str == '\v' || *str == '\f'))
+		str++;
+	if (str < end && (*str == '+' || *str == '-'))
+		negative = (*str++ == '-');
+	if (str >= end)
+		return false;
+	while (str < end)
+	{
+		if (*str < '0' || *str > '9')
+			return false;
+		value = 10 * value + (*str++ - '0');
+		if (value > (cl_long) INT_MAX + 1)
+			return false;
+	}
+	if (negative)
+		value = -value;
+	else if (value > INT_MAX)
+		return false;
+	*p_index = value;
+	return true;
+}
+
+/*
+ * __jsonb_numeric_to_cstring - see get_str_from_var()
+ *
+ * It returns length of the string, or -1 if buffer is too small.
+ */
+STATIC_FUNCTION(cl_int)
+__jsonb_numeric_to_cstring(const char *numeric, char *buf, cl_int bufsz)
+{
+	const char *pos = VARDATA_ANY(numeric);
+	cl_int		len = VARSIZE_ANY_EXHDR(numeric);
+	cl_ushort	header;
+	cl_short	weight;
+	cl_int		dscale;
+	cl_int		ndigits;
+	cl_bool		negative;
+	cl_int		d, i, j;
+	char	   *cp = buf;
+
+#define NUMERIC_DIGIT(index)						\
+	((cl_short)(((cl_uchar)pos[2 * (index)]) |		\
+				((cl_uchar)pos[2 * (index) + 1] << 8)))
+	header = ((cl_uchar) pos[0] | ((cl_uchar) pos[1] << 8));
+	if ((header & 0xC000) == 0xC000)
+	{
+		/* NaN */
+		if (bufsz < 3)
+			return -1;
+		memcpy(buf, "NaN", 3);
+		return 3;
+	}
+	else if ((header & 0x8000) != 0)
+	{
+		/* short format */
+		negative = ((header & 0x2000) != 0);
+		dscale = (header & 0x1F80) >> 7;
+		weight = ((header & 0x0040) ? ~0x003F : 0) | (header & 0x003F);
+		pos += sizeof(cl_ushort);
+		len -= sizeof(cl_ushort);
+	}
+	else
+	{
+		/* long format */
+		negative = ((header & 0xC000) == 0x4000);
+		dscale = (header & 0x3FFF);
+		weight = ((cl_uchar) pos[2] | ((cl_uchar) pos[3] << 8));
+		pos += 2 * sizeof(cl_ushort);
+		len -= 2 * sizeof(cl_ushort);
+	}
+	ndigits = len / sizeof(cl_short);
+
+	/* check buffer size */
+	if (bufsz < (1 + 4 * (weight < 0 ? 1 : weight + 1) +
+				 (dscale > 0 ? dscale + 4 : 0)))
+		return -1;
+
+	if (negative)
+		*cp++ = '-';
+	if (weight < 0)
+	{
+		d = weight + 1;
+		*cp++ = '0';
+	}
+	else
+	{
+		for (d=0; d <= weight; d++)
+		{
+			cl_int	dig = (d < ndigits ? NUMERIC_DIGIT(d) : 0);
+			cl_bool	putit = (d > 0);
+
+			for (j=1000; j > 0; j /= 10)
+			{
+				cl_int	d1 = dig / j;
+
+				dig -= d1 * j;
+				putit |= (d1 > 0);
+				if (putit)
+					*cp++ = d1 + '0';
+			}
+			if (!putit && d == 0)
+				*cp++ = '0';
+		}
+	}
+	if (dscale > 0)
+	{
+		char   *endcp;
+
+		*cp++ = '.';
+		endcp = cp + dscale;
+		for (i=0; i < dscale; d++, i += 4)
+		{
+			cl_int	dig = (d >= 0 && d < ndigits ? NUMERIC_DIGIT(d) : 0);
+
+			for (j=1000; j > 0; j /= 10)
+			{
+				cl_int	d1 = dig / j;
+
+				dig -= d1 * j;
+				*cp++ = d1 + '0';
+			}
+		}
+		cp = endcp;
+	}
+#undef NUMERIC_DIGIT
+	return (cl_int)(cp - buf);
+}
+
+/*
+ * __jsonb_scalar_to_cstring - text representation of the scalar value;
+ * same as ->> operator. It returns length of the string, or -1 if value
+ * is JSON null, container or buffer is too small.
+ */
+STATIC_FUNCTION(cl_int)
+__jsonb_scalar_to_cstring(kern_jsonb_value *jval, char *buf, cl_int bufsz)
+{
+	switch (jval->type)
+	{
+		case JENTRY_ISSTRING:
+			if (jval->len > bufsz)
+				return -1;
+			memcpy(buf, jval->data, jval->len);
+			return jval->len;
+		case JENTRY_ISNUMERIC:
+			return __jsonb_numeric_to_cstring(jval->data, buf, bufsz);
+		case JENTRY_ISBOOL_TRUE:
+			if (bufsz < 4)
+				return -1;
+			memcpy(buf, "true", 4);
+			return 4;
+		case JENTRY_ISBOOL_FALSE:
+			if (bufsz < 5)
+				return -1;
+			memcpy(buf, "false", 5);
+			return 5;
+		default:
+			return -1;
+	}
+}
+
+#ifdef __CUDACC__
+/*
+ * jsonb data type
+ */
+#ifndef PG_JSONB_TYPE_DEFINED
+#define PG_JSONB_TYPE_DEFINED
+STROMCL_VARLENA_TYPE_TEMPLATE(jsonb)
+#endif
+
+/*
+ * jsonb_form_value - builds a jsonb datum from the value in container.
+ * Scalar value is wrapped by the raw scalar pseudo array, as
+ * JsonbValueToJsonb() doing.
+ */
+STATIC_FUNCTION(pg_jsonb_t)
+jsonb_form_value(kern_context *kcxt, kern_jsonb_value *jval)
+{
+	pg_jsonb_t	result;
+	char	   *pos = (char *)INTALIGN(kcxt->vlpos);
+	cl_uint		length;
+
+	if (jval->type == JENTRY_ISCONTAINER)
+		length = VARHDRSZ + jval->len;
+	else
+		length = VARHDRSZ + sizeof(cl_uint) + sizeof(JEntry) + jval->len;
+	if (!PTR_ON_VLBUF(kcxt, pos, length))
+	{
+		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
+		result.isnull = true;
+		return result;
+	}
+	result.isnull = false;
+	result.value = (varlena *) pos;
+	SET_VARSIZE(pos, length);
+	pos += VARHDRSZ;
+	if (jval->type != JENTRY_ISCONTAINER)
+	{
+		*((cl_uint *) pos) = (1 | JB_FARRAY | JB_FSCALAR);
+		pos += sizeof(cl_uint);
+		*((JEntry *) pos) = (jval->type | JENTRY_HAS_OFF | jval->len);
+		pos += sizeof(JEntry);
+	}
+	memcpy(pos, jval->data, jval->len);
+	kcxt->vlpos = pos + jval->len;
+
+	return result;
+}
+
+/*
+ * jsonb_form_text - builds a text datum from the value in container.
+ */
+STATIC_FUNCTION(pg_text_t)
+jsonb_form_text(kern_context *kcxt, kern_jsonb_value *jval)
+{
+	pg_text_t	result;
+	char	   *pos = (char *)INTALIGN(kcxt->vlpos);
+	char	   *end = kcxt->vlbuf + KERN_CONTEXT_VARLENA_BUFSZ;
+	cl_int		len;
+
+	if (jval->type == JENTRY_ISNULL)
+	{
+		result.isnull = true;
+		return result;
+	}
+	else if (jval->type == JENTRY_ISCONTAINER || pos + VARHDRSZ > end)
+	{
+		/* serialization of the container is not supported */
+		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
+		result.isnull = true;
+		return result;
+	}
+	len = __jsonb_scalar_to_cstring(jval, pos + VARHDRSZ,
+									end - (pos + VARHDRSZ));
+	if (len < 0)
+	{
+		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
+		result.isnull = true;
+		return result;
+	}
+	result.isnull = false;
+	result.value = (varlena *) pos;
+	SET_VARSIZE(pos, VARHDRSZ + len);
+	kcxt->vlpos = pos + VARHDRSZ + len;
+
+	return result;
+}
+
+/*
+ * jsonb_root_container - returns the root container of the jsonb datum,
+ * or NULL if not available on the device.
+ */
+STATIC_INLINE(const char *)
+jsonb_root_container(kern_context *kcxt, varlena *datum)
+{
+	if (VARATT_IS_COMPRESSED(datum) || VARATT_IS_EXTERNAL(datum))
+	{
+		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
+		return NULL;
+	}
+	return VARDATA_ANY(datum);
+}
+
+STATIC_INLINE(cl_bool)
+jsonb_text_arg(kern_context *kcxt, varlena *datum,
+			   const char **p_key, cl_uint *p_keylen)
+{
+	if (VARATT_IS_COMPRESSED(datum) || VARATT_IS_EXTERNAL(datum))
+	{
+		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
+		return false;
+	}
+	*p_key = VARDATA_ANY(datum);
+	*p_keylen = VARSIZE_ANY_EXHDR(datum);
+	return true;
+}
+
+/*
+ * jsonb_lookup_field - common part of jsonb -> text and jsonb ->> text
+ */
+STATIC_INLINE(cl_bool)
+jsonb_lookup_field(kern_context *kcxt, pg_jsonb_t arg1, pg_text_t arg2,
+				   kern_jsonb_value *jval)
+{
+	const char *jc;
+	const char *key;
+	cl_uint		keylen;
+
+	if (arg1.isnull || arg2.isnull)
+		return false;
+	jc = jsonb_root_container(kcxt, arg1.value);
+	if (!jc || !jsonb_text_arg(kcxt, arg2.value, &key, &keylen))
+		return false;
+	return __jsonb_find_key(jc, key, keylen, jval);
+}
+
+/*
+ * jsonb_lookup_element - common part of jsonb -> int and jsonb ->> int
+ */
+STATIC_INLINE(cl_bool)
+jsonb_lookup_element(kern_context *kcxt, pg_jsonb_t arg1, pg_int4_t arg2,
+					 kern_jsonb_value *jval)
+{
+	const char *jc;
+
+	if (arg1.isnull || arg2.isnull)
+		return false;
+	jc = jsonb_root_container(kcxt, arg1.value);
+	if (!jc)
+		return false;
+	if ((__jsonb_fetch_uint32(jc) & JB_FSCALAR) != 0)
+	{
+		/* raw scalar is left to CPU */
+		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
+		return false;
+	}
+	return __jsonb_find_index(jc, arg2.value, jval);
+}
+
+/*
+ * jsonb_lookup_path - common part of jsonb #> text[] and jsonb #>> text[]
+ * (see get_jsonb_path_all)
+ */
+STATIC_FUNCTION(cl_bool)
+jsonb_lookup_path(kern_context *kcxt, pg_jsonb_t arg1, pg_array_t arg2,
+				  kern_jsonb_value *jval)
+{
+	const char *jc;
+	char	   *base;
+	cl_uint		offset = 0;
+	cl_uint		i, nitems;
+
+	if (arg1.isnull || arg2.isnull)
+		return false;
+	jc = jsonb_root_container(kcxt, arg1.value);
+	if (!jc)
+		return false;
+	if (VARATT_IS_COMPRESSED(arg2.value) || VARATT_IS_EXTERNAL(arg2.value))
+	{
+		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
+		return false;
+	}
+	/* path that contains NULL element always returns NULL */
+	if (ARR_HASNULL(arg2.value))
+	{
+		char   *bitmap = ARR_NULLBITMAP(arg2.value);
+
+		nitems = ArrayGetNItems(kcxt, ARR_NDIM(arg2.value),
+								ARR_DIMS(arg2.value));
+		for (i=0; i < nitems; i++)
+		{
+			if ((bitmap[i / BITS_PER_BYTE] & (1 << (i % BITS_PER_BYTE))) == 0)
+				return false;
+		}
+	}
+	nitems = ArrayGetNItems(kcxt, ARR_NDIM(arg2.value),
+							ARR_DIMS(arg2.value));
+	if (nitems == 0)
+	{
+		/* empty path; rare case, so left to CPU */
+		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
+		return false;
+	}
+	if ((__jsonb_fetch_uint32(jc) & JB_FSCALAR) != 0)
+		return false;
+
+	base = ARR_DATA_PTR(arg2.value);
+	for (i=0; i < nitems; i++)
+	{
+		varlena	   *elem = (varlena *)(base + offset);
+		const char *str = VARDATA_ANY(elem);
+		cl_uint		len = VARSIZE_ANY_EXHDR(elem);
+		cl_uint		header;
+		cl_long		index;
+
+		if (VARATT_IS_COMPRESSED(elem) || VARATT_IS_EXTERNAL(elem))
+		{
+			STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
+			return false;
+		}
+		offset = INTALIGN(offset + VARSIZE_ANY(elem));
+
+		if (i > 0)
+		{
+			/* scalar value has no more children */
+			if (jval->type != JENTRY_ISCONTAINER)
+				return false;
+			jc = jval->data;
+		}
+		header = __jsonb_fetch_uint32(jc);
+		if ((header & JB_FOBJECT) != 0)
+		{
+			if (!__jsonb_find_key(jc, str, len, jval))
+				return false;
+		}
+		else if ((header & JB_FARRAY) != 0)
+		{
+			if (!__jsonb_parse_index(str, len, &index) ||
+				!__jsonb_find_index(jc, index, jval))
+				return false;
+		}
+		else
+			return false;
+	}
+	return true;
+}
+
+/*
+ * jsonb -> text, jsonb -> int, jsonb #> text[]
+ */
+STATIC_FUNCTION(pg_jsonb_t)
+pgfn_jsonb_object_field(kern_context *kcxt, pg_jsonb_t arg1, pg_text_t arg2)
+{
+	kern_jsonb_value jval;
+	pg_jsonb_t	result;
+
+	if (!jsonb_lookup_field(kcxt, arg1, arg2, &jval))
+	{
+		result.isnull = true;
+		return result;
+	}
+	return jsonb_form_value(kcxt, &jval);
+}
+
+STATIC_FUNCTION(pg_jsonb_t)
+pgfn_jsonb_array_element(kern_context *kcxt, pg_jsonb_t arg1, pg_int4_t arg2)
+{
+	kern_jsonb_value jval;
+	pg_jsonb_t	result;
+
+	if (!jsonb_lookup_element(kcxt, arg1, arg2, &jval))
+	{
+		result.isnull = true;
+		return result;
+	}
+	return jsonb_form_value(kcxt, &jval);
+}
+
+STATIC_FUNCTION(pg_jsonb_t)
+pgfn_jsonb_extract_path(kern_context *kcxt, pg_jsonb_t arg1, pg_array_t arg2)
+{
+	kern_jsonb_value jval;
+	pg_jsonb_t	result;
+
+	if (!jsonb_lookup_path(kcxt, arg1, arg2, &jval))
+	{
+		result.isnull = true;
+		return result;
+	}
+	return jsonb_form_value(kcxt, &jval);
+}
+
+/*
+ * jsonb ->> text, jsonb ->> int, jsonb #>> text[]
+ */
+STATIC_FUNCTION(pg_text_t)
+pgfn_jsonb_object_field_text(kern_context *kcxt,
+							 pg_jsonb_t arg1, pg_text_t arg2)
+{
+	kern_jsonb_value jval;
+	pg_text_t	result;
+
+	if (!jsonb_lookup_field(kcxt, arg1, arg2, &jval))
+	{
+		result.isnull = true;
+		return result;
+	}
+	return jsonb_form_text(kcxt, &jval);
+}
+
+STATIC_FUNCTION(pg_text_t)
+pgfn_jsonb_array_element_text(kern_context *kcxt,
+							  pg_jsonb_t arg1, pg_int4_t arg2)
+{
+	kern_jsonb_value jval;
+	pg_text_t	result;
+
+	if (!jsonb_lookup_element(kcxt, arg1, arg2, &jval))
+	{
+		result.isnull = true;
+		return result;
+	}
+	return jsonb_form_text(kcxt, &jval);
+}
+
+STATIC_FUNCTION(pg_text_t)
+pgfn_jsonb_extract_path_text(kern_context *kcxt,
+							 pg_jsonb_t arg1, pg_array_t arg2)
+{
+	kern_jsonb_value jval;
+	pg_text_t	result;
+
+	if (!jsonb_lookup_path(kcxt, arg1, arg2, &jval))
+	{
+		result.isnull = true;
+		return result;
+	}
+	return jsonb_form_text(kcxt, &jval);
+}
+
+/*
+ * jsonb ? text
+ */
+STATIC_FUNCTION(pg_bool_t)
+pgfn_jsonb_exists(kern_context *kcxt, pg_jsonb_t arg1, pg_text_t arg2)
+{
+	pg_bool_t	result;
+	const char *jc;
+	const char *key;
+	cl_uint		keylen;
+
+	result.isnull = (arg1.isnull | arg2.isnull);
+	if (!result.isnull)
+	{
+		jc = jsonb_root_container(kcxt, arg1.value);
+		if (!jc || !jsonb_text_arg(kcxt, arg2.value, &key, &keylen))
+			result.isnull = true;
+		else
+			result.value = __jsonb_exists(jc, key, keylen);
+	}
+	return result;
+}
+
+/*
+ * Type cast functions from scalar jsonb (PG11 or later)
+ *
+ * It raises an error if the jsonb is not a scalar value of the expected
+ * type, so we leave them to CPU.
+ */
+STATIC_INLINE(cl_bool)
+jsonb_extract_scalar(kern_context *kcxt, pg_jsonb_t arg,
+					 cl_uint type, kern_jsonb_value *jval)
+{
+	const char *jc;
+
+	if (arg.isnull)
+		return false;
+	jc = jsonb_root_container(kcxt, arg.value);
+	if (!jc)
+		return false;
+	if ((__jsonb_fetch_uint32(jc) & JB_FSCALAR) == 0)
+	{
+		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
+		return false;
+	}
+	__jsonb_fetch_value(jc, 0, jval);
+	if (type == JENTRY_ISBOOL_TRUE
+		? (jval->type != JENTRY_ISBOOL_TRUE &&
+		   jval->type != JENTRY_ISBOOL_FALSE)
+		: jval->type != type)
+	{
+		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
+		return false;
+	}
+	return true;
+}
+
+STATIC_FUNCTION(pg_bool_t)
+pgfn_jsonb_bool(kern_context *kcxt, pg_jsonb_t arg)
+{
+	kern_jsonb_value jval;
+	pg_bool_t	result;
+
+	result.isnull = !jsonb_extract_scalar(kcxt, arg,
+										  JENTRY_ISBOOL_TRUE, &jval);
+	if (!result.isnull)
+		result.value = (jval.type == JENTRY_ISBOOL_TRUE);
+	return result;
+}
+
+#ifdef CUDA_NUMERIC_H
+STATIC_FUNCTION(pg_numeric_t)
+pgfn_jsonb_numeric(kern_context *kcxt, pg_jsonb_t arg)
+{
+	kern_jsonb_value jval;
+	pg_numeric_t result;
+
+	if (!jsonb_extract_scalar(kcxt, arg, JENTRY_ISNUMERIC, &jval))
+	{
+		result.isnull = true;
+		return result;
+	}
+	return pg_numeric_from_varlena(kcxt, (varlena *) jval.data);
+}
+
+#define PG_JSONB_NUMERIC_CAST_TEMPLATE(TARGET)						\
+	STATIC_FUNCTION(pg_##TARGET##_t)								\
+	pgfn_jsonb_##TARGET(kern_context *kcxt, pg_jsonb_t arg)			\
+	{																\
+		return pgfn_numeric_##TARGET(kcxt,							\
+									 pgfn_jsonb_numeric(kcxt, arg));\
+	}
+PG_JSONB_NUMERIC_CAST_TEMPLATE(int2)
+PG_JSONB_NUMERIC_CAST_TEMPLATE(int4)
+PG_JSONB_NUMERIC_CAST_TEMPLATE(int8)
+PG_JSONB_NUMERIC_CAST_TEMPLATE(float4)
+PG_JSONB_NUMERIC_CAST_TEMPLATE(float8)
+#undef PG_JSONB_NUMERIC_CAST_TEMPLATE
+#endif	/* CUDA_NUMERIC_H */
+
+#endif	/* __CUDACC__ */
+#endif	/* CUDA_JSONLIB_H */
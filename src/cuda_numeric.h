@@ -38,7 +38,7 @@ typedef cl_short	NumericDigit;
 #endif
 
 #define PG_MAX_DIGITS		40	/* Max digits of 128bit integer */
-#define PG_MAX_DATA			(PG_MAX_DIGITS / PG_DEC_DIGITS)
+#define PG_MAX_DATA			(PG_MAX_DIGITS / PG_DEC_DIGITS + 1)
 
 struct NumericShort
 {
@@ -344,6 +344,86 @@ __Int128_div(Int128_t x, cl_long a, cl_long *p_mod)
 	return res;
 }
 
+STATIC_INLINE(Int128_t)
+__Int128_add128(Int128_t x, Int128_t y)
+{
+	Int128_t	res;
+#ifdef HAVE_INT128
+	res.ival = (int128)((uint128)x.ival + (uint128)y.ival);
+#else
+	asm("add.cc.u64     %0, %2, %3;\n"
+		"addc.u64       %1, %4, %5;\n"
+		: "=l" (res.lo), "=l" (res.hi)
+		: "l" (x.lo), "l" (y.lo),
+		  "l" (x.hi), "l" (y.hi));
+#endif
+	return res;
+}
+
+/*
+ * __Int128_nbits - number of significant bits of the absolute value
+ */
+STATIC_INLINE(cl_int)
+__Int128_nbits(Int128_t x)
+{
+	cl_ulong	hi, lo;
+
+	if (__Int128_sign(x) < 0)
+		x = __Int128_inverse(x);
+#ifdef HAVE_INT128
+	hi = (cl_ulong)((uint128)x.ival >> 64);
+	lo = (cl_ulong)((uint128)x.ival);
+	if (hi != 0)
+		return 128 - __builtin_clzll(hi);
+	if (lo != 0)
+		return 64 - __builtin_clzll(lo);
+#else
+	hi = x.hi;
+	lo = x.lo;
+	if (hi != 0)
+		return 128 - __clzll(hi);
+	if (lo != 0)
+		return 64 - __clzll(lo);
+#endif
+	return 0;
+}
+
+/*
+ * __Int128_mul128 - multiplication of two 128bit integers
+ *
+ * It returns false if the result may not fit 128bit signed integer.
+ * The check is conservative, by the sum of significant bits.
+ */
+STATIC_INLINE(cl_bool)
+__Int128_mul128(Int128_t x, Int128_t y, Int128_t *p_res)
+{
+	cl_bool		is_negative = false;
+	Int128_t	res;
+
+	if (__Int128_nbits(x) + __Int128_nbits(y) > 127)
+		return false;
+	if (__Int128_sign(x) < 0)
+	{
+		is_negative = !is_negative;
+		x = __Int128_inverse(x);
+	}
+	if (__Int128_sign(y) < 0)
+	{
+		is_negative = !is_negative;
+		y = __Int128_inverse(y);
+	}
+#ifdef HAVE_INT128
+	res.ival = x.ival * y.ival;
+#else
+	res.lo = x.lo * y.lo;
+	res.hi = __umul64hi(x.lo, y.lo);
+	res.hi += x.hi * y.lo;
+	res.hi += x.lo * y.hi;
+#endif
+	*p_res = (is_negative ? __Int128_inverse(res) : res);
+	return true;
+}
+
 /*
  * PG-Strom internal representation of NUMERIC data type
  *
@@ -352,6 +432,9 @@ __Int128_div(Int128_t x, cl_long a, cl_long *p_mod)
  * within 128bit fixed-point number; that is compatible to Decimal type in
  * Apache Arrow.
  * Internal data format (pg_numeric_t) has 128bit value and precision (16bit).
+ * The precision follows the display scale of PostgreSQL's numeric, so values
+ * of a column with declared typmod, like numeric(12,2), share the same
+ * precision and can be added or compared without any scale adjustment.
  * Function that handles NUMERIC data type may set StromError_CpuReCheck,
  * if it detects overflow during calculation.
  */
@@ -361,6 +444,13 @@ typedef struct {
 	cl_bool		isnull;
 } pg_numeric_t;
 
+/*
+ * pg_numeric_normalize
+ *
+ * It removes trailing zeros of the value, to make a canonical form of the
+ * numeric; used for hash calculation, because values with different display
+ * scale (e.g, 1.50 and 1.5) must have identical hash value.
+ */
 STATIC_INLINE(pg_numeric_t)
 pg_numeric_normalize(pg_numeric_t num)
 {
@@ -403,6 +493,76 @@ pg_numeric_normalize(pg_numeric_t num)
 	return num;
 }
 
+/*
+ * __pg_numeric_pow10 - 10^k for 0 <= k <= PG_NUMERIC_POW10_MAX
+ */
+#define PG_NUMERIC_POW10_MAX	18
+
+STATIC_INLINE(cl_long)
+__pg_numeric_pow10(cl_int k)
+{
+	switch (k)
+	{
+		case 0:  return 1L;
+		case 1:  return 10L;
+		case 2:  return 100L;
+		case 3:  return 1000L;
+		case 4:  return 10000L;
+		case 5:  return 100000L;
+		case 6:  return 1000000L;
+		case 7:  return 10000000L;
+		case 8:  return 100000000L;
+		case 9:  return 1000000000L;
+		case 10: return 10000000000L;
+		case 11: return 100000000000L;
+		case 12: return 1000000000000L;
+		case 13: return 10000000000000L;
+		case 14: return 100000000000000L;
+		case 15: return 1000000000000000L;
+		case 16: return 10000000000000000L;
+		case 17: return 100000000000000000L;
+		case 18: return 1000000000000000000L;
+		default:
+			assert(k >= 0 && k <= PG_NUMERIC_POW10_MAX);
+			break;
+	}
+	return 0;
+}
+
+/*
+ * pg_numeric_rescale
+ *
+ * It adjusts the value to the supplied precision by one multiplication
+ * (or division) per 10^18, instead of the digit-by-digit loop.
+ * Down-scaling truncates the value towards zero. It returns false if
+ * up-scaling may overflow the 128bit integer.
+ */
+STATIC_FUNCTION(cl_bool)
+pg_numeric_rescale(pg_numeric_t *num, cl_int precision)
+{
+	cl_int		delta = precision - num->precision;
+	cl_int		k;
+	cl_long		mod;
+
+	while (delta > 0)
+	{
+		k = Min(delta, PG_NUMERIC_POW10_MAX);
+		/* 10^k has (k * log2(10)) bits, at most */
+		if (__Int128_nbits(num->value) + (10 * k + 2) / 3 + 1 > 127)
+			return false;
+		num->value = __Int128_mul(num->value, __pg_numeric_pow10(k));
+		delta -= k;
+	}
+	while (delta < 0)
+	{
+		k = Min(-delta, PG_NUMERIC_POW10_MAX);
+		num->value = __Int128_div(num->value, __pg_numeric_pow10(k), &mod);
+		delta += k;
+	}
+	num->precision = precision;
+	return true;
+}
+
 STATIC_FUNCTION(pg_numeric_t)
 pg_numeric_from_varlena(kern_context *kcxt, struct varlena *vl_datum)
 {
@@ -425,42 +585,65 @@ pg_numeric_from_varlena(kern_context *kcxt, struct varlena *vl_datum)
 	}
 	/* copy to private memory for alignment */
 	memcpy(&numData, VARDATA_ANY(vl_datum), len);
+	/* NaN is not supported on the device side */
+	if (NUMERIC_IS_NAN(&numData))
+	{
+		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
+		result.isnull = true;
+		return result;
+	}
 	/* construct pg_numeric_t value from PostgreSQL Numeric */
 	{
 		NumericDigit *digits = NUMERIC_DIGITS(&numData);
 		int		weight  = NUMERIC_WEIGHT(&numData) + 1;
+		int		dscale  = NUMERIC_DSCALE(&numData);
         int		offset  = (const char *)digits - (const char *)&numData;
         int		i, ndigits = (len - offset) / sizeof(NumericDigit);
 
 		/* Numeric value is 0, if ndigits is 0 */
         if (ndigits == 0)
+		{
+			result.precision = dscale;
             return result;
+		}
 		for (i=0; i < ndigits; i++)
 		{
 			NumericDigit	dig = digits[i];
-			Int128_t		temp;
 
-			temp = __Int128_mad(result.value, PG_NBASE, dig);
-			if (__Int128_sign(temp) < 0)
+			/* NBASE (=10000) has 14bits */
+			if (__Int128_nbits(result.value) + 14 > 127)
 			{
 				/* !overflow! */
 				STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
                 result.isnull = true;
                 return result;
 			}
-			result.value = temp;
+			result.value = __Int128_mad(result.value, PG_NBASE, dig);
 		}
 		/* sign of the value */
 		if (NUMERIC_SIGN(&numData) == NUMERIC_NEG)
 			result.value = __Int128_inverse(result.value);
 		/* precision */
 		result.precision = PG_DEC_DIGITS * (ndigits - weight);
+
+		/*
+		 * Adjust the precision to the display scale at once, so all the
+		 * values in a column with typmod have identical precision.
+		 * Large integer values with trailing zero digits are kept as-is.
+		 */
+		if (result.precision > dscale ||
+			(result.precision < dscale && dscale > 0))
+		{
+			if (!pg_numeric_rescale(&result, dscale))
+			{
+				STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
+				result.isnull = true;
+			}
+		}
 	}
-	return pg_numeric_normalize(result);
+	return result;
 }
 
-#ifdef __CUDACC__
-
 /*
  * pg_numeric_to_varlena
  *
@@ -476,8 +659,8 @@ STATIC_FUNCTION(cl_uint)
 pg_numeric_to_varlena(kern_context *kcxt, char *vl_buffer,
 					  cl_short precision, Int128_t value)
 {
-	NumericData	   *numData = (NumericData *)vl_buffer;
-	NumericLong	   *numBody = &numData->choice.n_long;
+	struct NumericData *numData = (struct NumericData *)vl_buffer;
+	struct NumericLong *numBody = &numData->choice.n_long;
 	NumericDigit	n_data[PG_MAX_DATA];
 	int				ndigits;
 	cl_uint			len;
@@ -488,30 +671,50 @@ pg_numeric_to_varlena(kern_context *kcxt, char *vl_buffer,
 	if (is_negative)
 		value = __Int128_inverse(value);
 
+	ndigits = 0;
 	switch (precision % PG_DEC_DIGITS)
 	{
-		case 3:
 		case -1:
 			value = __Int128_mul(value, 10);
 			precision += 1;
 			break;
-		case 2:
 		case -2:
 			value = __Int128_mul(value, 100);
 			precision += 2;
 			break;
-		case 1:
 		case -3:
 			value = __Int128_mul(value, 1000);
 			precision += 3;
 			break;
+		case 1:
+		case 2:
+		case 3:
+			/*
+			 * The lowest digits are split off at first, instead of the
+			 * multiplication of the whole value that may overflow.
+			 */
+			{
+				cl_int	shift = precision % PG_DEC_DIGITS;
+				cl_long	mod;
+
+				value = __Int128_div(value, __pg_numeric_pow10(shift), &mod);
+				precision -= shift;
+				if (mod != 0)
+				{
+					mod *= __pg_numeric_pow10(PG_DEC_DIGITS - shift);
+					n_data[PG_MAX_DATA - 1] = mod;
+					precision += PG_DEC_DIGITS;
+					ndigits++;
+				}
+			}
+			break;
 		default:
 			/* ok */
 			break;
 	}
 	assert(precision % PG_DEC_DIGITS == 0);
 
-	for (ndigits=0; __Int128_sign(value) != 0; ndigits++)
+	for (; __Int128_sign(value) != 0; ndigits++)
 	{
 		cl_long		mod;
 
@@ -529,12 +732,115 @@ pg_numeric_to_varlena(kern_context *kcxt, char *vl_buffer,
 	numBody->n_sign_dscale = n_header;
 	numBody->n_weight = ndigits - (precision / PG_DEC_DIGITS) - 1;
 
-	len = offsetof(NumericData, choice.n_long.n_data[ndigits]);
+	len = (offsetof(struct NumericData, choice.n_long.n_data) +
+		   sizeof(NumericDigit) * ndigits);
 	SET_VARSIZE(numData, len);
 
 	return len;
 }
 
+/*
+ * Fixed-point arithmetic on pg_numeric_t
+ *
+ * These routines are shared by the device code and host code, so the
+ * result of device side numeric operations can be checked towards the
+ * PostgreSQL's numeric operations on the host (see numeric_devlib_check).
+ * If both arguments have the same precision, as usual for columns with
+ * a declared typmod, no scale adjustment is needed.
+ */
+STATIC_INLINE(cl_bool)
+__pg_numeric_align(pg_numeric_t *arg1, pg_numeric_t *arg2)
+{
+	if (arg1->precision < arg2->precision)
+		return pg_numeric_rescale(arg1, arg2->precision);
+	if (arg1->precision > arg2->precision)
+		return pg_numeric_rescale(arg2, arg1->precision);
+	return true;
+}
+
+STATIC_FUNCTION(pg_numeric_t)
+pg_numeric_add(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2)
+{
+	pg_numeric_t result;
+	cl_int		sign1, sign2;
+
+	result.isnull = arg1.isnull | arg2.isnull;
+	if (result.isnull)
+		return result;
+	if (!__pg_numeric_align(&arg1, &arg2))
+		goto overflow;
+	sign1 = __Int128_sign(arg1.value);
+	sign2 = __Int128_sign(arg2.value);
+	result.value = __Int128_add128(arg1.value, arg2.value);
+	result.precision = arg1.precision;
+	/* overflow, if sign of the result is not sign of the arguments */
+	if (sign1 == sign2 && sign1 != 0 &&
+		__Int128_sign(result.value) != sign1)
+		goto overflow;
+	return result;
+
+overflow:
+	STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
+	result.isnull = true;
+	return result;
+}
+
+STATIC_FUNCTION(pg_numeric_t)
+pg_numeric_sub(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2)
+{
+	if (!arg2.isnull)
+		arg2.value = __Int128_inverse(arg2.value);
+	return pg_numeric_add(kcxt, arg1, arg2);
+}
+
+STATIC_FUNCTION(pg_numeric_t)
+pg_numeric_mul(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2)
+{
+	pg_numeric_t result;
+
+	result.isnull = arg1.isnull | arg2.isnull;
+	if (result.isnull)
+		return result;
+	if (!__Int128_mul128(arg1.value, arg2.value, &result.value))
+	{
+		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
+		result.isnull = true;
+		return result;
+	}
+	result.precision = arg1.precision + arg2.precision;
+	return result;
+}
+
+STATIC_FUNCTION(cl_int)
+pg_numeric_cmp(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2)
+{
+	int		sign1 = __Int128_sign(arg1.value);
+	int		sign2 = __Int128_sign(arg2.value);
+
+	/* shortcut for obvious cases */
+	if (sign1 > sign2)
+		return 1;
+	else if (sign1 < sign2)
+		return -1;
+	else if (sign1 == 0)
+		return 0;
+	/* ok, both of arg1 and arg2 is not zero, and have same sign */
+	if (!__pg_numeric_align(&arg1, &arg2))
+	{
+		/*
+		 * The one which cannot be up-scaled has larger absolute value,
+		 * because its value is already large enough.
+		 */
+		if (arg1.precision < arg2.precision)
+			return sign1;
+		else
+			return -sign1;
+	}
+	return __Int128_compare(arg1.value, arg2.value);
+}
+
+#ifdef __CUDACC__
+
 /*
  * pg_numeric_datum_(ref|store)
  *
@@ -611,8 +917,28 @@ pg_numeric_param(kern_context *kcxt,
 	return result;
 }
 
-/* CRC32 calculation function */
-STROMCL_SIMPLE_COMP_CRC32_TEMPLATE(numeric,cl_long)
+/*
+ * CRC32 calculation function
+ *
+ * Hash value must be calculated on the canonical form, because values with
+ * different display scale are equal. It also must be consistent to
+ * pg_numeric_devtype_hashfunc() on the host side.
+ */
+STATIC_INLINE(cl_uint)
+pg_numeric_comp_crc32(const cl_uint *crc32_table,
+					  kern_context *kcxt,
+					  cl_uint hash, pg_numeric_t datum)
+{
+	if (!datum.isnull)
+	{
+		datum = pg_numeric_normalize(datum);
+		hash = pg_common_comp_crc32(crc32_table,
+									hash,
+									(char *)&datum.value,
+									sizeof(Int128_t));
+	}
+	return hash;
+}
 
 STATIC_INLINE(Datum)
 pg_numeric_as_datum(void *addr)
@@ -622,34 +948,48 @@ pg_numeric_as_datum(void *addr)
 /* to avoid conflicts with auto-generated data type */
 #define PG_NUMERIC_TYPE_DEFINED
 
+/*
+ * Dependencies between the device functions below
+ *
+ * Once PGSTROM_DEVFUNC_PRUNED is defined, only the device functions
+ * tracked by the code generator (DEVFUNC_NEEDS__xxx) are built.
+ * pgfn_numeric_cash() in cuda_misc.h also calls the functions below.
+ */
+#ifdef PGSTROM_DEVFUNC_PRUNED
+#if defined(DEVFUNC_NEEDS__numeric_cash)
+#define DEVFUNC_NEEDS__int8_numeric
+#define DEVFUNC_NEEDS__numeric_int8
+#define DEVFUNC_NEEDS__numeric_mul
+#endif
+#endif	/* PGSTROM_DEVFUNC_PRUNED */
+
 /*
  * Numeric format translation functions
  * ----------------------------------------------------------------
  */
+#if !defined(PGSTROM_DEVFUNC_PRUNED) ||	\
+	defined(DEVFUNC_NEEDS__numeric_int2) ||	\
+	defined(DEVFUNC_NEEDS__numeric_int4) ||	\
+	defined(DEVFUNC_NEEDS__numeric_int8)
 STATIC_FUNCTION(cl_long)
 numeric_to_integer(kern_context *kcxt, pg_numeric_t arg,
 				   cl_ulong max_value, cl_bool *p_isnull)
 {
-	Int128_t	curr = arg.value;
-	int			precision = arg.precision;
+	Int128_t	curr;
 	bool		is_negative = false;
-	cl_long		mod;
 
+	if (!pg_numeric_rescale(&arg, 0))
+	{
+		*p_isnull = true;
+		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
+		return 0;
+	}
+	curr = arg.value;
 	if (__Int128_sign(curr) < 0)
 	{
 		is_negative = true;
 		curr = __Int128_inverse(curr);
 	}
-	while (precision > 0)
-	{
-		curr = __Int128_div(curr, 10, &mod);
-		precision--;
-	}
-	while (precision < 0)
-	{
-		curr = __Int128_mul(curr, 10);
-		precision++;
-	}
 	/* overflow? */
 	if (curr.hi != 0 || curr.lo > max_value)
 	{
@@ -658,7 +998,12 @@ numeric_to_integer(kern_context *kcxt, pg_numeric_t arg,
 	}
 	return (!is_negative ? (cl_long)curr.lo : -((cl_long)curr.lo));
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) ||	\
+	defined(DEVFUNC_NEEDS__numeric_float2) ||	\
+	defined(DEVFUNC_NEEDS__numeric_float4) ||	\
+	defined(DEVFUNC_NEEDS__numeric_float8)
 STATIC_FUNCTION(cl_double)
 numeric_to_float(kern_context *kcxt, pg_numeric_t arg)
 {
@@ -730,7 +1075,9 @@ numeric_to_float(kern_context *kcxt, pg_numeric_t arg)
 									((cl_ulong)expo << FP64_FRAC_BITS) |
 									(ival & FP64_FRAC_MASK));
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__numeric_int2)
 STATIC_FUNCTION(pg_int2_t)
 pgfn_numeric_int2(kern_context *kcxt, pg_numeric_t arg)
 {
@@ -744,7 +1091,9 @@ pgfn_numeric_int2(kern_context *kcxt, pg_numeric_t arg)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__numeric_int4)
 STATIC_FUNCTION(pg_int4_t)
 pgfn_numeric_int4(kern_context *kcxt, pg_numeric_t arg)
 {
@@ -758,7 +1107,9 @@ pgfn_numeric_int4(kern_context *kcxt, pg_numeric_t arg)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__numeric_int8)
 STATIC_FUNCTION(pg_int8_t)
 pgfn_numeric_int8(kern_context *kcxt, pg_numeric_t arg)
 {
@@ -772,7 +1123,9 @@ pgfn_numeric_int8(kern_context *kcxt, pg_numeric_t arg)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__numeric_float2)
 STATIC_INLINE(pg_float2_t)
 pgfn_numeric_float2(kern_context *kcxt, pg_numeric_t arg)
 {
@@ -790,7 +1143,9 @@ pgfn_numeric_float2(kern_context *kcxt, pg_numeric_t arg)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__numeric_float4)
 STATIC_INLINE(pg_float4_t)
 pgfn_numeric_float4(kern_context *kcxt, pg_numeric_t arg)
 {
@@ -808,7 +1163,9 @@ pgfn_numeric_float4(kern_context *kcxt, pg_numeric_t arg)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__numeric_float8)
 STATIC_INLINE(pg_float8_t)
 pgfn_numeric_float8(kern_context *kcxt, pg_numeric_t arg)
 {
@@ -826,7 +1183,12 @@ pgfn_numeric_float8(kern_context *kcxt, pg_numeric_t arg)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) ||	\
+	defined(DEVFUNC_NEEDS__int2_numeric) ||	\
+	defined(DEVFUNC_NEEDS__int4_numeric) ||	\
+	defined(DEVFUNC_NEEDS__int8_numeric)
 STATIC_FUNCTION(pg_numeric_t)
 integer_to_numeric(kern_context *kcxt, cl_long ival)
 {
@@ -837,9 +1199,14 @@ integer_to_numeric(kern_context *kcxt, cl_long ival)
 	result.value.lo = ival;
 	result.value.hi = (ival < 0 ? ~0UL : 0);
 
-	return pg_numeric_normalize(result);
+	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) ||	\
+	defined(DEVFUNC_NEEDS__float2_numeric) ||	\
+	defined(DEVFUNC_NEEDS__float4_numeric) ||	\
+	defined(DEVFUNC_NEEDS__float8_numeric)
 STATIC_FUNCTION(pg_numeric_t)
 float_to_numeric(kern_context *kcxt, cl_double fval)
 {
@@ -910,7 +1277,9 @@ float_to_numeric(kern_context *kcxt, cl_double fval)
 		result.value = __Int128_inverse(result.value);
     return pg_numeric_normalize(result);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__int2_numeric)
 STATIC_FUNCTION(pg_numeric_t)
 pgfn_int2_numeric(kern_context *kcxt, pg_int2_t arg)
 {
@@ -922,7 +1291,9 @@ pgfn_int2_numeric(kern_context *kcxt, pg_int2_t arg)
 		result = integer_to_numeric(kcxt, arg.value);
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__int4_numeric)
 STATIC_FUNCTION(pg_numeric_t)
 pgfn_int4_numeric(kern_context *kcxt, pg_int4_t arg)
 {
@@ -934,7 +1305,9 @@ pgfn_int4_numeric(kern_context *kcxt, pg_int4_t arg)
 		result = integer_to_numeric(kcxt, arg.value);
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__int8_numeric)
 STATIC_FUNCTION(pg_numeric_t)
 pgfn_int8_numeric(kern_context *kcxt, pg_int8_t arg)
 {
@@ -946,7 +1319,9 @@ pgfn_int8_numeric(kern_context *kcxt, pg_int8_t arg)
 		result = integer_to_numeric(kcxt, arg.value);
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__float2_numeric)
 STATIC_INLINE(pg_numeric_t)
 pgfn_float2_numeric(kern_context *kcxt, pg_float2_t arg)
 {
@@ -957,7 +1332,9 @@ pgfn_float2_numeric(kern_context *kcxt, pg_float2_t arg)
 		result = float_to_numeric(kcxt, (cl_double)arg.value);
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__float4_numeric)
 STATIC_FUNCTION(pg_numeric_t)
 pgfn_float4_numeric(kern_context *kcxt, pg_float4_t arg)
 {
@@ -968,7 +1345,9 @@ pgfn_float4_numeric(kern_context *kcxt, pg_float4_t arg)
 		result = float_to_numeric(kcxt, (cl_double)arg.value);
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__float8_numeric)
 STATIC_FUNCTION(pg_numeric_t)
 pgfn_float8_numeric(kern_context *kcxt, pg_float8_t arg)
 {
@@ -979,17 +1358,21 @@ pgfn_float8_numeric(kern_context *kcxt, pg_float8_t arg)
 		result = float_to_numeric(kcxt, (cl_double)arg.value);
 	return result;
 }
+#endif
 
 /*
  * Numeric operator functions
  * ----------------------------------------------------------------
  */
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__numeric_uplus)
 STATIC_FUNCTION(pg_numeric_t)
 pgfn_numeric_uplus(kern_context *kcxt, pg_numeric_t arg)
 {
 	return arg;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__numeric_uminus)
 STATIC_FUNCTION(pg_numeric_t)
 pgfn_numeric_uminus(kern_context *kcxt, pg_numeric_t arg)
 {
@@ -997,7 +1380,9 @@ pgfn_numeric_uminus(kern_context *kcxt, pg_numeric_t arg)
 		arg.value = __Int128_inverse(arg.value);
 	return arg;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__numeric_abs)
 STATIC_FUNCTION(pg_numeric_t)
 pgfn_numeric_abs(kern_context *kcxt, pg_numeric_t arg)
 {
@@ -1008,119 +1393,46 @@ pgfn_numeric_abs(kern_context *kcxt, pg_numeric_t arg)
 	}
 	return arg;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__numeric_add)
 STATIC_FUNCTION(pg_numeric_t)
 pgfn_numeric_add(kern_context *kcxt,
 				 pg_numeric_t arg1, pg_numeric_t arg2)
 {
-	pg_numeric_t result;
-
-	result.isnull = arg1.isnull | arg2.isnull;
-	if (result.isnull)
-		return result;
-
-	while (arg1.precision > arg2.precision)
-	{
-		arg2.value = __Int128_mul(arg2.value, 10);
-		arg2.precision++;
-	}
-	while (arg1.precision < arg2.precision)
-	{
-		arg1.value = __Int128_mul(arg1.value, 10);
-		arg1.precision++;
-	}
-	asm volatile("add.cc.u64     %0, %2, %3;\n"
-				 "addc.u64       %1, %4, %5;\n"
-				 : "=l" (result.value.lo),
-				   "=l" (result.value.hi)
-				 : "l" (arg1.value.lo),
-				   "l" (arg2.value.lo),
-				   "l" (arg1.value.hi),
-				   "l" (arg2.value.hi));
-	result.precision = arg1.precision;
-
-	return pg_numeric_normalize(result);
+	return pg_numeric_add(kcxt, arg1, arg2);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__numeric_sub)
 STATIC_FUNCTION(pg_numeric_t)
 pgfn_numeric_sub(kern_context *kcxt,
 				 pg_numeric_t arg1, pg_numeric_t arg2)
 {
-	arg2.value = __Int128_inverse(arg2.value);
-
-	return pgfn_numeric_add(kcxt, arg1, arg2);
+	return pg_numeric_sub(kcxt, arg1, arg2);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__numeric_mul)
 STATIC_FUNCTION(pg_numeric_t)
 pgfn_numeric_mul(kern_context *kcxt,
 				 pg_numeric_t arg1, pg_numeric_t arg2)
 {
-	pg_numeric_t result;
-	cl_bool		is_negative_1 = false;
-	cl_bool		is_negative_2 = false;
-
-	result.isnull = arg1.isnull | arg2.isnull;
-	if (result.isnull)
-		return result;
-	if (__Int128_sign(arg1.value) < 0)
-	{
-		is_negative_1 = true;
-		arg1.value = __Int128_inverse(arg1.value);
-	}
-	if (__Int128_sign(arg2.value) < 0)
-	{
-		is_negative_2 = true;
-		arg2.value = __Int128_inverse(arg2.value);
-	}
-
-	if ((arg1.value.hi != 0 && arg2.value.hi != 0) ||
-		__umul64hi(arg1.value.hi, arg2.value.lo) != 0 ||
-		__umul64hi(arg1.value.lo, arg2.value.hi) != 0)
-	{
-		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
-		result.isnull = true;
-		return result;
-	}
-	result.value.lo = arg1.value.lo * arg2.value.lo;
-	result.value.hi = __umul64hi(arg1.value.lo, arg2.value.lo);
-	result.value.hi += arg1.value.hi * arg2.value.lo;
-	result.value.hi += arg1.value.lo * arg2.value.hi;
-
-	if (is_negative_1 != is_negative_2)
-		result.value = __Int128_inverse(result.value);
-	result.precision = arg1.precision + arg2.precision;
-	return pg_numeric_normalize(result);
+	return pg_numeric_mul(kcxt, arg1, arg2);
 }
+#endif
 
 /*
  * Numeric comparison functions
  * ----------------------------------------------------------------
  */
-STATIC_FUNCTION(int)
+STATIC_INLINE(int)
 numeric_cmp(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2)
 {
-	int		sign1 = __Int128_sign(arg1.value);
-	int		sign2 = __Int128_sign(arg2.value);
-
-	/* shortcut for obvious cases */
-	if (sign1 > sign2)
-		return 1;
-	else if (sign1 < sign2)
-		return -1;
-	/* ok, both of arg1 and arg2 is not zero, and have same sign */
-	while (arg1.precision > arg2.precision)
-	{
-		arg2.value = __Int128_mul(arg2.value, 10);
-		arg2.precision++;
-	}
-	while (arg1.precision < arg2.precision)
-	{
-		arg1.value = __Int128_mul(arg1.value, 10);
-		arg1.precision++;
-	}
-	return __Int128_compare(arg1.value, arg2.value);
+	return pg_numeric_cmp(kcxt, arg1, arg2);
 }
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__numeric_eq)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_numeric_eq(kern_context *kcxt,
 				pg_numeric_t arg1, pg_numeric_t arg2)
@@ -1132,7 +1444,9 @@ pgfn_numeric_eq(kern_context *kcxt,
 		result.value = (numeric_cmp(kcxt, arg1, arg2) == 0);
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__numeric_ne)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_numeric_ne(kern_context *kcxt,
 				pg_numeric_t arg1, pg_numeric_t arg2)
@@ -1144,7 +1458,9 @@ pgfn_numeric_ne(kern_context *kcxt,
 		result.value = (numeric_cmp(kcxt, arg1, arg2) != 0);
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__numeric_lt)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_numeric_lt(kern_context *kcxt,
 				pg_numeric_t arg1, pg_numeric_t arg2)
@@ -1156,7 +1472,9 @@ pgfn_numeric_lt(kern_context *kcxt,
 		result.value = (numeric_cmp(kcxt, arg1, arg2) < 0);
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__numeric_le)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_numeric_le(kern_context *kcxt,
 				pg_numeric_t arg1, pg_numeric_t arg2)
@@ -1168,7 +1486,9 @@ pgfn_numeric_le(kern_context *kcxt,
 		result.value = (numeric_cmp(kcxt, arg1, arg2) <= 0);
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__numeric_gt)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_numeric_gt(kern_context *kcxt,
 				pg_numeric_t arg1, pg_numeric_t arg2)
@@ -1180,7 +1500,9 @@ pgfn_numeric_gt(kern_context *kcxt,
 		result.value = (numeric_cmp(kcxt, arg1, arg2) > 0);
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__numeric_ge)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_numeric_ge(kern_context *kcxt,
 				pg_numeric_t arg1, pg_numeric_t arg2)
@@ -1192,6 +1514,7 @@ pgfn_numeric_ge(kern_context *kcxt,
 		result.value = (numeric_cmp(kcxt, arg1, arg2) >= 0);
 	return result;
 }
+#endif
 
 STATIC_FUNCTION(pg_int4_t)
 pgfn_type_compare(kern_context *kcxt,
@@ -46,9 +46,23 @@ typedef struct
 	size_t			ptx_length;
 	char		   *error_msg;
 	int				error_code;
+	/* build scheduling and statistics */
+	int				build_priority;	/* one of PGCACHE_BUILD_PRIO__* */
+	TimestampTz		enqueue_time;	/* time when build was enqueued */
+	TimestampTz		build_start;	/* time when build was started */
+	TimestampTz		build_end;		/* time when build was completed */
 	char			data[FLEXIBLE_ARRAY_MEMBER];
 } program_cache_entry;
 
+/*
+ * Priority of the program build. Builders pick up pending programs from
+ * the build list with the smaller priority number first.
+ */
+#define PGCACHE_BUILD_PRIO__WAIT		0	/* backend waits for completion */
+#define PGCACHE_BUILD_PRIO__NORMAL		1	/* query execution */
+#define PGCACHE_BUILD_PRIO__BACKGROUND	2	/* EXPLAIN-only or pre-warm */
+#define PGCACHE_BUILD_PRIO__NUMS		3
+
 #define PGCACHE_MIN_ERRORMSG_BUFSIZE	256
 
 #define PGCACHE_CHUNKSZ_MAX_BIT		34		/* 16GB */
@@ -70,9 +84,22 @@ typedef struct
 	dlist_head	pgid_slots[PGCACHE_HASH_SIZE];
 	dlist_head	hash_slots[PGCACHE_HASH_SIZE];
 	dlist_head	lru_list;
-	dlist_head	build_list;		/* build pending list */
+	dlist_head	build_list[PGCACHE_BUILD_PRIO__NUMS];	/* build pending list
+														 * for each priority */
+	int			num_pending;	/* # of entries in the build_list */
+	int			num_building;	/* # of entries in build progress */
 	dlist_head	addr_list;
 	dlist_head	free_list[PGCACHE_CHUNKSZ_MAX_BIT + 1];
+	/* statistics */
+	cl_ulong	stat_lookups;	/* # of program lookups */
+	cl_ulong	stat_hits;		/* # of lookups found an existing program */
+	cl_ulong	stat_varlena_misses;	/* # of lookups found an equivalent
+										 * source but with smaller varlena
+										 * buffer */
+	cl_ulong	stat_builds;	/* # of builds completed */
+	cl_ulong	stat_queue_usec;	/* total time in the build_list */
+	cl_ulong	stat_build_usec;	/* total time to build */
+	TimestampTz	stat_reset;		/* timestamp of the last reset */
 	char		base[FLEXIBLE_ARRAY_MEMBER];
 } program_cache_head;
 
@@ -81,16 +108,29 @@ typedef struct
 	pg_atomic_uint32	num_active_builders;
 	struct {
 		volatile Latch *latch;
+		volatile bool	busy;		/* true, if builder is in progress */
+		volatile TimestampTz launched;	/* time when a dynamic builder is
+										 * registered on this slot, or 0 */
 	} builders[FLEXIBLE_ARRAY_MEMBER];
 } program_builder_state;
 
+/*
+ * Builders on the slot larger than or equal to num_program_builders are
+ * launched on demand, then exit once they are idle for a while.
+ */
+#define PROGRAM_BUILDER_IDLE_TIMEOUT	30000	/* ms */
+#define PROGRAM_BUILDER_LAUNCH_TIMEOUT	60000	/* ms */
+
 /* ---- GUC variables ---- */
 static int		program_cache_size_kb;
 static int		num_program_builders;
+static int		max_program_builders;
 static bool		pgstrom_debug_jit_compile_options;
+static bool		pgstrom_precompile_on_prepare;
 
 /* ---- static variables ---- */
 static shmem_startup_hook_type shmem_startup_next;
+static post_parse_analyze_hook_type post_parse_analyze_next;
 static program_cache_head *pgcache_head = NULL;
 static program_builder_state *pgbuilder_state = NULL;
 #define PGSTROM_CUDA(x)	\
@@ -103,7 +143,12 @@ static bool		cuda_program_builder_got_signal = false;
 /* ---- forward declarations ---- */
 static void put_cuda_program_entry_nolock(program_cache_entry *entry);
 void cudaProgramBuilderMain(Datum arg);
+static void cudaProgramBuilderLaunch(int num_launch);
 static void cudaProgramBuilderWakeUp(bool error_if_no_builders);
+Datum pgstrom_program_cache_info(PG_FUNCTION_ARGS);
+Datum pgstrom_program_cache_reset(PG_FUNCTION_ARGS);
+Datum pgstrom_program_cache_prewarm(PG_FUNCTION_ARGS);
+Datum pgstrom_program_build_info(PG_FUNCTION_ARGS);
 
 /*
  * lookup_cuda_program_entry_nolock - lookup a program_cache_entry by the
@@ -128,6 +173,74 @@ lookup_cuda_program_entry_nolock(ProgramId program_id)
 /*
  * split_cuda_program_entry_nolock
  */
+/*
+ * enqueue_build_cuda_program_nolock
+ *
+ * It links the program entry to the build_list of the supplied priority.
+ */
+static void
+enqueue_build_cuda_program_nolock(program_cache_entry *entry, int priority)
+{
+	Assert(priority >= 0 && priority < PGCACHE_BUILD_PRIO__NUMS);
+	Assert(!entry->build_chain.prev && !entry->build_chain.next);
+	entry->build_priority = priority;
+	dlist_push_tail(&pgcache_head->build_list[priority],
+					&entry->build_chain);
+	pgcache_head->num_pending++;
+}
+
+/*
+ * dequeue_build_cuda_program_nolock
+ *
+ * It detach the program entry from the build_list. If @entry is NULL, it
+ * picks up the pending entry with the highest priority.
+ */
+static program_cache_entry *
+dequeue_build_cuda_program_nolock(program_cache_entry *entry)
+{
+	int			i;
+
+	if (!entry)
+	{
+		for (i=0; i < PGCACHE_BUILD_PRIO__NUMS; i++)
+		{
+			if (!dlist_is_empty(&pgcache_head->build_list[i]))
+			{
+				entry = dlist_container(program_cache_entry, build_chain,
+									dlist_head_node(&pgcache_head->build_list[i]));
+				break;
+			}
+		}
+		if (!entry)
+			return NULL;
+	}
+	Assert(entry->build_chain.prev && entry->build_chain.next);
+	dlist_delete(&entry->build_chain);
+	memset(&entry->build_chain, 0, sizeof(dlist_node));
+	Assert(pgcache_head->num_pending > 0);
+	pgcache_head->num_pending--;
+
+	return entry;
+}
+
+/*
+ * raise_build_priority_nolock
+ *
+ * It moves the pending entry to the build_list of higher priority, if
+ * @priority is higher than the current one.
+ */
+static void
+raise_build_priority_nolock(program_cache_entry *entry, int priority)
+{
+	if ((entry->build_chain.prev != NULL ||
+		 entry->build_chain.next != NULL) &&
+		priority < entry->build_priority)
+	{
+		dequeue_build_cuda_program_nolock(entry);
+		enqueue_build_cuda_program_nolock(entry, priority);
+	}
+}
+
 static bool
 split_cuda_program_entry_nolock(int mclass)
 {
@@ -362,6 +475,10 @@ construct_flat_cuda_source(cl_uint extra_flags,
 	if ((extra_flags & DEVKERNEL_BUILD_DEBUG_INFO) != 0)
 		ofs += snprintf(source + ofs, len - ofs,
 						"#define PGSTROM_KERNEL_DEBUG 1\n");
+	/* Forces CPU fallback? */
+	if ((extra_flags & DEVKERNEL_DEBUG_CPU_FALLBACK) != 0)
+		ofs += snprintf(source + ofs, len - ofs,
+						"#define PGSTROM_DEBUG_FORCE_CPU_FALLBACK 1\n");
 	/* Common PG-Strom device routine */
 	ofs += snprintf(source + ofs, len - ofs,
 					"#include \"cuda_common.h\"\n");
@@ -396,6 +513,10 @@ construct_flat_cuda_source(cl_uint extra_flags,
 	if ((extra_flags & DEVKERNEL_NEEDS_MISC) == DEVKERNEL_NEEDS_MISC)
 		ofs += snprintf(source + ofs, len - ofs,
 						"#include \"cuda_misc.h\"\n");
+	/* cuda_jsonlib.h */
+	if ((extra_flags & DEVKERNEL_NEEDS_JSONLIB) == DEVKERNEL_NEEDS_JSONLIB)
+		ofs += snprintf(source + ofs, len - ofs,
+						"#include \"cuda_jsonlib.h\"\n");
 	/* cuda_rangetypes.h */
 	if ((extra_flags & DEVKERNEL_NEEDS_RANGETYPE) == DEVKERNEL_NEEDS_RANGETYPE)
 		ofs += snprintf(source + ofs, len - ofs,
@@ -441,6 +562,9 @@ construct_flat_cuda_source(cl_uint extra_flags,
 		"    pg_text_t        text_v;\n"
 		"    pg_varchar_t     varchar_v;\n"
 		"#endif\n"
+		"#ifdef CUDA_JSONLIB_H\n"
+		"    pg_jsonb_t       jsonb_v;\n"
+		"#endif\n"
 		"#ifdef CUDA_RANGETYPE_H\n"
 		"    pg_int4range_t   int4range_v;\n"
 		"    pg_int8range_t   int8range_v;\n"
@@ -741,6 +865,7 @@ build_cuda_program(program_cache_entry *src_entry)
 	int				hindex;
 	size_t			offset;
 	size_t			length;
+	TimestampTz		build_end;
 
 	Assert(!src_entry->build_chain.prev && !src_entry->build_chain.next);
 
@@ -851,6 +976,7 @@ build_cuda_program(program_cache_entry *src_entry)
 		/*
 		 * Allocation of a new entry, to keep ptx_image/build_log
 		 */
+		build_end = GetCurrentTimestamp();
 		length = (MAXALIGN(src_entry->kern_deflen + 1) +
 				  MAXALIGN(src_entry->kern_srclen + 1) +
 				  MAXALIGN(ptx_length + 1) +
@@ -917,6 +1043,18 @@ build_cuda_program(program_cache_entry *src_entry)
 		dlist_push_head(&pgcache_head->lru_list,
 						&bin_entry->lru_chain);
 		memset(&bin_entry->build_chain, 0, sizeof(dlist_node));
+		bin_entry->build_priority	= src_entry->build_priority;
+		bin_entry->enqueue_time		= src_entry->enqueue_time;
+		bin_entry->build_start		= src_entry->build_start;
+		bin_entry->build_end		= build_end;
+		pgcache_head->num_building--;
+		pgcache_head->stat_builds++;
+		if (bin_entry->build_start > bin_entry->enqueue_time)
+			pgcache_head->stat_queue_usec += (bin_entry->build_start -
+											  bin_entry->enqueue_time);
+		if (bin_entry->build_end > bin_entry->build_start)
+			pgcache_head->stat_build_usec += (bin_entry->build_end -
+											  bin_entry->build_start);
 		bin_entry->refcnt = src_entry->refcnt;
 		/* release src_entry */
 		src_entry->refcnt = 0;
@@ -956,6 +1094,27 @@ build_cuda_program(program_cache_entry *src_entry)
 	return bin_entry;
 }
 
+/*
+ * pgcache_varlena_bufsz_bucket
+ *
+ * It rounds up the required @varlena_bufsz with a margin to the boundary
+ * of buckets; which are 1/8-1/4 steps of the power-of-two. It allows to
+ * reuse a GPU program for queries that have different length of constant
+ * values, with at most 25% of extra buffer consumption.
+ */
+static inline cl_uint
+pgcache_varlena_bufsz_bucket(cl_uint varlena_bufsz)
+{
+	cl_uint		unitsz = 64;
+
+	if (varlena_bufsz == 0)
+		return 0;
+	varlena_bufsz += 36;
+	while (unitsz * 8 <= varlena_bufsz)
+		unitsz <<= 1;
+	return TYPEALIGN(unitsz, varlena_bufsz);
+}
+
 /*
  * pgstrom_create_cuda_program
  *
@@ -983,10 +1142,16 @@ __pgstrom_create_cuda_program(GpuContext *gcontext,
 	cl_int		target_cc;
 	dlist_iter	iter;
 	pg_crc32	crc;
+	bool		varlena_miss = false;
+	int			priority;
+	TimestampTz	now = GetCurrentTimestamp();
 
 	/* build with debug option? */
 	if (pgstrom_debug_jit_compile_options)
 		extra_flags |= DEVKERNEL_BUILD_DEBUG_INFO;
+	/* build to force CPU fallback? */
+	if (pgstrom_debug_force_cpu_fallback)
+		extra_flags |= DEVKERNEL_DEBUG_CPU_FALLBACK;
 	/* target binary to build */
 	Assert(dindex >= 0 && dindex < numDevAttrs);
 	target_cc = (devAttrs[dindex].COMPUTE_CAPABILITY_MAJOR * 10 +
@@ -999,8 +1164,18 @@ __pgstrom_create_cuda_program(GpuContext *gcontext,
 	COMP_LEGACY_CRC32(crc, kern_define, kern_deflen);
 	FIN_LEGACY_CRC32(crc);
 
+	/* priority of the program build, if not built yet */
+	if (wait_for_build)
+		priority = PGCACHE_BUILD_PRIO__WAIT;
+	else if (explain_only)
+		priority = PGCACHE_BUILD_PRIO__BACKGROUND;
+	else
+		priority = PGCACHE_BUILD_PRIO__NORMAL;
+
 	hindex = crc % PGCACHE_HASH_SIZE;
 	SpinLockAcquire(&pgcache_head->lock);
+	pgcache_head->stat_lookups++;
+	pgstromStatAdd(gcontext, GPUSTAT__PROGRAM_LOOKUPS, 1);
 	dlist_foreach (iter, &pgcache_head->hash_slots[hindex])
 	{
 		bool		kick_builders = false;
@@ -1011,14 +1186,21 @@ __pgstrom_create_cuda_program(GpuContext *gcontext,
 			entry->target_cc == target_cc &&
 			entry->extra_flags == extra_flags &&
 			strcmp(entry->kern_source, kern_source) == 0 &&
-			strcmp(entry->kern_define, kern_define) == 0 &&
-			entry->varlena_bufsz >= varlena_bufsz)
+			strcmp(entry->kern_define, kern_define) == 0)
 		{
+			if (entry->varlena_bufsz < varlena_bufsz)
+			{
+				varlena_miss = true;
+				continue;
+			}
+			pgcache_head->stat_hits++;
+			pgstromStatAdd(gcontext, GPUSTAT__PROGRAM_HITS, 1);
 			program_id = entry->program_id;
 			get_cuda_program_entry_nolock(entry);
 			/* Move this entry to the head of LRU list */
 			dlist_move_head(&pgcache_head->lru_list, &entry->lru_chain);
 		retry_checks:
+			raise_build_priority_nolock(entry, priority);
 			if (entry->ptx_image != NULL || !wait_for_build)
 			{
 				if (!trackCudaProgram(gcontext, program_id,
@@ -1081,6 +1263,8 @@ __pgstrom_create_cuda_program(GpuContext *gcontext,
 	 * Not found on the existing program cache.
 	 * So, create a new entry then kick NVRTC
 	 */
+	if (varlena_miss)
+		pgcache_head->stat_varlena_misses++;
 	length = (MAXALIGN(kern_srclen + 1) +
 			  MAXALIGN(kern_deflen + 1) +
 			  PGCACHE_MIN_ERRORMSG_BUFSIZE);
@@ -1118,11 +1302,12 @@ __pgstrom_create_cuda_program(GpuContext *gcontext,
 	 * e.g, substring(X from 0 for 3) will make different value from
 	 * the substring(X from 1 for 4), but code itself shall not be
 	 * changed. So, extra margin will help the case.
+	 * Constant values are delivered via kern_parambuf, so queries which
+	 * are different only in constants share the kernel source, but length
+	 * of the varlena constants still affects the estimation. So, we round
+	 * up the buffer size to the coarse bucket also.
 	 */
-	if (varlena_bufsz == 0)
-		entry->varlena_bufsz = 0;
-	else
-		entry->varlena_bufsz = MAXALIGN(varlena_bufsz + 36);
+	entry->varlena_bufsz = pgcache_varlena_bufsz_bucket(varlena_bufsz);
 
 	/* no cuda binary at this moment */
 	entry->ptx_image = NULL;
@@ -1137,8 +1322,8 @@ __pgstrom_create_cuda_program(GpuContext *gcontext,
 					&entry->hash_chain);
 	dlist_push_head(&pgcache_head->lru_list,
 					&entry->lru_chain);
-	dlist_push_head(&pgcache_head->build_list,
-					&entry->build_chain);
+	entry->enqueue_time = now;
+	enqueue_build_cuda_program_nolock(entry, priority);
 	entry->refcnt = 2;	/* reference count (entry itself and owner) */
 
 	/* track this program entry by GpuContext */
@@ -1183,6 +1368,7 @@ __pgstrom_create_cuda_program(GpuContext *gcontext,
 		else if (entry->build_chain.prev != NULL ||
 				 entry->build_chain.next != NULL)
 		{
+			raise_build_priority_nolock(entry, PGCACHE_BUILD_PRIO__WAIT);
 			kick_builders = true;
 		}
 		/* NVRTC on this GPU program is still in-progress */
@@ -1305,8 +1491,10 @@ retry_checks:
 		 * Nobody picked up this CUDA program for build yet, so we
 		 * try to build the program by ourselves, but synchronously.
 		 */
-		dlist_delete(&entry->build_chain);
-		memset(&entry->build_chain, 0, sizeof(dlist_node));
+		dequeue_build_cuda_program_nolock(entry);
+		entry->build_priority = PGCACHE_BUILD_PRIO__WAIT;
+		entry->build_start = GetCurrentTimestamp();
+		pgcache_head->num_building++;
 		get_cuda_program_entry_nolock(entry);
 		SpinLockRelease(&pgcache_head->lock);
 		STROM_TRY();
@@ -1315,7 +1503,12 @@ retry_checks:
 		}
 		STROM_CATCH();
 		{
-			put_cuda_program_entry(entry);
+			/* back to the build pending list, like program builders */
+			SpinLockAcquire(&pgcache_head->lock);
+			pgcache_head->num_building--;
+			enqueue_build_cuda_program_nolock(entry, PGCACHE_BUILD_PRIO__WAIT);
+			put_cuda_program_entry_nolock(entry);
+			SpinLockRelease(&pgcache_head->lock);
 			STROM_RE_THROW();
 		}
 		STROM_END_TRY();
@@ -1398,19 +1591,43 @@ cudaProgramBuilderMain(Datum arg)
 	 * Event Loop
 	 */
 	pgbuilder_state->builders[builder_id].latch = MyLatch;
+	pgbuilder_state->builders[builder_id].launched = 0;
 	pg_atomic_fetch_add_u32(&pgbuilder_state->num_active_builders, 1);
 	PG_TRY();
 	{
+		TimestampTz	last_active = GetCurrentTimestamp();
+
 		while (!cuda_program_builder_got_signal)
 		{
 			program_cache_entry *entry;
-			dlist_node *dnode;
+			TimestampTz	now = GetCurrentTimestamp();
 			int			ev;
 
 			/* Is there any pending CUDA program? */
 			SpinLockAcquire(&pgcache_head->lock);
-			if (dlist_is_empty(&pgcache_head->build_list))
+			entry = dequeue_build_cuda_program_nolock(NULL);
+			if (!entry)
 			{
+				/*
+				 * 'busy' must be cleared under the lock; elsewhere, a backend
+				 * which enqueued a program just after the dequeue above may
+				 * see busy = true and skip SetLatch, then the program waits
+				 * for the timeout.
+				 */
+				pgbuilder_state->builders[builder_id].busy = false;
+				/*
+				 * Dynamic builder exits if idle. Its latch is cleared under
+				 * the lock, so backends which enqueue a program later never
+				 * count on this builder.
+				 */
+				if (builder_id >= num_program_builders &&
+					TimestampDifferenceExceeds(last_active, now,
+											   PROGRAM_BUILDER_IDLE_TIMEOUT))
+				{
+					pgbuilder_state->builders[builder_id].latch = NULL;
+					SpinLockRelease(&pgcache_head->lock);
+					break;
+				}
 				SpinLockRelease(&pgcache_head->lock);
 
 				ev = WaitLatch(MyLatch,
@@ -1425,16 +1642,16 @@ cudaProgramBuilderMain(Datum arg)
 				CHECK_FOR_INTERRUPTS();
 				continue;
 			}
-			dnode = dlist_pop_head_node(&pgcache_head->build_list);
-			entry = dlist_container(program_cache_entry, build_chain, dnode);
 
 			/*
 			 * !ptx_image && build_chain==0 means program compilation is
 			 * in-progress. So, it avoid duplication of the program build.
 			 */
-			memset(&entry->build_chain, 0, sizeof(dlist_node));
 			Assert(!entry->ptx_image);	/* must be build in-progress */
+			entry->build_start = now;
+			pgcache_head->num_building++;
 			get_cuda_program_entry_nolock(entry);
+			pgbuilder_state->builders[builder_id].busy = true;
 			SpinLockRelease(&pgcache_head->lock);
 
 			PG_TRY();
@@ -1450,42 +1667,124 @@ cudaProgramBuilderMain(Datum arg)
 				 * pending list, to be picked up by other workers.
 				 */
 				SpinLockAcquire(&pgcache_head->lock);
-				dlist_push_tail(&pgcache_head->build_list,
-								&entry->build_chain);
+				pgcache_head->num_building--;
+				enqueue_build_cuda_program_nolock(entry,
+												  entry->build_priority);
 				put_cuda_program_entry_nolock(entry);
 				SpinLockRelease(&pgcache_head->lock);
 				PG_RE_THROW();
 			}
 			PG_END_TRY();
 			put_cuda_program_entry(entry);
+			last_active = GetCurrentTimestamp();
 		}
 	}
 	PG_CATCH();
 	{
 		pg_atomic_fetch_sub_u32(&pgbuilder_state->num_active_builders, 1);
 		pgbuilder_state->builders[builder_id].latch = NULL;
+		pgbuilder_state->builders[builder_id].busy = false;
 		PG_RE_THROW();
 	}
 	PG_END_TRY();
 	pg_atomic_fetch_sub_u32(&pgbuilder_state->num_active_builders, 1);
 	pgbuilder_state->builders[builder_id].latch = NULL;
+	pgbuilder_state->builders[builder_id].busy = false;
+}
+
+/*
+ * cudaProgramBuilderLaunch
+ *
+ * It launches dynamic program builders on the free slots, up to
+ * @num_launch. A slot is reserved by 'launched' until the builder attaches
+ * its latch; it is released if the builder does not start in time.
+ */
+static void
+cudaProgramBuilderLaunch(int num_launch)
+{
+	TimestampTz	now = GetCurrentTimestamp();
+	int			i;
+
+	for (i=num_program_builders;
+		 i < max_program_builders && num_launch > 0;
+		 i++)
+	{
+		BackgroundWorker worker;
+		BackgroundWorkerHandle *handle;
+		TimestampTz	launched;
+
+		SpinLockAcquire(&pgcache_head->lock);
+		launched = pgbuilder_state->builders[i].launched;
+		if (pgbuilder_state->builders[i].latch != NULL ||
+			(launched != 0 &&
+			 !TimestampDifferenceExceeds(launched, now,
+										 PROGRAM_BUILDER_LAUNCH_TIMEOUT)))
+		{
+			SpinLockRelease(&pgcache_head->lock);
+			continue;
+		}
+		pgbuilder_state->builders[i].launched = now;
+		SpinLockRelease(&pgcache_head->lock);
+
+		memset(&worker, 0, sizeof(BackgroundWorker));
+		snprintf(worker.bgw_name, sizeof(worker.bgw_name),
+				 "PG-Strom Program Builder-%d", i);
+		worker.bgw_flags = BGWORKER_SHMEM_ACCESS;
+		worker.bgw_start_time = BgWorkerStart_PostmasterStart;
+		worker.bgw_restart_time = BGW_NEVER_RESTART;
+		snprintf(worker.bgw_library_name,
+				 BGW_MAXLEN, "pg_strom");
+		snprintf(worker.bgw_function_name,
+				 BGW_MAXLEN, "cudaProgramBuilderMain");
+		worker.bgw_main_arg = Int32GetDatum(i);
+
+		/* pending programs are built by the running builders, if no slot */
+		if (!RegisterDynamicBackgroundWorker(&worker, &handle))
+		{
+			SpinLockAcquire(&pgcache_head->lock);
+			pgbuilder_state->builders[i].launched = 0;
+			SpinLockRelease(&pgcache_head->lock);
+			elog(DEBUG1, "PG-Strom: unable to launch program builder-%d", i);
+			break;
+		}
+		num_launch--;
+	}
 }
 
+/*
+ * cudaProgramBuilderWakeUp
+ *
+ * It wakes up idle program builders as many as the pending programs, so
+ * number of the active builders follows the load of program build.
+ * If pending programs are more than the idle builders, it also launches
+ * dynamic builders up to pg_strom.max_program_builders.
+ * Builders already in progress will pick up the next pending program
+ * by themselves. Note that @num_pending is referenced without lock, just
+ * as a hint. Caller must enqueue the program under pgcache_head->lock
+ * prior to the wake-up, because builders clear 'busy' under the lock
+ * when they find no pending program.
+ */
 static void
 cudaProgramBuilderWakeUp(bool error_if_no_builders)
 {
 	int		i, count = 0;
+	int		num_pending = Max(pgcache_head->num_pending, 1);
 
-	for (i=0; i < num_program_builders; i++)
+	for (i=0; i < max_program_builders; i++)
 	{
 		volatile Latch *latch = pgbuilder_state->builders[i].latch;
 
-		if (latch)
+		if (!latch)
+			continue;
+		if (num_pending > 0 && !pgbuilder_state->builders[i].busy)
 		{
 			SetLatch(latch);
-			count++;
+			num_pending--;
 		}
+		count++;
 	}
+	if (num_pending > 0)
+		cudaProgramBuilderLaunch(num_pending);
 
 	if (error_if_no_builders && count == 0)
 		elog(ERROR, "PG-Strom: no active CUDA C program builder");
@@ -1588,6 +1887,577 @@ build_wrapper_libraries(const char *wrapper_filename,
 }
 #endif
 
+/*
+ * plan_has_gpu_programs
+ *
+ * It checks whether the plan tree contains any custom-scan node that
+ * requires GPU programs.
+ */
+static bool
+plan_has_gpu_programs(Plan *plan)
+{
+	ListCell   *lc;
+
+	if (!plan)
+		return false;
+	if (pgstrom_plan_is_gpuscan(plan) ||
+		pgstrom_plan_is_gpujoin(plan) ||
+		pgstrom_plan_is_gpupreagg(plan))
+		return true;
+
+	switch (nodeTag(plan))
+	{
+		case T_ModifyTable:
+			foreach (lc, ((ModifyTable *) plan)->plans)
+			{
+				if (plan_has_gpu_programs(lfirst(lc)))
+					return true;
+			}
+			break;
+		case T_Append:
+			foreach (lc, ((Append *) plan)->appendplans)
+			{
+				if (plan_has_gpu_programs(lfirst(lc)))
+					return true;
+			}
+			break;
+		case T_MergeAppend:
+			foreach (lc, ((MergeAppend *) plan)->mergeplans)
+			{
+				if (plan_has_gpu_programs(lfirst(lc)))
+					return true;
+			}
+			break;
+		case T_SubqueryScan:
+			if (plan_has_gpu_programs(((SubqueryScan *) plan)->subplan))
+				return true;
+			break;
+		case T_CustomScan:
+			foreach (lc, ((CustomScan *) plan)->custom_plans)
+			{
+				if (plan_has_gpu_programs(lfirst(lc)))
+					return true;
+			}
+			break;
+		default:
+			break;
+	}
+	return (plan_has_gpu_programs(plan->lefttree) ||
+			plan_has_gpu_programs(plan->righttree));
+}
+
+/*
+ * precompile_gpu_programs
+ *
+ * It initializes the executor in EXPLAIN-only mode for each statement of
+ * the supplied plan source (its generic plan), or of the supplied query
+ * (a plan built here). It looks up or enqueues the GPU programs to the
+ * program builders without waiting for completion, like EXPLAIN doing, so
+ * the first execution of the statement will find out the programs already
+ * built.
+ * Any errors are reported as WARNING, because pre-compile is just a hint.
+ * It returns true if any GPU programs are enqueued.
+ */
+static bool
+precompile_gpu_programs(CachedPlanSource *plansource,
+						Query *query, const char *query_string)
+{
+	MemoryContext	oldcxt = CurrentMemoryContext;
+	ResourceOwner	oldowner = CurrentResourceOwner;
+	volatile bool	retval = false;
+
+	BeginInternalSubTransaction(NULL);
+	MemoryContextSwitchTo(oldcxt);
+	PG_TRY();
+	{
+		CachedPlan *cplan = NULL;
+		List	   *stmt_list;
+		ListCell   *lc;
+
+		PushActiveSnapshot(GetTransactionSnapshot());
+		if (plansource)
+		{
+			cplan = GetCachedPlan(plansource, NULL, false, NULL);
+			stmt_list = cplan->stmt_list;
+		}
+		else
+		{
+			/* query tree is owned by the caller */
+			stmt_list = pg_plan_queries(QueryRewrite(copyObject(query)),
+#if PG_VERSION_NUM < 100000
+										0,
+#else
+										CURSOR_OPT_PARALLEL_OK,
+#endif
+										NULL);
+		}
+
+		foreach (lc, stmt_list)
+		{
+			PlannedStmt *pstmt = (PlannedStmt *) lfirst(lc);
+			QueryDesc  *qdesc;
+			ListCell   *cell;
+			bool		has_gpu_programs;
+
+			if (!IsA(pstmt, PlannedStmt) ||
+				pstmt->commandType == CMD_UTILITY)
+				continue;
+			has_gpu_programs = plan_has_gpu_programs(pstmt->planTree);
+			foreach (cell, pstmt->subplans)
+			{
+				if (!has_gpu_programs)
+					has_gpu_programs = plan_has_gpu_programs(lfirst(cell));
+			}
+			if (!has_gpu_programs)
+				continue;
+
+			qdesc = CreateQueryDesc(pstmt,
+									query_string,
+									GetActiveSnapshot(),
+									InvalidSnapshot,
+									None_Receiver,
+									NULL,
+									NULL,
+									0);
+			ExecutorStart(qdesc, EXEC_FLAG_EXPLAIN_ONLY);
+			ExecutorEnd(qdesc);
+			FreeQueryDesc(qdesc);
+			retval = true;
+		}
+		if (cplan)
+			ReleaseCachedPlan(cplan, false);
+		PopActiveSnapshot();
+
+		ReleaseCurrentSubTransaction();
+		MemoryContextSwitchTo(oldcxt);
+		CurrentResourceOwner = oldowner;
+	}
+	PG_CATCH();
+	{
+		ErrorData  *edata;
+
+		MemoryContextSwitchTo(oldcxt);
+		edata = CopyErrorData();
+		FlushErrorState();
+
+		RollbackAndReleaseCurrentSubTransaction();
+		MemoryContextSwitchTo(oldcxt);
+		CurrentResourceOwner = oldowner;
+
+		ereport(WARNING,
+				(errmsg("failed on pre-compile of GPU programs: %s",
+						edata->message)));
+		FreeErrorData(edata);
+		retval = false;
+	}
+	PG_END_TRY();
+
+	return retval;
+}
+
+/*
+ * pgstrom_post_parse_analyze
+ *
+ * It kicks asynchronous build of GPU programs when a statement is prepared,
+ * if pg_strom.precompile_on_prepare is enabled. Both of PREPARE command and
+ * Parse message of the extended query protocol analyze the statement with
+ * variable parameters, then save it to the plan cache. We pick up them here,
+ * because the plan cache has no hook on its own.
+ *
+ * The plan cache uses custom plans for the first five executions of the
+ * statement with parameters, but the plan built here has no parameter
+ * values, so it is the generic plan. Both of Const and extern Param are
+ * referenced through KPARAM_n in the kernel source, so the custom plans
+ * look up the same GPU programs as the generic plan enqueued here.
+ *
+ * Note that the unnamed statement of the extended query protocol is also
+ * pre-compiled, although it is usually executed next to the Parse message.
+ */
+static void
+pgstrom_post_parse_analyze(ParseState *pstate, Query *query)
+{
+	if (post_parse_analyze_next)
+		post_parse_analyze_next(pstate, query);
+
+	if (!pgstrom_enabled ||
+		!pgstrom_precompile_on_prepare ||
+		query->commandType == CMD_UTILITY)
+		return;
+	/*
+	 * MEMO: only parse_analyze_varparams() set up p_coerce_param_hook;
+	 * used by PREPARE command and Parse message only.
+	 */
+	if (!pstate->p_coerce_param_hook)
+		return;
+
+	precompile_gpu_programs(NULL, query, pstate->p_sourcetext);
+}
+
+/*
+ * pgstrom_program_cache_prewarm
+ *
+ * It kicks asynchronous build of GPU programs for the supplied query text,
+ * with optional parameter types. It returns number of the statements which
+ * enqueued GPU programs.
+ */
+Datum
+pgstrom_program_cache_prewarm(PG_FUNCTION_ARGS)
+{
+	char	   *query_string = text_to_cstring(PG_GETARG_TEXT_PP(0));
+	ArrayType  *argtypes_array = PG_GETARG_ARRAYTYPE_P(1);
+	Oid		   *argtypes = NULL;
+	int			nargs = 0;
+	int			count = 0;
+	SPIPlanPtr	plan;
+	ListCell   *lc;
+
+	if (ARR_NDIM(argtypes_array) > 1 ||
+		ARR_HASNULL(argtypes_array) ||
+		ARR_ELEMTYPE(argtypes_array) != REGTYPEOID)
+		elog(ERROR, "argument types must be 1-dimensional regtype array");
+	if (ARR_NDIM(argtypes_array) == 1)
+	{
+		nargs = ARR_DIMS(argtypes_array)[0];
+		argtypes = (Oid *) ARR_DATA_PTR(argtypes_array);
+	}
+
+	if (SPI_connect() != SPI_OK_CONNECT)
+		elog(ERROR, "SPI_connect failed");
+	plan = SPI_prepare(query_string, nargs, argtypes);
+	if (!plan)
+		elog(ERROR, "SPI_prepare failed: %s",
+			 SPI_result_code_string(SPI_result));
+	foreach (lc, SPI_plan_get_plan_sources(plan))
+	{
+		if (precompile_gpu_programs(lfirst(lc), NULL, query_string))
+			count++;
+	}
+	SPI_freeplan(plan);
+	SPI_finish();
+
+	PG_RETURN_INT32(count);
+}
+PG_FUNCTION_INFO_V1(pgstrom_program_cache_prewarm);
+
+/*
+ * pgstrom_program_cache_info
+ *
+ * It returns statistics of the GPU program cache, to observe how much
+ * GPU programs are reused across queries, and load of the builders.
+ */
+Datum
+pgstrom_program_cache_info(PG_FUNCTION_ARGS)
+{
+	TupleDesc	tupdesc;
+	Datum		values[12];
+	bool		isnull[12];
+	HeapTuple	tuple;
+	dlist_iter	iter;
+	cl_ulong	lookups;
+	cl_ulong	hits;
+	cl_ulong	varlena_misses;
+	cl_ulong	builds;
+	cl_ulong	queue_usec;
+	cl_ulong	build_usec;
+	TimestampTz	stat_reset;
+	int64		num_entries = 0;
+	int64		num_pending;
+	int64		num_building;
+	int64		total_size = 0;
+
+	tupdesc = CreateTemplateTupleDesc(12, false);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 1, "lookups",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 2, "hits",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 3, "hit_ratio",
+					   FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 4, "varlena_misses",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 5, "num_entries",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 6, "num_pending",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 7, "num_building",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 8, "num_builds",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 9, "avg_queue_time",
+					   FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 10, "avg_build_time",
+					   FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 11, "total_size",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 12, "stats_reset",
+					   TIMESTAMPTZOID, -1, 0);
+	tupdesc = BlessTupleDesc(tupdesc);
+
+	SpinLockAcquire(&pgcache_head->lock);
+	lookups        = pgcache_head->stat_lookups;
+	hits           = pgcache_head->stat_hits;
+	varlena_misses = pgcache_head->stat_varlena_misses;
+	builds         = pgcache_head->stat_builds;
+	queue_usec     = pgcache_head->stat_queue_usec;
+	build_usec     = pgcache_head->stat_build_usec;
+	stat_reset     = pgcache_head->stat_reset;
+	num_pending    = pgcache_head->num_pending;
+	num_building   = pgcache_head->num_building;
+	dlist_foreach(iter, &pgcache_head->lru_list)
+	{
+		program_cache_entry *entry
+			= dlist_container(program_cache_entry, lru_chain, iter.cur);
+
+		num_entries++;
+		total_size += (1UL << entry->mclass);
+	}
+	SpinLockRelease(&pgcache_head->lock);
+
+	memset(isnull, 0, sizeof(isnull));
+	values[0] = Int64GetDatum(lookups);
+	values[1] = Int64GetDatum(hits);
+	if (lookups == 0)
+	{
+		isnull[2] = true;
+		values[2] = 0;
+	}
+	else
+		values[2] = Float8GetDatum((double) hits / (double) lookups);
+	values[3] = Int64GetDatum(varlena_misses);
+	values[4] = Int64GetDatum(num_entries);
+	values[5] = Int64GetDatum(num_pending);
+	values[6] = Int64GetDatum(num_building);
+	values[7] = Int64GetDatum(builds);
+	if (builds == 0)
+	{
+		isnull[8] = true;
+		isnull[9] = true;
+		values[8] = 0;
+		values[9] = 0;
+	}
+	else
+	{
+		/* in milliseconds */
+		values[8] = Float8GetDatum((double) queue_usec /
+								   (1000.0 * (double) builds));
+		values[9] = Float8GetDatum((double) build_usec /
+								   (1000.0 * (double) builds));
+	}
+	values[10] = Int64GetDatum(total_size);
+	values[11] = TimestampTzGetDatum(stat_reset);
+
+	tuple = heap_form_tuple(tupdesc, values, isnull);
+	PG_RETURN_DATUM(HeapTupleGetDatum(tuple));
+}
+PG_FUNCTION_INFO_V1(pgstrom_program_cache_info);
+
+/*
+ * pgstrom_program_cache_reset
+ *
+ * It resets statistics of the GPU program cache. Programs already built
+ * are kept as is.
+ */
+Datum
+pgstrom_program_cache_reset(PG_FUNCTION_ARGS)
+{
+	TimestampTz	now = GetCurrentTimestamp();
+
+	SpinLockAcquire(&pgcache_head->lock);
+	pgcache_head->stat_lookups = 0;
+	pgcache_head->stat_hits = 0;
+	pgcache_head->stat_varlena_misses = 0;
+	pgcache_head->stat_builds = 0;
+	pgcache_head->stat_queue_usec = 0;
+	pgcache_head->stat_build_usec = 0;
+	pgcache_head->stat_reset = now;
+	SpinLockRelease(&pgcache_head->lock);
+
+	PG_RETURN_VOID();
+}
+PG_FUNCTION_INFO_V1(pgstrom_program_cache_reset);
+
+/*
+ * pgstrom_program_build_info
+ *
+ * It returns build state, priority and latency of the GPU programs in
+ * the program cache.
+ */
+typedef struct
+{
+	ProgramId	program_id;
+	int			state;
+	int			priority;
+	size_t		srclen;
+	TimestampTz	enqueue_time;
+	TimestampTz	build_start;
+	TimestampTz	build_end;
+} program_build_info;
+
+#define PGCACHE_BUILD_STATE__PENDING	0
+#define PGCACHE_BUILD_STATE__BUILDING	1
+#define PGCACHE_BUILD_STATE__BUILT		2
+#define PGCACHE_BUILD_STATE__FAILED		3
+
+Datum
+pgstrom_program_build_info(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *fncxt;
+	program_build_info *pb_info;
+	List	   *pb_list;
+	Datum		values[8];
+	bool		isnull[8];
+	HeapTuple	tuple;
+	TimestampTz	now;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc		tupdesc;
+		MemoryContext	oldcxt;
+		dlist_iter		iter;
+		program_cache_entry *entry;
+		program_build_info *pb_array = NULL;
+		int				i, nitems = 0;
+
+		fncxt = SRF_FIRSTCALL_INIT();
+		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(8, false);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "program_id",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "state",
+						   TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "priority",
+						   TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "source_length",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "enqueue_time",
+						   TIMESTAMPTZOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "build_start",
+						   TIMESTAMPTZOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 7, "queue_time",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 8, "build_time",
+						   FLOAT8OID, -1, 0);
+		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
+
+		/*
+		 * collect the current state of the program cache; no memory
+		 * allocation under the spinlock
+		 */
+		for (;;)
+		{
+			int		count = 0;
+
+			SpinLockAcquire(&pgcache_head->lock);
+			dlist_foreach(iter, &pgcache_head->lru_list)
+				count++;
+			if (pb_array && count <= nitems)
+			{
+				nitems = 0;
+				dlist_foreach(iter, &pgcache_head->lru_list)
+				{
+					entry = dlist_container(program_cache_entry,
+											lru_chain, iter.cur);
+					pb_info = &pb_array[nitems++];
+					pb_info->program_id   = entry->program_id;
+					if (entry->ptx_image == CUDA_PROGRAM_BUILD_FAILURE)
+						pb_info->state = PGCACHE_BUILD_STATE__FAILED;
+					else if (entry->ptx_image)
+						pb_info->state = PGCACHE_BUILD_STATE__BUILT;
+					else if (entry->build_chain.prev ||
+							 entry->build_chain.next)
+						pb_info->state = PGCACHE_BUILD_STATE__PENDING;
+					else
+						pb_info->state = PGCACHE_BUILD_STATE__BUILDING;
+					pb_info->priority     = entry->build_priority;
+					pb_info->srclen       = entry->kern_srclen;
+					pb_info->enqueue_time = entry->enqueue_time;
+					pb_info->build_start  = entry->build_start;
+					pb_info->build_end    = entry->build_end;
+				}
+				SpinLockRelease(&pgcache_head->lock);
+				break;
+			}
+			SpinLockRelease(&pgcache_head->lock);
+			if (pb_array)
+				pfree(pb_array);
+			nitems = count + 10;
+			pb_array = palloc(sizeof(program_build_info) * nitems);
+		}
+
+		pb_list = NIL;
+		for (i=0; i < nitems; i++)
+			pb_list = lappend(pb_list, &pb_array[i]);
+		fncxt->user_fctx = pb_list;
+		MemoryContextSwitchTo(oldcxt);
+	}
+	fncxt = SRF_PERCALL_SETUP();
+	pb_list = (List *)fncxt->user_fctx;
+
+	if (pb_list == NIL)
+		SRF_RETURN_DONE(fncxt);
+	pb_info = linitial(pb_list);
+	fncxt->user_fctx = list_delete_first(pb_list);
+
+	memset(isnull, 0, sizeof(isnull));
+	now = GetCurrentTimestamp();
+	values[0] = Int64GetDatum(pb_info->program_id);
+	switch (pb_info->state)
+	{
+		case PGCACHE_BUILD_STATE__PENDING:
+			values[1] = CStringGetTextDatum("pending");
+			break;
+		case PGCACHE_BUILD_STATE__BUILDING:
+			values[1] = CStringGetTextDatum("building");
+			break;
+		case PGCACHE_BUILD_STATE__BUILT:
+			values[1] = CStringGetTextDatum("built");
+			break;
+		default:
+			values[1] = CStringGetTextDatum("failed");
+			break;
+	}
+	switch (pb_info->priority)
+	{
+		case PGCACHE_BUILD_PRIO__WAIT:
+			values[2] = CStringGetTextDatum("wait");
+			break;
+		case PGCACHE_BUILD_PRIO__NORMAL:
+			values[2] = CStringGetTextDatum("normal");
+			break;
+		default:
+			values[2] = CStringGetTextDatum("background");
+			break;
+	}
+	values[3] = Int64GetDatum(pb_info->srclen);
+	values[4] = TimestampTzGetDatum(pb_info->enqueue_time);
+	if (pb_info->state == PGCACHE_BUILD_STATE__PENDING)
+	{
+		/* still waiting for builders */
+		isnull[5] = true;
+		isnull[7] = true;
+		values[5] = 0;
+		values[7] = 0;
+		values[6] = Float8GetDatum((double)(now - pb_info->enqueue_time)
+								   / 1000.0);
+	}
+	else
+	{
+		values[5] = TimestampTzGetDatum(pb_info->build_start);
+		values[6] = Float8GetDatum((double)(pb_info->build_start -
+											pb_info->enqueue_time) / 1000.0);
+		if (pb_info->state == PGCACHE_BUILD_STATE__BUILDING)
+			values[7] = Float8GetDatum((double)(now - pb_info->build_start)
+									   / 1000.0);
+		else
+			values[7] = Float8GetDatum((double)(pb_info->build_end -
+												pb_info->build_start)
+									   / 1000.0);
+	}
+	tuple = heap_form_tuple(fncxt->tuple_desc, values, isnull);
+	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
+}
+PG_FUNCTION_INFO_V1(pgstrom_program_build_info);
+
 static void
 pgstrom_startup_cuda_program(void)
 {
@@ -1615,10 +2485,12 @@ pgstrom_startup_cuda_program(void)
 		dlist_init(&pgcache_head->hash_slots[i]);
 	}
 	dlist_init(&pgcache_head->lru_list);
-	dlist_init(&pgcache_head->build_list);
+	for (i=0; i < PGCACHE_BUILD_PRIO__NUMS; i++)
+		dlist_init(&pgcache_head->build_list[i]);
 	dlist_init(&pgcache_head->addr_list);
 	for (i=0; i <= PGCACHE_CHUNKSZ_MAX_BIT; i++)
 		dlist_init(&pgcache_head->free_list[i]);
+	pgcache_head->stat_reset = GetCurrentTimestamp();
 
 	length = ((size_t)program_cache_size_kb << 10);
 	offset = 0;
@@ -1643,7 +2515,7 @@ pgstrom_startup_cuda_program(void)
 
 	/* initialize program builder state */
 	length = offsetof(program_builder_state,
-					  builders[num_program_builders]);
+					  builders[max_program_builders]);
 	pgbuilder_state = ShmemInitStruct("PG-Strom Program Builders State",
 									  length, &found);
 	if (found)
@@ -1684,6 +2556,23 @@ pgstrom_init_cuda_program(void)
 							GUC_NOT_IN_SAMPLE,
 							NULL, NULL, NULL);
 
+	/*
+	 * max number of worker process to build CUDA program, including
+	 * the ones launched on demand
+	 */
+	DefineCustomIntVariable("pg_strom.max_program_builders",
+							"max number of workers to build CUDA C programs",
+							NULL,
+							&max_program_builders,
+							4,
+							1,
+							INT_MAX,
+							PGC_POSTMASTER,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+	if (max_program_builders < num_program_builders)
+		max_program_builders = num_program_builders;
+
 	/*
 	 * Enables debug option on GPU kernel build
 	 */
@@ -1696,6 +2585,18 @@ pgstrom_init_cuda_program(void)
 							 GUC_NOT_IN_SAMPLE | GUC_SUPERUSER_ONLY,
 							 NULL, NULL, NULL);
 
+	/*
+	 * Enables asynchronous build of GPU programs on PREPARE or Parse message
+	 */
+	DefineCustomBoolVariable("pg_strom.precompile_on_prepare",
+							 "Enables asynchronous GPU program build on preparation of statements",
+							 NULL,
+							 &pgstrom_precompile_on_prepare,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+
 	/* setup cuda_xxxx.h file pathname */
 #define PGSTROM_CUDA(x) \
 	pgstrom_cuda_##x##_pathname = PGSHAREDIR "/extension/cuda_" #x ".h";
@@ -1707,6 +2608,9 @@ pgstrom_init_cuda_program(void)
 						   ((size_t)program_cache_size_kb << 10));
 	shmem_startup_next = shmem_startup_hook;
 	shmem_startup_hook = pgstrom_startup_cuda_program;
+	/* hook for pre-compile on PREPARE */
+	post_parse_analyze_next = post_parse_analyze_hook;
+	post_parse_analyze_hook = pgstrom_post_parse_analyze;
 
 	/* register CUDA C program builders */
 	for (i=0; i < num_program_builders; i++)
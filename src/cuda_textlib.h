@@ -17,6 +17,58 @@
  */
 #ifndef CUDA_TEXTLIB_H
 #define CUDA_TEXTLIB_H
+
+/*
+ * kern_regex_dfa
+ *
+ * DFA (deterministic finite automaton) of a regular expression, compiled
+ * at the plan time, and delivered on the kern_parambuf as bytea.
+ * Input bytes are mapped to the byte-classes, then the next state is
+ * looked up from the transition table; trans[state * nclasses + class].
+ * The flags of the states follow the transition table.
+ */
+typedef struct
+{
+	cl_uint		vl_len_;		/* varlena header (only 4B) */
+	cl_ushort	nstates;		/* number of the DFA states */
+	cl_ushort	nclasses;		/* number of the byte-classes */
+	cl_ushort	start;			/* initial state */
+	cl_ushort	__padding;
+	cl_uchar	classes[256];	/* byte -> byte-class */
+	cl_ushort	trans[FLEXIBLE_ARRAY_MEMBER];
+} kern_regex_dfa;
+
+#define REGEX_DFA__MATCHED		0x01	/* pattern already matched */
+#define REGEX_DFA__ACCEPT_EOS	0x02	/* matched, if end of string */
+#define REGEX_DFA__DEAD			0x04	/* never match any more */
+
+#define REGEX_DFA_FLAGS(dfa)									\
+	((cl_uchar *)((dfa)->trans + (dfa)->nstates * (dfa)->nclasses))
+#define REGEX_DFA_LENGTH(nstates,nclasses)						\
+	(offsetof(kern_regex_dfa, trans[(nstates) * (nclasses)]) +	\
+	 sizeof(cl_uchar) * (nstates))
+
+/*
+ * regex_dfa_exec - returns true if the string contains a substring
+ * which matches the regular expression
+ */
+STATIC_INLINE(cl_bool)
+regex_dfa_exec(const kern_regex_dfa *dfa, const char *str, cl_uint len)
+{
+	const cl_uchar *flags = REGEX_DFA_FLAGS(dfa);
+	const cl_uchar *pos = (const cl_uchar *) str;
+	const cl_uchar *end = pos + len;
+	cl_uint		state = dfa->start;
+	cl_uint		nclasses = dfa->nclasses;
+
+	while (pos < end &&
+		   (flags[state] & (REGEX_DFA__MATCHED | REGEX_DFA__DEAD)) == 0)
+	{
+		state = dfa->trans[state * nclasses + dfa->classes[*pos++]];
+	}
+	return (flags[state] & REGEX_DFA__ACCEPT_EOS) != 0;
+}
+
 #ifdef __CUDACC__
 
 #define CHECK_VARLENA_ARGS(kcxt,result,arg1,arg2)				\
@@ -110,6 +162,7 @@ bpchar_compare(kern_context *kcxt, varlena *arg1, varlena *arg2)
 	return 0;
 }
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__bpchareq)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_bpchareq(kern_context *kcxt, pg_bpchar_t arg1, pg_bpchar_t arg2)
 {
@@ -135,7 +188,9 @@ pgfn_bpchareq(kern_context *kcxt, pg_bpchar_t arg1, pg_bpchar_t arg2)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__bpcharne)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_bpcharne(kern_context *kcxt, pg_bpchar_t arg1, pg_bpchar_t arg2)
 {
@@ -161,7 +216,9 @@ pgfn_bpcharne(kern_context *kcxt, pg_bpchar_t arg1, pg_bpchar_t arg2)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__bpcharlt)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_bpcharlt(kern_context *kcxt, pg_bpchar_t arg1, pg_bpchar_t arg2)
 {
@@ -187,7 +244,9 @@ pgfn_bpcharlt(kern_context *kcxt, pg_bpchar_t arg1, pg_bpchar_t arg2)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__bpcharle)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_bpcharle(kern_context *kcxt, pg_bpchar_t arg1, pg_bpchar_t arg2)
 {
@@ -213,7 +272,9 @@ pgfn_bpcharle(kern_context *kcxt, pg_bpchar_t arg1, pg_bpchar_t arg2)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__bpchargt)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_bpchargt(kern_context *kcxt, pg_bpchar_t arg1, pg_bpchar_t arg2)
 {
@@ -239,7 +300,9 @@ pgfn_bpchargt(kern_context *kcxt, pg_bpchar_t arg1, pg_bpchar_t arg2)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__bpcharge)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_bpcharge(kern_context *kcxt, pg_bpchar_t arg1, pg_bpchar_t arg2)
 {
@@ -265,6 +328,7 @@ pgfn_bpcharge(kern_context *kcxt, pg_bpchar_t arg1, pg_bpchar_t arg2)
 	}
 	return result;
 }
+#endif
 
 STATIC_FUNCTION(pg_int4_t)
 pgfn_type_compare(kern_context *kcxt, pg_bpchar_t arg1, pg_bpchar_t arg2)
@@ -290,6 +354,7 @@ pgfn_type_compare(kern_context *kcxt, pg_bpchar_t arg1, pg_bpchar_t arg2)
 	return result;
 }
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__bpcharlen)
 STATIC_FUNCTION(pg_int4_t)
 pgfn_bpcharlen(kern_context *kcxt, pg_bpchar_t arg1)
 {
@@ -303,6 +368,7 @@ pgfn_bpcharlen(kern_context *kcxt, pg_bpchar_t arg1)
 		result.value = bpchar_truelen(arg1.value);
 	return result;
 }
+#endif
 
 /* ----------------------------------------------------------------
  *
@@ -340,6 +406,7 @@ text_compare(kern_context *kcxt, varlena *arg1, varlena *arg2)
 	return 0;
 }
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__texteq)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_texteq(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 {
@@ -365,7 +432,9 @@ pgfn_texteq(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__textne)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_textne(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 {
@@ -391,7 +460,9 @@ pgfn_textne(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__text_lt)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_text_lt(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 {
@@ -417,7 +488,9 @@ pgfn_text_lt(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__text_le)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_text_le(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 {
@@ -443,7 +516,9 @@ pgfn_text_le(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__text_gt)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_text_gt(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 {
@@ -469,7 +544,9 @@ pgfn_text_gt(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__text_ge)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_text_ge(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 {
@@ -495,6 +572,7 @@ pgfn_text_ge(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 	}
 	return result;
 }
+#endif
 
 STATIC_FUNCTION(pg_int4_t)
 pgfn_type_compare(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
@@ -520,6 +598,7 @@ pgfn_type_compare(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 	return result;
 }
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__textlen)
 STATIC_FUNCTION(pg_int4_t)
 pgfn_textlen(kern_context *kcxt, pg_text_t arg1)
 {
@@ -533,7 +612,9 @@ pgfn_textlen(kern_context *kcxt, pg_text_t arg1)
 		result.value = toast_raw_datum_size(kcxt, arg1.value) - VARHDRSZ;
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__textcat)
 STATIC_FUNCTION(pg_text_t)
 pgfn_textcat(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 {
@@ -578,6 +659,7 @@ pgfn_textcat(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 
 	return result;
 }
+#endif
 
 /*
  * varchar(*) type definition
@@ -823,8 +905,16 @@ GetCharLowerCase(cl_char c)
 		RECURSIVE_RETURN(LIKE_ABORT);									\
 	}
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) ||	\
+	defined(DEVFUNC_NEEDS__textlike) ||	\
+	defined(DEVFUNC_NEEDS__textnlike)
 GENERIC_MATCH_TEXT_TEMPLATE(GenericMatchText, GetCharNormal)
+#endif
+#if !defined(PGSTROM_DEVFUNC_PRUNED) ||	\
+	defined(DEVFUNC_NEEDS__texticlike) ||	\
+	defined(DEVFUNC_NEEDS__texticnlike)
 GENERIC_MATCH_TEXT_TEMPLATE(GenericCaseMatchText, GetCharLowerCase)
+#endif
 
 #undef GetCharNormal
 #undef GetCharLowerCase
@@ -833,6 +923,7 @@ GENERIC_MATCH_TEXT_TEMPLATE(GenericCaseMatchText, GetCharLowerCase)
 #undef RECURSIVE_RETURN
 #undef VIRTUAL_STACK_MAX_DEPTH
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__textlike)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_textlike(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 {
@@ -863,7 +954,9 @@ pgfn_textlike(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__textnlike)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_textnlike(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 {
@@ -894,7 +987,9 @@ pgfn_textnlike(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__texticlike)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_texticlike(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 {
@@ -925,7 +1020,9 @@ pgfn_texticlike(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__texticnlike)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_texticnlike(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 {
@@ -956,11 +1053,45 @@ pgfn_texticnlike(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 	}
 	return result;
 }
+#endif
 
 #undef LIKE_TRUE
 #undef LIKE_FALSE
 #undef LIKE_ABORT
 
+/*
+ * Regular expression operators (~, !~, ~* and !~*) by DFA
+ *
+ * NOTE: it is not pruned, because the code generator calls this function
+ * without devfunc_info.
+ */
+STATIC_FUNCTION(pg_bool_t)
+pgfn_textregex_dfa(kern_context *kcxt, pg_text_t arg1, pg_bytea_t arg2,
+				   cl_bool negate)
+{
+	pg_bool_t	result;
+
+	result.isnull = arg1.isnull | arg2.isnull;
+	if (!result.isnull)
+	{
+		if (VARATT_IS_COMPRESSED(arg1.value) ||
+			VARATT_IS_EXTERNAL(arg1.value))
+		{
+			result.isnull = true;
+			STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
+		}
+		else
+		{
+			cl_bool		matched
+				= regex_dfa_exec((kern_regex_dfa *) arg2.value,
+								 VARDATA_ANY(arg1.value),
+								 VARSIZE_ANY_EXHDR(arg1.value));
+			result.value = (negate ? !matched : matched);
+		}
+	}
+	return result;
+}
+
 
 
 #else	/* __CUDACC__ */
@@ -1549,11 +1549,90 @@ interval_justify_hours(Interval span)
 	return result;
 }
 
+/*
+ * Dependencies between the device functions below
+ *
+ * Once PGSTROM_DEVFUNC_PRUNED is defined, only the device functions
+ * tracked by the code generator (DEVFUNC_NEEDS__xxx) are built.
+ * Functions invoked by other device functions must be also kept.
+ */
+#ifdef PGSTROM_DEVFUNC_PRUNED
+#if defined(DEVFUNC_NEEDS__timedate_pl)
+#define DEVFUNC_NEEDS__datetime_pl
+#endif
+#if defined(DEVFUNC_NEEDS__timestamptz_eq_date)
+#define DEVFUNC_NEEDS__date_eq_timestamptz
+#endif
+#if defined(DEVFUNC_NEEDS__timestamptz_le_date)
+#define DEVFUNC_NEEDS__date_ge_timestamptz
+#endif
+#if defined(DEVFUNC_NEEDS__timestamptz_lt_date)
+#define DEVFUNC_NEEDS__date_gt_timestamptz
+#endif
+#if defined(DEVFUNC_NEEDS__timestamptz_ge_date)
+#define DEVFUNC_NEEDS__date_le_timestamptz
+#endif
+#if defined(DEVFUNC_NEEDS__timestamptz_gt_date)
+#define DEVFUNC_NEEDS__date_lt_timestamptz
+#endif
+#if defined(DEVFUNC_NEEDS__timestamptz_ne_date)
+#define DEVFUNC_NEEDS__date_ne_timestamptz
+#endif
+#if defined(DEVFUNC_NEEDS__integer_pl_date)
+#define DEVFUNC_NEEDS__date_pli
+#endif
+#if defined(DEVFUNC_NEEDS__date_cmp_timestamp) ||	\
+	defined(DEVFUNC_NEEDS__date_eq_timestamp) ||	\
+	defined(DEVFUNC_NEEDS__date_ge_timestamp) ||	\
+	defined(DEVFUNC_NEEDS__date_gt_timestamp) ||	\
+	defined(DEVFUNC_NEEDS__date_le_timestamp) ||	\
+	defined(DEVFUNC_NEEDS__date_lt_timestamp) ||	\
+	defined(DEVFUNC_NEEDS__date_ne_timestamp) ||	\
+	defined(DEVFUNC_NEEDS__datetime_pl) ||	\
+	defined(DEVFUNC_NEEDS__timestamp_cmp_date) ||	\
+	defined(DEVFUNC_NEEDS__timestamp_eq_date) ||	\
+	defined(DEVFUNC_NEEDS__timestamp_ge_date) ||	\
+	defined(DEVFUNC_NEEDS__timestamp_gt_date) ||	\
+	defined(DEVFUNC_NEEDS__timestamp_le_date) ||	\
+	defined(DEVFUNC_NEEDS__timestamp_lt_date) ||	\
+	defined(DEVFUNC_NEEDS__timestamp_ne_date)
+#define DEVFUNC_NEEDS__date_timestamp
+#endif
+#if defined(DEVFUNC_NEEDS__interval_mi)
+#define DEVFUNC_NEEDS__interval_pl
+#endif
+#if defined(DEVFUNC_NEEDS__timestamptz_eq_timestamp)
+#define DEVFUNC_NEEDS__timestamp_eq_timestamptz
+#endif
+#if defined(DEVFUNC_NEEDS__timestamptz_le_timestamp)
+#define DEVFUNC_NEEDS__timestamp_ge_timestamptz
+#endif
+#if defined(DEVFUNC_NEEDS__timestamptz_lt_timestamp)
+#define DEVFUNC_NEEDS__timestamp_gt_timestamptz
+#endif
+#if defined(DEVFUNC_NEEDS__timestamptz_ge_timestamp)
+#define DEVFUNC_NEEDS__timestamp_le_timestamptz
+#endif
+#if defined(DEVFUNC_NEEDS__timestamptz_gt_timestamp)
+#define DEVFUNC_NEEDS__timestamp_lt_timestamptz
+#endif
+#if defined(DEVFUNC_NEEDS__timestamptz_ne_timestamp)
+#define DEVFUNC_NEEDS__timestamp_ne_timestamptz
+#endif
+#if defined(DEVFUNC_NEEDS__timestamptz_mi_interval)
+#define DEVFUNC_NEEDS__timestamptz_pl_interval
+#endif
+#if defined(DEVFUNC_NEEDS__timetz_mi_interval)
+#define DEVFUNC_NEEDS__timetz_pl_interval
+#endif
+#endif	/* PGSTROM_DEVFUNC_PRUNED */
+
 /* ---------------------------------------------------------------
  *
  * Type cast functions
  *
  * --------------------------------------------------------------- */
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamp_date)
 STATIC_FUNCTION(pg_date_t)
 pgfn_timestamp_date(kern_context *kcxt, pg_timestamp_t arg1)
 {
@@ -1586,10 +1665,12 @@ pgfn_timestamp_date(kern_context *kcxt, pg_timestamp_t arg1)
 	}
 	return result;
 }
+#endif
 
 /*
  * Data cast functions related to timezonetz
  */
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamptz_date)
 STATIC_FUNCTION(pg_date_t)
 pgfn_timestamptz_date(kern_context *kcxt, pg_timestamptz_t arg1)
 {
@@ -1623,7 +1704,9 @@ pgfn_timestamptz_date(kern_context *kcxt, pg_timestamptz_t arg1)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timetz_time)
 STATIC_FUNCTION(pg_time_t)
 pgfn_timetz_time(kern_context *kcxt, pg_timetz_t arg1)
 {
@@ -1638,7 +1721,9 @@ pgfn_timetz_time(kern_context *kcxt, pg_timetz_t arg1)
 
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamp_time)
 STATIC_FUNCTION(pg_time_t)
 pgfn_timestamp_time(kern_context *kcxt, pg_timestamp_t arg1)
 {
@@ -1666,7 +1751,9 @@ pgfn_timestamp_time(kern_context *kcxt, pg_timestamp_t arg1)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamptz_time)
 STATIC_FUNCTION(pg_time_t)
 pgfn_timestamptz_time(kern_context *kcxt, pg_timestamptz_t arg1)
 {
@@ -1695,7 +1782,9 @@ pgfn_timestamptz_time(kern_context *kcxt, pg_timestamptz_t arg1)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__time_timetz)
 STATIC_FUNCTION(pg_timetz_t)
 pgfn_time_timetz(kern_context *kcxt, pg_time_t arg1)
 {
@@ -1720,7 +1809,9 @@ pgfn_time_timetz(kern_context *kcxt, pg_time_t arg1)
 
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamptz_timetz)
 STATIC_FUNCTION(pg_timetz_t)
 pgfn_timestamptz_timetz(kern_context *kcxt, pg_timestamptz_t arg1)
 {
@@ -1748,6 +1839,7 @@ pgfn_timestamptz_timetz(kern_context *kcxt, pg_timestamptz_t arg1)
 
 	return result;
 }
+#endif
 
 #ifdef NOT_USED
 STATIC_FUNCTION(pg_timetz_t)
@@ -1770,6 +1862,7 @@ pgfn_timetz_scale(kern_context *kcxt, pg_timetz_t arg1, pg_int4_t arg2)
 }
 #endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__date_timestamp)
 STATIC_FUNCTION(pg_timestamp_t)
 pgfn_date_timestamp(kern_context *kcxt, pg_date_t arg1)
 {
@@ -1803,7 +1896,9 @@ pgfn_date_timestamp(kern_context *kcxt, pg_date_t arg1)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamptz_timestamp)
 STATIC_FUNCTION(pg_timestamp_t)
 pgfn_timestamptz_timestamp(kern_context *kcxt, pg_timestamptz_t arg1)
 {
@@ -1838,18 +1933,23 @@ pgfn_timestamptz_timestamp(kern_context *kcxt, pg_timestamptz_t arg1)
 
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__date_timestamptz)
 STATIC_FUNCTION(pg_timestamptz_t)
 pgfn_date_timestamptz(kern_context *kcxt, pg_date_t arg1)
 {
 	return date2timestamptz(kcxt, arg1);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamp_timestamptz)
 STATIC_FUNCTION(pg_timestamptz_t)
 pgfn_timestamp_timestamptz(kern_context *kcxt, pg_timestamp_t arg1)
 {
 	return timestamp2timestamptz(kcxt, arg1);
 }
+#endif
 
 /*
  * Simple comparison
@@ -1931,6 +2031,7 @@ pgfn_type_compare(kern_context *kcxt,
 /*
  * Time/Date operators
  */
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__date_pli)
 STATIC_FUNCTION(pg_date_t)
 pgfn_date_pli(kern_context *kcxt, pg_date_t arg1, pg_int4_t arg2)
 {
@@ -1948,7 +2049,9 @@ pgfn_date_pli(kern_context *kcxt, pg_date_t arg1, pg_int4_t arg2)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__date_mii)
 STATIC_FUNCTION(pg_date_t)
 pgfn_date_mii(kern_context *kcxt, pg_date_t arg1, pg_int4_t arg2)
 {
@@ -1966,7 +2069,9 @@ pgfn_date_mii(kern_context *kcxt, pg_date_t arg1, pg_int4_t arg2)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__date_mi)
 STATIC_FUNCTION(pg_int4_t)
 pgfn_date_mi(kern_context *kcxt, pg_date_t arg1, pg_date_t arg2)
 {
@@ -1986,7 +2091,9 @@ pgfn_date_mi(kern_context *kcxt, pg_date_t arg1, pg_date_t arg2)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__datetime_pl)
 STATIC_FUNCTION(pg_timestamp_t)
 pgfn_datetime_pl(kern_context *kcxt, pg_date_t arg1, pg_time_t arg2)
 {
@@ -2002,19 +2109,25 @@ pgfn_datetime_pl(kern_context *kcxt, pg_date_t arg1, pg_time_t arg2)
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__integer_pl_date)
 STATIC_FUNCTION(pg_date_t)
 pgfn_integer_pl_date(kern_context *kcxt, pg_int4_t arg1, pg_date_t arg2)
 {
 	return pgfn_date_pli(kcxt, arg2, arg1);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timedate_pl)
 STATIC_FUNCTION(pg_timestamp_t)
 pgfn_timedate_pl(kern_context *kcxt, pg_time_t arg1, pg_date_t arg2)
 {
 	return pgfn_datetime_pl(kcxt, arg2, arg1);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__time_mi_time)
 STATIC_FUNCTION(pg_interval_t)
 pgfn_time_mi_time(kern_context *kcxt, pg_time_t arg1, pg_time_t arg2)
 {
@@ -2032,7 +2145,9 @@ pgfn_time_mi_time(kern_context *kcxt, pg_time_t arg1, pg_time_t arg2)
 
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamp_mi)
 STATIC_FUNCTION(pg_interval_t)
 pgfn_timestamp_mi(kern_context *kcxt, pg_timestamp_t arg1, pg_timestamp_t arg2)
 {
@@ -2083,7 +2198,9 @@ pgfn_timestamp_mi(kern_context *kcxt, pg_timestamp_t arg1, pg_timestamp_t arg2)
 
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timetz_pl_interval)
 STATIC_FUNCTION(pg_timetz_t)
 pgfn_timetz_pl_interval(kern_context *kcxt,
 						pg_timetz_t arg1, pg_interval_t arg2)
@@ -2105,7 +2222,9 @@ pgfn_timetz_pl_interval(kern_context *kcxt,
 
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timetz_mi_interval)
 STATIC_FUNCTION(pg_timetz_t)
 pgfn_timetz_mi_interval(kern_context *kcxt, pg_timetz_t arg1, pg_interval_t arg2)
 {
@@ -2113,7 +2232,9 @@ pgfn_timetz_mi_interval(kern_context *kcxt, pg_timetz_t arg1, pg_interval_t arg2
 
 	return pgfn_timetz_pl_interval(kcxt, arg1, arg2);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamptz_pl_interval)
 STATIC_FUNCTION(pg_timestamptz_t)
 pgfn_timestamptz_pl_interval(kern_context *kcxt,
 							 pg_timestamptz_t arg1,
@@ -2202,7 +2323,9 @@ pgfn_timestamptz_pl_interval(kern_context *kcxt,
 
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamptz_mi_interval)
 STATIC_FUNCTION(pg_timestamptz_t)
 pgfn_timestamptz_mi_interval(kern_context *kcxt,
 							 pg_timestamptz_t arg1,
@@ -2214,7 +2337,9 @@ pgfn_timestamptz_mi_interval(kern_context *kcxt,
 
 	return pgfn_timestamptz_pl_interval(kcxt, arg1, arg2);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__interval_um)
 STATIC_FUNCTION(pg_interval_t)
 pgfn_interval_um(kern_context *kcxt, pg_interval_t arg1)
 {
@@ -2256,7 +2381,9 @@ pgfn_interval_um(kern_context *kcxt, pg_interval_t arg1)
 
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__interval_pl)
 STATIC_FUNCTION(pg_interval_t)
 pgfn_interval_pl(kern_context *kcxt, pg_interval_t arg1, pg_interval_t arg2)
 {
@@ -2300,7 +2427,9 @@ pgfn_interval_pl(kern_context *kcxt, pg_interval_t arg1, pg_interval_t arg2)
 
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__interval_mi)
 STATIC_FUNCTION(pg_interval_t)
 pgfn_interval_mi(kern_context *kcxt, pg_interval_t arg1, pg_interval_t arg2)
 {
@@ -2310,7 +2439,9 @@ pgfn_interval_mi(kern_context *kcxt, pg_interval_t arg1, pg_interval_t arg2)
 
 	return pgfn_interval_pl(kcxt, arg1, arg2);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__datetimetz_timestamptz)
 STATIC_FUNCTION(pg_timestamptz_t)
 pgfn_datetimetz_timestamptz(kern_context *kcxt, pg_date_t arg1, pg_timetz_t arg2)
 {
@@ -2333,10 +2464,12 @@ pgfn_datetimetz_timestamptz(kern_context *kcxt, pg_date_t arg1, pg_timetz_t arg2
 
 	return result;
 }
+#endif
 
 /*
  * Date comparison
  */
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__date_eq_timestamp)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_date_eq_timestamp(kern_context *kcxt,
 					   pg_date_t arg1, pg_timestamp_t arg2)
@@ -2353,7 +2486,9 @@ pgfn_date_eq_timestamp(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__date_ne_timestamp)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_date_ne_timestamp(kern_context *kcxt,
 					   pg_date_t arg1, pg_timestamp_t arg2)
@@ -2370,7 +2505,9 @@ pgfn_date_ne_timestamp(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__date_lt_timestamp)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_date_lt_timestamp(kern_context *kcxt,
 					   pg_date_t arg1, pg_timestamp_t arg2)
@@ -2387,7 +2524,9 @@ pgfn_date_lt_timestamp(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__date_le_timestamp)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_date_le_timestamp(kern_context *kcxt,
 					   pg_date_t arg1, pg_timestamp_t arg2)
@@ -2404,7 +2543,9 @@ pgfn_date_le_timestamp(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__date_gt_timestamp)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_date_gt_timestamp(kern_context *kcxt,
 					   pg_date_t arg1, pg_timestamp_t arg2)
@@ -2421,7 +2562,9 @@ pgfn_date_gt_timestamp(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__date_ge_timestamp)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_date_ge_timestamp(kern_context *kcxt,
 					   pg_date_t arg1, pg_timestamp_t arg2)
@@ -2438,7 +2581,9 @@ pgfn_date_ge_timestamp(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__date_cmp_timestamp)
 STATIC_FUNCTION(pg_int4_t)
 pgfn_date_cmp_timestamp(kern_context *kcxt,
 						pg_date_t arg1, pg_timestamp_t arg2)
@@ -2460,6 +2605,7 @@ pgfn_date_cmp_timestamp(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
 /*
  * Comparison between timetz
@@ -2527,6 +2673,7 @@ timetz_gt_internal(TimeTzADT arg1, TimeTzADT arg2)
 }
 
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timetz_eq)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timetz_eq(kern_context *kcxt, pg_timetz_t arg1, pg_timetz_t arg2)
 {
@@ -2543,7 +2690,9 @@ pgfn_timetz_eq(kern_context *kcxt, pg_timetz_t arg1, pg_timetz_t arg2)
 
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timetz_ne)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timetz_ne(kern_context *kcxt, pg_timetz_t arg1, pg_timetz_t arg2)
 {
@@ -2560,7 +2709,9 @@ pgfn_timetz_ne(kern_context *kcxt, pg_timetz_t arg1, pg_timetz_t arg2)
 
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timetz_lt)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timetz_lt(kern_context *kcxt, pg_timetz_t arg1, pg_timetz_t arg2)
 {
@@ -2577,7 +2728,9 @@ pgfn_timetz_lt(kern_context *kcxt, pg_timetz_t arg1, pg_timetz_t arg2)
 
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timetz_le)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timetz_le(kern_context *kcxt, pg_timetz_t arg1, pg_timetz_t arg2)
 {
@@ -2594,7 +2747,9 @@ pgfn_timetz_le(kern_context *kcxt, pg_timetz_t arg1, pg_timetz_t arg2)
 
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timetz_ge)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timetz_ge(kern_context *kcxt, pg_timetz_t arg1, pg_timetz_t arg2)
 {
@@ -2611,7 +2766,9 @@ pgfn_timetz_ge(kern_context *kcxt, pg_timetz_t arg1, pg_timetz_t arg2)
 
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timetz_gt)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timetz_gt(kern_context *kcxt, pg_timetz_t arg1, pg_timetz_t arg2)
 {
@@ -2628,6 +2785,7 @@ pgfn_timetz_gt(kern_context *kcxt, pg_timetz_t arg1, pg_timetz_t arg2)
 
 	return result;
 }
+#endif
 
 STATIC_FUNCTION(pg_int4_t)
 pgfn_type_compare(kern_context *kcxt, pg_timetz_t arg1, pg_timetz_t arg2)
@@ -2647,6 +2805,7 @@ pgfn_type_compare(kern_context *kcxt, pg_timetz_t arg1, pg_timetz_t arg2)
 /*
  * Timestamp comparison
  */
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamp_eq_date)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamp_eq_date(kern_context *kcxt,
 					   pg_timestamp_t arg1, pg_date_t arg2)
@@ -2663,7 +2822,9 @@ pgfn_timestamp_eq_date(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamp_ne_date)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamp_ne_date(kern_context *kcxt,
 					   pg_timestamp_t arg1, pg_date_t arg2)
@@ -2680,7 +2841,9 @@ pgfn_timestamp_ne_date(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamp_lt_date)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamp_lt_date(kern_context *kcxt,
 					   pg_timestamp_t arg1, pg_date_t arg2)
@@ -2697,7 +2860,9 @@ pgfn_timestamp_lt_date(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamp_le_date)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamp_le_date(kern_context *kcxt,
 					   pg_timestamp_t arg1, pg_date_t arg2)
@@ -2714,7 +2879,9 @@ pgfn_timestamp_le_date(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamp_gt_date)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamp_gt_date(kern_context *kcxt,
 					   pg_timestamp_t arg1, pg_date_t arg2)
@@ -2731,7 +2898,9 @@ pgfn_timestamp_gt_date(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamp_ge_date)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamp_ge_date(kern_context *kcxt,
 					   pg_timestamp_t arg1, pg_date_t arg2)
@@ -2748,7 +2917,9 @@ pgfn_timestamp_ge_date(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamp_cmp_date)
 STATIC_FUNCTION(pg_int4_t)
 pgfn_timestamp_cmp_date(kern_context *kcxt,
 						pg_timestamp_t arg1, pg_date_t arg2)
@@ -2770,10 +2941,12 @@ pgfn_timestamp_cmp_date(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
 /*
  * Comparison between date and timestamptz
  */
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__date_lt_timestamptz)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_date_lt_timestamptz(kern_context *kcxt,
 						 pg_date_t arg1, pg_timestamptz_t arg2)
@@ -2791,7 +2964,9 @@ pgfn_date_lt_timestamptz(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__date_le_timestamptz)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_date_le_timestamptz(kern_context *kcxt,
 						 pg_date_t arg1, pg_timestamptz_t arg2)
@@ -2809,7 +2984,9 @@ pgfn_date_le_timestamptz(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__date_eq_timestamptz)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_date_eq_timestamptz(kern_context *kcxt,
 						 pg_date_t arg1, pg_timestamptz_t arg2)
@@ -2827,7 +3004,9 @@ pgfn_date_eq_timestamptz(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__date_ge_timestamptz)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_date_ge_timestamptz(kern_context *kcxt,
 						 pg_date_t arg1, pg_timestamptz_t arg2)
@@ -2845,7 +3024,9 @@ pgfn_date_ge_timestamptz(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__date_gt_timestamptz)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_date_gt_timestamptz(kern_context *kcxt,
 						 pg_date_t arg1, pg_timestamptz_t arg2)
@@ -2863,7 +3044,9 @@ pgfn_date_gt_timestamptz(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__date_ne_timestamptz)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_date_ne_timestamptz(kern_context *kcxt,
 						 pg_date_t arg1, pg_timestamptz_t arg2)
@@ -2881,55 +3064,69 @@ pgfn_date_ne_timestamptz(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
 /*
  * Comparison between timestamptz and date
  */
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamptz_lt_date)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamptz_lt_date(kern_context *kcxt,
 						 pg_timestamptz_t arg1, pg_date_t arg2)
 {
 	return pgfn_date_gt_timestamptz(kcxt, arg2, arg1);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamptz_le_date)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamptz_le_date(kern_context *kcxt,
 						 pg_timestamptz_t arg1, pg_date_t arg2)
 {
 	return pgfn_date_ge_timestamptz(kcxt, arg2, arg1);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamptz_eq_date)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamptz_eq_date(kern_context *kcxt,
 						 pg_timestamptz_t arg1, pg_date_t arg2)
 {
 	return pgfn_date_eq_timestamptz(kcxt, arg2, arg1);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamptz_ge_date)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamptz_ge_date(kern_context *kcxt,
 						 pg_timestamptz_t arg1, pg_date_t arg2)
 {
 	return pgfn_date_le_timestamptz(kcxt, arg2, arg1);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamptz_gt_date)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamptz_gt_date(kern_context *kcxt,
 						 pg_timestamptz_t arg1, pg_date_t arg2)
 {
 	return pgfn_date_lt_timestamptz(kcxt, arg2, arg1);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamptz_ne_date)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamptz_ne_date(kern_context *kcxt,
 						 pg_timestamptz_t arg1, pg_date_t arg2)
 {
 	return pgfn_date_ne_timestamptz(kcxt, arg2, arg1);
 }
+#endif
 
 /*
  * Comparison between timestamp and timestamptz
  */
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamp_lt_timestamptz)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamp_lt_timestamptz(kern_context *kcxt,
 							  pg_timestamp_t arg1, pg_timestamptz_t arg2)
@@ -2947,7 +3144,9 @@ pgfn_timestamp_lt_timestamptz(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamp_le_timestamptz)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamp_le_timestamptz(kern_context *kcxt,
 							  pg_timestamp_t arg1, pg_timestamptz_t arg2)
@@ -2965,7 +3164,9 @@ pgfn_timestamp_le_timestamptz(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamp_eq_timestamptz)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamp_eq_timestamptz(kern_context *kcxt,
 							  pg_timestamp_t arg1, pg_timestamptz_t arg2)
@@ -2983,7 +3184,9 @@ pgfn_timestamp_eq_timestamptz(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamp_ge_timestamptz)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamp_ge_timestamptz(kern_context *kcxt,
 							  pg_timestamp_t arg1, pg_timestamptz_t arg2)
@@ -3001,7 +3204,9 @@ pgfn_timestamp_ge_timestamptz(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamp_gt_timestamptz)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamp_gt_timestamptz(kern_context *kcxt,
 							  pg_timestamp_t arg1, pg_timestamptz_t arg2)
@@ -3019,7 +3224,9 @@ pgfn_timestamp_gt_timestamptz(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamp_ne_timestamptz)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamp_ne_timestamptz(kern_context *kcxt,
 							  pg_timestamp_t arg1, pg_timestamptz_t arg2)
@@ -3037,51 +3244,64 @@ pgfn_timestamp_ne_timestamptz(kern_context *kcxt,
 	}
 	return result;
 }
+#endif
 
 /*
  * Comparison between timestamptz and timestamp
  */
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamptz_lt_timestamp)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamptz_lt_timestamp(kern_context *kcxt,
 							  pg_timestamptz_t arg1, pg_timestamp_t arg2)
 {
 	return pgfn_timestamp_gt_timestamptz(kcxt, arg2, arg1);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamptz_le_timestamp)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamptz_le_timestamp(kern_context *kcxt,
 							  pg_timestamptz_t arg1, pg_timestamp_t arg2)
 {
 	return pgfn_timestamp_ge_timestamptz(kcxt, arg2, arg1);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamptz_eq_timestamp)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamptz_eq_timestamp(kern_context *kcxt,
 							  pg_timestamptz_t arg1, pg_timestamp_t arg2)
 {
 	return pgfn_timestamp_eq_timestamptz(kcxt, arg2, arg1);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamptz_ge_timestamp)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamptz_ge_timestamp(kern_context *kcxt,
 							  pg_timestamptz_t arg1, pg_timestamp_t arg2)
 {
 	return pgfn_timestamp_le_timestamptz(kcxt, arg2, arg1);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamptz_gt_timestamp)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamptz_gt_timestamp(kern_context *kcxt,
 							  pg_timestamptz_t arg1, pg_timestamp_t arg2)
 {
 	return pgfn_timestamp_lt_timestamptz(kcxt, arg2, arg1);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__timestamptz_ne_timestamp)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_timestamptz_ne_timestamp(kern_context *kcxt,
 							  pg_timestamptz_t arg1, pg_timestamp_t arg2)
 {
 	return pgfn_timestamp_ne_timestamptz(kcxt, arg2, arg1);
 }
+#endif
 
 /*
  * Comparison between pg_interval_t
@@ -3107,6 +3327,7 @@ interval_cmp_internal(Interval arg1, Interval arg2)
 	return ((span1 < span2) ? -1 : (span1 > span2) ? 1 : 0);
 }
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__interval_eq)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_interval_eq(kern_context *kcxt, pg_interval_t arg1, pg_interval_t arg2)
 {
@@ -3123,7 +3344,9 @@ pgfn_interval_eq(kern_context *kcxt, pg_interval_t arg1, pg_interval_t arg2)
 
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__interval_ne)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_interval_ne(kern_context *kcxt, pg_interval_t arg1, pg_interval_t arg2)
 {
@@ -3140,7 +3363,9 @@ pgfn_interval_ne(kern_context *kcxt, pg_interval_t arg1, pg_interval_t arg2)
 
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__interval_lt)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_interval_lt(kern_context *kcxt, pg_interval_t arg1, pg_interval_t arg2)
 {
@@ -3157,7 +3382,9 @@ pgfn_interval_lt(kern_context *kcxt, pg_interval_t arg1, pg_interval_t arg2)
 
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__interval_le)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_interval_le(kern_context *kcxt, pg_interval_t arg1, pg_interval_t arg2)
 {
@@ -3174,7 +3401,9 @@ pgfn_interval_le(kern_context *kcxt, pg_interval_t arg1, pg_interval_t arg2)
 
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__interval_ge)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_interval_ge(kern_context *kcxt, pg_interval_t arg1, pg_interval_t arg2)
 {
@@ -3191,7 +3420,9 @@ pgfn_interval_ge(kern_context *kcxt, pg_interval_t arg1, pg_interval_t arg2)
 
 	return result;
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__interval_gt)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_interval_gt(kern_context *kcxt, pg_interval_t arg1, pg_interval_t arg2)
 {
@@ -3208,6 +3439,7 @@ pgfn_interval_gt(kern_context *kcxt, pg_interval_t arg1, pg_interval_t arg2)
 
 	return result;
 }
+#endif
 
 STATIC_FUNCTION(pg_int4_t)
 pgfn_type_compare(kern_context *kcxt, pg_interval_t arg1, pg_interval_t arg2)
@@ -3228,6 +3460,7 @@ pgfn_type_compare(kern_context *kcxt, pg_interval_t arg1, pg_interval_t arg2)
 /*
  * current date time function
  */
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__now)
 STATIC_FUNCTION(pg_timestamptz_t)
 pgfn_now(kern_context *kcxt)
 {
@@ -3239,6 +3472,7 @@ pgfn_now(kern_context *kcxt)
 
 	return result;
 }
+#endif
 
 /*
  * overlaps() SQL functions
@@ -3366,6 +3600,7 @@ OVERLAPS(cl_long,COMPARE_GT_OPS,COMPARE_LT_OPS)
 OVERLAPS(TimeTzADT,timetz_gt_internal,timetz_lt_internal)
 
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__overlaps_time)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_overlaps_time(kern_context *kcxt,
 				   pg_time_t arg1, pg_time_t arg2,
@@ -3377,7 +3612,9 @@ pgfn_overlaps_time(kern_context *kcxt,
 						  arg3.value, arg3.isnull,
 						  arg4.value, arg4.isnull);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__overlaps_timetz)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_overlaps_timetz(kern_context *kcxt,
 					 pg_timetz_t arg1, pg_timetz_t arg2,
@@ -3389,7 +3626,9 @@ pgfn_overlaps_timetz(kern_context *kcxt,
 							  arg3.value, arg3.isnull,
 							  arg4.value, arg4.isnull);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__overlaps_timestamp)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_overlaps_timestamp(kern_context *kcxt,
 						pg_timestamp_t arg1, pg_timestamp_t arg2,
@@ -3401,7 +3640,9 @@ pgfn_overlaps_timestamp(kern_context *kcxt,
 						  arg3.value, arg3.isnull,
 						  arg4.value, arg4.isnull);
 }
+#endif
 
+#if !defined(PGSTROM_DEVFUNC_PRUNED) || defined(DEVFUNC_NEEDS__overlaps_timestamptz)
 STATIC_FUNCTION(pg_bool_t)
 pgfn_overlaps_timestamptz(kern_context *kcxt,
 						  pg_timestamptz_t arg1, pg_timestamptz_t arg2,
@@ -3413,6 +3654,7 @@ pgfn_overlaps_timestamptz(kern_context *kcxt,
 						  arg3.value, arg3.isnull,
 						  arg4.value, arg4.isnull);
 }
+#endif
 #else	/* __CUDACC__ */
 
 #include "access/xact.h"
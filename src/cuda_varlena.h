@@ -660,5 +660,78 @@ PG_SCALAR_ARRAY_OP(kern_context *kcxt,
 	}
 	return result;
 }
+
+/*
+ * Support routines for ScalarArrayOpExpr with a large constant array
+ *
+ * Code generator builds a sorted array or a hash-set of the distinct and
+ * non-NULL elements, and informs whether the original array has NULLs.
+ * Semantics are identical to PG_SCALAR_ARRAY_OP with equality operator
+ * (useOr = true), or its negator (useOr = false).
+ */
+STATIC_INLINE(pg_bool_t)
+__PG_SCALAR_ARRAY_RESULT(cl_bool found, cl_bool useOr, cl_bool has_nulls)
+{
+	pg_bool_t	result;
+
+	if (found)
+	{
+		result.isnull = false;
+		result.value = useOr;
+	}
+	else if (has_nulls)
+	{
+		result.isnull = true;
+		result.value = false;
+	}
+	else
+	{
+		result.isnull = false;
+		result.value = !useOr;
+	}
+	return result;
+}
+
+template <typename ScalarType>
+STATIC_FUNCTION(pg_bool_t)
+PG_SCALAR_ARRAY_HASHED(kern_context *kcxt,
+					   ScalarType scalar,
+					   pg_bytea_t hashset,
+					   cl_bool useOr,	/* true = ANY, false = ALL */
+					   cl_bool has_nulls)
+{
+	kern_array_hashset *hset;
+	cl_long		value;
+	cl_uint		mask;
+	cl_uint		k;
+	pg_bool_t	result;
+
+	if (hashset.isnull)
+	{
+		result.isnull = true;
+		result.value = false;
+		return result;
+	}
+	hset = (kern_array_hashset *) hashset.value;
+	if (hset->nitems == 0)
+		return __PG_SCALAR_ARRAY_RESULT(false, useOr, has_nulls);
+	if (scalar.isnull)
+	{
+		result.isnull = true;
+		result.value = false;
+		return result;
+	}
+	/* open-addressing with linear probing */
+	value = (cl_long) scalar.value;
+	mask = hset->nslots - 1;
+	for (k = array_hashset_hash(value) & mask;
+		 hset->slots[k] != hset->empty;
+		 k = (k + 1) & mask)
+	{
+		if (hset->slots[k] == value)
+			return __PG_SCALAR_ARRAY_RESULT(true, useOr, has_nulls);
+	}
+	return __PG_SCALAR_ARRAY_RESULT(false, useOr, has_nulls);
+}
 #endif	/* __CUDACC__ */
 #endif	/* CUDA_VARLENA_H */
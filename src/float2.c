@@ -16,6 +16,13 @@
  * GNU General Public License for more details.
  */
 #include "pg_strom.h"
+/* target attribute on the intrinsics needs GCC 4.9 or later */
+#if defined(__x86_64__) && \
+	(__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define FLOAT2_HAS_F16C_KERNELS		1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
 
 typedef unsigned short	half_t;
 #define PG_GETARG_FLOAT2(x)	PG_GETARG_INT16(x)
@@ -149,6 +156,12 @@ Datum pgstrom_int2_as_float2(PG_FUNCTION_ARGS);
 Datum pgstrom_float2_accum(PG_FUNCTION_ARGS);
 Datum pgstrom_float2_sum(PG_FUNCTION_ARGS);
 
+/* float2 array functions */
+Datum pgstrom_float2_array_to_float4_array(PG_FUNCTION_ARGS);
+Datum pgstrom_float4_array_to_float2_array(PG_FUNCTION_ARGS);
+Datum pgstrom_float2_array_dot_product(PG_FUNCTION_ARGS);
+Datum pgstrom_float2_array_l2_distance(PG_FUNCTION_ARGS);
+
 //#define DEBUG_FP16 1
 
 static inline void
@@ -208,59 +221,63 @@ print_fp64(const char *prefix, cl_ulong value)
 
 /*
  * cast functions across floating point
+ *
+ * fp32_to_fp16_rn rounds the value to the nearest even, as F16C instruction
+ * and __float2half_rn() of CUDA doing. Values larger than FP16 can represent
+ * are rounded to +/-Infinity, so callers have to check FP32_IS_FP16_OVERFLOW
+ * prior to the conversion.
  */
-static half_t
-fp32_to_fp16(float value)
-{
-	cl_uint		fp32val = float_as_int(value);
-	cl_uint		sign = ((fp32val & 0x80000000U) >> 16);
-	cl_int		expo = ((fp32val & 0x7f800000U) >> 23);
-	cl_int		frac = ((fp32val & 0x007fffffU));
-	half_t		result;
+#define FP32_IS_FP16_OVERFLOW(fp32val)							\
+	(((fp32val) & 0x7fffffffU) - 0x477ff000U < 0x7f800000U - 0x477ff000U)
 
-	print_fp32("->", fp32val);
+static inline half_t
+fp32_to_fp16_rn(cl_uint fp32val)
+{
+	cl_uint		sign = ((fp32val >> 16) & 0x8000);
+	cl_uint		absv = (fp32val & 0x7fffffffU);
+	cl_uint		frac, rem, half;
+	cl_int		shift;
 
-	/* special cases */
-	if (expo == 0xff)
+	if (absv >= 0x7f800000U)
 	{
-		if (frac == 0)
-			result = sign | 0x7c00;		/* -/+Infinity */
-		else
-			result = 0xffff;			/* NaN */
+		if (absv == 0x7f800000U)
+			return sign | 0x7c00;		/* -/+Infinity */
+		/* NaN; keeps the upper bits of the payload */
+		return sign | 0x7e00 | ((absv >> 13) & 0x03ff);
 	}
-	else if (expo == 0)
-		result = sign;					/* -/+0.0 */
-	else
+	if (absv >= 0x477ff000U)
+		return sign | 0x7c00;			/* overflow */
+	if (absv >= 0x38800000U)
 	{
-		expo -= FP32_EXPO_BIAS;
+		/* normalized; round the 13 dropped bits to the nearest even */
+		absv += 0x0fff + ((absv >> 13) & 1);
+		return sign | ((absv - 0x38000000U) >> 13);
+	}
+	if (absv <= 0x33000000U)
+		return sign;					/* -/+0.0 */
+	/* non-uniformed fraction for small numbers */
+	shift = 126 - (absv >> 23);
+	frac = (absv & 0x007fffffU) | 0x00800000U;
+	rem = frac & ((1U << shift) - 1);
+	half = (1U << (shift - 1));
+	frac >>= shift;
+	if (rem > half || (rem == half && (frac & 1) != 0))
+		frac++;
+	return sign | frac;
+}
 
-		frac = ((frac >> 13) | 0x400) + ((frac >> 12) & 1);
-		while ((frac & 0xfc00) != 0x400)
-		{
-			frac >>= 1;
-			expo++;
-		}
+static half_t
+fp32_to_fp16(float value)
+{
+	cl_uint		fp32val = float_as_int(value);
+	half_t		result;
 
-		if (expo < FP16_EXPO_MIN)
-		{
-			/* try non-uniformed fraction for small numbers */
-			if (FP16_EXPO_MIN - expo <= FP16_FRAC_BITS)
-				frac >>= (FP16_EXPO_MIN - expo);
-			else
-				frac = 0;
-			expo = 0;
-		}
-		else if (expo > FP16_EXPO_MAX)
-			ereport(ERROR,
-					(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
-					 errmsg("\"%f\" is out of range for type float2", value)));
-		else
-		{
-			frac &= 0x3ff;
-			expo += FP16_EXPO_BIAS;
-		}
-		result = sign | (expo << FP16_FRAC_BITS) | frac;
-	}
+	print_fp32("->", fp32val);
+	if (FP32_IS_FP16_OVERFLOW(fp32val))
+		ereport(ERROR,
+				(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+				 errmsg("\"%f\" is out of range for type float2", value)));
+	result = fp32_to_fp16_rn(fp32val);
 	print_fp16("<-", result);
 	return result;
 }
@@ -280,7 +297,7 @@ fp16_to_fp32(half_t fp16val)
 		if (frac == 0)
 			result = (sign | 0x7f800000);	/* +/-Infinity */
 		else
-			result = 0xffffffff;			/* NaN */
+			result = (sign | 0x7fc00000 | (frac << 13));	/* NaN */
 	}
 	else if (expo == 0 && frac == 0)
 		result = sign;						/* +/-0.0 */
@@ -1514,3 +1531,401 @@ pgstrom_float2_sum(PG_FUNCTION_ARGS)
 	PG_RETURN_FLOAT8(newval);
 }
 PG_FUNCTION_INFO_V1(pgstrom_float2_sum);
+
+/*
+ * float2 array support
+ *
+ * Kernels of the batched conversion and arithmetic on float2 arrays.
+ * F16C/AVX2 version is chosen at pgstrom_init_float2() if CPU supports,
+ * or scalar version is used instead. Both versions accumulate values on
+ * 8 lanes in the same order, so the results are identical regardless of
+ * the CPU.
+ */
+static inline double
+float2_array_sum_lanes(const double *lanes)
+{
+	return (((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+			((lanes[4] + lanes[5]) + (lanes[6] + lanes[7])));
+}
+
+static void
+float2_array_to_float4_scalar(float *dst, const half_t *src, size_t nitems)
+{
+	size_t		i;
+
+	for (i=0; i < nitems; i++)
+		dst[i] = fp16_to_fp32(src[i]);
+}
+
+/* returns number of items converted, or index of the out of range value */
+static size_t
+float4_array_to_float2_scalar(half_t *dst, const float *src, size_t nitems)
+{
+	size_t		i;
+
+	for (i=0; i < nitems; i++)
+	{
+		cl_uint		fp32val = float_as_int(src[i]);
+
+		if (FP32_IS_FP16_OVERFLOW(fp32val))
+			break;
+		dst[i] = fp32_to_fp16_rn(fp32val);
+	}
+	return i;
+}
+
+static double
+float2_array_dot_scalar(const half_t *x, const half_t *y, size_t nitems)
+{
+	double		lanes[8] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+	size_t		i;
+
+	/* product of two float2 values is exact on float4 */
+	for (i=0; i < nitems; i++)
+		lanes[i & 7] += (double)(fp16_to_fp32(x[i]) * fp16_to_fp32(y[i]));
+	return float2_array_sum_lanes(lanes);
+}
+
+static double
+float2_array_l2_scalar(const half_t *x, const half_t *y, size_t nitems)
+{
+	double		lanes[8] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+	double		d;
+	size_t		i;
+
+	for (i=0; i < nitems; i++)
+	{
+		d = (double)fp16_to_fp32(x[i]) - (double)fp16_to_fp32(y[i]);
+		lanes[i & 7] += d * d;
+	}
+	return float2_array_sum_lanes(lanes);
+}
+
+#ifdef FLOAT2_HAS_F16C_KERNELS
+__attribute__((target("avx2,f16c")))
+static void
+float2_array_to_float4_f16c(float *dst, const half_t *src, size_t nitems)
+{
+	size_t		i;
+
+	for (i=0; i + 8 <= nitems; i += 8)
+	{
+		__m128i		h = _mm_loadu_si128((const __m128i *)(src + i));
+
+		_mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+	}
+	for (; i < nitems; i++)
+		dst[i] = fp16_to_fp32(src[i]);
+}
+
+__attribute__((target("avx2,f16c")))
+static size_t
+float4_array_to_float2_f16c(half_t *dst, const float *src, size_t nitems)
+{
+	const __m256 absmask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+	const __m256 ovflow = _mm256_castsi256_ps(_mm256_set1_epi32(0x477ff000));
+	const __m256 infval = _mm256_castsi256_ps(_mm256_set1_epi32(0x7f800000));
+	size_t		i;
+
+	for (i=0; i + 8 <= nitems; i += 8)
+	{
+		__m256		v = _mm256_loadu_ps(src + i);
+		__m256		a = _mm256_and_ps(v, absmask);
+
+		/* out of range values are checked by the scalar code below */
+		if (_mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(a, ovflow, _CMP_GE_OQ),
+											 _mm256_cmp_ps(a, infval, _CMP_LT_OQ))))
+			break;
+		_mm_storeu_si128((__m128i *)(dst + i),
+						 _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+	}
+	for (; i < nitems; i++)
+	{
+		cl_uint		fp32val = float_as_int(src[i]);
+
+		if (FP32_IS_FP16_OVERFLOW(fp32val))
+			break;
+		dst[i] = fp32_to_fp16_rn(fp32val);
+	}
+	return i;
+}
+
+__attribute__((target("avx2,f16c")))
+static double
+float2_array_dot_f16c(const half_t *x, const half_t *y, size_t nitems)
+{
+	__m256d		sum_lo = _mm256_setzero_pd();
+	__m256d		sum_hi = _mm256_setzero_pd();
+	double		lanes[8];
+	size_t		i;
+
+	for (i=0; i + 8 <= nitems; i += 8)
+	{
+		__m256	xv = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(x + i)));
+		__m256	yv = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(y + i)));
+		__m256	pv = _mm256_mul_ps(xv, yv);
+
+		sum_lo = _mm256_add_pd(sum_lo, _mm256_cvtps_pd(_mm256_castps256_ps128(pv)));
+		sum_hi = _mm256_add_pd(sum_hi, _mm256_cvtps_pd(_mm256_extractf128_ps(pv, 1)));
+	}
+	_mm256_storeu_pd(lanes, sum_lo);
+	_mm256_storeu_pd(lanes + 4, sum_hi);
+	for (; i < nitems; i++)
+		lanes[i & 7] += (double)(fp16_to_fp32(x[i]) * fp16_to_fp32(y[i]));
+	return float2_array_sum_lanes(lanes);
+}
+
+__attribute__((target("avx2,f16c")))
+static double
+float2_array_l2_f16c(const half_t *x, const half_t *y, size_t nitems)
+{
+	__m256d		sum_lo = _mm256_setzero_pd();
+	__m256d		sum_hi = _mm256_setzero_pd();
+	double		lanes[8];
+	double		d;
+	size_t		i;
+
+	for (i=0; i + 8 <= nitems; i += 8)
+	{
+		__m256	xv = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(x + i)));
+		__m256	yv = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(y + i)));
+		__m256d	d_lo = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(xv)),
+									 _mm256_cvtps_pd(_mm256_castps256_ps128(yv)));
+		__m256d	d_hi = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(xv, 1)),
+									 _mm256_cvtps_pd(_mm256_extractf128_ps(yv, 1)));
+
+		sum_lo = _mm256_add_pd(sum_lo, _mm256_mul_pd(d_lo, d_lo));
+		sum_hi = _mm256_add_pd(sum_hi, _mm256_mul_pd(d_hi, d_hi));
+	}
+	_mm256_storeu_pd(lanes, sum_lo);
+	_mm256_storeu_pd(lanes + 4, sum_hi);
+	for (; i < nitems; i++)
+	{
+		d = (double)fp16_to_fp32(x[i]) - (double)fp16_to_fp32(y[i]);
+		lanes[i & 7] += d * d;
+	}
+	return float2_array_sum_lanes(lanes);
+}
+#endif	/* FLOAT2_HAS_F16C_KERNELS */
+
+static void   (*float2_array_to_float4_kernel)(float *dst,
+											   const half_t *src,
+											   size_t nitems)
+	= float2_array_to_float4_scalar;
+static size_t (*float4_array_to_float2_kernel)(half_t *dst,
+											   const float *src,
+											   size_t nitems)
+	= float4_array_to_float2_scalar;
+static double (*float2_array_dot_kernel)(const half_t *x,
+										 const half_t *y,
+										 size_t nitems)
+	= float2_array_dot_scalar;
+static double (*float2_array_l2_kernel)(const half_t *x,
+										const half_t *y,
+										size_t nitems)
+	= float2_array_l2_scalar;
+
+/*
+ * float2_type_oid - float2 is not a built-in data type
+ */
+static Oid
+float2_type_oid(void)
+{
+	Oid		type_oid;
+
+	type_oid = GetSysCacheOid2(TYPENAMENSP,
+							   CStringGetDatum("float2"),
+							   ObjectIdGetDatum(PG_CATALOG_NAMESPACE));
+	if (!OidIsValid(type_oid))
+		elog(ERROR, "type 'float2' is not defined");
+	return type_oid;
+}
+
+/*
+ * construct_float_array_like
+ *
+ * It allocates an array with the same dimensions and null-bitmap with the
+ * source array, but different element type. It returns number of the
+ * non-null elements, to be filled up by the caller.
+ */
+static ArrayType *
+construct_float_array_like(ArrayType *source,
+						   Oid elemtype, int typlen, int *p_nvalues)
+{
+	ArrayType  *result;
+	int			ndim = ARR_NDIM(source);
+	int			nitems = ArrayGetNItems(ndim, ARR_DIMS(source));
+	int			nvalues = nitems;
+	bits8	   *nullmap = ARR_NULLBITMAP(source);
+	Size		dataoffset;
+	Size		len;
+	int			i;
+
+	if (!nullmap)
+		len = dataoffset = ARR_OVERHEAD_NONULLS(ndim);
+	else
+	{
+		for (i=0; i < nitems; i++)
+		{
+			if ((nullmap[i / BITS_PER_BYTE] & (1 << (i % BITS_PER_BYTE))) == 0)
+				nvalues--;
+		}
+		len = dataoffset = ARR_OVERHEAD_WITHNULLS(ndim, nitems);
+	}
+	len += (Size)typlen * (Size)nvalues;
+	if (!AllocSizeIsValid(len))
+		ereport(ERROR,
+				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+				 errmsg("array size exceeds the maximum allowed (%d)",
+						(int) MaxAllocSize)));
+	result = palloc(len);
+	SET_VARSIZE(result, len);
+	result->ndim = ndim;
+	result->dataoffset = (nullmap ? dataoffset : 0);
+	result->elemtype = elemtype;
+	memcpy(ARR_DIMS(result), ARR_DIMS(source), sizeof(int) * ndim);
+	memcpy(ARR_LBOUND(result), ARR_LBOUND(source), sizeof(int) * ndim);
+	if (nullmap)
+		array_bitmap_copy(ARR_NULLBITMAP(result), 0,
+						  nullmap, 0, nitems);
+	*p_nvalues = nvalues;
+
+	return result;
+}
+
+/*
+ * float2[] --> float4[]
+ */
+Datum
+pgstrom_float2_array_to_float4_array(PG_FUNCTION_ARGS)
+{
+	ArrayType  *source = PG_GETARG_ARRAYTYPE_P(0);
+	ArrayType  *result;
+	int			nvalues;
+
+	if (ARR_ELEMTYPE(source) != float2_type_oid())
+		elog(ERROR, "float2 array is expected");
+	if (ARR_NDIM(source) == 0)
+		PG_RETURN_ARRAYTYPE_P(construct_empty_array(FLOAT4OID));
+	result = construct_float_array_like(source, FLOAT4OID,
+										sizeof(float), &nvalues);
+	float2_array_to_float4_kernel((float *)ARR_DATA_PTR(result),
+								  (half_t *)ARR_DATA_PTR(source),
+								  nvalues);
+	PG_RETURN_ARRAYTYPE_P(result);
+}
+PG_FUNCTION_INFO_V1(pgstrom_float2_array_to_float4_array);
+
+/*
+ * float4[] --> float2[]
+ */
+Datum
+pgstrom_float4_array_to_float2_array(PG_FUNCTION_ARGS)
+{
+	ArrayType  *source = PG_GETARG_ARRAYTYPE_P(0);
+	ArrayType  *result;
+	Oid			float2_oid = float2_type_oid();
+	float	   *values;
+	int			nvalues;
+	size_t		nconv;
+
+	if (ARR_ELEMTYPE(source) != FLOAT4OID)
+		elog(ERROR, "float4 array is expected");
+	if (ARR_NDIM(source) == 0)
+		PG_RETURN_ARRAYTYPE_P(construct_empty_array(float2_oid));
+	result = construct_float_array_like(source, float2_oid,
+										sizeof(half_t), &nvalues);
+	values = (float *)ARR_DATA_PTR(source);
+	nconv = float4_array_to_float2_kernel((half_t *)ARR_DATA_PTR(result),
+										  values, nvalues);
+	if (nconv < nvalues)
+		ereport(ERROR,
+				(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+				 errmsg("\"%f\" is out of range for type float2",
+						values[nconv])));
+	PG_RETURN_ARRAYTYPE_P(result);
+}
+PG_FUNCTION_INFO_V1(pgstrom_float4_array_to_float2_array);
+
+/*
+ * float2_array_check_pair - both arrays must have the same number of
+ * elements without NULLs.
+ */
+static int
+float2_array_check_pair(ArrayType *x, ArrayType *y, const char *fname)
+{
+	Oid			float2_oid = float2_type_oid();
+	int			nitems;
+
+	if (ARR_ELEMTYPE(x) != float2_oid || ARR_ELEMTYPE(y) != float2_oid)
+		elog(ERROR, "%s: float2 array is expected", fname);
+	if (ARR_HASNULL(x) || ARR_HASNULL(y))
+		ereport(ERROR,
+				(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+				 errmsg("%s: array must not contain nulls", fname)));
+	nitems = ArrayGetNItems(ARR_NDIM(x), ARR_DIMS(x));
+	if (nitems != ArrayGetNItems(ARR_NDIM(y), ARR_DIMS(y)))
+		ereport(ERROR,
+				(errcode(ERRCODE_ARRAY_SUBSCRIPT_ERROR),
+				 errmsg("%s: arrays must have same number of elements",
+						fname)));
+	return nitems;
+}
+
+/*
+ * float2_dot_product(float2[], float2[])
+ */
+Datum
+pgstrom_float2_array_dot_product(PG_FUNCTION_ARGS)
+{
+	ArrayType  *x = PG_GETARG_ARRAYTYPE_P(0);
+	ArrayType  *y = PG_GETARG_ARRAYTYPE_P(1);
+	int			nitems;
+
+	nitems = float2_array_check_pair(x, y, "float2_dot_product");
+	PG_RETURN_FLOAT8(float2_array_dot_kernel((half_t *)ARR_DATA_PTR(x),
+											 (half_t *)ARR_DATA_PTR(y),
+											 nitems));
+}
+PG_FUNCTION_INFO_V1(pgstrom_float2_array_dot_product);
+
+/*
+ * float2_l2_distance(float2[], float2[])
+ */
+Datum
+pgstrom_float2_array_l2_distance(PG_FUNCTION_ARGS)
+{
+	ArrayType  *x = PG_GETARG_ARRAYTYPE_P(0);
+	ArrayType  *y = PG_GETARG_ARRAYTYPE_P(1);
+	int			nitems;
+	double		sum;
+
+	nitems = float2_array_check_pair(x, y, "float2_l2_distance");
+	sum = float2_array_l2_kernel((half_t *)ARR_DATA_PTR(x),
+								 (half_t *)ARR_DATA_PTR(y),
+								 nitems);
+	PG_RETURN_FLOAT8(sqrt(sum));
+}
+PG_FUNCTION_INFO_V1(pgstrom_float2_array_l2_distance);
+
+/*
+ * pgstrom_init_float2
+ */
+void
+pgstrom_init_float2(void)
+{
+#ifdef FLOAT2_HAS_F16C_KERNELS
+	unsigned int	eax, ebx, ecx, edx;
+
+	/* F16C and AVX2 are available? */
+	if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) &&
+		(ecx & bit_F16C) != 0 &&
+		__builtin_cpu_supports("avx2"))
+	{
+		float2_array_to_float4_kernel = float2_array_to_float4_f16c;
+		float4_array_to_float2_kernel = float4_array_to_float2_f16c;
+		float2_array_dot_kernel = float2_array_dot_f16c;
+		float2_array_l2_kernel = float2_array_l2_f16c;
+	}
+#endif
+}
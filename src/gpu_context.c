@@ -41,16 +41,90 @@ typedef struct
 	GpuContextIPCEntry ipc_entries[FLEXIBLE_ARRAY_MEMBER];
 } GpuContextIPCHead;
 
+/* statistics of GpuContext activities per backend */
+typedef struct
+{
+	pid_t			pid;			/* 0, if free slot */
+	Oid				userid;
+	cl_int			cuda_dindex;	/* device of the last GpuContext */
+	TimestampTz		gpu_start;		/* time of the first GpuContext */
+	pg_atomic_uint32 num_running_tasks;
+	pg_atomic_uint64 counters[GPUSTAT__NITEMS];
+} GpuStatBackend;
+
+typedef struct
+{
+	slock_t			lock;			/* lock for slot assignment and reset */
+	TimestampTz		stats_reset;
+	pg_atomic_uint64 *device_counters;	/* [numDevAttrs][GPUSTAT__NITEMS] */
+	cl_int			num_backends;
+	GpuStatBackend	backends[FLEXIBLE_ARRAY_MEMBER];
+} GpuStatHead;
+
+/*
+ * Event trace of GpuContext
+ *
+ * Each thread (the backend and worker threads) has its own ring buffer, so
+ * events are appended without locks. The ring buffers are dumped after the
+ * termination of worker threads, so older events are overwritten if a ring
+ * buffer gets full.
+ */
+#define GPUTRACE_RING_NITEMS		8192	/* must be 2^N */
+
+typedef struct
+{
+	cl_ulong		tv_begin;		/* [ns] */
+	cl_ulong		tv_end;			/* [ns] */
+	cl_uint			event;			/* one of GPUTRACE__* */
+	cl_uint			trace_id;		/* GpuTask identifier, or 0 */
+	cl_int			task_kind;		/* GpuTaskKind, or -1 */
+} GpuTraceEntry;
+
+typedef struct
+{
+	pg_atomic_uint64 head;			/* # of events ever recorded */
+	GpuTraceEntry	entries[GPUTRACE_RING_NITEMS];
+} GpuTraceRing;
+
+typedef struct GpuTrace
+{
+	cl_ulong		tv_start;		/* [ns] base of the timestamp */
+	TimestampTz		ts_start;
+	char		   *query;			/* query string, if any */
+	pg_atomic_uint32 trace_id_seq;
+	cl_int			num_rings;		/* 1 + number of worker threads */
+	GpuTraceRing	rings[FLEXIBLE_ARRAY_MEMBER];
+} GpuTrace;
+
+static const char *gputrace_event_names[] = {
+	"build chunk",
+	"sync wait",
+	"gpu process",
+	"retry wait",
+	"enqueue",
+	"pickup",
+	"complete",
+	"cpu fallback",
+};
 /* variables */
 static shmem_startup_hook_type shmem_startup_next = NULL;
 static pg_atomic_uint32 *global_num_running_tasks;	/* shared */
 static GpuContextIPCHead *gcontext_ipc_head;	/* shared */
+static GpuStatHead *gpu_stat_head;				/* shared */
+static GpuStatBackend *gpu_stat_backend = NULL;	/* my slot, if any */
+static int			gpu_stat_num_backends;		/* # of per-backend slots */
 int					global_max_async_tasks;		/* GUC */
 int					local_max_async_tasks;		/* GUC */
 int					max_num_gpucontext;			/* GUC */
+static char		   *gpu_trace_directory;		/* GUC */
+static double		gpu_trace_sample_rate;		/* GUC */
 static slock_t		activeGpuContextLock;
 static dlist_head	activeGpuContextList;
 
+Datum pgstrom_stat_device(PG_FUNCTION_ARGS);
+Datum pgstrom_stat_activity(PG_FUNCTION_ARGS);
+Datum pgstrom_stat_reset(PG_FUNCTION_ARGS);
+
 /*
  * Resource tracker of GpuContext
  *
@@ -487,6 +561,211 @@ GpuContextLookupModule(GpuContext *gcontext, ProgramId program_id)
 	return cuda_module;
 }
 
+/*
+ * gputrace_alloc - allocation of the event trace, if sampled
+ */
+static GpuTrace *
+gputrace_alloc(int num_workers)
+{
+	GpuTrace   *trace;
+	int			i;
+
+	if (!gpu_trace_directory || *gpu_trace_directory == '\0')
+		return NULL;
+	if (gpu_trace_sample_rate < 1.0 &&
+		random() >= gpu_trace_sample_rate * (double)MAX_RANDOM_VALUE)
+		return NULL;
+
+	trace = calloc(1, offsetof(GpuTrace, rings[num_workers + 1]));
+	if (!trace)
+	{
+		elog(LOG, "out of memory for GPU event trace");
+		return NULL;
+	}
+	trace->tv_start = get_monotonic_nsec();
+	trace->ts_start = GetCurrentTimestamp();
+	if (debug_query_string)
+		trace->query = strdup(debug_query_string);
+	pg_atomic_init_u32(&trace->trace_id_seq, 0);
+	trace->num_rings = num_workers + 1;
+	for (i=0; i < trace->num_rings; i++)
+		pg_atomic_init_u64(&trace->rings[i].head, 0);
+
+	return trace;
+}
+
+/*
+ * gputrace_free
+ */
+static void
+gputrace_free(GpuTrace *trace)
+{
+	if (trace->query)
+		free(trace->query);
+	free(trace);
+}
+
+/*
+ * pgstromTraceEvent - records an event on the ring buffer of the thread
+ *
+ * If @tv_end is 0, it records an instant event at the current time.
+ */
+void
+pgstromTraceEvent(GpuContext *gcontext, GpuTraceEvent event,
+				  cl_ulong tv_begin, cl_ulong tv_end,
+				  GpuTask *gtask)
+{
+	GpuTrace	   *trace = gcontext->trace;
+	GpuTraceRing   *ring;
+	GpuTraceEntry  *entry;
+	uint64			head;
+
+	Assert(trace != NULL && event < GPUTRACE__NITEMS);
+	/* ring[0] is for the backend; GpuWorkerIndex is -1 */
+	Assert(GpuWorkerIndex + 1 < trace->num_rings);
+	ring = &trace->rings[GpuWorkerIndex + 1];
+	if (tv_end == 0)
+		tv_begin = tv_end = get_monotonic_nsec();
+
+	head = pg_atomic_read_u64(&ring->head);
+	entry = &ring->entries[head & (GPUTRACE_RING_NITEMS - 1)];
+	entry->tv_begin	= tv_begin;
+	entry->tv_end	= tv_end;
+	entry->event	= event;
+	if (!gtask)
+	{
+		entry->trace_id	= 0;
+		entry->task_kind = -1;
+	}
+	else
+	{
+		if (gtask->trace_id == 0)
+			gtask->trace_id = pg_atomic_add_fetch_u32(&trace->trace_id_seq, 1);
+		entry->trace_id	= gtask->trace_id;
+		entry->task_kind = gtask->task_kind;
+	}
+	pg_atomic_write_u64(&ring->head, head + 1);
+}
+
+/*
+ * gputrace_dump - writes out the event trace as a Chrome trace JSON file
+ *
+ * Worker threads must be already terminated.
+ */
+static void
+gputrace_dump(GpuContext *gcontext)
+{
+	GpuTrace	   *trace = gcontext->trace;
+	StringInfoData	buf;
+	char			path[MAXPGPATH];
+	FILE		   *filp;
+	uint64			nevents = 0;
+	uint64			ndropped = 0;
+	int				i;
+
+	StaticAssertStmt(lengthof(gputrace_event_names) == GPUTRACE__NITEMS,
+					 "gputrace_event_names[] mismatch to GpuTraceEvent");
+	Assert(!gcontext->worker_is_running);
+
+	initStringInfo(&buf);
+	appendStringInfo(&buf, "{\"traceEvents\":[");
+	for (i=0; i < trace->num_rings; i++)
+	{
+		GpuTraceRing *ring = &trace->rings[i];
+		uint64		head = pg_atomic_read_u64(&ring->head);
+		uint64		pos = 0;
+
+		if (head > GPUTRACE_RING_NITEMS)
+			pos = head - GPUTRACE_RING_NITEMS;
+		ndropped += pos;
+
+		if (i == 0)
+			appendStringInfo(&buf, "\n{\"name\":\"thread_name\",\"ph\":\"M\","
+							 "\"pid\":%d,\"tid\":0,"
+							 "\"args\":{\"name\":\"backend\"}}",
+							 MyProcPid);
+		else
+			appendStringInfo(&buf, ",\n{\"name\":\"thread_name\",\"ph\":\"M\","
+							 "\"pid\":%d,\"tid\":%d,"
+							 "\"args\":{\"name\":\"worker %d\"}}",
+							 MyProcPid, i, i - 1);
+		for (; pos < head; pos++)
+		{
+			GpuTraceEntry *entry =
+				&ring->entries[pos & (GPUTRACE_RING_NITEMS - 1)];
+			const char *category;
+			double		ts = (double)(entry->tv_begin -
+									  trace->tv_start) / 1000.0;
+			double		dur = (double)(entry->tv_end -
+									   entry->tv_begin) / 1000.0;
+
+			switch (entry->task_kind)
+			{
+				case GpuTaskKind_GpuScan:	category = "GpuScan";	break;
+				case GpuTaskKind_GpuJoin:	category = "GpuJoin";	break;
+				case GpuTaskKind_GpuPreAgg:	category = "GpuPreAgg";	break;
+				case GpuTaskKind_GpuSort:	category = "GpuSort";	break;
+				case GpuTaskKind_PL_CUDA:	category = "PL/CUDA";	break;
+				default:					category = "GpuTask";	break;
+			}
+			appendStringInfo(&buf, ",\n{\"name\":\"%s\",\"cat\":\"%s\",",
+							 gputrace_event_names[entry->event],
+							 category);
+			if (entry->event < GPUTRACE__ENQUEUE)
+				appendStringInfo(&buf, "\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,",
+								 ts, dur);
+			else
+				appendStringInfo(&buf, "\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,",
+								 ts + dur);
+			appendStringInfo(&buf, "\"pid\":%d,\"tid\":%d,"
+							 "\"args\":{\"task\":%u",
+							 MyProcPid, i, entry->trace_id);
+			/* time in the pending list, on pickup */
+			if (entry->event == GPUTRACE__PICKUP)
+				appendStringInfo(&buf, ",\"queue_wait\":%.3f", dur);
+			appendStringInfo(&buf, "}}");
+			nevents++;
+		}
+	}
+	appendStringInfo(&buf, "\n],\n\"displayTimeUnit\":\"ms\",\n"
+					 "\"otherData\":{\"pid\":%d,\"device\":%d,"
+					 "\"start\":\"%s\",\"events\":" UINT64_FORMAT ","
+					 "\"dropped\":" UINT64_FORMAT ",\"query\":",
+					 MyProcPid,
+					 devAttrs[gcontext->cuda_dindex].DEV_ID,
+					 timestamptz_to_str(trace->ts_start),
+					 nevents, ndropped);
+	if (trace->query)
+		escape_json(&buf, trace->query);
+	else
+		appendStringInfo(&buf, "null");
+	appendStringInfo(&buf, "}}\n");
+
+	/* no GpuTasks on this GpuContext */
+	if (nevents == 0)
+	{
+		pfree(buf.data);
+		return;
+	}
+
+	snprintf(path, sizeof(path), "%s/pgstrom_trace.%d." INT64_FORMAT ".json",
+			 gpu_trace_directory, MyProcPid, (int64)trace->ts_start);
+	filp = AllocateFile(path, PG_BINARY_W);
+	if (!filp)
+		ereport(WARNING,
+				(errcode_for_file_access(),
+				 errmsg("could not open file \"%s\": %m", path)));
+	else
+	{
+		if (fwrite(buf.data, buf.len, 1, filp) != 1)
+			ereport(WARNING,
+					(errcode_for_file_access(),
+					 errmsg("could not write file \"%s\": %m", path)));
+		FreeFile(filp);
+	}
+	pfree(buf.data);
+}
+
 /*
  * ReleaseLocalResources - release all the private resources tracked by
  * the resource tracker of GpuContext
@@ -497,10 +776,25 @@ ReleaseLocalResources(GpuContext *gcontext, bool normal_exit)
 	ResourceTracker *tracker;
 	dlist_node *dnode;
 	CUresult	rc;
+	uint32		num_running_tasks;
 	int			i;
 
 	Assert(!gcontext->worker_is_running);
 
+	/*
+	 * Tasks not completed (e.g, pending ones on error) are still counted
+	 * in the global number of running tasks, so revert them.
+	 */
+	num_running_tasks = pg_atomic_exchange_u32(&gcontext->num_running_tasks, 0);
+	if (num_running_tasks > 0)
+	{
+		pg_atomic_sub_fetch_u32(gcontext->global_num_running_tasks,
+								num_running_tasks);
+		if (gpu_stat_backend)
+			pg_atomic_sub_fetch_u32(&gpu_stat_backend->num_running_tasks,
+									num_running_tasks);
+	}
+
 	if (gcontext->cuda_context)
 	{
 		rc = cuCtxDestroy(gcontext->cuda_context);
@@ -586,15 +880,139 @@ ReleaseLocalResources(GpuContext *gcontext, bool normal_exit)
 	}
 	if (gcontext->error_message)
 		free(gcontext->error_message);
+	if (gcontext->trace)
+		gputrace_free(gcontext->trace);
 	free(gcontext);
 }
 
+/*
+ * pgstromStatAdd - add a value to the counters of device and backend
+ *
+ * It is available for both of the backend and GPU worker threads.
+ * On the worker threads, the GpuTaskState of the GpuTask being processed
+ * also accumulates the value for the cost feedback.
+ */
+void
+pgstromStatAdd(GpuContext *gcontext, GpuStatKind kind, cl_ulong value)
+{
+	cl_int		index = gcontext->cuda_dindex * GPUSTAT__NITEMS + kind;
+
+	Assert(kind >= 0 && kind < GPUSTAT__NITEMS);
+	pg_atomic_fetch_add_u64(&gpu_stat_head->device_counters[index], value);
+	if (gpu_stat_backend)
+		pg_atomic_fetch_add_u64(&gpu_stat_backend->counters[kind], value);
+	if (GpuWorkerCurrentTaskState)
+	{
+		GpuTaskState   *gts = GpuWorkerCurrentTaskState;
+
+		pg_atomic_fetch_add_u64(&gts->stat_counters[kind], value);
+	}
+}
+
+/*
+ * pgstromStatTaskEnqueued - count up a GpuTask attached to the pending list
+ *
+ * Caller must hold gcontext->mutex.
+ */
+void
+pgstromStatTaskEnqueued(GpuContext *gcontext)
+{
+	pg_atomic_add_fetch_u32(gcontext->global_num_running_tasks, 1);
+	pg_atomic_add_fetch_u32(&gcontext->num_running_tasks, 1);
+	if (gpu_stat_backend)
+		pg_atomic_add_fetch_u32(&gpu_stat_backend->num_running_tasks, 1);
+	pgstromStatAdd(gcontext, GPUSTAT__NUM_TASKS, 1);
+}
+
+/*
+ * pgstromStatTaskDone - count down a GpuTask processed by worker thread
+ */
+static void
+pgstromStatTaskDone(GpuContext *gcontext)
+{
+	pg_atomic_sub_fetch_u32(gcontext->global_num_running_tasks, 1);
+	pg_atomic_sub_fetch_u32(&gcontext->num_running_tasks, 1);
+	if (gpu_stat_backend)
+		pg_atomic_sub_fetch_u32(&gpu_stat_backend->num_running_tasks, 1);
+}
+
 /*
  * GpuContextWorkerReportError
  */
 __thread GpuContext	   *GpuWorkerCurrentContext = NULL;
 __thread sigjmp_buf	   *GpuWorkerExceptionStack = NULL;
 __thread cl_int			GpuWorkerIndex = -1;
+__thread GpuTaskState  *GpuWorkerCurrentTaskState = NULL;
+static __thread cl_uint	GpuWorkerPhaseMask = 0;
+
+#define CU_TEVENT_PER_THREAD(phase)									\
+	(GpuWorkerCurrentContext->cuda_tevents[GpuWorkerIndex *			\
+										   GTS_PHASE__NITEMS + (phase)])
+
+/*
+ * gpuTaskPhaseMark - records a CUevent on the task stream at the boundary
+ * of the phases in cb_process_task, if EXPLAIN ANALYZE wants stage timing.
+ */
+void
+gpuTaskPhaseMark(GpuTaskPhase phase)
+{
+	GpuTaskState   *gts = GpuWorkerCurrentTaskState;
+	CUresult		rc;
+
+	Assert(phase >= 0 && phase < GTS_PHASE__NITEMS);
+	if (!gts || !gts->stage_timing)
+		return;
+	rc = cuEventRecord(CU_TEVENT_PER_THREAD(phase), CU_STREAM_PER_THREAD);
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuEventRecord: %s", errorText(rc));
+	GpuWorkerPhaseMask |= (1U << phase);
+}
+
+/*
+ * gpuTaskPhaseCollect - waits for the events recorded by gpuTaskPhaseMark,
+ * then accumulates the intervals between the adjacent phases on the
+ * DMA_SEND, KERNEL_EXEC and DMA_RECV stages.
+ *
+ * The worker loop calls it next to cb_process_task, so the handler has to
+ * call it by itself only when it resumes the kernel with new marks.
+ */
+void
+gpuTaskPhaseCollect(void)
+{
+	static const GpuTaskStage phase_stages[GTS_PHASE__NITEMS - 1] = {
+		GTS_STAGE__DMA_SEND,
+		GTS_STAGE__KERNEL_EXEC,
+		GTS_STAGE__DMA_RECV,
+	};
+	GpuTaskState   *gts = GpuWorkerCurrentTaskState;
+	cl_uint			mask = GpuWorkerPhaseMask;
+	float			elapsed;
+	CUresult		rc;
+	int				i;
+
+	GpuWorkerPhaseMask = 0;
+	if (!gts || !gts->stage_timing || mask == 0)
+		return;
+	/* wait for the last event recorded */
+	for (i = GTS_PHASE__NITEMS - 1; (mask & (1U << i)) == 0; i--);
+	rc = cuEventSynchronize(CU_TEVENT_PER_THREAD(i));
+	if (rc != CUDA_SUCCESS)
+		werror("failed on cuEventSynchronize: %s", errorText(rc));
+
+	for (i=0; i < GTS_PHASE__NITEMS - 1; i++)
+	{
+		if ((mask & (3U << i)) != (3U << i))
+			continue;
+		rc = cuEventElapsedTime(&elapsed,
+								CU_TEVENT_PER_THREAD(i),
+								CU_TEVENT_PER_THREAD(i+1));
+		if (rc != CUDA_SUCCESS)
+			werror("failed on cuEventElapsedTime: %s", errorText(rc));
+		if (elapsed > 0.0)
+			pg_atomic_add_fetch_u64(&gts->stage_nsec[phase_stages[i]],
+									(cl_ulong)(elapsed * 1000000.0));
+	}
+}
 
 void
 GpuContextWorkerReportError(int elevel,
@@ -674,6 +1092,7 @@ GpuContextWorkerMain(void *arg)
 			GpuTaskState *gts;
 			CUmodule	cuda_module;
 			cl_int		retval;
+			cl_ulong	tv_begin = 0;
 
 			pthreadMutexLock(gcontext->mutex);
 			if (dlist_is_empty(&gcontext->pending_tasks))
@@ -704,8 +1123,16 @@ GpuContextWorkerMain(void *arg)
 				pthreadMutexUnlock(gcontext->mutex);
 
 				gts = gtask->gts;
+				if (gts->stage_timing && gtask->tv_enqueue != 0)
+					gts_stage_trace(gts, GTS_STAGE__QUEUE_WAIT,
+									GPUTRACE__PICKUP, gtask->tv_enqueue,
+									gtask);
+				if (gts->stage_timing)
+					tv_begin = get_monotonic_nsec();
 				cuda_module = GpuContextLookupModule(gcontext,
 													 gtask->program_id);
+				if (gts->stage_timing)
+					gts_stage_elapsed(gts, GTS_STAGE__PROGRAM_WAIT, tv_begin);
 			retry_gputask:
 				/*
 				 * pgstromProcessGpuTask() returns the following status:
@@ -717,11 +1144,26 @@ GpuContextWorkerMain(void *arg)
 				 * <0 : GpuTask gets completed successfully, and the
 				 *      handler wants to release GpuTask immediately.
 				 */
+				if (gts->stage_timing)
+					tv_begin = get_monotonic_nsec();
+				GpuWorkerCurrentTaskState = gts;
+				GpuWorkerPhaseMask = 0;
 				retval = gts->cb_process_task(gtask, cuda_module);
+				gpuTaskPhaseCollect();
+				GpuWorkerCurrentTaskState = NULL;
+				if (gts->stage_timing)
+					gts_stage_trace(gts, GTS_STAGE__GPU_PROCESS,
+									GPUTRACE__GPU_PROCESS, tv_begin, gtask);
 				if (retval > 0)
 				{
 					/* wait for 40ms */
+					if (gts->stage_timing)
+						tv_begin = get_monotonic_nsec();
 					pg_usleep(40000L);
+					if (gts->stage_timing)
+						gts_stage_trace(gts, GTS_STAGE__RETRY_WAIT,
+										GPUTRACE__RETRY_WAIT, tv_begin,
+										gtask);
 					if (pg_atomic_read_u32(&gcontext->terminate_workers) == 0)
 						goto retry_gputask;
 					else
@@ -734,6 +1176,7 @@ GpuContextWorkerMain(void *arg)
 										&gtask->chain);
 						gts->num_running_tasks--;
 						pthreadMutexUnlock(gcontext->mutex);
+						pgstromStatTaskDone(gcontext);
 					}
 				}
 				else if (gtask->kerror.errcode != StromError_Success)
@@ -745,12 +1188,14 @@ GpuContextWorkerMain(void *arg)
 				else if (retval == 0)
 				{
 					/* Back GpuTask to GTS */
+					GPUTRACE_INSTANT(gcontext, GPUTRACE__COMPLETE, gtask);
 					pthreadMutexLock(gcontext->mutex);
 					dlist_push_tail(&gts->ready_tasks,
 									&gtask->chain);
 					gts->num_running_tasks--;
 					gts->num_ready_tasks++;
 					pthreadMutexUnlock(gcontext->mutex);
+					pgstromStatTaskDone(gcontext);
 
 					SetLatch(MyLatch);
 				}
@@ -760,6 +1205,8 @@ GpuContextWorkerMain(void *arg)
 					 * Release GpuTask immediately, expect for the last
 					 * GpuTask when retval==-2.
 					 */
+					GPUTRACE_INSTANT(gcontext, GPUTRACE__COMPLETE, gtask);
+					pgstromStatTaskDone(gcontext);
 					pthreadMutexLock(gcontext->mutex);
 					if (--gts->num_running_tasks == 0 &&
 						retval == -2 &&
@@ -862,7 +1309,7 @@ static void
 activate_cuda_workers(GpuContext *gcontext)
 {
 	CUresult	rc;
-	cl_int		i;
+	cl_int		i, j;
 
 	if (gcontext->worker_is_running)
 		return;
@@ -886,6 +1333,19 @@ activate_cuda_workers(GpuContext *gcontext)
 			if (rc != CUDA_SUCCESS)
 				elog(ERROR, "failed on cuEventCreate: %s", errorText(rc));
 		}
+
+		for (j=0; j < GTS_PHASE__NITEMS; j++)
+		{
+			CUevent	   *tevent = &gcontext->cuda_tevents[i *
+													 GTS_PHASE__NITEMS + j];
+			if (!*tevent)
+			{
+				rc = cuEventCreate(tevent, CU_EVENT_BLOCKING_SYNC);
+				if (rc != CUDA_SUCCESS)
+					elog(ERROR, "failed on cuEventCreate: %s",
+						 errorText(rc));
+			}
+		}
 	}
 	GPUCONTEXT_POP(gcontext);
 
@@ -904,6 +1364,41 @@ activate_cuda_workers(GpuContext *gcontext)
 	gcontext->worker_is_running = true;
 }
 
+/*
+ * assign_gpu_stat_backend - assign a statistics slot for this backend
+ *
+ * If no free slots, activities of this backend are counted only on the
+ * per-device statistics.
+ */
+static void
+assign_gpu_stat_backend(void)
+{
+	GpuStatBackend *slot = NULL;
+	int			i;
+
+	SpinLockAcquire(&gpu_stat_head->lock);
+	for (i=0; i < gpu_stat_head->num_backends; i++)
+	{
+		if (gpu_stat_head->backends[i].pid == 0)
+		{
+			slot = &gpu_stat_head->backends[i];
+			slot->pid = MyProcPid;
+			break;
+		}
+	}
+	SpinLockRelease(&gpu_stat_head->lock);
+	if (!slot)
+		return;
+
+	slot->userid = GetUserId();
+	slot->cuda_dindex = -1;
+	slot->gpu_start = GetCurrentTimestamp();
+	pg_atomic_write_u32(&slot->num_running_tasks, 0);
+	for (i=0; i < GPUSTAT__NITEMS; i++)
+		pg_atomic_write_u64(&slot->counters[i], 0);
+	gpu_stat_backend = slot;
+}
+
 /*
  * GetGpuContext - acquire a free GpuContext
  */
@@ -924,6 +1419,10 @@ AllocGpuContext(int cuda_dindex, bool never_use_mps,
 	if (rc != CUDA_SUCCESS)
 		elog(ERROR, "failed on gpuInit: %s", errorText(rc));
 
+	/* per-backend statistics slot, if not assigned yet */
+	if (!gpu_stat_backend)
+		assign_gpu_stat_backend();
+
 	/*
 	 * Lookup an existing active GpuContext
 	 */
@@ -946,12 +1445,13 @@ AllocGpuContext(int cuda_dindex, bool never_use_mps,
 	 * Not found, so allocate a new one
 	 */
 	gcontext = calloc(1, offsetof(GpuContext, worker_threads[num_workers]) +
-					  2 * sizeof(CUevent) * num_workers);
+					  (2 + GTS_PHASE__NITEMS) * sizeof(CUevent) * num_workers);
 	if (!gcontext)
 		elog(ERROR, "out of memory");
 	gcontext->cuda_events0 = (CUevent *)
 		((char *)gcontext + offsetof(GpuContext, worker_threads[num_workers]));
 	gcontext->cuda_events1 = gcontext->cuda_events0 + num_workers;
+	gcontext->cuda_tevents = gcontext->cuda_events1 + num_workers;
 
 	/* choose a device to use, if no preference */
 	if (cuda_dindex < 0)
@@ -998,6 +1498,8 @@ AllocGpuContext(int cuda_dindex, bool never_use_mps,
 	gcontext->worker_is_running = false;
 	gcontext->global_num_running_tasks
 		= &global_num_running_tasks[cuda_dindex];
+	pg_atomic_init_u32(&gcontext->num_running_tasks, 0);
+	gcontext->trace = gputrace_alloc(num_workers);
 	gcontext->mutex		= &ipc_entry->mutex;
 	gcontext->cond		= &ipc_entry->cond;
 	gcontext->command	= &ipc_entry->command;
@@ -1017,6 +1519,8 @@ AllocGpuContext(int cuda_dindex, bool never_use_mps,
 					&ipc_entry->chain);
 	SpinLockRelease(&gcontext_ipc_head->lock);
 activation:
+	if (gpu_stat_backend)
+		gpu_stat_backend->cuda_dindex = gcontext->cuda_dindex;
 	if (activate_context)
 		activate_cuda_context(gcontext);
 	if (activate_workers)
@@ -1094,6 +1598,9 @@ PutGpuContext(GpuContext *gcontext)
 		SpinLockRelease(&activeGpuContextLock);
 		/* wait for completion of worker threads */
 		SynchronizeGpuContext(gcontext);
+		/* write out the event trace, if any */
+		if (gcontext->trace)
+			gputrace_dump(gcontext);
 		/* cleanup local resources */
 		ReleaseLocalResources(gcontext, true);
 	}
@@ -1210,6 +1717,15 @@ gpucontext_cleanup_callback(ResourceReleasePhase phase,
 static void
 gpucontext_shmem_exit_cleanup(int code, Datum arg)
 {
+	/* release the statistics slot */
+	if (gpu_stat_backend)
+	{
+		SpinLockAcquire(&gpu_stat_head->lock);
+		gpu_stat_backend->pid = 0;
+		SpinLockRelease(&gpu_stat_head->lock);
+		gpu_stat_backend = NULL;
+	}
+
 	while (!dlist_is_empty(&activeGpuContextList))
 	{
 		dlist_node *dnode = dlist_pop_head_node(&activeGpuContextList);
@@ -1238,6 +1754,239 @@ gpucontext_shmem_exit_cleanup(int code, Datum arg)
 	}
 }
 
+/*
+ * pgstrom_stat_device
+ *
+ * It returns statistics of the GpuContext activities per device.
+ */
+Datum
+pgstrom_stat_device(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *fncxt;
+	Datum		values[14];
+	bool		isnull[14];
+	HeapTuple	tuple;
+	cl_int		dindex;
+	cl_ulong	normal_usage;
+	cl_ulong	managed_usage;
+	cl_ulong	iomap_usage;
+	pg_atomic_uint32 *running_tasks;
+	pg_atomic_uint64 *counters;
+	int			i;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc		tupdesc;
+		MemoryContext	oldcxt;
+
+		fncxt = SRF_FIRSTCALL_INIT();
+		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(14, false);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "device_nr",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "running_tasks",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "tasks",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "kernels",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "bytes_htod",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "bytes_dtoh",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 7, "cpu_fallbacks",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 8, "program_lookups",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 9, "program_hits",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 10, "normal_usage",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 11, "managed_usage",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 12, "iomap_usage",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 13, "total_memsz",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 14, "stats_reset",
+						   TIMESTAMPTZOID, -1, 0);
+		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
+
+		MemoryContextSwitchTo(oldcxt);
+	}
+	fncxt = SRF_PERCALL_SETUP();
+	dindex = fncxt->call_cntr;
+	if (dindex >= numDevAttrs)
+		SRF_RETURN_DONE(fncxt);
+
+	running_tasks = &global_num_running_tasks[dindex];
+	counters = &gpu_stat_head->device_counters[dindex * GPUSTAT__NITEMS];
+	gpuMemStatUsage(dindex, &normal_usage, &managed_usage, &iomap_usage);
+
+	memset(isnull, 0, sizeof(isnull));
+	values[0] = Int32GetDatum(devAttrs[dindex].DEV_ID);
+	values[1] = Int64GetDatum(pg_atomic_read_u32(running_tasks));
+	for (i=0; i < GPUSTAT__NITEMS; i++)
+		values[2+i] = Int64GetDatum(pg_atomic_read_u64(&counters[i]));
+	values[9] = Int64GetDatum(normal_usage);
+	values[10] = Int64GetDatum(managed_usage);
+	values[11] = Int64GetDatum(iomap_usage);
+	values[12] = Int64GetDatum(devAttrs[dindex].DEV_TOTAL_MEMSZ);
+	SpinLockAcquire(&gpu_stat_head->lock);
+	values[13] = TimestampTzGetDatum(gpu_stat_head->stats_reset);
+	SpinLockRelease(&gpu_stat_head->lock);
+
+	tuple = heap_form_tuple(fncxt->tuple_desc, values, isnull);
+
+	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
+}
+PG_FUNCTION_INFO_V1(pgstrom_stat_device);
+
+/*
+ * pgstrom_stat_activity
+ *
+ * It returns statistics of the GpuContext activities per backend which
+ * has ever used GPU devices.
+ */
+Datum
+pgstrom_stat_activity(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *fncxt;
+	Datum		values[12];
+	bool		isnull[12];
+	HeapTuple	tuple;
+	GpuStatBackend *lcopy;
+	List	   *slot_list;
+	int			i;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc		tupdesc;
+		MemoryContext	oldcxt;
+
+		fncxt = SRF_FIRSTCALL_INIT();
+		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(12, false);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "pid",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "usesysid",
+						   OIDOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "device_nr",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "gpu_start",
+						   TIMESTAMPTZOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "running_tasks",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "tasks",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 7, "kernels",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 8, "bytes_htod",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 9, "bytes_dtoh",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 10, "cpu_fallbacks",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 11, "program_lookups",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 12, "program_hits",
+						   INT8OID, -1, 0);
+		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
+
+		/*
+		 * collect a snapshot of the active slots; counters are updated
+		 * by atomic operations without locks, so values are copied one
+		 * by one.
+		 */
+		slot_list = NIL;
+		for (i=0; i < gpu_stat_head->num_backends; i++)
+		{
+			GpuStatBackend *slot = &gpu_stat_head->backends[i];
+			int		j;
+
+			lcopy = palloc0(sizeof(GpuStatBackend));
+			SpinLockAcquire(&gpu_stat_head->lock);
+			lcopy->pid = slot->pid;
+			lcopy->userid = slot->userid;
+			lcopy->cuda_dindex = slot->cuda_dindex;
+			lcopy->gpu_start = slot->gpu_start;
+			SpinLockRelease(&gpu_stat_head->lock);
+			if (lcopy->pid == 0)
+			{
+				pfree(lcopy);
+				continue;
+			}
+			pg_atomic_init_u32(&lcopy->num_running_tasks,
+							   pg_atomic_read_u32(&slot->num_running_tasks));
+			for (j=0; j < GPUSTAT__NITEMS; j++)
+				pg_atomic_init_u64(&lcopy->counters[j],
+								   pg_atomic_read_u64(&slot->counters[j]));
+			slot_list = lappend(slot_list, lcopy);
+		}
+		fncxt->user_fctx = slot_list;
+		MemoryContextSwitchTo(oldcxt);
+	}
+	fncxt = SRF_PERCALL_SETUP();
+	slot_list = (List *)fncxt->user_fctx;
+
+	if (slot_list == NIL)
+		SRF_RETURN_DONE(fncxt);
+	lcopy = linitial(slot_list);
+	fncxt->user_fctx = list_delete_first(slot_list);
+
+	memset(isnull, 0, sizeof(isnull));
+	values[0] = Int32GetDatum(lcopy->pid);
+	values[1] = ObjectIdGetDatum(lcopy->userid);
+	if (lcopy->cuda_dindex < 0)
+	{
+		isnull[2] = true;
+		values[2] = 0;
+	}
+	else
+		values[2] = Int32GetDatum(devAttrs[lcopy->cuda_dindex].DEV_ID);
+	values[3] = TimestampTzGetDatum(lcopy->gpu_start);
+	values[4] = Int64GetDatum(pg_atomic_read_u32(&lcopy->num_running_tasks));
+	for (i=0; i < GPUSTAT__NITEMS; i++)
+		values[5+i] = Int64GetDatum(pg_atomic_read_u64(&lcopy->counters[i]));
+
+	tuple = heap_form_tuple(fncxt->tuple_desc, values, isnull);
+
+	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
+}
+PG_FUNCTION_INFO_V1(pgstrom_stat_activity);
+
+/*
+ * pgstrom_stat_reset
+ *
+ * It resets the counters of pgstrom.stat_device and pgstrom.stat_activity.
+ * The number of running tasks and memory usage are current state, so kept
+ * as is.
+ */
+Datum
+pgstrom_stat_reset(PG_FUNCTION_ARGS)
+{
+	TimestampTz	now = GetCurrentTimestamp();
+	int			i, j;
+
+	for (i=0; i < numDevAttrs * GPUSTAT__NITEMS; i++)
+		pg_atomic_write_u64(&gpu_stat_head->device_counters[i], 0);
+	for (i=0; i < gpu_stat_head->num_backends; i++)
+	{
+		GpuStatBackend *slot = &gpu_stat_head->backends[i];
+
+		for (j=0; j < GPUSTAT__NITEMS; j++)
+			pg_atomic_write_u64(&slot->counters[j], 0);
+	}
+	SpinLockAcquire(&gpu_stat_head->lock);
+	gpu_stat_head->stats_reset = now;
+	SpinLockRelease(&gpu_stat_head->lock);
+
+	PG_RETURN_VOID();
+}
+PG_FUNCTION_INFO_V1(pgstrom_stat_reset);
+
 /*
  * pgstrom_startup_gpu_context
  */
@@ -1283,6 +2032,34 @@ pgstrom_startup_gpu_context(void)
 		dlist_push_tail(&gcontext_ipc_head->free_list,
 						&entry->chain);
 	}
+
+	gpu_stat_head =
+		ShmemInitStruct("Statistics of GpuContext activities",
+						MAXALIGN(offsetof(GpuStatHead,
+										  backends[gpu_stat_num_backends])) +
+						MAXALIGN(sizeof(pg_atomic_uint64) *
+								 GPUSTAT__NITEMS * numDevAttrs),
+						&found);
+	if (found)
+		elog(ERROR, "Bug? Statistics of GpuContext activities exists");
+	SpinLockInit(&gpu_stat_head->lock);
+	gpu_stat_head->stats_reset = GetCurrentTimestamp();
+	gpu_stat_head->device_counters = (pg_atomic_uint64 *)
+		((char *)gpu_stat_head +
+		 MAXALIGN(offsetof(GpuStatHead, backends[gpu_stat_num_backends])));
+	for (i=0; i < GPUSTAT__NITEMS * numDevAttrs; i++)
+		pg_atomic_init_u64(&gpu_stat_head->device_counters[i], 0);
+	gpu_stat_head->num_backends = gpu_stat_num_backends;
+	for (i=0; i < gpu_stat_num_backends; i++)
+	{
+		GpuStatBackend *slot = &gpu_stat_head->backends[i];
+		int		j;
+
+		memset(slot, 0, sizeof(GpuStatBackend));
+		pg_atomic_init_u32(&slot->num_running_tasks, 0);
+		for (j=0; j < GPUSTAT__NITEMS; j++)
+			pg_atomic_init_u64(&slot->counters[j], 0);
+	}
 }
 
 /*
@@ -1326,15 +2103,39 @@ pgstrom_init_gpu_context(void)
 							GUC_NOT_IN_SAMPLE | GUC_NO_SHOW_ALL,
 							NULL, NULL, NULL);
 
+	DefineCustomStringVariable("pg_strom.trace_directory",
+							   "Directory to write out event trace of GpuContext",
+							   NULL,
+							   &gpu_trace_directory,
+							   NULL,
+							   PGC_SUSET,
+							   GUC_NOT_IN_SAMPLE,
+							   NULL, NULL, NULL);
+	DefineCustomRealVariable("pg_strom.trace_sample_rate",
+							 "Fraction of GpuContexts to be traced",
+							 NULL,
+							 &gpu_trace_sample_rate,
+							 1.0,
+							 0.0,
+							 1.0,
+							 PGC_SUSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+
 	/* initialization of GpuContext List */
 	SpinLockInit(&activeGpuContextLock);
 	dlist_init(&activeGpuContextList);
 
 	/* shared memory */
+	gpu_stat_num_backends = max_nprocs;
 	RequestAddinShmemSpace(MAXALIGN(sizeof(pg_atomic_uint32) * numDevAttrs) +
 						   MAXALIGN(offsetof(GpuContextIPCHead,
 											ipc_entries[max_num_gpucontext])) +
-						   MAXALIGN(sizeof(dlist_head) * numDevAttrs));
+						   MAXALIGN(sizeof(dlist_head) * numDevAttrs) +
+						   MAXALIGN(offsetof(GpuStatHead,
+											 backends[gpu_stat_num_backends])) +
+						   MAXALIGN(sizeof(pg_atomic_uint64) *
+									GPUSTAT__NITEMS * numDevAttrs));
 	shmem_startup_next = shmem_startup_hook;
     shmem_startup_hook = pgstrom_startup_gpu_context;
 
@@ -1124,6 +1124,24 @@ gpuIpcMemCopyToHost(void *hbuffer,
 						  hbuffer, length, false);
 }
 
+/*
+ * gpuMemStatUsage - GPU device memory segments in use on the device
+ */
+void
+gpuMemStatUsage(cl_int cuda_dindex,
+				cl_ulong *p_normal_usage,
+				cl_ulong *p_managed_usage,
+				cl_ulong *p_iomap_usage)
+{
+	GpuMemStatistics *gm_stat;
+
+	Assert(cuda_dindex >= 0 && cuda_dindex < numDevAttrs);
+	gm_stat = &gm_stat_array[cuda_dindex];
+	*p_normal_usage  = pg_atomic_read_u64(&gm_stat->normal_usage);
+	*p_managed_usage = pg_atomic_read_u64(&gm_stat->managed_usage);
+	*p_iomap_usage   = pg_atomic_read_u64(&gm_stat->iomap_usage);
+}
+
 /*
  * pgstrom_gpu_mmgr_init_gpucontext - Per GpuContext initialization
  */
@@ -1223,6 +1241,18 @@ gpummgrHandleAllocPreserved(GpuMemPreservedRequest *gmemp_req)
 	if (rc != CUDA_SUCCESS)
 		goto error_0;
 
+	if (gmemp_req->cuda_dindex < 0)
+	{
+		/*
+		 * host memory only; DSM handle is unique while the segment is
+		 * alive, so it is also used as identifier of the region.
+		 */
+		m_devptr = 0UL;
+		memset(&m_handle, 0, sizeof(CUipcMemHandle));
+		memcpy(&m_handle, &h_handle, sizeof(dsm_handle));
+		goto setup;
+	}
+
 	rc = cuCtxPushCurrent(gpummgr_cuda_context[gmemp_req->cuda_dindex]);
 	if (rc != CUDA_SUCCESS)
 	{
@@ -1250,8 +1280,7 @@ gpummgrHandleAllocPreserved(GpuMemPreservedRequest *gmemp_req)
 		elog(WARNING, "failed on cuCtxPopCurrent: %s", errorText(rc));
 		goto error_2;
 	}
-	INIT_LEGACY_CRC32(crc);
-
+setup:
 	gmemp->cuda_dindex = gmemp_req->cuda_dindex;
 	gmemp->bytesize	= gmemp_req->bytesize;
 	gmemp->h_seg = h_seg;
@@ -1318,6 +1347,9 @@ gpummgrHandleLoadPreserved(GpuMemPreservedRequest *gmemp_req)
 	}
 	if (!gmemp)
 		return CUDA_ERROR_NOT_FOUND;
+	/* nothing to do for host memory */
+	if (gmemp->cuda_dindex < 0)
+		return CUDA_SUCCESS;
 
 	rc = cuCtxPushCurrent(gpummgr_cuda_context[gmemp_req->cuda_dindex]);
 	if (rc != CUDA_SUCCESS)
@@ -1389,13 +1421,19 @@ gpummgrHandleFreePreserved(GpuMemPreservedRequest *gmemp_req)
 	}
 	PG_END_TRY();
 
-	rc = cuMemFree(gmemp->m_devptr);
-	if (rc != CUDA_SUCCESS)
+	if (gmemp->cuda_dindex >= 0)
 	{
-		elog(WARNING, "failed on cuMemFree: %s", errorText(rc));
-		result = rc;
+		rc = cuMemFree(gmemp->m_devptr);
+		if (rc != CUDA_SUCCESS)
+		{
+			elog(WARNING, "failed on cuMemFree: %s", errorText(rc));
+			result = rc;
+		}
+		elog(LOG, "free: preserved memory at %p", (void *)gmemp->m_devptr);
 	}
-	elog(LOG, "free: preserved memory at %p", (void *)gmemp->m_devptr);
+	else
+		elog(LOG, "free: preserved host memory (handle: %u)",
+			 gmemp->h_handle);
 
 	dlist_delete(&gmemp->chain);
 	memset(gmemp, 0, sizeof(GpuMemPreserved));
@@ -1491,7 +1529,7 @@ gpummgrBgWorkerMain(Datum arg)
 			gmemp_req = dlist_container(GpuMemPreservedRequest, chain,
 				dlist_pop_head_node(&gmemp_head->gmemp_req_pending_list));
 			memset(&gmemp_req->chain, 0, sizeof(dlist_node));
-			Assert(gmemp_req->cuda_dindex >= 0 &&
+			Assert(gmemp_req->cuda_dindex >= -1 &&
 				   gmemp_req->cuda_dindex < numDevAttrs);
 			if (gmemp_req->bytesize > 0)
 				rc = gpummgrHandleAllocPreserved(gmemp_req);
@@ -1582,9 +1620,12 @@ pgstrom_device_preserved_meminfo(PG_FUNCTION_ARGS)
 	fncxt->user_fctx = list_delete_first(gmemp_list);
 
 	memset(isnull, 0, sizeof(isnull));
-	Assert(gmemp->cuda_dindex >= 0 &&
+	Assert(gmemp->cuda_dindex >= -1 &&
 		   gmemp->cuda_dindex < numDevAttrs);
-	values[0] = Int32GetDatum(devAttrs[gmemp->cuda_dindex].DEV_ID);
+	if (gmemp->cuda_dindex < 0)
+		values[0] = Int32GetDatum(-1);		/* host memory */
+	else
+		values[0] = Int32GetDatum(devAttrs[gmemp->cuda_dindex].DEV_ID);
 	if (superuser() || has_privs_of_role(GetUserId(), gmemp->owner))
 	{
 		temp = palloc(sizeof(CUipcMemHandle) + VARHDRSZ);
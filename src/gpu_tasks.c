@@ -17,6 +17,51 @@
  */
 #include "pg_strom.h"
 
+/*
+ * Cost feedback
+ *
+ * GPU nodes executed with per-stage timing (EXPLAIN ANALYZE, or auto_explain
+ * with log_analyze) record their actual behavior towards the estimation of
+ * the planner on the shared ring buffer. It is the source of the per-device
+ * cost coefficients fitted by pgstrom.cost_feedback_fit().
+ */
+#define COST_FEEDBACK_NSLOTS		1024
+
+typedef struct
+{
+	TimestampTz	ts;
+	Oid			database_oid;
+	cl_int		cuda_dindex;
+	char		node_name[32];
+	double		nloops;
+	double		plan_rows;		/* estimated rows per loop */
+	double		actual_rows;	/* actual rows per loop */
+	Cost		startup_cost;	/* estimated startup cost */
+	Cost		total_cost;		/* estimated total cost */
+	double		actual_time;	/* actual time per loop [ms] */
+	double		gpu_time;		/* total of GTS_STAGE__GPU_PROCESS [ms] */
+	cl_long		nchunks;
+	cl_ulong	source_nitems;
+	cl_ulong	num_kernels;
+	cl_ulong	bytes_htod;
+	cl_ulong	bytes_dtoh;
+} CostFeedbackEntry;
+
+typedef struct
+{
+	slock_t		lock;
+	cl_ulong	nitems;			/* # of entries ever recorded */
+	CostFeedbackEntry entries[COST_FEEDBACK_NSLOTS];
+} CostFeedbackHead;
+
+static shmem_startup_hook_type shmem_startup_next = NULL;
+static CostFeedbackHead *cost_feedback_head = NULL;	/* shared */
+static bool		pgstrom_cost_feedback;				/* GUC */
+
+Datum pgstrom_cost_feedback_info(PG_FUNCTION_ARGS);
+Datum pgstrom_cost_feedback_fit(PG_FUNCTION_ARGS);
+Datum pgstrom_cost_feedback_reset(PG_FUNCTION_ARGS);
+
 /*
  * construct_kern_parambuf
  *
@@ -228,6 +273,7 @@ pgstromInitGpuTaskState(GpuTaskState *gts,
 	CustomScan	   *cscan = (CustomScan *)(gts->css.ss.ps.plan);
 	Bitmapset	   *outer_refs = NULL;
 	ListCell	   *lc;
+	int				i;
 
 	Assert(gts->gcontext == gcontext);
 	gts->optimal_gpu = optimal_gpu;
@@ -280,6 +326,14 @@ pgstromInitGpuTaskState(GpuTaskState *gts,
 	dlist_init(&gts->ready_tasks);
 	gts->num_ready_tasks = 0;
 
+	/* per-stage timing, only if EXPLAIN ANALYZE with TIMING or traced */
+	gts->stage_timing = ((estate->es_instrument & INSTRUMENT_TIMER) != 0 ||
+						 gcontext->trace != NULL);
+	for (i=0; i < GTS_STAGE__NITEMS; i++)
+		pg_atomic_init_u64(&gts->stage_nsec[i], 0);
+	for (i=0; i < GPUSTAT__NITEMS; i++)
+		pg_atomic_init_u64(&gts->stat_counters[i], 0);
+
 	/* co-operation with CPU parallel (setup by DSM init handler) */
 	gts->pcxt = NULL;
 }
@@ -296,6 +350,7 @@ fetch_next_gputask(GpuTaskState *gts)
 	cl_int			local_num_running_tasks;
 	cl_int			global_num_running_tasks;
 	cl_int			ev;
+	cl_ulong		tv_begin = 0;
 
 	/* force activate GpuContext on demand */
 	Assert(gcontext->worker_is_running);
@@ -315,16 +370,24 @@ fetch_next_gputask(GpuTaskState *gts)
 			 gts->num_running_tasks == 0))
 		{
 			pthreadMutexUnlock(gcontext->mutex);
+			if (gts->stage_timing)
+				tv_begin = get_monotonic_nsec();
 			gtask = gts->cb_next_task(gts);
+			if (gts->stage_timing)
+				gts_stage_trace(gts, GTS_STAGE__BUILD_CHUNK,
+								GPUTRACE__BUILD_CHUNK, tv_begin, gtask);
 			pthreadMutexLock(gcontext->mutex);
 			if (!gtask)
 			{
 				gts->scan_done = true;
 				break;
 			}
+			if (gts->stage_timing)
+				gtask->tv_enqueue = get_monotonic_nsec();
 			dlist_push_tail(&gcontext->pending_tasks, &gtask->chain);
 			gts->num_running_tasks++;
-			pg_atomic_add_fetch_u32(gcontext->global_num_running_tasks, 1);
+			pgstromStatTaskEnqueued(gcontext);
+			GPUTRACE_INSTANT(gcontext, GPUTRACE__ENQUEUE, gtask);
 			pthreadCondSignal(gcontext->cond);
 		}
 		else if (!dlist_is_empty(&gts->ready_tasks))
@@ -345,6 +408,8 @@ fetch_next_gputask(GpuTaskState *gts)
 			 */
 			pthreadMutexUnlock(gcontext->mutex);
 
+			if (gts->stage_timing)
+				tv_begin = get_monotonic_nsec();
 			ev = WaitLatch(MyLatch,
 						   WL_LATCH_SET |
 						   WL_TIMEOUT |
@@ -355,6 +420,9 @@ fetch_next_gputask(GpuTaskState *gts)
 				ereport(FATAL,
 						(errcode(ERRCODE_ADMIN_SHUTDOWN),
 						 errmsg("Unexpected Postmaster dead")));
+			if (gts->stage_timing)
+				gts_stage_trace(gts, GTS_STAGE__SYNC_WAIT,
+								GPUTRACE__SYNC_WAIT, tv_begin, NULL);
 			CHECK_FOR_GPUCONTEXT(gcontext);
 
 			pthreadMutexLock(gcontext->mutex);
@@ -365,7 +433,12 @@ fetch_next_gputask(GpuTaskState *gts)
 			/*
 			 * Sadly, we touched a threshold. Taks a short break.
 			 */
+			if (gts->stage_timing)
+				tv_begin = get_monotonic_nsec();
 			pg_usleep(20000L);	/* wait for 20msec */
+			if (gts->stage_timing)
+				gts_stage_trace(gts, GTS_STAGE__SYNC_WAIT,
+								GPUTRACE__SYNC_WAIT, tv_begin, NULL);
 
 			CHECK_FOR_GPUCONTEXT(gcontext);
 			pthreadMutexLock(gcontext->mutex);
@@ -394,7 +467,12 @@ retry:
 			{
 				cl_bool		is_ready = false;
 
+				if (gts->stage_timing)
+					tv_begin = get_monotonic_nsec();
 				gtask = gts->cb_terminator_task(gts, &is_ready);
+				if (gts->stage_timing)
+					gts_stage_trace(gts, GTS_STAGE__BUILD_CHUNK,
+									GPUTRACE__BUILD_CHUNK, tv_begin, gtask);
 				pthreadMutexLock(gcontext->mutex);
 				if (gtask)
 				{
@@ -406,10 +484,13 @@ retry:
 					}
 					else
 					{
+						if (gts->stage_timing)
+							gtask->tv_enqueue = get_monotonic_nsec();
 						dlist_push_tail(&gcontext->pending_tasks,
 										&gtask->chain);
 						gts->num_running_tasks++;
-						pg_atomic_add_fetch_u32(gcontext->global_num_running_tasks, 1);
+						pgstromStatTaskEnqueued(gcontext);
+						GPUTRACE_INSTANT(gcontext, GPUTRACE__ENQUEUE, gtask);
 						pthreadCondSignal(gcontext->cond);
 					}
 					goto retry;
@@ -422,6 +503,8 @@ retry:
 
 		CHECK_FOR_GPUCONTEXT(gcontext);
 
+		if (gts->stage_timing)
+			tv_begin = get_monotonic_nsec();
 		ev = WaitLatch(MyLatch,
 					   WL_LATCH_SET |
 					   WL_TIMEOUT |
@@ -432,6 +515,9 @@ retry:
 			ereport(FATAL,
 					(errcode(ERRCODE_ADMIN_SHUTDOWN),
 					 errmsg("Unexpected Postmaster dead")));
+		if (gts->stage_timing)
+			gts_stage_trace(gts, GTS_STAGE__SYNC_WAIT,
+							GPUTRACE__SYNC_WAIT, tv_begin, NULL);
 
 		pthreadMutexLock(gcontext->mutex);
 		ResetLatch(MyLatch);
@@ -447,6 +533,29 @@ pickup_gputask:
 	return gtask;
 }
 
+/*
+ * next_tuple_gputask - cb_next_tuple with per-stage timing, if needed
+ */
+static inline TupleTableSlot *
+next_tuple_gputask(GpuTaskState *gts)
+{
+	TupleTableSlot *slot;
+	GpuTaskStage	stage;
+	cl_ulong		tv_begin;
+
+	if (!gts->stage_timing)
+		return gts->cb_next_tuple(gts);
+
+	stage = (gts->curr_task->cpu_fallback
+			 ? GTS_STAGE__CPU_FALLBACK
+			 : GTS_STAGE__FETCH_TUPLE);
+	tv_begin = get_monotonic_nsec();
+	slot = gts->cb_next_tuple(gts);
+	gts_stage_elapsed(gts, stage, tv_begin);
+
+	return slot;
+}
+
 /*
  * pgstromExecGpuTaskState
  */
@@ -455,7 +564,7 @@ pgstromExecGpuTaskState(GpuTaskState *gts)
 {
 	TupleTableSlot *slot = NULL;
 
-	while (!gts->curr_task || !(slot = gts->cb_next_tuple(gts)))
+	while (!gts->curr_task || !(slot = next_tuple_gputask(gts)))
 	{
 		GpuTask	   *gtask = gts->curr_task;
 
@@ -472,7 +581,12 @@ pgstromExecGpuTaskState(GpuTaskState *gts)
 		if (!gtask)
 			return NULL;
 		if (gtask->cpu_fallback)
+		{
 			gts->num_cpu_fallbacks++;
+			pgstromStatAdd(gts->gcontext, GPUSTAT__NUM_FALLBACKS, 1);
+			GPUTRACE_INSTANT(gts->gcontext, GPUTRACE__CPU_FALLBACK, gtask);
+		}
+		gts->num_chunks++;
 		gts->curr_task = gtask;
 		gts->curr_index = 0;
 		gts->curr_lp_index = 0;
@@ -530,12 +644,84 @@ pgstromRescanGpuTaskState(GpuTaskState *gts)
 	}
 }
 
+/*
+ * pgstromRecordCostFeedback
+ *
+ * It records the actual behavior of the GPU node towards the estimation.
+ * Instrumentation of the node shall be already finalized by EXPLAIN, or
+ * the current loop is still counted if not.
+ */
+static void
+pgstromRecordCostFeedback(GpuTaskState *gts, GpuTaskRuntimeStat *gt_rtstat)
+{
+	Instrumentation *instr = gts->css.ss.ps.instrument;
+	Plan	   *plan = gts->css.ss.ps.plan;
+	CostFeedbackEntry entry;
+	cl_ulong	gpu_nsec;
+	double		nloops;
+	double		ntuples;
+	double		total_time;
+
+	if (!pgstrom_cost_feedback || !gts->stage_timing ||
+		!instr || !instr->need_timer || gts->num_chunks == 0)
+		return;
+	/*
+	 * Counters of the parallel-aware node are partial in the individual
+	 * processes, so we don't record them.
+	 */
+	if (gts->gtss != NULL || IsParallelWorker())
+		return;
+
+	nloops = instr->nloops;
+	ntuples = instr->ntuples + instr->tuplecount;
+	total_time = instr->total;
+	if (instr->running)
+	{
+		nloops += 1.0;
+		total_time += INSTR_TIME_GET_DOUBLE(instr->counter);
+	}
+	if (nloops <= 0.0)
+		return;
+
+	memset(&entry, 0, sizeof(CostFeedbackEntry));
+	entry.ts = GetCurrentTimestamp();
+	entry.database_oid = MyDatabaseId;
+	entry.cuda_dindex = gts->gcontext->cuda_dindex;
+	strlcpy(entry.node_name, gts->css.methods->CustomName,
+			sizeof(entry.node_name));
+	entry.nloops = nloops;
+	entry.plan_rows = plan->plan_rows;
+	entry.actual_rows = ntuples / nloops;
+	entry.startup_cost = plan->startup_cost;
+	entry.total_cost = plan->total_cost;
+	entry.actual_time = 1000.0 * total_time / nloops;
+	gpu_nsec = pg_atomic_read_u64(&gts->stage_nsec[GTS_STAGE__GPU_PROCESS]);
+	entry.gpu_time = (double) gpu_nsec / 1000000.0;
+	entry.nchunks = gts->num_chunks;
+	if (gt_rtstat)
+		entry.source_nitems = pg_atomic_read_u64(&gt_rtstat->source_nitems);
+	entry.num_kernels =
+		pg_atomic_read_u64(&gts->stat_counters[GPUSTAT__NUM_KERNELS]);
+	entry.bytes_htod =
+		pg_atomic_read_u64(&gts->stat_counters[GPUSTAT__BYTES_HTOD]);
+	entry.bytes_dtoh =
+		pg_atomic_read_u64(&gts->stat_counters[GPUSTAT__BYTES_DTOH]);
+
+	SpinLockAcquire(&cost_feedback_head->lock);
+	memcpy(&cost_feedback_head->entries[cost_feedback_head->nitems++ %
+										COST_FEEDBACK_NSLOTS],
+		   &entry, sizeof(CostFeedbackEntry));
+	SpinLockRelease(&cost_feedback_head->lock);
+}
+
 /*
  * pgstromReleaseGpuTaskState
  */
 void
 pgstromReleaseGpuTaskState(GpuTaskState *gts, GpuTaskRuntimeStat *gt_rtstat)
 {
+	/* record the actual behavior for the cost feedback, if any */
+	pgstromRecordCostFeedback(gts, gt_rtstat);
 	/*
 	 * release any unprocessed tasks
 	 */
@@ -560,6 +746,47 @@ pgstromReleaseGpuTaskState(GpuTaskState *gts, GpuTaskRuntimeStat *gt_rtstat)
 	PutGpuContext(gts->gcontext);
 }
 
+/*
+ * pgstromExplainGpuTaskStage - per-stage timing of GpuTasks
+ */
+static void
+pgstromExplainGpuTaskStage(GpuTaskState *gts, ExplainState *es)
+{
+	static const char *stage_labels[GTS_STAGE__NITEMS][2] = {
+		{ "build",    "Chunk Build Time" },
+		{ "queue",    "Queue Wait Time" },
+		{ "retry",    "Retry Wait Time" },
+		{ "gpu",      "GPU Process Time" },
+		{ "send",     "DMA Send Time" },
+		{ "kernel",   "Kernel Exec Time" },
+		{ "recv",     "DMA Receive Time" },
+		{ "program",  "Program Wait Time" },
+		{ "sync",     "Sync Wait Time" },
+		{ "fetch",    "Tuple Fetch Time" },
+		{ "fallback", "CPU Fallback Time" },
+	};
+	StringInfoData	str;
+	int				i;
+
+	initStringInfo(&str);
+	for (i=0; i < GTS_STAGE__NITEMS; i++)
+	{
+		double	msec = (double)
+			pg_atomic_read_u64(&gts->stage_nsec[i]) / 1000000.0;
+
+		if (es->format != EXPLAIN_FORMAT_TEXT)
+			ExplainPropertyFloat(stage_labels[i][1], "ms", msec, 3, es);
+		else if (msec > 0.0)
+			appendStringInfo(&str, "%s%s: %s",
+							 str.len > 0 ? ", " : "",
+							 stage_labels[i][0],
+							 format_millisec(msec));
+	}
+	if (es->format == EXPLAIN_FORMAT_TEXT && str.len > 0)
+		ExplainPropertyText("Stage Time", str.data, es);
+	pfree(str.data);
+}
+
 /*
  * pgstromExplainGpuTaskState
  */
@@ -615,6 +842,13 @@ pgstromExplainGpuTaskState(GpuTaskState *gts, ExplainState *es)
 	if (es->analyze && gts->num_cpu_fallbacks > 0)
 		ExplainPropertyInteger("CPU fallbacks",
 							   NULL, gts->num_cpu_fallbacks, es);
+	/* Number of chunks processed */
+	if (es->analyze && es->format != EXPLAIN_FORMAT_TEXT)
+		ExplainPropertyInteger("Processed chunks",
+							   NULL, gts->num_chunks, es);
+	/* Per-stage timing, if EXPLAIN ANALYZE with TIMING */
+	if (es->analyze && es->timing && gts->stage_timing)
+		pgstromExplainGpuTaskStage(gts, es);
 
 	/* Source path of the GPU kernel */
 	if (es->verbose &&
@@ -718,6 +952,419 @@ pgstromInitGpuTask(GpuTaskState *gts, GpuTask *gtask)
 	gtask->program_id   = gts->program_id;
 	gtask->gts          = gts;
 	gtask->cpu_fallback = false;
+	gtask->tv_enqueue   = 0;
+	gtask->trace_id     = 0;
+}
+
+/*
+ * pgstrom_cost_feedback_info
+ *
+ * It returns the recent records of the cost feedback.
+ */
+typedef struct
+{
+	int			nitems;
+	int			index;
+	CostFeedbackEntry entries[FLEXIBLE_ARRAY_MEMBER];
+} CostFeedbackSnapshot;
+
+static CostFeedbackSnapshot *
+cost_feedback_snapshot(void)
+{
+	CostFeedbackSnapshot *snap;
+	cl_ulong	nitems;
+	cl_ulong	i;
+
+	snap = palloc(offsetof(CostFeedbackSnapshot,
+						   entries[COST_FEEDBACK_NSLOTS]));
+	SpinLockAcquire(&cost_feedback_head->lock);
+	nitems = cost_feedback_head->nitems;
+	i = (nitems > COST_FEEDBACK_NSLOTS ? nitems - COST_FEEDBACK_NSLOTS : 0);
+	snap->nitems = 0;
+	while (i < nitems)
+	{
+		memcpy(&snap->entries[snap->nitems++],
+			   &cost_feedback_head->entries[i++ % COST_FEEDBACK_NSLOTS],
+			   sizeof(CostFeedbackEntry));
+	}
+	SpinLockRelease(&cost_feedback_head->lock);
+	snap->index = 0;
+
+	return snap;
+}
+
+Datum
+pgstrom_cost_feedback_info(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *fncxt;
+	CostFeedbackSnapshot *snap;
+	CostFeedbackEntry *entry;
+	Datum		values[16];
+	bool		isnull[16];
+	HeapTuple	tuple;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc		tupdesc;
+		MemoryContext	oldcxt;
+
+		fncxt = SRF_FIRSTCALL_INIT();
+		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(16, false);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "ts",
+						   TIMESTAMPTZOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "datid",
+						   OIDOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "device_nr",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "node",
+						   TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "nloops",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "plan_rows",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 7, "actual_rows",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 8, "startup_cost",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 9, "total_cost",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 10, "actual_time",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 11, "gpu_time",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 12, "chunks",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 13, "source_rows",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 14, "kernels",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 15, "bytes_htod",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 16, "bytes_dtoh",
+						   INT8OID, -1, 0);
+		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
+		fncxt->user_fctx = cost_feedback_snapshot();
+
+		MemoryContextSwitchTo(oldcxt);
+	}
+	fncxt = SRF_PERCALL_SETUP();
+	snap = (CostFeedbackSnapshot *) fncxt->user_fctx;
+
+	if (snap->index >= snap->nitems)
+		SRF_RETURN_DONE(fncxt);
+	entry = &snap->entries[snap->index++];
+
+	memset(isnull, 0, sizeof(isnull));
+	values[0] = TimestampTzGetDatum(entry->ts);
+	values[1] = ObjectIdGetDatum(entry->database_oid);
+	values[2] = Int32GetDatum(devAttrs[entry->cuda_dindex].DEV_ID);
+	values[3] = CStringGetTextDatum(entry->node_name);
+	values[4] = Float8GetDatum(entry->nloops);
+	values[5] = Float8GetDatum(entry->plan_rows);
+	values[6] = Float8GetDatum(entry->actual_rows);
+	values[7] = Float8GetDatum(entry->startup_cost);
+	values[8] = Float8GetDatum(entry->total_cost);
+	values[9] = Float8GetDatum(entry->actual_time);
+	values[10] = Float8GetDatum(entry->gpu_time);
+	values[11] = Int64GetDatum(entry->nchunks);
+	values[12] = Int64GetDatum(entry->source_nitems);
+	values[13] = Int64GetDatum(entry->num_kernels);
+	values[14] = Int64GetDatum(entry->bytes_htod);
+	values[15] = Int64GetDatum(entry->bytes_dtoh);
+
+	tuple = heap_form_tuple(fncxt->tuple_desc, values, isnull);
+
+	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
+}
+PG_FUNCTION_INFO_V1(pgstrom_cost_feedback_info);
+
+/*
+ * cost_feedback_solve
+ *
+ * It solves the least squares with non-negative coefficients, because none
+ * of the costs should be negative. Its solution is the least squares on a
+ * subset of the variables, with the others fixed to zero, so we solve the
+ * normal equation (X^T X) beta = X^T y on every subset by Gauss-Jordan
+ * elimination, then choose the non-negative one with the least residual.
+ * It is exhaustive, but only 2^COST_FEEDBACK_NVARS subsets.
+ */
+#define COST_FEEDBACK_NVARS		3
+
+static bool
+cost_feedback_solve_subset(double xtx[COST_FEEDBACK_NVARS][COST_FEEDBACK_NVARS],
+						   double xty[COST_FEEDBACK_NVARS],
+						   int mask,
+						   double beta[COST_FEEDBACK_NVARS])
+{
+	double	a[COST_FEEDBACK_NVARS][COST_FEEDBACK_NVARS + 1];
+	double	temp;
+	int		index[COST_FEEDBACK_NVARS];
+	int		n = 0;
+	int		i, j, k;
+
+	memset(beta, 0, sizeof(double) * COST_FEEDBACK_NVARS);
+	for (i=0; i < COST_FEEDBACK_NVARS; i++)
+	{
+		if ((mask & (1 << i)) != 0)
+			index[n++] = i;
+	}
+	for (i=0; i < n; i++)
+	{
+		for (j=0; j < n; j++)
+			a[i][j] = xtx[index[i]][index[j]];
+		a[i][n] = xty[index[i]];
+	}
+
+	for (k=0; k < n; k++)
+	{
+		int		pivot = k;
+
+		for (i=k+1; i < n; i++)
+		{
+			if (fabs(a[i][k]) > fabs(a[pivot][k]))
+				pivot = i;
+		}
+		/* singular; variable is dependent on the others */
+		if (fabs(a[pivot][k]) <= 1.0e-12 * xtx[index[k]][index[k]])
+			return false;
+		if (pivot != k)
+		{
+			for (j=0; j <= n; j++)
+			{
+				temp = a[k][j];
+				a[k][j] = a[pivot][j];
+				a[pivot][j] = temp;
+			}
+		}
+		for (i=0; i < n; i++)
+		{
+			if (i == k)
+				continue;
+			temp = a[i][k] / a[k][k];
+			for (j=k; j <= n; j++)
+				a[i][j] -= temp * a[k][j];
+		}
+	}
+
+	for (k=0; k < n; k++)
+	{
+		beta[index[k]] = a[k][n] / a[k][k];
+		if (beta[index[k]] < 0.0)
+			return false;
+	}
+	return true;
+}
+
+static void
+cost_feedback_solve(double xtx[COST_FEEDBACK_NVARS][COST_FEEDBACK_NVARS],
+					double xty[COST_FEEDBACK_NVARS],
+					double beta[COST_FEEDBACK_NVARS])
+{
+	double	temp[COST_FEEDBACK_NVARS];
+	double	resid;
+	double	best = 0.0;		/* residual of beta = 0 */
+	int		mask, i, j;
+
+	memset(beta, 0, sizeof(double) * COST_FEEDBACK_NVARS);
+	for (mask=1; mask < (1 << COST_FEEDBACK_NVARS); mask++)
+	{
+		/* variables never observed are not a part of the model */
+		for (i=0; i < COST_FEEDBACK_NVARS; i++)
+		{
+			if ((mask & (1 << i)) != 0 && xtx[i][i] <= 0.0)
+				break;
+		}
+		if (i < COST_FEEDBACK_NVARS ||
+			!cost_feedback_solve_subset(xtx, xty, mask, temp))
+			continue;
+		/* |y - X beta|^2 - |y|^2 = beta^T (X^T X) beta - 2 beta^T X^T y */
+		resid = 0.0;
+		for (i=0; i < COST_FEEDBACK_NVARS; i++)
+		{
+			for (j=0; j < COST_FEEDBACK_NVARS; j++)
+				resid += temp[i] * xtx[i][j] * temp[j];
+			resid -= 2.0 * temp[i] * xty[i];
+		}
+		if (resid < best)
+		{
+			best = resid;
+			memcpy(beta, temp, sizeof(double) * COST_FEEDBACK_NVARS);
+		}
+	}
+}
+
+/*
+ * pgstrom_cost_feedback_fit
+ *
+ * It fits the per-device coefficients of the GPU cost model using the
+ * records of the cost feedback since the given timestamp (or all the
+ * records if NULL), as follows:
+ *
+ *   gpu_time = kernel_ms * kernels + (bytes / dma_mbps) + row_ns * rows
+ *
+ * gpu_time is the total time of GPU processing (DMA and kernel execution)
+ * by the worker threads. Records without the number of source rows (like
+ * GpuPreAgg) are not used for fitting.
+ */
+typedef struct
+{
+	int			cuda_dindex;
+	cl_long		nsamples;
+	double		xtx[COST_FEEDBACK_NVARS][COST_FEEDBACK_NVARS];
+	double		xty[COST_FEEDBACK_NVARS];
+	double		sum_kernels;
+	double		sum_chunks;
+} CostFeedbackFitState;
+
+Datum
+pgstrom_cost_feedback_fit(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *fncxt;
+	CostFeedbackFitState *fstate;
+	Datum		values[6];
+	bool		isnull[6];
+	HeapTuple	tuple;
+	double		beta[COST_FEEDBACK_NVARS];
+	double		chunk_mb;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc		tupdesc;
+		MemoryContext	oldcxt;
+		CostFeedbackSnapshot *snap;
+		TimestampTz		since = (PG_ARGISNULL(0)
+								 ? DT_NOBEGIN
+								 : PG_GETARG_TIMESTAMPTZ(0));
+		int				i, j, k;
+
+		fncxt = SRF_FIRSTCALL_INIT();
+		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(6, false);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "device_nr",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "nsamples",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "kernel_ms",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "dma_mbps",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "row_ns",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "chunk_ms",
+						   FLOAT8OID, -1, 0);
+		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
+
+		fstate = palloc0(sizeof(CostFeedbackFitState) * numDevAttrs);
+		snap = cost_feedback_snapshot();
+		for (i=0; i < snap->nitems; i++)
+		{
+			CostFeedbackEntry *entry = &snap->entries[i];
+			CostFeedbackFitState *fs;
+			double		x[COST_FEEDBACK_NVARS];
+			double		y;
+
+			if (entry->ts < since ||
+				entry->source_nitems == 0 ||
+				entry->gpu_time <= 0.0)
+				continue;
+			/* kernels, MB of DMA, and million rows */
+			x[0] = (double) entry->num_kernels;
+			x[1] = (double)(entry->bytes_htod +
+							entry->bytes_dtoh) / (double)(1UL << 20);
+			x[2] = (double) entry->source_nitems / 1000000.0;
+			y = entry->gpu_time;
+
+			fs = &fstate[entry->cuda_dindex];
+			for (j=0; j < COST_FEEDBACK_NVARS; j++)
+			{
+				for (k=0; k < COST_FEEDBACK_NVARS; k++)
+					fs->xtx[j][k] += x[j] * x[k];
+				fs->xty[j] += x[j] * y;
+			}
+			fs->sum_kernels += x[0];
+			fs->sum_chunks += (double) entry->nchunks;
+			fs->nsamples++;
+		}
+		pfree(snap);
+		/* only devices with records are returned */
+		for (i=0, j=0; i < numDevAttrs; i++)
+		{
+			if (fstate[i].nsamples == 0)
+				continue;
+			if (i != j)
+				memcpy(&fstate[j], &fstate[i], sizeof(CostFeedbackFitState));
+			fstate[j++].cuda_dindex = i;
+		}
+		fncxt->user_fctx = fstate;
+		fncxt->max_calls = j;
+
+		MemoryContextSwitchTo(oldcxt);
+	}
+	fncxt = SRF_PERCALL_SETUP();
+	fstate = (CostFeedbackFitState *) fncxt->user_fctx;
+
+	if (fncxt->call_cntr >= fncxt->max_calls)
+		SRF_RETURN_DONE(fncxt);
+	fstate = &fstate[fncxt->call_cntr];
+
+	cost_feedback_solve(fstate->xtx, fstate->xty, beta);
+
+	memset(isnull, 0, sizeof(isnull));
+	values[0] = Int32GetDatum(devAttrs[fstate->cuda_dindex].DEV_ID);
+	values[1] = Int64GetDatum(fstate->nsamples);
+	values[2] = Float8GetDatum(beta[0]);
+	if (beta[1] > 0.0)
+		values[3] = Float8GetDatum(1000.0 / beta[1]);
+	else
+		isnull[3] = true;
+	/* ms/Mrows equals to ns/row */
+	values[4] = Float8GetDatum(beta[2]);
+	chunk_mb = (double) pgstrom_chunk_size() / (double)(1UL << 20);
+	values[5] = Float8GetDatum(beta[0] * (fstate->sum_kernels /
+										  Max(fstate->sum_chunks, 1.0)) +
+							   beta[1] * chunk_mb);
+
+	tuple = heap_form_tuple(fncxt->tuple_desc, values, isnull);
+
+	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
+}
+PG_FUNCTION_INFO_V1(pgstrom_cost_feedback_fit);
+
+/*
+ * pgstrom_cost_feedback_reset
+ */
+Datum
+pgstrom_cost_feedback_reset(PG_FUNCTION_ARGS)
+{
+	SpinLockAcquire(&cost_feedback_head->lock);
+	cost_feedback_head->nitems = 0;
+	SpinLockRelease(&cost_feedback_head->lock);
+
+	PG_RETURN_VOID();
+}
+PG_FUNCTION_INFO_V1(pgstrom_cost_feedback_reset);
+
+/*
+ * pgstrom_startup_gputasks
+ */
+static void
+pgstrom_startup_gputasks(void)
+{
+	bool	found;
+
+	if (shmem_startup_next)
+		(*shmem_startup_next)();
+
+	cost_feedback_head = ShmemInitStruct("Cost feedback of GPU nodes",
+										 sizeof(CostFeedbackHead),
+										 &found);
+	if (found)
+		elog(ERROR, "Bug? Cost feedback of GPU nodes exists");
+	SpinLockInit(&cost_feedback_head->lock);
+	cost_feedback_head->nitems = 0;
 }
 
 /*
@@ -726,5 +1373,17 @@ pgstromInitGpuTask(GpuTaskState *gts, GpuTask *gtask)
 void
 pgstrom_init_gputasks(void)
 {
-	/* nothing to do */
+	DefineCustomBoolVariable("pg_strom.cost_feedback",
+							 "Enables to record the actual behavior of GPU nodes towards the estimation",
+							 NULL,
+							 &pgstrom_cost_feedback,
+							 true,
+							 PGC_SUSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+
+	/* shared memory */
+	RequestAddinShmemSpace(MAXALIGN(sizeof(CostFeedbackHead)));
+	shmem_startup_next = shmem_startup_hook;
+	shmem_startup_hook = pgstrom_startup_gputasks;
 }
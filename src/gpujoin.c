@@ -54,6 +54,7 @@ typedef struct
 	int			num_rels;
 	int			optimal_gpu;
 	char	   *kern_source;
+	char	   *kern_devfuncs;
 	cl_uint		extra_flags;
 	cl_uint		varlena_bufsz;
 	List	   *used_params;
@@ -92,6 +93,7 @@ form_gpujoin_info(CustomScan *cscan, GpuJoinInfo *gj_info)
 	privs = lappend(privs, makeInteger(gj_info->num_rels));
 	privs = lappend(privs, makeInteger(gj_info->optimal_gpu));
 	privs = lappend(privs, makeString(pstrdup(gj_info->kern_source)));
+	privs = lappend(privs, makeString(pstrdup(gj_info->kern_devfuncs)));
 	privs = lappend(privs, makeInteger(gj_info->extra_flags));
 	privs = lappend(privs, makeInteger(gj_info->varlena_bufsz));
 	exprs = lappend(exprs, gj_info->used_params);
@@ -136,6 +138,7 @@ deform_gpujoin_info(CustomScan *cscan)
 	gj_info->num_rels = intVal(list_nth(privs, pindex++));
 	gj_info->optimal_gpu = intVal(list_nth(privs, pindex++));
 	gj_info->kern_source = strVal(list_nth(privs, pindex++));
+	gj_info->kern_devfuncs = strVal(list_nth(privs, pindex++));
 	gj_info->extra_flags = intVal(list_nth(privs, pindex++));
 	gj_info->varlena_bufsz = intVal(list_nth(privs, pindex++));
 	gj_info->used_params = list_nth(exprs, eindex++);
@@ -2256,6 +2259,7 @@ PlanGpuJoinPath(PlannerInfo *root,
 	GpuJoinInfo		gj_info;
 	CustomScan	   *cscan;
 	codegen_context	context;
+	StringInfoData	devfuncs;
 	Plan		   *outer_plan;
 	ListCell	   *lc;
 	Bitmapset	   *varattnos = NULL;
@@ -2440,6 +2444,9 @@ PlanGpuJoinPath(PlannerInfo *root,
 	gj_info.extra_flags = (DEVKERNEL_NEEDS_GPUSCAN |
 						   DEVKERNEL_NEEDS_GPUJOIN |
 						   context.extra_flags);
+	initStringInfo(&devfuncs);
+	pgstrom_codegen_devfunc_needs(&devfuncs, &context);
+	gj_info.kern_devfuncs = devfuncs.data;
 	gj_info.outer_refs = outer_refs;
 	gj_info.used_params = context.used_params;
 
@@ -2891,6 +2898,7 @@ ExecInitGpuJoin(CustomScanState *node, EState *estate, int eflags)
 	pgstrom_build_session_info(&kern_define,
 							   &gjs->gts,
 							   gj_info->extra_flags);
+	appendStringInfoString(&kern_define, gj_info->kern_devfuncs);
 	program_id = pgstrom_create_cuda_program(gjs->gts.gcontext,
 											 gj_info->extra_flags,
 											 gj_info->varlena_bufsz,
@@ -3865,6 +3873,7 @@ gpujoin_codegen_projection(StringInfo source,
 	List		   *tlist_dev = cscan->custom_scan_tlist;
 	List		   *ps_src_depth = gj_info->ps_src_depth;
 	List		   *ps_src_resno = gj_info->ps_src_resno;
+	List		   *exprs;
 	ListCell	   *lc1;
 	ListCell	   *lc2;
 	ListCell	   *lc3;
@@ -4300,6 +4309,18 @@ gpujoin_codegen_projection(StringInfo source,
 	/*
 	 * Execution of the expression
 	 */
+	exprs = NIL;
+	forboth (lc1, tlist_dev,
+			 lc2, ps_src_depth)
+	{
+		TargetEntry	   *tle = lfirst(lc1);
+
+		if (!tle->resjunk && lfirst_int(lc2) < 0)
+			exprs = lappend(exprs, tle->expr);
+	}
+	pgstrom_codegen_cse_setup(context, exprs);
+	pgstrom_codegen_cse_declarations(&body, context);
+
 	is_first = true;
 	forboth (lc1, tlist_dev,
 			 lc2, ps_src_depth)
@@ -4371,6 +4392,8 @@ gpujoin_codegen_projection(StringInfo source,
 				context->varlena_bufsz += MAXALIGN(dtype->extra_sz);
 		}
 	}
+	pgstrom_codegen_cse_reset(context);
+	list_free(exprs);
 	/* add parameter declarations */
 	pgstrom_codegen_param_declarations(source, context);
 	/* merge with declaration part */
@@ -5734,6 +5757,7 @@ GpuJoinCreateCombinedProgram(PlanState *node,
 							 cl_uint gpa_extra_flags,
 							 cl_uint gpa_varlena_bufsz,
 							 const char *gpa_kern_source,
+							 const char *gpa_kern_devfuncs,
 							 bool explain_only)
 {
 	GpuJoinState   *gjs = (GpuJoinState *) node;
@@ -5752,6 +5776,8 @@ GpuJoinCreateCombinedProgram(PlanState *node,
 							   gpa_gts,
 							   extra_flags & ~DEVKERNEL_NEEDS_GPUJOIN);
 	assign_gpujoin_session_info(&kern_define, &gjs->gts);
+	appendStringInfoString(&kern_define, gj_info->kern_devfuncs);
+	appendStringInfoString(&kern_define, gpa_kern_devfuncs);
 
 	appendStringInfoString(
 		&kern_source,
@@ -5847,6 +5873,8 @@ gpujoin_throw_partial_result(GpuJoinTask *pgjoin)
 							CU_STREAM_PER_THREAD);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+	pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__BYTES_DTOH,
+				   pds_dst->kds.length);
 
 	/* setup responder task with supplied @kds_dst */
 	head_sz = STROMALIGN(offsetof(GpuJoinTask, kern) +
@@ -6003,6 +6031,7 @@ gpujoinColocateOuterJoinMaps(GpuTaskState *gts, CUmodule cuda_module)
 						NULL);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuLaunchKernel: %s", errorText(rc));
+	pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__NUM_KERNELS, 1);
 	pg_atomic_write_u32(&gj_sstate->needs_colocation, 0);
 }
 
@@ -6075,6 +6104,7 @@ gpujoin_process_inner_join(GpuJoinTask *pgjoin, CUmodule cuda_module)
 	/*
 	 * OK, kick a series of GpuJoin invocations
 	 */
+	gpuTaskPhaseMark(GTS_PHASE__SEND_BEGIN);
 	if (pds_src->kds.format != KDS_FORMAT_BLOCK)
 	{
 		rc = cuMemPrefetchAsync(m_kds_src,
@@ -6083,6 +6113,8 @@ gpujoin_process_inner_join(GpuJoinTask *pgjoin, CUmodule cuda_module)
 								CU_STREAM_PER_THREAD);
 		if (rc != CUDA_SUCCESS)
 			werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+		pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__BYTES_HTOD,
+					   pds_src->kds.length);
 	}
 	else if (!pgjoin->with_nvme_strom)
 	{
@@ -6092,6 +6124,8 @@ gpujoin_process_inner_join(GpuJoinTask *pgjoin, CUmodule cuda_module)
 							   CU_STREAM_PER_THREAD);
 		if (rc != CUDA_SUCCESS)
 			werror("failed on cuMemcpyHtoD: %s", errorText(rc));
+		pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__BYTES_HTOD,
+					   pds_src->kds.length);
 	}
 	else
 	{
@@ -6125,6 +6159,7 @@ resume_kernel:
 	kern_args[3] = &m_kds_dst;
 	kern_args[4] = &m_nullptr;
 
+	gpuTaskPhaseMark(GTS_PHASE__KERNEL_BEGIN);
 	rc = cuLaunchKernel(kern_gpujoin_main,
 						grid_sz, 1, 1,
 						block_sz, 1, 1,
@@ -6134,6 +6169,9 @@ resume_kernel:
 						NULL);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuLaunchKernel: %s", errorText(rc));
+	pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__NUM_KERNELS, 1);
+	/* results are fetched through the unified memory; no explicit DMA */
+	gpuTaskPhaseMark(GTS_PHASE__RECV_BEGIN);
 
 	rc = cuEventRecord(CU_EVENT0_PER_THREAD, CU_STREAM_PER_THREAD);
 	if (rc != CUDA_SUCCESS)
@@ -6150,6 +6188,7 @@ resume_kernel:
 		if (pgjoin->kern.suspend_count > 0)
 		{
 			CHECK_WORKER_TERMINATION();
+			gpuTaskPhaseCollect();
 			gpujoin_throw_partial_result(pgjoin);
 
 			pgjoin->kern.suspend_count = 0;
@@ -6261,6 +6300,7 @@ resume_kernel:
 	kern_args[3] = &m_kds_dst;
 	kern_args[4] = &m_nullptr;
 
+	gpuTaskPhaseMark(GTS_PHASE__KERNEL_BEGIN);
 	rc = cuLaunchKernel(kern_gpujoin_main,
 						grid_sz, 1, 1,
 						block_sz, 1, 1,
@@ -6270,6 +6310,9 @@ resume_kernel:
 						NULL);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuLaunchKernel: %s", errorText(rc));
+	pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__NUM_KERNELS, 1);
+	/* results are fetched through the unified memory; no explicit DMA */
+	gpuTaskPhaseMark(GTS_PHASE__RECV_BEGIN);
 
 	rc = cuEventRecord(CU_EVENT0_PER_THREAD, CU_STREAM_PER_THREAD);
 	if (rc != CUDA_SUCCESS)
@@ -6286,6 +6329,7 @@ resume_kernel:
 		if (pgjoin->kern.suspend_count > 0)
 		{
 			CHECK_WORKER_TERMINATION();
+			gpuTaskPhaseCollect();
 
 			gpujoin_throw_partial_result(pgjoin);
 			pds_dst = pgjoin->pds_dst;	/* buffer renew */
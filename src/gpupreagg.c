@@ -51,6 +51,7 @@ typedef struct
 									 * should not update this field */
 	int				optimal_gpu;
 	char		   *kern_source;
+	char		   *kern_devfuncs;
 	cl_uint			extra_flags;
 	cl_uint			varlena_bufsz;
 	List		   *used_params;	/* referenced Const/Param */
@@ -80,6 +81,7 @@ form_gpupreagg_info(CustomScan *cscan, GpuPreAggInfo *gpa_info)
 	privs = lappend(privs, gpa_info->tlist_fallback);
 	privs = lappend(privs, makeInteger(gpa_info->optimal_gpu));
 	privs = lappend(privs, makeString(gpa_info->kern_source));
+	privs = lappend(privs, makeString(gpa_info->kern_devfuncs));
 	privs = lappend(privs, makeInteger(gpa_info->extra_flags));
 	privs = lappend(privs, makeInteger(gpa_info->varlena_bufsz));
 	exprs = lappend(exprs, gpa_info->used_params);
@@ -115,6 +117,7 @@ deform_gpupreagg_info(CustomScan *cscan)
 	gpa_info->tlist_fallback = list_nth(privs, pindex++);
 	gpa_info->optimal_gpu = intVal(list_nth(privs, pindex++));
 	gpa_info->kern_source = strVal(list_nth(privs, pindex++));
+	gpa_info->kern_devfuncs = strVal(list_nth(privs, pindex++));
 	gpa_info->extra_flags = intVal(list_nth(privs, pindex++));
 	gpa_info->varlena_bufsz = intVal(list_nth(privs, pindex++));
 	gpa_info->used_params = list_nth(exprs, eindex++);
@@ -2146,6 +2149,230 @@ make_altfunc_pcov_xy(Aggref *aggref, const char *func_name)
 						COERCE_EXPLICIT_CALL);
 }
 
+#ifdef GPUPREAGG_SUPPORT_NUMERIC
+/*
+ * numeric_fixed_sum_scale
+ *
+ * It returns the scale of the argument if the supplied SUM(numeric) or
+ * AVG(numeric) can be accumulated using scaled 64bit integers exactly;
+ * that is, the argument has a declared typmod and its precision is up to
+ * 18 digits. Elsewhere, it returns -1 and the float8 based partial sum is
+ * used.
+ */
+#define NUMERIC_FIXED_SUM_MAX_PRECISION		18
+
+static int
+numeric_fixed_sum_scale(Aggref *aggref, const aggfunc_catalog_t *aggfn_cat)
+{
+	TargetEntry *tle;
+	int32		typmod;
+	int			precision;
+
+	if ((strcmp(aggfn_cat->aggfn_name, "sum") != 0 &&
+		 strcmp(aggfn_cat->aggfn_name, "avg") != 0) ||
+		aggfn_cat->aggfn_nargs != 1 ||
+		aggfn_cat->aggfn_argtypes[0] != NUMERICOID)
+		return -1;
+	Assert(list_length(aggref->args) == 1);
+	tle = linitial(aggref->args);
+	typmod = exprTypmod((Node *) tle->expr);
+	if (typmod < (int32) VARHDRSZ)
+		return -1;
+	precision = ((typmod - VARHDRSZ) >> 16) & 0xffff;
+	if (precision > NUMERIC_FIXED_SUM_MAX_PRECISION)
+		return -1;
+	return (typmod - VARHDRSZ) & 0xffff;
+}
+
+/*
+ * make_altfunc_numeric_fixed_sum
+ *
+ * It constructs the partial sum of NUMERIC with a declared typmod, using
+ * a pair of 64bit integer accumulators. X is scaled to an integer V by
+ * 10^scale on the device, then V is split into the signed upper and lower
+ * halves centered on zero; V = HI * 2^32 + LO, where
+ *   HI = (V + 2^31) >> 32
+ *   LO = ((V + 2^31) & 0xffffffff) - 2^31
+ * PSUM of HI and LO are accumulated individually. Because |LO| <= 2^31 and
+ * |HI| < 2^28 (precision is up to 18 digits), these partial sums never
+ * overflow unless a group has more than 2^32 rows, even if all the values
+ * are at the bounds; small values of either sign contribute small LO.
+ * The host expression re-constructs the exact sum as
+ * ((PSUM(HI) * 2^32 + PSUM(LO)) / 10^scale).
+ */
+static Expr *
+make_altfunc_numeric_fixed_sum(Aggref *aggref, int scale,
+							   FuncExpr **p_pfunc_hi,
+							   FuncExpr **p_pfunc_lo)
+{
+	TargetEntry *tle;
+	Expr	   *expr;
+	Expr	   *expr_hi;
+	Expr	   *expr_lo;
+	Const	   *con;
+
+	Assert(list_length(aggref->args) == 1);
+	tle = linitial(aggref->args);
+	expr = tle->expr;
+	/* V = int8(X * 10^scale) */
+	if (scale > 0)
+	{
+		int64	pow10 = 1;
+		int		i;
+
+		for (i=0; i < scale; i++)
+			pow10 *= 10;
+		con = makeConst(NUMERICOID, -1, InvalidOid, -1,
+						DirectFunctionCall1(int8_numeric,
+											Int64GetDatum(pow10)),
+						false, false);
+		expr = (Expr *) makeFuncExpr(F_NUMERIC_MUL,
+									 NUMERICOID,
+									 list_make2(expr, con),
+									 InvalidOid,
+									 InvalidOid,
+									 COERCE_EXPLICIT_CALL);
+	}
+	expr = (Expr *) makeFuncExpr(F_NUMERIC_INT8,
+								 INT8OID,
+								 list_make1(expr),
+								 InvalidOid,
+								 InvalidOid,
+								 COERCE_EXPLICIT_CAST);
+	/* make conditional if aggref has any filter */
+	expr = make_expr_conditional(expr, aggref->aggfilter, true);
+	/* W = V + 2^31 */
+	con = makeConst(INT8OID, -1, InvalidOid, sizeof(int64),
+					Int64GetDatum(INT64CONST(0x80000000)),
+					false, FLOAT8PASSBYVAL);
+	expr = (Expr *) makeFuncExpr(F_INT8PL,
+								 INT8OID,
+								 list_make2(expr, con),
+								 InvalidOid,
+								 InvalidOid,
+								 COERCE_EXPLICIT_CALL);
+	/* HI = W >> 32 */
+	con = makeConst(INT4OID, -1, InvalidOid, sizeof(int32),
+					Int32GetDatum(32), false, true);
+	expr_hi = (Expr *) makeFuncExpr(F_INT8SHR,
+									INT8OID,
+									list_make2(expr, con),
+									InvalidOid,
+									InvalidOid,
+									COERCE_EXPLICIT_CALL);
+	/* LO = (W & 0xffffffff) - 2^31 */
+	con = makeConst(INT8OID, -1, InvalidOid, sizeof(int64),
+					Int64GetDatum(INT64CONST(0xffffffff)),
+					false, FLOAT8PASSBYVAL);
+	expr_lo = (Expr *) makeFuncExpr(F_INT8AND,
+									INT8OID,
+									list_make2(copyObject(expr), con),
+									InvalidOid,
+									InvalidOid,
+									COERCE_EXPLICIT_CALL);
+	con = makeConst(INT8OID, -1, InvalidOid, sizeof(int64),
+					Int64GetDatum(INT64CONST(0x80000000)),
+					false, FLOAT8PASSBYVAL);
+	expr_lo = (Expr *) makeFuncExpr(F_INT8MI,
+									INT8OID,
+									list_make2(expr_lo, con),
+									InvalidOid,
+									InvalidOid,
+									COERCE_EXPLICIT_CALL);
+	*p_pfunc_hi = make_altfunc_simple_expr("psum", expr_hi);
+	*p_pfunc_lo = make_altfunc_simple_expr("psum", expr_lo);
+
+	/* host expression to re-construct the sum */
+	expr_hi = (Expr *) makeFuncExpr(F_INT8_NUMERIC,
+									NUMERICOID,
+									list_make1(*p_pfunc_hi),
+									InvalidOid,
+									InvalidOid,
+									COERCE_EXPLICIT_CAST);
+	expr_lo = (Expr *) makeFuncExpr(F_INT8_NUMERIC,
+									NUMERICOID,
+									list_make1(*p_pfunc_lo),
+									InvalidOid,
+									InvalidOid,
+									COERCE_EXPLICIT_CAST);
+	con = makeConst(NUMERICOID, -1, InvalidOid, -1,
+					DirectFunctionCall1(int8_numeric,
+										Int64GetDatum(INT64CONST(0x100000000))),
+					false, false);
+	expr = (Expr *) makeFuncExpr(F_NUMERIC_MUL,
+								 NUMERICOID,
+								 list_make2(expr_hi, con),
+								 InvalidOid,
+								 InvalidOid,
+								 COERCE_EXPLICIT_CALL);
+	expr = (Expr *) makeFuncExpr(F_NUMERIC_ADD,
+								 NUMERICOID,
+								 list_make2(expr, expr_lo),
+								 InvalidOid,
+								 InvalidOid,
+								 COERCE_EXPLICIT_CALL);
+	if (scale > 0)
+	{
+		char   *temp = psprintf("1e-%d", scale);
+
+		/* display scale of the result follows 10^-scale */
+		con = makeConst(NUMERICOID, -1, InvalidOid, -1,
+						DirectFunctionCall3(numeric_in,
+											CStringGetDatum(temp),
+											ObjectIdGetDatum(InvalidOid),
+											Int32GetDatum(-1)),
+						false, false);
+		expr = (Expr *) makeFuncExpr(F_NUMERIC_MUL,
+									 NUMERICOID,
+									 list_make2(expr, con),
+									 InvalidOid,
+									 InvalidOid,
+									 COERCE_EXPLICIT_CALL);
+	}
+	return expr;
+}
+#endif	/* GPUPREAGG_SUPPORT_NUMERIC */
+
+/*
+ * add_altfunc_to_device_target
+ *
+ * It adds the partial-aggregate function on the target_device, if its
+ * arguments are device executable.
+ */
+static bool
+add_altfunc_to_device_target(PlannerInfo *root,
+							 Aggref *aggref,
+							 FuncExpr *pfunc,
+							 PathTarget *target_device,
+							 PathTarget *target_input,
+							 Bitmapset **p_pfunc_bitmap)
+{
+	/* device executable? */
+	if (pfunc->args)
+	{
+		Node   *temp = replace_expression_by_outerref((Node *)pfunc->args,
+													  target_input);
+		if (!pgstrom_device_expression(root, (Expr *) temp))
+		{
+			elog(DEBUG2, "argument of %s is not device executable: %s",
+				 format_procedure(aggref->aggfnoid),
+				 nodeToString(aggref));
+			return false;
+		}
+	}
+	/*
+	 * Add partial-aggregate function expression
+	 * Also see add_new_column_to_pathtarget().
+	 */
+	if (!list_member(target_device->exprs, pfunc))
+	{
+		add_column_to_pathtarget(target_device, (Expr *)pfunc, 0);
+		*p_pfunc_bitmap = bms_add_member(*p_pfunc_bitmap,
+										 list_length(target_device->exprs) - 1);
+	}
+	return true;
+}
+
 /*
  * make_alternative_aggref
  *
@@ -2168,10 +2395,15 @@ make_alternative_aggref(PlannerInfo *root,
 	Oid			func_oid;
 	const char *func_name;
 	oidvector  *func_argtypes;
+	const char *finalfn_name;
+	Oid			finalfn_argtype;
 	HeapTuple	tuple;
 	int			i;
 	Form_pg_proc proc_form;
 	Form_pg_aggregate agg_form;
+#ifdef GPUPREAGG_SUPPORT_NUMERIC
+	int			numeric_scale;
+#endif
 
 	if (aggref->aggorder || aggref->aggdistinct)
 	{
@@ -2200,134 +2432,181 @@ make_alternative_aggref(PlannerInfo *root,
 	Assert(aggref->aggkind == AGGKIND_NORMAL &&
 		   !aggref->aggvariadic &&
 		   list_length(aggref->args) <= 2);
+	finalfn_name = aggfn_cat->finalfn_name;
+	finalfn_argtype = aggfn_cat->finalfn_argtype;
 
+#ifdef GPUPREAGG_SUPPORT_NUMERIC
 	/*
-	 * construct arguments list of the partial aggregation
+	 * SUM(numeric) and AVG(numeric) with a declared typmod are accumulated
+	 * as scaled integers exactly, instead of the float8 based partial sum.
 	 */
-	for (i=0; i < aggfn_cat->partfn_nargs; i++)
+	numeric_scale = numeric_fixed_sum_scale(aggref, aggfn_cat);
+	if (numeric_scale >= 0)
 	{
-		cl_int		action = aggfn_cat->partfn_argexprs[i];
-		cl_int		argtype = aggfn_cat->partfn_argtypes[i];
-		FuncExpr   *pfunc;
+		FuncExpr   *pfunc_hi;
+		FuncExpr   *pfunc_lo;
 
-		switch (action)
+		expr_host = make_altfunc_numeric_fixed_sum(aggref, numeric_scale,
+												   &pfunc_hi, &pfunc_lo);
+		if (!add_altfunc_to_device_target(root, aggref, pfunc_hi,
+										  target_device,
+										  target_input,
+										  p_pfunc_bitmap) ||
+			!add_altfunc_to_device_target(root, aggref, pfunc_lo,
+										  target_device,
+										  target_input,
+										  p_pfunc_bitmap))
+			return NULL;
+		if (strcmp(aggfn_cat->aggfn_name, "avg") == 0)
 		{
-			case ALTFUNC_EXPR_NROWS:    /* NROWS(X) */
-				pfunc = make_altfunc_nrows_expr(aggref);
-				break;
-			case ALTFUNC_EXPR_PMIN:     /* PMIN(X) */
-				pfunc = make_altfunc_minmax_expr(aggref, "pmin", argtype);
-				break;
-			case ALTFUNC_EXPR_PMAX:     /* PMAX(X) */
-				pfunc = make_altfunc_minmax_expr(aggref, "pmax", argtype);
-				break;
-			case ALTFUNC_EXPR_PSUM:     /* PSUM(X) */
-				pfunc = make_altfunc_psum_expr(aggref, "psum", argtype);
-				break;
-			case ALTFUNC_EXPR_PSUM_X2:  /* PSUM_X2(X) = PSUM(X^2) */
-				pfunc = make_altfunc_psum_expr(aggref, "psum_x2", argtype);
-				break;
-			case ALTFUNC_EXPR_PCOV_X:   /* PCOV_X(X,Y) */
-				pfunc = make_altfunc_pcov_xy(aggref, "pcov_x");
-				break;
-			case ALTFUNC_EXPR_PCOV_Y:   /* PCOV_Y(X,Y) */
-				pfunc = make_altfunc_pcov_xy(aggref, "pcov_y");
-				break;
-			case ALTFUNC_EXPR_PCOV_X2:  /* PCOV_X2(X,Y) */
-				pfunc = make_altfunc_pcov_xy(aggref, "pcov_x2");
-				break;
-			case ALTFUNC_EXPR_PCOV_Y2:  /* PCOV_Y2(X,Y) */
-				pfunc = make_altfunc_pcov_xy(aggref, "pcov_y2");
-				break;
-			case ALTFUNC_EXPR_PCOV_XY:  /* PCOV_XY(X,Y) */
-				pfunc = make_altfunc_pcov_xy(aggref, "pcov_xy");
-				break;
-			default:
-				elog(ERROR, "unknown alternative function code: %d", action);
-				break;
+			/* AVG(X) = FAVG(PAVG(NROWS(X), exact sum of X)) */
+			FuncExpr   *pfunc_nrows = make_altfunc_nrows_expr(aggref);
+			Oid			pavg_argtypes[2] = { INT8OID, NUMERICOID };
+
+			if (!add_altfunc_to_device_target(root, aggref, pfunc_nrows,
+											  target_device,
+											  target_input,
+											  p_pfunc_bitmap))
+				return NULL;
+			namespace_oid = get_namespace_oid("pgstrom", false);
+			func_argtypes = buildoidvector(pavg_argtypes, 2);
+			func_oid = GetSysCacheOid3(PROCNAMEARGSNSP,
+									   PointerGetDatum("pavg"),
+									   PointerGetDatum(func_argtypes),
+									   ObjectIdGetDatum(namespace_oid));
+			if (!OidIsValid(func_oid))
+				elog(ERROR, "cache lookup failed for function %s",
+					 funcname_signature_string("pavg", 2, NIL,
+											   pavg_argtypes));
+			expr_host = (Expr *)makeFuncExpr(func_oid,
+											 NUMERICARRAYOID,
+											 list_make2(pfunc_nrows,
+														expr_host),
+											 InvalidOid,
+											 InvalidOid,
+											 COERCE_EXPLICIT_CALL);
+			finalfn_name = "s:favg";
+			finalfn_argtype = NUMERICARRAYOID;
+		}
+		else
+		{
+			finalfn_name = "c:sum";
+			finalfn_argtype = NUMERICOID;
 		}
-		/* device executable? */
-		if (pfunc->args)
+	}
+	else
+#endif
+	{
+		/*
+		 * construct arguments list of the partial aggregation
+		 */
+		for (i=0; i < aggfn_cat->partfn_nargs; i++)
 		{
-			Node   *temp = replace_expression_by_outerref((Node *)pfunc->args,
-														  target_input);
-			if (!pgstrom_device_expression(root, (Expr *) temp))
+			cl_int		action = aggfn_cat->partfn_argexprs[i];
+			cl_int		argtype = aggfn_cat->partfn_argtypes[i];
+			FuncExpr   *pfunc;
+
+			switch (action)
 			{
-				elog(DEBUG2, "argument of %s is not device executable: %s",
-					 format_procedure(aggref->aggfnoid),
-					 nodeToString(aggref));
-				return NULL;
+				case ALTFUNC_EXPR_NROWS:    /* NROWS(X) */
+					pfunc = make_altfunc_nrows_expr(aggref);
+					break;
+				case ALTFUNC_EXPR_PMIN:     /* PMIN(X) */
+					pfunc = make_altfunc_minmax_expr(aggref, "pmin", argtype);
+					break;
+				case ALTFUNC_EXPR_PMAX:     /* PMAX(X) */
+					pfunc = make_altfunc_minmax_expr(aggref, "pmax", argtype);
+					break;
+				case ALTFUNC_EXPR_PSUM:     /* PSUM(X) */
+					pfunc = make_altfunc_psum_expr(aggref, "psum", argtype);
+					break;
+				case ALTFUNC_EXPR_PSUM_X2:  /* PSUM_X2(X) = PSUM(X^2) */
+					pfunc = make_altfunc_psum_expr(aggref, "psum_x2", argtype);
+					break;
+				case ALTFUNC_EXPR_PCOV_X:   /* PCOV_X(X,Y) */
+					pfunc = make_altfunc_pcov_xy(aggref, "pcov_x");
+					break;
+				case ALTFUNC_EXPR_PCOV_Y:   /* PCOV_Y(X,Y) */
+					pfunc = make_altfunc_pcov_xy(aggref, "pcov_y");
+					break;
+				case ALTFUNC_EXPR_PCOV_X2:  /* PCOV_X2(X,Y) */
+					pfunc = make_altfunc_pcov_xy(aggref, "pcov_x2");
+					break;
+				case ALTFUNC_EXPR_PCOV_Y2:  /* PCOV_Y2(X,Y) */
+					pfunc = make_altfunc_pcov_xy(aggref, "pcov_y2");
+					break;
+				case ALTFUNC_EXPR_PCOV_XY:  /* PCOV_XY(X,Y) */
+					pfunc = make_altfunc_pcov_xy(aggref, "pcov_xy");
+					break;
+				default:
+					elog(ERROR, "unknown alternative function code: %d", action);
+					break;
 			}
+			if (!add_altfunc_to_device_target(root, aggref, pfunc,
+											  target_device,
+											  target_input,
+											  p_pfunc_bitmap))
+				return NULL;
+			/* append to the argument list */
+			altfunc_args = lappend(altfunc_args, (Expr *)pfunc);
 		}
+
 		/*
-		 * Add partial-aggregate function expression
-		 * Also see add_new_column_to_pathtarget().
+		 * Lookup an alternative function that generates partial state
+		 * of the final aggregate function, or varref if internal state
+		 * of aggregation is as-is.
 		 */
-		if (!list_member(target_device->exprs, pfunc))
+		if (strcmp(aggfn_cat->partfn_name, "varref") == 0)
 		{
-			add_column_to_pathtarget(target_device, (Expr *)pfunc, 0);
-			*p_pfunc_bitmap = bms_add_member(*p_pfunc_bitmap,
-											 list_length(target_device->exprs) - 1);
+			Assert(list_length(altfunc_args) == 1);
+			expr_host = linitial(altfunc_args);
 		}
-		/* append to the argument list */
-		altfunc_args = lappend(altfunc_args, (Expr *)pfunc);
-	}
-
-	/*
-	 * Lookup an alternative function that generates partial state
-	 * of the final aggregate function, or varref if internal state
-	 * of aggregation is as-is.
-	 */
-	if (strcmp(aggfn_cat->partfn_name, "varref") == 0)
-	{
-		Assert(list_length(altfunc_args) == 1);
-		expr_host = linitial(altfunc_args);
-	}
-	else
-	{
-		Assert(list_length(altfunc_args) == aggfn_cat->partfn_nargs);
-		if (strncmp(aggfn_cat->partfn_name, "c:", 2) == 0)
-			namespace_oid = PG_CATALOG_NAMESPACE;
-		else if (strncmp(aggfn_cat->partfn_name, "s:", 2) == 0)
-			namespace_oid = get_namespace_oid("pgstrom", false);
 		else
-			elog(ERROR, "Bug? incorrect alternative function catalog");
-
-		func_name = aggfn_cat->partfn_name + 2;
-		func_argtypes = buildoidvector(aggfn_cat->partfn_argtypes,
-									   aggfn_cat->partfn_nargs);
-		tuple = SearchSysCache3(PROCNAMEARGSNSP,
-								PointerGetDatum(func_name),
-								PointerGetDatum(func_argtypes),
-								ObjectIdGetDatum(namespace_oid));
-		if (!HeapTupleIsValid(tuple))
-			elog(ERROR, "cache lookup failed for function %s",
-				 funcname_signature_string(func_name,
-										   aggfn_cat->partfn_nargs,
-										   NIL,
-										   aggfn_cat->partfn_argtypes));
-		proc_form = (Form_pg_proc) GETSTRUCT(tuple);
-		expr_host = (Expr *)makeFuncExpr(HeapTupleGetOid(tuple),
-										 proc_form->prorettype,
-										 altfunc_args,
-										 InvalidOid,
-										 InvalidOid,
-										 COERCE_EXPLICIT_CALL);
-		ReleaseSysCache(tuple);
+		{
+			Assert(list_length(altfunc_args) == aggfn_cat->partfn_nargs);
+			if (strncmp(aggfn_cat->partfn_name, "c:", 2) == 0)
+				namespace_oid = PG_CATALOG_NAMESPACE;
+			else if (strncmp(aggfn_cat->partfn_name, "s:", 2) == 0)
+				namespace_oid = get_namespace_oid("pgstrom", false);
+			else
+				elog(ERROR, "Bug? incorrect alternative function catalog");
+
+			func_name = aggfn_cat->partfn_name + 2;
+			func_argtypes = buildoidvector(aggfn_cat->partfn_argtypes,
+										   aggfn_cat->partfn_nargs);
+			tuple = SearchSysCache3(PROCNAMEARGSNSP,
+									PointerGetDatum(func_name),
+									PointerGetDatum(func_argtypes),
+									ObjectIdGetDatum(namespace_oid));
+			if (!HeapTupleIsValid(tuple))
+				elog(ERROR, "cache lookup failed for function %s",
+					 funcname_signature_string(func_name,
+											   aggfn_cat->partfn_nargs,
+											   NIL,
+											   aggfn_cat->partfn_argtypes));
+			proc_form = (Form_pg_proc) GETSTRUCT(tuple);
+			expr_host = (Expr *)makeFuncExpr(HeapTupleGetOid(tuple),
+											 proc_form->prorettype,
+											 altfunc_args,
+											 InvalidOid,
+											 InvalidOid,
+											 COERCE_EXPLICIT_CALL);
+			ReleaseSysCache(tuple);
+		}
 	}
 	/* add expression if unique */
 	add_new_column_to_pathtarget(target_partial, expr_host);
 
 	/* construction of the final Aggref */
-	if (strncmp(aggfn_cat->finalfn_name, "c:", 2) == 0)
+	if (strncmp(finalfn_name, "c:", 2) == 0)
 		namespace_oid = PG_CATALOG_NAMESPACE;
-	else if (strncmp(aggfn_cat->finalfn_name, "s:", 2) == 0)
+	else if (strncmp(finalfn_name, "s:", 2) == 0)
 		namespace_oid = get_namespace_oid("pgstrom", false);
 	else
 		elog(ERROR, "Bug? incorrect alternative function catalog");
 
-	func_name = aggfn_cat->finalfn_name + 2;
-	func_argtypes = buildoidvector(&aggfn_cat->finalfn_argtype, 1);
+	func_name = finalfn_name + 2;
+	func_argtypes = buildoidvector(&finalfn_argtype, 1);
 	func_oid = GetSysCacheOid3(PROCNAMEARGSNSP,
 							   PointerGetDatum(func_name),
 							   PointerGetDatum(func_argtypes),
@@ -2335,7 +2614,7 @@ make_alternative_aggref(PlannerInfo *root,
 	if (!OidIsValid(func_oid))
 		elog(ERROR, "cache lookup failed for function %s",
 			 funcname_signature_string(func_name, 1, NIL,
-									   &aggfn_cat->finalfn_argtype));
+									   &finalfn_argtype));
 	/* sanity checks */
 	Assert(aggref->aggtype == get_func_rettype(func_oid));
 
@@ -2617,6 +2896,7 @@ PlanGpuPreAggPath(PlannerInfo *root,
 	ListCell	   *lc;
 	int				index;
 	char		   *kern_source;
+	StringInfoData	devfuncs;
 	codegen_context	context;
 
 	Assert(list_length(best_path->custom_private) == 3);
@@ -2721,7 +3001,10 @@ PlanGpuPreAggPath(PlannerInfo *root,
 									outer_tlist,
 									gpa_info,
 									pfunc_bitmap);
+	initStringInfo(&devfuncs);
+	pgstrom_codegen_devfunc_needs(&devfuncs, &context);
 	gpa_info->kern_source = kern_source;
+	gpa_info->kern_devfuncs = devfuncs.data;
 	gpa_info->extra_flags = context.extra_flags;
 	gpa_info->outer_refs = outer_refs;
 	gpa_info->used_params = context.used_params;
@@ -3081,6 +3364,9 @@ gpupreagg_codegen_projection_row(StringInfo kern,
 	StringInfoData	temp;
 	Relation		outer_rel = NULL;
 	TupleDesc		outer_desc = NULL;
+	Expr		  **proj_exprs;
+	const char	  **null_consts;
+	List		   *exprs;
 	ListCell	   *lc;
 	int				i, k, nattrs;
 
@@ -3278,14 +3564,13 @@ gpupreagg_codegen_projection_row(StringInfo kern,
 	/*
 	 * Execute expression and store the value on dst_values/dst_isnull
 	 */
-	resetStringInfo(&temp);
+	proj_exprs = palloc0(sizeof(Expr *) * list_length(tlist_alt));
+	null_consts = palloc0(sizeof(char *) * list_length(tlist_alt));
+	exprs = NIL;
 	foreach (lc, tlist_alt)
 	{
 		TargetEntry	   *tle = lfirst(lc);
 		Expr		   *expr;
-		devtype_info   *dtype;
-		const char	   *null_const_value = NULL;
-		const char	   *projection_label = NULL;
 
 		if (tle->resjunk)
 			continue;
@@ -3294,22 +3579,41 @@ gpupreagg_codegen_projection_row(StringInfo kern,
 		if (is_altfunc_expression((Node *)tle->expr))
 		{
 			FuncExpr   *f = (FuncExpr *) tle->expr;
+			const char **p_null_const = &null_consts[tle->resno-1];
 
 			expr = codegen_projection_partial_funcion(f,
 													  context,
-													  &null_const_value);
-			projection_label = "aggfunc-arg";
+													  p_null_const);
 		}
 		else if (tle->ressortgroupref)
 		{
 			expr = tle->expr;
-			null_const_value = "0";
-			projection_label = "grouping-key";
+			null_consts[tle->resno-1] = "0";
 		}
 		else
 			elog(ERROR, "Bug? unexpected expression: %s",
                  nodeToString(tle->expr));
+		proj_exprs[tle->resno-1] = expr;
+		exprs = lappend(exprs, expr);
+	}
+	/* grouping keys are often referenced by aggregate arguments also */
+	resetStringInfo(&temp);
+	pgstrom_codegen_cse_setup(context, exprs);
+	pgstrom_codegen_cse_declarations(&temp, context);
 
+	foreach (lc, tlist_alt)
+	{
+		TargetEntry	   *tle = lfirst(lc);
+		Expr		   *expr = proj_exprs[tle->resno-1];
+		devtype_info   *dtype;
+		const char	   *null_const_value = null_consts[tle->resno-1];
+		const char	   *projection_label;
+
+		if (!expr)
+			continue;
+		projection_label = (is_altfunc_expression((Node *)tle->expr)
+							? "aggfunc-arg"
+							: "grouping-key");
 		dtype = pgstrom_devtype_lookup_and_track(exprType((Node *)expr),
 												 context);
 		if (!dtype)
@@ -3367,6 +3671,10 @@ gpupreagg_codegen_projection_row(StringInfo kern,
 	appendStringInfoString(&tbody, temp.data);
 	appendStringInfoString(&sbody, temp.data);
 	appendStringInfoString(&cbody, temp.data);
+	pgstrom_codegen_cse_reset(context);
+	list_free(exprs);
+	pfree(proj_exprs);
+	pfree(null_consts);
 
 	/* const/params */
 	pgstrom_codegen_param_declarations(&decl, context);
@@ -4176,6 +4484,7 @@ ExecInitGpuPreAgg(CustomScanState *node, EState *estate, int eflags)
 												  gpa_info->extra_flags,
 												  gpa_info->varlena_bufsz,
 												  gpa_info->kern_source,
+												  gpa_info->kern_devfuncs,
 												  explain_only);
 	}
 	else
@@ -4184,6 +4493,7 @@ ExecInitGpuPreAgg(CustomScanState *node, EState *estate, int eflags)
 		pgstrom_build_session_info(&kern_define,
 								   &gpas->gts,
 								   gpa_info->extra_flags);
+		appendStringInfoString(&kern_define, gpa_info->kern_devfuncs);
 		program_id = pgstrom_create_cuda_program(gpas->gts.gcontext,
 												 gpa_info->extra_flags,
 												 gpa_info->varlena_bufsz,
@@ -5008,6 +5318,7 @@ gpupreagg_init_final_hash(GpuPreAggTask *gpreagg,
 								NULL);
 			if (rc != CUDA_SUCCESS)
 				werror("failed on cuLaunchKernel: %s", errorText(rc));
+			pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__NUM_KERNELS, 1);
 
 			rc = cuEventRecord(ev_init_fhash,
 							   CU_STREAM_PER_THREAD);
@@ -5072,6 +5383,8 @@ gpupreagg_throw_partial_result(GpuPreAggTask *gpreagg,
 							CU_STREAM_PER_THREAD);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+	pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__BYTES_DTOH,
+				   gpreagg->kds_slot_length);
 
 	/* setup responder task with supplied @kds_slot */
 	length = STROMALIGN(offsetof(GpuPreAggTask, kern.kparams) +
@@ -5229,6 +5542,7 @@ gpupreagg_process_reduction_task(GpuPreAggTask *gpreagg,
 	/*
 	 * OK, kick a series of GpuPreAgg invocations
 	 */
+	gpuTaskPhaseMark(GTS_PHASE__SEND_BEGIN);
 
 	/* source data to be reduced */
 	if (pds_src->kds.format != KDS_FORMAT_BLOCK)
@@ -5239,6 +5553,8 @@ gpupreagg_process_reduction_task(GpuPreAggTask *gpreagg,
 								CU_STREAM_PER_THREAD);
 		if (rc != CUDA_SUCCESS)
 			werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+		pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__BYTES_HTOD,
+					   pds_src->kds.length);
 	}
 	else if (!gpreagg->with_nvme_strom)
 	{
@@ -5248,6 +5564,8 @@ gpupreagg_process_reduction_task(GpuPreAggTask *gpreagg,
 							   CU_STREAM_PER_THREAD);
 		if (rc != CUDA_SUCCESS)
 			werror("failed on cuMemcpyHtoD: %s", errorText(rc));
+		pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__BYTES_HTOD,
+					   pds_src->kds.length);
 	}
 	else
 	{
@@ -5277,6 +5595,7 @@ resume_kernel:
 	kern_args[0] = &m_gpreagg;
 	kern_args[1] = &m_kds_src;
 	kern_args[2] = &m_kds_slot;
+	gpuTaskPhaseMark(GTS_PHASE__KERNEL_BEGIN);
 	rc = cuLaunchKernel(kern_setup,
 						gpreagg->kern.grid_sz, 1, 1,
 						gpreagg->kern.block_sz, 1, 1,
@@ -5286,6 +5605,7 @@ resume_kernel:
 						NULL);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuLaunchKernel: %s", errorText(rc));
+	pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__NUM_KERNELS, 1);
 
 	/*
 	 * Launch:
@@ -5317,6 +5637,8 @@ resume_kernel:
 						NULL);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuLaunchKernel: %s", errorText(rc));
+	pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__NUM_KERNELS, 1);
+	gpuTaskPhaseMark(GTS_PHASE__RECV_BEGIN);
 
 	rc = cuEventRecord(CU_EVENT0_PER_THREAD, CU_STREAM_PER_THREAD);
 	if (rc != CUDA_SUCCESS)
@@ -5349,6 +5671,7 @@ resume_kernel:
 		if (gpreagg->kern.suspend_count > 0)
 		{
 			CHECK_WORKER_TERMINATION();
+			gpuTaskPhaseCollect();
 			gpupreagg_reset_kernel_task(&gpreagg->kern, true);
 
 			Assert(gpreagg->kern.suspend_size > 0);
@@ -5405,6 +5728,8 @@ resume_kernel:
 			CHECK_WORKER_TERMINATION();
 			m_kds_slot = (CUdeviceptr) KDS_clone(gcontext, kds_slot);
 			gpupreagg_throw_partial_result(gpreagg, kds_slot);
+			gpuTaskPhaseMark(GTS_PHASE__RECV_END);
+			gpuTaskPhaseCollect();
 
 			/* save the suspend status at this point, then resume */
 			gpupreagg_reset_kernel_task(&gpreagg->kern, true);
@@ -5428,6 +5753,9 @@ resume_kernel:
 									CU_STREAM_PER_THREAD);
 			if (rc != CUDA_SUCCESS)
 				werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+			pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__BYTES_DTOH,
+						   gpreagg->kds_slot_length);
+			gpuTaskPhaseMark(GTS_PHASE__RECV_END);
 			gpreagg->kds_slot = (kern_data_store *) m_kds_slot;
 			m_kds_slot = 0UL;
 		}
@@ -5559,6 +5887,7 @@ gpupreagg_process_combined_task(GpuPreAggTask *gpreagg, CUmodule cuda_module)
 	/*
 	 * OK, kick a series of GpuPreAgg invocations
 	 */
+	gpuTaskPhaseMark(GTS_PHASE__SEND_BEGIN);
 	if (pds_src)
 	{
 		if (pds_src->kds.format != KDS_FORMAT_BLOCK)
@@ -5569,6 +5898,8 @@ gpupreagg_process_combined_task(GpuPreAggTask *gpreagg, CUmodule cuda_module)
 									CU_STREAM_PER_THREAD);
 			if (rc != CUDA_SUCCESS)
 				werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+			pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__BYTES_HTOD,
+						   pds_src->kds.length);
 		}
 		else if (!gpreagg->with_nvme_strom)
 		{
@@ -5578,6 +5909,8 @@ gpupreagg_process_combined_task(GpuPreAggTask *gpreagg, CUmodule cuda_module)
 								   CU_STREAM_PER_THREAD);
 			if (rc != CUDA_SUCCESS)
 				werror("failed on cuMemcpyHtoDAsync: %s", errorText(rc));
+			pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__BYTES_HTOD,
+						   pds_src->kds.length);
 		}
 		else
 		{
@@ -5631,6 +5964,7 @@ resume_kernel:
 	kern_args[3] = &m_kds_slot;
 	kern_args[4] = &m_kparams;
 
+	gpuTaskPhaseMark(GTS_PHASE__KERNEL_BEGIN);
 	rc = cuLaunchKernel(kern_gpujoin_main,
 						grid_sz, 1, 1,
 						block_sz, 1, 1,
@@ -5640,6 +5974,7 @@ resume_kernel:
 						NULL);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuLaunchKernel: %s", errorText(rc));
+	pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__NUM_KERNELS, 1);
 
 	/*
 	 * Launch:
@@ -5672,6 +6007,8 @@ resume_kernel:
 						NULL);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuLaunchKernel: %s", errorText(rc));
+	pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__NUM_KERNELS, 1);
+	gpuTaskPhaseMark(GTS_PHASE__RECV_BEGIN);
 
 	rc = cuEventRecord(CU_EVENT0_PER_THREAD, CU_STREAM_PER_THREAD);
 	if (rc != CUDA_SUCCESS)
@@ -5744,6 +6081,8 @@ resume_kernel:
 				CHECK_WORKER_TERMINATION();
 				m_kds_slot = (CUdeviceptr) KDS_clone(gcontext, kds_slot);
 				gpupreagg_throw_partial_result(gpreagg, kds_slot);
+				gpuTaskPhaseMark(GTS_PHASE__RECV_END);
+				gpuTaskPhaseCollect();
 
 				/* save the suspend status at this point, then resume */
 				gpujoin_reset_kernel_task(kgjoin, true);
@@ -5763,6 +6102,9 @@ resume_kernel:
 										CU_STREAM_PER_THREAD);
 				if (rc != CUDA_SUCCESS)
 					werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+				pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__BYTES_DTOH,
+							   gpreagg->kds_slot_length);
+				gpuTaskPhaseMark(GTS_PHASE__RECV_END);
 				gpreagg->task.cpu_fallback = true;
 				gpreagg->kds_slot = (kern_data_store *) m_kds_slot;
 				m_kds_slot = 0UL;
@@ -5783,6 +6125,7 @@ resume_kernel:
 		if (kgjoin->suspend_count > 0)
 		{
 			CHECK_WORKER_TERMINATION();
+			gpuTaskPhaseCollect();
 			gpujoin_reset_kernel_task(kgjoin, true);
 			gpupreagg_reset_kernel_task(&gpreagg->kern, false);
 			if (!last_suspend)
@@ -32,6 +32,7 @@ static bool					enable_pullup_outer_scan;
 typedef struct {
 	cl_int		optimal_gpu;	/* optimal GPU selection, or -1 */
 	char	   *kern_source;	/* source of the CUDA kernel */
+	char	   *kern_devfuncs;	/* device functions in use */
 	cl_uint		extra_flags;	/* extra libraries to be included */
 	cl_uint		varlena_bufsz;	/* buffer size of temporary varlena datum */
 	cl_uint		proj_tuple_sz;	/* nbytes of the expected result tuple size */
@@ -53,6 +54,7 @@ form_gpuscan_info(CustomScan *cscan, GpuScanInfo *gs_info)
 
 	privs = lappend(privs, makeInteger(gs_info->optimal_gpu));
 	privs = lappend(privs, makeString(gs_info->kern_source));
+	privs = lappend(privs, makeString(gs_info->kern_devfuncs));
 	privs = lappend(privs, makeInteger(gs_info->extra_flags));
 	privs = lappend(privs, makeInteger(gs_info->varlena_bufsz));
 	privs = lappend(privs, makeInteger(gs_info->proj_tuple_sz));
@@ -80,6 +82,7 @@ deform_gpuscan_info(CustomScan *cscan)
 
 	gs_info->optimal_gpu = intVal(list_nth(privs, pindex++));
 	gs_info->kern_source = strVal(list_nth(privs, pindex++));
+	gs_info->kern_devfuncs = strVal(list_nth(privs, pindex++));
 	gs_info->extra_flags = intVal(list_nth(privs, pindex++));
 	gs_info->varlena_bufsz = intVal(list_nth(privs, pindex++));
 	gs_info->proj_tuple_sz = intVal(list_nth(privs, pindex++));
@@ -456,6 +459,7 @@ codegen_gpuscan_quals(StringInfo kern, codegen_context *context,
 		goto output;
 	/* Let's walk on the device expression tree */
 	dev_quals = (Node *)make_flat_ands_explicit(dev_quals_list);
+	pgstrom_codegen_cse_setup(context, list_make1(dev_quals));
 	expr_code = pgstrom_codegen_expression(dev_quals, context);
 	/* Const/Param declarations */
 	pgstrom_codegen_param_declarations(&cfunc, context);
@@ -582,6 +586,10 @@ codegen_gpuscan_quals(StringInfo kern, codegen_context *context,
 			&tfunc,
 			"  EXTRACT_HEAP_TUPLE_END();\n");
 	}
+	/* common sub-expressions */
+	pgstrom_codegen_cse_declarations(&tfunc, context);
+	pgstrom_codegen_cse_declarations(&cfunc, context);
+	pgstrom_codegen_cse_reset(context);
 output:
 	appendStringInfo(
 		kern,
@@ -620,6 +628,7 @@ codegen_gpuscan_projection(StringInfo kern, codegen_context *context,
 {
 	TupleDesc		tupdesc = RelationGetDescr(relation);
 	List		   *tlist_dev = NIL;
+	List		   *exprs;
 	AttrNumber	   *varremaps;
 	Bitmapset	   *varattnos;
 	ListCell	   *lc;
@@ -909,6 +918,18 @@ codegen_gpuscan_projection(StringInfo kern, codegen_context *context,
 	/*
 	 * step.3 - execute expression node, then store the result onto KVAR_xx
 	 */
+	exprs = NIL;
+	foreach (lc, tlist_dev)
+	{
+		TargetEntry    *tle = lfirst(lc);
+
+		if (!IsA(tle->expr, Var))
+			exprs = lappend(exprs, tle->expr);
+	}
+	pgstrom_codegen_cse_setup(context, exprs);
+	pgstrom_codegen_cse_declarations(&tbody, context);
+	pgstrom_codegen_cse_declarations(&cbody, context);
+
     foreach (lc, tlist_dev)
     {
         TargetEntry    *tle = lfirst(lc);
@@ -991,6 +1012,8 @@ codegen_gpuscan_projection(StringInfo kern, codegen_context *context,
 	}
 	appendStringInfo(&tbody, "%s}\n", temp.data);
 	appendStringInfo(&cbody, "%s}\n", temp.data);
+	pgstrom_codegen_cse_reset(context);
+	list_free(exprs);
 
 	/* parameter references */
 	pgstrom_codegen_param_declarations(&tdecl, context);
@@ -1336,6 +1359,7 @@ PlanGpuScanPath(PlannerInfo *root,
 	cl_int			i, j;
 	StringInfoData	kern;
 	StringInfoData	source;
+	StringInfoData	devfuncs;
 	codegen_context	context;
 
 	/* It should be a base relation */
@@ -1402,6 +1426,8 @@ PlanGpuScanPath(PlannerInfo *root,
 	appendStringInfoString(&source, kern.data);
 	pfree(kern.data);
 	varlena_bufsz = Max(varlena_bufsz, context.varlena_bufsz);
+	initStringInfo(&devfuncs);
+	pgstrom_codegen_devfunc_needs(&devfuncs, &context);
 
 	/* pickup referenced attributes */
 	pull_varattnos((Node *)dev_quals, baserel->relid, &varattnos);
@@ -1430,6 +1456,7 @@ PlanGpuScanPath(PlannerInfo *root,
 	cscan->custom_scan_tlist = tlist_dev;
 
 	gs_info->kern_source = source.data;
+	gs_info->kern_devfuncs = devfuncs.data;
 	gs_info->extra_flags = context.extra_flags | DEVKERNEL_NEEDS_GPUSCAN;
 	gs_info->varlena_bufsz = varlena_bufsz;
 	gs_info->proj_tuple_sz = proj_tuple_sz;
@@ -1806,6 +1833,7 @@ ExecInitGpuScan(CustomScanState *node, EState *estate, int eflags)
 	pgstrom_build_session_info(&kern_define,
 							   &gss->gts,
 							   gs_info->extra_flags);
+	appendStringInfoString(&kern_define, gs_info->kern_devfuncs);
 	program_id = pgstrom_create_cuda_program(gcontext,
 											 gs_info->extra_flags,
 											 gs_info->varlena_bufsz,
@@ -2647,6 +2675,7 @@ gpuscan_process_task(GpuTask *gtask, CUmodule cuda_module)
 	/*
 	 * OK, enqueue a series of requests
 	 */
+	gpuTaskPhaseMark(GTS_PHASE__SEND_BEGIN);
 	length = KERN_GPUSCAN_DMASEND_LENGTH(&gscan->kern);
 	rc = cuMemPrefetchAsync((CUdeviceptr)&gscan->kern,
 							length,
@@ -2654,6 +2683,8 @@ gpuscan_process_task(GpuTask *gtask, CUmodule cuda_module)
 							CU_STREAM_PER_THREAD);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+	pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__BYTES_HTOD,
+				   length);
 
 	/* kern_data_store *kds_src */
 	if (pds_src->kds.format != KDS_FORMAT_BLOCK)
@@ -2664,6 +2695,8 @@ gpuscan_process_task(GpuTask *gtask, CUmodule cuda_module)
 								CU_STREAM_PER_THREAD);
 		if (rc != CUDA_SUCCESS)
 			werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+		pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__BYTES_HTOD,
+					   pds_src->kds.length);
 	}
 	else if (!gscan->with_nvme_strom)
 	{
@@ -2673,6 +2706,8 @@ gpuscan_process_task(GpuTask *gtask, CUmodule cuda_module)
 							   CU_STREAM_PER_THREAD);
 		if (rc != CUDA_SUCCESS)
 			werror("failed on cuMemcpyHtoDAsync: %s", errorText(rc));
+		pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__BYTES_HTOD,
+					   pds_src->kds.length);
 	}
 	else
 	{
@@ -2690,6 +2725,8 @@ gpuscan_process_task(GpuTask *gtask, CUmodule cuda_module)
 								CU_STREAM_PER_THREAD);
 		if (rc != CUDA_SUCCESS)
 			werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+		pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__BYTES_HTOD,
+					   length);
 	}
 
 	/*
@@ -2716,6 +2753,7 @@ resume_kernel:
 	kern_args[1] = &m_kds_src;
 	kern_args[2] = &m_kds_dst;
 
+	gpuTaskPhaseMark(GTS_PHASE__KERNEL_BEGIN);
 	rc = cuLaunchKernel(kern_gpuscan_quals,
 						grid_sz, 1, 1,
 						block_sz, 1, 1,
@@ -2725,6 +2763,8 @@ resume_kernel:
 						NULL);
 	if (rc != CUDA_SUCCESS)
 		werror("failed on cuLaunchKernel: %s", errorText(rc));
+	pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__NUM_KERNELS, 1);
+	gpuTaskPhaseMark(GTS_PHASE__RECV_BEGIN);
 
 	rc = cuEventRecord(CU_EVENT0_PER_THREAD, CU_STREAM_PER_THREAD);
 	if (rc != CUDA_SUCCESS)
@@ -2766,6 +2806,9 @@ resume_kernel:
 									CU_STREAM_PER_THREAD);
 			if (rc != CUDA_SUCCESS)
 				werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+			pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__BYTES_DTOH,
+						   offsetof(gpuscanResultIndex,
+									results[nitems_out]));
 		}
 		else if (nitems_out > 0)
 		{
@@ -2777,6 +2820,8 @@ resume_kernel:
 									CU_STREAM_PER_THREAD);
 			if (rc != CUDA_SUCCESS)
 				werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+			pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__BYTES_DTOH,
+						   extra_size);
 
 			length = KERN_DATA_STORE_HEAD_LENGTH(&pds_dst->kds);
 			rc = cuMemPrefetchAsync((CUdeviceptr)(&pds_dst->kds),
@@ -2785,7 +2830,10 @@ resume_kernel:
 									CU_STREAM_PER_THREAD);
 			if (rc != CUDA_SUCCESS)
 				werror("failed on cuMemPrefetchAsync: %s", errorText(rc));
+			pgstromStatAdd(GpuWorkerCurrentContext, GPUSTAT__BYTES_DTOH,
+						   length + sizeof(cl_uint) * nitems_out);
 		}
+		gpuTaskPhaseMark(GTS_PHASE__RECV_END);
 
 		/* resume gpuscan kernel, if suspended */
 		if (gscan->kern.suspend_count > 0)
@@ -2793,6 +2841,7 @@ resume_kernel:
 			void	   *temp;
 
 			CHECK_WORKER_TERMINATION();
+			gpuTaskPhaseCollect();
 			/* return partial result */
 			pds_dst = PDS_clone(gscan->pds_dst);
 			gpuscan_throw_partial_result(gscan, gscan->pds_dst);
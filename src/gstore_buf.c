@@ -17,6 +17,19 @@
  */
 #include "pg_strom.h"
 
+/*
+ * GpuStoreShard - a part of the main image, that keeps a range of rows
+ * on a particular GPU device, or host memory on overflow.
+ */
+typedef struct
+{
+	cl_int			cuda_dindex;/* CUDA device index, or -1 if host memory */
+	size_t			rawsize;	/* length of the KDS */
+	size_t			nitems;		/* nitems of the KDS */
+	CUipcMemHandle	ipc_mhandle;
+	dsm_handle		dsm_mhandle;
+} GpuStoreShard;
+
 /*
  * GpuStoreChunk - shared structure
  */
@@ -31,12 +44,18 @@ typedef struct
 	TransactionId	xmin;
 	bool			xmax_committed;
 	bool			xmin_committed;
-	cl_int			pinning;	/* CUDA device index */
+	cl_int			pinning;	/* primary CUDA device index */
 	cl_int			format;		/* one of GSTORE_FDW_FORMAT__* */
 	size_t			rawsize;	/* rawsize regardless of the internal format */
 	size_t			nitems;		/* nitems regardless of the internal format */
-	CUipcMemHandle	ipc_mhandle;
-	dsm_handle		dsm_mhandle;
+	cl_int			nshards;	/* number of shards of the main image */
+	GpuStoreShard	shards[GSTORE_MAX_SHARDS];
+	cl_ulong		image_ident;/* identifier of the main image */
+	/* delta image on top of the main image, if any */
+	bool			has_delta;
+	size_t			delta_length;
+	CUipcMemHandle	delta_ipc_mhandle;
+	dsm_handle		delta_dsm_mhandle;
 } GpuStoreChunk;
 
 /*
@@ -63,10 +82,52 @@ typedef struct
 	bool			xmax_committed;
 } MVCCAttrs;
 
+/*
+ * GpuStoreDeltaHead - delta image on top of the main (read-only) image.
+ *
+ * Small updates are not merged to the main image on commit. Instead of the
+ * full rewrite, the rows deleted from the main image and the KDS of the rows
+ * inserted are written to the delta image, then the chunk shares the main
+ * image with the previous version. Row-index of the inserted rows follows
+ * the rows of the main image.
+ */
+typedef struct
+{
+	size_t		length;			/* total length of the delta image */
+	size_t		main_nitems;	/* nitems of the main image */
+	size_t		kds_offset;		/* offset of the KDS of the inserted rows */
+	cl_uint		ndeleted;		/* number of the rows deleted from the main */
+	cl_uint		deleted[FLEXIBLE_ARRAY_MEMBER];	/* sorted row-index */
+} GpuStoreDeltaHead;
+
+#define GSTORE_DELTA_KDS(delta)							\
+	((kern_data_store *)((char *)(delta) + (delta)->kds_offset))
+
+/*
+ * GpuStoreMainMVCC - MVCC attributes of the rows on the main image, once
+ * they are updated or deleted by the read-write buffer on the delta mode.
+ */
+typedef struct
+{
+	cl_uint		row_index;		/* hash key */
+	MVCCAttrs	mvcc;
+} GpuStoreMainMVCC;
+
+/*
+ * GpuStoreLocalShard - local mapping of GpuStoreShard
+ */
+typedef struct
+{
+	GpuStoreShard	shard;
+	size_t			base_index;	/* row-index of the first row */
+	dsm_segment	   *h_seg;
+	kern_data_store *kds;
+} GpuStoreLocalShard;
+
 struct GpuStoreBuffer
 {
 	Oid			table_oid;	/* oid of the gstore_fdw */
-	cl_int		pinning;	/* CUDA device index */
+	cl_int		pinning;	/* primary CUDA device index, or -1 */
 	cl_int		format;		/* one of GSTORE_FDW_FORMAT__* */
 	cl_uint		revision;	/* revision number of the buffer */
 	bool		read_only;	/* true, if read-write buffer is not ready */
@@ -74,15 +135,20 @@ struct GpuStoreBuffer
 							 * write buffer, thus read-only buffer is
 							 * not uptodata any more. */
 	MemoryContext memcxt;	/* memory context of read-write buffer */
-	/* read-only buffer */
+	/* read-only buffer; main image consists of the shards */
 	size_t		rawsize;
-	dsm_segment	*h_seg;
-	union {
-		kern_data_store *kds;
-		void   *buffer;		/* copy of GPU device memory if any */
-	} h;
-	CUipcMemHandle ipc_mhandle;
+	size_t		main_nitems;
+	cl_int		nshards;
+	GpuStoreLocalShard shards[GSTORE_MAX_SHARDS];
+	cl_ulong	image_ident;	/* identifier of the main image */
+	/* delta image of the read-only buffer, if any */
+	dsm_segment	*d_seg;
+	GpuStoreDeltaHead *delta;
+	CUipcMemHandle delta_ipc_mhandle;
 	/* read-write buffer */
+	HTAB	   *main_mvcc;		/* non-NULL, if delta mode. The read-write
+								 * buffer keeps the rows of delta only, on
+								 * top of the read-only main image */
 	int			nattrs;
 	size_t		nitems;
 	size_t		nrooms;
@@ -93,6 +159,8 @@ struct GpuStoreBuffer
 	int		   *vl_compress;	/* one of GSTORE_COMPRESSION__* */
 	size_t	   *extra_sz;
 	MVCCAttrs  *gs_mvcc;		/* MVCC attributes */
+	/* sorted dictionary index of the read-only buffer, built on demand */
+	struct GpuStoreDictIndex **vl_dict_index;
 };
 
 /*
@@ -108,8 +176,82 @@ typedef struct
 							 * rows only */
 } vl_dict_key;
 
+/*
+ * GpuStoreDictIndex - index of the sorted varlena dictionary on the
+ * read-only KDS. Entries of the dictionary are written out in order of
+ * the default btree operator class, so offset of the entry (dictionary
+ * code) preserves the order of the values.
+ */
+typedef struct GpuStoreDictIndex
+{
+	size_t		nitems;
+	cl_uint	   *codes;			/* dictionary codes in sorted order */
+	Datum	   *values;			/* detoasted dictionary values */
+	SortSupportData ssup;
+} GpuStoreDictIndex;
+
+/*
+ * GpuStoreSnapshotHead - header of the snapshot file of gstore_fdw.
+ * The images of KDS_FORMAT_COLUMN for each shard follow the header as is,
+ * at the MAXALIGN'ed offset.
+ */
+#define GSTORE_SNAPSHOT_DIR			"pg_strom_gstore"
+#define GSTORE_SNAPSHOT_MAGIC		0x32535347		/* 'GSS2' */
+#define GSTORE_SNAPSHOT_DELTA_MAGIC	0x31445347		/* 'GSD1' */
+#define GSTORE_SNAPSHOT_HEAD_SZ		MAXALIGN(sizeof(GpuStoreSnapshotHead))
+#define GSTORE_SNAPSHOT_LOAD_UNITSZ	(256UL << 20)	/* 256MB per thread */
+#define GSTORE_SNAPSHOT_LOAD_NTHREADS 8
+typedef struct
+{
+	cl_uint			magic;		/* GSTORE_SNAPSHOT_MAGIC */
+	Oid				database_oid;
+	Oid				table_oid;
+	cl_int			format;		/* one of GSTORE_FDW_FORMAT__* */
+	cl_uint			nattrs;
+	cl_uint			nshards;	/* number of shards (1 for delta) */
+	size_t			rawsize;	/* length of the KDS (or delta) images */
+	size_t			nitems;
+	cl_ulong		image_ident;/* identifier of the main image */
+	pg_crc32		crc;		/* checksum of the fields above */
+} GpuStoreSnapshotHead;
+
+/*
+ * GpuStoreSnapshotPending - snapshot file operations to be applied at
+ * end of the transaction. Snapshot file is written to the temporary file
+ * on pre-commit, then renamed on commit or removed on abort.
+ * The delta image is written to the separate file with identifier of the
+ * main image, so it is ignored unless it matches the main snapshot file.
+ */
+typedef struct
+{
+	Oid			table_oid;
+	bool		is_delta;		/* true, if snapshot file of the delta */
+	char	   *temp_path;		/* NULL, if snapshot file shall be removed */
+} GpuStoreSnapshotPending;
+
+/*
+ * GpuStoreSnapshotLoader - argument of the loader threads
+ */
+typedef struct
+{
+	int			fdesc;
+	char	   *dest;
+	off_t		fpos;
+	size_t		length;
+	int			errcode;		/* errno, or -1 on unexpected EOF */
+} GpuStoreSnapshotLoader;
+
+/* functions */
+extern void gstoreSnapshotLauncherMain(Datum arg);
+extern void gstoreSnapshotRestoreMain(Datum arg);
+extern void gstoreCompactionMain(Datum arg);
+
 /* static variables */
 static int				gstore_max_relations;	/* GUC */
+static bool				gstore_snapshot_enabled;	/* GUC */
+static double			gstore_delta_ratio;		/* GUC */
+static List			   *gstore_snapshot_pending = NIL;
+static List			   *gstore_compaction_pending = NIL;
 static object_access_hook_type object_access_next;
 static shmem_startup_hook_type shmem_startup_next;
 static GpuStoreHead	   *gstore_head = NULL;
@@ -117,11 +259,14 @@ static HTAB			   *gstore_buffer_htab = NULL;
 
 /* SQL functions */
 Datum pgstrom_gstore_fdw_chunk_info(PG_FUNCTION_ARGS);
+Datum pgstrom_gstore_fdw_shard_info(PG_FUNCTION_ARGS);
 Datum pgstrom_gstore_fdw_format(PG_FUNCTION_ARGS);
 Datum pgstrom_gstore_fdw_nitems(PG_FUNCTION_ARGS);
 Datum pgstrom_gstore_fdw_nattrs(PG_FUNCTION_ARGS);
 Datum pgstrom_gstore_fdw_rawsize(PG_FUNCTION_ARGS);
 Datum pgstrom_gstore_export_ipchandle(PG_FUNCTION_ARGS);
+Datum pgstrom_gstore_fdw_compaction(PG_FUNCTION_ARGS);
+Datum pgstrom_gstore_fdw_reload(PG_FUNCTION_ARGS);
 
 /*
  * gstore_buf_chunk_visibility - equivalent to HeapTupleSatisfiesMVCC,
@@ -250,7 +395,8 @@ gstore_buf_visibility_bitmap(GpuStoreBuffer *gs_buffer, size_t *p_nrooms)
 	{
 		MVCCAttrs  *mvcc = &gs_buffer->gs_mvcc[i];
 
-		if (!TransactionIdIsCurrentTransactionId(mvcc->xmax))
+		if (mvcc->xmin != InvalidTransactionId &&
+			!TransactionIdIsCurrentTransactionId(mvcc->xmax))
 		{
 			/*
 			 * Row is exist on the initial load (it means somebody others
@@ -258,6 +404,8 @@ gstore_buf_visibility_bitmap(GpuStoreBuffer *gs_buffer, size_t *p_nrooms)
 			 * exclusive lock towards concurrent writer operations (INSERT/
 			 * UPDATE/DELETE), so no need to pay attention for the updates
 			 * by the concurrent transactions.
+			 * Rows with invalid xmin are never visible; inserted by aborted
+			 * transaction or deleted on the delta image.
 			 */
 			rowmap[(i >> 3)] |= (1 << (i & 7));
 			nrooms++;
@@ -330,24 +478,151 @@ gstore_buf_lookup_chunk(Oid ftable_oid, Snapshot snapshot)
 	return gs_chunk;
 }
 
+/*
+ * gstore_buf_release_shards - release the preserved memory of the shards
+ */
+static void
+gstore_buf_release_shards(GpuStoreShard *shards, int nshards)
+{
+	int			i;
+
+	for (i=0; i < nshards; i++)
+		gpuMemFreePreserved(shards[i].cuda_dindex,
+							shards[i].ipc_mhandle);
+}
+
+/*
+ * gstore_buf_attach_shards - maps the shards of the main image
+ */
+static void
+gstore_buf_attach_shards(GpuStoreBuffer *gs_buffer,
+						 GpuStoreShard *shards, int nshards)
+{
+	size_t		base_index = 0;
+	size_t		rawsize = 0;
+	int			i;
+
+	Assert(gs_buffer->nshards == 0 && nshards <= GSTORE_MAX_SHARDS);
+	for (i=0; i < nshards; i++)
+	{
+		GpuStoreLocalShard *lshard = &gs_buffer->shards[i];
+		dsm_segment	   *h_seg = dsm_attach(shards[i].dsm_mhandle);
+
+		if (!h_seg)
+			elog(ERROR, "gstore_fdw: failed on dsm_attach of shard %d", i);
+		/* DSM mapping will alive more than transaction duration */
+		dsm_pin_mapping(h_seg);
+		lshard->shard = shards[i];
+		lshard->base_index = base_index;
+		lshard->h_seg = h_seg;
+		lshard->kds = dsm_segment_address(h_seg);
+		gs_buffer->nshards = i + 1;
+
+		base_index += shards[i].nitems;
+		rawsize += shards[i].rawsize;
+	}
+	gs_buffer->main_nitems = base_index;
+	gs_buffer->rawsize = rawsize;
+}
+
+/*
+ * gstore_buf_detach_shards - unmaps the shards of the main image
+ */
+static void
+gstore_buf_detach_shards(GpuStoreBuffer *gs_buffer)
+{
+	int			i;
+
+	for (i=0; i < gs_buffer->nshards; i++)
+	{
+		if (gs_buffer->shards[i].h_seg)
+			dsm_detach(gs_buffer->shards[i].h_seg);
+	}
+	memset(gs_buffer->shards, 0, sizeof(gs_buffer->shards));
+	gs_buffer->nshards = 0;
+	gs_buffer->main_nitems = 0;
+	gs_buffer->rawsize = 0;
+}
+
+/*
+ * gstore_buf_lookup_shard - shard that contains the row on the main image
+ */
+static GpuStoreLocalShard *
+gstore_buf_lookup_shard(GpuStoreBuffer *gs_buffer, size_t row_index)
+{
+	int			head = 0;
+	int			tail = gs_buffer->nshards;
+
+	while (head < tail)
+	{
+		int			curr = (head + tail) / 2;
+		GpuStoreLocalShard *lshard = &gs_buffer->shards[curr];
+
+		if (row_index < lshard->base_index)
+			tail = curr;
+		else if (row_index >= lshard->base_index + lshard->shard.nitems)
+			head = curr + 1;
+		else
+			return lshard;
+	}
+	return NULL;
+}
+
+/*
+ * gstore_buf_alloc_shard
+ *
+ * It allocates the preserved memory for a shard on the supplied device.
+ * If device memory is not sufficient, the shard overflows to the host
+ * memory.
+ */
+static void
+gstore_buf_alloc_shard(GpuStoreShard *shard, Relation frel,
+					   cl_int cuda_dindex, size_t rawsize)
+{
+	CUresult	rc;
+
+	memset(shard, 0, sizeof(GpuStoreShard));
+	rc = gpuMemAllocPreserved(cuda_dindex,
+							  &shard->ipc_mhandle,
+							  &shard->dsm_mhandle,
+							  rawsize);
+	if (rc == CUDA_ERROR_OUT_OF_MEMORY && cuda_dindex >= 0)
+	{
+		elog(LOG, "gstore_fdw: shard of \"%s\" (%zu bytes) overflows to the host memory, because GPU%d has no sufficient device memory",
+			 RelationGetRelationName(frel), rawsize, cuda_dindex);
+		cuda_dindex = -1;
+		rc = gpuMemAllocPreserved(cuda_dindex,
+								  &shard->ipc_mhandle,
+								  &shard->dsm_mhandle,
+								  rawsize);
+	}
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on gpuMemAllocPreserved: %s", errorText(rc));
+	shard->cuda_dindex = cuda_dindex;
+	shard->rawsize = rawsize;
+}
+
 /*
  * gstore_buf_insert_chunk
+ *
+ * It registers the read-only buffer as a new version of GpuStoreChunk.
+ * xmin is usually the current transaction, but FrozenTransactionId for
+ * the image restored from the snapshot file, because it is already
+ * committed and visible to everybody.
  */
 static void
-gstore_buf_insert_chunk(GpuStoreBuffer *gs_buffer,
-						size_t nrooms,
-						CUipcMemHandle ipc_mhandle,
-						dsm_handle dsm_mhandle)
+gstore_buf_insert_chunk(GpuStoreBuffer *gs_buffer, size_t nrooms,
+						TransactionId xmin)
 {
 	dlist_node	   *dnode;
 	GpuStoreChunk  *gs_chunk;
-	int				index;
+	int				i, index;
 	dlist_iter		iter;
 
 	Assert(gs_buffer->pinning < numDevAttrs);
 	Assert(gs_buffer->read_only &&
-		   gs_buffer->h_seg != NULL &&
-		   gs_buffer->h.buffer == dsm_segment_address(gs_buffer->h_seg));
+		   gs_buffer->nshards > 0 &&
+		   gs_buffer->nshards <= GSTORE_MAX_SHARDS);
 	/* setup GpuStoreChunk */
 	SpinLockAcquire(&gstore_head->lock);
 	if (dlist_is_empty(&gstore_head->free_chunks))
@@ -365,13 +640,26 @@ gstore_buf_insert_chunk(GpuStoreBuffer *gs_buffer,
 	gs_chunk->database_oid = MyDatabaseId;
 	gs_chunk->table_oid = gs_buffer->table_oid;
 	gs_chunk->xmax = InvalidTransactionId;
-	gs_chunk->xmin = GetCurrentTransactionId();
+	gs_chunk->xmin = xmin;
 	gs_chunk->pinning = gs_buffer->pinning;
 	gs_chunk->format = gs_buffer->format;
 	gs_chunk->rawsize = gs_buffer->rawsize;
 	gs_chunk->nitems = nrooms;
-	gs_chunk->ipc_mhandle = ipc_mhandle;
-	gs_chunk->dsm_mhandle = dsm_mhandle;
+	gs_chunk->nshards = gs_buffer->nshards;
+	for (i=0; i < gs_buffer->nshards; i++)
+		gs_chunk->shards[i] = gs_buffer->shards[i].shard;
+	gs_chunk->image_ident = gs_buffer->image_ident;
+	if (!gs_buffer->delta)
+		gs_chunk->has_delta = false;
+	else
+	{
+		Assert(gs_buffer->d_seg != NULL &&
+			   gs_buffer->delta == dsm_segment_address(gs_buffer->d_seg));
+		gs_chunk->has_delta = true;
+		gs_chunk->delta_length = gs_buffer->delta->length;
+		gs_chunk->delta_ipc_mhandle = gs_buffer->delta_ipc_mhandle;
+		gs_chunk->delta_dsm_mhandle = dsm_segment_handle(gs_buffer->d_seg);
+	}
 	/* remember the revision when buffer is built */
 	gs_buffer->revision = gs_chunk->revision;
 
@@ -404,144 +692,878 @@ gstore_buf_insert_chunk(GpuStoreBuffer *gs_buffer,
 static void
 gstore_buf_release_chunk(GpuStoreChunk *gs_chunk)
 {
+	int			index = gs_chunk->hash % GSTORE_CHUNK_HASH_NSLOTS;
+	bool		main_is_shared = false;
+	dlist_iter	iter;
+
 	dlist_delete(&gs_chunk->chain);
-	gpuMemFreePreserved(gs_chunk->pinning,
-						gs_chunk->ipc_mhandle);
+	/* main image may be shared with the other versions by the delta */
+	dlist_foreach(iter, &gstore_head->active_chunks[index])
+	{
+		GpuStoreChunk  *gs_temp = dlist_container(GpuStoreChunk,
+												  chain, iter.cur);
+		if (gs_temp->shards[0].cuda_dindex == gs_chunk->shards[0].cuda_dindex &&
+			memcmp(&gs_temp->shards[0].ipc_mhandle,
+				   &gs_chunk->shards[0].ipc_mhandle,
+				   sizeof(CUipcMemHandle)) == 0)
+		{
+			main_is_shared = true;
+			break;
+		}
+	}
+	if (!main_is_shared)
+		gstore_buf_release_shards(gs_chunk->shards, gs_chunk->nshards);
+	if (gs_chunk->has_delta)
+		gpuMemFreePreserved(gs_chunk->pinning,
+							gs_chunk->delta_ipc_mhandle);
 	memset(gs_chunk, 0, sizeof(GpuStoreChunk));
 	dlist_push_head(&gstore_head->free_chunks,
 					&gs_chunk->chain);
 }
 
 /*
- * vl_dict_hash_value - hash value of varlena dictionary
+ * gstore_buf_has_live_chunk - true, if any GpuStoreChunk of the table is
+ * not deleted yet, regardless of the visibility to the current snapshot.
  */
-static uint32
-vl_dict_hash_value(const void *__key, Size keysize)
+static bool
+gstore_buf_has_live_chunk(Oid ftable_oid)
 {
-	const vl_dict_key *key = __key;
-	Datum		hash;
+	pg_crc32	hash = gstore_buf_chunk_hashvalue(ftable_oid);
+	int			index = hash % GSTORE_CHUNK_HASH_NSLOTS;
+	dlist_iter	iter;
+	bool		found = false;
 
-	if (VARATT_IS_EXTENDED(key->vl_datum))
-		elog(ERROR, "unexpected non-flat varlena datum");
-	hash = hash_any((unsigned char *)VARDATA_ANY(key->vl_datum),
-					VARSIZE_ANY(key->vl_datum));
-	return (uint32)(hash & 0xffffffff);
+	SpinLockAcquire(&gstore_head->lock);
+	dlist_foreach(iter, &gstore_head->active_chunks[index])
+	{
+		GpuStoreChunk  *gs_temp = dlist_container(GpuStoreChunk,
+												  chain, iter.cur);
+		if (gs_temp->hash == hash &&
+			gs_temp->database_oid == MyDatabaseId &&
+			gs_temp->table_oid == ftable_oid &&
+			gs_temp->xmax == InvalidTransactionId)
+		{
+			found = true;
+			break;
+		}
+	}
+	SpinLockRelease(&gstore_head->lock);
+
+	return found;
 }
 
 /*
- * vl_dict_matched - equality comparison of varlena dictionary
+ * gstore_buf_snapshot_path
  */
-static int
-vl_dict_matched(const void *__key1, const void *__key2, Size keysize)
+static char *
+gstore_buf_snapshot_path(Oid database_oid, Oid ftable_oid, bool is_delta)
 {
-	const vl_dict_key *key1 = __key1;
-	const vl_dict_key *key2 = __key2;
+	return psprintf("%s/%u_%u.%s",
+					GSTORE_SNAPSHOT_DIR, database_oid, ftable_oid,
+					is_delta ? "delta" : "kds");
+}
 
-	if (VARATT_IS_EXTENDED(key1->vl_datum) ||
-		VARATT_IS_EXTENDED(key2->vl_datum))
-		elog(ERROR, "unexpected non-flat varlena datum");
-	else
-	{
-		const char *temp1 = VARDATA_ANY(key1->vl_datum);
-		const char *temp2 = VARDATA_ANY(key2->vl_datum);
-		size_t		sz = VARSIZE_ANY_EXHDR(key1->vl_datum);
+/*
+ * gstore_buf_snapshot_pending - registers a snapshot file operation
+ */
+static void
+gstore_buf_snapshot_pending(Oid ftable_oid, bool is_delta,
+							const char *temp_path)
+{
+	GpuStoreSnapshotPending *pending;
+	MemoryContext	oldcxt;
 
-		if (sz == VARSIZE_ANY_EXHDR(key2->vl_datum))
-			return memcmp(temp1, temp2, sz);
-	}
-	return 1;
+	oldcxt = MemoryContextSwitchTo(TopMemoryContext);
+	pending = palloc(sizeof(GpuStoreSnapshotPending));
+	pending->table_oid = ftable_oid;
+	pending->is_delta = is_delta;
+	pending->temp_path = (temp_path ? pstrdup(temp_path) : NULL);
+	gstore_snapshot_pending = lappend(gstore_snapshot_pending, pending);
+	MemoryContextSwitchTo(oldcxt);
 }
 
 /*
- * vl_datum_compression - makes varlena compressed
+ * gstore_buf_snapshot_atxact - applies the pending snapshot file operations
+ * at end of the transaction
  */
-static struct varlena *
-vl_datum_compression(void *datum, int vl_comression)
+static void
+gstore_buf_snapshot_atxact(bool is_commit)
 {
-	struct varlena *vl = NULL;
+	ListCell   *lc;
 
-	if (vl_comression == GSTORE_COMPRESSION__PGLZ)
+	foreach (lc, gstore_snapshot_pending)
 	{
-		struct varlena *temp = PG_DETOAST_DATUM(datum);
+		GpuStoreSnapshotPending *pending = lfirst(lc);
+		char	   *path = gstore_buf_snapshot_path(MyDatabaseId,
+													pending->table_oid,
+													pending->is_delta);
+		if (!is_commit)
+		{
+			if (pending->temp_path &&
+				unlink(pending->temp_path) != 0 && errno != ENOENT)
+				elog(WARNING, "failed on unlink('%s'): %m",
+					 pending->temp_path);
+		}
+		else if (pending->temp_path)
+		{
+			/* it reports the error by itself, if any */
+			(void) durable_rename(pending->temp_path, path, WARNING);
+		}
+		else if (unlink(path) != 0 && errno != ENOENT)
+			elog(WARNING, "failed on unlink('%s'): %m", path);
 
-		vl = (struct varlena *)toast_compress_datum(PointerGetDatum(temp));
+		pfree(path);
+		if (pending->temp_path)
+			pfree(pending->temp_path);
+		pfree(pending);
 	}
-	else if (vl_comression != GSTORE_COMPRESSION__NONE)
-		elog(ERROR, "unknown compresion logic %d", vl_comression);
-
-	return vl;
+	list_free(gstore_snapshot_pending);
+	gstore_snapshot_pending = NIL;
 }
 
 /*
- * vl_datum_compare - support routine for varlena sorting
+ * __gstore_buf_snapshot_pwrite
  */
-static int
-vl_datum_compare(const void *a, const void *b, void *arg)
+static bool
+__gstore_buf_snapshot_pwrite(int fdesc, const void *buffer,
+							 size_t length, off_t fpos)
 {
-	const vl_dict_key  *vl_a = *((vl_dict_key **)a);
-	const vl_dict_key  *vl_b = *((vl_dict_key **)b);
+	const char *pos = buffer;
+	ssize_t		nbytes;
 
-	return ApplySortComparator(PointerGetDatum(vl_a->vl_datum), false,
-							   PointerGetDatum(vl_b->vl_datum), false,
-							   (SortSupport) arg);
+	while (length > 0)
+	{
+		nbytes = pwrite(fdesc, pos, length, fpos);
+		if (nbytes < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		pos += nbytes;
+		fpos += nbytes;
+		length -= nbytes;
+	}
+	return true;
 }
 
 /*
- * vl_datum_writeout - write out varlena datum onto extra buffer of KDS
+ * gstore_buf_snapshot_write
+ *
+ * It writes out the shards of the new read-only buffer (KDS), or the delta
+ * image on top of the main image if any, to the temporary snapshot file,
+ * then it shall be renamed to the snapshot file of the table at commit time.
  */
-static size_t
-vl_datum_writeout(GpuStoreBuffer *gs_buffer, AttrNumber j,
-				  Form_pg_attribute attr, bits8 *rowmap,
-				  cl_uint *base, char *extra)
+static void
+gstore_buf_snapshot_write(GpuStoreBuffer *gs_buffer,
+						  GpuStoreDeltaHead *delta)
 {
-	HTAB	   *vl_dict = gs_buffer->vl_dict[j];
-	Oid			vl_ltop;
-	char	   *pos = extra;
-	HASH_SEQ_STATUS seq;
-
-	if (!vl_dict)
-		return 0;
-
-	/*
-	 * Sort by varlena values first, if operator can support.
-	 * It enables special optimization for GPU kernel.
-	 */
-	get_sort_group_operators(attr->atttypid,
-							 false, false, false,
-							 &vl_ltop, NULL, NULL, NULL);
-	if (!OidIsValid(vl_ltop))
+	GpuStoreSnapshotHead head;
+	bool		is_delta = (delta != NULL);
+	size_t		length = 0;
+	char	   *temp_path;
+	int			i, fdesc;
+	struct timeval tv1, tv2;
+	double		elapsed;
+
+	if (!gstore_snapshot_enabled)
 	{
-		vl_dict_key *entry;
-		struct varlena *vl_datum;
-		size_t		vl_len;
-
-		/* No sortable operators, so no chance to be sorted on SQL */
-		hash_seq_init(&seq, vl_dict);
-		while ((entry = hash_seq_search(&seq)) != NULL)
+		/* older snapshot files (if any) are no longer up-to-date */
+		gstore_buf_snapshot_pending(gs_buffer->table_oid, false, NULL);
+		gstore_buf_snapshot_pending(gs_buffer->table_oid, true, NULL);
+		return;
+	}
+	/* older delta is not valid for the new main image */
+	if (!is_delta)
+		gstore_buf_snapshot_pending(gs_buffer->table_oid, true, NULL);
+	gettimeofday(&tv1, NULL);
+
+	if (mkdir(GSTORE_SNAPSHOT_DIR, S_IRWXU) != 0 && errno != EEXIST)
+		elog(ERROR, "failed on mkdir('%s'): %m", GSTORE_SNAPSHOT_DIR);
+	temp_path = psprintf("%s/%u_%u.%s.tmp%d",
+						 GSTORE_SNAPSHOT_DIR,
+						 MyDatabaseId,
+						 gs_buffer->table_oid,
+						 is_delta ? "delta" : "kds",
+						 MyProcPid);
+	fdesc = open(temp_path, O_WRONLY | O_CREAT | O_TRUNC | PG_BINARY, 0600);
+	if (fdesc < 0)
+		elog(ERROR, "failed on open('%s'): %m", temp_path);
+	/* temporary file shall be removed on abort */
+	gstore_buf_snapshot_pending(gs_buffer->table_oid, is_delta, temp_path);
+
+	memset(&head, 0, sizeof(GpuStoreSnapshotHead));
+	head.database_oid = MyDatabaseId;
+	head.table_oid = gs_buffer->table_oid;
+	head.format = gs_buffer->format;
+	head.image_ident = gs_buffer->image_ident;
+	if (is_delta)
+	{
+		head.magic = GSTORE_SNAPSHOT_DELTA_MAGIC;
+		head.nattrs = GSTORE_DELTA_KDS(delta)->ncols;
+		head.nshards = 1;
+		head.rawsize = delta->length;
+		head.nitems = GSTORE_DELTA_KDS(delta)->nitems;
+	}
+	else
+	{
+		Assert(gs_buffer->nshards > 0);
+		head.magic = GSTORE_SNAPSHOT_MAGIC;
+		head.nattrs = gs_buffer->shards[0].kds->ncols;
+		head.nshards = gs_buffer->nshards;
+		for (i=0; i < gs_buffer->nshards; i++)
+			head.rawsize += MAXALIGN(gs_buffer->shards[i].kds->length);
+		head.nitems = gs_buffer->main_nitems;
+	}
+	INIT_LEGACY_CRC32(head.crc);
+	COMP_LEGACY_CRC32(head.crc, &head, offsetof(GpuStoreSnapshotHead, crc));
+	FIN_LEGACY_CRC32(head.crc);
+
+	if (!__gstore_buf_snapshot_pwrite(fdesc, &head,
+									  sizeof(GpuStoreSnapshotHead), 0))
+		goto error;
+	if (is_delta)
+	{
+		if (!__gstore_buf_snapshot_pwrite(fdesc, delta, delta->length,
+										  GSTORE_SNAPSHOT_HEAD_SZ))
+			goto error;
+		length = delta->length;
+	}
+	else
+	{
+		for (i=0; i < gs_buffer->nshards; i++)
 		{
-			if (rowmap && entry->usecnt == 0)
-				continue;		/* unreferenced, skip */
-			if (!entry->compressed)
-				vl_datum = entry->vl_datum;
-			else
-				vl_datum = entry->compressed;
-			vl_len = VARSIZE_ANY(vl_datum);
-			memcpy(pos, vl_datum, vl_len);
-			entry->offset = __kds_packed((char *)pos - (char *)base);
-			pos += MAXALIGN(vl_len);
+			kern_data_store *kds = gs_buffer->shards[i].kds;
+
+			if (!__gstore_buf_snapshot_pwrite(fdesc, kds, kds->length,
+											  GSTORE_SNAPSHOT_HEAD_SZ +
+											  length))
+				goto error;
+			length += MAXALIGN(kds->length);
 		}
 	}
-	else
+	if (pg_fsync(fdesc) != 0)
+		goto error;
+	close(fdesc);
+
+	gettimeofday(&tv2, NULL);
+	elapsed = ((double)(tv2.tv_sec - tv1.tv_sec) +
+			   (double)(tv2.tv_usec - tv1.tv_usec) / 1000000.0);
+	elog(DEBUG1, "gstore_fdw: %s snapshot of \"%s\" written (%zu bytes in %.3fsec, %.2fMB/s)",
+		 is_delta ? "delta" : "main",
+		 get_rel_name(gs_buffer->table_oid), length, elapsed,
+		 (double)length / (1048576.0 * Max(elapsed, 0.000001)));
+	pfree(temp_path);
+	return;
+
+error:
 	{
-		SortSupportData ssup;
-		size_t		i, nitems;
-		vl_dict_key **vl_items;
-		vl_dict_key *entry;
-		struct varlena *vl_datum;
-		size_t		vl_len;
+		int		errno_saved = errno;
 
-		memset(&ssup, 0, sizeof(ssup));
-		ssup.ssup_cxt = gs_buffer->memcxt;
+		close(fdesc);
+		errno = errno_saved;
+		elog(ERROR, "failed on write('%s'): %m", temp_path);
+	}
+}
+
+/*
+ * gstore_buf_snapshot_loader - thread entrypoint to read a part of the
+ * snapshot file
+ */
+static void *
+gstore_buf_snapshot_loader(void *__arg)
+{
+	GpuStoreSnapshotLoader *loader = __arg;
+	char	   *dest = loader->dest;
+	off_t		fpos = loader->fpos;
+	size_t		length = loader->length;
+	ssize_t		nbytes;
+
+	while (length > 0)
+	{
+		nbytes = pread(loader->fdesc, dest, length, fpos);
+		if (nbytes < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			loader->errcode = errno;
+			break;
+		}
+		else if (nbytes == 0)
+		{
+			loader->errcode = -1;
+			break;
+		}
+		dest += nbytes;
+		fpos += nbytes;
+		length -= nbytes;
+	}
+	return NULL;
+}
+
+/*
+ * gstore_buf_snapshot_load - reads the KDS image from the snapshot file
+ * using multiple threads
+ */
+static void
+gstore_buf_snapshot_load(int fdesc, const char *path,
+						 char *dest, size_t length, off_t fpos)
+{
+	GpuStoreSnapshotLoader loaders[GSTORE_SNAPSHOT_LOAD_NTHREADS];
+	pthread_t	threads[GSTORE_SNAPSHOT_LOAD_NTHREADS];
+	size_t		unitsz;
+	int			i, nthreads;
+
+	nthreads = Min(1 + length / GSTORE_SNAPSHOT_LOAD_UNITSZ,
+				   GSTORE_SNAPSHOT_LOAD_NTHREADS);
+	unitsz = TYPEALIGN(BLCKSZ, (length + nthreads - 1) / nthreads);
+	memset(loaders, 0, sizeof(loaders));
+	for (i=0; i < nthreads; i++)
+	{
+		size_t		offset = Min(unitsz * i, length);
+
+		loaders[i].fdesc  = fdesc;
+		loaders[i].dest   = dest + offset;
+		loaders[i].fpos   = fpos + offset;
+		loaders[i].length = Min(unitsz, length - offset);
+	}
+	/* the first portion is loaded by the backend itself */
+	for (i=1; i < nthreads; i++)
+	{
+		if ((errno = pthread_create(&threads[i], NULL,
+									gstore_buf_snapshot_loader,
+									&loaders[i])) != 0)
+		{
+			int		errno_saved = errno;
+
+			while (--i > 0)
+				pthread_join(threads[i], NULL);
+			errno = errno_saved;
+			elog(ERROR, "failed on pthread_create: %m");
+		}
+	}
+	gstore_buf_snapshot_loader(&loaders[0]);
+	for (i=1; i < nthreads; i++)
+		pthread_join(threads[i], NULL);
+
+	for (i=0; i < nthreads; i++)
+	{
+		if (loaders[i].errcode < 0)
+			elog(ERROR, "gstore_fdw: snapshot file '%s' is truncated", path);
+		else if (loaders[i].errcode > 0)
+		{
+			errno = loaders[i].errcode;
+			elog(ERROR, "failed on pread('%s'): %m", path);
+		}
+	}
+}
+
+/*
+ * gstore_buf_snapshot_validate - checks header of the snapshot file
+ */
+static bool
+gstore_buf_snapshot_validate(int fdesc, const char *path,
+							 GpuStoreBuffer *gs_buffer, TupleDesc tupdesc,
+							 GpuStoreSnapshotHead *head)
+{
+	kern_data_store *kds;
+	size_t		kds_head_sz = offsetof(kern_data_store,
+									   colmeta[tupdesc->natts]);
+	struct stat	st_buf;
+	pg_crc32	crc;
+	int			j;
+
+	if (fstat(fdesc, &st_buf) != 0)
+		elog(ERROR, "failed on fstat('%s'): %m", path);
+	if ((size_t)st_buf.st_size < GSTORE_SNAPSHOT_HEAD_SZ + kds_head_sz ||
+		pread(fdesc, head, sizeof(GpuStoreSnapshotHead), 0)
+			!= sizeof(GpuStoreSnapshotHead))
+		return false;
+	INIT_LEGACY_CRC32(crc);
+	COMP_LEGACY_CRC32(crc, head, offsetof(GpuStoreSnapshotHead, crc));
+	FIN_LEGACY_CRC32(crc);
+	if (head->magic != GSTORE_SNAPSHOT_MAGIC ||
+		head->crc != crc ||
+		head->database_oid != MyDatabaseId ||
+		head->table_oid != gs_buffer->table_oid ||
+		head->format != gs_buffer->format ||
+		head->nattrs != tupdesc->natts ||
+		head->nshards < 1 ||
+		head->nshards > GSTORE_MAX_SHARDS ||
+		(size_t)st_buf.st_size != GSTORE_SNAPSHOT_HEAD_SZ + head->rawsize)
+		return false;
+
+	/* definition of the columns must be identical (checks the first shard) */
+	kds = palloc(kds_head_sz);
+	if (pread(fdesc, kds, kds_head_sz,
+			  GSTORE_SNAPSHOT_HEAD_SZ) != kds_head_sz ||
+		kds->length > head->rawsize ||
+		kds->nitems > head->nitems ||
+		kds->ncols  != tupdesc->natts ||
+		kds->format != KDS_FORMAT_COLUMN)
+	{
+		pfree(kds);
+		return false;
+	}
+	for (j=0; j < tupdesc->natts; j++)
+	{
+		Form_pg_attribute attr = tupleDescAttr(tupdesc, j);
+		kern_colmeta *cmeta = &kds->colmeta[j];
+
+		if (cmeta->attbyval  != attr->attbyval ||
+			cmeta->attlen    != attr->attlen ||
+			cmeta->attnum    != attr->attnum ||
+			cmeta->atttypid  != attr->atttypid ||
+			cmeta->atttypmod != attr->atttypmod)
+		{
+			pfree(kds);
+			return false;
+		}
+	}
+	pfree(kds);
+
+	return true;
+}
+
+/*
+ * gstore_buf_snapshot_restore_delta
+ *
+ * It restores the delta image on top of the main image just restored,
+ * if the delta snapshot file is built on the same main image.
+ */
+static void
+gstore_buf_snapshot_restore_delta(GpuStoreBuffer *gs_buffer, Relation frel)
+{
+	GpuStoreSnapshotHead head;
+	GpuStoreDeltaHead *delta;
+	kern_data_store *kds;
+	char		   *path;
+	int				fdesc;
+	struct stat		st_buf;
+	pg_crc32		crc;
+	CUresult		rc;
+	CUipcMemHandle	ipc_mhandle;
+	dsm_handle		dsm_mhandle;
+	dsm_segment	   *d_seg;
+
+	path = gstore_buf_snapshot_path(MyDatabaseId, gs_buffer->table_oid, true);
+	fdesc = open(path, O_RDONLY | PG_BINARY);
+	if (fdesc < 0)
+	{
+		if (errno != ENOENT)
+			elog(ERROR, "failed on open('%s'): %m", path);
+		pfree(path);
+		return;
+	}
+
+	PG_TRY();
+	{
+		if (fstat(fdesc, &st_buf) != 0)
+			elog(ERROR, "failed on fstat('%s'): %m", path);
+		if ((size_t)st_buf.st_size < GSTORE_SNAPSHOT_HEAD_SZ ||
+			pread(fdesc, &head, sizeof(GpuStoreSnapshotHead), 0)
+				!= sizeof(GpuStoreSnapshotHead))
+			memset(&head, 0, sizeof(GpuStoreSnapshotHead));
+		INIT_LEGACY_CRC32(crc);
+		COMP_LEGACY_CRC32(crc, &head, offsetof(GpuStoreSnapshotHead, crc));
+		FIN_LEGACY_CRC32(crc);
+		/* delta of the older main image shall be ignored */
+		if (head.magic != GSTORE_SNAPSHOT_DELTA_MAGIC ||
+			head.crc != crc ||
+			head.database_oid != MyDatabaseId ||
+			head.table_oid != gs_buffer->table_oid ||
+			head.format != gs_buffer->format ||
+			head.nattrs != RelationGetNumberOfAttributes(frel) ||
+			head.image_ident != gs_buffer->image_ident ||
+			(size_t)st_buf.st_size != GSTORE_SNAPSHOT_HEAD_SZ + head.rawsize)
+		{
+			elog(LOG, "gstore_fdw: delta snapshot file '%s' does not match to the main image, ignored", path);
+		}
+		else
+		{
+			rc = gpuMemAllocPreserved(gs_buffer->pinning,
+									  &ipc_mhandle,
+									  &dsm_mhandle,
+									  head.rawsize);
+			if (rc != CUDA_SUCCESS)
+				elog(ERROR, "failed on gpuMemAllocPreserved: %s",
+					 errorText(rc));
+			PG_TRY();
+			{
+				d_seg = dsm_attach(dsm_mhandle);
+				delta = dsm_segment_address(d_seg);
+				gstore_buf_snapshot_load(fdesc, path,
+										 (char *)delta, head.rawsize,
+										 GSTORE_SNAPSHOT_HEAD_SZ);
+				kds = GSTORE_DELTA_KDS(delta);
+				if (delta->length != head.rawsize ||
+					delta->main_nitems != gs_buffer->main_nitems ||
+					delta->kds_offset < offsetof(GpuStoreDeltaHead,
+												 deleted[delta->ndeleted]) ||
+					delta->kds_offset + kds->length != delta->length ||
+					kds->format != KDS_FORMAT_COLUMN ||
+					kds->ncols != head.nattrs)
+					elog(ERROR, "gstore_fdw: delta snapshot file '%s' is corrupted", path);
+				gs_buffer->d_seg = d_seg;
+				gs_buffer->delta = delta;
+				gs_buffer->delta_ipc_mhandle = ipc_mhandle;
+				/* keep DSM mapping */
+				dsm_pin_mapping(d_seg);
+			}
+			PG_CATCH();
+			{
+				gpuMemFreePreserved(gs_buffer->pinning, ipc_mhandle);
+				gs_buffer->d_seg = NULL;
+				gs_buffer->delta = NULL;
+				PG_RE_THROW();
+			}
+			PG_END_TRY();
+		}
+	}
+	PG_CATCH();
+	{
+		close(fdesc);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+	close(fdesc);
+	pfree(path);
+}
+
+/*
+ * gstore_buf_snapshot_restore
+ *
+ * It restores the read-only buffer from the snapshot file, if any, and
+ * registers it as a new version of GpuStoreChunk. It returns true, if
+ * GpuStoreChunk of the table may become available, either restored by
+ * this backend or by the concurrent one, so caller has to look up again.
+ *
+ * Any write on the gstore_fdw table registers a new version of chunk and
+ * replaces (or removes) the snapshot file on commit, so snapshot file of
+ * the table without live chunk exists only on the first load after the
+ * restart.
+ */
+static bool
+gstore_buf_snapshot_restore(Relation frel)
+{
+	Oid				ftable_oid = RelationGetRelid(frel);
+	GpuStoreBuffer *gs_buffer;
+	GpuStoreSnapshotHead head;
+	char		   *path;
+	int				fdesc;
+	CUresult		rc;
+	bool			is_valid;
+	cl_int			pinning;
+	cl_int			format;
+	struct timeval	tv1, tv2;
+	double			elapsed;
+
+	if (!gstore_snapshot_enabled ||
+		IsInParallelMode() ||
+		RecoveryInProgress())
+		return false;
+
+	path = gstore_buf_snapshot_path(MyDatabaseId, ftable_oid, false);
+	if (access(path, F_OK) != 0)
+	{
+		pfree(path);
+		return false;
+	}
+
+	/*
+	 * NOTE: ShareRowExclusiveLock conflicts with the writer transactions
+	 * (RowExclusiveLock) and the concurrent restore. Once the lock is
+	 * acquired, we have to check whether GpuStoreChunk is already restored
+	 * (or written) by others, and whether the snapshot file still exists.
+	 * The lock is released just after the restore, not at end of the
+	 * transaction, because the restored image is already visible to
+	 * everybody.
+	 */
+	LockRelationOid(ftable_oid, ShareRowExclusiveLock);
+	if (gstore_buf_has_live_chunk(ftable_oid))
+	{
+		UnlockRelationOid(ftable_oid, ShareRowExclusiveLock);
+		pfree(path);
+		return true;
+	}
+
+	gettimeofday(&tv1, NULL);
+	fdesc = open(path, O_RDONLY | PG_BINARY);
+	if (fdesc < 0)
+	{
+		if (errno != ENOENT)
+			elog(ERROR, "failed on open('%s'): %m", path);
+		UnlockRelationOid(ftable_oid, ShareRowExclusiveLock);
+		pfree(path);
+		return false;
+	}
+
+	/*
+	 * The image is restored on the temporary buffer, then published as
+	 * GpuStoreChunk only when it is fully populated. Caller attaches the
+	 * chunk as usual.
+	 */
+	gstore_fdw_table_options(ftable_oid, &pinning, &format);
+	gs_buffer = palloc0(sizeof(GpuStoreBuffer));
+	gs_buffer->table_oid = ftable_oid;
+	gs_buffer->pinning   = pinning;
+	gs_buffer->format    = format;
+	gs_buffer->read_only = true;
+
+	PG_TRY();
+	{
+		is_valid = gstore_buf_snapshot_validate(fdesc, path, gs_buffer,
+												RelationGetDescr(frel),
+												&head);
+		if (is_valid)
+		{
+			GpuStoreShard shards[GSTORE_MAX_SHARDS];
+			List	   *devices;
+			size_t		shard_nrows;
+			size_t		offset = 0;
+			size_t		nitems = 0;
+			volatile cl_uint nshards = 0;
+
+			gstore_fdw_table_shard_options(ftable_oid, &devices,
+										   &shard_nrows);
+			PG_TRY();
+			{
+				/*
+				 * Shards are re-distributed to the devices according to
+				 * the current 'pinning' option.
+				 */
+				while (nshards < head.nshards)
+				{
+					GpuStoreShard  *shard = &shards[nshards];
+					kern_data_store	kds_head;
+					dsm_segment	   *h_seg;
+					cl_int			dindex;
+
+					if (offset + sizeof(kern_data_store) > head.rawsize ||
+						pread(fdesc, &kds_head, sizeof(kern_data_store),
+							  GSTORE_SNAPSHOT_HEAD_SZ + offset)
+							!= sizeof(kern_data_store) ||
+						kds_head.format != KDS_FORMAT_COLUMN ||
+						kds_head.ncols != head.nattrs ||
+						offset + kds_head.length > head.rawsize)
+						elog(ERROR, "gstore_fdw: snapshot file '%s' is corrupted", path);
+					dindex = list_nth_int(devices,
+										  nshards % list_length(devices));
+					gstore_buf_alloc_shard(shard, frel, dindex,
+										   kds_head.length);
+					shard->nitems = kds_head.nitems;
+					nshards++;
+
+					h_seg = dsm_attach(shard->dsm_mhandle);
+					gstore_buf_snapshot_load(fdesc, path,
+											 dsm_segment_address(h_seg),
+											 kds_head.length,
+											 GSTORE_SNAPSHOT_HEAD_SZ + offset);
+					dsm_detach(h_seg);
+					/* load the shard of read-only buffer to GPU device */
+					if (shard->cuda_dindex >= 0)
+					{
+						rc = gpuMemLoadPreserved(shard->cuda_dindex,
+												 shard->ipc_mhandle);
+						if (rc != CUDA_SUCCESS)
+							elog(ERROR, "failed on gpuMemLoadPreserved: %s",
+								 errorText(rc));
+					}
+					offset += MAXALIGN(kds_head.length);
+					nitems += kds_head.nitems;
+				}
+				if (offset != head.rawsize || nitems != head.nitems)
+					elog(ERROR, "gstore_fdw: snapshot file '%s' is corrupted", path);
+				gstore_buf_attach_shards(gs_buffer, shards, nshards);
+				gs_buffer->image_ident = head.image_ident;
+				/* delta image on the main image, if any */
+				gstore_buf_snapshot_restore_delta(gs_buffer, frel);
+				if (gs_buffer->delta)
+				{
+					nitems -= gs_buffer->delta->ndeleted;
+					nitems += GSTORE_DELTA_KDS(gs_buffer->delta)->nitems;
+				}
+				/* no XID is assigned on restore, even if read path */
+				gstore_buf_insert_chunk(gs_buffer, nitems,
+										FrozenTransactionId);
+			}
+			PG_CATCH();
+			{
+				if (gs_buffer->delta)
+					gpuMemFreePreserved(gs_buffer->pinning,
+										gs_buffer->delta_ipc_mhandle);
+				if (gs_buffer->d_seg)
+					dsm_detach(gs_buffer->d_seg);
+				gstore_buf_detach_shards(gs_buffer);
+				gstore_buf_release_shards(shards, nshards);
+				PG_RE_THROW();
+			}
+			PG_END_TRY();
+			list_free(devices);
+		}
+	}
+	PG_CATCH();
+	{
+		close(fdesc);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+	close(fdesc);
+	UnlockRelationOid(ftable_oid, ShareRowExclusiveLock);
+
+	if (!is_valid)
+	{
+		elog(WARNING, "gstore_fdw: snapshot file '%s' does not match to the definition of \"%s\", ignored",
+			 path, RelationGetRelationName(frel));
+		pfree(gs_buffer);
+		pfree(path);
+		return false;
+	}
+	/* GpuStoreChunk keeps the shards; temporary mapping is no longer used */
+	if (gs_buffer->d_seg)
+		dsm_detach(gs_buffer->d_seg);
+	gstore_buf_detach_shards(gs_buffer);
+	pfree(gs_buffer);
+
+	gettimeofday(&tv2, NULL);
+	elapsed = ((double)(tv2.tv_sec - tv1.tv_sec) +
+			   (double)(tv2.tv_usec - tv1.tv_usec) / 1000000.0);
+	elog(LOG, "gstore_fdw: \"%s\" restored from snapshot (%zu rows, %zu bytes in %.3fsec, %.2fMB/s)",
+		 RelationGetRelationName(frel), head.nitems, head.rawsize, elapsed,
+		 (double)head.rawsize / (1048576.0 * Max(elapsed, 0.000001)));
+	pfree(path);
+
+	return true;
+}
+
+/*
+ * vl_dict_hash_value - hash value of varlena dictionary
+ */
+static uint32
+vl_dict_hash_value(const void *__key, Size keysize)
+{
+	const vl_dict_key *key = __key;
+	Datum		hash;
+
+	if (VARATT_IS_EXTENDED(key->vl_datum))
+		elog(ERROR, "unexpected non-flat varlena datum");
+	hash = hash_any((unsigned char *)VARDATA_ANY(key->vl_datum),
+					VARSIZE_ANY(key->vl_datum));
+	return (uint32)(hash & 0xffffffff);
+}
+
+/*
+ * vl_dict_matched - equality comparison of varlena dictionary
+ */
+static int
+vl_dict_matched(const void *__key1, const void *__key2, Size keysize)
+{
+	const vl_dict_key *key1 = __key1;
+	const vl_dict_key *key2 = __key2;
+
+	if (VARATT_IS_EXTENDED(key1->vl_datum) ||
+		VARATT_IS_EXTENDED(key2->vl_datum))
+		elog(ERROR, "unexpected non-flat varlena datum");
+	else
+	{
+		const char *temp1 = VARDATA_ANY(key1->vl_datum);
+		const char *temp2 = VARDATA_ANY(key2->vl_datum);
+		size_t		sz = VARSIZE_ANY_EXHDR(key1->vl_datum);
+
+		if (sz == VARSIZE_ANY_EXHDR(key2->vl_datum))
+			return memcmp(temp1, temp2, sz);
+	}
+	return 1;
+}
+
+/*
+ * vl_datum_compression - makes varlena compressed
+ */
+static struct varlena *
+vl_datum_compression(void *datum, int vl_comression)
+{
+	struct varlena *vl = NULL;
+
+	if (vl_comression == GSTORE_COMPRESSION__PGLZ)
+	{
+		struct varlena *temp = PG_DETOAST_DATUM(datum);
+
+		vl = (struct varlena *)toast_compress_datum(PointerGetDatum(temp));
+	}
+	else if (vl_comression != GSTORE_COMPRESSION__NONE)
+		elog(ERROR, "unknown compresion logic %d", vl_comression);
+
+	return vl;
+}
+
+/*
+ * vl_datum_compare - support routine for varlena sorting
+ */
+static int
+vl_datum_compare(const void *a, const void *b, void *arg)
+{
+	const vl_dict_key  *vl_a = *((vl_dict_key **)a);
+	const vl_dict_key  *vl_b = *((vl_dict_key **)b);
+
+	return ApplySortComparator(PointerGetDatum(vl_a->vl_datum), false,
+							   PointerGetDatum(vl_b->vl_datum), false,
+							   (SortSupport) arg);
+}
+
+/*
+ * vl_datum_writeout - write out varlena datum onto extra buffer of KDS
+ */
+static size_t
+vl_datum_writeout(GpuStoreBuffer *gs_buffer, AttrNumber j,
+				  Form_pg_attribute attr, bits8 *rowmap,
+				  cl_uint *base, char *extra)
+{
+	HTAB	   *vl_dict = gs_buffer->vl_dict[j];
+	Oid			vl_ltop;
+	char	   *pos = extra;
+	HASH_SEQ_STATUS seq;
+
+	if (!vl_dict)
+		return 0;
+
+	/*
+	 * Sort by varlena values first, if operator can support.
+	 * It enables special optimization for GPU kernel.
+	 */
+	vl_ltop = gstore_buf_vl_dict_ordering(attr->atttypid);
+	if (!OidIsValid(vl_ltop))
+	{
+		vl_dict_key *entry;
+		struct varlena *vl_datum;
+		size_t		vl_len;
+
+		/* No sortable operators, so no chance to be sorted on SQL */
+		hash_seq_init(&seq, vl_dict);
+		while ((entry = hash_seq_search(&seq)) != NULL)
+		{
+			if (rowmap && entry->usecnt == 0)
+				continue;		/* unreferenced, skip */
+			if (!entry->compressed)
+				vl_datum = entry->vl_datum;
+			else
+				vl_datum = entry->compressed;
+			vl_len = VARSIZE_ANY(vl_datum);
+			memcpy(pos, vl_datum, vl_len);
+			entry->offset = __kds_packed((char *)pos - (char *)base);
+			pos += MAXALIGN(vl_len);
+		}
+	}
+	else
+	{
+		SortSupportData ssup;
+		size_t		i, nitems;
+		vl_dict_key **vl_items;
+		vl_dict_key *entry;
+		struct varlena *vl_datum;
+		size_t		vl_len;
+
+		memset(&ssup, 0, sizeof(ssup));
+		ssup.ssup_cxt = gs_buffer->memcxt;
 		ssup.ssup_collation = attr->attcollation;
 		ssup.ssup_nulls_first = false;
 		PrepareSortSupportFromOrderingOp(vl_ltop, &ssup);
@@ -586,12 +1608,14 @@ vl_datum_writeout(GpuStoreBuffer *gs_buffer, AttrNumber j,
 /*
  * GpuStoreBufferCopyFromKDS
  *
- * It fills up the initial read-write buffer by the read-only KDS.
+ * It fills up the read-write buffer by the read-only KDS, from the
+ * @base_index'th row.
  */
 static void
 GpuStoreBufferCopyFromKDS(GpuStoreBuffer *gs_buffer,
 						  TupleDesc tupdesc,
-						  kern_data_store *kds)
+						  kern_data_store *kds,
+						  size_t base_index)
 {
 	size_t		i, nitems = kds->nitems;
 	cl_uint		j;
@@ -599,7 +1623,7 @@ GpuStoreBufferCopyFromKDS(GpuStoreBuffer *gs_buffer,
 
 	Assert(kds->ncols == tupdesc->natts &&
 		   kds->ncols == gs_buffer->nattrs);
-	if (kds->nitems > gs_buffer->nrooms)
+	if (base_index + kds->nitems > gs_buffer->nrooms)
 		elog(ERROR, "lack of GpuStoreBuffer rooms");
 
 	oldcxt = MemoryContextSwitchTo(gs_buffer->memcxt);
@@ -629,19 +1653,22 @@ GpuStoreBufferCopyFromKDS(GpuStoreBuffer *gs_buffer,
 		{
 			if (cmeta->attlen < 0)
 			{
+				vl_dict_key	  **vl_array = (vl_dict_key **)gs_buffer->values[j];
+
 				Assert(gs_buffer->nullmap[j] == NULL);
 				gs_buffer->hasnull[j] = true;
-				memset(gs_buffer->values[j],
+				memset(vl_array + base_index,
 					   0, sizeof(vl_dict_key *) * nitems);
 				Assert(gs_buffer->vl_dict[j] != NULL);
-				gs_buffer->extra_sz[j] = 0;
 			}
 			else
 			{
-				memset(gs_buffer->nullmap[j], 0, BITMAPLEN(nitems));
+				bits8	   *nullmap = gs_buffer->nullmap[j];
+
+				for (i=base_index; i < base_index + nitems; i++)
+					nullmap[i >> 3] &= ~(1 << (i & 7));
 				gs_buffer->hasnull[j] = true;
 				Assert(gs_buffer->vl_dict[j] == NULL);
-				gs_buffer->extra_sz[j] = 0;
 			}
 			continue;
 		}
@@ -660,7 +1687,8 @@ GpuStoreBufferCopyFromKDS(GpuStoreBuffer *gs_buffer,
 				offset = __kds_unpack(((cl_uint *)addr)[i]);
 				if (offset == 0)
 				{
-					vl_array[i] = NULL;
+					vl_array[base_index + i] = NULL;
+					gs_buffer->hasnull[j] = true;
 					continue;
 				}
 				datum = (char *)addr + offset;
@@ -682,10 +1710,10 @@ GpuStoreBufferCopyFromKDS(GpuStoreBuffer *gs_buffer,
 					entry->compressed = NULL;
 					gs_buffer->extra_sz[j] += MAXALIGN(VARSIZE(vl));
 				}
-				if (MAXALIGN(sizeof(cl_uint) * nitems) +
+				if (MAXALIGN(sizeof(cl_uint) * (base_index + nitems)) +
 					gs_buffer->extra_sz[j] >= KDS_OFFSET_MAX_SIZE)
 					elog(ERROR, "too much vl_dictionary consumption");
-				vl_array[i] = entry;
+				vl_array[base_index + i] = entry;
 			}
 		}
 		else
@@ -693,23 +1721,41 @@ GpuStoreBufferCopyFromKDS(GpuStoreBuffer *gs_buffer,
 			int		unitsz = TYPEALIGN(cmeta->attalign,
 									   cmeta->attlen);
 			size_t	extra_sz = va_length - MAXALIGN(unitsz * nitems);
+			bits8  *nullmap = gs_buffer->nullmap[j];
 
 			if (extra_sz > 0)
 			{
+				bits8  *s_nullmap = (bits8 *)
+					((char *)addr + MAXALIGN(unitsz * nitems));
+
 				Assert(extra_sz == MAXALIGN(BITMAPLEN(nitems)));
-				memcpy(gs_buffer->nullmap[j],
-					   (char *)addr + MAXALIGN(unitsz * nitems),
-					   BITMAPLEN(nitems));
+				if ((base_index & 7) == 0)
+					memcpy(nullmap + (base_index >> 3),
+						   s_nullmap, BITMAPLEN(nitems));
+				else
+				{
+					for (i=0; i < nitems; i++)
+					{
+						size_t	k = base_index + i;
+
+						if (att_isnull(i, s_nullmap))
+							nullmap[k >> 3] &= ~(1 << (k & 7));
+						else
+							nullmap[k >> 3] |=  (1 << (k & 7));
+					}
+				}
 				gs_buffer->hasnull[j] = true;
 			}
+			else if ((base_index & 7) == 0)
+				memset(nullmap + (base_index >> 3), ~0, BITMAPLEN(nitems));
 			else
 			{
-				memset(gs_buffer->nullmap[j], ~0, BITMAPLEN(nitems));
-				gs_buffer->hasnull[j] = false;
+				for (i=base_index; i < base_index + nitems; i++)
+					nullmap[i >> 3] |= (1 << (i & 7));
 			}
-			memcpy(gs_buffer->values[j], addr, unitsz * nitems);
+			memcpy((char *)gs_buffer->values[j] + unitsz * base_index,
+				   addr, unitsz * nitems);
 			Assert(gs_buffer->vl_dict[j] == NULL);
-			gs_buffer->extra_sz[j] = 0;
 		}
 	}
 	MemoryContextSwitchTo(oldcxt);
@@ -859,14 +1905,17 @@ GpuStoreBufferMakeReadOnly(GpuStoreBuffer *gs_buffer)
 	gs_buffer->vl_compress = NULL;
 	gs_buffer->extra_sz = NULL;
 	gs_buffer->gs_mvcc  = NULL;
+	gs_buffer->main_mvcc = NULL;
+	gs_buffer->vl_dict_index = NULL;
 
 	/* then, mark the buffer read-only with no dirty */
 	gs_buffer->read_only = true;
 	gs_buffer->is_dirty = false;
 	/* sanity checks */
-	Assert(gs_buffer->h_seg != NULL &&
-		   gs_buffer->rawsize <= dsm_segment_map_length(gs_buffer->h_seg) &&
-		   gs_buffer->h.buffer == dsm_segment_address(gs_buffer->h_seg));
+	Assert(gs_buffer->nshards > 0 &&
+		   gs_buffer->shards[0].h_seg != NULL &&
+		   gs_buffer->shards[0].kds ==
+		   dsm_segment_address(gs_buffer->shards[0].h_seg));
 }
 
 /*
@@ -933,74 +1982,164 @@ GpuStoreBufferAllocRW(GpuStoreBuffer *gs_buffer,
 	MemoryContextSwitchTo(oldcxt);
 }
 
+/*
+ * gstore_buf_delta_is_small
+ *
+ * It checks whether the delta image is small enough towards the main image,
+ * to keep the delta rather than full rewrite of the main image.
+ */
+static bool
+gstore_buf_delta_is_small(GpuStoreBuffer *gs_buffer, double factor)
+{
+	GpuStoreDeltaHead *delta = gs_buffer->delta;
+
+	if (gstore_delta_ratio <= 0.0 || gs_buffer->nshards == 0)
+		return false;
+	if (!delta)
+		return true;
+	return ((double)(delta->ndeleted + GSTORE_DELTA_KDS(delta)->nitems) <=
+			factor * gstore_delta_ratio * (double)gs_buffer->main_nitems);
+}
+
+/*
+ * gstore_buf_delta_is_deleted - true, if the row on the main image is
+ * already deleted on the delta image
+ */
+static bool
+gstore_buf_delta_is_deleted(GpuStoreDeltaHead *delta, cl_uint row_index)
+{
+	cl_uint		head = 0;
+	cl_uint		tail = delta->ndeleted;
+
+	while (head < tail)
+	{
+		cl_uint		curr = (head + tail) / 2;
+
+		if (delta->deleted[curr] == row_index)
+			return true;
+		if (delta->deleted[curr] < row_index)
+			head = curr + 1;
+		else
+			tail = curr;
+	}
+	return false;
+}
+
 /*
  * GpuStoreBufferMakeWritable
+ *
+ * If @allow_delta and the delta image is small enough, the read-write
+ * buffer is built on the delta mode; it keeps only the rows on the delta
+ * image, and the rows on the read-only main image are referenced as is.
+ * Elsewhere, the main and delta images are merged to the read-write buffer,
+ * then entire image shall be rewritten on commit.
  */
 static void
-GpuStoreBufferMakeWritable(GpuStoreBuffer *gs_buffer, TupleDesc tupdesc)
+GpuStoreBufferMakeWritable(GpuStoreBuffer *gs_buffer, TupleDesc tupdesc,
+						   bool allow_delta)
 {
-	size_t			nrooms;
+	kern_data_store *delta_kds = NULL;
+	size_t			main_nitems = 0;
+	size_t			delta_nitems = 0;
 	size_t			nitems;
 	size_t			i;
+	MVCCAttrs		all_visible;
 
 	/* already done? */
 	if (!gs_buffer->read_only)
 		return;
-	/* calculation of nrooms */
-	if (!gs_buffer->h_seg)
+	if (gs_buffer->nshards > 0)
 	{
-		Assert(!gs_buffer->h.buffer);
-		nitems = 0;
-		nrooms = 10000;
+		if (gs_buffer->format != GSTORE_FDW_FORMAT__PGSTROM)
+			elog(ERROR, "gstore_fdw: Bug? unknown buffer format: %d",
+				 gs_buffer->format);
+		main_nitems = gs_buffer->main_nitems;
+		if (gs_buffer->delta)
+		{
+			delta_kds = GSTORE_DELTA_KDS(gs_buffer->delta);
+			delta_nitems = delta_kds->nitems;
+		}
 	}
-	else if (gs_buffer->format == GSTORE_FDW_FORMAT__PGSTROM)
+	else
 	{
-		nitems = gs_buffer->h.kds->nitems;
-		nrooms = gs_buffer->h.kds->nitems + 10000;
+		Assert(!gs_buffer->delta);
 	}
-	else
-		elog(ERROR, "gstore_fdw: Bug? unknown buffer format: %d",
-			 gs_buffer->format);
-	/* allocation of read-write buffer */
-	GpuStoreBufferAllocRW(gs_buffer, tupdesc, nrooms);
-
-	/* extract the read-only buffer if any */
-	gs_buffer->nitems = nitems;
-	if (nitems > 0)
+	/* read-only tuples are all visible at first */
+	memset(&all_visible, 0, sizeof(MVCCAttrs));
+	all_visible.xmin = FrozenTransactionId;
+	all_visible.xmax = InvalidTransactionId;
+	all_visible.cid  = 0;
+	all_visible.xmin_committed = true;
+	all_visible.xmax_committed = false;
+
+	if (allow_delta && gstore_buf_delta_is_small(gs_buffer, 4.0))
 	{
-		MVCCAttrs		all_visible;
+		HASHCTL		hctl;
+
+		/* read-write buffer on the delta mode */
+		GpuStoreBufferAllocRW(gs_buffer, tupdesc, delta_nitems + 10000);
+		if (delta_kds)
+			GpuStoreBufferCopyFromKDS(gs_buffer, tupdesc, delta_kds, 0);
+		for (i=0; i < delta_nitems; i++)
+			gs_buffer->gs_mvcc[i] = all_visible;
+		gs_buffer->nitems = delta_nitems;
 
-		if (gs_buffer->format == GSTORE_FDW_FORMAT__PGSTROM)
+		memset(&hctl, 0, sizeof(HASHCTL));
+		hctl.keysize = sizeof(cl_uint);
+		hctl.entrysize = sizeof(GpuStoreMainMVCC);
+		hctl.hcxt = gs_buffer->memcxt;
+		gs_buffer->main_mvcc = hash_create("GpuStoreMainMVCC",
+										   1024,
+										   &hctl,
+										   HASH_ELEM |
+										   HASH_BLOBS |
+										   HASH_CONTEXT);
+		/* main image (and older delta) are still referenced */
+	}
+	else
+	{
+		/* allocation of read-write buffer */
+		nitems = main_nitems + delta_nitems;
+		GpuStoreBufferAllocRW(gs_buffer, tupdesc, nitems + 10000);
+		/* extract the shards of read-only buffer if any */
+		for (i=0; i < gs_buffer->nshards; i++)
 		{
-			GpuStoreBufferCopyFromKDS(gs_buffer, tupdesc,
-									  gs_buffer->h.kds);
+			GpuStoreLocalShard *lshard = &gs_buffer->shards[i];
+
+			GpuStoreBufferCopyFromKDS(gs_buffer, tupdesc, lshard->kds,
+									  lshard->base_index);
 		}
-		else
-			elog(ERROR, "gstore_fdw: Bug? unknown buffer format: %d",
-				 gs_buffer->format);
-		/* read-only tuples are all visible at first */
-		memset(&all_visible, 0, sizeof(MVCCAttrs));
-		all_visible.xmin = FrozenTransactionId;
-		all_visible.xmax = InvalidTransactionId;
-		all_visible.cid  = 0;
-		all_visible.xmin_committed = true;
-		all_visible.xmax_committed = false;
-
-		/* initial tuples are all visible */
+		if (delta_kds)
+			GpuStoreBufferCopyFromKDS(gs_buffer, tupdesc, delta_kds,
+									  main_nitems);
 		for (i=0; i < nitems; i++)
 			gs_buffer->gs_mvcc[i] = all_visible;
-	}
+		/* rows deleted on the delta image are never visible */
+		if (gs_buffer->delta)
+		{
+			GpuStoreDeltaHead *delta = gs_buffer->delta;
 
-	if (gs_buffer->h_seg)
-	{
-		Assert(gs_buffer->rawsize > 0 && gs_buffer->h.buffer != NULL);
-		dsm_detach(gs_buffer->h_seg);
+			for (i=0; i < delta->ndeleted; i++)
+			{
+				MVCCAttrs  *mvcc = &gs_buffer->gs_mvcc[delta->deleted[i]];
+
+				mvcc->xmin = InvalidTransactionId;
+				mvcc->xmin_committed = false;
+			}
+		}
+		gs_buffer->nitems = nitems;
 
-		gs_buffer->rawsize = 0;
-		gs_buffer->h_seg = NULL;
-		gs_buffer->h.buffer = NULL;
-		memset(&gs_buffer->ipc_mhandle, 0, sizeof(CUipcMemHandle));
+		if (gs_buffer->d_seg)
+		{
+			dsm_detach(gs_buffer->d_seg);
+			gs_buffer->d_seg = NULL;
+			gs_buffer->delta = NULL;
+			memset(&gs_buffer->delta_ipc_mhandle, 0, sizeof(CUipcMemHandle));
+		}
+		gstore_buf_detach_shards(gs_buffer);
 	}
+	/* dictionary index is valid only on the read-only buffer */
+	gs_buffer->vl_dict_index = NULL;
 	gs_buffer->read_only = false;
 }
 
@@ -1050,6 +2189,9 @@ GpuStoreBufferCreate(Relation frel, Snapshot snapshot)
 		 * image.
 		 */
 		MemoryContextDelete(gs_buffer->memcxt);
+		if (gs_buffer->d_seg)
+			dsm_detach(gs_buffer->d_seg);
+		gstore_buf_detach_shards(gs_buffer);
 		memset(gs_buffer, 0, sizeof(GpuStoreBuffer));
 		gs_buffer->table_oid = RelationGetRelid(frel);
 	}
@@ -1057,6 +2199,9 @@ GpuStoreBufferCreate(Relation frel, Snapshot snapshot)
 	{
 		gs_chunk = gstore_buf_lookup_chunk(RelationGetRelid(frel), snapshot);
 	}
+	/* restore the image from the snapshot file on the first load, if any */
+	if (!gs_chunk && gstore_buf_snapshot_restore(frel))
+		gs_chunk = gstore_buf_lookup_chunk(RelationGetRelid(frel), snapshot);
 
 	/*
 	 * Local buffer is not found, or invalid. So, re-initialize it again.
@@ -1080,10 +2225,16 @@ GpuStoreBufferCreate(Relation frel, Snapshot snapshot)
 			gs_buffer->is_dirty  = false;
 			gs_buffer->memcxt    = memcxt;
 			gs_buffer->rawsize   = 0;
-			gs_buffer->h_seg     = NULL;
-			gs_buffer->h.buffer  = NULL;
-			memset(&gs_buffer->ipc_mhandle, 0, sizeof(CUipcMemHandle));
-			GpuStoreBufferMakeWritable(gs_buffer, RelationGetDescr(frel));
+			gs_buffer->main_nitems = 0;
+			gs_buffer->nshards   = 0;
+			gs_buffer->image_ident = 0;
+			gs_buffer->d_seg     = NULL;
+			gs_buffer->delta     = NULL;
+			memset(&gs_buffer->delta_ipc_mhandle, 0, sizeof(CUipcMemHandle));
+			gs_buffer->main_mvcc = NULL;
+			gs_buffer->vl_dict_index = NULL;
+			GpuStoreBufferMakeWritable(gs_buffer, RelationGetDescr(frel),
+									   true);
 		}
 		else
 		{
@@ -1094,18 +2245,29 @@ GpuStoreBufferCreate(Relation frel, Snapshot snapshot)
 			gs_buffer->read_only = true;
 			gs_buffer->is_dirty  = false;
 			gs_buffer->memcxt    = memcxt;
-			gs_buffer->rawsize   = gs_chunk->rawsize;
-			gs_buffer->h_seg     = dsm_attach(gs_chunk->dsm_mhandle);
-			gs_buffer->h.buffer  = dsm_segment_address(gs_buffer->h_seg);
-			gs_buffer->ipc_mhandle = gs_chunk->ipc_mhandle;
-			/* DSM mapping will alive more than transaction duration */
-			dsm_pin_mapping(gs_buffer->h_seg);
+			gs_buffer->nshards   = 0;
+			gs_buffer->image_ident = gs_chunk->image_ident;
+			gs_buffer->d_seg     = NULL;
+			gs_buffer->delta     = NULL;
+			memset(&gs_buffer->delta_ipc_mhandle, 0, sizeof(CUipcMemHandle));
+			gs_buffer->main_mvcc = NULL;
+			gs_buffer->vl_dict_index = NULL;
+			gstore_buf_attach_shards(gs_buffer, gs_chunk->shards,
+									 gs_chunk->nshards);
+			if (gs_chunk->has_delta)
+			{
+				gs_buffer->d_seg = dsm_attach(gs_chunk->delta_dsm_mhandle);
+				gs_buffer->delta = dsm_segment_address(gs_buffer->d_seg);
+				gs_buffer->delta_ipc_mhandle = gs_chunk->delta_ipc_mhandle;
+				dsm_pin_mapping(gs_buffer->d_seg);
+			}
 		}
 	}
 	PG_CATCH();
 	{
 		if (gs_buffer)
 		{
+			gstore_buf_detach_shards(gs_buffer);
 			hash_search(gstore_buffer_htab,
 						&RelationGetRelid(frel),
 						HASH_REMOVE,
@@ -1122,22 +2284,28 @@ GpuStoreBufferCreate(Relation frel, Snapshot snapshot)
 }
 
 /*
- * GpuStoreBufferOpenDevPtr
+ * GpuStoreBufferOpenDevPtr - opens the device memory of the shard
  */
 CUdeviceptr
 GpuStoreBufferOpenDevPtr(GpuContext *gcontext,
-						 GpuStoreBuffer *gs_buffer)
+						 GpuStoreBuffer *gs_buffer,
+						 int shard_id)
 {
+	GpuStoreLocalShard *lshard;
 	CUdeviceptr	m_devptr;
 	CUresult	rc;
 
 	if (!gs_buffer->read_only)
 		elog(ERROR, "Gstore_Fdw has uncommitted changes");
-	Assert(gs_buffer->h_seg != NULL &&
-		   gs_buffer->h.buffer == dsm_segment_address(gs_buffer->h_seg));
+	if (shard_id < 0 || shard_id >= gs_buffer->nshards)
+		elog(ERROR, "Gstore_Fdw: shard %d is out of range", shard_id);
+	lshard = &gs_buffer->shards[shard_id];
+	if (lshard->shard.cuda_dindex != gcontext->cuda_dindex)
+		elog(ERROR, "Gstore_Fdw: shard %d is not on GPU%d",
+			 shard_id, gcontext->cuda_dindex);
 	rc = gpuIpcOpenMemHandle(gcontext,
 							 &m_devptr,
-							 gs_buffer->ipc_mhandle,
+							 lshard->shard.ipc_mhandle,
 							 CU_IPC_MEM_LAZY_ENABLE_PEER_ACCESS);
 	if (rc != CUDA_SUCCESS)
 		elog(ERROR, "failed on gpuIpcOpenMemHandle: %s",
@@ -1145,6 +2313,34 @@ GpuStoreBufferOpenDevPtr(GpuContext *gcontext,
 	return m_devptr;
 }
 
+/*
+ * GpuStoreBufferGetNShards
+ */
+int
+GpuStoreBufferGetNShards(GpuStoreBuffer *gs_buffer)
+{
+	return (gs_buffer->read_only ? gs_buffer->nshards : 0);
+}
+
+/*
+ * GpuStoreBufferGetShard - returns CUDA device index of the shard (-1 if
+ * host memory), and range of the row-index
+ */
+cl_int
+GpuStoreBufferGetShard(GpuStoreBuffer *gs_buffer, int shard_id,
+					   size_t *p_base_index, size_t *p_nitems)
+{
+	GpuStoreLocalShard *lshard;
+
+	Assert(shard_id >= 0 && shard_id < gs_buffer->nshards);
+	lshard = &gs_buffer->shards[shard_id];
+	if (p_base_index)
+		*p_base_index = lshard->base_index;
+	if (p_nitems)
+		*p_nitems = lshard->shard.nitems;
+	return lshard->shard.cuda_dindex;
+}
+
 /*
  * GpuStoreBufferExpand
  */
@@ -1189,6 +2385,9 @@ GpuStoreBufferExpand(GpuStoreBuffer *gs_buffer, TupleDesc tupdesc)
 
 /*
  * GpuStoreBufferGetTuple
+ *
+ * Rows on the main image come first, then rows on the delta image (or
+ * the read-write buffer) follow.
  */
 int
 GpuStoreBufferGetTuple(Relation frel,
@@ -1199,30 +2398,63 @@ GpuStoreBufferGetTuple(Relation frel,
 					   bool needs_system_columns)
 {
 	TupleDesc	tupdesc = RelationGetDescr(frel);
+	MVCCAttrs  *mvcc = NULL;
+	size_t		main_nitems = 0;
 
 	ExecClearTuple(slot);
-	if (gs_buffer->read_only)
+	if (gs_buffer->nshards > 0)
 	{
-		/* read from the read-only buffer */
-		if (gs_buffer->format == GSTORE_FDW_FORMAT__PGSTROM)
-		{
-			if (!KDS_fetch_tuple_column(slot,
-										gs_buffer->h.kds,
-										row_index))
-				return -1;
-		}
-		else
-		{
+		if (gs_buffer->format != GSTORE_FDW_FORMAT__PGSTROM)
 			elog(ERROR, "Gstore_Fdw: unexpected format: %d",
 				 gs_buffer->format);
+		main_nitems = gs_buffer->main_nitems;
+	}
+
+	if (row_index < main_nitems)
+	{
+		GpuStoreLocalShard *lshard;
+
+		/* read from the main image */
+		if (gs_buffer->delta &&
+			gstore_buf_delta_is_deleted(gs_buffer->delta, row_index))
+			return 1;		/* try next */
+		if (gs_buffer->main_mvcc)
+		{
+			GpuStoreMainMVCC *entry;
+			cl_uint		key = row_index;
+
+			entry = hash_search(gs_buffer->main_mvcc,
+								&key, HASH_FIND, NULL);
+			if (entry)
+			{
+				mvcc = &entry->mvcc;
+				if (!gstore_buf_tuple_visibility(mvcc, snapshot))
+					return 1;	/* try next */
+			}
 		}
+		lshard = gstore_buf_lookup_shard(gs_buffer, row_index);
+		if (!lshard ||
+			!KDS_fetch_tuple_column(slot,
+									lshard->kds,
+									row_index - lshard->base_index))
+			return -1;
+	}
+	else if (gs_buffer->read_only)
+	{
+		/* read from the delta image */
+		if (!gs_buffer->delta ||
+			!KDS_fetch_tuple_column(slot,
+									GSTORE_DELTA_KDS(gs_buffer->delta),
+									row_index - main_nitems))
+			return -1;
 	}
-	else if (row_index < gs_buffer->nitems)
+	else if (row_index - main_nitems < gs_buffer->nitems)
 	{
-		cl_int			j;
+		size_t		index = row_index - main_nitems;
+		cl_int		j;
 
-		if (!gstore_buf_tuple_visibility(&gs_buffer->gs_mvcc[row_index],
-										 snapshot))
+		mvcc = &gs_buffer->gs_mvcc[index];
+		if (!gstore_buf_tuple_visibility(mvcc, snapshot))
 			return 1;		/* try next */
 
 		/* OK, tuple is visible */
@@ -1232,37 +2464,47 @@ GpuStoreBufferGetTuple(Relation frel,
 			int			unitsz;
 			void	   *addr;
 
-			if (att_isnull(j, gs_buffer->nullmap[j]))
+			if (attr->attisdropped)
 			{
 				slot->tts_isnull[j] = true;
 				continue;
 			}
-			slot->tts_isnull[j] = false;
 			if (attr->attlen < 0)
 			{
 				vl_dict_key	*vkey
-					= ((vl_dict_key **)gs_buffer->values[j])[row_index];
-				slot->tts_values[j] = PointerGetDatum(vkey->vl_datum);
+					= ((vl_dict_key **)gs_buffer->values[j])[index];
+
+				if (!vkey)
+					slot->tts_isnull[j] = true;
+				else
+				{
+					slot->tts_isnull[j] = false;
+					slot->tts_values[j] = PointerGetDatum(vkey->vl_datum);
+				}
+				continue;
 			}
-			else
+			if (att_isnull(index, gs_buffer->nullmap[j]))
 			{
-				unitsz = att_align_nominal(attr->attlen,
-										   attr->attalign);
-				addr = (char *)gs_buffer->values[j] + unitsz * row_index;
-				if (!attr->attbyval)
-					slot->tts_values[j] = PointerGetDatum(addr);
-				else if (attr->attlen == sizeof(cl_char))
-					slot->tts_values[j] = CharGetDatum(*((cl_char *)addr));
-				else if (attr->attlen == sizeof(cl_short))
-					slot->tts_values[j] = Int16GetDatum(*((cl_short *)addr));
-				else if (attr->attlen == sizeof(cl_int))
-					slot->tts_values[j] = Int32GetDatum(*((cl_int *)addr));
-				else if (attr->attlen == sizeof(cl_long))
-					slot->tts_values[j] = Int64GetDatum(*((cl_long *)addr));
-				else
-					elog(ERROR, "gstore_buf: unexpected attlen: %d",
-						 attr->attlen);
+				slot->tts_isnull[j] = true;
+				continue;
 			}
+			slot->tts_isnull[j] = false;
+			unitsz = att_align_nominal(attr->attlen,
+									   attr->attalign);
+			addr = (char *)gs_buffer->values[j] + unitsz * index;
+			if (!attr->attbyval)
+				slot->tts_values[j] = PointerGetDatum(addr);
+			else if (attr->attlen == sizeof(cl_char))
+				slot->tts_values[j] = CharGetDatum(*((cl_char *)addr));
+			else if (attr->attlen == sizeof(cl_short))
+				slot->tts_values[j] = Int16GetDatum(*((cl_short *)addr));
+			else if (attr->attlen == sizeof(cl_int))
+				slot->tts_values[j] = Int32GetDatum(*((cl_int *)addr));
+			else if (attr->attlen == sizeof(cl_long))
+				slot->tts_values[j] = Int64GetDatum(*((cl_long *)addr));
+			else
+				elog(ERROR, "gstore_buf: unexpected attlen: %d",
+					 attr->attlen);
 		}
 		ExecStoreVirtualTuple(slot);
 	}
@@ -1278,7 +2520,7 @@ GpuStoreBufferGetTuple(Relation frel,
 		tup->t_self.ip_blkid.bi_lo = (row_index >> 16) & 0x0000ffff;
 		tup->t_self.ip_posid       = (row_index & 0x0000ffff);
 		tup->t_tableOid = RelationGetRelid(frel);
-		if (gs_buffer->read_only)
+		if (!mvcc)
 		{
 			tup->t_data->t_choice.t_heap.t_xmin = FrozenTransactionId;
 			tup->t_data->t_choice.t_heap.t_xmax = InvalidTransactionId;
@@ -1286,7 +2528,6 @@ GpuStoreBufferGetTuple(Relation frel,
 		}
 		else
 		{
-			MVCCAttrs  *mvcc = &gs_buffer->gs_mvcc[row_index];
 			tup->t_data->t_choice.t_heap.t_xmin = mvcc->xmin;
 			tup->t_data->t_choice.t_heap.t_xmax = mvcc->xmax;
 			tup->t_data->t_choice.t_heap.t_field3.t_cid = mvcc->cid;
@@ -1303,27 +2544,52 @@ GpuStoreBufferAppendRow(GpuStoreBuffer *gs_buffer,
 						TupleDesc tupdesc,
 						Snapshot snapshot,
 						TupleTableSlot *slot)
+{
+	slot_getallattrs(slot);
+	GpuStoreBufferAppendRows(gs_buffer, tupdesc, snapshot, 1,
+							 slot->tts_values,
+							 slot->tts_isnull);
+}
+
+/*
+ * GpuStoreBufferAppendRows
+ *
+ * It appends a batch of rows. @values and @isnull are arrays of
+ * (nrows * tupdesc->natts) items in row-major order, like tts_values and
+ * tts_isnull of TupleTableSlot. Rows are written out column by column,
+ * so the buffer expansion, dictionary lookups and MVCC setup are done
+ * once per batch rather than once per row.
+ */
+void
+GpuStoreBufferAppendRows(GpuStoreBuffer *gs_buffer,
+						 TupleDesc tupdesc,
+						 Snapshot snapshot,
+						 size_t nrows,
+						 Datum *values,
+						 bool *isnull)
 {
 	MemoryContext	oldcxt;
-	size_t			index = gs_buffer->nitems++;
-	cl_uint			j;
+	size_t			base_index;
+	size_t			i;
+	cl_uint			j, natts = tupdesc->natts;
+	TransactionId	curr_xid;
 	MVCCAttrs	   *mvcc;
 
+	if (nrows == 0)
+		return;
 	/* ensure the buffer is read-writable */
 	if (gs_buffer->read_only)
-		GpuStoreBufferMakeWritable(gs_buffer, tupdesc);
+		GpuStoreBufferMakeWritable(gs_buffer, tupdesc, true);
 	/* expand the buffer on demand */
-	while (index >= gs_buffer->nrooms)
+	base_index = gs_buffer->nitems;
+	while (base_index + nrows > gs_buffer->nrooms)
 		GpuStoreBufferExpand(gs_buffer, tupdesc);
 
-	/* write out the new tuple */
-	slot_getallattrs(slot);
+	/* write out the new tuples column by column */
 	oldcxt = MemoryContextSwitchTo(gs_buffer->memcxt);
-	for (j=0; j < tupdesc->natts; j++)
+	for (j=0; j < natts; j++)
 	{
 		Form_pg_attribute attr = tupleDescAttr(tupdesc, j);
-		bool	isnull = slot->tts_isnull[j];
-		Datum	datum  = slot->tts_values[j];
 
 		if (attr->attisdropped)
 			continue;
@@ -1331,86 +2597,107 @@ GpuStoreBufferAppendRow(GpuStoreBuffer *gs_buffer,
 		if (attr->attlen > 0)
 		{
 			bits8  *nullmap = gs_buffer->nullmap[j];
-			char   *base = gs_buffer->values[j];
+			int		unitsz = att_align_nominal(attr->attlen,
+											   attr->attalign);
+			char   *base = (char *)gs_buffer->values[j];
 
-			if (isnull)
-			{
-				gs_buffer->hasnull[j] = true;
-				nullmap[index >> 3] &= ~(1 << (index & 7));
-			}
-			else if (!attr->attbyval)
-			{
-				nullmap[index >> 3] |= (1 << (index & 7));
-				base += att_align_nominal(attr->attlen,
-										  attr->attalign) * index;
-				memcpy(base, DatumGetPointer(datum), attr->attlen);
-			}
-			else
+			for (i=0; i < nrows; i++)
 			{
-				nullmap[index >> 3] |= (1 << (index & 7));
-				base += att_align_nominal(attr->attlen,
-										  attr->attalign) * index;
-				memcpy(base, &datum, attr->attlen);
+				size_t	index = base_index + i;
+				Datum	datum = values[i * natts + j];
+
+				if (isnull[i * natts + j])
+				{
+					gs_buffer->hasnull[j] = true;
+					nullmap[index >> 3] &= ~(1 << (index & 7));
+				}
+				else if (!attr->attbyval)
+				{
+					nullmap[index >> 3] |= (1 << (index & 7));
+					memcpy(base + unitsz * index,
+						   DatumGetPointer(datum), attr->attlen);
+				}
+				else
+				{
+					nullmap[index >> 3] |= (1 << (index & 7));
+					memcpy(base + unitsz * index, &datum, attr->attlen);
+				}
 			}
 		}
 		else if (attr->attlen == -1)
 		{
-			vl_dict_key	   *entry = NULL;
 			vl_dict_key	  **vl_items =
 				(vl_dict_key **)gs_buffer->values[j];
 
-			if (!isnull)
+			for (i=0; i < nrows; i++)
 			{
-				struct varlena *vl = PG_DETOAST_DATUM_COPY(datum);
-				vl_dict_key key;
-				bool		found;
-				size_t		usage;
+				vl_dict_key	   *entry = NULL;
 
-				key.offset = 0;
-				key.usecnt = 0;
-				key.vl_datum = vl;
-				key.compressed = NULL;
-				entry = hash_search(gs_buffer->vl_dict[j],
-									&key,
-									HASH_ENTER,
-									&found);
-				if (!found)
+				if (!isnull[i * natts + j])
 				{
-					entry->offset = 0;
-					entry->usecnt = 0;
-					entry->vl_datum = vl;
-					entry->compressed = NULL;
-					gs_buffer->extra_sz[j] += MAXALIGN(VARSIZE_ANY(vl));
-					Assert(gs_buffer->memcxt == GetMemoryChunkContext(vl));
-
-					usage = (MAXALIGN(sizeof(cl_uint) * index) +
-							 gs_buffer->extra_sz[j]);
-					if (usage >= KDS_OFFSET_MAX_SIZE)
-						elog(ERROR, "attribute \"%s\" consumed too much",
-							 NameStr(attr->attname));
+					struct varlena *vl;
+					vl_dict_key key;
+					bool		found;
+					size_t		usage;
+
+					/*
+					 * NOTE: datum is copied to the buffer only when it is
+					 * a new entry of the dictionary. Duplicated values
+					 * consume no memory of the read-write buffer.
+					 */
+					vl = PG_DETOAST_DATUM(values[i * natts + j]);
+					key.offset = 0;
+					key.usecnt = 0;
+					key.vl_datum = vl;
+					key.compressed = NULL;
+					entry = hash_search(gs_buffer->vl_dict[j],
+										&key,
+										HASH_ENTER,
+										&found);
+					if (!found)
+					{
+						struct varlena *copy = palloc(VARSIZE(vl));
+
+						memcpy(copy, vl, VARSIZE(vl));
+						entry->offset = 0;
+						entry->usecnt = 0;
+						entry->vl_datum = copy;
+						entry->compressed = NULL;
+						gs_buffer->extra_sz[j] += MAXALIGN(VARSIZE(copy));
+
+						usage = (MAXALIGN(sizeof(cl_uint) * (base_index +
+															  nrows)) +
+								 gs_buffer->extra_sz[j]);
+						if (usage >= KDS_OFFSET_MAX_SIZE)
+							elog(ERROR, "attribute \"%s\" consumed too much",
+								 NameStr(attr->attname));
+					}
+					Assert(entry->vl_datum != NULL &&
+						   entry->compressed == NULL);
+					if (vl != DatumGetPointer(values[i * natts + j]))
+						pfree(vl);
 				}
-				Assert(entry->vl_datum != NULL &&
-					   entry->compressed == NULL);
+				vl_items[base_index + i] = entry;
 			}
-			vl_items[index] = entry;
 		}
 		else
 			elog(ERROR, "unexpected type length: %d", attr->attlen);
 	}
-	mvcc = &gs_buffer->gs_mvcc[index];
-	memset(mvcc, 0, sizeof(MVCCAttrs));
-	mvcc->xmin = GetCurrentTransactionId();
-    mvcc->xmax = InvalidTransactionId;
-    mvcc->cid  = snapshot->curcid;
+	curr_xid = GetCurrentTransactionId();
+	for (i=0; i < nrows; i++)
+	{
+		mvcc = &gs_buffer->gs_mvcc[base_index + i];
+		memset(mvcc, 0, sizeof(MVCCAttrs));
+		mvcc->xmin = curr_xid;
+		mvcc->xmax = InvalidTransactionId;
+		mvcc->cid  = snapshot->curcid;
+	}
+	gs_buffer->nitems += nrows;
 	/*
-	 * mark the buffer is dirty, and read-only buffer is not valid any more.
+	 * mark the buffer is dirty, and read-only buffer is not up-to-date
+	 * any more (main image is still valid on the delta mode).
 	 */
 	gs_buffer->is_dirty = true;
-	if (gs_buffer->h.buffer)
-	{
-		pfree(gs_buffer->h.buffer);
-		gs_buffer->h.buffer = NULL;
-	}
 	MemoryContextSwitchTo(oldcxt);
 }
 
@@ -1421,26 +2708,43 @@ GpuStoreBufferRemoveRow(GpuStoreBuffer *gs_buffer,
 						size_t old_index)
 {
 	MVCCAttrs  *mvcc;
+	size_t		main_nitems = 0;
 
 	if (gs_buffer->read_only)
-		GpuStoreBufferMakeWritable(gs_buffer, tupdesc);
+		GpuStoreBufferMakeWritable(gs_buffer, tupdesc, true);
+	if (gs_buffer->main_mvcc)
+		main_nitems = gs_buffer->main_nitems;
 	/* remove the old version */
-	if (old_index >= gs_buffer->nitems)
+	if (old_index < main_nitems)
+	{
+		GpuStoreMainMVCC *entry;
+		cl_uint		key = old_index;
+		bool		found;
+
+		/* row on the main image, on the delta mode */
+		entry = hash_search(gs_buffer->main_mvcc,
+							&key, HASH_ENTER, &found);
+		if (!found)
+		{
+			memset(&entry->mvcc, 0, sizeof(MVCCAttrs));
+			entry->mvcc.xmin = FrozenTransactionId;
+			entry->mvcc.xmin_committed = true;
+		}
+		mvcc = &entry->mvcc;
+	}
+	else if (old_index - main_nitems < gs_buffer->nitems)
+		mvcc = &gs_buffer->gs_mvcc[old_index - main_nitems];
+	else
 		elog(ERROR, "gstore_buf: UPDATE row out of range (%lu of %zu)",
-			 old_index, gs_buffer->nitems);
-	mvcc = &gs_buffer->gs_mvcc[old_index];
+			 old_index, main_nitems + gs_buffer->nitems);
 	mvcc->xmax = GetCurrentTransactionId();
 	mvcc->cid  = snapshot->curcid;
 
 	/*
-	 * mark the buffer is dirty, and read-only buffer is not valid any more.
+	 * mark the buffer is dirty, and read-only buffer is not up-to-date
+	 * any more.
 	 */
 	gs_buffer->is_dirty = true;
-	if (gs_buffer->h.buffer)
-	{
-		pfree(gs_buffer->h.buffer);
-		gs_buffer->h.buffer = NULL;
-	}
 }
 
 /*
@@ -1493,11 +2797,18 @@ GpuStoreBufferEstimateSize(Relation frel, GpuStoreBuffer *gs_buffer,
 					continue;
 				}
 
-				/* check unreferenced varlena-dictionary */
+				/*
+				 * check unreferenced varlena-dictionary; usecnt shall be
+				 * reset first, because it is estimated for each shard.
+				 */
 				if (rowmap)
 				{
 					vl_dict_key	  **vl_keys
 						= (vl_dict_key **)gs_buffer->values[j];
+
+					hash_seq_init(&seq, vl_dict);
+					while ((entry = hash_seq_search(&seq)) != NULL)
+						entry->usecnt = 0;
 					for (i=0; i < gs_buffer->nitems; i++)
 					{
 						if (att_isnull(i, rowmap))
@@ -1519,7 +2830,10 @@ GpuStoreBufferEstimateSize(Relation frel, GpuStoreBuffer *gs_buffer,
 					if (rowmap && entry->usecnt == 0)
 						continue;		/* unreferenced, skip */
 					vl_datum = entry->vl_datum;
-					compressed = vl_datum_compression(vl_datum, vl_compress);
+					compressed = entry->compressed;
+					if (!compressed)
+						compressed = vl_datum_compression(vl_datum,
+														  vl_compress);
 					if (!compressed)
 						extra_sz += MAXALIGN(VARSIZE_ANY(vl_datum));
 					else
@@ -1567,8 +2881,16 @@ GpuStoreBufferGetSize(Oid ftable_oid, Snapshot snapshot,
 				switch (gs_buffer->format)
 				{
 					case GSTORE_FDW_FORMAT__PGSTROM:
-						rawsize = gs_buffer->h.kds->length;
-						nitems  = gs_buffer->h.kds->nitems;
+						rawsize = gs_buffer->rawsize;
+						nitems  = gs_buffer->main_nitems;
+						if (gs_buffer->delta)
+						{
+							GpuStoreDeltaHead *delta = gs_buffer->delta;
+
+							rawsize += delta->length;
+							nitems  += (GSTORE_DELTA_KDS(delta)->nitems -
+										delta->ndeleted);
+						}
 						break;
 					default:
 						elog(ERROR, "Unknown Gstore_Fdw format: %d",
@@ -1615,6 +2937,12 @@ GpuStoreBufferGetSize(Oid ftable_oid, Snapshot snapshot,
 					}
 					ReleaseSysCache(tup);
 				}
+				/* main image on the delta mode */
+				if (gs_buffer->main_mvcc)
+				{
+					rawsize += gs_buffer->rawsize;
+					nitems  += gs_buffer->main_nitems;
+				}
 			}
 			goto out;
 		}
@@ -1634,33 +2962,543 @@ out:
 }
 
 /*
- * GpuStoreBufferGetNitems
+ * GpuStoreBufferGetNitems - number of the rows, including the rows on the
+ * delta image or the read-write buffer on the delta mode.
+ */
+size_t
+GpuStoreBufferGetNitems(GpuStoreBuffer *gs_buffer)
+{
+	size_t		nitems;
+
+	nitems = GpuStoreBufferGetMainNitems(gs_buffer);
+	if (gs_buffer->read_only)
+	{
+		if (gs_buffer->delta)
+			nitems += GSTORE_DELTA_KDS(gs_buffer->delta)->nitems;
+	}
+	else
+	{
+		nitems += gs_buffer->nitems;
+	}
+	return nitems;
+}
+
+/*
+ * GpuStoreBufferGetMainNitems - number of the rows on the main image.
+ * GPU kernel scans only the main image; rows on the delta image follow
+ * the main rows.
+ */
+size_t
+GpuStoreBufferGetMainNitems(GpuStoreBuffer *gs_buffer)
+{
+	if (gs_buffer->nshards == 0)
+	{
+		Assert(!gs_buffer->read_only);
+		return 0;
+	}
+	if (gs_buffer->format != GSTORE_FDW_FORMAT__PGSTROM)
+		elog(ERROR, "Gstore_Fdw has unknown format: %d",
+			 gs_buffer->format);
+	return gs_buffer->main_nitems;
+}
+
+/*
+ * gstore_buf_vl_dict_ordering - ordering operator that is used to sort
+ * the varlena dictionary on the read-only buffer, if any.
+ */
+Oid
+gstore_buf_vl_dict_ordering(Oid type_oid)
+{
+	Oid		vl_ltop;
+
+	if (get_typlen(type_oid) != -1)
+		return InvalidOid;
+	get_sort_group_operators(type_oid,
+							 false, false, false,
+							 &vl_ltop, NULL, NULL, NULL);
+	return vl_ltop;
+}
+
+/*
+ * GpuStoreBufferBuildDictIndex
+ *
+ * It walks on the extra area of the varlena column on the read-only KDS,
+ * then builds an index of the dictionary entries. Because
+ * vl_datum_writeout() writes out the entries in sorted order, the index
+ * is also sorted by the values.
+ */
+static GpuStoreDictIndex *
+GpuStoreBufferBuildDictIndex(GpuStoreBuffer *gs_buffer,
+							 Form_pg_attribute attr)
+{
+	kern_data_store *kds = gs_buffer->shards[0].kds;
+	kern_colmeta   *cmeta = &kds->colmeta[attr->attnum - 1];
+	GpuStoreDictIndex *dindex;
+	MemoryContext	oldcxt;
+	Oid				vl_ltop;
+	char		   *base;
+	char		   *pos;
+	char		   *end;
+	size_t			nrooms;
+
+	vl_ltop = gstore_buf_vl_dict_ordering(attr->atttypid);
+	if (!OidIsValid(vl_ltop))
+		elog(ERROR, "gstore_fdw: varlena dictionary of \"%s\" is not sorted",
+			 NameStr(attr->attname));
+
+	oldcxt = MemoryContextSwitchTo(gs_buffer->memcxt);
+	dindex = palloc0(sizeof(GpuStoreDictIndex));
+	dindex->ssup.ssup_cxt = gs_buffer->memcxt;
+	dindex->ssup.ssup_collation = attr->attcollation;
+	dindex->ssup.ssup_nulls_first = false;
+	PrepareSortSupportFromOrderingOp(vl_ltop, &dindex->ssup);
+
+	if (cmeta->va_offset != 0)
+	{
+		base = (char *)kds + __kds_unpack(cmeta->va_offset);
+		end  = base + __kds_unpack(cmeta->va_length);
+		pos  = base + MAXALIGN(sizeof(cl_uint) * kds->nitems);
+
+		nrooms = 1000;
+		dindex->codes  = palloc(sizeof(cl_uint) * nrooms);
+		dindex->values = palloc(sizeof(Datum) * nrooms);
+		while (pos < end)
+		{
+			struct varlena *vl = (struct varlena *)pos;
+
+			if (dindex->nitems >= nrooms)
+			{
+				nrooms *= 2;
+				dindex->codes = repalloc_huge(dindex->codes,
+											  sizeof(cl_uint) * nrooms);
+				dindex->values = repalloc_huge(dindex->values,
+											   sizeof(Datum) * nrooms);
+			}
+			dindex->codes[dindex->nitems] = __kds_packed(pos - base);
+			dindex->values[dindex->nitems] =
+				PointerGetDatum(PG_DETOAST_DATUM(PointerGetDatum(vl)));
+			dindex->nitems++;
+			pos += MAXALIGN(VARSIZE_ANY(vl));
+		}
+		Assert(pos == end);
+	}
+	MemoryContextSwitchTo(oldcxt);
+
+	return dindex;
+}
+
+/*
+ * GpuStoreBufferHasDictionary
+ *
+ * It returns true, if the column has sorted varlena dictionary on the
+ * read-only buffer, thus qualifiers can be evaluated by dictionary codes.
+ * Rows on the delta image and each shard have their own dictionary, so it
+ * is available only if no delta image and single shard.
+ */
+bool
+GpuStoreBufferHasDictionary(GpuStoreBuffer *gs_buffer, AttrNumber anum)
+{
+	kern_data_store *kds;
+
+	if (!gs_buffer->read_only ||
+		gs_buffer->nshards != 1 ||
+		gs_buffer->delta != NULL ||
+		gs_buffer->format != GSTORE_FDW_FORMAT__PGSTROM)
+		return false;
+	kds = gs_buffer->shards[0].kds;
+	if (anum < 1 || anum > kds->ncols)
+		return false;
+	if (kds->colmeta[anum-1].attlen != -1)
+		return false;
+	return OidIsValid(gstore_buf_vl_dict_ordering(kds->colmeta[anum-1].atttypid));
+}
+
+/*
+ * GpuStoreBufferLookupDictCode
+ *
+ * It returns the least dictionary code whose value is larger than or equal
+ * to (if @inclusive) or larger than (if !@inclusive) the supplied key.
+ * If no such entries, it returns UINT_MAX as a code beyond any entries.
+ */
+cl_uint
+GpuStoreBufferLookupDictCode(GpuStoreBuffer *gs_buffer,
+							 TupleDesc tupdesc,
+							 AttrNumber anum,
+							 Datum key,
+							 bool inclusive)
+{
+	GpuStoreDictIndex *dindex;
+	size_t		head;
+	size_t		tail;
+
+	Assert(GpuStoreBufferHasDictionary(gs_buffer, anum));
+	if (!gs_buffer->vl_dict_index)
+		gs_buffer->vl_dict_index =
+			MemoryContextAllocZero(gs_buffer->memcxt,
+								   sizeof(GpuStoreDictIndex *) *
+								   gs_buffer->shards[0].kds->ncols);
+	dindex = gs_buffer->vl_dict_index[anum-1];
+	if (!dindex)
+	{
+		dindex = GpuStoreBufferBuildDictIndex(gs_buffer,
+											  tupleDescAttr(tupdesc, anum-1));
+		gs_buffer->vl_dict_index[anum-1] = dindex;
+	}
+
+	/* binary search on the sorted dictionary */
+	head = 0;
+	tail = dindex->nitems;
+	while (head < tail)
+	{
+		size_t	curr = (head + tail) / 2;
+		int		comp = ApplySortComparator(dindex->values[curr], false,
+										   key, false,
+										   &dindex->ssup);
+		if (comp < 0 || (!inclusive && comp == 0))
+			head = curr + 1;
+		else
+			tail = curr;
+	}
+	if (head < dindex->nitems)
+		return dindex->codes[head];
+	return UINT_MAX;
+}
+
+/*
+ * GpuStoreBufferGetDictCode
+ *
+ * It returns dictionary code of the varlena column on the read-only buffer.
+ * 0 means NULL.
+ */
+cl_uint
+GpuStoreBufferGetDictCode(GpuStoreBuffer *gs_buffer,
+						  AttrNumber anum, size_t row_index)
+{
+	kern_data_store *kds = gs_buffer->shards[0].kds;
+	kern_colmeta   *cmeta;
+
+	Assert(GpuStoreBufferHasDictionary(gs_buffer, anum));
+	if (row_index >= kds->nitems)
+		return 0;
+	cmeta = &kds->colmeta[anum-1];
+	if (cmeta->va_offset == 0)
+		return 0;
+	return ((cl_uint *)((char *)kds +
+						__kds_unpack(cmeta->va_offset)))[row_index];
+}
+
+
+
+
+
+/*
+ * gstore_buf_delta_comp - comparison of row-index of the deleted rows
+ */
+static int
+gstore_buf_delta_comp(const void *__a, const void *__b)
+{
+	cl_uint		a = *((const cl_uint *)__a);
+	cl_uint		b = *((const cl_uint *)__b);
+
+	if (a < b)
+		return -1;
+	if (a > b)
+		return 1;
+	return 0;
+}
+
+/*
+ * gstore_buf_delta_deleted
+ *
+ * It returns sorted array of the rows on the main image deleted by the
+ * delta image, including the rows removed by the current transaction.
+ */
+static cl_uint *
+gstore_buf_delta_deleted(GpuStoreBuffer *gs_buffer, cl_uint *p_ndeleted)
+{
+	GpuStoreDeltaHead *delta = gs_buffer->delta;
+	GpuStoreMainMVCC *entry;
+	HASH_SEQ_STATUS	seq;
+	cl_uint	   *deleted;
+	cl_uint		ndeleted = 0;
+	size_t		nrooms;
+
+	Assert(gs_buffer->main_mvcc != NULL);
+	nrooms = (hash_get_num_entries(gs_buffer->main_mvcc) +
+			  (delta ? delta->ndeleted : 0));
+	deleted = palloc(sizeof(cl_uint) * Max(nrooms, 1));
+	if (delta)
+	{
+		memcpy(deleted, delta->deleted, sizeof(cl_uint) * delta->ndeleted);
+		ndeleted = delta->ndeleted;
+	}
+	hash_seq_init(&seq, gs_buffer->main_mvcc);
+	while ((entry = hash_seq_search(&seq)) != NULL)
+	{
+		/* see gstore_buf_visibility_bitmap */
+		if (TransactionIdIsCurrentTransactionId(entry->mvcc.xmax))
+			deleted[ndeleted++] = entry->row_index;
+	}
+	Assert(ndeleted <= nrooms);
+	qsort(deleted, ndeleted, sizeof(cl_uint), gstore_buf_delta_comp);
+
+	*p_ndeleted = ndeleted;
+	return deleted;
+}
+
+/*
+ * gstore_buf_compaction_pending - registers a table to be compacted by
+ * the background worker once the current transaction is committed
+ */
+static void
+gstore_buf_compaction_pending(Oid ftable_oid)
+{
+	MemoryContext	oldcxt;
+
+	oldcxt = MemoryContextSwitchTo(TopMemoryContext);
+	gstore_compaction_pending = list_append_unique_oid(gstore_compaction_pending,
+													   ftable_oid);
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * gstore_buf_compaction_atxact - launches the compaction workers
+ */
+static void
+gstore_buf_compaction_atxact(bool is_commit)
+{
+	ListCell   *lc;
+
+	foreach (lc, gstore_compaction_pending)
+	{
+		Oid			ftable_oid = lfirst_oid(lc);
+		BackgroundWorker worker;
+		BackgroundWorkerHandle *handle;
+
+		if (!is_commit)
+			continue;
+		memset(&worker, 0, sizeof(BackgroundWorker));
+		snprintf(worker.bgw_name, sizeof(worker.bgw_name),
+				 "PG-Strom Gstore Compaction (%u)", ftable_oid);
+		worker.bgw_flags = BGWORKER_SHMEM_ACCESS |
+			BGWORKER_BACKEND_DATABASE_CONNECTION;
+		worker.bgw_start_time = BgWorkerStart_RecoveryFinished;
+		worker.bgw_restart_time = BGW_NEVER_RESTART;
+		snprintf(worker.bgw_library_name, BGW_MAXLEN, "pg_strom");
+		snprintf(worker.bgw_function_name, BGW_MAXLEN,
+				 "gstoreCompactionMain");
+		worker.bgw_main_arg = ObjectIdGetDatum(MyDatabaseId);
+		memcpy(worker.bgw_extra, &ftable_oid, sizeof(Oid));
+
+		/* delta shall be merged by the next full rewrite, if no slot */
+		if (!RegisterDynamicBackgroundWorker(&worker, &handle))
+			elog(LOG, "gstore_fdw: unable to launch compaction worker for \"%s\"",
+				 get_rel_name(ftable_oid));
+	}
+	list_free(gstore_compaction_pending);
+	gstore_compaction_pending = NIL;
+}
+
+/*
+ * gstore_buf_commit_delta
+ *
+ * It writes out the delta image of the read-write buffer on the delta mode,
+ * then registers a new version of GpuStoreChunk that shares the main image
+ * with the older version.
+ */
+static void
+gstore_buf_commit_delta(GpuStoreBuffer *gs_buffer, Relation frel,
+						bits8 *rowmap, size_t nrooms,
+						cl_uint *deleted, cl_uint ndeleted)
+{
+	TupleDesc		tupdesc = RelationGetDescr(frel);
+	size_t			main_nitems = gs_buffer->main_nitems;
+	size_t			head_sz;
+	size_t			kds_sz;
+	CUresult		rc;
+	CUipcMemHandle	ipc_mhandle;
+	dsm_handle		dsm_mhandle;
+
+	head_sz = MAXALIGN(offsetof(GpuStoreDeltaHead, deleted[ndeleted]));
+	kds_sz = GpuStoreBufferEstimateSize(frel, gs_buffer, nrooms, rowmap);
+	rc = gpuMemAllocPreserved(gs_buffer->pinning,
+							  &ipc_mhandle,
+							  &dsm_mhandle,
+							  head_sz + kds_sz);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on gpuMemAllocPreserved: %s", errorText(rc));
+	PG_TRY();
+	{
+		dsm_segment	   *d_seg = dsm_attach(dsm_mhandle);
+		GpuStoreDeltaHead *delta = dsm_segment_address(d_seg);
+		kern_data_store *kds;
+
+		delta->length = head_sz + kds_sz;
+		delta->main_nitems = main_nitems;
+		delta->kds_offset = head_sz;
+		delta->ndeleted = ndeleted;
+		memcpy(delta->deleted, deleted, sizeof(cl_uint) * ndeleted);
+		kds = GSTORE_DELTA_KDS(delta);
+		GpuStoreBufferCopyToKDS(kds, gs_buffer, tupdesc, rowmap, nrooms);
+		Assert(kds->length == kds_sz);
+		gstore_buf_snapshot_write(gs_buffer, delta);
+		/*
+		 * NOTE: rows on the delta image are processed by CPU, so we don't
+		 * load the delta image to the device memory.
+		 */
+		if (gs_buffer->d_seg)
+			dsm_detach(gs_buffer->d_seg);
+		gs_buffer->d_seg = d_seg;
+		gs_buffer->delta = delta;
+		gs_buffer->delta_ipc_mhandle = ipc_mhandle;
+		/* mark the buffer read-only again */
+		GpuStoreBufferMakeReadOnly(gs_buffer);
+		/* keep DSM mapping */
+		dsm_pin_mapping(d_seg);
+		gstore_buf_insert_chunk(gs_buffer,
+								main_nitems - ndeleted + nrooms,
+								GetCurrentTransactionId());
+	}
+	PG_CATCH();
+	{
+		gpuMemFreePreserved(gs_buffer->pinning, ipc_mhandle);
+		gs_buffer->d_seg = NULL;
+		gs_buffer->delta = NULL;
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	/* merge the delta to the main image on the background, if large */
+	if (!gstore_buf_delta_is_small(gs_buffer, 1.0))
+		gstore_buf_compaction_pending(gs_buffer->table_oid);
+}
+
+/*
+ * gstore_buf_shard_rowmap
+ *
+ * It makes a visibility map of the rows on the read-write buffer, but only
+ * the visible rows whose ordinal number is in the range of [lo, hi).
+ */
+static bits8 *
+gstore_buf_shard_rowmap(GpuStoreBuffer *gs_buffer, bits8 *rowmap,
+						size_t lo, size_t hi)
+{
+	bits8	   *result = palloc0(BITMAPLEN(gs_buffer->nitems));
+	size_t		i, k = 0;
+
+	for (i=0; i < gs_buffer->nitems && k < hi; i++)
+	{
+		if (rowmap && att_isnull(i, rowmap))
+			continue;
+		if (k >= lo)
+			result[i >> 3] |= (1 << (i & 7));
+		k++;
+	}
+	return result;
+}
+
+/*
+ * gstore_buf_build_shards
+ *
+ * It builds the shards of the new main image from the visible rows on the
+ * read-write buffer, and loads them to the devices listed at 'pinning'
+ * option. Each shard has 'shard_nrows' rows in order of the row-index,
+ * except for the last one. If 'shard_nrows' is not set, rows are split
+ * evenly to one shard for each device.
  */
-size_t
-GpuStoreBufferGetNitems(GpuStoreBuffer *gs_buffer)
+static int
+gstore_buf_build_shards(GpuStoreBuffer *gs_buffer, Relation frel,
+						bits8 *rowmap, size_t nvisibles,
+						GpuStoreShard *shards)
 {
-	size_t		nitems;
-
-	if (gs_buffer->read_only)
+	TupleDesc		tupdesc = RelationGetDescr(frel);
+	List		   *devices;
+	size_t			shard_nrows;
+	volatile int	nshards = 0;
+	int				i, ndevs;
+
+	gstore_fdw_table_shard_options(RelationGetRelid(frel),
+								   &devices, &shard_nrows);
+	if (shard_nrows > 0)
 	{
-		Assert(gs_buffer->h_seg &&
-			   gs_buffer->h.buffer == dsm_segment_address(gs_buffer->h_seg));
-		if (gs_buffer->format == GSTORE_FDW_FORMAT__PGSTROM)
-			nitems = gs_buffer->h.kds->nitems;
-		else
-			elog(ERROR, "Gstore_Fdw has unknown format: %d",
-				 gs_buffer->format);
+		size_t		nrequired = (nvisibles + shard_nrows - 1) / shard_nrows;
+
+		if (nrequired > GSTORE_MAX_SHARDS)
+			ereport(ERROR,
+					(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+					 errmsg("gstore_fdw: \"%s\" needs %zu shards for %zu rows, but up to %d shards are supported",
+							RelationGetRelationName(frel),
+							nrequired, nvisibles, GSTORE_MAX_SHARDS),
+					 errhint("Set larger 'shard_nrows' option")));
+		ndevs = nrequired;
 	}
 	else
+		ndevs = Min(list_length(devices), nvisibles);
+	ndevs = Max(ndevs, 1);
+
+	PG_TRY();
 	{
-		nitems = gs_buffer->nitems;
+		for (i=0; i < ndevs; i++)
+		{
+			GpuStoreShard  *shard = &shards[i];
+			size_t			lo;
+			size_t			hi;
+			bits8		   *shard_map = rowmap;
+			dsm_segment	   *h_seg;
+			kern_data_store *kds;
+			size_t			rawsize;
+			cl_int			dindex;
+			CUresult		rc;
+
+			if (shard_nrows > 0)
+			{
+				lo = Min(shard_nrows * i, nvisibles);
+				hi = Min(shard_nrows * (i + 1), nvisibles);
+			}
+			else
+			{
+				lo = nvisibles * i / ndevs;
+				hi = nvisibles * (i + 1) / ndevs;
+			}
+			if (ndevs > 1)
+				shard_map = gstore_buf_shard_rowmap(gs_buffer, rowmap,
+													lo, hi);
+			rawsize = GpuStoreBufferEstimateSize(frel, gs_buffer,
+												 hi - lo, shard_map);
+			dindex = list_nth_int(devices, i % list_length(devices));
+			gstore_buf_alloc_shard(shard, frel, dindex, rawsize);
+			nshards++;
+
+			h_seg = dsm_attach(shard->dsm_mhandle);
+			kds = dsm_segment_address(h_seg);
+			GpuStoreBufferCopyToKDS(kds, gs_buffer, tupdesc,
+									shard_map, hi - lo);
+			Assert(kds->length == rawsize);
+			shard->nitems = kds->nitems;
+			dsm_detach(h_seg);
+			/* load the shard of read-only buffer to GPU device */
+			if (shard->cuda_dindex >= 0)
+			{
+				rc = gpuMemLoadPreserved(shard->cuda_dindex,
+										 shard->ipc_mhandle);
+				if (rc != CUDA_SUCCESS)
+					elog(ERROR, "failed on gpuMemLoadPreserved: %s",
+						 errorText(rc));
+			}
+			if (shard_map != rowmap)
+				pfree(shard_map);
+		}
 	}
-	return nitems;
-}
-
-
-
+	PG_CATCH();
+	{
+		gstore_buf_release_shards(shards, nshards);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+	list_free(devices);
 
+	return nshards;
+}
 
 /*
  * gstoreXactCallbackOnPreCommit
@@ -1678,18 +3516,25 @@ gstoreXactCallbackOnPreCommit(void)
 	while ((gs_buffer = hash_seq_search(&status)) != NULL)
 	{
 		Relation		frel;
-		size_t			rawsize;
 		bits8		   *rowmap;
 		size_t			nrooms = gs_buffer->nitems;
-		CUresult		rc;
-		CUipcMemHandle	ipc_mhandle;
-		dsm_handle		dsm_mhandle;
+		size_t			nvisibles;
+		cl_uint		   *deleted = NULL;
+		cl_uint			ndeleted = 0;
+		GpuStoreShard	shards[GSTORE_MAX_SHARDS];
+		int				nshards;
 
 		/* any writes happen? */
 		if (!gs_buffer->is_dirty)
 			continue;
 		/* check visibility for each rows (if any) */
 		rowmap = gstore_buf_visibility_bitmap(gs_buffer, &nrooms);
+		nvisibles = nrooms;
+		if (gs_buffer->main_mvcc)
+		{
+			deleted = gstore_buf_delta_deleted(gs_buffer, &ndeleted);
+			nvisibles += gs_buffer->main_nitems - ndeleted;
+		}
 
 		/*
 		 * once all the rows are removed from the gstore_fdw, we don't
@@ -1697,7 +3542,7 @@ gstoreXactCallbackOnPreCommit(void)
 		 * Older version will be removed when it becomes invisible from
 		 * all the transactions.
 		 */
-		if (nrooms == 0)
+		if (nvisibles == 0)
 		{
 			Oid			gstore_oid = gs_buffer->table_oid;
 			pg_crc32	hash = gstore_buf_chunk_hashvalue(gstore_oid);
@@ -1720,8 +3565,14 @@ gstoreXactCallbackOnPreCommit(void)
 			}
 			pg_atomic_add_fetch_u32(&gstore_head->has_warm_chunks, 1);
 			SpinLockRelease(&gstore_head->lock);
+			/* also remove the snapshot files on commit */
+			gstore_buf_snapshot_pending(gstore_oid, false, NULL);
+			gstore_buf_snapshot_pending(gstore_oid, true, NULL);
 			/* also remove the buffer */
 			MemoryContextDelete(gs_buffer->memcxt);
+			if (gs_buffer->d_seg)
+				dsm_detach(gs_buffer->d_seg);
+			gstore_buf_detach_shards(gs_buffer);
 			hash_search(gstore_buffer_htab,
 						&gstore_oid,
 						HASH_REMOVE,
@@ -1730,56 +3581,43 @@ gstoreXactCallbackOnPreCommit(void)
 			continue;
 		}
 
+		frel = heap_open(gs_buffer->table_oid, NoLock);
+		if (gs_buffer->main_mvcc)
+		{
+			/*
+			 * delta mode - construction of new version of the delta image
+			 * on top of the main image
+			 */
+			gstore_buf_commit_delta(gs_buffer, frel, rowmap, nrooms,
+									deleted, ndeleted);
+			heap_close(frel, NoLock);
+			continue;
+		}
+
 		/*
 		 * construction of new version of GPU device memory image
 		 */
-		frel = heap_open(gs_buffer->table_oid, NoLock);
-		rawsize = GpuStoreBufferEstimateSize(frel, gs_buffer, nrooms, rowmap);
-		rc = gpuMemAllocPreserved(gs_buffer->pinning,
-								  &ipc_mhandle,
-								  &dsm_mhandle,
-								  rawsize);
-		if (rc != CUDA_SUCCESS)
-			elog(ERROR, "failed on gpuMemAllocPreserved: %s", errorText(rc));
+		if (gs_buffer->format != GSTORE_FDW_FORMAT__PGSTROM)
+			elog(ERROR, "Gstore_Fdw: unknown format %d",
+				 gs_buffer->format);
+		nshards = gstore_buf_build_shards(gs_buffer, frel, rowmap,
+										  nrooms, shards);
 		PG_TRY();
 		{
-			dsm_segment	   *h_seg = dsm_attach(dsm_mhandle);
-
-			if (gs_buffer->format == GSTORE_FDW_FORMAT__PGSTROM)
-			{
-				kern_data_store	   *kds = dsm_segment_address(h_seg);
-
-				GpuStoreBufferCopyToKDS(kds, gs_buffer,
-										RelationGetDescr(frel),
-										rowmap, nrooms);
-				Assert(kds->length == rawsize);
-			}
-			else
-				elog(ERROR, "Gstore_Fdw: unknown format %d",
-					 gs_buffer->format);
-			/* load the read-only buffer to GPU device */
-			rc = gpuMemLoadPreserved(gs_buffer->pinning, ipc_mhandle);
-			if (rc != CUDA_SUCCESS)
-				elog(ERROR, "failed on gpuMemLoadPreserved: %s",
-					 errorText(rc));
-			/* register the new version of chunk */
-			gs_buffer->rawsize  = rawsize;
-			gs_buffer->h_seg    = h_seg;
-			gs_buffer->h.buffer = dsm_segment_address(h_seg);
-			gs_buffer->ipc_mhandle = ipc_mhandle;
+			/* identifier of the new main image */
+			gs_buffer->image_ident = (cl_ulong) GetCurrentTimestamp();
+			gstore_buf_attach_shards(gs_buffer, shards, nshards);
 			/* mark the buffer read-only again */
 			GpuStoreBufferMakeReadOnly(gs_buffer);
-			/* keep DSM mapping */
-			dsm_pin_mapping(h_seg);
-			gstore_buf_insert_chunk(gs_buffer, nrooms, ipc_mhandle,
-									dsm_segment_handle(h_seg));
+			gstore_buf_snapshot_write(gs_buffer, NULL);
+			/* register the new version of chunk */
+			gstore_buf_insert_chunk(gs_buffer, nrooms,
+									GetCurrentTransactionId());
 		}
 		PG_CATCH();
 		{
-			gpuMemFreePreserved(gs_buffer->pinning, ipc_mhandle);
-			gs_buffer->rawsize  = 0;
-			gs_buffer->h_seg    = NULL;
-			gs_buffer->h.buffer = NULL;
+			gstore_buf_detach_shards(gs_buffer);
+			gstore_buf_release_shards(shards, nshards);
 			PG_RE_THROW();
 		}
 		PG_END_TRY();
@@ -1803,8 +3641,9 @@ gstoreXactCallbackOnAbort(void)
 		while ((gs_buffer = hash_seq_search(&status)) != NULL)
 		{
 			MemoryContextDelete(gs_buffer->memcxt);
-			if (gs_buffer->h_seg)
-				dsm_detach(gs_buffer->h_seg);
+			if (gs_buffer->d_seg)
+				dsm_detach(gs_buffer->d_seg);
+			gstore_buf_detach_shards(gs_buffer);
 		}
 		hash_destroy(gstore_buffer_htab);
 		gstore_buffer_htab = NULL;
@@ -1892,10 +3731,14 @@ gstoreXactCallback(XactEvent event, void *arg)
 			gstoreXactCallbackOnPreCommit();
 			return;
 		case XACT_EVENT_COMMIT:
+			gstore_buf_snapshot_atxact(true);
+			gstore_buf_compaction_atxact(true);
 			is_commit = true;
 			break;
 		case XACT_EVENT_ABORT:
 			gstoreXactCallbackOnAbort();
+			gstore_buf_snapshot_atxact(false);
+			gstore_buf_compaction_atxact(false);
 			is_commit = false;
 			break;
 		default:
@@ -2012,6 +3855,9 @@ gstore_fdw_post_drop(Oid relid, AttrNumber attnum)
 	}
 	pg_atomic_add_fetch_u32(&gstore_head->has_warm_chunks, 1);
 	SpinLockRelease(&gstore_head->lock);
+	/* snapshot files shall be removed on commit */
+	gstore_buf_snapshot_pending(relid, false, NULL);
+	gstore_buf_snapshot_pending(relid, true, NULL);
 }
 
 /*
@@ -2077,6 +3923,228 @@ gstore_fdw_object_access(ObjectAccessType access,
 	}
 }
 
+/*
+ * gstoreSnapshotRestoreMain - restores a gstore_fdw table from the snapshot
+ * file. The launcher process kicks one worker per snapshot file.
+ */
+void
+gstoreSnapshotRestoreMain(Datum arg)
+{
+	Oid			database_oid = DatumGetObjectId(arg);
+	Oid			ftable_oid;
+
+	memcpy(&ftable_oid, MyBgworkerEntry->bgw_extra, sizeof(Oid));
+	BackgroundWorkerUnblockSignals();
+#if PG_VERSION_NUM < 110000
+	BackgroundWorkerInitializeConnectionByOid(database_oid, InvalidOid);
+#else
+	BackgroundWorkerInitializeConnectionByOid(database_oid, InvalidOid, 0);
+#endif
+	StartTransactionCommand();
+	PushActiveSnapshot(GetTransactionSnapshot());
+	if (!relation_is_gstore_fdw(ftable_oid))
+	{
+		char   *path = gstore_buf_snapshot_path(database_oid, ftable_oid,
+												false);
+		char   *dpath = gstore_buf_snapshot_path(database_oid, ftable_oid,
+												 true);
+
+		/* gstore_fdw table was dropped, so snapshot file is orphan */
+		if (unlink(path) != 0 && errno != ENOENT)
+			elog(LOG, "failed on unlink('%s'): %m", path);
+		else
+			elog(LOG, "gstore_fdw: orphan snapshot file '%s' removed", path);
+		if (unlink(dpath) != 0 && errno != ENOENT)
+			elog(LOG, "failed on unlink('%s'): %m", dpath);
+	}
+	else
+	{
+		Relation	frel = heap_open(ftable_oid, AccessShareLock);
+
+		(void) GpuStoreBufferCreate(frel, GetActiveSnapshot());
+		heap_close(frel, NoLock);
+	}
+	PopActiveSnapshot();
+	CommitTransactionCommand();
+
+	proc_exit(0);
+}
+
+/*
+ * gstoreSnapshotLauncherMain - launches the restore workers for each
+ * snapshot file in parallel.
+ */
+void
+gstoreSnapshotLauncherMain(Datum arg)
+{
+	DIR		   *dir;
+	struct dirent *dent;
+	List	   *handles = NIL;
+	ListCell   *lc;
+	int			nfiles = 0;
+	size_t		total_sz = 0;
+	struct timeval tv1, tv2;
+	double		elapsed;
+
+	BackgroundWorkerUnblockSignals();
+	gettimeofday(&tv1, NULL);
+
+	dir = AllocateDir(GSTORE_SNAPSHOT_DIR);
+	if (!dir)
+	{
+		if (errno != ENOENT)
+			elog(LOG, "failed on opendir('%s'): %m", GSTORE_SNAPSHOT_DIR);
+		proc_exit(0);
+	}
+
+	while ((dent = ReadDir(dir, GSTORE_SNAPSHOT_DIR)) != NULL)
+	{
+		BackgroundWorker worker;
+		BackgroundWorkerHandle *handle = NULL;
+		Oid			database_oid;
+		Oid			ftable_oid;
+		char		path[MAXPGPATH];
+		char		dummy;
+		struct stat	st_buf;
+
+		snprintf(path, sizeof(path), "%s/%s",
+				 GSTORE_SNAPSHOT_DIR, dent->d_name);
+		if (sscanf(dent->d_name, "%u_%u.kds%c",
+				   &database_oid, &ftable_oid, &dummy) != 2 ||
+			strstr(dent->d_name, ".delta") != NULL)
+		{
+			/*
+			 * temporary file by the crashed transaction; delta file is
+			 * restored together with the main snapshot file
+			 */
+			if ((strstr(dent->d_name, ".kds.tmp") != NULL ||
+				 strstr(dent->d_name, ".delta.tmp") != NULL) &&
+				unlink(path) != 0)
+				elog(LOG, "failed on unlink('%s'): %m", path);
+			continue;
+		}
+		if (stat(path, &st_buf) == 0)
+			total_sz += st_buf.st_size;
+
+		memset(&worker, 0, sizeof(BackgroundWorker));
+		snprintf(worker.bgw_name, sizeof(worker.bgw_name),
+				 "PG-Strom Gstore Snapshot Restore (%u)", ftable_oid);
+		worker.bgw_flags = BGWORKER_SHMEM_ACCESS |
+			BGWORKER_BACKEND_DATABASE_CONNECTION;
+		worker.bgw_start_time = BgWorkerStart_RecoveryFinished;
+		worker.bgw_restart_time = BGW_NEVER_RESTART;
+		snprintf(worker.bgw_library_name, BGW_MAXLEN, "pg_strom");
+		snprintf(worker.bgw_function_name, BGW_MAXLEN,
+				 "gstoreSnapshotRestoreMain");
+		worker.bgw_main_arg = ObjectIdGetDatum(database_oid);
+		memcpy(worker.bgw_extra, &ftable_oid, sizeof(Oid));
+		worker.bgw_notify_pid = MyProcPid;
+
+		while (!RegisterDynamicBackgroundWorker(&worker, &handle))
+		{
+			/* no free worker slot, so wait for the earlier one */
+			if (handles == NIL)
+			{
+				elog(LOG, "gstore_fdw: unable to launch restore worker for '%s', it shall be restored on demand", path);
+				handle = NULL;
+				break;
+			}
+			WaitForBackgroundWorkerShutdown(linitial(handles));
+			handles = list_delete_first(handles);
+		}
+		if (handle)
+			handles = lappend(handles, handle);
+		nfiles++;
+	}
+	FreeDir(dir);
+
+	foreach (lc, handles)
+		WaitForBackgroundWorkerShutdown(lfirst(lc));
+
+	gettimeofday(&tv2, NULL);
+	elapsed = ((double)(tv2.tv_sec - tv1.tv_sec) +
+			   (double)(tv2.tv_usec - tv1.tv_usec) / 1000000.0);
+	if (nfiles > 0)
+		elog(LOG, "gstore_fdw: %d snapshot files processed (%zu bytes in %.3fsec, %.2fMB/s)",
+			 nfiles, total_sz, elapsed,
+			 (double)total_sz / (1048576.0 * Max(elapsed, 0.000001)));
+	proc_exit(0);
+}
+
+/*
+ * gstore_buf_compaction
+ *
+ * It merges the delta image to the main image. The new version of the
+ * image shall be built on pre-commit of the current transaction.
+ * Caller must hold ShareUpdateExclusiveLock on the relation.
+ */
+static bool
+gstore_buf_compaction(Relation frel)
+{
+	GpuStoreBuffer *gs_buffer;
+	GpuStoreChunk  *gs_chunk;
+
+	gs_buffer = GpuStoreBufferCreate(frel, GetActiveSnapshot());
+	if (!gs_buffer->read_only || !gs_buffer->delta)
+		return false;
+	/* merge of older image overwrites the concurrent updates */
+	gs_chunk = gstore_buf_lookup_chunk(RelationGetRelid(frel),
+									   GetLatestSnapshot());
+	if (!gs_chunk || gs_chunk->revision != gs_buffer->revision)
+		ereport(ERROR,
+				(errcode(ERRCODE_T_R_SERIALIZATION_FAILURE),
+				 errmsg("could not serialize access due to concurrent update")));
+	GpuStoreBufferMakeWritable(gs_buffer, RelationGetDescr(frel), false);
+	gs_buffer->is_dirty = true;
+
+	return true;
+}
+
+/*
+ * gstoreCompactionMain - merges the delta image of gstore_fdw table to
+ * the main image on the background.
+ */
+void
+gstoreCompactionMain(Datum arg)
+{
+	Oid			database_oid = DatumGetObjectId(arg);
+	Oid			ftable_oid;
+	char		relname[NAMEDATALEN];
+	bool		compacted = false;
+	struct timeval tv1, tv2;
+
+	memcpy(&ftable_oid, MyBgworkerEntry->bgw_extra, sizeof(Oid));
+	BackgroundWorkerUnblockSignals();
+#if PG_VERSION_NUM < 110000
+	BackgroundWorkerInitializeConnectionByOid(database_oid, InvalidOid);
+#else
+	BackgroundWorkerInitializeConnectionByOid(database_oid, InvalidOid, 0);
+#endif
+	gettimeofday(&tv1, NULL);
+	StartTransactionCommand();
+	/* snapshot must be taken after the lock, to see the latest image */
+	LockRelationOid(ftable_oid, ShareUpdateExclusiveLock);
+	PushActiveSnapshot(GetTransactionSnapshot());
+	if (relation_is_gstore_fdw(ftable_oid))
+	{
+		Relation	frel = heap_open(ftable_oid, NoLock);
+
+		strlcpy(relname, RelationGetRelationName(frel), NAMEDATALEN);
+		compacted = gstore_buf_compaction(frel);
+		heap_close(frel, NoLock);
+	}
+	PopActiveSnapshot();
+	CommitTransactionCommand();
+	gettimeofday(&tv2, NULL);
+
+	if (compacted)
+		elog(LOG, "gstore_fdw: delta of \"%s\" merged to the main image in %.3fsec",
+			 relname,
+			 ((double)(tv2.tv_sec - tv1.tv_sec) +
+			  (double)(tv2.tv_usec - tv1.tv_usec) / 1000000.0));
+	proc_exit(0);
+}
+
 /*
  * pgstrom_startup_gstore_buf
  */
@@ -2127,6 +4195,24 @@ pgstrom_init_gstore_buf(void)
 							PGC_POSTMASTER,
 							GUC_NOT_IN_SAMPLE,
 							NULL, NULL, NULL);
+	DefineCustomBoolVariable("pg_strom.gstore_snapshot",
+							 "Enables snapshot files of gstore_fdw tables",
+							 NULL,
+							 &gstore_snapshot_enabled,
+							 false,
+							 PGC_SUSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	DefineCustomRealVariable("pg_strom.gstore_delta_ratio",
+							 "Ratio of the delta to be merged to the main image of gstore_fdw",
+							 NULL,
+							 &gstore_delta_ratio,
+							 0.05,
+							 0.0,
+							 1.0,
+							 PGC_SUSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 	required = offsetof(GpuStoreHead, gs_chunks[gstore_max_relations]);
 	RequestAddinShmemSpace(MAXALIGN(required));
 
@@ -2138,6 +4224,24 @@ pgstrom_init_gstore_buf(void)
 
 	RegisterXactCallback(gstoreXactCallback, NULL);
 	//RegisterSubXactCallback(gstoreSubXactCallback, NULL);
+
+	/* restore gstore_fdw tables from the snapshot files on startup */
+	if (gstore_snapshot_enabled)
+	{
+		BackgroundWorker worker;
+
+		memset(&worker, 0, sizeof(BackgroundWorker));
+		snprintf(worker.bgw_name, sizeof(worker.bgw_name),
+				 "PG-Strom Gstore Snapshot Launcher");
+		worker.bgw_flags = BGWORKER_SHMEM_ACCESS;
+		worker.bgw_start_time = BgWorkerStart_RecoveryFinished;
+		worker.bgw_restart_time = BGW_NEVER_RESTART;
+		snprintf(worker.bgw_library_name, BGW_MAXLEN, "pg_strom");
+		snprintf(worker.bgw_function_name, BGW_MAXLEN,
+				 "gstoreSnapshotLauncherMain");
+		worker.bgw_main_arg = 0;
+		RegisterBackgroundWorker(&worker);
+	}
 }
 
 /*
@@ -2340,6 +4444,123 @@ pgstrom_gstore_fdw_chunk_info(PG_FUNCTION_ARGS)
 }
 PG_FUNCTION_INFO_V1(pgstrom_gstore_fdw_chunk_info);
 
+/*
+ * pgstrom_gstore_fdw_shard_info
+ */
+typedef struct
+{
+	Oid				database_oid;
+	Oid				table_oid;
+	cl_uint			revision;
+	cl_int			shard_id;
+	GpuStoreShard	shard;
+} GpuStoreShardInfo;
+
+Datum
+pgstrom_gstore_fdw_shard_info(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *fncxt;
+	GpuStoreShardInfo *sinfo;
+	List	   *shards_list;
+	Datum		values[7];
+	bool		isnull[7];
+	HeapTuple	tuple;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc		tupdesc;
+		MemoryContext	oldcxt;
+
+		fncxt = SRF_FIRSTCALL_INIT();
+		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(7, false);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "database_oid",
+						   OIDOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "table_oid",
+						   REGCLASSOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "revision",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "shard_id",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "device",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "nitems",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 7, "rawsize",
+						   INT8OID, -1, 0);
+		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
+
+		shards_list = NIL;
+		SpinLockAcquire(&gstore_head->lock);
+		PG_TRY();
+		{
+			GpuStoreChunk  *gs_chunk;
+			dlist_iter	iter;
+			int			i, k;
+
+			for (i=0; i < GSTORE_CHUNK_HASH_NSLOTS; i++)
+			{
+				dlist_foreach(iter, &gstore_head->active_chunks[i])
+				{
+					gs_chunk = dlist_container(GpuStoreChunk, chain, iter.cur);
+					if (!superuser())
+					{
+						if (gs_chunk->database_oid != MyDatabaseId)
+							continue;
+						if (pg_class_aclcheck(gs_chunk->table_oid,
+											  GetUserId(),
+											  ACL_SELECT) != ACLCHECK_OK)
+							continue;
+					}
+					for (k=0; k < gs_chunk->nshards; k++)
+					{
+						sinfo = palloc(sizeof(GpuStoreShardInfo));
+						sinfo->database_oid = gs_chunk->database_oid;
+						sinfo->table_oid = gs_chunk->table_oid;
+						sinfo->revision = gs_chunk->revision;
+						sinfo->shard_id = k;
+						sinfo->shard = gs_chunk->shards[k];
+
+						shards_list = lappend(shards_list, sinfo);
+					}
+				}
+			}
+		}
+		PG_CATCH();
+		{
+			SpinLockRelease(&gstore_head->lock);
+			PG_RE_THROW();
+		}
+		PG_END_TRY();
+		SpinLockRelease(&gstore_head->lock);
+
+		fncxt->user_fctx = shards_list;
+		MemoryContextSwitchTo(oldcxt);
+	}
+	fncxt = SRF_PERCALL_SETUP();
+
+	shards_list = fncxt->user_fctx;
+	if (shards_list == NIL)
+		SRF_RETURN_DONE(fncxt);
+	sinfo = linitial(shards_list);
+	fncxt->user_fctx = list_delete_first(shards_list);
+
+	memset(isnull, 0, sizeof(isnull));
+	values[0] = ObjectIdGetDatum(sinfo->database_oid);
+	values[1] = ObjectIdGetDatum(sinfo->table_oid);
+	values[2] = Int32GetDatum(sinfo->revision);
+	values[3] = Int32GetDatum(sinfo->shard_id);
+	values[4] = Int32GetDatum(sinfo->shard.cuda_dindex);
+	values[5] = Int64GetDatum(sinfo->shard.nitems);
+	values[6] = Int64GetDatum(sinfo->shard.rawsize);
+
+	tuple = heap_form_tuple(fncxt->tuple_desc, values, isnull);
+
+	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
+}
+PG_FUNCTION_INFO_V1(pgstrom_gstore_fdw_shard_info);
+
 
 /*
  * pgstrom_gstore_export_ipchandle
@@ -2367,13 +4588,25 @@ __pgstrom_gstore_export_ipchandle(Oid ftable_oid)
 	gs_chunk = gstore_buf_lookup_chunk(ftable_oid, GetActiveSnapshot());
 	if (!gs_chunk)
 		return NULL;
+	if (gs_chunk->has_delta)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("gstore_fdw: \"%s\" has delta image not merged yet",
+						get_rel_name(ftable_oid)),
+				 errhint("Run gstore_fdw_compaction() prior to export")));
+	if (gs_chunk->nshards != 1 || gs_chunk->shards[0].cuda_dindex < 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("gstore_fdw: \"%s\" is not a single shard on GPU device",
+						get_rel_name(ftable_oid)),
+				 errhint("Only gstore_fdw pinned on a single GPU device can be exported")));
 
 	result = palloc0(sizeof(GstoreIpcHandle));
-	result->device_id = devAttrs[pinning].DEV_ID;
+	result->device_id = devAttrs[gs_chunk->shards[0].cuda_dindex].DEV_ID;
 	result->format = gs_chunk->format;
-	result->rawsize = gs_chunk->rawsize;
+	result->rawsize = gs_chunk->shards[0].rawsize;
 	memcpy(&result->ipc_mhandle.d,
-		   &gs_chunk->ipc_mhandle,
+		   &gs_chunk->shards[0].ipc_mhandle,
 		   sizeof(CUipcMemHandle));
 	SET_VARSIZE(result, sizeof(GstoreIpcHandle));
 
@@ -2391,3 +4624,116 @@ pgstrom_gstore_export_ipchandle(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(handle);
 }
 PG_FUNCTION_INFO_V1(pgstrom_gstore_export_ipchandle);
+
+/*
+ * pgstrom_gstore_fdw_compaction
+ */
+Datum
+pgstrom_gstore_fdw_compaction(PG_FUNCTION_ARGS)
+{
+	Oid			gstore_oid = PG_GETARG_OID(0);
+	Relation	frel;
+	bool		retval;
+
+	if (!relation_is_gstore_fdw(gstore_oid))
+		elog(ERROR, "relation %u is not gstore_fdw foreign table",
+			 gstore_oid);
+	strom_foreign_table_aclcheck(gstore_oid, GetUserId(), ACL_UPDATE);
+
+	frel = heap_open(gstore_oid, ShareUpdateExclusiveLock);
+	retval = gstore_buf_compaction(frel);
+	heap_close(frel, NoLock);
+
+	PG_RETURN_BOOL(retval);
+}
+PG_FUNCTION_INFO_V1(pgstrom_gstore_fdw_compaction);
+
+/*
+ * pgstrom_gstore_fdw_reload
+ *
+ * It discards the in-memory image of the gstore_fdw table, then restores
+ * the image from the snapshot file, as if it is the first load after the
+ * restart.
+ */
+Datum
+pgstrom_gstore_fdw_reload(PG_FUNCTION_ARGS)
+{
+	Oid			gstore_oid = PG_GETARG_OID(0);
+	Relation	frel;
+	GpuStoreBuffer *gs_buffer;
+	char	   *path;
+	pg_crc32	hash;
+	int			index;
+	dlist_mutable_iter iter;
+	bool		found;
+
+	if (!superuser())
+		ereport(ERROR,
+				(errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+				 errmsg("only superuser can reload gstore_fdw table")));
+	if (!relation_is_gstore_fdw(gstore_oid))
+		elog(ERROR, "relation %u is not gstore_fdw foreign table",
+			 gstore_oid);
+	if (!gstore_snapshot_enabled)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("gstore_fdw: snapshot is not enabled"),
+				 errhint("Set pg_strom.gstore_snapshot = on")));
+
+	/* nobody else can touch the table during the reload */
+	frel = heap_open(gstore_oid, AccessExclusiveLock);
+	path = gstore_buf_snapshot_path(MyDatabaseId, gstore_oid, false);
+	if (access(path, F_OK) != 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("gstore_fdw: \"%s\" has no snapshot file",
+						RelationGetRelationName(frel))));
+	pfree(path);
+
+	if (gstore_buffer_htab)
+	{
+		gs_buffer = hash_search(gstore_buffer_htab,
+								&gstore_oid,
+								HASH_FIND,
+								NULL);
+		if (gs_buffer)
+		{
+			if (gs_buffer->is_dirty)
+				ereport(ERROR,
+						(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+						 errmsg("gstore_fdw: \"%s\" is modified in the current transaction",
+								RelationGetRelationName(frel))));
+			MemoryContextDelete(gs_buffer->memcxt);
+			if (gs_buffer->d_seg)
+				dsm_detach(gs_buffer->d_seg);
+			gstore_buf_detach_shards(gs_buffer);
+			hash_search(gstore_buffer_htab,
+						&gstore_oid,
+						HASH_REMOVE,
+						&found);
+			Assert(found);
+		}
+	}
+
+	/* release all the versions of GpuStoreChunk */
+	hash = gstore_buf_chunk_hashvalue(gstore_oid);
+	index = hash % GSTORE_CHUNK_HASH_NSLOTS;
+	SpinLockAcquire(&gstore_head->lock);
+	dlist_foreach_modify(iter, &gstore_head->active_chunks[index])
+	{
+		GpuStoreChunk  *gs_temp = dlist_container(GpuStoreChunk,
+												  chain, iter.cur);
+		if (gs_temp->hash == hash &&
+			gs_temp->database_oid == MyDatabaseId &&
+			gs_temp->table_oid == gstore_oid)
+			gstore_buf_release_chunk(gs_temp);
+	}
+	SpinLockRelease(&gstore_head->lock);
+
+	/* restore the image from the snapshot file */
+	gs_buffer = GpuStoreBufferCreate(frel, GetActiveSnapshot());
+	heap_close(frel, NoLock);
+
+	PG_RETURN_BOOL(gs_buffer->revision != 0);
+}
+PG_FUNCTION_INFO_V1(pgstrom_gstore_fdw_reload);
@@ -25,6 +25,7 @@ typedef struct
 {
 	List	   *host_quals;
 	List	   *dev_quals;
+	List	   *dict_quals;		/* quals evaluated by dictionary codes */
 	size_t		raw_nrows;		/* # of rows kept in GpuStoreFdw */
 	size_t		dma_nrows;		/* # of rows to be backed from the device */
 	Bitmapset  *outer_refs;		/* attributes to be backed to host */
@@ -32,11 +33,13 @@ typedef struct
 	List	   *sort_order;		/* BTXXXXStrategyNumber */
 	List	   *sort_null_first;/* null-first? */
 	/* table options */
-	int			pinning;		/* GPU device number */
+	int			pinning;		/* primary GPU device number, or -1 */
 	int			format;			/* GSTORE_FDW_FORMAT__*  */
+	List	   *devices;		/* devices of the shards, -1 if host */
 	/* kernel code */
 	List	   *used_params;	/* list of referenced param-id */
 	char	   *kern_source;	/* source of the CUDA kernel */
+	char	   *kern_devfuncs;	/* device functions in use */
 	cl_uint		extra_flags;	/* extra libraries to be included */
 	cl_uint		varlena_bufsz;	/* nbytes of the expected result tuple size */
 	cl_uint		proj_tuple_sz;	/* expected average tuple size */
@@ -50,17 +53,115 @@ typedef struct
 	GpuStoreBuffer *gs_buffer;
 	cl_ulong		gs_index;
 	AttrNumber		ctid_anum;	/* only UPDATE or DELETE */
-	GpuContext	   *gcontext;
+	GpuContext	   *gcontext;	/* GPU context of the primary device */
 	ProgramId		program_id;
+	int				num_gcontexts;
+	GpuContext	  **gcontexts;	/* GPU context per device of the shards */
+	ProgramId	   *program_ids;
 	kern_parambuf  *kparams;
-	kern_gpusort   *kgpusort;
+	int				nshards;
+	struct GpuStoreScanShard *shards;	/* NULL, if not launched yet */
+	int				curr_shard;	/* current shard on unsorted scan */
 	bool			has_sortkeys;
+	/* qualifiers on the dictionary-encoded varlena columns */
+	List		   *dict_quals;		/* list of GpuStoreDictQual */
+#if PG_VERSION_NUM < 100000
+	List		   *dict_fallback;	/* quals by CPU, if no dictionary */
+#else
+	ExprState	   *dict_fallback;	/* quals by CPU, if no dictionary */
+#endif
+	bool			dict_resolved;	/* true, if dict_quals are resolved */
+	bool			dict_by_code;	/* true, if evaluated by codes */
+	/* rows on the host shards and delta image, not processed by GPU */
+#if PG_VERSION_NUM < 100000
+	List		   *dev_quals_host;	/* dev_quals to be run by CPU */
+#else
+	ExprState	   *dev_quals_host;	/* dev_quals to be run by CPU */
+#endif
+	int				host_shard;		/* current host shard, or nshards */
+	size_t			host_index;		/* next row on the host shard or delta */
+	/* merge of the sorted rows on the shards and delta image */
+	int				sort_nkeys;
+	AttrNumber	   *sort_anums;
+	SortSupport		sort_ssup;
+	TupleTableSlot *temp_slot;
+	struct GpuStoreDeltaRow **delta_rows;	/* sorted rows by CPU */
+	size_t			delta_nrows;
+	size_t			delta_index;
+	/* batched insertion (only INSERT or COPY FROM) */
+	MemoryContext	batch_memcxt;	/* NULL, if rows are appended one by one */
+	size_t			batch_nrows;
+	size_t			batch_usage;	/* bytes consumed by by-reference values */
+	Datum		   *batch_values;	/* GSTORE_INSERT_BATCH_NROWS x natts */
+	bool		   *batch_isnull;	/* GSTORE_INSERT_BATCH_NROWS x natts */
 } GpuStoreExecState;
 
+/*
+ * GpuStoreDeltaRow - a row and its sort keys, to merge the sorted rows
+ */
+typedef struct GpuStoreDeltaRow
+{
+	size_t		row_index;
+	bool	   *isnull;
+	Datum		values[FLEXIBLE_ARRAY_MEMBER];
+} GpuStoreDeltaRow;
+
+/*
+ * GpuStoreScanShard - state of the scan on a shard of the main image
+ */
+typedef struct GpuStoreScanShard
+{
+	size_t		base_index;		/* row-index of the first row */
+	size_t		nitems;
+	GpuContext *gcontext;		/* NULL, if rows are processed by CPU */
+	ProgramId	program_id;
+	kern_gpusort *kgpusort;
+	CUdeviceptr	m_kds_src;
+	size_t		index;			/* next position on the kresults */
+	GpuStoreDeltaRow *head;		/* next row in the sorted order, if any */
+	GpuStoreDeltaRow *head_buf;
+} GpuStoreScanShard;
+
+#define GSTORE_INSERT_BATCH_NROWS	10000
+#define GSTORE_INSERT_BATCH_USAGE	(64UL << 20)	/* 64MB */
+
+/*
+ * GpuStoreDictKey - a range of the key values on the dictionary-encoded
+ * varlena column. Equality, IN-list, range and LIKE-prefix qualifiers are
+ * transformed to the set of key ranges.
+ */
+typedef struct
+{
+	bool		has_lower;
+	bool		lower_inc;
+	Datum		lower;
+	bool		has_upper;
+	bool		upper_inc;
+	Datum		upper;
+} GpuStoreDictKey;
+
+/*
+ * GpuStoreDictQual - qualifier on the dictionary-encoded varlena column.
+ * Because varlena dictionary on the read-only buffer is sorted, key ranges
+ * are resolved to the ranges of dictionary codes once at the beginning of
+ * the scan, then evaluated by integer comparison for each row.
+ */
+typedef struct
+{
+	AttrNumber	anum;			/* attribute number of the column */
+	int			nkeys;			/* number of key ranges */
+	GpuStoreDictKey *keys;		/* array of key ranges */
+	int			ncodes;			/* number of the resolved code ranges */
+	cl_uint	   *codes;			/* pairs of [lower, upper) codes, sorted */
+} GpuStoreDictQual;
+
 /* ---- static variables ---- */
 static Oid		reggstore_type_oid = InvalidOid;
 static bool		enable_gpusort;			/* GUC */
 
+static void gstoreSetupInsertBatch(GpuStoreExecState *gstate,
+								   ResultRelInfo *rrinfo);
+
 Datum pgstrom_gstore_fdw_validator(PG_FUNCTION_ARGS);
 Datum pgstrom_gstore_fdw_handler(PG_FUNCTION_ARGS);
 Datum pgstrom_reggstore_in(PG_FUNCTION_ARGS);
@@ -79,6 +180,7 @@ form_gpustore_fdw_info(GpuStoreFdwInfo *gsf_info,
 
 	exprs = lappend(exprs, gsf_info->host_quals);
 	exprs = lappend(exprs, gsf_info->dev_quals);
+	exprs = lappend(exprs, gsf_info->dict_quals);
 	privs = lappend(privs, makeInteger(gsf_info->raw_nrows));
 	privs = lappend(privs, makeInteger(gsf_info->dma_nrows));
 	j = -1;
@@ -90,8 +192,10 @@ form_gpustore_fdw_info(GpuStoreFdwInfo *gsf_info,
 	privs = lappend(privs, gsf_info->sort_null_first);
 	privs = lappend(privs, makeInteger(gsf_info->pinning));
 	privs = lappend(privs, makeInteger(gsf_info->format));
+	privs = lappend(privs, gsf_info->devices);
 	exprs = lappend(exprs, gsf_info->used_params);
 	privs = lappend(privs, makeString(gsf_info->kern_source));
+	privs = lappend(privs, makeString(gsf_info->kern_devfuncs));
 	privs = lappend(privs, makeInteger(gsf_info->extra_flags));
 	privs = lappend(privs, makeInteger(gsf_info->varlena_bufsz));
 	privs = lappend(privs, makeInteger(gsf_info->proj_tuple_sz));
@@ -114,6 +218,7 @@ deform_gpustore_fdw_info(ForeignScan *fscan)
 
 	gsf_info->host_quals  = list_nth(exprs, eindex++);
 	gsf_info->dev_quals   = list_nth(exprs, eindex++);
+	gsf_info->dict_quals  = list_nth(exprs, eindex++);
 	gsf_info->raw_nrows   = intVal(list_nth(privs, pindex++));
 	gsf_info->dma_nrows   = intVal(list_nth(privs, pindex++));
 	temp = list_nth(privs, pindex++);
@@ -125,8 +230,10 @@ deform_gpustore_fdw_info(ForeignScan *fscan)
 	gsf_info->sort_null_first = list_nth(privs, pindex++);
 	gsf_info->pinning     = intVal(list_nth(privs, pindex++));
 	gsf_info->format      = intVal(list_nth(privs, pindex++));
+	gsf_info->devices     = list_nth(privs, pindex++);
 	gsf_info->used_params = list_nth(exprs, eindex++);
 	gsf_info->kern_source = strVal(list_nth(privs, pindex++));
+	gsf_info->kern_devfuncs = strVal(list_nth(privs, pindex++));
 	gsf_info->extra_flags = intVal(list_nth(privs, pindex++));
 	gsf_info->varlena_bufsz = intVal(list_nth(privs, pindex++));
 	gsf_info->proj_tuple_sz = intVal(list_nth(privs, pindex++));
@@ -134,6 +241,385 @@ deform_gpustore_fdw_info(ForeignScan *fscan)
 	return gsf_info;
 }
 
+/*
+ * gstore_dict_qual_keys_append
+ */
+static GpuStoreDictKey *
+gstore_dict_qual_keys_append(GpuStoreDictQual *dqual)
+{
+	GpuStoreDictKey *dkey;
+
+	if (!dqual->keys)
+		dqual->keys = palloc0(sizeof(GpuStoreDictKey));
+	else
+		dqual->keys = repalloc(dqual->keys, sizeof(GpuStoreDictKey) *
+							   (dqual->nkeys + 1));
+	dkey = &dqual->keys[dqual->nkeys++];
+	memset(dkey, 0, sizeof(GpuStoreDictKey));
+
+	return dkey;
+}
+
+/*
+ * gstore_dict_qual_like_prefix
+ *
+ * It checks whether the LIKE pattern is a simple prefix match, like
+ * 'abc%', then set up the key range. Prefix is meaningful as range of
+ * the sorted dictionary only if collation is "C".
+ */
+static bool
+gstore_dict_qual_like_prefix(Const *con, Oid collid, Oid ltop,
+							 GpuStoreDictQual *dqual)
+{
+	text	   *patt = DatumGetTextPP(con->constvalue);
+	char	   *str = VARDATA_ANY(patt);
+	int			len = VARSIZE_ANY_EXHDR(patt);
+	int			i;
+	bool		is_prefix = false;
+
+	if (!lc_collate_is_c(collid))
+		return false;
+	if (len > 0 && str[len-1] == '%')
+	{
+		is_prefix = true;
+		len--;
+	}
+	for (i=0; i < len; i++)
+	{
+		if (str[i] == '%' || str[i] == '_' || str[i] == '\\')
+			return false;
+	}
+
+	if (dqual)
+	{
+		GpuStoreDictKey *dkey = gstore_dict_qual_keys_append(dqual);
+		Const	   *prefix;
+
+		prefix = makeConst(TEXTOID, -1, collid, -1,
+						   PointerGetDatum(cstring_to_text_with_len(str, len)),
+						   false, false);
+		dkey->has_lower = true;
+		dkey->lower_inc = true;
+		dkey->lower = prefix->constvalue;
+		if (!is_prefix)
+		{
+			/* LIKE without wildcard is equivalent to equality */
+			dkey->has_upper = true;
+			dkey->upper_inc = true;
+			dkey->upper = prefix->constvalue;
+		}
+		else if (len > 0)
+		{
+			FmgrInfo	ltproc;
+			Const	   *greater;
+
+			fmgr_info(get_opcode(ltop), &ltproc);
+			greater = make_greater_string(prefix, &ltproc, collid);
+			if (greater)
+			{
+				dkey->has_upper = true;
+				dkey->upper_inc = false;
+				dkey->upper = greater->constvalue;
+			}
+		}
+	}
+	return true;
+}
+
+/*
+ * gstore_dict_qual_classify
+ *
+ * It checks whether the supplied qualifier can be evaluated by the codes
+ * of sorted varlena dictionary, and set up GpuStoreDictQual if @dqual is
+ * not NULL. Right now, the qualifiers below are supported:
+ *   - <column> {=|<|<=|>|>=} <const>
+ *   - <column> = ANY(<const array>)
+ *   - <column> LIKE '<prefix>%'  (only "C" collation)
+ */
+static bool
+gstore_dict_qual_classify(Expr *clause, Index scanrelid,
+						  GpuStoreDictQual *dqual)
+{
+	Expr	   *larg;
+	Expr	   *rarg;
+	Var		   *var;
+	Const	   *con;
+	Oid			opno;
+	Oid			inputcollid;
+	Oid			ltop;
+	Oid			opfamily;
+	Oid			opcintype;
+	Oid			lefttype;
+	Oid			righttype;
+	int16		ltop_strategy;
+	int			strategy;
+	bool		commuted = false;
+	bool		is_array = false;
+
+	if (IsA(clause, OpExpr))
+	{
+		OpExpr	   *op = (OpExpr *) clause;
+
+		if (list_length(op->args) != 2)
+			return false;
+		larg = linitial(op->args);
+		rarg = lsecond(op->args);
+		opno = op->opno;
+		inputcollid = op->inputcollid;
+	}
+	else if (IsA(clause, ScalarArrayOpExpr))
+	{
+		ScalarArrayOpExpr *saop = (ScalarArrayOpExpr *) clause;
+
+		if (!saop->useOr || list_length(saop->args) != 2)
+			return false;
+		larg = linitial(saop->args);
+		rarg = lsecond(saop->args);
+		opno = saop->opno;
+		inputcollid = saop->inputcollid;
+		is_array = true;
+	}
+	else
+		return false;
+
+	/* binary compatible relabeling, like varchar -> text, is harmless */
+	while (IsA(larg, RelabelType))
+		larg = ((RelabelType *) larg)->arg;
+	while (IsA(rarg, RelabelType))
+		rarg = ((RelabelType *) rarg)->arg;
+	if (IsA(larg, Var) && IsA(rarg, Const))
+	{
+		var = (Var *) larg;
+		con = (Const *) rarg;
+	}
+	else if (!is_array && IsA(larg, Const) && IsA(rarg, Var))
+	{
+		var = (Var *) rarg;
+		con = (Const *) larg;
+		commuted = true;
+	}
+	else
+		return false;
+
+	/* only varlena column with sorted dictionary */
+	if (var->varno != scanrelid ||
+		var->varattno <= 0 ||
+		var->varlevelsup != 0 ||
+		con->constisnull)
+		return false;
+	ltop = gstore_buf_vl_dict_ordering(var->vartype);
+	if (!OidIsValid(ltop))
+		return false;
+	/* dictionary is sorted according to the column's collation */
+	if (var->varcollid != inputcollid)
+		return false;
+	if (!get_ordering_op_properties(ltop, &opfamily, &opcintype,
+									&ltop_strategy))
+		return false;
+
+	/* LIKE-prefix */
+	if (!is_array && !commuted && get_opcode(opno) == F_TEXTLIKE)
+	{
+		if (opcintype != TEXTOID)
+			return false;
+		return gstore_dict_qual_like_prefix(con, inputcollid, ltop, dqual);
+	}
+
+	/* operators in the btree operator family of the dictionary */
+	if (!op_in_opfamily(opno, opfamily))
+		return false;
+	get_op_opfamily_properties(opno, opfamily, false,
+							   &strategy, &lefttype, &righttype);
+	if (lefttype != opcintype || righttype != opcintype)
+		return false;
+	if (commuted)
+	{
+		if (strategy == BTLessStrategyNumber)
+			strategy = BTGreaterStrategyNumber;
+		else if (strategy == BTLessEqualStrategyNumber)
+			strategy = BTGreaterEqualStrategyNumber;
+		else if (strategy == BTGreaterStrategyNumber)
+			strategy = BTLessStrategyNumber;
+		else if (strategy == BTGreaterEqualStrategyNumber)
+			strategy = BTLessEqualStrategyNumber;
+	}
+
+	if (is_array)
+	{
+		ArrayType  *array = DatumGetArrayTypeP(con->constvalue);
+		int16		elmlen;
+		bool		elmbyval;
+		char		elmalign;
+		Datum	   *elem_values;
+		bool	   *elem_nulls;
+		int			i, nelems;
+
+		if (strategy != BTEqualStrategyNumber)
+			return false;
+		if (dqual)
+		{
+			get_typlenbyvalalign(ARR_ELEMTYPE(array),
+								 &elmlen, &elmbyval, &elmalign);
+			deconstruct_array(array,
+							  ARR_ELEMTYPE(array),
+							  elmlen, elmbyval, elmalign,
+							  &elem_values, &elem_nulls, &nelems);
+			for (i=0; i < nelems; i++)
+			{
+				GpuStoreDictKey *dkey;
+
+				/* NULL never matches to any rows */
+				if (elem_nulls[i])
+					continue;
+				dkey = gstore_dict_qual_keys_append(dqual);
+				dkey->has_lower = true;
+				dkey->lower_inc = true;
+				dkey->lower = PointerGetDatum(PG_DETOAST_DATUM(elem_values[i]));
+				dkey->has_upper = true;
+				dkey->upper_inc = true;
+				dkey->upper = dkey->lower;
+			}
+		}
+	}
+	else if (dqual)
+	{
+		GpuStoreDictKey *dkey = gstore_dict_qual_keys_append(dqual);
+		Datum		key = PointerGetDatum(PG_DETOAST_DATUM(con->constvalue));
+
+		switch (strategy)
+		{
+			case BTLessStrategyNumber:
+			case BTLessEqualStrategyNumber:
+				dkey->has_upper = true;
+				dkey->upper_inc = (strategy == BTLessEqualStrategyNumber);
+				dkey->upper = key;
+				break;
+			case BTEqualStrategyNumber:
+				dkey->has_lower = dkey->has_upper = true;
+				dkey->lower_inc = dkey->upper_inc = true;
+				dkey->lower = dkey->upper = key;
+				break;
+			case BTGreaterEqualStrategyNumber:
+			case BTGreaterStrategyNumber:
+				dkey->has_lower = true;
+				dkey->lower_inc = (strategy == BTGreaterEqualStrategyNumber);
+				dkey->lower = key;
+				break;
+			default:
+				elog(ERROR, "unexpected btree strategy: %d", strategy);
+		}
+	}
+	else if (strategy < BTLessStrategyNumber ||
+			 strategy > BTGreaterStrategyNumber)
+		return false;
+
+	if (dqual)
+		dqual->anum = var->varattno;
+	return true;
+}
+
+/*
+ * gstore_dict_code_comp - qsort comparator of [lower,upper) code pairs
+ */
+static int
+gstore_dict_code_comp(const void *__a, const void *__b)
+{
+	const cl_uint  *a = __a;
+	const cl_uint  *b = __b;
+
+	if (a[0] < b[0])
+		return -1;
+	if (a[0] > b[0])
+		return 1;
+	return 0;
+}
+
+/*
+ * gstore_dict_qual_resolve
+ *
+ * It translates the key ranges to the ranges of dictionary codes on the
+ * current read-only buffer. Overlapped ranges are merged, so each code
+ * belongs to at most one range.
+ */
+static void
+gstore_dict_qual_resolve(GpuStoreDictQual *dqual,
+						 GpuStoreBuffer *gs_buffer,
+						 TupleDesc tupdesc)
+{
+	cl_uint	   *codes = palloc(sizeof(cl_uint) * 2 * Max(dqual->nkeys, 1));
+	int			i, ncodes = 0;
+
+	for (i=0; i < dqual->nkeys; i++)
+	{
+		GpuStoreDictKey *dkey = &dqual->keys[i];
+		cl_uint		lower = 1;			/* 0 means NULL */
+		cl_uint		upper = UINT_MAX;
+
+		if (dkey->has_lower)
+			lower = GpuStoreBufferLookupDictCode(gs_buffer, tupdesc,
+												 dqual->anum,
+												 dkey->lower,
+												 dkey->lower_inc);
+		if (dkey->has_upper)
+			upper = GpuStoreBufferLookupDictCode(gs_buffer, tupdesc,
+												 dqual->anum,
+												 dkey->upper,
+												 !dkey->upper_inc);
+		if (lower >= upper)
+			continue;	/* empty range */
+		codes[2 * ncodes]     = lower;
+		codes[2 * ncodes + 1] = upper;
+		ncodes++;
+	}
+	/* sort by lower code, then merge overlapped ranges */
+	if (ncodes > 1)
+	{
+		int		k = 0;
+
+		qsort(codes, ncodes, 2 * sizeof(cl_uint), gstore_dict_code_comp);
+		for (i=1; i < ncodes; i++)
+		{
+			if (codes[2 * i] <= codes[2 * k + 1])
+				codes[2 * k + 1] = Max(codes[2 * k + 1], codes[2 * i + 1]);
+			else
+			{
+				k++;
+				codes[2 * k]     = codes[2 * i];
+				codes[2 * k + 1] = codes[2 * i + 1];
+			}
+		}
+		ncodes = k + 1;
+	}
+	dqual->ncodes = ncodes;
+	dqual->codes = codes;
+}
+
+/*
+ * gstore_dict_qual_check - evaluation of the qualifier by dictionary code
+ */
+static inline bool
+gstore_dict_qual_check(GpuStoreDictQual *dqual, cl_uint code)
+{
+	int		head = 0;
+	int		tail = dqual->ncodes;
+
+	if (code == 0)
+		return false;	/* NULL never matches */
+	/* binary search of the last range whose lower <= code */
+	while (head < tail)
+	{
+		int		curr = (head + tail) / 2;
+
+		if (dqual->codes[2 * curr] <= code)
+			head = curr + 1;
+		else
+			tail = curr;
+	}
+	if (head == 0)
+		return false;
+	return (code < dqual->codes[2 * (head - 1) + 1]);
+}
+
 /*
  * gstoreGetForeignRelSize
  */
@@ -150,6 +636,7 @@ gstoreGetForeignRelSize(PlannerInfo *root,
 	List	   *tmp_quals;
 	List	   *dev_quals = NIL;
 	List	   *host_quals = NIL;
+	List	   *dict_quals = NIL;
 	Bitmapset  *compressed = NULL;
 	ListCell   *lc;
 	int			anum;
@@ -159,6 +646,7 @@ gstoreGetForeignRelSize(PlannerInfo *root,
 	gstore_fdw_table_options(ftable_oid,
 							 &gsf_info->pinning,
 							 &gsf_info->format);
+	gstore_fdw_table_shard_options(ftable_oid, &gsf_info->devices, NULL);
 	for (anum=1; anum <= baserel->max_attr; anum++)
 	{
 		int		comp;
@@ -174,7 +662,13 @@ gstoreGetForeignRelSize(PlannerInfo *root,
 		RestrictInfo   *rinfo = lfirst(lc);
 		Bitmapset	   *varattnos = NULL;
 
-		if (pgstrom_device_expression(root, rinfo->clause))
+		/*
+		 * Qualifiers on the sorted varlena dictionary are evaluated by
+		 * comparison of dictionary codes, regardless of compression.
+		 */
+		if (gstore_dict_qual_classify(rinfo->clause, baserel->relid, NULL))
+			dict_quals = lappend(dict_quals, rinfo);
+		else if (pgstrom_device_expression(root, rinfo->clause))
 		{
 			/*
 			 * MEMO: Right now, we don't allow to reference compressed
@@ -186,10 +680,10 @@ gstoreGetForeignRelSize(PlannerInfo *root,
 			if (!bms_overlap(varattnos, compressed))
 				dev_quals = lappend(dev_quals, rinfo);
 			else
-				host_quals = lappend(dev_quals, rinfo);
+				host_quals = lappend(host_quals, rinfo);
 		}
 		else
-			host_quals = lappend(dev_quals, rinfo);
+			host_quals = lappend(host_quals, rinfo);
 	}
 	/* estimate number of result rows */
 	snapshot = RegisterSnapshot(GetTransactionSnapshot());
@@ -205,7 +699,7 @@ gstoreGetForeignRelSize(PlannerInfo *root,
 	baserel->rows  = selectivity * (double)nitems;
 	baserel->pages = (rawsize + BLCKSZ - 1) / BLCKSZ;
 
-	if (host_quals == NIL)
+	if (host_quals == NIL && dict_quals == NIL)
 		gsf_info->dma_nrows = baserel->rows;
 	else if (dev_quals != NIL)
 	{
@@ -223,6 +717,7 @@ gstoreGetForeignRelSize(PlannerInfo *root,
 	gsf_info->raw_nrows  = nitems;
 	gsf_info->host_quals = extract_actual_clauses(host_quals, false);
 	gsf_info->dev_quals  = extract_actual_clauses(dev_quals, false);
+	gsf_info->dict_quals = extract_actual_clauses(dict_quals, false);
 
 	/* attributes to be referenced in the host code */
 	pull_varattnos((Node *)baserel->reltarget->exprs,
@@ -298,6 +793,11 @@ gstoreCreateForeignPath(PlannerInfo *root,
 				MAXALIGN(tup_size) * (size_t)dma_nrows);
 	run_cost += pgstrom_gpu_dma_cost *
 		((double)dma_size / (double)pgstrom_chunk_size());
+	/* Cost for dictionary code comparison, if any */
+	gsf_info = (GpuStoreFdwInfo *)baserel->fdw_private;
+	if (gsf_info->dict_quals)
+		run_cost += (cpu_operator_cost *
+					 list_length(gsf_info->dict_quals) * dma_nrows);
 	/* Cost for CPU qualifiers, if any */
 	if (host_quals)
 	{
@@ -442,15 +942,20 @@ gstoreGetForeignPaths(PlannerInfo *root,
 					   &outer_refs_nodev);
 	}
 
-	/* no device qual execution, no device side sorting */
-	any_quals = extract_actual_clauses(baserel->baserestrictinfo, false);
+	/*
+	 * no device qual execution, no device side sorting
+	 * (dict_quals are always evaluated by dictionary codes)
+	 */
+	any_quals = list_concat(list_copy(gsf_info->host_quals),
+							gsf_info->dev_quals);
 	gstoreCreateForeignPath(root, baserel, foreigntableid,
 							outer_refs_nodev,
 							any_quals, NIL,
 							gsf_info->raw_nrows,
 							gsf_info->raw_nrows,
 							NIL);
-	if (!pgstrom_enabled)
+	/* no GPU device paths, if all the shards are on the host memory */
+	if (!pgstrom_enabled || gsf_info->pinning < 0)
 		return;
 
 	/* device qual execution, but no device side sorting */
@@ -706,8 +1211,10 @@ gstoreGetForeignPlan(PlannerInfo *root,
 	GpuStoreFdwInfo *gsf_info = linitial(best_path->fdw_private);
 	codegen_context context;
 	StringInfoData	kern;
+	StringInfoData	devfuncs;
 	List		   *fdw_exprs;
 	List		   *fdw_privs;
+	List		   *recheck_quals;
 
 	/* kernel code generation */
 	initStringInfo(&kern);
@@ -716,21 +1223,26 @@ gstoreGetForeignPlan(PlannerInfo *root,
 							 gsf_info->dev_quals);
 	gstore_codegen_keycomp(&kern, &context, baserel,
 						   ftable_oid, gsf_info);
+	initStringInfo(&devfuncs);
+	pgstrom_codegen_devfunc_needs(&devfuncs, &context);
 
 	/* update GpuStoreFdwInfo */
 	gsf_info->used_params = context.used_params;
 	gsf_info->extra_flags = DEVKERNEL_NEEDS_GPUSORT | context.extra_flags;
 	gsf_info->kern_source = kern.data;
+	gsf_info->kern_devfuncs = devfuncs.data;
 	gsf_info->varlena_bufsz = context.varlena_bufsz;
 
 	form_gpustore_fdw_info(gsf_info, &fdw_exprs, &fdw_privs);
+	recheck_quals = list_concat(list_copy(gsf_info->dev_quals),
+								gsf_info->dict_quals);
 	return make_foreignscan(tlist,					/* plan.targetlist */
 							gsf_info->host_quals,	/* plan.qual */
 							baserel->relid,			/* scanrelid */
 							fdw_exprs,				/* fdw_exprs */
 							fdw_privs,				/* fdw_private */
 							NIL,					/* fdw_scan_tlist */
-							gsf_info->dev_quals,	/* fdw_recheck_quals */
+							recheck_quals,			/* fdw_recheck_quals */
 							NULL);					/* outer_plan */
 }
 
@@ -782,26 +1294,53 @@ gstoreBeginForeignScan(ForeignScanState *node, int eflags)
 	bool			has_sortkeys = false;
 
 	gstate = palloc0(sizeof(GpuStoreExecState));
-	if (gsf_info->dev_quals != NIL ||
-		gsf_info->sort_keys != NIL)
+	if ((gsf_info->dev_quals != NIL ||
+		 gsf_info->sort_keys != NIL) && gsf_info->pinning >= 0)
 	{
 		StringInfoData kern_define;
 		bool		explain_only
 			= ((eflags & EXEC_FLAG_EXPLAIN_ONLY) != 0);
+		ListCell   *lc;
+		int			k;
 
 		initStringInfo(&kern_define);
 		pgstrom_build_session_info(&kern_define,
 								   NULL,
 								   gsf_info->extra_flags);
-		gcontext = AllocGpuContext(gsf_info->pinning,
-								   false, false, false);
-		program_id = pgstrom_create_cuda_program(gcontext,
-												 gsf_info->extra_flags,
-												 gsf_info->varlena_bufsz,
-												 gsf_info->kern_source,
-												 kern_define.data,
-												 false,
-												 explain_only);
+		appendStringInfoString(&kern_define, gsf_info->kern_devfuncs);
+		/* GPU context and program for each device of the shards */
+		gstate->gcontexts = palloc0(sizeof(GpuContext *) *
+									list_length(gsf_info->devices));
+		gstate->program_ids = palloc0(sizeof(ProgramId) *
+									  list_length(gsf_info->devices));
+		foreach (lc, gsf_info->devices)
+		{
+			int		dindex = lfirst_int(lc);
+
+			if (dindex < 0)
+				continue;	/* host memory */
+			for (k=0; k < gstate->num_gcontexts; k++)
+			{
+				if (gstate->gcontexts[k]->cuda_dindex == dindex)
+					break;
+			}
+			if (k < gstate->num_gcontexts)
+				continue;	/* already allocated */
+			gcontext = AllocGpuContext(dindex, false, false, false);
+			program_id = pgstrom_create_cuda_program(gcontext,
+													 gsf_info->extra_flags,
+													 gsf_info->varlena_bufsz,
+													 gsf_info->kern_source,
+													 kern_define.data,
+													 false,
+													 explain_only);
+			gstate->gcontexts[k] = gcontext;
+			gstate->program_ids[k] = program_id;
+			gstate->num_gcontexts++;
+		}
+		Assert(gstate->num_gcontexts > 0);
+		gcontext = gstate->gcontexts[0];
+		program_id = gstate->program_ids[0];
 		kparams = construct_kern_parambuf(gsf_info->used_params,
 										  node->ss.ps.ps_ExprContext,
 										  NIL);
@@ -815,29 +1354,98 @@ gstoreBeginForeignScan(ForeignScanState *node, int eflags)
 	gstate->kparams    = kparams;
 	gstate->has_sortkeys = has_sortkeys;
 
+	/* rows on the host shards and delta image are evaluated by CPU */
+	if (gcontext && gsf_info->dev_quals != NIL)
+	{
+#if PG_VERSION_NUM < 100000
+		gstate->dev_quals_host = (List *)
+			ExecInitExpr((Expr *)gsf_info->dev_quals, &node->ss.ps);
+#else
+		gstate->dev_quals_host = ExecInitQual(gsf_info->dev_quals,
+											  &node->ss.ps);
+#endif
+	}
+	/* sort keys to merge the rows on the shards and delta image */
+	if (has_sortkeys)
+	{
+		Relation	frel = node->ss.ss_currentRelation;
+		ListCell   *lc1, *lc2, *lc3;
+		int			k = 0;
+
+		gstate->sort_nkeys = list_length(gsf_info->sort_keys);
+		gstate->sort_anums = palloc0(sizeof(AttrNumber) *
+									 gstate->sort_nkeys);
+		gstate->sort_ssup = palloc0(sizeof(SortSupportData) *
+									gstate->sort_nkeys);
+		forthree (lc1, gsf_info->sort_keys,
+				  lc2, gsf_info->sort_order,
+				  lc3, gsf_info->sort_null_first)
+		{
+			Var		   *var = lfirst(lc1);
+			int			order = lfirst_int(lc2);
+			SortSupport	ssup = &gstate->sort_ssup[k];
+			Oid			ltop;
+			Oid			gtop;
+
+			get_sort_group_operators(var->vartype,
+									 true, false, true,
+									 &ltop, NULL, &gtop, NULL);
+			ssup->ssup_cxt = CurrentMemoryContext;
+			ssup->ssup_collation = var->varcollid;
+			ssup->ssup_nulls_first = (bool)lfirst_int(lc3);
+			ssup->ssup_attno = var->varattno;
+			PrepareSortSupportFromOrderingOp(order == BTLessStrategyNumber
+											 ? ltop : gtop, ssup);
+			gstate->sort_anums[k++] = var->varattno;
+		}
+		gstate->temp_slot = MakeSingleTupleTableSlot(RelationGetDescr(frel));
+	}
+
+	/* qualifiers to be evaluated by dictionary codes */
+	if (gsf_info->dict_quals != NIL)
+	{
+		ListCell   *lc;
+
+		foreach (lc, gsf_info->dict_quals)
+		{
+			GpuStoreDictQual *dqual = palloc0(sizeof(GpuStoreDictQual));
+
+			if (!gstore_dict_qual_classify(lfirst(lc),
+										   fscan->scan.scanrelid,
+										   dqual))
+				elog(ERROR, "Bug? unexpected dictionary qualifier: %s",
+					 nodeToString(lfirst(lc)));
+			gstate->dict_quals = lappend(gstate->dict_quals, dqual);
+		}
+		/* in case when read-write buffer has no sorted dictionary */
+#if PG_VERSION_NUM < 100000
+		gstate->dict_fallback = (List *)
+			ExecInitExpr((Expr *)gsf_info->dict_quals, &node->ss.ps);
+#else
+		gstate->dict_fallback = ExecInitQual(gsf_info->dict_quals,
+											 &node->ss.ps);
+#endif
+	}
+
 	node->fdw_state = (void *) gstate;
 }
 
 /*
- * gstoreLaunchScanSortKernel
+ * gstoreLaunchScanKernel - kicks the kernel to setup kern_gpusort
+ * asynchronously, so the shards on multiple devices are processed
+ * concurrently.
  */
 static void
-gstoreLaunchScanSortKernel(GpuContext *gcontext,
-						   CUmodule cuda_module,
-						   CUdeviceptr m_gpusort,
-						   CUdeviceptr m_kds_src,
-						   bool run_gpusort)
+gstoreLaunchScanKernel(GpuContext *gcontext,
+					   CUmodule cuda_module,
+					   CUdeviceptr m_gpusort,
+					   CUdeviceptr m_kds_src)
 {
-	kern_gpusort   *kgpusort = (kern_gpusort *) m_gpusort;
 	CUfunction		kern_gpusort_setup;
-	CUfunction		kern_gpusort_local;
-	CUfunction		kern_gpusort_step;
-	CUfunction		kern_gpusort_merge;
 	CUresult		rc;
-	cl_uint			nitems;
 	cl_int			grid_sz;
 	cl_int			block_sz;
-	void		   *kern_args[4];
+	void		   *kern_args[2];
 
 	rc = cuModuleGetFunction(&kern_gpusort_setup,
 							 cuda_module,
@@ -845,27 +1453,6 @@ gstoreLaunchScanSortKernel(GpuContext *gcontext,
 	if (rc != CUDA_SUCCESS)
 		elog(ERROR, "failed on cuModuleGetFunction: %s", errorText(rc));
 
-	if (run_gpusort)
-	{
-		rc = cuModuleGetFunction(&kern_gpusort_local,
-								 cuda_module,
-								 "gpusort_bitonic_local");
-		if (rc != CUDA_SUCCESS)
-			elog(ERROR, "failed on cuModuleGetFunction: %s", errorText(rc));
-
-		rc = cuModuleGetFunction(&kern_gpusort_step,
-								 cuda_module,
-								 "gpusort_bitonic_step");
-		if (rc != CUDA_SUCCESS)
-			elog(ERROR, "failed on cuModuleGetFunction: %s", errorText(rc));
-
-		rc = cuModuleGetFunction(&kern_gpusort_merge,
-								 cuda_module,
-								 "gpusort_bitonic_merge");
-		if (rc != CUDA_SUCCESS)
-			elog(ERROR, "failed on cuModuleGetFunction: %s", errorText(rc));
-	}
-
 	/*
 	 * KERNEL_FUNCTION(void)
 	 * gpusort_setup_column(kern_gpusort *kgpusort,
@@ -890,86 +1477,108 @@ gstoreLaunchScanSortKernel(GpuContext *gcontext,
 						NULL);
 	if (rc != CUDA_SUCCESS)
 		elog(ERROR, "failed on cuLaunchKernel: %s", errorText(rc));
+}
+
+/*
+ * gstoreLaunchSortKernel - waits for the setup kernel, then sorts the
+ * results on the device if needed.
+ */
+static void
+gstoreLaunchSortKernel(GpuContext *gcontext,
+					   CUmodule cuda_module,
+					   CUdeviceptr m_gpusort,
+					   CUdeviceptr m_kds_src,
+					   bool run_gpusort)
+{
+	kern_gpusort   *kgpusort = (kern_gpusort *) m_gpusort;
+	gpusortResultIndex *kresults;
+	CUfunction		kern_gpusort_local;
+	CUfunction		kern_gpusort_step;
+	CUfunction		kern_gpusort_merge;
+	CUresult		rc;
+	cl_uint			nitems;
+	cl_uint			nhalf;
+	cl_uint			i, j;
+	cl_int			grid_sz;
+	cl_int			block_sz;
+	void		   *kern_args[4];
 
-	if (run_gpusort)
+	rc = cuStreamSynchronize(NULL);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuStreamSynchronize: %s", errorText(rc));
+	if (kgpusort->kerror.errcode != StromError_Success)
 	{
-		gpusortResultIndex *kresults;
-		cl_uint		nhalf;
-		cl_uint		i, j;
+		/* TODO: CPU fallback handling */
+		elog(ERROR, "GPU kernel error - %s",
+			 errorTextKernel(&kgpusort->kerror));
+	}
+	if (!run_gpusort)
+		return;
 
-		rc = cuStreamSynchronize(NULL);
-		if (rc != CUDA_SUCCESS)
-			elog(ERROR, "failed on cuStreamSynchronize: %s", errorText(rc));
-		if (kgpusort->kerror.errcode != StromError_Success)
-		{
-			/* TODO: CPU fallback handling */
-			elog(ERROR, "GPU kernel error - %s",
-				 errorTextKernel(&kgpusort->kerror));
-		}
-		kresults = KERN_GPUSORT_RESULT_INDEX(kgpusort);
-		nitems = kresults->nitems;
-		/* nhalf is the least power of two larger than the nitems */
-		nhalf = 1UL << (get_next_log2(nitems + 1) - 1);
+	rc = cuModuleGetFunction(&kern_gpusort_local,
+							 cuda_module,
+							 "gpusort_bitonic_local");
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuModuleGetFunction: %s", errorText(rc));
 
-		block_sz = MAXTHREADS_PER_BLOCK;
-		grid_sz = Max(nhalf / MAXTHREADS_PER_BLOCK, 1);
+	rc = cuModuleGetFunction(&kern_gpusort_step,
+							 cuda_module,
+							 "gpusort_bitonic_step");
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuModuleGetFunction: %s", errorText(rc));
 
-		/*
-		 * make a sorting block up to (2 * BITONIC_MAX_LOCAL_SZ)
-		 *
-		 * KERNEL_FUNCTION_MAXTHREADS(void)
-		 * gpusort_bitonic_local(kern_gpusort *kgpusort,
-		 *                       kern_data_store *kds_src)
-		 */
-		kern_args[0] = &m_gpusort;
-		kern_args[1] = &m_kds_src;
-		rc = cuLaunchKernel(kern_gpusort_local,
-							grid_sz, 1, 1,
-							block_sz, 1, 1,
-							0,
-							CU_STREAM_PER_THREAD,
-							kern_args,
-							NULL);
-		if (rc != CUDA_SUCCESS)
-			elog(ERROR, "failed on cuLaunchKernel: %s", errorText(rc));
-		/* inter blocks bitonic sorting */
-		for (i = BITONIC_MAX_LOCAL_SZ; i < nhalf; i *= 2)
-		{
-			for (j = 2 * i; j > BITONIC_MAX_LOCAL_SZ; j /= 2)
-			{
-				cl_uint		unitsz = 2 * j;
-				cl_bool		reversing = ((j == 2 * i) ? true : false);
+	rc = cuModuleGetFunction(&kern_gpusort_merge,
+							 cuda_module,
+							 "gpusort_bitonic_merge");
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuModuleGetFunction: %s", errorText(rc));
 
-				/*
-				 * KERNEL_FUNCTION_MAXTHREADS(void)
-				 * gpustore_bitonic_step(kern_gpusort *kgpusort,
-				 *                       kern_data_store *kds_src,
-				 *                       cl_uint unitsz,
-				 *                       cl_bool reversing)
-				 */
-				kern_args[0] = &m_gpusort;
-				kern_args[1] = &m_kds_src;
-				kern_args[2] = &unitsz;
-				kern_args[3] = &reversing;
-				rc = cuLaunchKernel(kern_gpusort_step,
-									grid_sz, 1, 1,
-									block_sz, 1, 1,
-									0,
-									CU_STREAM_PER_THREAD,
-									kern_args,
-									NULL);
-				if (rc != CUDA_SUCCESS)
-					elog(ERROR, "failed on cuLaunchKernel: %s", errorText(rc));
-			}
+	kresults = KERN_GPUSORT_RESULT_INDEX(kgpusort);
+	nitems = kresults->nitems;
+	/* nhalf is the least power of two larger than the nitems */
+	nhalf = 1UL << (get_next_log2(nitems + 1) - 1);
+
+	block_sz = MAXTHREADS_PER_BLOCK;
+	grid_sz = Max(nhalf / MAXTHREADS_PER_BLOCK, 1);
+
+	/*
+	 * make a sorting block up to (2 * BITONIC_MAX_LOCAL_SZ)
+	 *
+	 * KERNEL_FUNCTION_MAXTHREADS(void)
+	 * gpusort_bitonic_local(kern_gpusort *kgpusort,
+	 *                       kern_data_store *kds_src)
+	 */
+	kern_args[0] = &m_gpusort;
+	kern_args[1] = &m_kds_src;
+	rc = cuLaunchKernel(kern_gpusort_local,
+						grid_sz, 1, 1,
+						block_sz, 1, 1,
+						0,
+						CU_STREAM_PER_THREAD,
+						kern_args,
+						NULL);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuLaunchKernel: %s", errorText(rc));
+	/* inter blocks bitonic sorting */
+	for (i = BITONIC_MAX_LOCAL_SZ; i < nhalf; i *= 2)
+	{
+		for (j = 2 * i; j > BITONIC_MAX_LOCAL_SZ; j /= 2)
+		{
+			cl_uint		unitsz = 2 * j;
+			cl_bool		reversing = ((j == 2 * i) ? true : false);
 
 			/*
 			 * KERNEL_FUNCTION_MAXTHREADS(void)
-			 * gpusort_bitonic_merge(kern_gpusort *kgpusort,
-			 *                       kern_data_store *kds_src)
+			 * gpustore_bitonic_step(kern_gpusort *kgpusort,
+			 *                       kern_data_store *kds_src,
+			 *                       cl_uint unitsz,
+			 *                       cl_bool reversing)
 			 */
 			kern_args[0] = &m_gpusort;
 			kern_args[1] = &m_kds_src;
-			rc = cuLaunchKernel(kern_gpusort_merge,
+			kern_args[2] = &unitsz;
+			kern_args[3] = &reversing;
+			rc = cuLaunchKernel(kern_gpusort_step,
 								grid_sz, 1, 1,
 								block_sz, 1, 1,
 								0,
@@ -979,70 +1588,407 @@ gstoreLaunchScanSortKernel(GpuContext *gcontext,
 			if (rc != CUDA_SUCCESS)
 				elog(ERROR, "failed on cuLaunchKernel: %s", errorText(rc));
 		}
-	}
-
-	rc = cuStreamSynchronize(NULL);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on cuStreamSynchronize: %s", errorText(rc));
-}
 
-/*
- * gstoreProcessScanSortKernel
- */
-static void
+		/*
+		 * KERNEL_FUNCTION_MAXTHREADS(void)
+		 * gpusort_bitonic_merge(kern_gpusort *kgpusort,
+		 *                       kern_data_store *kds_src)
+		 */
+		kern_args[0] = &m_gpusort;
+		kern_args[1] = &m_kds_src;
+		rc = cuLaunchKernel(kern_gpusort_merge,
+							grid_sz, 1, 1,
+							block_sz, 1, 1,
+							0,
+							CU_STREAM_PER_THREAD,
+							kern_args,
+							NULL);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuLaunchKernel: %s", errorText(rc));
+	}
+
+	rc = cuStreamSynchronize(NULL);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuStreamSynchronize: %s", errorText(rc));
+}
+
+/*
+ * gstoreProcessScanSortKernel
+ *
+ * It kicks the GPU kernel for each shard on the GPU devices. Kernels are
+ * launched asynchronously first, then synchronized, so shards on the
+ * multiple devices are processed concurrently. Shards on the host memory
+ * are processed by CPU.
+ */
+static void
 gstoreProcessScanSortKernel(GpuStoreExecState *gstate)
 {
-	GpuContext	   *gcontext = gstate->gcontext;
 	GpuStoreBuffer *gs_buffer = gstate->gs_buffer;
 	kern_parambuf  *kparams = gstate->kparams;
+	GpuStoreScanShard *sshard;
+	GpuContext	   *gcontext;
 	size_t			length;
-	size_t			nitems;
 	CUdeviceptr		m_gpusort;
-	CUdeviceptr		m_kds_src;
 	CUmodule		cuda_module;
 	CUresult		rc;
-	
-	ActivateGpuContextNoWorkers(gcontext);
-	/*
-	 * setup kern_gpusort (including gpusortResultIndex)
-	 */
-	nitems = GpuStoreBufferGetNitems(gs_buffer);
-	length = (STROMALIGN(offsetof(kern_gpusort, kparams)) +
-			  STROMALIGN(kparams->length) +
-			  STROMALIGN(offsetof(gpusortResultIndex, results)));
-	rc = gpuMemAllocManaged(gcontext,
-							&m_gpusort,
-							STROMALIGN(length + sizeof(cl_uint) * nitems),
-							CU_MEM_ATTACH_GLOBAL);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on gpuMemAllocManaged: %s", errorText(rc));
-	memset((void *)m_gpusort, 0, length);
-	memcpy(KERN_GPUSORT_PARAMBUF(m_gpusort),
-		   kparams,
-		   kparams->length);
-	gstate->kgpusort = (kern_gpusort *) m_gpusort;
-	gstate->kgpusort->nitems_in = nitems;
+	int				i, k, nshards;
 
-	/*
-	 * map device memory
-	 */
-	m_kds_src = GpuStoreBufferOpenDevPtr(gcontext, gs_buffer);
-
-	/*
-	 * kick GPU kernel(s)
-	 */
-	cuda_module = GpuContextLookupModule(gcontext, gstate->program_id);
-	gstoreLaunchScanSortKernel(gcontext,
+	nshards = GpuStoreBufferGetNShards(gs_buffer);
+	gstate->shards = palloc0(sizeof(GpuStoreScanShard) * Max(nshards, 1));
+	gstate->nshards = nshards;
+	for (i=0; i < nshards; i++)
+	{
+		cl_int		dindex;
+
+		sshard = &gstate->shards[i];
+		dindex = GpuStoreBufferGetShard(gs_buffer, i,
+										&sshard->base_index,
+										&sshard->nitems);
+		if (dindex < 0)
+			continue;		/* host memory */
+		for (k=0; k < gstate->num_gcontexts; k++)
+		{
+			if (gstate->gcontexts[k]->cuda_dindex == dindex)
+				break;
+		}
+		if (k == gstate->num_gcontexts)
+			continue;		/* not a device at the plan time, so by CPU */
+		gcontext = gstate->gcontexts[k];
+		sshard->gcontext = gcontext;
+		sshard->program_id = gstate->program_ids[k];
+
+		ActivateGpuContextNoWorkers(gcontext);
+		GPUCONTEXT_PUSH(gcontext);
+		/*
+		 * setup kern_gpusort (including gpusortResultIndex)
+		 */
+		length = (STROMALIGN(offsetof(kern_gpusort, kparams)) +
+				  STROMALIGN(kparams->length) +
+				  STROMALIGN(offsetof(gpusortResultIndex, results)));
+		rc = gpuMemAllocManaged(gcontext,
+								&m_gpusort,
+								STROMALIGN(length + (sizeof(cl_uint) *
+													 sshard->nitems)),
+								CU_MEM_ATTACH_GLOBAL);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on gpuMemAllocManaged: %s", errorText(rc));
+		memset((void *)m_gpusort, 0, length);
+		memcpy(KERN_GPUSORT_PARAMBUF(m_gpusort),
+			   kparams,
+			   kparams->length);
+		sshard->kgpusort = (kern_gpusort *) m_gpusort;
+		sshard->kgpusort->nitems_in = sshard->nitems;
+		/*
+		 * map device memory, then kick GPU kernel
+		 */
+		sshard->m_kds_src = GpuStoreBufferOpenDevPtr(gcontext, gs_buffer, i);
+		cuda_module = GpuContextLookupModule(gcontext, sshard->program_id);
+		gstoreLaunchScanKernel(gcontext,
 							   cuda_module,
 							   m_gpusort,
-							   m_kds_src,
+							   sshard->m_kds_src);
+		GPUCONTEXT_POP(gcontext);
+	}
+
+	for (i=0; i < nshards; i++)
+	{
+		sshard = &gstate->shards[i];
+		if (!sshard->kgpusort)
+			continue;
+		gcontext = sshard->gcontext;
+		GPUCONTEXT_PUSH(gcontext);
+		cuda_module = GpuContextLookupModule(gcontext, sshard->program_id);
+		gstoreLaunchSortKernel(gcontext,
+							   cuda_module,
+							   (CUdeviceptr) sshard->kgpusort,
+							   sshard->m_kds_src,
 							   gstate->has_sortkeys);
-	/*
-	 * unmap device memory
-	 */
-	rc = gpuIpcCloseMemHandle(gcontext, m_kds_src);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on gpuIpcCloseMemHandle: %s", errorText(rc));
+		/*
+		 * unmap device memory
+		 */
+		rc = gpuIpcCloseMemHandle(gcontext, sshard->m_kds_src);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on gpuIpcCloseMemHandle: %s", errorText(rc));
+		sshard->m_kds_src = 0UL;
+		GPUCONTEXT_POP(gcontext);
+	}
+}
+
+/*
+ * gstoreFetchDeviceRow - fetch the next row index processed by GPU kernel
+ */
+static bool
+gstoreFetchDeviceRow(GpuStoreExecState *gstate, size_t *p_row_index)
+{
+	while (gstate->curr_shard < gstate->nshards)
+	{
+		GpuStoreScanShard *sshard = &gstate->shards[gstate->curr_shard];
+
+		if (sshard->kgpusort)
+		{
+			gpusortResultIndex *kresults
+				= KERN_GPUSORT_RESULT_INDEX(sshard->kgpusort);
+
+			if (sshard->index < kresults->nitems)
+			{
+				*p_row_index = (sshard->base_index +
+								kresults->results[sshard->index++]);
+				return true;
+			}
+		}
+		gstate->curr_shard++;
+	}
+	return false;
+}
+
+/*
+ * gstoreFetchHostRow - fetch the next row index not processed by GPU
+ * kernel; rows on the host shards, then rows on the delta image.
+ */
+static bool
+gstoreFetchHostRow(GpuStoreExecState *gstate, size_t *p_row_index)
+{
+	GpuStoreBuffer *gs_buffer = gstate->gs_buffer;
+	size_t			row_index;
+
+	while (gstate->host_shard < gstate->nshards)
+	{
+		GpuStoreScanShard *sshard = &gstate->shards[gstate->host_shard];
+
+		if (!sshard->kgpusort && gstate->host_index < sshard->nitems)
+		{
+			*p_row_index = sshard->base_index + gstate->host_index++;
+			return true;
+		}
+		gstate->host_shard++;
+		gstate->host_index = 0;
+	}
+	row_index = GpuStoreBufferGetMainNitems(gs_buffer) + gstate->host_index;
+	if (row_index >= GpuStoreBufferGetNitems(gs_buffer))
+		return false;
+	gstate->host_index++;
+	*p_row_index = row_index;
+	return true;
+}
+
+/*
+ * gstoreExecHostQuals - evaluation of qualifiers by CPU
+ */
+#if PG_VERSION_NUM < 100000
+static bool
+gstoreExecHostQuals(ForeignScanState *node, List *quals, TupleTableSlot *slot)
+#else
+static bool
+gstoreExecHostQuals(ForeignScanState *node, ExprState *quals,
+					TupleTableSlot *slot)
+#endif
+{
+	ExprContext	   *econtext = node->ss.ps.ps_ExprContext;
+
+	ResetExprContext(econtext);
+	econtext->ecxt_scantuple = slot;
+#if PG_VERSION_NUM < 100000
+	return ExecQual(quals, econtext, false);
+#else
+	return ExecQual(quals, econtext);
+#endif
+}
+
+/*
+ * gstore_delta_row_compare - comparison of the sort keys
+ */
+static int
+gstore_delta_row_compare(const void *__a, const void *__b, void *arg)
+{
+	const GpuStoreDeltaRow *a = *((const GpuStoreDeltaRow **) __a);
+	const GpuStoreDeltaRow *b = *((const GpuStoreDeltaRow **) __b);
+	GpuStoreExecState *gstate = arg;
+	int			k, comp;
+
+	for (k=0; k < gstate->sort_nkeys; k++)
+	{
+		comp = ApplySortComparator(a->values[k], a->isnull[k],
+								   b->values[k], b->isnull[k],
+								   &gstate->sort_ssup[k]);
+		if (comp != 0)
+			return comp;
+	}
+	/* keep the order of row-index for stable results */
+	if (a->row_index < b->row_index)
+		return -1;
+	if (a->row_index > b->row_index)
+		return 1;
+	return 0;
+}
+
+/*
+ * gstore_form_delta_row - picks up the sort keys of the row
+ *
+ * Values of the sort keys reference the read-only buffer as is.
+ */
+static GpuStoreDeltaRow *
+gstore_form_delta_row(GpuStoreExecState *gstate, TupleTableSlot *slot,
+					  size_t row_index, GpuStoreDeltaRow *drow)
+{
+	size_t		sz;
+	int			k;
+
+	sz = MAXALIGN(offsetof(GpuStoreDeltaRow, values[gstate->sort_nkeys]));
+	if (!drow)
+	{
+		drow = palloc(sz + sizeof(bool) * gstate->sort_nkeys);
+		drow->isnull = (bool *)((char *)drow + sz);
+	}
+	drow->row_index = row_index;
+	for (k=0; k < gstate->sort_nkeys; k++)
+		drow->values[k] = slot_getattr(slot, gstate->sort_anums[k],
+									   &drow->isnull[k]);
+	return drow;
+}
+
+/*
+ * gstoreSetupDeltaMerge
+ *
+ * GPU kernel sorts only the rows on the shards of the GPU devices, so rows
+ * on the host shards and delta image are filtered and sorted by CPU, then
+ * merged to the results of the GPU kernels.
+ */
+static void
+gstoreSetupDeltaMerge(ForeignScanState *node, GpuStoreExecState *gstate)
+{
+	Relation		frel = node->ss.ss_currentRelation;
+	Snapshot		snapshot = node->ss.ps.state->es_snapshot;
+	TupleTableSlot *slot = gstate->temp_slot;
+	GpuStoreBuffer *gs_buffer = gstate->gs_buffer;
+	GpuStoreDeltaRow **delta_rows = NULL;
+	size_t			nrooms = 0;
+	size_t			nrows = 0;
+	size_t			row_index;
+
+	gstate->host_shard = 0;
+	gstate->host_index = 0;
+	while (gstoreFetchHostRow(gstate, &row_index))
+	{
+		if (GpuStoreBufferGetTuple(frel,
+								   snapshot,
+								   slot,
+								   gs_buffer,
+								   row_index, false) != 0)
+			continue;
+		if (gstate->dev_quals_host &&
+			!gstoreExecHostQuals(node, gstate->dev_quals_host, slot))
+			continue;
+		if (gstate->dict_fallback && !gstate->dict_by_code &&
+			!gstoreExecHostQuals(node, gstate->dict_fallback, slot))
+			continue;
+
+		if (nrows >= nrooms)
+		{
+			nrooms = Max(2 * nrooms, 1024);
+			if (!delta_rows)
+				delta_rows = palloc_huge(sizeof(GpuStoreDeltaRow *) * nrooms);
+			else
+				delta_rows = repalloc_huge(delta_rows,
+										   sizeof(GpuStoreDeltaRow *) * nrooms);
+		}
+		delta_rows[nrows++] = gstore_form_delta_row(gstate, slot,
+													row_index, NULL);
+	}
+	ExecClearTuple(slot);
+
+	if (nrows > 0)
+	{
+		qsort_arg(delta_rows, nrows, sizeof(GpuStoreDeltaRow *),
+				  gstore_delta_row_compare, gstate);
+		gstate->delta_rows = delta_rows;
+		gstate->delta_nrows = nrows;
+	}
+	else if (delta_rows)
+		pfree(delta_rows);
+}
+
+/*
+ * gstoreFetchShardHead - fetch the next row in sorted order on the shard
+ */
+static GpuStoreDeltaRow *
+gstoreFetchShardHead(ForeignScanState *node, GpuStoreExecState *gstate,
+					 GpuStoreScanShard *sshard)
+{
+	Relation		frel = node->ss.ss_currentRelation;
+	Snapshot		snapshot = node->ss.ps.state->es_snapshot;
+	TupleTableSlot *slot = gstate->temp_slot;
+	gpusortResultIndex *kresults = KERN_GPUSORT_RESULT_INDEX(sshard->kgpusort);
+
+	while (sshard->index < kresults->nitems)
+	{
+		size_t		row_index = (sshard->base_index +
+								 kresults->results[sshard->index++]);
+
+		if (GpuStoreBufferGetTuple(frel,
+								   snapshot,
+								   slot,
+								   gstate->gs_buffer,
+								   row_index, false) != 0)
+			continue;
+		if (gstate->dict_fallback && !gstate->dict_by_code &&
+			!gstoreExecHostQuals(node, gstate->dict_fallback, slot))
+			continue;
+		sshard->head_buf = gstore_form_delta_row(gstate, slot, row_index,
+												 sshard->head_buf);
+		sshard->head = sshard->head_buf;
+		return sshard->head;
+	}
+	return NULL;
+}
+
+/*
+ * gstoreFetchMergedRow - fetch the next row index in the sorted order
+ *
+ * It merges the rows sorted by GPU kernel on each shard, and the rows
+ * sorted by CPU.
+ */
+static bool
+gstoreFetchMergedRow(ForeignScanState *node, GpuStoreExecState *gstate,
+					 size_t *p_row_index)
+{
+	GpuStoreScanShard *best_shard = NULL;
+	GpuStoreDeltaRow *best = NULL;
+	GpuStoreDeltaRow *drow;
+	int				i;
+
+	for (i=0; i < gstate->nshards; i++)
+	{
+		GpuStoreScanShard *sshard = &gstate->shards[i];
+
+		if (!sshard->kgpusort)
+			continue;
+		drow = sshard->head;
+		if (!drow)
+			drow = gstoreFetchShardHead(node, gstate, sshard);
+		if (!drow)
+			continue;
+		if (!best || gstore_delta_row_compare(&drow, &best, gstate) < 0)
+		{
+			best_shard = sshard;
+			best = drow;
+		}
+	}
+
+	if (gstate->delta_index < gstate->delta_nrows)
+	{
+		drow = gstate->delta_rows[gstate->delta_index];
+		if (!best || gstore_delta_row_compare(&drow, &best, gstate) < 0)
+		{
+			gstate->delta_index++;
+			*p_row_index = drow->row_index;
+			return true;
+		}
+	}
+	if (!best)
+		return false;
+	best_shard->head = NULL;
+	*p_row_index = best->row_index;
+	return true;
 }
 
 /*
@@ -1057,25 +2003,90 @@ gstoreExecForeignScan(ForeignScanState *node)
 	EState		   *estate = node->ss.ps.state;
 	Snapshot		snapshot = estate->es_snapshot;
 	ForeignScan	   *fscan = (ForeignScan *)node->ss.ps.plan;
-	cl_uint			row_index;
+	size_t			row_index;
+	bool			is_host;
+	bool			is_merged;
 
 	if (!gstate->gs_buffer)
 		gstate->gs_buffer = GpuStoreBufferCreate(frel, snapshot);
+	if (gstate->dict_quals != NIL && !gstate->dict_resolved)
+	{
+		ListCell   *lc;
+
+		/*
+		 * Dictionary codes are available only if read-only buffer has
+		 * sorted varlena dictionary. Elsewhere, we fallback to the normal
+		 * qualifier evaluation.
+		 */
+		gstate->dict_by_code = true;
+		foreach (lc, gstate->dict_quals)
+		{
+			GpuStoreDictQual *dqual = lfirst(lc);
+
+			if (!GpuStoreBufferHasDictionary(gstate->gs_buffer, dqual->anum))
+			{
+				gstate->dict_by_code = false;
+				break;
+			}
+		}
+		if (gstate->dict_by_code)
+		{
+			foreach (lc, gstate->dict_quals)
+				gstore_dict_qual_resolve(lfirst(lc),
+										 gstate->gs_buffer,
+										 RelationGetDescr(frel));
+		}
+		gstate->dict_resolved = true;
+	}
 lnext:
+	is_host = false;
+	is_merged = false;
 	if (gstate->gcontext)
 	{
-		gpusortResultIndex *kresults;
-
-		if (!gstate->kgpusort)
+		if (!gstate->shards)
+		{
 			gstoreProcessScanSortKernel(gstate);
-		kresults = KERN_GPUSORT_RESULT_INDEX(gstate->kgpusort);
-		if (gstate->gs_index >= kresults->nitems)
-			return NULL;
-		row_index = kresults->results[gstate->gs_index++];
+			if (gstate->has_sortkeys)
+				gstoreSetupDeltaMerge(node, gstate);
+		}
+		if (gstate->has_sortkeys)
+		{
+			/* merge the sorted rows on the shards and by CPU */
+			if (!gstoreFetchMergedRow(node, gstate, &row_index))
+				return NULL;
+			is_merged = true;
+		}
+		else if (!gstoreFetchDeviceRow(gstate, &row_index))
+		{
+			/* rows on the host shards and delta image */
+			if (!gstoreFetchHostRow(gstate, &row_index))
+				return NULL;
+			is_host = true;
+		}
 	}
 	else
 		row_index = gstate->gs_index++;
 
+	/* evaluation of dict_quals prior to fetch the tuple */
+	if (gstate->dict_by_code)
+	{
+		ListCell   *lc;
+
+		if (row_index >= GpuStoreBufferGetNitems(gstate->gs_buffer))
+			return NULL;
+		foreach (lc, gstate->dict_quals)
+		{
+			GpuStoreDictQual *dqual = lfirst(lc);
+			cl_uint		code;
+
+			code = GpuStoreBufferGetDictCode(gstate->gs_buffer,
+											 dqual->anum,
+											 row_index);
+			if (!gstore_dict_qual_check(dqual, code))
+				goto lnext;
+		}
+	}
+
 	if (GpuStoreBufferGetTuple(frel,
 							   snapshot,
 							   slot,
@@ -1084,6 +2095,17 @@ lnext:
 							   fscan->fsSystemCol) > 0)
 		goto lnext;
 
+	/* rows on the host shards and delta image are not evaluated by GPU */
+	if (is_host && gstate->dev_quals_host && !TupIsNull(slot) &&
+		!gstoreExecHostQuals(node, gstate->dev_quals_host, slot))
+		goto lnext;
+
+	/* elsewhere, dict_quals are evaluated as usual (unless merged rows) */
+	if (!is_merged &&
+		gstate->dict_fallback && !gstate->dict_by_code && !TupIsNull(slot) &&
+		!gstoreExecHostQuals(node, gstate->dict_fallback, slot))
+		goto lnext;
+
 	return slot;
 }
 
@@ -1094,8 +2116,19 @@ static void
 gstoreReScanForeignScan(ForeignScanState *node)
 {
 	GpuStoreExecState *gstate = (GpuStoreExecState *) node->fdw_state;
+	int			i;
 
 	gstate->gs_index = 0;
+	gstate->curr_shard = 0;
+	gstate->host_shard = 0;
+	gstate->host_index = 0;
+	gstate->delta_index = 0;
+	for (i=0; i < gstate->nshards; i++)
+	{
+		gstate->shards[i].index = 0;
+		gstate->shards[i].head = NULL;
+	}
+	gstate->dict_resolved = false;
 }
 
 /*
@@ -1105,17 +2138,24 @@ static void
 gstoreEndForeignScan(ForeignScanState *node)
 {
 	GpuStoreExecState  *gstate = (GpuStoreExecState *) node->fdw_state;
+	int			i;
 
-	if (gstate->gcontext)
+	for (i=0; i < gstate->nshards; i++)
 	{
-		if (gstate->program_id != INVALID_PROGRAM_ID)
-			pgstrom_put_cuda_program(gstate->gcontext,
-									 gstate->program_id);
-		if (gstate->kgpusort)
-			gpuMemFree(gstate->gcontext, (CUdeviceptr) gstate->kgpusort);
+		GpuStoreScanShard *sshard = &gstate->shards[i];
 
-		PutGpuContext(gstate->gcontext);
+		if (sshard->kgpusort)
+			gpuMemFree(sshard->gcontext, (CUdeviceptr) sshard->kgpusort);
+	}
+	for (i=0; i < gstate->num_gcontexts; i++)
+	{
+		if (gstate->program_ids[i] != INVALID_PROGRAM_ID)
+			pgstrom_put_cuda_program(gstate->gcontexts[i],
+									 gstate->program_ids[i]);
+		PutGpuContext(gstate->gcontexts[i]);
 	}
+	if (gstate->temp_slot)
+		ExecDropSingleTupleTableSlot(gstate->temp_slot);
 }
 
 /*
@@ -1145,6 +2185,14 @@ gstoreExplainForeignScan(ForeignScanState *node, ExplainState *es)
 		//Rows Removed by GPU Filter if EXPLAIN ANALYZE
 	}
 
+	/* qualifiers evaluated by dictionary codes, if any */
+	if (gsf_info->dict_quals != NIL)
+	{
+		temp = deparse_expression((Node *)gsf_info->dict_quals,
+								  dcontext, es->verbose, false);
+		ExplainPropertyText("Dictionary Filter", temp, es);
+	}
+
 	/* sorting keys, if any */
 	if (gsf_info->sort_keys != NIL)
 	{
@@ -1252,8 +2300,75 @@ gstoreBeginForeignModify(ModifyTableState *mtstate,
 			elog(ERROR, "could not find junk ctid column");
 		gstate->ctid_anum = ctid_anum;
 	}
+	else if (operation == CMD_INSERT)
+		gstoreSetupInsertBatch(gstate, rrinfo);
+	rrinfo->ri_FdwState = gstate;
+}
+
+#if PG_VERSION_NUM >= 110000
+/*
+ * gstoreBeginForeignInsert - COPY FROM or tuple routing
+ */
+static void
+gstoreBeginForeignInsert(ModifyTableState *mtstate,
+						 ResultRelInfo *rrinfo)
+{
+	GpuStoreExecState *gstate = palloc0(sizeof(GpuStoreExecState));
+	Relation	frel = rrinfo->ri_RelationDesc;
+
+	/* see the comment in gstoreBeginForeignModify */
+	LockRelationOid(RelationGetRelid(frel), ShareUpdateExclusiveLock);
+	gstoreSetupInsertBatch(gstate, rrinfo);
 	rrinfo->ri_FdwState = gstate;
 }
+#endif
+
+/*
+ * gstoreSetupInsertBatch
+ *
+ * INSERT and COPY FROM accumulate the new rows in the local batch, then
+ * append them to GpuStoreBuffer at once. It is not used if the table has
+ * any triggers, because row triggers may reference the rows inserted
+ * by the statement.
+ */
+static void
+gstoreSetupInsertBatch(GpuStoreExecState *gstate, ResultRelInfo *rrinfo)
+{
+	TupleDesc	tupdesc = RelationGetDescr(rrinfo->ri_RelationDesc);
+	size_t		nitems = GSTORE_INSERT_BATCH_NROWS * tupdesc->natts;
+
+	if (rrinfo->ri_TrigDesc != NULL)
+		return;
+	gstate->batch_memcxt = AllocSetContextCreate(CurrentMemoryContext,
+												 "gstore_fdw insert batch",
+												 ALLOCSET_DEFAULT_SIZES);
+	gstate->batch_nrows  = 0;
+	gstate->batch_usage  = 0;
+	gstate->batch_values = palloc(sizeof(Datum) * nitems);
+	gstate->batch_isnull = palloc(sizeof(bool) * nitems);
+}
+
+/*
+ * gstoreFlushInsertBatch
+ */
+static void
+gstoreFlushInsertBatch(GpuStoreExecState *gstate,
+					   Relation frel, Snapshot snapshot)
+{
+	if (gstate->batch_nrows == 0)
+		return;
+	if (!gstate->gs_buffer)
+		gstate->gs_buffer = GpuStoreBufferCreate(frel, snapshot);
+	GpuStoreBufferAppendRows(gstate->gs_buffer,
+							 RelationGetDescr(frel),
+							 snapshot,
+							 gstate->batch_nrows,
+							 gstate->batch_values,
+							 gstate->batch_isnull);
+	gstate->batch_nrows = 0;
+	gstate->batch_usage = 0;
+	MemoryContextReset(gstate->batch_memcxt);
+}
 
 /*
  * gstoreExecForeignInsert
@@ -1271,6 +2386,52 @@ gstoreExecForeignInsert(EState *estate,
 	if (snapshot->curcid > INT_MAX)
 		elog(ERROR, "gstore_fdw: too much sub-transactions");
 
+	if (gstate->batch_memcxt)
+	{
+		TupleDesc	tupdesc = RelationGetDescr(frel);
+		cl_uint		j, natts = tupdesc->natts;
+		Datum	   *values;
+		bool	   *isnull;
+		MemoryContext oldcxt;
+
+		slot_getallattrs(slot);
+		values = gstate->batch_values + natts * gstate->batch_nrows;
+		isnull = gstate->batch_isnull + natts * gstate->batch_nrows;
+		oldcxt = MemoryContextSwitchTo(gstate->batch_memcxt);
+		for (j=0; j < natts; j++)
+		{
+			Form_pg_attribute attr = tupleDescAttr(tupdesc, j);
+			Datum	datum = slot->tts_values[j];
+
+			isnull[j] = slot->tts_isnull[j];
+			if (isnull[j] || attr->attisdropped)
+				values[j] = 0;
+			else if (attr->attbyval)
+				values[j] = datum;
+			else if (attr->attlen == -1)
+			{
+				struct varlena *vl = PG_DETOAST_DATUM_COPY(datum);
+
+				values[j] = PointerGetDatum(vl);
+				gstate->batch_usage += VARSIZE(vl);
+			}
+			else
+			{
+				void   *temp = palloc(attr->attlen);
+
+				memcpy(temp, DatumGetPointer(datum), attr->attlen);
+				values[j] = PointerGetDatum(temp);
+				gstate->batch_usage += attr->attlen;
+			}
+		}
+		MemoryContextSwitchTo(oldcxt);
+
+		if (++gstate->batch_nrows >= GSTORE_INSERT_BATCH_NROWS ||
+			gstate->batch_usage >= GSTORE_INSERT_BATCH_USAGE)
+			gstoreFlushInsertBatch(gstate, frel, snapshot);
+		return slot;
+	}
+
 	if (!gstate->gs_buffer)
 		gstate->gs_buffer = GpuStoreBufferCreate(frel, snapshot);
 
@@ -1374,8 +2535,25 @@ static void
 gstoreEndForeignModify(EState *estate,
 					   ResultRelInfo *rrinfo)
 {
-	//GpuStoreExecState *gstate = (GpuStoreExecState *) rrinfo->ri_FdwState;
+	GpuStoreExecState *gstate = (GpuStoreExecState *) rrinfo->ri_FdwState;
+
+	if (gstate->batch_memcxt)
+		gstoreFlushInsertBatch(gstate,
+							   rrinfo->ri_RelationDesc,
+							   estate->es_snapshot);
+}
+
+#if PG_VERSION_NUM >= 110000
+/*
+ * gstoreEndForeignInsert
+ */
+static void
+gstoreEndForeignInsert(EState *estate,
+					   ResultRelInfo *rrinfo)
+{
+	gstoreEndForeignModify(estate, rrinfo);
 }
+#endif
 
 /*
  * relation_is_gstore_fdw
@@ -1446,11 +2624,16 @@ relation_is_gstore_fdw(Oid table_oid)
 static void
 __gstore_fdw_table_options(List *options,
 						   int *p_pinning,
-						   int *p_format)
+						   int *p_format,
+						   List **p_devices,
+						   size_t *p_shard_nrows)
 {
 	ListCell   *lc;
+	ListCell   *cell;
+	List	   *devices = NIL;
 	int			pinning = -1;
 	int			format = -1;
+	long		shard_nrows = -1;
 
 	foreach (lc, options)
 	{
@@ -1458,15 +2641,69 @@ __gstore_fdw_table_options(List *options,
 
 		if (strcmp(defel->defname, "pinning") == 0)
 		{
-			if (pinning >= 0)
+			char	   *temp;
+			List	   *namelist;
+
+			if (devices != NIL)
 				ereport(ERROR,
 						(errcode(ERRCODE_SYNTAX_ERROR),
 						 errmsg("\"pinning\" option appears twice")));
-			pinning = atoi(defGetString(defel));
-			if (pinning < 0 || pinning >= numDevAttrs)
+			/*
+			 * pinning is a comma separated list of GPU device index, or
+			 * 'host' to keep the shard on the host memory.
+			 */
+			temp = pstrdup(defGetString(defel));
+			if (!SplitIdentifierString(temp, ',', &namelist) ||
+				namelist == NIL)
+				ereport(ERROR,
+						(errcode(ERRCODE_SYNTAX_ERROR),
+						 errmsg("\"pinning\" must be a list of GPU device or 'host'")));
+			foreach (cell, namelist)
+			{
+				char   *name = lfirst(cell);
+				char   *end;
+				long	dindex;
+
+				if (pg_strcasecmp(name, "host") == 0)
+					dindex = -1;
+				else
+				{
+					dindex = strtol(name, &end, 10);
+					if (*name == '\0' || *end != '\0')
+						ereport(ERROR,
+								(errcode(ERRCODE_SYNTAX_ERROR),
+								 errmsg("\"pinning\" has invalid GPU device: %s", name)));
+					if (dindex < 0 || dindex >= numDevAttrs)
+						ereport(ERROR,
+								(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+								 errmsg("\"pinning\" on unavailable GPU device")));
+				}
+				if (list_length(devices) >= GSTORE_MAX_SHARDS)
+					ereport(ERROR,
+							(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+							 errmsg("\"pinning\" lists too many devices (up to %d)",
+									GSTORE_MAX_SHARDS)));
+				devices = lappend_int(devices, (int)dindex);
+				if (pinning < 0 && dindex >= 0)
+					pinning = dindex;
+			}
+			list_free(namelist);
+			pfree(temp);
+		}
+		else if (strcmp(defel->defname, "shard_nrows") == 0)
+		{
+			char   *temp = defGetString(defel);
+			char   *end;
+
+			if (shard_nrows >= 0)
 				ereport(ERROR,
-						(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
-						 errmsg("\"pinning\" on unavailable GPU device")));
+						(errcode(ERRCODE_SYNTAX_ERROR),
+						 errmsg("\"shard_nrows\" option appears twice")));
+			shard_nrows = strtol(temp, &end, 10);
+			if (*temp == '\0' || *end != '\0' || shard_nrows < 0)
+				ereport(ERROR,
+						(errcode(ERRCODE_SYNTAX_ERROR),
+						 errmsg("\"shard_nrows\" must be zero or positive integer")));
 		}
 		else if (strcmp(defel->defname, "format") == 0)
 		{
@@ -1494,7 +2731,7 @@ __gstore_fdw_table_options(List *options,
 							defel->defname)));
 		}
 	}
-	if (pinning < 0)
+	if (devices == NIL)
 		ereport(ERROR,
 				(errcode(ERRCODE_SYNTAX_ERROR),
 				 errmsg("gstore_fdw: No pinning GPU device"),
@@ -1503,15 +2740,23 @@ __gstore_fdw_table_options(List *options,
 	/* put default if not specified */
 	if (format < 0)
 		format = GSTORE_FDW_FORMAT__PGSTROM;
+	if (shard_nrows < 0)
+		shard_nrows = 0;
 	/* set results */
 	if (p_pinning)
 		*p_pinning = pinning;
 	if (p_format)
 		*p_format = format;
+	if (p_devices)
+		*p_devices = devices;
+	else
+		list_free(devices);
+	if (p_shard_nrows)
+		*p_shard_nrows = shard_nrows;
 }
 
-void
-gstore_fdw_table_options(Oid gstore_oid, int *p_pinning, int *p_format)
+static List *
+gstore_fdw_table_rawoptions(Oid gstore_oid)
 {
 	HeapTuple	tup;
 	Datum		datum;
@@ -1526,8 +2771,30 @@ gstore_fdw_table_options(Oid gstore_oid, int *p_pinning, int *p_format)
 							&isnull);
 	if (!isnull)
 		options = untransformRelOptions(datum);
-	__gstore_fdw_table_options(options, p_pinning, p_format);
 	ReleaseSysCache(tup);
+
+	return options;
+}
+
+void
+gstore_fdw_table_options(Oid gstore_oid, int *p_pinning, int *p_format)
+{
+	List	   *options = gstore_fdw_table_rawoptions(gstore_oid);
+
+	__gstore_fdw_table_options(options, p_pinning, p_format, NULL, NULL);
+}
+
+/*
+ * gstore_fdw_table_shard_options - list of the devices to keep the shards,
+ * and number of rows per shard (0 means one shard per device)
+ */
+void
+gstore_fdw_table_shard_options(Oid gstore_oid,
+							   List **p_devices, size_t *p_shard_nrows)
+{
+	List	   *options = gstore_fdw_table_rawoptions(gstore_oid);
+
+	__gstore_fdw_table_options(options, NULL, NULL, p_devices, p_shard_nrows);
 }
 
 /*
@@ -1597,7 +2864,7 @@ pgstrom_gstore_fdw_validator(PG_FUNCTION_ARGS)
 	switch (catalog)
 	{
 		case ForeignTableRelationId:
-			__gstore_fdw_table_options(options, NULL, NULL);
+			__gstore_fdw_table_options(options, NULL, NULL, NULL, NULL);
 			break;
 
 		case AttributeRelationId:
@@ -1650,6 +2917,10 @@ pgstrom_gstore_fdw_handler(PG_FUNCTION_ARGS)
 	routine->ExecForeignUpdate  = gstoreExecForeignUpdate;
 	routine->ExecForeignDelete	= gstoreExecForeignDelete;
 	routine->EndForeignModify	= gstoreEndForeignModify;
+#if PG_VERSION_NUM >= 110000
+	routine->BeginForeignInsert	= gstoreBeginForeignInsert;
+	routine->EndForeignInsert	= gstoreEndForeignInsert;
+#endif
 
 	PG_RETURN_POINTER(routine);
 }
@@ -25,6 +25,7 @@ PG_MODULE_MAGIC;
 bool		pgstrom_enabled;
 bool		pgstrom_debug_kernel_source;
 bool		pgstrom_cpu_fallback_enabled;
+bool		pgstrom_debug_force_cpu_fallback;
 static int	pgstrom_chunk_size_kb;
 
 /* cost factors */
@@ -67,6 +68,15 @@ pgstrom_init_misc_guc(void)
 							 PGC_USERSET,
 							 GUC_NOT_IN_SAMPLE,
 							 NULL, NULL, NULL);
+	/* turn on/off forced CPU fallback for debugging */
+	DefineCustomBoolVariable("pg_strom.debug_force_cpu_fallback",
+							 "Forces GPU programs to return CPU ReCheck error",
+							 NULL,
+							 &pgstrom_debug_force_cpu_fallback,
+							 false,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 	/* turn on/off cuda kernel source saving */
 	DefineCustomBoolVariable("pg_strom.debug_kernel_source",
 							 "Turn on/off to display the kernel source path",
@@ -534,6 +544,8 @@ _PG_init(void)
 
 	/* miscellaneous initializations */
 	pgstrom_init_codegen();
+	pgstrom_init_regex_dfa();
+	pgstrom_init_float2();
 	pgstrom_init_plcuda();
 	pgstrom_init_gstore_buf();
 	pgstrom_init_gstore_fdw();
@@ -18,12 +18,18 @@
 #include "pg_strom.h"
 #include "cuda_plcuda.h"
 #include <math.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 /* function declarations */
 Datum array_matrix_accum(PG_FUNCTION_ARGS);
 Datum array_matrix_accum_varbit(PG_FUNCTION_ARGS);
 Datum varbit_to_int4_array(PG_FUNCTION_ARGS);
 Datum int4_array_to_varbit(PG_FUNCTION_ARGS);
+Datum array_matrix_combine(PG_FUNCTION_ARGS);
+Datum array_matrix_serialize(PG_FUNCTION_ARGS);
+Datum array_matrix_deserialize(PG_FUNCTION_ARGS);
 Datum array_matrix_final_bool(PG_FUNCTION_ARGS);
 Datum array_matrix_final_int2(PG_FUNCTION_ARGS);
 Datum array_matrix_final_int4(PG_FUNCTION_ARGS);
@@ -128,14 +134,151 @@ create_empty_matrix(Oid type_oid, cl_uint width, cl_uint height)
 
 /*
  * Constructor of Matrix-like Array
+ *
+ * The input vectors are written to the column-major buffer in place, so
+ * the final function can build the matrix with a memcpy per column.
+ * Capacity of the buffer is doubled when it becomes full.
  */
 typedef struct
 {
 	Oid			elemtype;	/* element type of the input array */
+	cl_int		typlen;		/* length of the element type */
 	cl_uint		width;		/* max width of the input vector */
-	List	   *rows;		/* list of the supplied vector */
+	cl_uint		height;		/* number of the supplied vectors */
+	cl_uint		nrooms;		/* capacity of the buffer (in rows) */
+	char	   *values;		/* column-major buffer of width x nrooms */
 } array_matrix_state;
 
+#define ARRAY_MATRIX_STATE_MIN_NROOMS		256
+
+static array_matrix_state *
+create_array_matrix_state(Oid elemtype)
+{
+	array_matrix_state *amstate;
+	cl_int		typlen;
+
+	switch (elemtype)
+	{
+		case BOOLOID:	typlen = sizeof(bool);		break;
+		case INT2OID:	typlen = sizeof(int16);		break;
+		case INT4OID:	typlen = sizeof(int32);		break;
+		case INT8OID:	typlen = sizeof(int64);		break;
+		case FLOAT4OID:	typlen = sizeof(float);		break;
+		case FLOAT8OID:	typlen = sizeof(double);	break;
+		default:
+			elog(ERROR, "unsupported element type: %s",
+				 format_type_be(elemtype));
+	}
+	amstate = palloc0(sizeof(array_matrix_state));
+	amstate->elemtype = elemtype;
+	amstate->typlen = typlen;
+
+	return amstate;
+}
+
+/*
+ * expand_array_matrix_state
+ *
+ * It ensures the buffer has enough space for @height rows with @width
+ * columns. Existing values are moved to the new location of the column,
+ * and the new columns are filled by zero.
+ */
+static void
+expand_array_matrix_state(array_matrix_state *amstate,
+						  cl_uint width, cl_uint height)
+{
+	Size		typlen = amstate->typlen;
+	Size		nrooms = amstate->nrooms;
+	Size		length;
+	char	   *values;
+	cl_uint		i;
+
+	if (width <= amstate->width && height <= amstate->nrooms)
+		return;		/* nothing to do */
+	if (height > amstate->nrooms)
+	{
+		nrooms = Max3(ARRAY_MATRIX_STATE_MIN_NROOMS, 2 * nrooms, height);
+		nrooms = Min(nrooms, UINT_MAX);
+	}
+	width = Max(width, amstate->width);
+
+	/* the final matrix has to fit in a varlena */
+	if (!AllocSizeIsValid(ARRAY_MATRIX_RAWSIZE(typlen, height, width)))
+		elog(ERROR, "supplied array-matrix is too big");
+	length = typlen * nrooms * width;
+	if (!AllocHugeSizeIsValid(length))
+		elog(ERROR, "supplied array-matrix is too big");
+
+	if (nrooms == amstate->nrooms && amstate->values)
+	{
+		/* only new columns are added */
+		values = repalloc_huge(amstate->values, length);
+	}
+	else
+	{
+		values = MemoryContextAllocHuge(CurrentMemoryContext, length);
+		for (i=0; i < amstate->width; i++)
+			memcpy(values + typlen * nrooms * i,
+				   amstate->values + typlen * amstate->nrooms * i,
+				   typlen * amstate->height);
+		if (amstate->values)
+			pfree(amstate->values);
+	}
+	/* new columns of the existing rows are zero */
+	for (i=amstate->width; i < width; i++)
+		memset(values + typlen * nrooms * i, 0,
+			   typlen * amstate->height);
+	amstate->width = width;
+	amstate->nrooms = nrooms;
+	amstate->values = values;
+}
+
+#define ARRAY_MATRIX_STATE_APPEND_TEMPLATE(amstate,src,nitems,BASETYPE)	\
+	do {																\
+		BASETYPE   *__src = (BASETYPE *)(src);							\
+		BASETYPE   *__dst = ((BASETYPE *)(amstate)->values +			\
+							 (amstate)->height);						\
+		cl_uint		__i;												\
+																		\
+		for (__i=0; __i < (nitems); __i++, __dst += (amstate)->nrooms)	\
+			*__dst = __src[__i];										\
+		for (; __i < (amstate)->width; __i++, __dst += (amstate)->nrooms) \
+			*__dst = 0;													\
+	} while(0)
+
+/*
+ * append_array_matrix_state
+ *
+ * It writes a vector of @nitems elements on the next row of the buffer.
+ */
+static void
+append_array_matrix_state(array_matrix_state *amstate,
+						  const char *src, cl_uint nitems)
+{
+	if (amstate->height == UINT_MAX)
+		elog(ERROR, "supplied array-matrix is too big");
+	expand_array_matrix_state(amstate, nitems, amstate->height + 1);
+
+	switch (amstate->typlen)
+	{
+		case sizeof(cl_uchar):
+			ARRAY_MATRIX_STATE_APPEND_TEMPLATE(amstate,src,nitems,cl_uchar);
+			break;
+		case sizeof(cl_ushort):
+			ARRAY_MATRIX_STATE_APPEND_TEMPLATE(amstate,src,nitems,cl_ushort);
+			break;
+		case sizeof(cl_uint):
+			ARRAY_MATRIX_STATE_APPEND_TEMPLATE(amstate,src,nitems,cl_uint);
+			break;
+		case sizeof(cl_ulong):
+			ARRAY_MATRIX_STATE_APPEND_TEMPLATE(amstate,src,nitems,cl_ulong);
+			break;
+		default:
+			elog(ERROR, "unexpected element length: %d", amstate->typlen);
+	}
+	amstate->height++;
+}
+
 Datum
 array_matrix_accum(PG_FUNCTION_ARGS)
 {
@@ -151,8 +294,7 @@ array_matrix_accum(PG_FUNCTION_ARGS)
 	if (PG_ARGISNULL(1))
 		elog(ERROR, "null-array was supplied");
 
-	oldcxt = MemoryContextSwitchTo(aggcxt);
-	V = (VectorType *)PG_GETARG_ARRAYTYPE_P_COPY(1);
+	V = (VectorType *)PG_GETARG_ARRAYTYPE_P(1);
 
 	/* validation */
 	if (ARR_ELEMTYPE(V) != BOOLOID &&
@@ -166,19 +308,17 @@ array_matrix_accum(PG_FUNCTION_ARGS)
 	if (!VALIDATE_ARRAY_VECTOR(V))
 		elog(ERROR, "input was not vector-like array");
 	nitems = ARRAY_VECTOR_HEIGHT(V);
+
+	oldcxt = MemoryContextSwitchTo(aggcxt);
 	if (PG_ARGISNULL(0))
-	{
-		amstate = palloc0(sizeof(array_matrix_state));
-		amstate->elemtype = V->elemtype;
-	}
+		amstate = create_array_matrix_state(V->elemtype);
 	else
 	{
 		amstate = (array_matrix_state *)PG_GETARG_POINTER(0);
 		if (amstate->elemtype != ARR_ELEMTYPE(V))
 			elog(ERROR, "vector like array has wrong data type");
 	}
-	amstate->width = Max(amstate->width, nitems);
-	amstate->rows = lappend(amstate->rows, V);
+	append_array_matrix_state(amstate, ARR_DATA_PTR(V), nitems);
 
 	MemoryContextSwitchTo(oldcxt);
 
@@ -253,81 +393,207 @@ array_matrix_accum_varbit(PG_FUNCTION_ARGS)
 	if (!AggCheckCallContext(fcinfo, &aggcxt))
 		elog(ERROR, "aggregate function called in non-aggregate context");
 
-	oldcxt = MemoryContextSwitchTo(aggcxt);
 	if (!PG_ARGISNULL(1))
 		varbit = PG_GETARG_VARBIT_P(1);
 	V = __varbit_to_int_vector(varbit);
 
+	oldcxt = MemoryContextSwitchTo(aggcxt);
 	if (PG_ARGISNULL(0))
+		amstate = create_array_matrix_state(INT4OID);
+	else
+		amstate = (array_matrix_state *)PG_GETARG_POINTER(0);
+	append_array_matrix_state(amstate, ARR_DATA_PTR(V),
+							  ARRAY_VECTOR_HEIGHT(V));
+	MemoryContextSwitchTo(oldcxt);
+
+	pfree(V);
+
+	PG_RETURN_POINTER(amstate);
+}
+PG_FUNCTION_INFO_V1(array_matrix_accum_varbit);
+
+/*
+ * array_matrix_combine
+ *
+ * It appends the rows of the second state to the first one, for partial
+ * and parallel aggregation.
+ */
+Datum
+array_matrix_combine(PG_FUNCTION_ARGS)
+{
+	array_matrix_state *amstate1;
+	array_matrix_state *amstate2;
+	MemoryContext	aggcxt;
+	MemoryContext	oldcxt;
+	Size			typlen;
+	cl_uint			height;
+	cl_uint			i;
+
+	if (!AggCheckCallContext(fcinfo, &aggcxt))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+	if (PG_ARGISNULL(1))
 	{
-		amstate = palloc0(sizeof(array_matrix_state));
-		amstate->elemtype = INT4OID;
+		if (PG_ARGISNULL(0))
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(PG_GETARG_POINTER(0));
 	}
+	amstate2 = (array_matrix_state *)PG_GETARG_POINTER(1);
+
+	oldcxt = MemoryContextSwitchTo(aggcxt);
+	if (PG_ARGISNULL(0))
+		amstate1 = create_array_matrix_state(amstate2->elemtype);
 	else
-		amstate = (array_matrix_state *)PG_GETARG_POINTER(0);
+	{
+		amstate1 = (array_matrix_state *)PG_GETARG_POINTER(0);
+		if (amstate1->elemtype != amstate2->elemtype)
+			elog(ERROR, "vector like array has wrong data type");
+	}
+	if ((Size)amstate1->height + (Size)amstate2->height > UINT_MAX)
+		elog(ERROR, "supplied array-matrix is too big");
+	height = amstate1->height + amstate2->height;
+	expand_array_matrix_state(amstate1, amstate2->width, height);
+
+	typlen = amstate1->typlen;
+	for (i=0; amstate2->height > 0 && i < amstate1->width; i++)
+	{
+		char   *dst = (amstate1->values +
+					   typlen * ((Size)amstate1->nrooms * i +
+								 amstate1->height));
+
+		if (i < amstate2->width)
+			memcpy(dst, (amstate2->values +
+						 typlen * (Size)amstate2->nrooms * i),
+				   typlen * amstate2->height);
+		else
+			memset(dst, 0, typlen * amstate2->height);
+	}
+	amstate1->height = height;
+	MemoryContextSwitchTo(oldcxt);
+
+	PG_RETURN_POINTER(amstate1);
+}
+PG_FUNCTION_INFO_V1(array_matrix_combine);
+
+/*
+ * array_matrix_serialize / array_matrix_deserialize
+ *
+ * Serialized form of array_matrix_state is a bytea that contains the
+ * header (elemtype, width and height) followed by the columns.
+ */
+typedef struct
+{
+	int32		vl_len_;
+	Oid			elemtype;
+	cl_uint		width;
+	cl_uint		height;
+	char		values[FLEXIBLE_ARRAY_MEMBER];
+} array_matrix_serial;
+
+Datum
+array_matrix_serialize(PG_FUNCTION_ARGS)
+{
+	array_matrix_state *amstate;
+	array_matrix_serial *amserial;
+	Size		length;
+	Size		unitsz;
+	cl_uint		i;
 
-	amstate->width = Max(amstate->width, ARRAY_VECTOR_HEIGHT(V));
-	amstate->rows = lappend(amstate->rows, V);
+	if (!AggCheckCallContext(fcinfo, NULL))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+	amstate = (array_matrix_state *)PG_GETARG_POINTER(0);
 
+	unitsz = amstate->typlen * (Size)amstate->height;
+	length = offsetof(array_matrix_serial, values) + unitsz * amstate->width;
+	if (!AllocSizeIsValid(length))
+		elog(ERROR, "supplied array-matrix is too big");
+	amserial = palloc(length);
+	SET_VARSIZE(amserial, length);
+	amserial->elemtype = amstate->elemtype;
+	amserial->width = amstate->width;
+	amserial->height = amstate->height;
+	for (i=0; i < amstate->width; i++)
+		memcpy(amserial->values + unitsz * i,
+			   amstate->values + amstate->typlen * (Size)amstate->nrooms * i,
+			   unitsz);
+	PG_RETURN_BYTEA_P(amserial);
+}
+PG_FUNCTION_INFO_V1(array_matrix_serialize);
+
+Datum
+array_matrix_deserialize(PG_FUNCTION_ARGS)
+{
+	array_matrix_serial *amserial;
+	array_matrix_state *amstate;
+	MemoryContext	aggcxt;
+	MemoryContext	oldcxt;
+	Size			length;
+
+	if (!AggCheckCallContext(fcinfo, &aggcxt))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+	amserial = (array_matrix_serial *)PG_GETARG_BYTEA_P(0);
+
+	oldcxt = MemoryContextSwitchTo(aggcxt);
+	amstate = create_array_matrix_state(amserial->elemtype);
+	length = amstate->typlen * (Size)amserial->height * amserial->width;
+	if (VARSIZE(amserial) != offsetof(array_matrix_serial, values) + length)
+		elog(ERROR, "corrupted array-matrix state");
+	if (amserial->height > 0 && amserial->width > 0)
+	{
+		amstate->values = MemoryContextAllocHuge(aggcxt, length);
+		memcpy(amstate->values, amserial->values, length);
+	}
+	amstate->width = amserial->width;
+	amstate->height = amserial->height;
+	amstate->nrooms = amserial->height;
 	MemoryContextSwitchTo(oldcxt);
 
 	PG_RETURN_POINTER(amstate);
 }
-PG_FUNCTION_INFO_V1(array_matrix_accum_varbit);
+PG_FUNCTION_INFO_V1(array_matrix_deserialize);
 
-#define ARRAY_MATRIX_FINAL_TEMPLATE(R,amstate,BASETYPE)					\
-	do {																\
-		Size		width = (amstate)->width;							\
-		Size		height = list_length((amstate)->rows);				\
-		Size		length;												\
-		Size		row_index;											\
-		int16		typlen;												\
-		bool		typbyval;											\
-		ListCell   *lc;													\
-																		\
-		get_typlenbyval((amstate)->elemtype,							\
-						&typlen, &typbyval);							\
-		Assert(typlen == sizeof(BASETYPE));								\
-		length = ARRAY_MATRIX_RAWSIZE(typlen, height, width);			\
-		if (!AllocSizeIsValid(length))									\
-			elog(ERROR, "supplied array-matrix is too big");			\
-		R = palloc(length);												\
-		if (width == 1)													\
-			INIT_ARRAY_VECTOR(R, (amstate)->elemtype, typlen, height);	\
-		else															\
-			INIT_ARRAY_MATRIX(R, (amstate)->elemtype,					\
-							  typlen, height, width);					\
-		row_index = 0;													\
-		foreach (lc, (amstate)->rows)									\
-		{																\
-			ArrayType  *V = lfirst(lc);									\
-			Size		i, nitems;										\
-			BASETYPE   *src;											\
-			BASETYPE   *dst;											\
-																		\
-			/* sanity checks */											\
-			Assert(VALIDATE_ARRAY_VECTOR_TYPE(V, (amstate)->elemtype));	\
-			src = ((BASETYPE *)ARR_DATA_PTR(V));						\
-			dst = ((BASETYPE *)ARR_DATA_PTR(R)) + row_index;			\
-			nitems = ARRAY_VECTOR_HEIGHT(V);							\
-			for (i=0; i < nitems; i++, src++, dst += height)			\
-				*dst = *src;											\
-			row_index++;												\
-		}																\
-	} while(0)
+/*
+ * array_matrix_final_common
+ */
+static ArrayType *
+array_matrix_final_common(array_matrix_state *amstate)
+{
+	Size		width = amstate->width;
+	Size		height = amstate->height;
+	Size		typlen = amstate->typlen;
+	Size		length;
+	ArrayType  *R;
+	Size		i;
+
+	length = ARRAY_MATRIX_RAWSIZE(typlen, height, width);
+	if (!AllocSizeIsValid(length))
+		elog(ERROR, "supplied array-matrix is too big");
+	R = palloc(length);
+	if (width == 1)
+		INIT_ARRAY_VECTOR(R, amstate->elemtype, typlen, height);
+	else
+		INIT_ARRAY_MATRIX(R, amstate->elemtype, typlen, height, width);
+	if (amstate->nrooms == height)
+		memcpy(ARR_DATA_PTR(R), amstate->values, typlen * height * width);
+	else
+	{
+		for (i=0; i < width; i++)
+			memcpy(ARR_DATA_PTR(R) + typlen * height * i,
+				   amstate->values + typlen * amstate->nrooms * i,
+				   typlen * height);
+	}
+	return R;
+}
 
 Datum
 array_matrix_final_bool(PG_FUNCTION_ARGS)
 {
 	array_matrix_state *amstate;
-	ArrayType *R;
 
 	if (PG_ARGISNULL(0))
 		PG_RETURN_NULL();
 	amstate = (array_matrix_state *)PG_GETARG_POINTER(0);
 	Assert(amstate->elemtype == BOOLOID);
-	ARRAY_MATRIX_FINAL_TEMPLATE(R,amstate,cl_uchar);
-	PG_RETURN_POINTER(R);
+	PG_RETURN_POINTER(array_matrix_final_common(amstate));
 }
 PG_FUNCTION_INFO_V1(array_matrix_final_bool);
 
@@ -335,14 +601,12 @@ Datum
 array_matrix_final_int2(PG_FUNCTION_ARGS)
 {
 	array_matrix_state *amstate;
-	ArrayType *R;
 
 	if (PG_ARGISNULL(0))
 		PG_RETURN_NULL();
 	amstate = (array_matrix_state *)PG_GETARG_POINTER(0);
 	Assert(amstate->elemtype == INT2OID);
-	ARRAY_MATRIX_FINAL_TEMPLATE(R,amstate,cl_ushort);
-	PG_RETURN_POINTER(R);
+	PG_RETURN_POINTER(array_matrix_final_common(amstate));
 }
 PG_FUNCTION_INFO_V1(array_matrix_final_int2);
 
@@ -350,14 +614,12 @@ Datum
 array_matrix_final_int4(PG_FUNCTION_ARGS)
 {
 	array_matrix_state *amstate;
-	ArrayType *R;
 
 	if (PG_ARGISNULL(0))
 		PG_RETURN_NULL();
 	amstate = (array_matrix_state *)PG_GETARG_POINTER(0);
 	Assert(amstate->elemtype == INT4OID);
-	ARRAY_MATRIX_FINAL_TEMPLATE(R,amstate,cl_uint);
-	PG_RETURN_POINTER(R);
+	PG_RETURN_POINTER(array_matrix_final_common(amstate));
 }
 PG_FUNCTION_INFO_V1(array_matrix_final_int4);
 
@@ -365,14 +627,12 @@ Datum
 array_matrix_final_int8(PG_FUNCTION_ARGS)
 {
 	array_matrix_state *amstate;
-	ArrayType *R;
 
 	if (PG_ARGISNULL(0))
 		PG_RETURN_NULL();
 	amstate = (array_matrix_state *)PG_GETARG_POINTER(0);
 	Assert(amstate->elemtype == INT8OID);
-	ARRAY_MATRIX_FINAL_TEMPLATE(R,amstate,cl_ulong);
-	PG_RETURN_POINTER(R);
+	PG_RETURN_POINTER(array_matrix_final_common(amstate));
 }
 PG_FUNCTION_INFO_V1(array_matrix_final_int8);
 
@@ -380,14 +640,12 @@ Datum
 array_matrix_final_float4(PG_FUNCTION_ARGS)
 {
 	array_matrix_state *amstate;
-	ArrayType *R;
 
 	if (PG_ARGISNULL(0))
 		PG_RETURN_NULL();
 	amstate = (array_matrix_state *)PG_GETARG_POINTER(0);
 	Assert(amstate->elemtype == FLOAT4OID);
-	ARRAY_MATRIX_FINAL_TEMPLATE(R,amstate,cl_uint);
-	PG_RETURN_POINTER(R);
+	PG_RETURN_POINTER(array_matrix_final_common(amstate));
 }
 PG_FUNCTION_INFO_V1(array_matrix_final_float4);
 
@@ -395,14 +653,12 @@ Datum
 array_matrix_final_float8(PG_FUNCTION_ARGS)
 {
 	array_matrix_state *amstate;
-	ArrayType *R;
 
 	if (PG_ARGISNULL(0))
 		PG_RETURN_NULL();
 	amstate = (array_matrix_state *)PG_GETARG_POINTER(0);
 	Assert(amstate->elemtype == FLOAT8OID);
-	ARRAY_MATRIX_FINAL_TEMPLATE(R,amstate,cl_ulong);
-	PG_RETURN_POINTER(R);
+	PG_RETURN_POINTER(array_matrix_final_common(amstate));
 }
 PG_FUNCTION_INFO_V1(array_matrix_final_float8);
 
@@ -927,26 +1183,35 @@ array_martix_cbind(Oid elemtype, ArrayType *X, ArrayType *Y)
 	R = palloc(length);
 	INIT_ARRAY_MATRIX(R, elemtype, typlen, r_height, r_width);
 
+	/* columns are contiguous if height is identical, so block copy */
 	src = ARR_DATA_PTR(X);
 	dst = ARR_DATA_PTR(R);
-	for (i=0; i < x_width; i++)
+	if (x_height == r_height)
+		memcpy(dst, src, typlen * x_height * x_width);
+	else
 	{
-		memcpy(dst, src, typlen * x_height);
-		if (x_height < r_height)
+		for (i=0; i < x_width; i++)
+		{
+			memcpy(dst, src, typlen * x_height);
 			memset(dst + typlen * x_height, 0, typlen * (r_height - x_height));
-		src += typlen * x_height;
-		dst += typlen * r_height;
+			src += typlen * x_height;
+			dst += typlen * r_height;
+		}
 	}
 
 	src = ARR_DATA_PTR(Y);
 	dst = ARR_DATA_PTR(R) + typlen * x_width * r_height;
-	for (i=0; i < y_width; i++)
+	if (y_height == r_height)
+		memcpy(dst, src, typlen * y_height * y_width);
+	else
 	{
-		memcpy(dst, src, typlen * y_height);
-		if (y_height < r_height)
+		for (i=0; i < y_width; i++)
+		{
+			memcpy(dst, src, typlen * y_height);
 			memset(dst + typlen * y_height, 0, typlen * (r_height - y_height));
-		src += typlen * y_height;
-		dst += typlen * r_height;
+			src += typlen * y_height;
+			dst += typlen * r_height;
+		}
 	}
 	return R;
 }
@@ -1534,6 +1799,13 @@ array_matrix_cbind_final(matrix_cbind_state *mcstate)
 
 		Assert(VALIDATE_ARRAY_MATRIX(X));
 		src = ARR_DATA_PTR(X);
+		if (x_height == height)
+		{
+			/* columns are contiguous, so a block copy is sufficient */
+			memcpy(dst, src, typlen * x_height * x_width);
+			dst += typlen * x_height * x_width;
+			continue;
+		}
 		for (i=0; i < x_width; i++)
 		{
 			memcpy(dst, src, typlen * x_height);
@@ -1627,15 +1899,141 @@ PG_FUNCTION_INFO_V1(array_matrix_cbind_final_float8);
 
 /*
  * matrix_transpose
+ *
+ * Element-by-element transpose writes the destination with the stride
+ * of the matrix width, so large matrices thrash the cache. We walk the
+ * source matrix by tiles that fit in L1 cache together with the
+ * destination, and transpose 4x4 (4-bytes) or 2x2 (8-bytes) blocks in
+ * the SSE2 registers, if available.
  */
-#define ARRAY_MATRIX_TRANSPOSE_TEMPLATE(T,M,BASETYPE)					\
+#define MATRIX_TRANSPOSE_TILESZ		32
+
+#define MATRIX_TRANSPOSE_SCALAR(BASETYPE,T,M,height,width,r0,r1,c0,c1)	\
+	do {																\
+		Size	__r, __c;												\
+																		\
+		for (__r=(r0); __r < (r1); __r++)								\
+		{																\
+			BASETYPE	   *__dst = (T) + __r * (width);				\
+			const BASETYPE *__src = (M) + __r;							\
+																		\
+			for (__c=(c0); __c < (c1); __c++)							\
+				__dst[__c] = __src[__c * (height)];						\
+		}																\
+	} while(0)
+
+#define MATRIX_TRANSPOSE_TILED_TEMPLATE(NAME,BASETYPE)					\
+	static void															\
+	matrix_transpose_##NAME(BASETYPE *T, const BASETYPE *M,				\
+							Size height, Size width)					\
+	{																	\
+		Size	rb, re, cb, ce;											\
+																		\
+		for (cb=0; cb < width; cb += MATRIX_TRANSPOSE_TILESZ)			\
+		{																\
+			ce = Min(cb + MATRIX_TRANSPOSE_TILESZ, width);				\
+			for (rb=0; rb < height; rb += MATRIX_TRANSPOSE_TILESZ)		\
+			{															\
+				re = Min(rb + MATRIX_TRANSPOSE_TILESZ, height);			\
+				MATRIX_TRANSPOSE_SCALAR(BASETYPE,T,M,height,width,		\
+										rb,re,cb,ce);					\
+			}															\
+		}																\
+	}
+
+MATRIX_TRANSPOSE_TILED_TEMPLATE(1b,cl_uchar)
+MATRIX_TRANSPOSE_TILED_TEMPLATE(2b,cl_ushort)
+#ifndef __SSE2__
+MATRIX_TRANSPOSE_TILED_TEMPLATE(4b,cl_uint)
+MATRIX_TRANSPOSE_TILED_TEMPLATE(8b,cl_ulong)
+#else
+static void
+matrix_transpose_4b(cl_uint *T, const cl_uint *M, Size height, Size width)
+{
+	Size		rb, re, r4, r;
+	Size		cb, ce, c4, c;
+	__m128i		a0, a1, a2, a3;
+	__m128i		t0, t1, t2, t3;
+
+	for (cb=0; cb < width; cb += MATRIX_TRANSPOSE_TILESZ)
+	{
+		ce = Min(cb + MATRIX_TRANSPOSE_TILESZ, width);
+		c4 = cb + ((ce - cb) & ~3UL);
+		for (rb=0; rb < height; rb += MATRIX_TRANSPOSE_TILESZ)
+		{
+			re = Min(rb + MATRIX_TRANSPOSE_TILESZ, height);
+			r4 = rb + ((re - rb) & ~3UL);
+			for (c=cb; c < c4; c += 4)
+			{
+				for (r=rb; r < r4; r += 4)
+				{
+					/* 4 rows of the 4 source columns */
+					a0 = _mm_loadu_si128((const __m128i *)(M + (c+0) * height + r));
+					a1 = _mm_loadu_si128((const __m128i *)(M + (c+1) * height + r));
+					a2 = _mm_loadu_si128((const __m128i *)(M + (c+2) * height + r));
+					a3 = _mm_loadu_si128((const __m128i *)(M + (c+3) * height + r));
+					t0 = _mm_unpacklo_epi32(a0, a1);
+					t1 = _mm_unpackhi_epi32(a0, a1);
+					t2 = _mm_unpacklo_epi32(a2, a3);
+					t3 = _mm_unpackhi_epi32(a2, a3);
+					_mm_storeu_si128((__m128i *)(T + (r+0) * width + c),
+									 _mm_unpacklo_epi64(t0, t2));
+					_mm_storeu_si128((__m128i *)(T + (r+1) * width + c),
+									 _mm_unpackhi_epi64(t0, t2));
+					_mm_storeu_si128((__m128i *)(T + (r+2) * width + c),
+									 _mm_unpacklo_epi64(t1, t3));
+					_mm_storeu_si128((__m128i *)(T + (r+3) * width + c),
+									 _mm_unpackhi_epi64(t1, t3));
+				}
+			}
+			/* remaining edges of the tile */
+			MATRIX_TRANSPOSE_SCALAR(cl_uint,T,M,height,width,rb,r4,c4,ce);
+			MATRIX_TRANSPOSE_SCALAR(cl_uint,T,M,height,width,r4,re,cb,ce);
+		}
+	}
+}
+
+static void
+matrix_transpose_8b(cl_ulong *T, const cl_ulong *M, Size height, Size width)
+{
+	Size		rb, re, r2, r;
+	Size		cb, ce, c2, c;
+	__m128i		a0, a1;
+
+	for (cb=0; cb < width; cb += MATRIX_TRANSPOSE_TILESZ)
+	{
+		ce = Min(cb + MATRIX_TRANSPOSE_TILESZ, width);
+		c2 = cb + ((ce - cb) & ~1UL);
+		for (rb=0; rb < height; rb += MATRIX_TRANSPOSE_TILESZ)
+		{
+			re = Min(rb + MATRIX_TRANSPOSE_TILESZ, height);
+			r2 = rb + ((re - rb) & ~1UL);
+			for (c=cb; c < c2; c += 2)
+			{
+				for (r=rb; r < r2; r += 2)
+				{
+					/* 2 rows of the 2 source columns */
+					a0 = _mm_loadu_si128((const __m128i *)(M + (c+0) * height + r));
+					a1 = _mm_loadu_si128((const __m128i *)(M + (c+1) * height + r));
+					_mm_storeu_si128((__m128i *)(T + (r+0) * width + c),
+									 _mm_unpacklo_epi64(a0, a1));
+					_mm_storeu_si128((__m128i *)(T + (r+1) * width + c),
+									 _mm_unpackhi_epi64(a0, a1));
+				}
+			}
+			/* remaining edges of the tile */
+			MATRIX_TRANSPOSE_SCALAR(cl_ulong,T,M,height,width,rb,r2,c2,ce);
+			MATRIX_TRANSPOSE_SCALAR(cl_ulong,T,M,height,width,r2,re,cb,ce);
+		}
+	}
+}
+#endif	/* __SSE2__ */
+
+#define ARRAY_MATRIX_TRANSPOSE_TEMPLATE(T,M,BASETYPE,NAME)				\
 	do {																\
 		Size	height = ARRAY_MATRIX_HEIGHT(M);						\
 		Size	width = ARRAY_MATRIX_WIDTH(M);							\
-		Size	i, nitems = width * height;								\
 		Size	length;													\
-		char   *T_values;												\
-		char   *M_values = ARR_DATA_PTR(M);								\
 																		\
 		length = ARRAY_MATRIX_RAWSIZE(sizeof(BASETYPE), height, width);	\
 		if (!AllocSizeIsValid(length))									\
@@ -1643,13 +2041,9 @@ PG_FUNCTION_INFO_V1(array_matrix_cbind_final_float8);
 		T = palloc(length);												\
 		INIT_ARRAY_MATRIX(T, ARR_ELEMTYPE(M),							\
 						  sizeof(BASETYPE), width, height);				\
-		T_values = ARR_DATA_PTR(T);										\
-		for (i=0; i < nitems; i++)										\
-		{																\
-			*((BASETYPE *)(T_values + sizeof(BASETYPE) *				\
-						   ((i % height) * width + (i / height)))) =	\
-				*((BASETYPE *)(M_values + sizeof(BASETYPE) * i));		\
-		}																\
+		matrix_transpose_##NAME((BASETYPE *)ARR_DATA_PTR(T),			\
+								(const BASETYPE *)ARR_DATA_PTR(M),		\
+								height, width);							\
 	} while(0)
 
 Datum
@@ -1662,7 +2056,7 @@ array_matrix_transpose_bool(PG_FUNCTION_ARGS)
 		!VALIDATE_ARRAY_MATRIX(matrix))
 		elog(ERROR, "Array is not like Matrix");
 	Assert(matrix->elemtype == BOOLOID);
-	ARRAY_MATRIX_TRANSPOSE_TEMPLATE(result,matrix,cl_uchar);
+	ARRAY_MATRIX_TRANSPOSE_TEMPLATE(result,matrix,cl_uchar,1b);
 	PG_RETURN_POINTER(result);
 }
 PG_FUNCTION_INFO_V1(array_matrix_transpose_bool);
@@ -1677,7 +2071,7 @@ array_matrix_transpose_int2(PG_FUNCTION_ARGS)
 		!VALIDATE_ARRAY_MATRIX(matrix))
 		elog(ERROR, "Array is not like Matrix");
 	Assert(matrix->elemtype == INT2OID);
-	ARRAY_MATRIX_TRANSPOSE_TEMPLATE(result,matrix,cl_ushort);
+	ARRAY_MATRIX_TRANSPOSE_TEMPLATE(result,matrix,cl_ushort,2b);
 	PG_RETURN_POINTER(result);
 }
 PG_FUNCTION_INFO_V1(array_matrix_transpose_int2);
@@ -1692,7 +2086,7 @@ array_matrix_transpose_int4(PG_FUNCTION_ARGS)
 		!VALIDATE_ARRAY_MATRIX(matrix))
 		elog(ERROR, "Array is not like Matrix");
 	Assert(matrix->elemtype == INT4OID);
-	ARRAY_MATRIX_TRANSPOSE_TEMPLATE(result,matrix,cl_ushort);
+	ARRAY_MATRIX_TRANSPOSE_TEMPLATE(result,matrix,cl_uint,4b);
 	PG_RETURN_POINTER(result);
 }
 PG_FUNCTION_INFO_V1(array_matrix_transpose_int4);
@@ -1707,7 +2101,7 @@ array_matrix_transpose_int8(PG_FUNCTION_ARGS)
 		!VALIDATE_ARRAY_MATRIX(matrix))
 		elog(ERROR, "Array is not like Matrix");
 	Assert(matrix->elemtype == INT8OID);
-	ARRAY_MATRIX_TRANSPOSE_TEMPLATE(result,matrix,cl_ushort);
+	ARRAY_MATRIX_TRANSPOSE_TEMPLATE(result,matrix,cl_ulong,8b);
 	PG_RETURN_POINTER(result);
 }
 PG_FUNCTION_INFO_V1(array_matrix_transpose_int8);
@@ -1722,7 +2116,7 @@ array_matrix_transpose_float4(PG_FUNCTION_ARGS)
 		!VALIDATE_ARRAY_MATRIX(matrix))
 		elog(ERROR, "Array is not like Matrix");
 	Assert(matrix->elemtype == FLOAT4OID);
-	ARRAY_MATRIX_TRANSPOSE_TEMPLATE(result,matrix,cl_ushort);
+	ARRAY_MATRIX_TRANSPOSE_TEMPLATE(result,matrix,cl_uint,4b);
 	PG_RETURN_POINTER(result);
 }
 PG_FUNCTION_INFO_V1(array_matrix_transpose_float4);
@@ -1737,7 +2131,7 @@ array_matrix_transpose_float8(PG_FUNCTION_ARGS)
 		!VALIDATE_ARRAY_MATRIX(matrix))
 		elog(ERROR, "Array is not like Matrix");
 	Assert(matrix->elemtype == FLOAT8OID);
-	ARRAY_MATRIX_TRANSPOSE_TEMPLATE(result,matrix,cl_ushort);
+	ARRAY_MATRIX_TRANSPOSE_TEMPLATE(result,matrix,cl_ulong,8b);
 	PG_RETURN_POINTER(result);
 }
 PG_FUNCTION_INFO_V1(array_matrix_transpose_float8);
@@ -17,6 +17,8 @@
  * GNU General Public License for more details.
  */
 #include "pg_strom.h"
+#include "cuda_jsonlib.h"
+#include "cuda_numeric.h"
 
 /*
  * make_flat_ands_expr - similar to make_ands_explicit but it pulls up
@@ -943,3 +945,977 @@ pgstrom_random_daterange(PG_FUNCTION_ARGS)
 							 DateADTGetDatum(y));
 }
 PG_FUNCTION_INFO_V1(pgstrom_random_daterange);
+
+/*
+ * pgstrom_generate_table
+ *
+ * A set-returning function that generates synthetic rows for benchmarks.
+ * The caller gives the column definition list, and a spec string for each
+ * column. A spec string is a space separated list of key=value; 'dist'
+ * (uniform, normal, zipf or serial), 'param' (standard deviation relative
+ * to the width of the range for normal, exponent for zipf), 'lower' and
+ * 'upper' (bounds of the value), 'null' (NULL ratio in %) and 'template'
+ * (for inet and text). Values may be quoted by single-quotes.
+ *
+ * Unlike pgstrom.random_* functions, every value is derived from the
+ * (seed, column, row-id) using a counter-based PRNG, so the result is
+ * reproducible and independent from how the rows are split into the
+ * partitions (part/nparts). It allows to run several partitions
+ * concurrently; as non-partial subplans of Parallel Append on UNION ALL,
+ * or on individual sessions.
+ */
+#define GENTBL_DIST_UNIFORM		'u'
+#define GENTBL_DIST_NORMAL		'n'
+#define GENTBL_DIST_ZIPF		'z'
+#define GENTBL_DIST_SERIAL		's'
+
+#define GENTBL_BATCH_NROWS		1024
+#define GENTBL_MAX_DRAWS		64
+/* draw identifier of the PRNG within a row */
+#define GENTBL_DRAW(sub,index)	(((sub) << 8) | (index))
+
+typedef struct
+{
+	Oid			atttypid;
+	Oid			subtype;		/* element type if range, or atttypid */
+	TypeCacheEntry *typcache;	/* only range types */
+	char		dist;
+	double		param;
+	double		null_ratio;		/* in % */
+	cl_ulong	key;			/* PRNG key of the column */
+	/* domain of the ordinal values */
+	int64		lower;
+	cl_ulong	width;			/* upper - lower */
+	double		flower;			/* only float4/float8 */
+	double		fupper;
+	inet	   *template_inet;
+	text	   *template_text;
+	/* parameters of the zipf distribution */
+	double		zipf_hx1;
+	double		zipf_hn;
+	double		zipf_s;
+} gentbl_column;
+
+typedef struct
+{
+	int64		curr_row;
+	int64		end_row;
+	int			nrows;			/* number of rows in the current batch */
+	int			index;			/* next row in the current batch */
+	MemoryContext batch_cxt;
+	Datum	   *values;			/* column-major [nattrs x BATCH_NROWS] */
+	bool	   *isnull;
+	Datum	   *row_values;		/* [nattrs] */
+	bool	   *row_isnull;
+	int			nattrs;
+	gentbl_column columns[FLEXIBLE_ARRAY_MEMBER];
+} gentbl_state;
+
+Datum pgstrom_generate_table(PG_FUNCTION_ARGS);
+
+static inline cl_ulong
+gentbl_mix64(cl_ulong x)
+{
+	/* finalizer of SplitMix64 */
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9UL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebUL;
+	return x ^ (x >> 31);
+}
+
+static inline cl_ulong
+gentbl_rand64(gentbl_column *gcol, int64 row_id, cl_uint draw)
+{
+	cl_ulong	x = (cl_ulong)row_id * 0x9e3779b97f4a7c15UL + draw;
+
+	return gentbl_mix64(gcol->key ^ gentbl_mix64(x));
+}
+
+/* uniform random in [0,1) */
+static inline double
+gentbl_rand_double(gentbl_column *gcol, int64 row_id, cl_uint draw)
+{
+	return (double)(gentbl_rand64(gcol, row_id, draw) >> 11) / 9007199254740992.0;
+}
+
+/*
+ * Zipf distribution by the rejection-inversion method;
+ * W.Hormann and G.Derflinger, "Rejection-inversion to generate variates
+ * from monotone discrete distributions", ACM TOMACS 6(3), 1996.
+ */
+static inline double
+gentbl_zipf_helper1(double x)
+{
+	/* log(1+x)/x */
+	if (fabs(x) > 1e-8)
+		return log1p(x) / x;
+	return 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
+
+static inline double
+gentbl_zipf_helper2(double x)
+{
+	/* (exp(x)-1)/x */
+	if (fabs(x) > 1e-8)
+		return expm1(x) / x;
+	return 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+}
+
+static inline double
+gentbl_zipf_h(double s, double x)
+{
+	return exp(-s * log(x));
+}
+
+static inline double
+gentbl_zipf_hint(double s, double x)
+{
+	double		lx = log(x);
+
+	return gentbl_zipf_helper2((1.0 - s) * lx) * lx;
+}
+
+static inline double
+gentbl_zipf_hinv(double s, double x)
+{
+	double		t = x * (1.0 - s);
+
+	if (t < -1.0)
+		t = -1.0;
+	return exp(gentbl_zipf_helper1(t) * x);
+}
+
+static void
+gentbl_zipf_setup(gentbl_column *gcol)
+{
+	double		s = gcol->param;
+	double		n = (double)gcol->width + 1.0;
+
+	gcol->zipf_hx1 = gentbl_zipf_hint(s, 1.5) - 1.0;
+	gcol->zipf_hn  = gentbl_zipf_hint(s, n + 0.5);
+	gcol->zipf_s   = 2.0 - gentbl_zipf_hinv(s, gentbl_zipf_hint(s, 2.5) -
+											gentbl_zipf_h(s, 2.0));
+}
+
+/* returns rank in [0, width] */
+static cl_ulong
+gentbl_zipf_rank(gentbl_column *gcol, int64 row_id, int sub)
+{
+	double		s = gcol->param;
+	double		n = (double)gcol->width + 1.0;
+	double		u, x, k = 1.0;
+	int			i;
+
+	for (i=0; i < GENTBL_MAX_DRAWS; i++)
+	{
+		u = gentbl_rand_double(gcol, row_id, GENTBL_DRAW(sub, i));
+		u = gcol->zipf_hn + u * (gcol->zipf_hx1 - gcol->zipf_hn);
+		x = gentbl_zipf_hinv(s, u);
+		k = floor(x + 0.5);
+		if (k < 1.0)
+			k = 1.0;
+		else if (k > n)
+			k = n;
+		if (k - x <= gcol->zipf_s ||
+			u >= gentbl_zipf_hint(s, k + 0.5) - gentbl_zipf_h(s, k))
+			break;
+	}
+	if (k >= (double)gcol->width + 1.0)
+		return gcol->width;
+	return (cl_ulong)k - 1;
+}
+
+/*
+ * gentbl_fraction - [0,1) according to the uniform or normal distribution
+ */
+static double
+gentbl_fraction(gentbl_column *gcol, int64 row_id, int sub)
+{
+	double		u1 = 0.5, u2, z, t;
+	int			i;
+
+	if (gcol->dist != GENTBL_DIST_NORMAL)
+		return gentbl_rand_double(gcol, row_id, GENTBL_DRAW(sub, 0));
+
+	/* Box-Muller transform; re-draw if out of the range */
+	for (i=0; i < GENTBL_MAX_DRAWS; i += 2)
+	{
+		u1 = gentbl_rand_double(gcol, row_id, GENTBL_DRAW(sub, i));
+		u2 = gentbl_rand_double(gcol, row_id, GENTBL_DRAW(sub, i+1));
+		z = sqrt(-2.0 * log(1.0 - u1)) * cos(2.0 * M_PI * u2);
+		t = 0.5 + z * gcol->param;
+		if (t >= 0.0 && t < 1.0)
+			return t;
+	}
+	return u1;
+}
+
+/*
+ * gentbl_ordinal - [0, width] according to the distribution
+ */
+static cl_ulong
+gentbl_ordinal(gentbl_column *gcol, int64 row_id, int sub)
+{
+	cl_ulong	nvalues = gcol->width + 1;	/* 0 means 2^64 */
+	cl_ulong	v;
+
+	switch (gcol->dist)
+	{
+		case GENTBL_DIST_SERIAL:
+			v = (cl_ulong)row_id;
+			break;
+		case GENTBL_DIST_ZIPF:
+			return gentbl_zipf_rank(gcol, row_id, sub);
+		case GENTBL_DIST_NORMAL:
+			v = (cl_ulong)(gentbl_fraction(gcol, row_id, sub) *
+						   ((double)gcol->width + 1.0));
+			return Min(v, gcol->width);
+		default:
+			v = gentbl_rand64(gcol, row_id, GENTBL_DRAW(sub, 0));
+			break;
+	}
+	return (nvalues == 0 ? v : v % nvalues);
+}
+
+/*
+ * gentbl_datum - makes a datum from the ordinal value
+ */
+static Datum
+gentbl_datum(gentbl_column *gcol, Oid type_oid, cl_ulong ord, int64 row_id)
+{
+	static const char *base32 = "ABCDEFGHIJKLMNOPQRSTUVWXYZ1234567890";
+	int64		ival = (int64)((cl_ulong)gcol->lower + ord);
+
+	switch (type_oid)
+	{
+		case INT2OID:
+			return Int16GetDatum(ival);
+		case INT4OID:
+			return Int32GetDatum(ival);
+		case INT8OID:
+			return Int64GetDatum(ival);
+		case DATEOID:
+			return DateADTGetDatum(ival);
+		case TIMEOID:
+			return TimeADTGetDatum(ival);
+		case TIMESTAMPOID:
+			return TimestampGetDatum(ival);
+		case TIMESTAMPTZOID:
+			return TimestampTzGetDatum(ival);
+		case TIMETZOID:
+			{
+				TimeTzADT  *temp = palloc(sizeof(TimeTzADT));
+				cl_ulong	r = gentbl_rand64(gcol, row_id, GENTBL_DRAW(3,0));
+
+				temp->time = ival;
+				temp->zone = ((int)(r % 23) - 11) * SECS_PER_HOUR;
+				return TimeTzADTPGetDatum(temp);
+			}
+		case MACADDROID:
+			{
+				macaddr	   *temp = palloc(sizeof(macaddr));
+
+				temp->a = (ival >> 40) & 0x00ff;
+				temp->b = (ival >> 32) & 0x00ff;
+				temp->c = (ival >> 24) & 0x00ff;
+				temp->d = (ival >> 16) & 0x00ff;
+				temp->e = (ival >>  8) & 0x00ff;
+				temp->f = (ival      ) & 0x00ff;
+				return MacaddrPGetDatum(temp);
+			}
+		case INETOID:
+			{
+				inet	   *temp;
+				int			i, j, bits;
+				cl_ulong	v = ord;
+
+				temp = palloc(VARSIZE(gcol->template_inet));
+				memcpy(temp, gcol->template_inet,
+					   VARSIZE(gcol->template_inet));
+				bits = ip_maxbits(temp) - ip_bits(temp);
+				for (i = ip_maxbits(temp) / 8 - 1, j = 0;
+					 bits > 0;
+					 i--, j++, bits -= 8)
+				{
+					/* more host bits than the ordinal value */
+					if (j > 0 && j % sizeof(cl_ulong) == 0)
+						v = gentbl_mix64(ord + j);
+					if (bits >= 8)
+						temp->inet_data.ipaddr[i] = (v & 0xff);
+					else
+					{
+						cl_uint		mask = (1 << bits) - 1;
+
+						temp->inet_data.ipaddr[i] &= ~(mask);
+						temp->inet_data.ipaddr[i] |= (v & mask);
+					}
+					v >>= 8;
+				}
+				ip_bits(temp) = ip_maxbits(temp);
+				return InetPGetDatum(temp);
+			}
+		case TEXTOID:
+			{
+				text	   *temp;
+				char	   *pos;
+				int			i, j, n;
+				cl_ulong	v = ord;
+
+				temp = palloc(VARSIZE(gcol->template_text));
+				memcpy(temp, gcol->template_text,
+					   VARSIZE(gcol->template_text));
+				n = VARSIZE(temp) - VARHDRSZ;
+				pos = VARDATA(temp);
+				for (i=0, j=0; i < n; i++, pos++)
+				{
+					if (*pos != '*')
+						continue;
+					/* more wildcards than the ordinal value */
+					if (j > 0 && j % 12 == 0)
+						v = gentbl_mix64(ord + j);
+					*pos = base32[v & 0x1f];
+					v >>= 5;
+					j++;
+				}
+				return PointerGetDatum(temp);
+			}
+		default:
+			elog(ERROR, "unexpected data type: %s", format_type_be(type_oid));
+	}
+	return 0;	/* not reachable */
+}
+
+/*
+ * gentbl_value - makes a value of the column
+ */
+static Datum
+gentbl_value(gentbl_column *gcol, int64 row_id)
+{
+	double		fval;
+
+	switch (gcol->atttypid)
+	{
+		case FLOAT4OID:
+		case FLOAT8OID:
+			if (gcol->dist == GENTBL_DIST_UNIFORM ||
+				gcol->dist == GENTBL_DIST_NORMAL)
+				fval = gcol->flower + (gentbl_fraction(gcol, row_id, 1) *
+									   (gcol->fupper - gcol->flower));
+			else
+				fval = gcol->flower + (double)gentbl_ordinal(gcol, row_id, 1);
+			if (gcol->atttypid == FLOAT4OID)
+				return Float4GetDatum((float4)fval);
+			return Float8GetDatum(fval);
+
+		case INT4RANGEOID:
+		case INT8RANGEOID:
+		case DATERANGEOID:
+		case TSRANGEOID:
+		case TSTZRANGEOID:
+			{
+				RangeBound	x, y;
+				cl_ulong	x_ord = gentbl_ordinal(gcol, row_id, 1);
+				cl_ulong	y_ord = gentbl_ordinal(gcol, row_id, 2);
+				cl_ulong	r = gentbl_rand64(gcol, row_id, GENTBL_DRAW(3,0));
+
+				if (x_ord > y_ord)
+				{
+					cl_ulong	temp = x_ord;
+
+					x_ord = y_ord;
+					y_ord = temp;
+				}
+				/* same ratio of infinite/inclusive as random_*range */
+				memset(&x, 0, sizeof(RangeBound));
+				x.val = gentbl_datum(gcol, gcol->subtype, x_ord, row_id);
+				x.infinite = ((r & 0x03ff) % 200 == 0);
+				x.inclusive = ((r >> 10) & 0x03) == 0;
+				x.lower = true;
+
+				memset(&y, 0, sizeof(RangeBound));
+				y.val = gentbl_datum(gcol, gcol->subtype, y_ord, row_id);
+				y.infinite = (((r >> 12) & 0x03ff) % 200 == 0);
+				y.inclusive = ((r >> 22) & 0x03) == 0;
+				y.lower = false;
+
+				return PointerGetDatum(make_range(gcol->typcache,
+												  &x, &y, false));
+			}
+		default:
+			return gentbl_datum(gcol, gcol->subtype,
+								gentbl_ordinal(gcol, row_id, 1), row_id);
+	}
+}
+
+/*
+ * gentbl_parse_spec - parses key=value list of the column spec
+ */
+static void
+gentbl_parse_spec(gentbl_column *gcol, const char *spec,
+				  char **p_lower, char **p_upper, char **p_template)
+{
+	const char *pos = spec;
+	bool		has_param = false;
+
+	gcol->dist = GENTBL_DIST_UNIFORM;
+	while (*pos != '\0')
+	{
+		StringInfoData key;
+		StringInfoData val;
+
+		if (isspace(*pos))
+		{
+			pos++;
+			continue;
+		}
+		initStringInfo(&key);
+		while (*pos != '\0' && *pos != '=' && !isspace(*pos))
+			appendStringInfoChar(&key, *pos++);
+		if (*pos++ != '=')
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("generate_table: invalid column spec \"%s\"",
+							spec),
+					 errhint("column spec has to be a list of key=value")));
+		initStringInfo(&val);
+		if (*pos == '\'')
+		{
+			for (pos++; ; pos++)
+			{
+				if (*pos == '\0')
+					ereport(ERROR,
+							(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+							 errmsg("generate_table: unterminated quoted string in \"%s\"",
+									spec)));
+				if (*pos == '\'')
+				{
+					if (pos[1] != '\'')
+						break;
+					pos++;
+				}
+				appendStringInfoChar(&val, *pos);
+			}
+			pos++;
+		}
+		else
+		{
+			while (*pos != '\0' && !isspace(*pos))
+				appendStringInfoChar(&val, *pos++);
+		}
+
+		if (strcmp(key.data, "dist") == 0)
+		{
+			if (strcmp(val.data, "uniform") == 0)
+				gcol->dist = GENTBL_DIST_UNIFORM;
+			else if (strcmp(val.data, "normal") == 0)
+				gcol->dist = GENTBL_DIST_NORMAL;
+			else if (strcmp(val.data, "zipf") == 0)
+				gcol->dist = GENTBL_DIST_ZIPF;
+			else if (strcmp(val.data, "serial") == 0)
+				gcol->dist = GENTBL_DIST_SERIAL;
+			else
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("generate_table: unknown distribution \"%s\"",
+								val.data),
+						 errhint("uniform, normal, zipf or serial is available")));
+		}
+		else if (strcmp(key.data, "param") == 0)
+		{
+			gcol->param = DatumGetFloat8(DirectFunctionCall1(float8in,
+											CStringGetDatum(val.data)));
+			has_param = true;
+		}
+		else if (strcmp(key.data, "null") == 0)
+		{
+			gcol->null_ratio = DatumGetFloat8(DirectFunctionCall1(float8in,
+											CStringGetDatum(val.data)));
+			if (gcol->null_ratio < 0.0 || gcol->null_ratio > 100.0)
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("generate_table: null ratio must be between 0 and 100")));
+		}
+		else if (strcmp(key.data, "lower") == 0)
+			*p_lower = val.data;
+		else if (strcmp(key.data, "upper") == 0)
+			*p_upper = val.data;
+		else if (strcmp(key.data, "template") == 0)
+			*p_template = val.data;
+		else
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("generate_table: unknown key \"%s\" in \"%s\"",
+							key.data, spec)));
+	}
+
+	if (gcol->dist == GENTBL_DIST_NORMAL)
+	{
+		if (!has_param)
+			gcol->param = 1.0 / 6.0;
+		else if (gcol->param <= 0.0 || gcol->param > 1.0)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("generate_table: param of normal distribution must be in (0, 1]")));
+	}
+	else if (gcol->dist == GENTBL_DIST_ZIPF)
+	{
+		if (!has_param)
+			gcol->param = 1.0;
+		else if (gcol->param <= 0.0)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("generate_table: param of zipf distribution must be positive")));
+	}
+}
+
+static Datum
+gentbl_input(Oid type_oid, char *str)
+{
+	Oid			typinput;
+	Oid			typioparam;
+
+	getTypeInputInfo(type_oid, &typinput, &typioparam);
+	return OidInputFunctionCall(typinput, str, typioparam, -1);
+}
+
+/*
+ * gentbl_setup_column - setup the domain of the ordinal values
+ */
+static void
+gentbl_setup_column(gentbl_column *gcol, const char *spec)
+{
+	char	   *lower_str = NULL;
+	char	   *upper_str = NULL;
+	char	   *template = NULL;
+	Oid			type_oid;
+	int64		lower;
+	int64		upper;
+
+	gentbl_parse_spec(gcol, spec, &lower_str, &upper_str, &template);
+
+	type_oid = gcol->subtype = gcol->atttypid;
+	switch (gcol->atttypid)
+	{
+		case INT4RANGEOID:
+		case INT8RANGEOID:
+		case DATERANGEOID:
+		case TSRANGEOID:
+		case TSTZRANGEOID:
+			gcol->typcache = lookup_type_cache(gcol->atttypid,
+											   TYPECACHE_RANGE_INFO);
+			type_oid = gcol->subtype = gcol->typcache->rngelemtype->type_id;
+			break;
+		case TIMETZOID:
+			/* bounds are given by time */
+			type_oid = TIMEOID;
+			break;
+		default:
+			break;
+	}
+
+	switch (gcol->subtype)
+	{
+		case INT2OID:
+			lower = (lower_str ? DatumGetInt16(gentbl_input(type_oid, lower_str)) : 0);
+			upper = (upper_str ? DatumGetInt16(gentbl_input(type_oid, upper_str)) : SHRT_MAX);
+			break;
+		case INT4OID:
+			lower = (lower_str ? DatumGetInt32(gentbl_input(type_oid, lower_str)) : 0);
+			upper = (upper_str ? DatumGetInt32(gentbl_input(type_oid, upper_str)) : INT_MAX);
+			break;
+		case INT8OID:
+			lower = (lower_str ? DatumGetInt64(gentbl_input(type_oid, lower_str)) : 0);
+			upper = (upper_str ? DatumGetInt64(gentbl_input(type_oid, upper_str)) : INT_MAX);
+			break;
+		case FLOAT4OID:
+		case FLOAT8OID:
+			gcol->flower = (lower_str ? DatumGetFloat8(gentbl_input(FLOAT8OID, lower_str)) : 0.0);
+			gcol->fupper = (upper_str ? DatumGetFloat8(gentbl_input(FLOAT8OID, upper_str)) : 1.0);
+			if (gcol->fupper < gcol->flower)
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("generate_table: lower bound is larger than upper")));
+			/* zipf/serial walks on the integer steps */
+			lower = 0;
+			upper = (int64)Min(gcol->fupper - gcol->flower, (double)LONG_MAX);
+			break;
+		case DATEOID:
+			if (lower_str)
+				lower = DatumGetDateADT(gentbl_input(type_oid, lower_str));
+			else
+				lower = date2j(2015, 1, 1) - POSTGRES_EPOCH_JDATE;
+			if (upper_str)
+				upper = DatumGetDateADT(gentbl_input(type_oid, upper_str));
+			else
+				upper = date2j(2025, 12, 31) - POSTGRES_EPOCH_JDATE;
+			break;
+		case TIMEOID:
+		case TIMETZOID:
+			lower = (lower_str ? DatumGetTimeADT(gentbl_input(type_oid, lower_str)) : 0);
+			upper = (upper_str ? DatumGetTimeADT(gentbl_input(type_oid, upper_str))
+					 : HOURS_PER_DAY * USECS_PER_HOUR - 1);
+			break;
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+			if (lower_str)
+				lower = DatumGetTimestamp(gentbl_input(type_oid, lower_str));
+			else
+				lower = (date2j(2015, 1, 1) - POSTGRES_EPOCH_JDATE) * USECS_PER_DAY;
+			if (upper_str)
+				upper = DatumGetTimestamp(gentbl_input(type_oid, upper_str));
+			else
+				upper = (date2j(2025, 1, 1) - POSTGRES_EPOCH_JDATE) * USECS_PER_DAY;
+			break;
+		case MACADDROID:
+			lower = 0xabcd00000000L;
+			upper = 0xabcdffffffffL;
+			if (lower_str || upper_str)
+			{
+				macaddr	   *temp;
+
+				if (lower_str)
+				{
+					temp = DatumGetMacaddrP(gentbl_input(type_oid, lower_str));
+					lower = (((int64)temp->a << 40) | ((int64)temp->b << 32) |
+							 ((int64)temp->c << 24) | ((int64)temp->d << 16) |
+							 ((int64)temp->e <<  8) | ((int64)temp->f));
+				}
+				if (upper_str)
+				{
+					temp = DatumGetMacaddrP(gentbl_input(type_oid, upper_str));
+					upper = (((int64)temp->a << 40) | ((int64)temp->b << 32) |
+							 ((int64)temp->c << 24) | ((int64)temp->d << 16) |
+							 ((int64)temp->e <<  8) | ((int64)temp->f));
+				}
+			}
+			break;
+		case INETOID:
+			{
+				int		bits;
+
+				if (!template)
+					template = "192.168.0.0/16";
+				gcol->template_inet =
+					DatumGetInetP(gentbl_input(type_oid, template));
+				bits = (ip_maxbits(gcol->template_inet) -
+						ip_bits(gcol->template_inet));
+				lower = 0;
+				upper = (bits < 63 ? (1L << bits) - 1 : LONG_MAX);
+			}
+			break;
+		case TEXTOID:
+			{
+				char   *pos;
+				int		bits = 0;
+
+				if (!template)
+					template = "test_**";
+				gcol->template_text = cstring_to_text(template);
+				for (pos = template; *pos != '\0'; pos++)
+				{
+					if (*pos == '*')
+						bits += 5;
+				}
+				lower = 0;
+				upper = (bits < 63 ? (1L << bits) - 1 : LONG_MAX);
+			}
+			break;
+		default:
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("generate_table: unsupported data type: %s",
+							format_type_be(gcol->atttypid))));
+	}
+	if (upper < lower)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("generate_table: lower bound is larger than upper")));
+	gcol->lower = lower;
+	gcol->width = (cl_ulong)upper - (cl_ulong)lower;
+
+	if (gcol->dist == GENTBL_DIST_ZIPF)
+		gentbl_zipf_setup(gcol);
+}
+
+/*
+ * gentbl_next_batch - generates values of the next batch column by column
+ */
+static void
+gentbl_next_batch(gentbl_state *gstate)
+{
+	MemoryContext oldcxt;
+	int			nrows = Min(gstate->end_row - gstate->curr_row,
+							GENTBL_BATCH_NROWS);
+	int			i, j;
+
+	MemoryContextReset(gstate->batch_cxt);
+	oldcxt = MemoryContextSwitchTo(gstate->batch_cxt);
+	for (j=0; j < gstate->nattrs; j++)
+	{
+		gentbl_column *gcol = &gstate->columns[j];
+		Datum	   *values = gstate->values + j * GENTBL_BATCH_NROWS;
+		bool	   *isnull = gstate->isnull + j * GENTBL_BATCH_NROWS;
+
+		for (i=0; i < nrows; i++)
+		{
+			int64	row_id = gstate->curr_row + i;
+
+			if (gcol->null_ratio > 0.0 &&
+				100.0 * gentbl_rand_double(gcol, row_id,
+										   GENTBL_DRAW(0,0)) < gcol->null_ratio)
+			{
+				values[i] = 0;
+				isnull[i] = true;
+			}
+			else
+			{
+				values[i] = gentbl_value(gcol, row_id);
+				isnull[i] = false;
+			}
+		}
+	}
+	MemoryContextSwitchTo(oldcxt);
+
+	gstate->curr_row += nrows;
+	gstate->nrows = nrows;
+	gstate->index = 0;
+}
+
+Datum
+pgstrom_generate_table(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *fncxt;
+	gentbl_state *gstate;
+	HeapTuple	tuple;
+	int			j;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		ArrayType  *specs = PG_GETARG_ARRAYTYPE_P(0);
+		int64		nrows = PG_GETARG_INT64(1);
+		int64		seed = PG_GETARG_INT64(2);
+		int32		part = PG_GETARG_INT32(3);
+		int32		nparts = PG_GETARG_INT32(4);
+		TupleDesc	tupdesc;
+		MemoryContext oldcxt;
+		Datum	   *spec_elems;
+		bool	   *spec_nulls;
+		int			nspecs;
+		int			nattrs;
+
+		fncxt = SRF_FIRSTCALL_INIT();
+		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
+
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("generate_table: column definition list is required")));
+		if (nrows < 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("generate_table: number of rows must not be negative")));
+		if (nparts < 1 || part < 0 || part >= nparts)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("generate_table: partition %d is out of range for %d partitions",
+							part, nparts)));
+		deconstruct_array(specs, TEXTOID, -1, false, 'i',
+						  &spec_elems, &spec_nulls, &nspecs);
+		nattrs = tupdesc->natts;
+		if (nspecs != nattrs)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("generate_table: %d column specs for %d columns",
+							nspecs, nattrs)));
+
+		gstate = palloc0(offsetof(gentbl_state, columns[nattrs]));
+		for (j=0; j < nattrs; j++)
+		{
+			gentbl_column *gcol = &gstate->columns[j];
+
+			gcol->atttypid = tupleDescAttr(tupdesc, j)->atttypid;
+			gcol->key = gentbl_mix64(gentbl_mix64((cl_ulong)seed) + j);
+			gentbl_setup_column(gcol, (spec_nulls[j]
+									   ? ""
+									   : TextDatumGetCString(spec_elems[j])));
+		}
+		gstate->nattrs = nattrs;
+		/* rows of this partition */
+		gstate->curr_row = part * (nrows / nparts) + Min(part, nrows % nparts);
+		gstate->end_row = gstate->curr_row + nrows / nparts
+			+ (part < nrows % nparts ? 1 : 0);
+		gstate->batch_cxt = AllocSetContextCreate(fncxt->multi_call_memory_ctx,
+												  "generate_table batch",
+												  ALLOCSET_DEFAULT_SIZES);
+		gstate->values = palloc(sizeof(Datum) * nattrs * GENTBL_BATCH_NROWS);
+		gstate->isnull = palloc(sizeof(bool) * nattrs * GENTBL_BATCH_NROWS);
+		gstate->row_values = palloc(sizeof(Datum) * nattrs);
+		gstate->row_isnull = palloc(sizeof(bool) * nattrs);
+
+		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
+		fncxt->user_fctx = gstate;
+		MemoryContextSwitchTo(oldcxt);
+	}
+	fncxt = SRF_PERCALL_SETUP();
+	gstate = fncxt->user_fctx;
+
+	if (gstate->index >= gstate->nrows)
+	{
+		if (gstate->curr_row >= gstate->end_row)
+			SRF_RETURN_DONE(fncxt);
+		gentbl_next_batch(gstate);
+	}
+	for (j=0; j < gstate->nattrs; j++)
+	{
+		gstate->row_values[j] =
+			gstate->values[j * GENTBL_BATCH_NROWS + gstate->index];
+		gstate->row_isnull[j] =
+			gstate->isnull[j * GENTBL_BATCH_NROWS + gstate->index];
+	}
+	gstate->index++;
+	tuple = heap_form_tuple(fncxt->tuple_desc,
+							gstate->row_values,
+							gstate->row_isnull);
+
+	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
+}
+PG_FUNCTION_INFO_V1(pgstrom_generate_table);
+
+/*
+ * pgstrom_jsonb_devlib_check
+ *
+ * It walks on the jsonb document according to the path, using the common
+ * routines of cuda_jsonlib.h built for the host, then returns the scalar
+ * value in text form, as jsonb #>> text[] operator doing. Container values
+ * are not supported on the device, so it returns NULL instead.
+ * It is only for the regression test of the device library.
+ */
+#if PG_VERSION_NUM < 110000
+#define PG_GETARG_JSONB_P(x)	PG_GETARG_JSONB(x)
+#endif
+
+Datum
+pgstrom_jsonb_devlib_check(PG_FUNCTION_ARGS)
+{
+	Jsonb	   *jb = PG_GETARG_JSONB_P(0);
+	ArrayType  *path = PG_GETARG_ARRAYTYPE_P(1);
+	Datum	   *path_elems;
+	bool	   *path_nulls;
+	int			i, npath;
+	const char *jc = (const char *) &jb->root;
+	kern_jsonb_value jval;
+	char	   *buf;
+	int			bufsz;
+	int			len;
+
+	deconstruct_array(path, TEXTOID, -1, false, 'i',
+					  &path_elems, &path_nulls, &npath);
+	if (JB_ROOT_IS_SCALAR(jb))
+	{
+		if (npath > 0)
+			PG_RETURN_NULL();
+		__jsonb_fetch_value(jc, 0, &jval);
+	}
+	else
+	{
+		jval.type = JENTRY_ISCONTAINER;
+		jval.data = jc;
+		jval.len = VARSIZE(jb) - VARHDRSZ;
+	}
+
+	for (i=0; i < npath; i++)
+	{
+		text	   *elem;
+		cl_uint		header;
+		cl_long		index;
+		bool		found;
+
+		if (path_nulls[i] || jval.type != JENTRY_ISCONTAINER)
+			PG_RETURN_NULL();
+		elem = DatumGetTextPP(path_elems[i]);
+		jc = jval.data;
+		header = __jsonb_fetch_uint32(jc);
+		if ((header & JB_FOBJECT) != 0)
+			found = __jsonb_find_key(jc,
+									 VARDATA_ANY(elem),
+									 VARSIZE_ANY_EXHDR(elem),
+									 &jval);
+		else if ((header & JB_FARRAY) != 0 &&
+				 __jsonb_parse_index(VARDATA_ANY(elem),
+									 VARSIZE_ANY_EXHDR(elem),
+									 &index))
+			found = __jsonb_find_index(jc, index, &jval);
+		else
+			found = false;
+		if (!found)
+			PG_RETURN_NULL();
+	}
+	if (jval.type == JENTRY_ISNULL ||
+		jval.type == JENTRY_ISCONTAINER)
+		PG_RETURN_NULL();
+
+	bufsz = 64;
+	for (;;)
+	{
+		buf = palloc(VARHDRSZ + bufsz);
+		len = __jsonb_scalar_to_cstring(&jval, buf + VARHDRSZ, bufsz);
+		if (len >= 0)
+			break;
+		pfree(buf);
+		bufsz *= 2;
+	}
+	SET_VARSIZE(buf, VARHDRSZ + len);
+
+	PG_RETURN_TEXT_P((text *) buf);
+}
+PG_FUNCTION_INFO_V1(pgstrom_jsonb_devlib_check);
+
+/*
+ * pgstrom_numeric_devlib_check
+ *
+ * It applies the supplied operator ('+', '-', '*' or 'cmp') on the numeric
+ * arguments, using the fixed-point arithmetic of cuda_numeric.h built for
+ * the host, so the results can be compared to PostgreSQL's numeric ones.
+ * It returns NULL if device code would raise CpuReCheck error.
+ * It is only for the regression test of the device library.
+ */
+Datum
+pgstrom_numeric_devlib_check(PG_FUNCTION_ARGS)
+{
+	char	   *op = text_to_cstring(PG_GETARG_TEXT_PP(0));
+	struct varlena *vl1 = PG_DETOAST_DATUM_PACKED(PG_GETARG_DATUM(1));
+	struct varlena *vl2 = PG_DETOAST_DATUM_PACKED(PG_GETARG_DATUM(2));
+	kern_context kcxt;
+	pg_numeric_t arg1;
+	pg_numeric_t arg2;
+	pg_numeric_t result;
+	char	   *buf;
+
+	memset(&kcxt, 0, sizeof(kern_context));
+	arg1 = pg_numeric_from_varlena(&kcxt, vl1);
+	arg2 = pg_numeric_from_varlena(&kcxt, vl2);
+	if (kcxt.e.errcode != StromError_Success)
+		PG_RETURN_NULL();
+
+	if (strcmp(op, "+") == 0)
+		result = pg_numeric_add(&kcxt, arg1, arg2);
+	else if (strcmp(op, "-") == 0)
+		result = pg_numeric_sub(&kcxt, arg1, arg2);
+	else if (strcmp(op, "*") == 0)
+		result = pg_numeric_mul(&kcxt, arg1, arg2);
+	else if (strcmp(op, "cmp") == 0)
+	{
+		memset(&result, 0, sizeof(pg_numeric_t));
+		result.value = __Int128_add(result.value,
+									pg_numeric_cmp(&kcxt, arg1, arg2));
+	}
+	else
+		elog(ERROR, "unknown operator: %s", op);
+	if (kcxt.e.errcode != StromError_Success || result.isnull)
+		PG_RETURN_NULL();
+
+	buf = palloc(sizeof(struct NumericData));
+	pg_numeric_to_varlena(&kcxt, buf, result.precision, result.value);
+
+	PG_RETURN_NUMERIC((Numeric) buf);
+}
+PG_FUNCTION_INFO_V1(pgstrom_numeric_devlib_check);
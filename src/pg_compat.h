@@ -109,4 +109,15 @@
 	((missing_ok) ? get_attname((a),(b)) : get_relid_attribute_name((a),(b)))
 #endif
 
+/*
+ * MEMO: PG10 adds QueryEnvironment argument to CreateQueryDesc() and
+ * GetCachedPlan(). Just omit it if PG9.6.
+ */
+#if PG_VERSION_NUM < 100000
+#define CreateQueryDesc(a,b,c,d,e,f,g,h)	\
+	CreateQueryDesc((a),(b),(c),(d),(e),(f),(h))
+#define GetCachedPlan(a,b,c,d)				\
+	GetCachedPlan((a),(b),(c))
+#endif
+
 #endif	/* PG_COMPAT_H */
@@ -24,6 +24,7 @@
 #include "access/twophase.h"
 #include "access/visibilitymap.h"
 #include "access/xact.h"
+#include "access/xlog.h"
 #include "catalog/catalog.h"
 #include "catalog/dependency.h"
 #include "catalog/heap.h"
@@ -49,6 +50,7 @@
 #include "catalog/pg_type.h"
 #include "commands/dbcommands.h"
 #include "commands/defrem.h"
+#include "commands/prepare.h"
 #include "commands/explain.h"
 #include "commands/proclang.h"
 #include "commands/tablespace.h"
@@ -64,6 +66,7 @@
 #include "executor/nodeIndexscan.h"
 #include "executor/nodeCustom.h"
 #include "executor/nodeSubplan.h"
+#include "executor/spi.h"
 #include "fmgr.h"
 #include "foreign/fdwapi.h"
 #include "foreign/foreign.h"
@@ -92,6 +95,7 @@
 #include "optimizer/restrictinfo.h"
 #include "optimizer/tlist.h"
 #include "optimizer/var.h"
+#include "parser/analyze.h"
 #include "parser/parsetree.h"
 #include "parser/parse_func.h"
 #include "parser/parse_oper.h"
@@ -99,6 +103,7 @@
 #include "port/atomics.h"
 #include "postmaster/bgworker.h"
 #include "postmaster/postmaster.h"
+#include "rewrite/rewriteHandler.h"
 #include "storage/buf.h"
 #include "storage/buf_internals.h"
 #include "storage/ipc.h"
@@ -115,6 +120,8 @@
 #include "storage/shmem.h"
 #include "storage/smgr.h"
 #include "storage/spin.h"
+#include "tcop/tcopprot.h"
+#include "tcop/utility.h"
 #include "utils/array.h"
 #include "utils/arrayaccess.h"
 #include "utils/builtins.h"
@@ -124,6 +131,7 @@
 #include "utils/fmgroids.h"
 #include "utils/guc.h"
 #include "utils/json.h"
+#include "utils/jsonb.h"
 #include "utils/inet.h"
 #include "utils/int8.h"
 #include "utils/inval.h"
@@ -132,6 +140,7 @@
 #include "utils/numeric.h"
 #include "utils/pg_crc.h"
 #include "utils/pg_locale.h"
+#include "utils/plancache.h"
 #include "utils/rangetypes.h"
 #if PG_VERSION_NUM >= 100000
 #include "utils/regproc.h"
@@ -227,6 +236,7 @@ typedef struct GpuContext
 	CUcontext		cuda_context;
 	CUevent		   *cuda_events0; /* per-worker general purpose event */
 	CUevent		   *cuda_events1; /* per-worker general purpose event */
+	CUevent		   *cuda_tevents; /* per-worker events for phase timing */
 	pthread_mutex_t	cuda_modules_lock;
 	dlist_head		cuda_modules_slot[CUDA_MODULES_HASHSIZE];
 	/* resource management */
@@ -247,6 +257,8 @@ typedef struct GpuContext
 	/* management of the work-queue */
 	bool			worker_is_running;
 	pg_atomic_uint32 *global_num_running_tasks;
+	pg_atomic_uint32 num_running_tasks;	/* # of tasks in global_num_... */
+	struct GpuTrace *trace;				/* event trace buffer, if any */
 	pthread_mutex_t	*mutex;				/* IPC stuff */
 	pthread_cond_t	*cond;				/* IPC stuff */
 	pg_atomic_uint32 *command;			/* IPC stuff */
@@ -257,6 +269,45 @@ typedef struct GpuContext
 	pthread_t		worker_threads[FLEXIBLE_ARRAY_MEMBER];
 } GpuContext;
 
+/*
+ * GpuStatKind
+ *
+ * Counters of the GpuContext activities; accumulated on the shared memory
+ * per device and per backend, then exposed by pgstrom.stat_device and
+ * pgstrom.stat_activity views.
+ */
+typedef enum
+{
+	GPUSTAT__NUM_TASKS = 0,		/* # of GpuTasks enqueued */
+	GPUSTAT__NUM_KERNELS,		/* # of GPU kernels launched */
+	GPUSTAT__BYTES_HTOD,		/* bytes sent by host-to-device DMA */
+	GPUSTAT__BYTES_DTOH,		/* bytes received by device-to-host DMA */
+	GPUSTAT__NUM_FALLBACKS,		/* # of chunks processed by CPU fallback */
+	GPUSTAT__PROGRAM_LOOKUPS,	/* # of lookups on the GPU program cache */
+	GPUSTAT__PROGRAM_HITS,		/* # of hits on the GPU program cache */
+	GPUSTAT__NITEMS
+} GpuStatKind;
+
+/*
+ * GpuTraceEvent
+ *
+ * Events recorded on the event trace of GpuContext, if sampled by the
+ * pg_strom.trace_directory and pg_strom.trace_sample_rate. Events marked
+ * as (instant) have no duration.
+ */
+typedef enum
+{
+	GPUTRACE__BUILD_CHUNK = 0,	/* cb_next_task; load a chunk */
+	GPUTRACE__SYNC_WAIT,		/* wait for completion of tasks */
+	GPUTRACE__GPU_PROCESS,		/* cb_process_task (worker) */
+	GPUTRACE__RETRY_WAIT,		/* break on lack of resources (worker) */
+	GPUTRACE__ENQUEUE,			/* attached to the pending list (instant) */
+	GPUTRACE__PICKUP,			/* picked up by worker (worker; instant) */
+	GPUTRACE__COMPLETE,			/* completed by worker (worker; instant) */
+	GPUTRACE__CPU_FALLBACK,		/* chunk to be processed by CPU (instant) */
+	GPUTRACE__NITEMS
+} GpuTraceEvent;
+
 /* Identifier of the Gpu Programs */
 typedef cl_long					ProgramId;
 #define INVALID_PROGRAM_ID		(-1L)
@@ -276,6 +327,28 @@ typedef struct GpuTask				GpuTask;
 typedef struct GpuTaskState			GpuTaskState;
 typedef struct GpuTaskSharedState	GpuTaskSharedState;
 
+/*
+ * GpuTaskStage
+ *
+ * Stages of GpuTask for the per-stage timing on EXPLAIN ANALYZE.
+ * Stages marked as (worker) are accumulated by GPU worker threads.
+ */
+typedef enum
+{
+	GTS_STAGE__BUILD_CHUNK = 0,	/* cb_next_task; load a chunk */
+	GTS_STAGE__QUEUE_WAIT,		/* pending in GpuContext (worker) */
+	GTS_STAGE__RETRY_WAIT,		/* break on lack of resources (worker) */
+	GTS_STAGE__GPU_PROCESS,		/* cb_process_task; DMA and kernel (worker) */
+	GTS_STAGE__DMA_SEND,		/* - DMA send on the GPU stream (worker) */
+	GTS_STAGE__KERNEL_EXEC,		/* - GPU kernel on the GPU stream (worker) */
+	GTS_STAGE__DMA_RECV,		/* - DMA receive on the GPU stream (worker) */
+	GTS_STAGE__PROGRAM_WAIT,	/* wait for build of GPU program (worker) */
+	GTS_STAGE__SYNC_WAIT,		/* wait for completion of tasks */
+	GTS_STAGE__FETCH_TUPLE,		/* cb_next_tuple on the GPU results */
+	GTS_STAGE__CPU_FALLBACK,	/* cb_next_tuple on the CPU fallback */
+	GTS_STAGE__NITEMS
+} GpuTaskStage;
+
 /*
  * GpuTaskState
  *
@@ -349,6 +422,10 @@ struct GpuTaskState
 
 	/* misc fields */
 	cl_long			num_cpu_fallbacks;	/* # of CPU fallback chunks */
+	cl_long			num_chunks;		/* # of chunks already processed */
+	bool			stage_timing;	/* true, if EXPLAIN ANALYZE with TIMING */
+	pg_atomic_uint64 stage_nsec[GTS_STAGE__NITEMS];	/* elapsed time [ns] */
+	pg_atomic_uint64 stat_counters[GPUSTAT__NITEMS];	/* by worker threads */
 
 	/* co-operation with CPU parallel */
 	GpuTaskSharedState *gtss;		/* DSM segment of GTS if any */
@@ -380,12 +457,16 @@ typedef struct
 	pg_atomic_uint64	nvme_count;
 	pg_atomic_uint64	brin_count;
 	pg_atomic_uint64	fallback_count;
+	pg_atomic_uint64	chunk_count;
+	pg_atomic_uint64	stage_nsec[GTS_STAGE__NITEMS];
 } GpuTaskRuntimeStat;
 
 static inline void
 mergeGpuTaskRuntimeStatParallelWorker(GpuTaskState *gts,
 									  GpuTaskRuntimeStat *gt_rtstat)
 {
+	int		i;
+
 	Assert(IsParallelWorker());
 	if (!gt_rtstat)
 		return;
@@ -397,12 +478,18 @@ mergeGpuTaskRuntimeStatParallelWorker(GpuTaskState *gts,
 	pg_atomic_add_fetch_u64(&gt_rtstat->brin_count, gts->outer_brin_count);
 	pg_atomic_add_fetch_u64(&gt_rtstat->fallback_count,
 							gts->num_cpu_fallbacks);
+	pg_atomic_add_fetch_u64(&gt_rtstat->chunk_count, gts->num_chunks);
+	for (i=0; i < GTS_STAGE__NITEMS; i++)
+		pg_atomic_add_fetch_u64(&gt_rtstat->stage_nsec[i],
+								pg_atomic_read_u64(&gts->stage_nsec[i]));
 }
 
 static inline void
 mergeGpuTaskRuntimeStat(GpuTaskState *gts,
 						GpuTaskRuntimeStat *gt_rtstat)
 {
+	int		i;
+
 	InstrAggNode(&gts->outer_instrument,
 				 &gt_rtstat->outer_instrument);
 	gts->outer_instrument.tuplecount = (double)
@@ -412,6 +499,10 @@ mergeGpuTaskRuntimeStat(GpuTaskState *gts,
 	gts->nvme_count += pg_atomic_read_u64(&gt_rtstat->nvme_count);
 	gts->outer_brin_count += pg_atomic_read_u64(&gt_rtstat->brin_count);
 	gts->num_cpu_fallbacks += pg_atomic_read_u64(&gt_rtstat->fallback_count);
+	gts->num_chunks += pg_atomic_read_u64(&gt_rtstat->chunk_count);
+	for (i=0; i < GTS_STAGE__NITEMS; i++)
+		pg_atomic_add_fetch_u64(&gts->stage_nsec[i],
+								pg_atomic_read_u64(&gt_rtstat->stage_nsec[i]));
 }
 
 /*
@@ -428,6 +519,8 @@ struct GpuTask
 	ProgramId		program_id;		/* same with GTS's one */
 	GpuTaskState   *gts;			/* GTS reference in the backend */
 	bool			cpu_fallback;	/* true, if task needs CPU fallback */
+	cl_ulong		tv_enqueue;		/* timestamp [ns] of the last enqueue */
+	cl_uint			trace_id;		/* identifier on the event trace */
 };
 
 /*
@@ -445,7 +538,9 @@ struct GpuTask
 #define DEVKERNEL_NEEDS_RANGETYPE		0x00008000
 #define DEVKERNEL_NEEDS_PRIMITIVE		0x00010000
 #define DEVKERNEL_NEEDS_TIME_EXTRACT	0x00020000
+#define DEVKERNEL_NEEDS_JSONLIB			0x00040000
 
+#define DEVKERNEL_DEBUG_CPU_FALLBACK	0x40000000
 #define DEVKERNEL_BUILD_DEBUG_INFO		0x80000000
 
 struct devtype_info;
@@ -680,6 +775,10 @@ extern void gpuIpcMemCopyToHost(void *hbuffer,
 extern void gpuMemReclaimSegment(GpuContext *gcontext);
 
 extern void gpuMemCopyFromSSD(CUdeviceptr m_kds, pgstrom_data_store *pds);
+extern void gpuMemStatUsage(cl_int cuda_dindex,
+							cl_ulong *p_normal_usage,
+							cl_ulong *p_managed_usage,
+							cl_ulong *p_iomap_usage);
 
 extern void pgstrom_gpu_mmgr_init_gpucontext(GpuContext *gcontext);
 extern void pgstrom_gpu_mmgr_cleanup_gpucontext(GpuContext *gcontext);
@@ -693,6 +792,7 @@ extern int		local_max_async_tasks;		/* GUC */
 extern __thread GpuContext	   *GpuWorkerCurrentContext;
 extern __thread sigjmp_buf	   *GpuWorkerExceptionStack;
 extern __thread int				GpuWorkerIndex;
+extern __thread GpuTaskState   *GpuWorkerCurrentTaskState;
 #define CU_CONTEXT_PER_THREAD					\
 	(GpuWorkerCurrentContext->cuda_context)
 #define CU_DEVICE_PER_THREAD					\
@@ -704,6 +804,19 @@ extern __thread int				GpuWorkerIndex;
 #define CU_EVENT1_PER_THREAD					\
 	(GpuWorkerCurrentContext->cuda_events1[GpuWorkerIndex])
 
+/*
+ * GpuTaskPhase - boundaries of the phases in cb_process_task, to break down
+ * GTS_STAGE__GPU_PROCESS using CUevents recorded on the task stream.
+ */
+typedef enum
+{
+	GTS_PHASE__SEND_BEGIN = 0,	/* prior to the first DMA send */
+	GTS_PHASE__KERNEL_BEGIN,	/* prior to the (first) kernel launch */
+	GTS_PHASE__RECV_BEGIN,		/* prior to the first DMA receive */
+	GTS_PHASE__RECV_END,		/* next to the last DMA receive */
+	GTS_PHASE__NITEMS
+} GpuTaskPhase;
+
 extern void GpuContextWorkerReportError(int elevel,
 										const char *filename, int lineno,
 										const char *funcname,
@@ -751,6 +864,19 @@ extern GpuContext *GetGpuContext(GpuContext *gcontext);
 extern void PutGpuContext(GpuContext *gcontext);
 extern void SynchronizeGpuContext(GpuContext *gcontext);
 extern void SynchronizeGpuContextOnDSMDetach(dsm_segment *seg, Datum arg);
+extern void pgstromStatAdd(GpuContext *gcontext,
+						   GpuStatKind kind, cl_ulong value);
+extern void pgstromStatTaskEnqueued(GpuContext *gcontext);
+extern void gpuTaskPhaseMark(GpuTaskPhase phase);
+extern void gpuTaskPhaseCollect(void);
+extern void pgstromTraceEvent(GpuContext *gcontext, GpuTraceEvent event,
+							  cl_ulong tv_begin, cl_ulong tv_end,
+							  GpuTask *gtask);
+#define GPUTRACE_INSTANT(gcontext,event,gtask)					\
+	do {														\
+		if ((gcontext)->trace)									\
+			pgstromTraceEvent((gcontext),(event),0,0,(gtask));	\
+	} while(0)
 
 extern bool trackCudaProgram(GpuContext *gcontext, ProgramId program_id,
 							 const char *filename, int lineno);
@@ -960,6 +1086,7 @@ typedef struct {
 	List	   *pseudo_tlist;	/* pseudo tlist expression, if any */
 	int			extra_flags;	/* external libraries to be included */
 	int			varlena_bufsz;	/* required size of temporary varlena buffer */
+	List	   *cse_items;		/* common sub-expressions, if any */
 } codegen_context;
 
 extern void pgstrom_codegen_typeoid_declarations(StringInfo buf);
@@ -976,6 +1103,12 @@ extern void pgstrom_devfunc_track(codegen_context *context,
 extern char *pgstrom_codegen_expression(Node *expr, codegen_context *context);
 extern void pgstrom_codegen_param_declarations(StringInfo buf,
 											   codegen_context *context);
+extern void pgstrom_codegen_devfunc_needs(StringInfo buf,
+										  codegen_context *context);
+extern void pgstrom_codegen_cse_setup(codegen_context *context, List *exprs);
+extern void pgstrom_codegen_cse_declarations(StringInfo buf,
+											 codegen_context *context);
+extern void pgstrom_codegen_cse_reset(codegen_context *context);
 extern bool __pgstrom_device_expression(PlannerInfo *root, Expr *expr,
 										const char *filename, int lineno);
 
@@ -989,6 +1122,13 @@ extern void pgstrom_init_codegen_context(codegen_context *context,
 										 PlannerInfo *root);
 extern void pgstrom_init_codegen(void);
 
+/*
+ * regex_dfa.c
+ */
+extern bytea *pgstrom_regex_dfa_compile(text *pattern, bool icase,
+										Oid collid);
+extern void pgstrom_init_regex_dfa(void);
+
 /*
  * datastore.c
  */
@@ -1189,6 +1329,7 @@ extern ProgramId GpuJoinCreateCombinedProgram(PlanState *node,
 											  cl_uint gpa_extra_flags,
 											  cl_uint gpa_varlena_bufsz,
 											  const char *gpa_kern_source,
+											  const char *gpa_kern_devfuncs,
 											  bool explain_only);
 extern bool GpuJoinInnerPreload(GpuTaskState *gts, CUdeviceptr *p_m_kmrels);
 extern void GpuJoinInnerUnload(GpuTaskState *gts, bool is_rescan);
@@ -1226,8 +1367,12 @@ extern void pgstrom_init_plcuda(void);
 /*
  * gstore_fdw.c
  */
+#define GSTORE_MAX_SHARDS		32
 extern void gstore_fdw_table_options(Oid gstore_oid,
 									 int *p_pinning, int *p_format);
+extern void gstore_fdw_table_shard_options(Oid gstore_oid,
+										   List **p_devices,
+										   size_t *p_shard_nrows);
 extern void gstore_fdw_column_options(Oid gstore_oid, AttrNumber attnum,
 									  int *p_compression);
 extern bool relation_is_gstore_fdw(Oid table_oid);
@@ -1244,7 +1389,13 @@ typedef struct GpuStoreBuffer	GpuStoreBuffer;
 extern GpuStoreBuffer *GpuStoreBufferCreate(Relation frel,
 											Snapshot snapshot);
 extern CUdeviceptr GpuStoreBufferOpenDevPtr(GpuContext *gcontext,
-											GpuStoreBuffer *gs_buffer);
+											GpuStoreBuffer *gs_buffer,
+											int shard_id);
+extern int	GpuStoreBufferGetNShards(GpuStoreBuffer *gs_buffer);
+extern cl_int GpuStoreBufferGetShard(GpuStoreBuffer *gs_buffer,
+									 int shard_id,
+									 size_t *p_base_index,
+									 size_t *p_nitems);
 extern int GpuStoreBufferGetTuple(Relation frel,
 								  Snapshot snapshot,
 								  TupleTableSlot *slot,
@@ -1255,6 +1406,12 @@ extern void GpuStoreBufferAppendRow(GpuStoreBuffer *gs_buffer,
 									TupleDesc tupdesc,
 									Snapshot snapshot,
 									TupleTableSlot *slot);
+extern void GpuStoreBufferAppendRows(GpuStoreBuffer *gs_buffer,
+									 TupleDesc tupdesc,
+									 Snapshot snapshot,
+									 size_t nrows,
+									 Datum *values,
+									 bool *isnull);
 extern void GpuStoreBufferRemoveRow(GpuStoreBuffer *gs_buffer,
 									TupleDesc tupdesc,
 									Snapshot snapshot,
@@ -1263,11 +1420,28 @@ extern void GpuStoreBufferGetSize(Oid table_oid, Snapshot snapshot,
 								  Size *p_rawsize,
 								  Size *p_nitems);
 extern size_t GpuStoreBufferGetNitems(GpuStoreBuffer *gs_buffer);
+extern size_t GpuStoreBufferGetMainNitems(GpuStoreBuffer *gs_buffer);
+extern Oid	gstore_buf_vl_dict_ordering(Oid type_oid);
+extern bool GpuStoreBufferHasDictionary(GpuStoreBuffer *gs_buffer,
+										AttrNumber anum);
+extern cl_uint GpuStoreBufferLookupDictCode(GpuStoreBuffer *gs_buffer,
+											TupleDesc tupdesc,
+											AttrNumber anum,
+											Datum key,
+											bool inclusive);
+extern cl_uint GpuStoreBufferGetDictCode(GpuStoreBuffer *gs_buffer,
+										 AttrNumber anum,
+										 size_t row_index);
 
 extern void pgstrom_init_gstore_buf(void);
 
 extern GstoreIpcHandle *__pgstrom_gstore_export_ipchandle(Oid ftable_oid);
 
+/*
+ * float2.c
+ */
+extern void pgstrom_init_float2(void);
+
 /*
  * misc.c
  */
@@ -1300,6 +1474,7 @@ extern bool		pgstrom_enabled;
 extern bool		pgstrom_debug_kernel_source;
 extern bool		pgstrom_bulkexec_enabled;
 extern bool		pgstrom_cpu_fallback_enabled;
+extern bool		pgstrom_debug_force_cpu_fallback;
 extern int		pgstrom_max_async_tasks;
 extern double	pgstrom_gpu_setup_cost;
 extern double	pgstrom_gpu_dma_cost;
@@ -1622,6 +1797,42 @@ __basename(const char *filename)
 	return pos ? pos + 1 : filename;
 }
 
+/*
+ * get_monotonic_nsec - current time in nanoseconds, for interval measurement
+ */
+static inline cl_ulong
+get_monotonic_nsec(void)
+{
+	struct timespec	tm;
+
+	clock_gettime(CLOCK_MONOTONIC, &tm);
+	return (cl_ulong)tm.tv_sec * 1000000000UL + (cl_ulong)tm.tv_nsec;
+}
+
+/*
+ * gts_stage_elapsed - accumulates the time since @tv_begin on the stage
+ */
+static inline void
+gts_stage_elapsed(GpuTaskState *gts, GpuTaskStage stage, cl_ulong tv_begin)
+{
+	pg_atomic_add_fetch_u64(&gts->stage_nsec[stage],
+							get_monotonic_nsec() - tv_begin);
+}
+
+/*
+ * gts_stage_trace - gts_stage_elapsed, and records the event on the trace
+ */
+static inline void
+gts_stage_trace(GpuTaskState *gts, GpuTaskStage stage,
+				GpuTraceEvent event, cl_ulong tv_begin, GpuTask *gtask)
+{
+	cl_ulong	tv_end = get_monotonic_nsec();
+
+	pg_atomic_add_fetch_u64(&gts->stage_nsec[stage], tv_end - tv_begin);
+	if (gts->gcontext->trace)
+		pgstromTraceEvent(gts->gcontext, event, tv_begin, tv_end, gtask);
+}
+
 /*
  * XXX - why PG does not have palloc_huge()?
  */
@@ -0,0 +1,1107 @@
+/*
+ * regex_dfa.c
+ *
+ * Plan-time compiler of regular expressions to DFA, for the device quals
+ * using regular expression operators (~, !~, ~* and !~*).
+ * ----
+ * Copyright 2011-2019 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2019 (C) The PG-Strom Development Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#include "pg_strom.h"
+#include "cuda_textlib.h"
+#include "portability/instr_time.h"
+
+/*
+ * NOTE: The compiler supports a subset of the advanced regular expression
+ * (ARE) of PostgreSQL; literals, escapes, '.', bracket expressions with
+ * character classes, '^', '$', groups, alternation and quantifiers
+ * ('*', '+', '?' and bounds, including non-greedy ones, because only
+ * boolean result is required).
+ * Back-references, lookahead/lookbehind constraints, word boundaries,
+ * embedded options and collating elements are not supported, so these
+ * regular expressions are evaluated by the PostgreSQL's engine on CPU.
+ * Character classes and case-insensitive match are supported only if
+ * LC_CTYPE of the collation is "C", because the DFA works on ASCII only.
+ * Database encoding must be UTF-8 or single-byte encoding.
+ */
+#define REGEX_NFA_MAX_STATES	4000
+#define REGEX_DFA_MAX_STATES	1000
+#define REGEX_DFA_MAX_LENGTH	(256 * 1024)
+#define REGEX_DUPMAX			255		/* same as RE_DUP_MAX */
+
+typedef enum
+{
+	RXN_EMPTY,
+	RXN_CSET,
+	RXN_CONCAT,
+	RXN_ALT,
+	RXN_REPEAT,
+	RXN_BOL,
+	RXN_EOL,
+} RegexNodeTag;
+
+typedef struct RegexNode
+{
+	RegexNodeTag tag;
+	bits8		cset[32];		/* RXN_CSET */
+	List	   *items;			/* RXN_CONCAT, RXN_ALT */
+	struct RegexNode *child;	/* RXN_REPEAT */
+	int			min;
+	int			max;			/* -1 means infinity */
+} RegexNode;
+
+typedef struct
+{
+	const char *pos;
+	const char *end;
+	bool		icase;			/* case-insensitive match */
+	bool		utf8;			/* database encoding is UTF-8 */
+	bool		ctype_is_c;		/* LC_CTYPE is "C" */
+} RegexParser;
+
+/* NFA states */
+#define RXS_EPS		1			/* epsilon transition to out1 (and out2) */
+#define RXS_CSET	2			/* transition to out1 by a byte in cset */
+#define RXS_BOL		3			/* epsilon transition on the head of string */
+#define RXS_EOL		4			/* epsilon transition on the tail of string */
+#define RXS_MATCH	5			/* final state */
+
+typedef struct
+{
+	int			tag;
+	int			out1;
+	int			out2;
+	bits8	   *cset;
+} RegexNfaState;
+
+typedef struct
+{
+	int			nstates;
+	int			nrooms;
+	RegexNfaState *states;
+} RegexNfa;
+
+/* static variables */
+static bool		pgstrom_enable_regex_dfa;	/* GUC */
+
+Datum pgstrom_regex_dfa_bench(PG_FUNCTION_ARGS);
+
+#define CSET_SET(cset,c)	((cset)[(cl_uchar)(c) >> 3] |= (1 << ((c) & 7)))
+#define CSET_TEST(cset,c)	(((cset)[(cl_uchar)(c) >> 3] & (1 << ((c) & 7))) != 0)
+
+static RegexNode *regex_parse_alt(RegexParser *rp);
+
+static RegexNode *
+regex_make_node(RegexNodeTag tag)
+{
+	RegexNode  *rnode = palloc0(sizeof(RegexNode));
+
+	rnode->tag = tag;
+	return rnode;
+}
+
+static RegexNode *
+regex_make_cset_range(int lo, int hi)
+{
+	RegexNode  *rnode = regex_make_node(RXN_CSET);
+	int			c;
+
+	for (c=lo; c <= hi; c++)
+		CSET_SET(rnode->cset, c);
+	return rnode;
+}
+
+/*
+ * regex_make_mbchar_any - any multi-byte character of UTF-8
+ */
+static List *
+regex_make_mbchar_any(void)
+{
+	RegexNode  *rnode;
+	List	   *result = NIL;
+	int			i, j;
+	static const int first_ranges[3][2] = {{0xc2,0xdf},
+										   {0xe0,0xef},
+										   {0xf0,0xf4}};
+
+	for (i=0; i < 3; i++)
+	{
+		rnode = regex_make_node(RXN_CONCAT);
+		rnode->items = list_make1(regex_make_cset_range(first_ranges[i][0],
+														first_ranges[i][1]));
+		for (j=0; j <= i; j++)
+			rnode->items = lappend(rnode->items,
+								   regex_make_cset_range(0x80, 0xbf));
+		result = lappend(result, rnode);
+	}
+	return result;
+}
+
+/*
+ * regex_make_charset - builds a node to match a character in the set.
+ * On UTF-8, cset must contain only ASCII characters, and negative set
+ * also matches any multi-byte characters.
+ */
+static RegexNode *
+regex_make_charset(RegexParser *rp, bits8 *cset, bool negate)
+{
+	RegexNode  *rnode;
+	RegexNode  *alt;
+	int			c;
+
+	rnode = regex_make_node(RXN_CSET);
+	for (c=0; c < 256; c++)
+	{
+		bool	isset = CSET_TEST(cset, c);
+
+		if (rp->icase && c < 128 && isalpha(c))
+			isset |= CSET_TEST(cset, islower(c) ? toupper(c) : tolower(c));
+		if (isset != negate)
+			CSET_SET(rnode->cset, c);
+	}
+	if (!negate || !rp->utf8)
+		return rnode;
+
+	/* negative set on UTF-8 */
+	for (c=128; c < 256; c++)
+		rnode->cset[c >> 3] &= ~(1 << (c & 7));
+	alt = regex_make_node(RXN_ALT);
+	alt->items = lcons(rnode, regex_make_mbchar_any());
+	return alt;
+}
+
+/*
+ * regex_add_class - adds characters of the class to cset
+ */
+static bool
+regex_add_class(RegexParser *rp, bits8 *cset, const char *name, int namelen)
+{
+	int			c;
+
+	if (!rp->ctype_is_c)
+		return false;
+	for (c=0; c < 128; c++)
+	{
+		bool	isset;
+
+#define CLASS_IS(label)		(namelen == strlen(label) &&		\
+							 strncmp(name, (label), namelen) == 0)
+		if (CLASS_IS("alpha"))
+			isset = isalpha(c);
+		else if (CLASS_IS("upper"))
+			isset = isupper(c);
+		else if (CLASS_IS("lower"))
+			isset = islower(c);
+		else if (CLASS_IS("digit"))
+			isset = isdigit(c);
+		else if (CLASS_IS("xdigit"))
+			isset = isxdigit(c);
+		else if (CLASS_IS("alnum"))
+			isset = isalnum(c);
+		else if (CLASS_IS("word"))
+			isset = (isalnum(c) || c == '_');
+		else if (CLASS_IS("space"))
+			isset = isspace(c);
+		else if (CLASS_IS("blank"))
+			isset = (c == ' ' || c == '\t');
+		else if (CLASS_IS("punct"))
+			isset = ispunct(c);
+		else if (CLASS_IS("print"))
+			isset = isprint(c);
+		else if (CLASS_IS("graph"))
+			isset = isgraph(c);
+		else if (CLASS_IS("cntrl"))
+			isset = iscntrl(c);
+		else
+			return false;
+#undef CLASS_IS
+		if (isset)
+			CSET_SET(cset, c);
+	}
+	return true;
+}
+
+/*
+ * regex_parse_escape_char - escaped character; returns -1 if not a simple
+ * character escape
+ */
+static int
+regex_parse_escape_char(RegexParser *rp, char c)
+{
+	switch (c)
+	{
+		case 'a':	return '\007';
+		case 'b':	return '\b';
+		case 'B':	return '\\';
+		case 'e':	return '\033';
+		case 'f':	return '\f';
+		case 'n':	return '\n';
+		case 'r':	return '\r';
+		case 't':	return '\t';
+		case 'v':	return '\v';
+		case 'x':
+			{
+				int		code = 0;
+				int		ndigits = 0;
+
+				while (rp->pos < rp->end && isxdigit((cl_uchar) *rp->pos))
+				{
+					char	h = *rp->pos++;
+
+					code = code * 16 + (isdigit(h) ? h - '0'
+										: tolower(h) - 'a' + 10);
+					if (code >= 128)
+						return -1;
+					ndigits++;
+				}
+				if (ndigits == 0 || code == 0)
+					return -1;
+				return code;
+			}
+		default:
+			/* back references, constraints, and so on */
+			if (isalnum((cl_uchar) c) || (c & 0x80) != 0)
+				return -1;
+			return c;
+	}
+}
+
+/*
+ * regex_parse_bracket - bracket expression; '[' is already consumed
+ */
+static RegexNode *
+regex_parse_bracket(RegexParser *rp)
+{
+	bits8		cset[32];
+	bool		negate = false;
+	bool		first = true;
+
+	memset(cset, 0, sizeof(cset));
+	if (rp->pos < rp->end && *rp->pos == '^')
+	{
+		negate = true;
+		rp->pos++;
+	}
+	for (;;)
+	{
+		int		lo, hi;
+
+		if (rp->pos >= rp->end)
+			return NULL;		/* unmatched [ */
+		lo = (cl_uchar) *rp->pos++;
+		if (lo == ']' && !first)
+			break;
+		first = false;
+
+		if (lo == '[' && rp->pos < rp->end)
+		{
+			const char *tail;
+			char		kind = *rp->pos;
+
+			if (kind == '.' || kind == '=')
+				return NULL;	/* collating element, equivalence class */
+			if (kind == ':')
+			{
+				for (tail = rp->pos + 1; tail + 1 < rp->end; tail++)
+				{
+					if (tail[0] == ':' && tail[1] == ']')
+						break;
+				}
+				if (tail + 1 >= rp->end ||
+					!regex_add_class(rp, cset, rp->pos + 1,
+									 tail - (rp->pos + 1)))
+					return NULL;
+				rp->pos = tail + 2;
+				continue;
+			}
+		}
+		else if (lo == '\\')
+		{
+			char	c;
+
+			if (rp->pos >= rp->end)
+				return NULL;
+			c = *rp->pos++;
+			if (c == 'd' || c == 's' || c == 'w')
+			{
+				if (!regex_add_class(rp, cset,
+									 c == 'd' ? "digit" :
+									 c == 's' ? "space" : "word",
+									 c == 'd' ? 5 : c == 's' ? 5 : 4))
+					return NULL;
+				continue;
+			}
+			lo = regex_parse_escape_char(rp, c);
+			if (lo < 0)
+				return NULL;
+		}
+		if (lo >= 128 && rp->utf8)
+			return NULL;		/* multi-byte character in the set */
+
+		/* range of characters? */
+		if (rp->pos + 1 < rp->end && rp->pos[0] == '-' && rp->pos[1] != ']')
+		{
+			rp->pos++;
+			hi = (cl_uchar) *rp->pos++;
+			if (hi == '[' || hi == '\\' || (hi >= 128 && rp->utf8))
+				return NULL;
+			if (lo > hi)
+				return NULL;	/* invalid range; raise an error on CPU */
+		}
+		else
+			hi = lo;
+		while (lo <= hi)
+		{
+			CSET_SET(cset, lo);
+			lo++;
+		}
+	}
+	return regex_make_charset(rp, cset, negate);
+}
+
+/*
+ * regex_parse_atom
+ */
+static RegexNode *
+regex_parse_atom(RegexParser *rp)
+{
+	bits8		cset[32];
+	RegexNode  *rnode;
+	int			c = (cl_uchar) *rp->pos++;
+
+	memset(cset, 0, sizeof(cset));
+	switch (c)
+	{
+		case '(':
+			if (rp->pos < rp->end && *rp->pos == '?')
+			{
+				/* only non-capturing group is supported */
+				if (rp->pos + 1 >= rp->end || rp->pos[1] != ':')
+					return NULL;
+				rp->pos += 2;
+			}
+			rnode = regex_parse_alt(rp);
+			if (!rnode || rp->pos >= rp->end || *rp->pos != ')')
+				return NULL;
+			rp->pos++;
+			return rnode;
+		case ')':
+		case '*':
+		case '+':
+		case '?':
+			return NULL;		/* syntax error; raise an error on CPU */
+		case '{':
+			if (rp->pos < rp->end && isdigit((cl_uchar) *rp->pos))
+				return NULL;	/* syntax error; raise an error on CPU */
+			break;
+		case '^':
+			return regex_make_node(RXN_BOL);
+		case '$':
+			return regex_make_node(RXN_EOL);
+		case '.':
+			if (!rp->utf8)
+				return regex_make_cset_range(0x00, 0xff);
+			memset(cset, 0xff, 16);
+			rnode = regex_make_node(RXN_ALT);
+			rnode->items = lcons(regex_make_charset(rp, cset, false),
+								 regex_make_mbchar_any());
+			return rnode;
+		case '[':
+			return regex_parse_bracket(rp);
+		case '\\':
+			if (rp->pos >= rp->end)
+				return NULL;
+			c = *rp->pos++;
+			switch (c)
+			{
+				case 'd':
+				case 'D':
+					if (!regex_add_class(rp, cset, "digit", 5))
+						return NULL;
+					return regex_make_charset(rp, cset, c == 'D');
+				case 's':
+				case 'S':
+					if (!regex_add_class(rp, cset, "space", 5))
+						return NULL;
+					return regex_make_charset(rp, cset, c == 'S');
+				case 'w':
+				case 'W':
+					if (!regex_add_class(rp, cset, "word", 4))
+						return NULL;
+					return regex_make_charset(rp, cset, c == 'W');
+				default:
+					c = regex_parse_escape_char(rp, c);
+					if (c < 0)
+						return NULL;
+					break;
+			}
+			break;
+		default:
+			if (c >= 128 && rp->utf8)
+			{
+				/* multi-byte character as a sequence of bytes */
+				const char *mbstr = rp->pos - 1;
+				int			i, mblen = pg_mblen(mbstr);
+
+				if (rp->icase || mbstr + mblen > rp->end)
+					return NULL;
+				rnode = regex_make_node(RXN_CONCAT);
+				for (i=0; i < mblen; i++)
+					rnode->items = lappend(rnode->items,
+										   regex_make_cset_range((cl_uchar)mbstr[i],
+																 (cl_uchar)mbstr[i]));
+				rp->pos = mbstr + mblen;
+				return rnode;
+			}
+			if (c >= 128 && rp->icase)
+				return NULL;
+			break;
+	}
+	CSET_SET(cset, c);
+	return regex_make_charset(rp, cset, false);
+}
+
+/*
+ * regex_parse_bound - {m}, {m,} or {m,n}; '{' is already consumed
+ */
+static bool
+regex_parse_bound(RegexParser *rp, int *p_min, int *p_max)
+{
+	int			min = 0;
+	int			max;
+
+	while (rp->pos < rp->end && isdigit((cl_uchar) *rp->pos))
+	{
+		min = min * 10 + (*rp->pos++ - '0');
+		if (min > REGEX_DUPMAX)
+			return false;
+	}
+	max = min;
+	if (rp->pos < rp->end && *rp->pos == ',')
+	{
+		rp->pos++;
+		if (rp->pos < rp->end && isdigit((cl_uchar) *rp->pos))
+		{
+			max = 0;
+			while (rp->pos < rp->end && isdigit((cl_uchar) *rp->pos))
+			{
+				max = max * 10 + (*rp->pos++ - '0');
+				if (max > REGEX_DUPMAX)
+					return false;
+			}
+			if (min > max)
+				return false;
+		}
+		else
+			max = -1;
+	}
+	if (rp->pos >= rp->end || *rp->pos != '}')
+		return false;
+	rp->pos++;
+	*p_min = min;
+	*p_max = max;
+	return true;
+}
+
+/*
+ * regex_parse_concat
+ */
+static RegexNode *
+regex_parse_concat(RegexParser *rp)
+{
+	RegexNode  *concat = regex_make_node(RXN_CONCAT);
+
+	while (rp->pos < rp->end && *rp->pos != '|' && *rp->pos != ')')
+	{
+		RegexNode  *atom = regex_parse_atom(rp);
+		int			min, max;
+
+		if (!atom)
+			return NULL;
+		if (rp->pos < rp->end)
+		{
+			char	c = *rp->pos;
+
+			if (c == '*' || c == '+' || c == '?' ||
+				(c == '{' && rp->pos + 1 < rp->end &&
+				 isdigit((cl_uchar) rp->pos[1])))
+			{
+				RegexNode  *repeat;
+
+				if (atom->tag == RXN_BOL || atom->tag == RXN_EOL)
+					return NULL;
+				rp->pos++;
+				if (c == '*')
+					min = 0, max = -1;
+				else if (c == '+')
+					min = 1, max = -1;
+				else if (c == '?')
+					min = 0, max = 1;
+				else if (!regex_parse_bound(rp, &min, &max))
+					return NULL;
+				/* non-greedy makes no difference on the boolean results */
+				if (rp->pos < rp->end && *rp->pos == '?')
+					rp->pos++;
+				/* nested quantifier is an error */
+				if (rp->pos < rp->end &&
+					(*rp->pos == '*' || *rp->pos == '+' || *rp->pos == '?' ||
+					 (*rp->pos == '{' && rp->pos + 1 < rp->end &&
+					  isdigit((cl_uchar) rp->pos[1]))))
+					return NULL;
+				repeat = regex_make_node(RXN_REPEAT);
+				repeat->child = atom;
+				repeat->min = min;
+				repeat->max = max;
+				atom = repeat;
+			}
+		}
+		concat->items = lappend(concat->items, atom);
+	}
+	return concat;
+}
+
+/*
+ * regex_parse_alt
+ */
+static RegexNode *
+regex_parse_alt(RegexParser *rp)
+{
+	RegexNode  *alt = regex_make_node(RXN_ALT);
+	RegexNode  *rnode;
+
+	for (;;)
+	{
+		rnode = regex_parse_concat(rp);
+		if (!rnode)
+			return NULL;
+		alt->items = lappend(alt->items, rnode);
+		if (rp->pos >= rp->end || *rp->pos != '|')
+			break;
+		rp->pos++;
+	}
+	if (list_length(alt->items) == 1)
+		return linitial(alt->items);
+	return alt;
+}
+
+/*
+ * regex_nfa_* - construction of Thompson's NFA
+ */
+static int
+regex_nfa_state(RegexNfa *nfa, int tag, bits8 *cset)
+{
+	RegexNfaState *nstate;
+
+	if (nfa->nstates >= REGEX_NFA_MAX_STATES)
+		return -1;
+	if (nfa->nstates >= nfa->nrooms)
+	{
+		nfa->nrooms = 2 * nfa->nrooms + 64;
+		nfa->states = repalloc(nfa->states,
+							   sizeof(RegexNfaState) * nfa->nrooms);
+	}
+	nstate = &nfa->states[nfa->nstates];
+	nstate->tag = tag;
+	nstate->out1 = -1;
+	nstate->out2 = -1;
+	nstate->cset = cset;
+
+	return nfa->nstates++;
+}
+
+/*
+ * regex_nfa_build - builds a fragment of NFA. *p_start and *p_end are
+ * the first and the last state of the fragment. out1 of the last state is
+ * not connected yet.
+ */
+static bool
+regex_nfa_build(RegexNfa *nfa, RegexNode *rnode, int *p_start, int *p_end)
+{
+	ListCell   *lc;
+	int			start, end;
+	int			s, e, i, split;
+
+	switch (rnode->tag)
+	{
+		case RXN_EMPTY:
+			start = end = regex_nfa_state(nfa, RXS_EPS, NULL);
+			break;
+
+		case RXN_CSET:
+		case RXN_BOL:
+		case RXN_EOL:
+			start = regex_nfa_state(nfa,
+									rnode->tag == RXN_CSET ? RXS_CSET :
+									rnode->tag == RXN_BOL  ? RXS_BOL : RXS_EOL,
+									rnode->cset);
+			end = regex_nfa_state(nfa, RXS_EPS, NULL);
+			if (start < 0 || end < 0)
+				return false;
+			nfa->states[start].out1 = end;
+			break;
+
+		case RXN_CONCAT:
+			start = end = regex_nfa_state(nfa, RXS_EPS, NULL);
+			foreach (lc, rnode->items)
+			{
+				if (end < 0 ||
+					!regex_nfa_build(nfa, lfirst(lc), &s, &e))
+					return false;
+				nfa->states[end].out1 = s;
+				end = e;
+			}
+			break;
+
+		case RXN_ALT:
+			start = split = regex_nfa_state(nfa, RXS_EPS, NULL);
+			end = regex_nfa_state(nfa, RXS_EPS, NULL);
+			foreach (lc, rnode->items)
+			{
+				if (split < 0 || end < 0 ||
+					!regex_nfa_build(nfa, lfirst(lc), &s, &e))
+					return false;
+				nfa->states[e].out1 = end;
+				nfa->states[split].out1 = s;
+				if (lnext(lc))
+				{
+					i = regex_nfa_state(nfa, RXS_EPS, NULL);
+					nfa->states[split].out2 = i;
+					split = i;
+				}
+			}
+			break;
+
+		case RXN_REPEAT:
+			start = end = regex_nfa_state(nfa, RXS_EPS, NULL);
+			for (i=0; i < rnode->min; i++)
+			{
+				if (end < 0 ||
+					!regex_nfa_build(nfa, rnode->child, &s, &e))
+					return false;
+				nfa->states[end].out1 = s;
+				end = e;
+			}
+			if (rnode->max < 0)
+			{
+				/* loop: split -> child -> split, or exit */
+				split = regex_nfa_state(nfa, RXS_EPS, NULL);
+				e = regex_nfa_state(nfa, RXS_EPS, NULL);
+				if (end < 0 || split < 0 || e < 0)
+					return false;
+				nfa->states[end].out1 = split;
+				nfa->states[split].out2 = e;
+				if (!regex_nfa_build(nfa, rnode->child, &s, &i))
+					return false;
+				nfa->states[split].out1 = s;
+				nfa->states[i].out1 = split;
+				end = e;
+			}
+			else if (rnode->max > rnode->min)
+			{
+				/* optional copies; each one may skip to the tail */
+				int		tail = regex_nfa_state(nfa, RXS_EPS, NULL);
+
+				for (i=rnode->min; i < rnode->max; i++)
+				{
+					split = regex_nfa_state(nfa, RXS_EPS, NULL);
+					if (end < 0 || split < 0 || tail < 0 ||
+						!regex_nfa_build(nfa, rnode->child, &s, &e))
+						return false;
+					nfa->states[end].out1 = split;
+					nfa->states[split].out1 = s;
+					nfa->states[split].out2 = tail;
+					end = e;
+				}
+				nfa->states[end].out1 = tail;
+				end = tail;
+			}
+			break;
+
+		default:
+			elog(ERROR, "Bug? unexpected regex node: %d", (int)rnode->tag);
+	}
+	if (start < 0 || end < 0)
+		return false;
+	*p_start = start;
+	*p_end = end;
+	return true;
+}
+
+/*
+ * regex_nfa_closure - adds states reachable by epsilon transitions
+ */
+static void
+regex_nfa_closure(RegexNfa *nfa, bits8 *set, int *stack,
+				  bool follow_bol, bool follow_eol)
+{
+	int			i, sp = 0;
+
+	for (i=0; i < nfa->nstates; i++)
+	{
+		if (CSET_TEST(set, i))
+			stack[sp++] = i;
+	}
+	while (sp > 0)
+	{
+		RegexNfaState *nstate = &nfa->states[stack[--sp]];
+		int		next[2];
+		int		j, n = 0;
+
+		if (nstate->tag == RXS_EPS)
+		{
+			next[n++] = nstate->out1;
+			next[n++] = nstate->out2;
+		}
+		else if ((nstate->tag == RXS_BOL && follow_bol) ||
+				 (nstate->tag == RXS_EOL && follow_eol))
+			next[n++] = nstate->out1;
+
+		for (j=0; j < n; j++)
+		{
+			if (next[j] >= 0 && !CSET_TEST(set, next[j]))
+			{
+				CSET_SET(set, next[j]);
+				stack[sp++] = next[j];
+			}
+		}
+	}
+}
+
+typedef struct
+{
+	int			state_id;
+	bits8		set[FLEXIBLE_ARRAY_MEMBER];		/* hash key */
+} RegexDfaEntry;
+
+/*
+ * regex_dfa_build - subset construction
+ */
+static kern_regex_dfa *
+regex_dfa_build(RegexNfa *nfa, int nfa_start, int nfa_match)
+{
+	Size		setsz = (nfa->nstates + 7) / 8;
+	bits8	  **dfa_sets;
+	cl_ushort  *trans = NULL;
+	cl_uchar   *flags;
+	cl_uchar	classes[256];
+	int			class_repr[256];
+	int			nclasses = 1;
+	int		   *stack;
+	bits8	   *work;
+	HASHCTL		hctl;
+	HTAB	   *htab;
+	RegexDfaEntry *entry;
+	kern_regex_dfa *dfa;
+	int			i, j, c, k;
+	int			nstates = 0;
+	bool		found;
+
+	/* byte-classes; refinement by the character sets of NFA */
+	memset(classes, 0, sizeof(classes));
+	for (i=0; i < nfa->nstates; i++)
+	{
+		int		remap[256][2];
+
+		if (nfa->states[i].tag != RXS_CSET)
+			continue;
+		memset(remap, -1, sizeof(remap));
+		k = 0;
+		for (c=0; c < 256; c++)
+		{
+			int		in = (CSET_TEST(nfa->states[i].cset, c) ? 1 : 0);
+
+			if (remap[classes[c]][in] < 0)
+				remap[classes[c]][in] = k++;
+			classes[c] = remap[classes[c]][in];
+		}
+		nclasses = k;
+	}
+	for (c=255; c >= 0; c--)
+		class_repr[classes[c]] = c;
+
+	/* hash table of the DFA states */
+	memset(&hctl, 0, sizeof(HASHCTL));
+	hctl.keysize = setsz;
+	hctl.entrysize = offsetof(RegexDfaEntry, set) + setsz;
+	hctl.hcxt = CurrentMemoryContext;
+	htab = hash_create("regex DFA states", 256, &hctl,
+					   HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	dfa_sets = palloc(sizeof(bits8 *) * REGEX_DFA_MAX_STATES);
+	flags = palloc0(sizeof(cl_uchar) * REGEX_DFA_MAX_STATES);
+	stack = palloc(sizeof(int) * nfa->nstates);
+	work = palloc(setsz);
+
+	/* the initial state */
+	memset(work, 0, setsz);
+	CSET_SET(work, nfa_start);
+	regex_nfa_closure(nfa, work, stack, true, false);
+	entry = hash_search(htab, work, HASH_ENTER, &found);
+	entry->state_id = nstates;
+	dfa_sets[nstates++] = entry->set;
+
+	for (i=0; i < nstates; i++)
+	{
+		bits8  *set = dfa_sets[i];
+		bool	has_cset = false;
+
+		/* state flags */
+		if (CSET_TEST(set, nfa_match))
+			flags[i] |= (REGEX_DFA__MATCHED | REGEX_DFA__ACCEPT_EOS);
+		else
+		{
+			memcpy(work, set, setsz);
+			regex_nfa_closure(nfa, work, stack, i == 0, true);
+			if (CSET_TEST(work, nfa_match))
+				flags[i] |= REGEX_DFA__ACCEPT_EOS;
+		}
+		for (j=0; j < nfa->nstates; j++)
+		{
+			if (CSET_TEST(set, j) && nfa->states[j].tag == RXS_CSET)
+			{
+				has_cset = true;
+				break;
+			}
+		}
+		if (!has_cset && (flags[i] & REGEX_DFA__ACCEPT_EOS) == 0)
+			flags[i] |= REGEX_DFA__DEAD;
+
+		/* transitions */
+		trans = (trans ? repalloc(trans, sizeof(cl_ushort) *
+								  nclasses * (i + 1))
+				 : palloc(sizeof(cl_ushort) * nclasses));
+		for (k=0; k < nclasses; k++)
+		{
+			if (flags[i] & (REGEX_DFA__MATCHED | REGEX_DFA__DEAD))
+			{
+				trans[i * nclasses + k] = i;
+				continue;
+			}
+			c = class_repr[k];
+			memset(work, 0, setsz);
+			CSET_SET(work, nfa_start);		/* unanchored search */
+			for (j=0; j < nfa->nstates; j++)
+			{
+				RegexNfaState *nstate = &nfa->states[j];
+
+				if (CSET_TEST(set, j) &&
+					nstate->tag == RXS_CSET &&
+					CSET_TEST(nstate->cset, c))
+					CSET_SET(work, nstate->out1);
+			}
+			regex_nfa_closure(nfa, work, stack, false, false);
+			entry = hash_search(htab, work, HASH_ENTER, &found);
+			if (!found)
+			{
+				if (nstates >= REGEX_DFA_MAX_STATES)
+					return NULL;
+				entry->state_id = nstates;
+				dfa_sets[nstates++] = entry->set;
+			}
+			trans[i * nclasses + k] = entry->state_id;
+		}
+	}
+	if (REGEX_DFA_LENGTH(nstates, nclasses) > REGEX_DFA_MAX_LENGTH)
+		return NULL;
+
+	dfa = palloc0(REGEX_DFA_LENGTH(nstates, nclasses));
+	SET_VARSIZE(dfa, REGEX_DFA_LENGTH(nstates, nclasses));
+	dfa->nstates = nstates;
+	dfa->nclasses = nclasses;
+	dfa->start = 0;
+	memcpy(dfa->classes, classes, sizeof(classes));
+	memcpy(dfa->trans, trans, sizeof(cl_ushort) * nstates * nclasses);
+	memcpy(REGEX_DFA_FLAGS(dfa), flags, sizeof(cl_uchar) * nstates);
+
+	return dfa;
+}
+
+/*
+ * pgstrom_regex_dfa_compile
+ *
+ * It compiles the regular expression to DFA, or returns NULL if pattern
+ * contains unsupported constructs.
+ */
+bytea *
+pgstrom_regex_dfa_compile(text *pattern, bool icase, Oid collid)
+{
+	MemoryContext	memcxt;
+	MemoryContext	oldcxt;
+	RegexParser		rp;
+	RegexNode	   *rnode;
+	RegexNfa		nfa;
+	kern_regex_dfa *dfa = NULL;
+	int				start, end, match;
+
+	if (!pgstrom_enable_regex_dfa)
+		return NULL;
+	if (GetDatabaseEncoding() != PG_UTF8 &&
+		pg_database_encoding_max_length() != 1)
+		return NULL;
+
+	memset(&rp, 0, sizeof(RegexParser));
+	rp.pos = VARDATA_ANY(pattern);
+	rp.end = rp.pos + VARSIZE_ANY_EXHDR(pattern);
+	rp.icase = icase;
+	rp.utf8 = (GetDatabaseEncoding() == PG_UTF8);
+	rp.ctype_is_c = (OidIsValid(collid) && lc_ctype_is_c(collid));
+	/* case-insensitive match requires LC_CTYPE = "C" */
+	if (icase && !rp.ctype_is_c)
+		return NULL;
+	/* director prefix (***: or ***=) */
+	if (rp.end - rp.pos >= 3 && strncmp(rp.pos, "***", 3) == 0)
+		return NULL;
+
+	memcxt = AllocSetContextCreate(CurrentMemoryContext,
+								   "regex DFA compiler",
+								   ALLOCSET_DEFAULT_SIZES);
+	oldcxt = MemoryContextSwitchTo(memcxt);
+
+	rnode = regex_parse_alt(&rp);
+	if (rnode && rp.pos >= rp.end)
+	{
+		memset(&nfa, 0, sizeof(RegexNfa));
+		nfa.nrooms = 256;
+		nfa.states = palloc(sizeof(RegexNfaState) * nfa.nrooms);
+		if (regex_nfa_build(&nfa, rnode, &start, &end) &&
+			(match = regex_nfa_state(&nfa, RXS_MATCH, NULL)) >= 0)
+		{
+			nfa.states[end].out1 = match;
+			dfa = regex_dfa_build(&nfa, start, match);
+		}
+	}
+	MemoryContextSwitchTo(oldcxt);
+	if (dfa)
+	{
+		kern_regex_dfa *temp = palloc(VARSIZE(dfa));
+
+		memcpy(temp, dfa, VARSIZE(dfa));
+		dfa = temp;
+	}
+	MemoryContextDelete(memcxt);
+
+	return (bytea *) dfa;
+}
+
+/*
+ * pgstrom_regex_dfa_bench
+ *
+ * It compares the DFA matcher with the PostgreSQL's regular expression
+ * engine, used on the CPU fallback path, by the supplied sample strings.
+ */
+Datum
+pgstrom_regex_dfa_bench(PG_FUNCTION_ARGS)
+{
+	ArrayType  *samples = PG_GETARG_ARRAYTYPE_P(0);
+	text	   *pattern = PG_GETARG_TEXT_PP(1);
+	bool		icase = PG_GETARG_BOOL(2);
+	int32		nloops = PG_GETARG_INT32(3);
+	Oid			collid = PG_GET_COLLATION();
+	TupleDesc	tupdesc;
+	kern_regex_dfa *dfa;
+	Datum	   *elems;
+	bool	   *nulls;
+	int			nitems;
+	int			i, loop;
+	int64		nmatched_dfa = 0;
+	int64		nmatched_pg = 0;
+	instr_time	tv1, tv2;
+	Datum		values[6];
+	bool		isnull[6];
+
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+	if (nloops < 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("nloops must be positive")));
+	if (!OidIsValid(collid))
+		collid = DEFAULT_COLLATION_OID;
+	deconstruct_array(samples, TEXTOID, -1, false, 'i',
+					  &elems, &nulls, &nitems);
+	memset(isnull, 0, sizeof(isnull));
+
+	/* DFA matcher */
+	dfa = (kern_regex_dfa *)
+		pgstrom_regex_dfa_compile(pattern, icase, collid);
+	if (!dfa)
+	{
+		isnull[0] = isnull[1] = isnull[2] = isnull[4] = true;
+	}
+	else
+	{
+		INSTR_TIME_SET_CURRENT(tv1);
+		for (loop=0; loop < nloops; loop++)
+		{
+			for (i=0; i < nitems; i++)
+			{
+				text   *t;
+
+				if (nulls[i])
+					continue;
+				t = DatumGetTextPP(elems[i]);
+				if (regex_dfa_exec(dfa, VARDATA_ANY(t),
+								   VARSIZE_ANY_EXHDR(t)) && loop == 0)
+					nmatched_dfa++;
+			}
+		}
+		INSTR_TIME_SET_CURRENT(tv2);
+		INSTR_TIME_SUBTRACT(tv2, tv1);
+		values[0] = Int32GetDatum(dfa->nstates);
+		values[1] = Int32GetDatum(dfa->nclasses);
+		values[2] = Int64GetDatum(nmatched_dfa);
+		values[4] = Float8GetDatum(INSTR_TIME_GET_MILLISEC(tv2));
+	}
+
+	/* PostgreSQL's engine */
+	INSTR_TIME_SET_CURRENT(tv1);
+	for (loop=0; loop < nloops; loop++)
+	{
+		for (i=0; i < nitems; i++)
+		{
+			if (nulls[i])
+				continue;
+			if (DatumGetBool(DirectFunctionCall2Coll(icase
+													 ? texticregexeq
+													 : textregexeq,
+													 collid,
+													 elems[i],
+													 PointerGetDatum(pattern)))
+				&& loop == 0)
+				nmatched_pg++;
+		}
+	}
+	INSTR_TIME_SET_CURRENT(tv2);
+	INSTR_TIME_SUBTRACT(tv2, tv1);
+	values[3] = Int64GetDatum(nmatched_pg);
+	values[5] = Float8GetDatum(INSTR_TIME_GET_MILLISEC(tv2));
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc,
+													  values, isnull)));
+}
+PG_FUNCTION_INFO_V1(pgstrom_regex_dfa_bench);
+
+/*
+ * pgstrom_init_regex_dfa
+ */
+void
+pgstrom_init_regex_dfa(void)
+{
+	/* pg_strom.enable_regex_dfa */
+	DefineCustomBoolVariable("pg_strom.enable_regex_dfa",
+							 "Enables regular expression operators on GPU device, compiled to DFA",
+							 NULL,
+							 &pgstrom_enable_regex_dfa,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+}
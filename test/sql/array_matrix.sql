@@ -0,0 +1,84 @@
+---
+--- Test cases for array_matrix aggregates under parallel query
+---
+CREATE TABLE array_matrix_t AS
+  SELECT x id, x % 1000 a, (x * 7) % 1000 b, x % 17 c
+    FROM generate_series(1,400000) x;
+
+SET pg_strom.enabled = off;
+SET max_parallel_workers_per_gather = 0;
+SELECT array_matrix_height(m) h, array_matrix_width(m) w,
+       (SELECT count(*) FROM (SELECT a, b, c FROM array_matrix_t
+                              EXCEPT ALL
+                              SELECT * FROM matrix_unnest(m)
+                                         AS x(a int, b int, c int)) d) diff
+  FROM (SELECT array_matrix(a, b, c) m FROM array_matrix_t) q;
+SELECT array_matrix_height(m) h, array_matrix_width(m) w,
+       (SELECT count(*) FROM (SELECT a::float8, c::float8 FROM array_matrix_t
+                               WHERE id % 3 = 0
+                              EXCEPT ALL
+                              SELECT * FROM matrix_unnest(m)
+                                         AS x(a float8, c float8)) d) diff
+  FROM (SELECT array_matrix(a::float8, c::float8) m
+          FROM array_matrix_t WHERE id % 3 = 0) q;
+
+-- partial aggregation by parallel workers
+SET max_parallel_workers_per_gather = 4;
+SET parallel_setup_cost = 0;
+SET parallel_tuple_cost = 0;
+ALTER TABLE array_matrix_t SET (parallel_workers = 4);
+EXPLAIN (costs off)
+SELECT array_matrix(a, b, c) FROM array_matrix_t;
+SELECT array_matrix_height(m) h, array_matrix_width(m) w,
+       (SELECT count(*) FROM (SELECT a, b, c FROM array_matrix_t
+                              EXCEPT ALL
+                              SELECT * FROM matrix_unnest(m)
+                                         AS x(a int, b int, c int)) d) diff
+  FROM (SELECT array_matrix(a, b, c) m FROM array_matrix_t) q;
+SELECT array_matrix_height(m) h, array_matrix_width(m) w,
+       (SELECT count(*) FROM (SELECT a::float8, c::float8 FROM array_matrix_t
+                               WHERE id % 3 = 0
+                              EXCEPT ALL
+                              SELECT * FROM matrix_unnest(m)
+                                         AS x(a float8, c float8)) d) diff
+  FROM (SELECT array_matrix(a::float8, c::float8) m
+          FROM array_matrix_t WHERE id % 3 = 0) q;
+RESET parallel_tuple_cost;
+RESET parallel_setup_cost;
+RESET max_parallel_workers_per_gather;
+RESET pg_strom.enabled;
+
+-- transpose/rbind over the tile and SIMD block boundaries
+SELECT array_matrix_height(r) h, array_matrix_width(r) w,
+       (SELECT count(*) FROM (SELECT a, b, c, a, b, c FROM array_matrix_t
+                               WHERE id <= 1001
+                              EXCEPT ALL
+                              SELECT * FROM matrix_unnest(r)
+                                         AS x(a1 int, b1 int, c1 int,
+                                              a2 int, b2 int, c2 int)) d) diff
+  FROM (SELECT transpose(rbind(t, t)) r
+          FROM (SELECT transpose(array_matrix(a, b, c)) t
+                  FROM array_matrix_t WHERE id <= 1001) q1) q2;
+SELECT array_matrix_height(r) h, array_matrix_width(r) w,
+       (SELECT count(*) FROM (SELECT a::int2, c::int2, a::int2, c::int2
+                                FROM array_matrix_t WHERE id <= 1001
+                              EXCEPT ALL
+                              SELECT * FROM matrix_unnest(r)
+                                         AS x(a1 int2, c1 int2,
+                                              a2 int2, c2 int2)) d) diff
+  FROM (SELECT transpose(rbind(t, t)) r
+          FROM (SELECT transpose(array_matrix(a::int2, c::int2)) t
+                  FROM array_matrix_t WHERE id <= 1001) q1) q2;
+SELECT array_matrix_height(r) h, array_matrix_width(r) w,
+       (SELECT count(*) FROM (SELECT a::float8, b::float8 / 4,
+                                     a::float8, b::float8 / 4
+                                FROM array_matrix_t WHERE id <= 1001
+                              EXCEPT ALL
+                              SELECT * FROM matrix_unnest(r)
+                                         AS x(a1 float8, b1 float8,
+                                              a2 float8, b2 float8)) d) diff
+  FROM (SELECT transpose(rbind(t, t)) r
+          FROM (SELECT transpose(array_matrix(a::float8, b::float8 / 4)) t
+                  FROM array_matrix_t WHERE id <= 1001) q1) q2;
+
+DROP TABLE array_matrix_t;
@@ -0,0 +1,73 @@
+---
+--- Test cases for common sub-expressions in the device code
+---
+CREATE TABLE codegen_cse_t AS
+  SELECT x id, (x % 97) - 10 a, (x % 13) b,
+         '2019-01-01'::timestamp + (x || ' hours')::interval ts
+    FROM generate_series(1,20000) x;
+
+-- projection and grouping keys with common sub-expressions
+RESET pg_strom.enabled;
+SET pg_strom.enable_codegen_cse = on;
+SELECT id, (a + b) * 2 v1, (a + b) * 3 v2, (a + b) % 7 v3,
+       extract(year from ts + '3 days'::interval) v4,
+       extract(month from ts + '3 days'::interval) v5
+  INTO pg_temp.test_c01a
+  FROM codegen_cse_t
+ WHERE (a + b) % 3 = 0 OR (a + b) < 0;
+SELECT (a * b) % 5 k, count(*), sum(a * b), max(a * b)
+  INTO pg_temp.test_c02a
+  FROM codegen_cse_t
+ GROUP BY (a * b) % 5;
+-- expressions guarded by AND/CASE must not be hoisted
+SELECT id, CASE WHEN b <> 0 THEN a / b END v1,
+           CASE WHEN b <> 0 THEN a / b + 1 END v2
+  INTO pg_temp.test_c03a
+  FROM codegen_cse_t
+ WHERE b <> 0 AND a / b > 1 AND a / b < 5;
+SET pg_strom.enable_codegen_cse = off;
+SELECT id, (a + b) * 2 v1, (a + b) * 3 v2, (a + b) % 7 v3,
+       extract(year from ts + '3 days'::interval) v4,
+       extract(month from ts + '3 days'::interval) v5
+  INTO pg_temp.test_c01b
+  FROM codegen_cse_t
+ WHERE (a + b) % 3 = 0 OR (a + b) < 0;
+SELECT (a * b) % 5 k, count(*), sum(a * b), max(a * b)
+  INTO pg_temp.test_c02b
+  FROM codegen_cse_t
+ GROUP BY (a * b) % 5;
+SELECT id, CASE WHEN b <> 0 THEN a / b END v1,
+           CASE WHEN b <> 0 THEN a / b + 1 END v2
+  INTO pg_temp.test_c03b
+  FROM codegen_cse_t
+ WHERE b <> 0 AND a / b > 1 AND a / b < 5;
+RESET pg_strom.enable_codegen_cse;
+SET pg_strom.enabled = off;
+SELECT id, (a + b) * 2 v1, (a + b) * 3 v2, (a + b) % 7 v3,
+       extract(year from ts + '3 days'::interval) v4,
+       extract(month from ts + '3 days'::interval) v5
+  INTO pg_temp.test_c01c
+  FROM codegen_cse_t
+ WHERE (a + b) % 3 = 0 OR (a + b) < 0;
+SELECT (a * b) % 5 k, count(*), sum(a * b), max(a * b)
+  INTO pg_temp.test_c02c
+  FROM codegen_cse_t
+ GROUP BY (a * b) % 5;
+SELECT id, CASE WHEN b <> 0 THEN a / b END v1,
+           CASE WHEN b <> 0 THEN a / b + 1 END v2
+  INTO pg_temp.test_c03c
+  FROM codegen_cse_t
+ WHERE b <> 0 AND a / b > 1 AND a / b < 5;
+RESET pg_strom.enabled;
+
+(SELECT * FROM pg_temp.test_c01a EXCEPT ALL SELECT * FROM pg_temp.test_c01c);
+(SELECT * FROM pg_temp.test_c01b EXCEPT ALL SELECT * FROM pg_temp.test_c01c);
+(SELECT * FROM pg_temp.test_c01c EXCEPT ALL SELECT * FROM pg_temp.test_c01a);
+(SELECT * FROM pg_temp.test_c02a EXCEPT ALL SELECT * FROM pg_temp.test_c02c);
+(SELECT * FROM pg_temp.test_c02b EXCEPT ALL SELECT * FROM pg_temp.test_c02c);
+(SELECT * FROM pg_temp.test_c02c EXCEPT ALL SELECT * FROM pg_temp.test_c02a);
+(SELECT * FROM pg_temp.test_c03a EXCEPT ALL SELECT * FROM pg_temp.test_c03c);
+(SELECT * FROM pg_temp.test_c03b EXCEPT ALL SELECT * FROM pg_temp.test_c03c);
+(SELECT * FROM pg_temp.test_c03c EXCEPT ALL SELECT * FROM pg_temp.test_c03a);
+
+DROP TABLE codegen_cse_t;
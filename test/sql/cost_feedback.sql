@@ -0,0 +1,43 @@
+---
+--- Test cases for the cost feedback of GPU nodes
+---
+CREATE TABLE cost_feedback_t AS
+  SELECT x id, (x % 100) a, md5(x::text) memo
+    FROM generate_series(1,100000) x;
+ANALYZE cost_feedback_t;
+
+RESET pg_strom.enabled;
+SET enable_seqscan = off;
+SET max_parallel_workers_per_gather = 0;
+SELECT pgstrom.cost_feedback_reset();
+SELECT count(*) FROM pgstrom.cost_feedback;
+SELECT count(*) FROM pgstrom.cost_feedback_fit();
+
+-- EXPLAIN ANALYZE records the actual behavior of GpuScan
+DO $$
+BEGIN
+  EXECUTE 'EXPLAIN ANALYZE SELECT * FROM cost_feedback_t WHERE a < 40';
+END;
+$$;
+SELECT node, plan_rows > 0 plan_rows, actual_rows, source_rows,
+       chunks > 0 chunks, kernels > 0 kernels, gpu_time > 0 gpu_time
+  FROM pgstrom.cost_feedback;
+-- only devices with the records are fitted, without negative coefficients
+SELECT count(*) devices, count(DISTINCT device_nr) = count(*) uniq,
+       sum(nsamples) nsamples,
+       bool_and(kernel_ms >= 0 AND row_ns >= 0 AND chunk_ms >= 0 AND
+                (dma_mbps IS NULL OR dma_mbps > 0)) non_negative
+  FROM pgstrom.cost_feedback_fit();
+SELECT count(*) FROM pgstrom.cost_feedback_fit(now() + interval '1 day');
+RESET enable_seqscan;
+RESET max_parallel_workers_per_gather;
+
+-- only superuser can clear the records
+CREATE ROLE regress_cost_feedback_user;
+GRANT USAGE ON SCHEMA pgstrom TO regress_cost_feedback_user;
+SET ROLE regress_cost_feedback_user;
+SELECT pgstrom.cost_feedback_reset();
+RESET ROLE;
+REVOKE USAGE ON SCHEMA pgstrom FROM regress_cost_feedback_user;
+DROP ROLE regress_cost_feedback_user;
+DROP TABLE cost_feedback_t;
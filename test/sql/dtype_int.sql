@@ -210,3 +210,551 @@ SELECT l.e, null::int, r.f
 (SELECT * FROM pg_temp.test_l05b EXCEPT ALL SELECT * FROM pg_temp.test_l05a);
 (SELECT * FROM pg_temp.test_l06a EXCEPT ALL SELECT * FROM pg_temp.test_l06b);
 (SELECT * FROM pg_temp.test_l06b EXCEPT ALL SELECT * FROM pg_temp.test_l06a);
+
+--
+-- IN-list with large constant array
+--
+RESET pg_strom.enabled;
+SET pg_strom.scalar_array_op_hashed_threshold = 128;
+SELECT id, a
+  INTO pg_temp.test_n01a
+  FROM t_int1
+ WHERE a IN (
+    -32767, -32556, -32345, -32134, -31923, -31712, -31501, -31290, -31079,
+    -30868, -30657, -30446, -30235, -30024, -29813, -29602, -29391, -29180,
+    -28969, -28758, -28547, -28336, -28125, -27914, -27703, -27492, -27281,
+    -27070, -26859, -26648, -26437, -26226, -26015, -25804, -25593, -25382,
+    -25171, -24960, -24749, -24538, -24327, -24116, -23905, -23694, -23483,
+    -23272, -23061, -22850, -22639, -22428, -22217, -22006, -21795, -21584,
+    -21373, -21162, -20951, -20740, -20529, -20318, -20107, -19896, -19685,
+    -19474, -19263, -19052, -18841, -18630, -18419, -18208, -17997, -17786,
+    -17575, -17364, -17153, -16942, -16731, -16520, -16309, -16098, -15887,
+    -15676, -15465, -15254, -15043, -14832, -14621, -14410, -14199, -13988,
+    -13777, -13566, -13355, -13144, -12933, -12722, -12511, -12300, -12089,
+    -11878, -11667, -11456, -11245, -11034, -10823, -10612, -10401, -10190,
+    -9979, -9768, -9557, -9346, -9135, -8924, -8713, -8502, -8291, -8080,
+    -7869, -7658, -7447, -7236, -7025, -6814, -6603, -6392, -6181, -5970,
+    -5759, -5548, -5337, -5126, -4915, -4704, -4493, -4282, -4071, -3860,
+    -3649, -3438, -3227, -3016, -2805, -2594, -2383, -2172, -1961, -1750,
+    -1539, -1328, -1117, -906, -695, -484, -273, -62, 149, 360, 571, 782,
+    993, 1204, 1415, 1626, 1837, 2048, 2259, 2470, 2681, 2892, 3103, 3314,
+    3525, 3736, 3947, 4158, 4369, 4580, 4791, 5002, 5213, 5424, 5635, 5846,
+    6057, 6268, 6479, 6690, 6901, 7112, 7323, 7534, 7745, 7956, 8167, 8378,
+    8589, 8800, 9011, 9222, 9433, 9644, 9855, 10066, 10277, 10488, 10699,
+    10910, 11121, 11332, 11543, 11754, 11965, 12176, 12387, 12598, 12809,
+    13020, 13231, 13442, 13653, 13864, 14075, 14286, 14497, 14708, 14919,
+    15130, 15341, 15552, 15763, 15974, 16185, 16396, 16607, 16818, 17029,
+    17240, 17451, 17662, 17873, 18084, 18295, 18506, 18717, 18928, 19139,
+    19350, 19561, 19772, 19983, 20194, 20405, 20616, 20827, 21038, 21249,
+    21460, 21671, 21882, 22093, 22304, 22515, 22726, 22937, 23148, 23359,
+    23570, 23781, 23992, 24203, 24414, 24625, 24836, 25047, 25258, 25469,
+    25680, 25891, 26102, 26313, 26524, 26735, 26946, 27157, 27368, 27579,
+    27790, 28001, 28212, 28423, 28634, 28845, 29056, 29267, 29478, 29689,
+    29900, 30111, 30322, 30533, 30744, 30955, 31166, 31377, 31588, 31799,
+    32010, 32221, 32432, 32643);
+SELECT id, c
+  INTO pg_temp.test_n02a
+  FROM t_int1
+ WHERE id % 100 = 7 AND c NOT IN (
+    -1187850, -1179931, -1172012, -1164093, -1156174, -1148255, -1140336,
+    -1132417, -1124498, -1116579, -1108660, -1100741, -1092822, -1084903,
+    -1076984, -1069065, -1061146, -1053227, -1045308, -1037389, -1029470,
+    -1021551, -1013632, -1005713, -997794, -989875, -981956, -974037,
+    -966118, -958199, -950280, -942361, -934442, -926523, -918604, -910685,
+    -902766, -894847, -886928, -879009, -871090, -863171, -855252, -847333,
+    -839414, -831495, -823576, -815657, -807738, -799819, -791900, -783981,
+    -776062, -768143, -760224, -752305, -744386, -736467, -728548, -720629,
+    -712710, -704791, -696872, -688953, -681034, -673115, -665196, -657277,
+    -649358, -641439, -633520, -625601, -617682, -609763, -601844, -593925,
+    -586006, -578087, -570168, -562249, -554330, -546411, -538492, -530573,
+    -522654, -514735, -506816, -498897, -490978, -483059, -475140, -467221,
+    -459302, -451383, -443464, -435545, -427626, -419707, -411788, -403869,
+    -395950, -388031, -380112, -372193, -364274, -356355, -348436, -340517,
+    -332598, -324679, -316760, -308841, -300922, -293003, -285084, -277165,
+    -269246, -261327, -253408, -245489, -237570, -229651, -221732, -213813,
+    -205894, -197975, -190056, -182137, -174218, -166299, -158380, -150461,
+    -142542, -134623, -126704, -118785, -110866, -102947, -95028, -87109,
+    -79190, -71271, -63352, -55433, -47514, -39595, -31676, -23757, -15838,
+    -7919, 0, 7919, 15838, 23757, 31676, 39595, 47514, 55433, 63352, 71271,
+    79190, 87109, 95028, 102947, 110866, 118785, 126704, 134623, 142542,
+    150461, 158380, 166299, 174218, 182137, 190056, 197975, 205894, 213813,
+    221732, 229651, 237570, 245489, 253408, 261327, 269246, 277165, 285084,
+    293003, 300922, 308841, 316760, 324679, 332598, 340517, 348436, 356355,
+    364274, 372193, 380112, 388031, 395950, 403869, 411788, 419707, 427626,
+    435545, 443464, 451383, 459302, 467221, 475140, 483059, 490978, 498897,
+    506816, 514735, 522654, 530573, 538492, 546411, 554330, 562249, 570168,
+    578087, 586006, 593925, 601844, 609763, 617682, 625601, 633520, 641439,
+    649358, 657277, 665196, 673115, 681034, 688953, 696872, 704791, 712710,
+    720629, 728548, 736467, 744386, 752305, 760224, 768143, 776062, 783981,
+    791900, 799819, 807738, 815657, 823576, 831495, 839414, 847333, 855252,
+    863171, 871090, 879009, 886928, 894847, 902766, 910685, 918604, 926523,
+    934442, 942361, 950280, 958199, 966118, 974037, 981956, 989875, 997794,
+    1005713, 1013632, 1021551, 1029470, 1037389, 1045308, 1053227, 1061146,
+    1069065, 1076984, 1084903, 1092822, 1100741, 1108660, 1116579, 1124498,
+    1132417, 1140336, 1148255, 1156174, 1164093, 1172012, 1179931);
+SELECT id, e
+  INTO pg_temp.test_n03a
+  FROM t_int1
+ WHERE e = ANY (ARRAY[
+    -20945800, -20841071, -20736342, -20631613, -20526884, -20422155,
+    -20317426, -20212697, -20107968, -20003239, -19898510, -19793781,
+    -19689052, -19584323, -19479594, -19374865, -19270136, -19165407,
+    -19060678, -18955949, -18851220, -18746491, -18641762, -18537033,
+    -18432304, -18327575, -18222846, -18118117, -18013388, -17908659,
+    -17803930, -17699201, -17594472, -17489743, -17385014, -17280285,
+    -17175556, -17070827, -16966098, -16861369, -16756640, -16651911,
+    -16547182, -16442453, -16337724, -16232995, -16128266, -16023537,
+    -15918808, -15814079, -15709350, -15604621, -15499892, -15395163,
+    -15290434, -15185705, -15080976, -14976247, -14871518, -14766789,
+    -14662060, -14557331, -14452602, -14347873, -14243144, -14138415,
+    -14033686, -13928957, -13824228, -13719499, -13614770, -13510041,
+    -13405312, -13300583, -13195854, -13091125, -12986396, -12881667,
+    -12776938, -12672209, -12567480, -12462751, -12358022, -12253293,
+    -12148564, -12043835, -11939106, -11834377, -11729648, -11624919,
+    -11520190, -11415461, -11310732, -11206003, -11101274, -10996545,
+    -10891816, -10787087, -10682358, -10577629, -10472900, -10368171,
+    -10263442, -10158713, -10053984, -9949255, -9844526, -9739797,
+    -9635068, -9530339, -9425610, -9320881, -9216152, -9111423, -9006694,
+    -8901965, -8797236, -8692507, -8587778, -8483049, -8378320, -8273591,
+    -8168862, -8064133, -7959404, -7854675, -7749946, -7645217, -7540488,
+    -7435759, -7331030, -7226301, -7121572, -7016843, -6912114, -6807385,
+    -6702656, -6597927, -6493198, -6388469, -6283740, -6179011, -6074282,
+    -5969553, -5864824, -5760095, -5655366, -5550637, -5445908, -5341179,
+    -5236450, -5131721, -5026992, -4922263, -4817534, -4712805, -4608076,
+    -4503347, -4398618, -4293889, -4189160, -4084431, -3979702, -3874973,
+    -3770244, -3665515, -3560786, -3456057, -3351328, -3246599, -3141870,
+    -3037141, -2932412, -2827683, -2722954, -2618225, -2513496, -2408767,
+    -2304038, -2199309, -2094580, -1989851, -1885122, -1780393, -1675664,
+    -1570935, -1466206, -1361477, -1256748, -1152019, -1047290, -942561,
+    -837832, -733103, -628374, -523645, -418916, -314187, -209458, -104729,
+    0, 104729, 209458, 314187, 418916, 523645, 628374, 733103, 837832,
+    942561, 1047290, 1152019, 1256748, 1361477, 1466206, 1570935, 1675664,
+    1780393, 1885122, 1989851, 2094580, 2199309, 2304038, 2408767, 2513496,
+    2618225, 2722954, 2827683, 2932412, 3037141, 3141870, 3246599, 3351328,
+    3456057, 3560786, 3665515, 3770244, 3874973, 3979702, 4084431, 4189160,
+    4293889, 4398618, 4503347, 4608076, 4712805, 4817534, 4922263, 5026992,
+    5131721, 5236450, 5341179, 5445908, 5550637, 5655366, 5760095, 5864824,
+    5969553, 6074282, 6179011, 6283740, 6388469, 6493198, 6597927, 6702656,
+    6807385, 6912114, 7016843, 7121572, 7226301, 7331030, 7435759, 7540488,
+    7645217, 7749946, 7854675, 7959404, 8064133, 8168862, 8273591, 8378320,
+    8483049, 8587778, 8692507, 8797236, 8901965, 9006694, 9111423, 9216152,
+    9320881, 9425610, 9530339, 9635068, 9739797, 9844526, 9949255,
+    10053984, 10158713, 10263442, 10368171, 10472900, 10577629, 10682358,
+    10787087, 10891816, 10996545, 11101274, 11206003, 11310732, 11415461,
+    11520190, 11624919, 11729648, 11834377, 11939106, 12043835, 12148564,
+    12253293, 12358022, 12462751, 12567480, 12672209, 12776938, 12881667,
+    12986396, 13091125, 13195854, 13300583, 13405312, 13510041, 13614770,
+    13719499, 13824228, 13928957, 14033686, 14138415, 14243144, 14347873,
+    14452602, 14557331, 14662060, 14766789, 14871518, 14976247, 15080976,
+    15185705, 15290434, 15395163, 15499892, 15604621, 15709350, 15814079,
+    15918808, 16023537, 16128266, 16232995, 16337724, 16442453, 16547182,
+    16651911, 16756640, 16861369, 16966098, 17070827, 17175556, 17280285,
+    17385014, 17489743, 17594472, 17699201, 17803930, 17908659, 18013388,
+    18118117, 18222846, 18327575, 18432304, 18537033, 18641762, 18746491,
+    18851220, 18955949, 19060678, 19165407, 19270136, 19374865, 19479594,
+    19584323, 19689052, 19793781, 19898510, 20003239, 20107968, 20212697,
+    20317426, 20422155, 20526884, 20631613, 20736342, 20841071]);
+SELECT id, a
+  INTO pg_temp.test_n04a
+  FROM t_int1
+ WHERE a NOT IN (NULL,
+    -32767, -32556, -32345, -32134, -31923, -31712, -31501, -31290, -31079,
+    -30868, -30657, -30446, -30235, -30024, -29813, -29602, -29391, -29180,
+    -28969, -28758, -28547, -28336, -28125, -27914, -27703, -27492, -27281,
+    -27070, -26859, -26648, -26437, -26226, -26015, -25804, -25593, -25382,
+    -25171, -24960, -24749, -24538, -24327, -24116, -23905, -23694, -23483,
+    -23272, -23061, -22850, -22639, -22428, -22217, -22006, -21795, -21584,
+    -21373, -21162, -20951, -20740, -20529, -20318, -20107, -19896, -19685,
+    -19474, -19263, -19052, -18841, -18630, -18419, -18208, -17997, -17786,
+    -17575, -17364, -17153, -16942, -16731, -16520, -16309, -16098, -15887,
+    -15676, -15465, -15254, -15043, -14832, -14621, -14410, -14199, -13988,
+    -13777, -13566, -13355, -13144, -12933, -12722, -12511, -12300, -12089,
+    -11878, -11667, -11456, -11245, -11034, -10823, -10612, -10401, -10190,
+    -9979, -9768, -9557, -9346, -9135, -8924, -8713, -8502, -8291, -8080,
+    -7869, -7658, -7447, -7236, -7025, -6814, -6603, -6392, -6181, -5970,
+    -5759, -5548, -5337, -5126, -4915, -4704, -4493, -4282, -4071, -3860,
+    -3649, -3438, -3227, -3016, -2805, -2594, -2383, -2172, -1961, -1750,
+    -1539, -1328, -1117, -906, -695, -484, -273, -62, 149, 360, 571, 782,
+    993, 1204, 1415, 1626, 1837, 2048, 2259, 2470, 2681, 2892, 3103, 3314,
+    3525, 3736, 3947, 4158, 4369, 4580, 4791, 5002, 5213, 5424, 5635, 5846,
+    6057, 6268, 6479, 6690, 6901, 7112, 7323, 7534, 7745, 7956, 8167, 8378,
+    8589, 8800, 9011, 9222, 9433, 9644, 9855, 10066, 10277, 10488, 10699,
+    10910, 11121, 11332, 11543, 11754, 11965, 12176, 12387, 12598, 12809,
+    13020, 13231, 13442, 13653, 13864, 14075, 14286, 14497, 14708, 14919,
+    15130, 15341, 15552, 15763, 15974, 16185, 16396, 16607, 16818, 17029,
+    17240, 17451, 17662, 17873, 18084, 18295, 18506, 18717, 18928, 19139,
+    19350, 19561, 19772, 19983, 20194, 20405, 20616, 20827, 21038, 21249,
+    21460, 21671, 21882, 22093, 22304, 22515, 22726, 22937, 23148, 23359,
+    23570, 23781, 23992, 24203, 24414, 24625, 24836, 25047, 25258, 25469,
+    25680, 25891, 26102, 26313, 26524, 26735, 26946, 27157, 27368, 27579,
+    27790, 28001, 28212, 28423, 28634, 28845, 29056, 29267, 29478, 29689,
+    29900, 30111, 30322, 30533, 30744, 30955, 31166, 31377, 31588, 31799,
+    32010, 32221, 32432, 32643);
+SET pg_strom.scalar_array_op_hashed_threshold = 0;
+SELECT id, a
+  INTO pg_temp.test_n01b
+  FROM t_int1
+ WHERE a IN (
+    -32767, -32556, -32345, -32134, -31923, -31712, -31501, -31290, -31079,
+    -30868, -30657, -30446, -30235, -30024, -29813, -29602, -29391, -29180,
+    -28969, -28758, -28547, -28336, -28125, -27914, -27703, -27492, -27281,
+    -27070, -26859, -26648, -26437, -26226, -26015, -25804, -25593, -25382,
+    -25171, -24960, -24749, -24538, -24327, -24116, -23905, -23694, -23483,
+    -23272, -23061, -22850, -22639, -22428, -22217, -22006, -21795, -21584,
+    -21373, -21162, -20951, -20740, -20529, -20318, -20107, -19896, -19685,
+    -19474, -19263, -19052, -18841, -18630, -18419, -18208, -17997, -17786,
+    -17575, -17364, -17153, -16942, -16731, -16520, -16309, -16098, -15887,
+    -15676, -15465, -15254, -15043, -14832, -14621, -14410, -14199, -13988,
+    -13777, -13566, -13355, -13144, -12933, -12722, -12511, -12300, -12089,
+    -11878, -11667, -11456, -11245, -11034, -10823, -10612, -10401, -10190,
+    -9979, -9768, -9557, -9346, -9135, -8924, -8713, -8502, -8291, -8080,
+    -7869, -7658, -7447, -7236, -7025, -6814, -6603, -6392, -6181, -5970,
+    -5759, -5548, -5337, -5126, -4915, -4704, -4493, -4282, -4071, -3860,
+    -3649, -3438, -3227, -3016, -2805, -2594, -2383, -2172, -1961, -1750,
+    -1539, -1328, -1117, -906, -695, -484, -273, -62, 149, 360, 571, 782,
+    993, 1204, 1415, 1626, 1837, 2048, 2259, 2470, 2681, 2892, 3103, 3314,
+    3525, 3736, 3947, 4158, 4369, 4580, 4791, 5002, 5213, 5424, 5635, 5846,
+    6057, 6268, 6479, 6690, 6901, 7112, 7323, 7534, 7745, 7956, 8167, 8378,
+    8589, 8800, 9011, 9222, 9433, 9644, 9855, 10066, 10277, 10488, 10699,
+    10910, 11121, 11332, 11543, 11754, 11965, 12176, 12387, 12598, 12809,
+    13020, 13231, 13442, 13653, 13864, 14075, 14286, 14497, 14708, 14919,
+    15130, 15341, 15552, 15763, 15974, 16185, 16396, 16607, 16818, 17029,
+    17240, 17451, 17662, 17873, 18084, 18295, 18506, 18717, 18928, 19139,
+    19350, 19561, 19772, 19983, 20194, 20405, 20616, 20827, 21038, 21249,
+    21460, 21671, 21882, 22093, 22304, 22515, 22726, 22937, 23148, 23359,
+    23570, 23781, 23992, 24203, 24414, 24625, 24836, 25047, 25258, 25469,
+    25680, 25891, 26102, 26313, 26524, 26735, 26946, 27157, 27368, 27579,
+    27790, 28001, 28212, 28423, 28634, 28845, 29056, 29267, 29478, 29689,
+    29900, 30111, 30322, 30533, 30744, 30955, 31166, 31377, 31588, 31799,
+    32010, 32221, 32432, 32643);
+SELECT id, c
+  INTO pg_temp.test_n02b
+  FROM t_int1
+ WHERE id % 100 = 7 AND c NOT IN (
+    -1187850, -1179931, -1172012, -1164093, -1156174, -1148255, -1140336,
+    -1132417, -1124498, -1116579, -1108660, -1100741, -1092822, -1084903,
+    -1076984, -1069065, -1061146, -1053227, -1045308, -1037389, -1029470,
+    -1021551, -1013632, -1005713, -997794, -989875, -981956, -974037,
+    -966118, -958199, -950280, -942361, -934442, -926523, -918604, -910685,
+    -902766, -894847, -886928, -879009, -871090, -863171, -855252, -847333,
+    -839414, -831495, -823576, -815657, -807738, -799819, -791900, -783981,
+    -776062, -768143, -760224, -752305, -744386, -736467, -728548, -720629,
+    -712710, -704791, -696872, -688953, -681034, -673115, -665196, -657277,
+    -649358, -641439, -633520, -625601, -617682, -609763, -601844, -593925,
+    -586006, -578087, -570168, -562249, -554330, -546411, -538492, -530573,
+    -522654, -514735, -506816, -498897, -490978, -483059, -475140, -467221,
+    -459302, -451383, -443464, -435545, -427626, -419707, -411788, -403869,
+    -395950, -388031, -380112, -372193, -364274, -356355, -348436, -340517,
+    -332598, -324679, -316760, -308841, -300922, -293003, -285084, -277165,
+    -269246, -261327, -253408, -245489, -237570, -229651, -221732, -213813,
+    -205894, -197975, -190056, -182137, -174218, -166299, -158380, -150461,
+    -142542, -134623, -126704, -118785, -110866, -102947, -95028, -87109,
+    -79190, -71271, -63352, -55433, -47514, -39595, -31676, -23757, -15838,
+    -7919, 0, 7919, 15838, 23757, 31676, 39595, 47514, 55433, 63352, 71271,
+    79190, 87109, 95028, 102947, 110866, 118785, 126704, 134623, 142542,
+    150461, 158380, 166299, 174218, 182137, 190056, 197975, 205894, 213813,
+    221732, 229651, 237570, 245489, 253408, 261327, 269246, 277165, 285084,
+    293003, 300922, 308841, 316760, 324679, 332598, 340517, 348436, 356355,
+    364274, 372193, 380112, 388031, 395950, 403869, 411788, 419707, 427626,
+    435545, 443464, 451383, 459302, 467221, 475140, 483059, 490978, 498897,
+    506816, 514735, 522654, 530573, 538492, 546411, 554330, 562249, 570168,
+    578087, 586006, 593925, 601844, 609763, 617682, 625601, 633520, 641439,
+    649358, 657277, 665196, 673115, 681034, 688953, 696872, 704791, 712710,
+    720629, 728548, 736467, 744386, 752305, 760224, 768143, 776062, 783981,
+    791900, 799819, 807738, 815657, 823576, 831495, 839414, 847333, 855252,
+    863171, 871090, 879009, 886928, 894847, 902766, 910685, 918604, 926523,
+    934442, 942361, 950280, 958199, 966118, 974037, 981956, 989875, 997794,
+    1005713, 1013632, 1021551, 1029470, 1037389, 1045308, 1053227, 1061146,
+    1069065, 1076984, 1084903, 1092822, 1100741, 1108660, 1116579, 1124498,
+    1132417, 1140336, 1148255, 1156174, 1164093, 1172012, 1179931);
+SELECT id, e
+  INTO pg_temp.test_n03b
+  FROM t_int1
+ WHERE e = ANY (ARRAY[
+    -20945800, -20841071, -20736342, -20631613, -20526884, -20422155,
+    -20317426, -20212697, -20107968, -20003239, -19898510, -19793781,
+    -19689052, -19584323, -19479594, -19374865, -19270136, -19165407,
+    -19060678, -18955949, -18851220, -18746491, -18641762, -18537033,
+    -18432304, -18327575, -18222846, -18118117, -18013388, -17908659,
+    -17803930, -17699201, -17594472, -17489743, -17385014, -17280285,
+    -17175556, -17070827, -16966098, -16861369, -16756640, -16651911,
+    -16547182, -16442453, -16337724, -16232995, -16128266, -16023537,
+    -15918808, -15814079, -15709350, -15604621, -15499892, -15395163,
+    -15290434, -15185705, -15080976, -14976247, -14871518, -14766789,
+    -14662060, -14557331, -14452602, -14347873, -14243144, -14138415,
+    -14033686, -13928957, -13824228, -13719499, -13614770, -13510041,
+    -13405312, -13300583, -13195854, -13091125, -12986396, -12881667,
+    -12776938, -12672209, -12567480, -12462751, -12358022, -12253293,
+    -12148564, -12043835, -11939106, -11834377, -11729648, -11624919,
+    -11520190, -11415461, -11310732, -11206003, -11101274, -10996545,
+    -10891816, -10787087, -10682358, -10577629, -10472900, -10368171,
+    -10263442, -10158713, -10053984, -9949255, -9844526, -9739797,
+    -9635068, -9530339, -9425610, -9320881, -9216152, -9111423, -9006694,
+    -8901965, -8797236, -8692507, -8587778, -8483049, -8378320, -8273591,
+    -8168862, -8064133, -7959404, -7854675, -7749946, -7645217, -7540488,
+    -7435759, -7331030, -7226301, -7121572, -7016843, -6912114, -6807385,
+    -6702656, -6597927, -6493198, -6388469, -6283740, -6179011, -6074282,
+    -5969553, -5864824, -5760095, -5655366, -5550637, -5445908, -5341179,
+    -5236450, -5131721, -5026992, -4922263, -4817534, -4712805, -4608076,
+    -4503347, -4398618, -4293889, -4189160, -4084431, -3979702, -3874973,
+    -3770244, -3665515, -3560786, -3456057, -3351328, -3246599, -3141870,
+    -3037141, -2932412, -2827683, -2722954, -2618225, -2513496, -2408767,
+    -2304038, -2199309, -2094580, -1989851, -1885122, -1780393, -1675664,
+    -1570935, -1466206, -1361477, -1256748, -1152019, -1047290, -942561,
+    -837832, -733103, -628374, -523645, -418916, -314187, -209458, -104729,
+    0, 104729, 209458, 314187, 418916, 523645, 628374, 733103, 837832,
+    942561, 1047290, 1152019, 1256748, 1361477, 1466206, 1570935, 1675664,
+    1780393, 1885122, 1989851, 2094580, 2199309, 2304038, 2408767, 2513496,
+    2618225, 2722954, 2827683, 2932412, 3037141, 3141870, 3246599, 3351328,
+    3456057, 3560786, 3665515, 3770244, 3874973, 3979702, 4084431, 4189160,
+    4293889, 4398618, 4503347, 4608076, 4712805, 4817534, 4922263, 5026992,
+    5131721, 5236450, 5341179, 5445908, 5550637, 5655366, 5760095, 5864824,
+    5969553, 6074282, 6179011, 6283740, 6388469, 6493198, 6597927, 6702656,
+    6807385, 6912114, 7016843, 7121572, 7226301, 7331030, 7435759, 7540488,
+    7645217, 7749946, 7854675, 7959404, 8064133, 8168862, 8273591, 8378320,
+    8483049, 8587778, 8692507, 8797236, 8901965, 9006694, 9111423, 9216152,
+    9320881, 9425610, 9530339, 9635068, 9739797, 9844526, 9949255,
+    10053984, 10158713, 10263442, 10368171, 10472900, 10577629, 10682358,
+    10787087, 10891816, 10996545, 11101274, 11206003, 11310732, 11415461,
+    11520190, 11624919, 11729648, 11834377, 11939106, 12043835, 12148564,
+    12253293, 12358022, 12462751, 12567480, 12672209, 12776938, 12881667,
+    12986396, 13091125, 13195854, 13300583, 13405312, 13510041, 13614770,
+    13719499, 13824228, 13928957, 14033686, 14138415, 14243144, 14347873,
+    14452602, 14557331, 14662060, 14766789, 14871518, 14976247, 15080976,
+    15185705, 15290434, 15395163, 15499892, 15604621, 15709350, 15814079,
+    15918808, 16023537, 16128266, 16232995, 16337724, 16442453, 16547182,
+    16651911, 16756640, 16861369, 16966098, 17070827, 17175556, 17280285,
+    17385014, 17489743, 17594472, 17699201, 17803930, 17908659, 18013388,
+    18118117, 18222846, 18327575, 18432304, 18537033, 18641762, 18746491,
+    18851220, 18955949, 19060678, 19165407, 19270136, 19374865, 19479594,
+    19584323, 19689052, 19793781, 19898510, 20003239, 20107968, 20212697,
+    20317426, 20422155, 20526884, 20631613, 20736342, 20841071]);
+SELECT id, a
+  INTO pg_temp.test_n04b
+  FROM t_int1
+ WHERE a NOT IN (NULL,
+    -32767, -32556, -32345, -32134, -31923, -31712, -31501, -31290, -31079,
+    -30868, -30657, -30446, -30235, -30024, -29813, -29602, -29391, -29180,
+    -28969, -28758, -28547, -28336, -28125, -27914, -27703, -27492, -27281,
+    -27070, -26859, -26648, -26437, -26226, -26015, -25804, -25593, -25382,
+    -25171, -24960, -24749, -24538, -24327, -24116, -23905, -23694, -23483,
+    -23272, -23061, -22850, -22639, -22428, -22217, -22006, -21795, -21584,
+    -21373, -21162, -20951, -20740, -20529, -20318, -20107, -19896, -19685,
+    -19474, -19263, -19052, -18841, -18630, -18419, -18208, -17997, -17786,
+    -17575, -17364, -17153, -16942, -16731, -16520, -16309, -16098, -15887,
+    -15676, -15465, -15254, -15043, -14832, -14621, -14410, -14199, -13988,
+    -13777, -13566, -13355, -13144, -12933, -12722, -12511, -12300, -12089,
+    -11878, -11667, -11456, -11245, -11034, -10823, -10612, -10401, -10190,
+    -9979, -9768, -9557, -9346, -9135, -8924, -8713, -8502, -8291, -8080,
+    -7869, -7658, -7447, -7236, -7025, -6814, -6603, -6392, -6181, -5970,
+    -5759, -5548, -5337, -5126, -4915, -4704, -4493, -4282, -4071, -3860,
+    -3649, -3438, -3227, -3016, -2805, -2594, -2383, -2172, -1961, -1750,
+    -1539, -1328, -1117, -906, -695, -484, -273, -62, 149, 360, 571, 782,
+    993, 1204, 1415, 1626, 1837, 2048, 2259, 2470, 2681, 2892, 3103, 3314,
+    3525, 3736, 3947, 4158, 4369, 4580, 4791, 5002, 5213, 5424, 5635, 5846,
+    6057, 6268, 6479, 6690, 6901, 7112, 7323, 7534, 7745, 7956, 8167, 8378,
+    8589, 8800, 9011, 9222, 9433, 9644, 9855, 10066, 10277, 10488, 10699,
+    10910, 11121, 11332, 11543, 11754, 11965, 12176, 12387, 12598, 12809,
+    13020, 13231, 13442, 13653, 13864, 14075, 14286, 14497, 14708, 14919,
+    15130, 15341, 15552, 15763, 15974, 16185, 16396, 16607, 16818, 17029,
+    17240, 17451, 17662, 17873, 18084, 18295, 18506, 18717, 18928, 19139,
+    19350, 19561, 19772, 19983, 20194, 20405, 20616, 20827, 21038, 21249,
+    21460, 21671, 21882, 22093, 22304, 22515, 22726, 22937, 23148, 23359,
+    23570, 23781, 23992, 24203, 24414, 24625, 24836, 25047, 25258, 25469,
+    25680, 25891, 26102, 26313, 26524, 26735, 26946, 27157, 27368, 27579,
+    27790, 28001, 28212, 28423, 28634, 28845, 29056, 29267, 29478, 29689,
+    29900, 30111, 30322, 30533, 30744, 30955, 31166, 31377, 31588, 31799,
+    32010, 32221, 32432, 32643);
+SET pg_strom.enabled = off;
+SELECT id, a
+  INTO pg_temp.test_n01c
+  FROM t_int1
+ WHERE a IN (
+    -32767, -32556, -32345, -32134, -31923, -31712, -31501, -31290, -31079,
+    -30868, -30657, -30446, -30235, -30024, -29813, -29602, -29391, -29180,
+    -28969, -28758, -28547, -28336, -28125, -27914, -27703, -27492, -27281,
+    -27070, -26859, -26648, -26437, -26226, -26015, -25804, -25593, -25382,
+    -25171, -24960, -24749, -24538, -24327, -24116, -23905, -23694, -23483,
+    -23272, -23061, -22850, -22639, -22428, -22217, -22006, -21795, -21584,
+    -21373, -21162, -20951, -20740, -20529, -20318, -20107, -19896, -19685,
+    -19474, -19263, -19052, -18841, -18630, -18419, -18208, -17997, -17786,
+    -17575, -17364, -17153, -16942, -16731, -16520, -16309, -16098, -15887,
+    -15676, -15465, -15254, -15043, -14832, -14621, -14410, -14199, -13988,
+    -13777, -13566, -13355, -13144, -12933, -12722, -12511, -12300, -12089,
+    -11878, -11667, -11456, -11245, -11034, -10823, -10612, -10401, -10190,
+    -9979, -9768, -9557, -9346, -9135, -8924, -8713, -8502, -8291, -8080,
+    -7869, -7658, -7447, -7236, -7025, -6814, -6603, -6392, -6181, -5970,
+    -5759, -5548, -5337, -5126, -4915, -4704, -4493, -4282, -4071, -3860,
+    -3649, -3438, -3227, -3016, -2805, -2594, -2383, -2172, -1961, -1750,
+    -1539, -1328, -1117, -906, -695, -484, -273, -62, 149, 360, 571, 782,
+    993, 1204, 1415, 1626, 1837, 2048, 2259, 2470, 2681, 2892, 3103, 3314,
+    3525, 3736, 3947, 4158, 4369, 4580, 4791, 5002, 5213, 5424, 5635, 5846,
+    6057, 6268, 6479, 6690, 6901, 7112, 7323, 7534, 7745, 7956, 8167, 8378,
+    8589, 8800, 9011, 9222, 9433, 9644, 9855, 10066, 10277, 10488, 10699,
+    10910, 11121, 11332, 11543, 11754, 11965, 12176, 12387, 12598, 12809,
+    13020, 13231, 13442, 13653, 13864, 14075, 14286, 14497, 14708, 14919,
+    15130, 15341, 15552, 15763, 15974, 16185, 16396, 16607, 16818, 17029,
+    17240, 17451, 17662, 17873, 18084, 18295, 18506, 18717, 18928, 19139,
+    19350, 19561, 19772, 19983, 20194, 20405, 20616, 20827, 21038, 21249,
+    21460, 21671, 21882, 22093, 22304, 22515, 22726, 22937, 23148, 23359,
+    23570, 23781, 23992, 24203, 24414, 24625, 24836, 25047, 25258, 25469,
+    25680, 25891, 26102, 26313, 26524, 26735, 26946, 27157, 27368, 27579,
+    27790, 28001, 28212, 28423, 28634, 28845, 29056, 29267, 29478, 29689,
+    29900, 30111, 30322, 30533, 30744, 30955, 31166, 31377, 31588, 31799,
+    32010, 32221, 32432, 32643);
+SELECT id, c
+  INTO pg_temp.test_n02c
+  FROM t_int1
+ WHERE id % 100 = 7 AND c NOT IN (
+    -1187850, -1179931, -1172012, -1164093, -1156174, -1148255, -1140336,
+    -1132417, -1124498, -1116579, -1108660, -1100741, -1092822, -1084903,
+    -1076984, -1069065, -1061146, -1053227, -1045308, -1037389, -1029470,
+    -1021551, -1013632, -1005713, -997794, -989875, -981956, -974037,
+    -966118, -958199, -950280, -942361, -934442, -926523, -918604, -910685,
+    -902766, -894847, -886928, -879009, -871090, -863171, -855252, -847333,
+    -839414, -831495, -823576, -815657, -807738, -799819, -791900, -783981,
+    -776062, -768143, -760224, -752305, -744386, -736467, -728548, -720629,
+    -712710, -704791, -696872, -688953, -681034, -673115, -665196, -657277,
+    -649358, -641439, -633520, -625601, -617682, -609763, -601844, -593925,
+    -586006, -578087, -570168, -562249, -554330, -546411, -538492, -530573,
+    -522654, -514735, -506816, -498897, -490978, -483059, -475140, -467221,
+    -459302, -451383, -443464, -435545, -427626, -419707, -411788, -403869,
+    -395950, -388031, -380112, -372193, -364274, -356355, -348436, -340517,
+    -332598, -324679, -316760, -308841, -300922, -293003, -285084, -277165,
+    -269246, -261327, -253408, -245489, -237570, -229651, -221732, -213813,
+    -205894, -197975, -190056, -182137, -174218, -166299, -158380, -150461,
+    -142542, -134623, -126704, -118785, -110866, -102947, -95028, -87109,
+    -79190, -71271, -63352, -55433, -47514, -39595, -31676, -23757, -15838,
+    -7919, 0, 7919, 15838, 23757, 31676, 39595, 47514, 55433, 63352, 71271,
+    79190, 87109, 95028, 102947, 110866, 118785, 126704, 134623, 142542,
+    150461, 158380, 166299, 174218, 182137, 190056, 197975, 205894, 213813,
+    221732, 229651, 237570, 245489, 253408, 261327, 269246, 277165, 285084,
+    293003, 300922, 308841, 316760, 324679, 332598, 340517, 348436, 356355,
+    364274, 372193, 380112, 388031, 395950, 403869, 411788, 419707, 427626,
+    435545, 443464, 451383, 459302, 467221, 475140, 483059, 490978, 498897,
+    506816, 514735, 522654, 530573, 538492, 546411, 554330, 562249, 570168,
+    578087, 586006, 593925, 601844, 609763, 617682, 625601, 633520, 641439,
+    649358, 657277, 665196, 673115, 681034, 688953, 696872, 704791, 712710,
+    720629, 728548, 736467, 744386, 752305, 760224, 768143, 776062, 783981,
+    791900, 799819, 807738, 815657, 823576, 831495, 839414, 847333, 855252,
+    863171, 871090, 879009, 886928, 894847, 902766, 910685, 918604, 926523,
+    934442, 942361, 950280, 958199, 966118, 974037, 981956, 989875, 997794,
+    1005713, 1013632, 1021551, 1029470, 1037389, 1045308, 1053227, 1061146,
+    1069065, 1076984, 1084903, 1092822, 1100741, 1108660, 1116579, 1124498,
+    1132417, 1140336, 1148255, 1156174, 1164093, 1172012, 1179931);
+SELECT id, e
+  INTO pg_temp.test_n03c
+  FROM t_int1
+ WHERE e = ANY (ARRAY[
+    -20945800, -20841071, -20736342, -20631613, -20526884, -20422155,
+    -20317426, -20212697, -20107968, -20003239, -19898510, -19793781,
+    -19689052, -19584323, -19479594, -19374865, -19270136, -19165407,
+    -19060678, -18955949, -18851220, -18746491, -18641762, -18537033,
+    -18432304, -18327575, -18222846, -18118117, -18013388, -17908659,
+    -17803930, -17699201, -17594472, -17489743, -17385014, -17280285,
+    -17175556, -17070827, -16966098, -16861369, -16756640, -16651911,
+    -16547182, -16442453, -16337724, -16232995, -16128266, -16023537,
+    -15918808, -15814079, -15709350, -15604621, -15499892, -15395163,
+    -15290434, -15185705, -15080976, -14976247, -14871518, -14766789,
+    -14662060, -14557331, -14452602, -14347873, -14243144, -14138415,
+    -14033686, -13928957, -13824228, -13719499, -13614770, -13510041,
+    -13405312, -13300583, -13195854, -13091125, -12986396, -12881667,
+    -12776938, -12672209, -12567480, -12462751, -12358022, -12253293,
+    -12148564, -12043835, -11939106, -11834377, -11729648, -11624919,
+    -11520190, -11415461, -11310732, -11206003, -11101274, -10996545,
+    -10891816, -10787087, -10682358, -10577629, -10472900, -10368171,
+    -10263442, -10158713, -10053984, -9949255, -9844526, -9739797,
+    -9635068, -9530339, -9425610, -9320881, -9216152, -9111423, -9006694,
+    -8901965, -8797236, -8692507, -8587778, -8483049, -8378320, -8273591,
+    -8168862, -8064133, -7959404, -7854675, -7749946, -7645217, -7540488,
+    -7435759, -7331030, -7226301, -7121572, -7016843, -6912114, -6807385,
+    -6702656, -6597927, -6493198, -6388469, -6283740, -6179011, -6074282,
+    -5969553, -5864824, -5760095, -5655366, -5550637, -5445908, -5341179,
+    -5236450, -5131721, -5026992, -4922263, -4817534, -4712805, -4608076,
+    -4503347, -4398618, -4293889, -4189160, -4084431, -3979702, -3874973,
+    -3770244, -3665515, -3560786, -3456057, -3351328, -3246599, -3141870,
+    -3037141, -2932412, -2827683, -2722954, -2618225, -2513496, -2408767,
+    -2304038, -2199309, -2094580, -1989851, -1885122, -1780393, -1675664,
+    -1570935, -1466206, -1361477, -1256748, -1152019, -1047290, -942561,
+    -837832, -733103, -628374, -523645, -418916, -314187, -209458, -104729,
+    0, 104729, 209458, 314187, 418916, 523645, 628374, 733103, 837832,
+    942561, 1047290, 1152019, 1256748, 1361477, 1466206, 1570935, 1675664,
+    1780393, 1885122, 1989851, 2094580, 2199309, 2304038, 2408767, 2513496,
+    2618225, 2722954, 2827683, 2932412, 3037141, 3141870, 3246599, 3351328,
+    3456057, 3560786, 3665515, 3770244, 3874973, 3979702, 4084431, 4189160,
+    4293889, 4398618, 4503347, 4608076, 4712805, 4817534, 4922263, 5026992,
+    5131721, 5236450, 5341179, 5445908, 5550637, 5655366, 5760095, 5864824,
+    5969553, 6074282, 6179011, 6283740, 6388469, 6493198, 6597927, 6702656,
+    6807385, 6912114, 7016843, 7121572, 7226301, 7331030, 7435759, 7540488,
+    7645217, 7749946, 7854675, 7959404, 8064133, 8168862, 8273591, 8378320,
+    8483049, 8587778, 8692507, 8797236, 8901965, 9006694, 9111423, 9216152,
+    9320881, 9425610, 9530339, 9635068, 9739797, 9844526, 9949255,
+    10053984, 10158713, 10263442, 10368171, 10472900, 10577629, 10682358,
+    10787087, 10891816, 10996545, 11101274, 11206003, 11310732, 11415461,
+    11520190, 11624919, 11729648, 11834377, 11939106, 12043835, 12148564,
+    12253293, 12358022, 12462751, 12567480, 12672209, 12776938, 12881667,
+    12986396, 13091125, 13195854, 13300583, 13405312, 13510041, 13614770,
+    13719499, 13824228, 13928957, 14033686, 14138415, 14243144, 14347873,
+    14452602, 14557331, 14662060, 14766789, 14871518, 14976247, 15080976,
+    15185705, 15290434, 15395163, 15499892, 15604621, 15709350, 15814079,
+    15918808, 16023537, 16128266, 16232995, 16337724, 16442453, 16547182,
+    16651911, 16756640, 16861369, 16966098, 17070827, 17175556, 17280285,
+    17385014, 17489743, 17594472, 17699201, 17803930, 17908659, 18013388,
+    18118117, 18222846, 18327575, 18432304, 18537033, 18641762, 18746491,
+    18851220, 18955949, 19060678, 19165407, 19270136, 19374865, 19479594,
+    19584323, 19689052, 19793781, 19898510, 20003239, 20107968, 20212697,
+    20317426, 20422155, 20526884, 20631613, 20736342, 20841071]);
+SELECT id, a
+  INTO pg_temp.test_n04c
+  FROM t_int1
+ WHERE a NOT IN (NULL,
+    -32767, -32556, -32345, -32134, -31923, -31712, -31501, -31290, -31079,
+    -30868, -30657, -30446, -30235, -30024, -29813, -29602, -29391, -29180,
+    -28969, -28758, -28547, -28336, -28125, -27914, -27703, -27492, -27281,
+    -27070, -26859, -26648, -26437, -26226, -26015, -25804, -25593, -25382,
+    -25171, -24960, -24749, -24538, -24327, -24116, -23905, -23694, -23483,
+    -23272, -23061, -22850, -22639, -22428, -22217, -22006, -21795, -21584,
+    -21373, -21162, -20951, -20740, -20529, -20318, -20107, -19896, -19685,
+    -19474, -19263, -19052, -18841, -18630, -18419, -18208, -17997, -17786,
+    -17575, -17364, -17153, -16942, -16731, -16520, -16309, -16098, -15887,
+    -15676, -15465, -15254, -15043, -14832, -14621, -14410, -14199, -13988,
+    -13777, -13566, -13355, -13144, -12933, -12722, -12511, -12300, -12089,
+    -11878, -11667, -11456, -11245, -11034, -10823, -10612, -10401, -10190,
+    -9979, -9768, -9557, -9346, -9135, -8924, -8713, -8502, -8291, -8080,
+    -7869, -7658, -7447, -7236, -7025, -6814, -6603, -6392, -6181, -5970,
+    -5759, -5548, -5337, -5126, -4915, -4704, -4493, -4282, -4071, -3860,
+    -3649, -3438, -3227, -3016, -2805, -2594, -2383, -2172, -1961, -1750,
+    -1539, -1328, -1117, -906, -695, -484, -273, -62, 149, 360, 571, 782,
+    993, 1204, 1415, 1626, 1837, 2048, 2259, 2470, 2681, 2892, 3103, 3314,
+    3525, 3736, 3947, 4158, 4369, 4580, 4791, 5002, 5213, 5424, 5635, 5846,
+    6057, 6268, 6479, 6690, 6901, 7112, 7323, 7534, 7745, 7956, 8167, 8378,
+    8589, 8800, 9011, 9222, 9433, 9644, 9855, 10066, 10277, 10488, 10699,
+    10910, 11121, 11332, 11543, 11754, 11965, 12176, 12387, 12598, 12809,
+    13020, 13231, 13442, 13653, 13864, 14075, 14286, 14497, 14708, 14919,
+    15130, 15341, 15552, 15763, 15974, 16185, 16396, 16607, 16818, 17029,
+    17240, 17451, 17662, 17873, 18084, 18295, 18506, 18717, 18928, 19139,
+    19350, 19561, 19772, 19983, 20194, 20405, 20616, 20827, 21038, 21249,
+    21460, 21671, 21882, 22093, 22304, 22515, 22726, 22937, 23148, 23359,
+    23570, 23781, 23992, 24203, 24414, 24625, 24836, 25047, 25258, 25469,
+    25680, 25891, 26102, 26313, 26524, 26735, 26946, 27157, 27368, 27579,
+    27790, 28001, 28212, 28423, 28634, 28845, 29056, 29267, 29478, 29689,
+    29900, 30111, 30322, 30533, 30744, 30955, 31166, 31377, 31588, 31799,
+    32010, 32221, 32432, 32643);
+RESET pg_strom.scalar_array_op_hashed_threshold;
+
+(SELECT * FROM pg_temp.test_n01a EXCEPT ALL SELECT * FROM pg_temp.test_n01c);
+(SELECT * FROM pg_temp.test_n01c EXCEPT ALL SELECT * FROM pg_temp.test_n01a);
+(SELECT * FROM pg_temp.test_n01b EXCEPT ALL SELECT * FROM pg_temp.test_n01c);
+(SELECT * FROM pg_temp.test_n01c EXCEPT ALL SELECT * FROM pg_temp.test_n01b);
+(SELECT * FROM pg_temp.test_n02a EXCEPT ALL SELECT * FROM pg_temp.test_n02c);
+(SELECT * FROM pg_temp.test_n02c EXCEPT ALL SELECT * FROM pg_temp.test_n02a);
+(SELECT * FROM pg_temp.test_n02b EXCEPT ALL SELECT * FROM pg_temp.test_n02c);
+(SELECT * FROM pg_temp.test_n02c EXCEPT ALL SELECT * FROM pg_temp.test_n02b);
+(SELECT * FROM pg_temp.test_n03a EXCEPT ALL SELECT * FROM pg_temp.test_n03c);
+(SELECT * FROM pg_temp.test_n03c EXCEPT ALL SELECT * FROM pg_temp.test_n03a);
+(SELECT * FROM pg_temp.test_n03b EXCEPT ALL SELECT * FROM pg_temp.test_n03c);
+(SELECT * FROM pg_temp.test_n03c EXCEPT ALL SELECT * FROM pg_temp.test_n03b);
+(SELECT * FROM pg_temp.test_n04a EXCEPT ALL SELECT * FROM pg_temp.test_n04c);
+(SELECT * FROM pg_temp.test_n04c EXCEPT ALL SELECT * FROM pg_temp.test_n04a);
+(SELECT * FROM pg_temp.test_n04b EXCEPT ALL SELECT * FROM pg_temp.test_n04c);
+(SELECT * FROM pg_temp.test_n04c EXCEPT ALL SELECT * FROM pg_temp.test_n04b);
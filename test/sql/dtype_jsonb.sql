@@ -0,0 +1,64 @@
+---
+--- Test cases for jsonb data type on the device
+---
+SELECT setseed(0.20190401);
+CREATE TABLE dtype_jsonb_t AS
+  SELECT x id,
+         jsonb_build_object('a', x,
+                            'b', md5(x::text),
+                            'c', CASE WHEN x % 7 = 0 THEN NULL
+                                      ELSE x % 3 = 0 END,
+                            'd', jsonb_build_array(x * 1.5,
+                                                   'k' || x,
+                                                   x % 2 = 0,
+                                                   jsonb_build_object('e',
+                                                       (x % 100)::numeric / 7)),
+                            'f', (SELECT jsonb_agg((random() * 1000000)::numeric(14,4))
+                                    FROM generate_series(0, x % 40) y),
+                            'longer_key_' || (x % 5), -x,
+                            'g', CASE WHEN x % 11 = 0 THEN ''
+                                      ELSE repeat('z', x % 17) END) v
+    FROM generate_series(1,8000) x;
+
+-- common routines of the device library must be consistent to #>>
+SELECT p, count(*) FILTER (WHERE pgstrom.jsonb_devlib_check(v, p)
+                           IS DISTINCT FROM
+                           CASE WHEN jsonb_typeof(v #> p) IN ('object','array')
+                                THEN NULL
+                                ELSE v #>> p END) mismatch
+  FROM dtype_jsonb_t,
+       (VALUES ('{a}'::text[]), ('{b}'), ('{c}'), ('{d,0}'), ('{d,1}'),
+               ('{d,2}'), ('{d,3,e}'), ('{d,-1,e}'), ('{d,-5}'),
+               ('{f,0}'), ('{f,33}'), ('{f,-1}'), ('{f,1x}'),
+               ('{longer_key_3}'), ('{g}'), ('{nokey}'), ('{a,0}'),
+               ('{d,NULL}'), ('{}')) p(p)
+ GROUP BY p
+ ORDER BY p::text COLLATE "C";
+
+-- jsonb operators on GPU
+RESET pg_strom.enabled;
+SELECT id, v->>'b' b, v->'d' d, v#>>'{d,3,e}' e, v#>'{f,-1}' f
+  INTO pg_temp.test_j01a
+  FROM dtype_jsonb_t
+ WHERE v ? 'c' AND v->>'b' LIKE '%a%' AND v->'d'->>2 = 'true';
+SELECT id, v#>>'{f,3}' f, v->'longer_key_2' l
+  INTO pg_temp.test_j02a
+  FROM dtype_jsonb_t
+ WHERE v->>'g' = '' OR v->'d'->>1 LIKE 'k1%';
+SET pg_strom.enabled = off;
+SELECT id, v->>'b' b, v->'d' d, v#>>'{d,3,e}' e, v#>'{f,-1}' f
+  INTO pg_temp.test_j01b
+  FROM dtype_jsonb_t
+ WHERE v ? 'c' AND v->>'b' LIKE '%a%' AND v->'d'->>2 = 'true';
+SELECT id, v#>>'{f,3}' f, v->'longer_key_2' l
+  INTO pg_temp.test_j02b
+  FROM dtype_jsonb_t
+ WHERE v->>'g' = '' OR v->'d'->>1 LIKE 'k1%';
+RESET pg_strom.enabled;
+
+(SELECT * FROM pg_temp.test_j01a EXCEPT ALL SELECT * FROM pg_temp.test_j01b);
+(SELECT * FROM pg_temp.test_j01b EXCEPT ALL SELECT * FROM pg_temp.test_j01a);
+(SELECT * FROM pg_temp.test_j02a EXCEPT ALL SELECT * FROM pg_temp.test_j02b);
+(SELECT * FROM pg_temp.test_j02b EXCEPT ALL SELECT * FROM pg_temp.test_j02a);
+
+DROP TABLE dtype_jsonb_t;
@@ -0,0 +1,74 @@
+---
+--- Test cases for numeric data type on the device
+---
+SELECT setseed(0.20190415);
+CREATE TABLE dtype_numeric_t AS
+  SELECT x id,
+         (x % 50)::int cat,
+         ((random() - 0.5) * 10000000000)::numeric(12,2) a,
+         ((random() - 0.5) * 1000)::numeric(10,4) b,
+         ((random() - 0.5) * 1000000)::numeric c
+    FROM generate_series(1,20000) x;
+UPDATE dtype_numeric_t SET a = NULL WHERE id % 97 = 0;
+UPDATE dtype_numeric_t SET c = c * 100000000000000000000 WHERE id % 89 = 0;
+
+-- fixed-point arithmetic of the device library must be consistent to
+-- the numeric operators, including the display scale of the results.
+-- NULL means the device code falls back to the CPU; it is allowed only
+-- on the rows with huge values of c (id % 89 = 0), so the other rows must
+-- be all evaluated by the device library.
+SELECT op, count(*) FILTER (WHERE r IS NOT NULL AND r::text <> e::text) mismatch,
+       count(r) FILTER (WHERE id % 89 <> 0) ondevice,
+       count(e) FILTER (WHERE r IS NULL AND id % 89 <> 0) fallback
+  FROM (SELECT '+' op, id, pgstrom.numeric_devlib_check('+', a, b) r, a + b e
+          FROM dtype_numeric_t
+        UNION ALL
+        SELECT '-' op, id, pgstrom.numeric_devlib_check('-', b, c) r, b - c e
+          FROM dtype_numeric_t
+        UNION ALL
+        SELECT '*' op, id, pgstrom.numeric_devlib_check('*', a, c) r, a * c e
+          FROM dtype_numeric_t
+        UNION ALL
+        SELECT 'cmp' op, id, pgstrom.numeric_devlib_check('cmp', a, c) r,
+               sign(a - c)::int e
+          FROM dtype_numeric_t) qry
+ GROUP BY op
+ ORDER BY op;
+
+-- numeric operators, SUM(numeric) and AVG(numeric) on GPU
+RESET pg_strom.enabled;
+SELECT id, a + b x, b - a y, a * 2.50 z
+  INTO pg_temp.test_n01a
+  FROM dtype_numeric_t
+ WHERE a > b AND b + 100.0 < c;
+SELECT cat, sum(a) sa, sum(b) sb, sum(a) FILTER (WHERE b > 0) sf,
+       avg(a) aa, avg(b) ab, avg(a) FILTER (WHERE b > 0) af
+  INTO pg_temp.test_n02a
+  FROM dtype_numeric_t
+ GROUP BY cat;
+SET pg_strom.enabled = off;
+SELECT id, a + b x, b - a y, a * 2.50 z
+  INTO pg_temp.test_n01b
+  FROM dtype_numeric_t
+ WHERE a > b AND b + 100.0 < c;
+SELECT cat, sum(a) sa, sum(b) sb, sum(a) FILTER (WHERE b > 0) sf,
+       avg(a) aa, avg(b) ab, avg(a) FILTER (WHERE b > 0) af
+  INTO pg_temp.test_n02b
+  FROM dtype_numeric_t
+ GROUP BY cat;
+RESET pg_strom.enabled;
+
+(SELECT * FROM pg_temp.test_n01a EXCEPT ALL SELECT * FROM pg_temp.test_n01b);
+(SELECT * FROM pg_temp.test_n01b EXCEPT ALL SELECT * FROM pg_temp.test_n01a);
+(SELECT cat, sa::text, sb::text, sf::text,
+        aa::text, ab::text, af::text FROM pg_temp.test_n02a
+ EXCEPT ALL
+ SELECT cat, sa::text, sb::text, sf::text,
+        aa::text, ab::text, af::text FROM pg_temp.test_n02b);
+(SELECT cat, sa::text, sb::text, sf::text,
+        aa::text, ab::text, af::text FROM pg_temp.test_n02b
+ EXCEPT ALL
+ SELECT cat, sa::text, sb::text, sf::text,
+        aa::text, ab::text, af::text FROM pg_temp.test_n02a);
+
+DROP TABLE dtype_numeric_t;
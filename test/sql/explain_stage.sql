@@ -0,0 +1,41 @@
+---
+--- Test cases for the per-stage timing on EXPLAIN ANALYZE
+---
+CREATE TABLE explain_stage_t AS
+  SELECT x id, (x % 100) a, (x % 7) b
+    FROM generate_series(1,200000) x;
+ANALYZE explain_stage_t;
+
+-- pick up the stage properties of the top plan node
+CREATE FUNCTION pg_temp.explain_stage(opts text, query text)
+RETURNS TABLE (item text, valid bool)
+AS $$
+DECLARE
+  plan  json;
+BEGIN
+  EXECUTE 'EXPLAIN (' || opts || ', format json) ' || query INTO plan;
+  RETURN QUERY
+    SELECT 'Provider: ' || (plan->0->'Plan'->>'Custom Plan Provider'), true;
+  RETURN QUERY
+    SELECT key, CASE WHEN key IN ('GPU Process Time',
+                                  'DMA Send Time',
+                                  'Kernel Exec Time')
+                     THEN value::text::float8 > 0.0
+                     ELSE value::text::float8 >= 0.0
+                END
+      FROM json_each(plan->0->'Plan')
+     WHERE key LIKE '% Time' AND key NOT LIKE 'Actual %'
+     ORDER BY key COLLATE "C";
+END;
+$$ LANGUAGE plpgsql;
+
+RESET pg_strom.enabled;
+SET enable_seqscan = off;
+SET max_parallel_workers_per_gather = 0;
+SELECT * FROM pg_temp.explain_stage('analyze, costs off',
+  'SELECT id, a FROM explain_stage_t WHERE a % 3 = 0 AND b < 5');
+-- no stage properties without timing
+SELECT * FROM pg_temp.explain_stage('analyze, costs off, timing off',
+  'SELECT id, a FROM explain_stage_t WHERE a % 3 = 0 AND b < 5');
+RESET enable_seqscan;
+RESET max_parallel_workers_per_gather;
@@ -0,0 +1,35 @@
+---
+--- Test cases for float2 array functions
+---
+CREATE TABLE float2_array_t AS
+  SELECT id, array_agg(((id * 31 + k * 17) % 201 - 100)::float2 ORDER BY k) a,
+             array_agg(((id * 13 + k * 29) % 201 - 100)::float2 ORDER BY k) b
+    FROM generate_series(1,200) id, generate_series(1,37) k
+   GROUP BY id;
+
+-- array cast must be consistent to the element-wise cast
+SELECT count(*) mismatch
+  FROM float2_array_t
+ WHERE a::float4[] IS DISTINCT FROM
+       (SELECT array_agg(v::float4 ORDER BY i)
+          FROM unnest(a) WITH ORDINALITY u(v, i))
+    OR a IS DISTINCT FROM a::float4[]::float2[];
+
+-- values are integers, so results are exact
+SELECT count(*) mismatch
+  FROM float2_array_t
+ WHERE float2_dot_product(a, b) <>
+       (SELECT sum(x::float8 * y::float8) FROM unnest(a, b) u(x, y))
+    OR float2_l2_distance(a, b) <>
+       (SELECT sqrt(sum((x::float8 - y::float8)^2)) FROM unnest(a, b) u(x, y));
+
+-- round to the nearest even, NULLs and dimensions
+SELECT '{2049,2051,1.5,NULL,-2.25}'::float4[]::float2[] v;
+SELECT '{{0.5,NULL},{-1,65504}}'::float2[]::float4[] v;
+SELECT '{1,70000}'::float4[]::float2[] v;
+SELECT float2_dot_product('{1,2,3}', '{4,5,6}') v1,
+       float2_l2_distance('{0,0}', '{3,4}') v2;
+SELECT float2_dot_product('{1,2,3}', '{4,5}');
+SELECT float2_l2_distance('{1,NULL}', '{4,5}');
+
+DROP TABLE float2_array_t;
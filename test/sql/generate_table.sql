@@ -0,0 +1,56 @@
+---
+--- Test cases for pgstrom.generate_table
+---
+CREATE TEMP VIEW generate_table_v AS
+  SELECT * FROM pgstrom.generate_table(
+    ARRAY['dist=serial lower=1001',
+          'dist=zipf param=1.1 lower=1 upper=1000',
+          'dist=normal lower=-100 upper=100',
+          'null=10',
+          'lower=''2019-01-01 00:00:00'' upper=''2019-12-31 23:59:59''',
+          'template=''key_****''',
+          'template=10.0.0.0/8 null=5',
+          'dist=zipf lower=1 upper=100',
+          NULL],
+    10000, 20191018)
+    AS t(a int, b bigint, c float8, d date, e timestamp,
+         f text, g inet, h int4range, i macaddr);
+
+SELECT count(*), min(a), max(a),
+       count(*) FILTER (WHERE d IS NULL) d_nulls,
+       count(*) FILTER (WHERE c < -100 OR c >= 100) c_outside,
+       count(*) FILTER (WHERE e < '2019-01-01' OR e > '2019-12-31 23:59:59') e_outside
+  FROM generate_table_v;
+
+-- zipf distribution; smaller value is more frequent
+SELECT count(*) FILTER (WHERE b = 1) > count(*) FILTER (WHERE b = 2) AND
+       count(*) FILTER (WHERE b = 2) > count(*) FILTER (WHERE b = 10) zipf_ok
+  FROM generate_table_v;
+
+-- same result regardless of the partitions; no rows missing nor extra
+WITH partitioned AS (
+  SELECT t.* FROM pgstrom.generate_table(
+           ARRAY['dist=serial lower=1001',
+                 'dist=zipf param=1.1 lower=1 upper=1000',
+                 'dist=normal lower=-100 upper=100',
+                 'null=10',
+                 'lower=''2019-01-01 00:00:00'' upper=''2019-12-31 23:59:59''',
+                 'template=''key_****''',
+                 'template=10.0.0.0/8 null=5',
+                 'dist=zipf lower=1 upper=100',
+                 NULL],
+           10000, 20191018, p, 3)
+           AS t(a int, b bigint, c float8, d date, e timestamp,
+                f text, g inet, h int4range, i macaddr),
+         generate_series(0,2) p)
+SELECT (SELECT count(*) FROM partitioned) nrows,
+       (SELECT count(*) FROM (SELECT * FROM generate_table_v
+                              EXCEPT ALL
+                              SELECT * FROM partitioned) x) missing,
+       (SELECT count(*) FROM (SELECT * FROM partitioned
+                              EXCEPT ALL
+                              SELECT * FROM generate_table_v) x) extra;
+
+SELECT * FROM pgstrom.generate_table('{"dist=serial"}', 3, 0, 1, 2) AS t(a int);
+SELECT * FROM pgstrom.generate_table('{"dist=gauss"}', 3) AS t(a int);
+SELECT * FROM pgstrom.generate_table('{"",""}', 3) AS t(a int);
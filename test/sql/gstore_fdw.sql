@@ -0,0 +1,229 @@
+--
+-- Test for bulk loading onto gstore_fdw
+--
+SET client_min_messages = error;
+DROP FOREIGN TABLE IF EXISTS gstore_load;
+RESET client_min_messages;
+
+CREATE FOREIGN TABLE gstore_load (
+  id     int,
+  x      float8,
+  label  text,
+  memo   text
+) SERVER gstore_fdw OPTIONS (pinning '0', format 'pgstrom');
+
+-- bulk loading by INSERT ... SELECT
+INSERT INTO gstore_load (
+  SELECT i, i::float8 / 7.0, 'label_' || (i % 100),
+         CASE WHEN i % 11 = 0 THEN NULL ELSE md5(i::text) END
+    FROM generate_series(1,1000000) i);
+
+SELECT count(*) nrows, count(memo) nmemo, count(distinct label) nlabels,
+       sum(id) sum_id, min(id) min_id, max(id) max_id
+  FROM gstore_load;
+
+SELECT count(*) mismatch
+  FROM gstore_load g FULL OUTER JOIN
+       (SELECT i, i::float8 / 7.0 x, 'label_' || (i % 100) label,
+               CASE WHEN i % 11 = 0 THEN NULL ELSE md5(i::text) END memo
+          FROM generate_series(1,1000000) i) s ON g.id = s.i
+ WHERE g.id IS NULL OR s.i IS NULL OR g.x <> s.x
+    OR g.label <> s.label OR g.memo IS DISTINCT FROM s.memo;
+
+-- rows loaded by the aborted transaction are invisible
+BEGIN;
+INSERT INTO gstore_load (SELECT i, 0.0, 'aborted', NULL
+                           FROM generate_series(1,1000) i);
+ROLLBACK;
+
+-- loading from the gstore_fdw table itself
+INSERT INTO gstore_load (SELECT * FROM gstore_load WHERE id <= 1000);
+
+SELECT count(*) nrows, count(distinct id) nids,
+       count(*) FILTER (WHERE label = 'aborted') naborted
+  FROM gstore_load;
+
+DROP FOREIGN TABLE gstore_load;
+
+-- qualifiers on varlena columns evaluated by dictionary codes
+CREATE FOREIGN TABLE gstore_dict (
+  id     int,
+  t      text COLLATE "C",
+  b      bytea
+) SERVER gstore_fdw OPTIONS (pinning '0');
+INSERT INTO gstore_dict (
+  SELECT i, CASE WHEN i % 10 = 0 THEN NULL
+                 ELSE 'k' || lpad((i % 500)::text, 3, '0') END,
+            CASE WHEN i % 7 = 0 THEN NULL
+                 ELSE decode(lpad(to_hex(i % 256), 2, '0'), 'hex') END
+    FROM generate_series(1,10000) i);
+CREATE TEMP VIEW gstore_dict_v AS
+  SELECT 't_eq'::text q, count(*) nrows, sum(id) sum_id
+    FROM gstore_dict WHERE t = 'k123'
+  UNION ALL
+  SELECT 't_ne', count(*), sum(id) FROM gstore_dict WHERE t <> 'k123'
+  UNION ALL
+  SELECT 't_lt', count(*), sum(id) FROM gstore_dict WHERE t < 'k050'
+  UNION ALL
+  SELECT 't_between', count(*), sum(id)
+    FROM gstore_dict WHERE t BETWEEN 'k100' AND 'k199'
+  UNION ALL
+  SELECT 't_in', count(*), sum(id)
+    FROM gstore_dict WHERE t IN ('k001', 'k002', 'k499', 'zzz')
+  UNION ALL
+  SELECT 't_like', count(*), sum(id) FROM gstore_dict WHERE t LIKE 'k12%'
+  UNION ALL
+  SELECT 't_null', count(*), sum(id) FROM gstore_dict WHERE t IS NULL
+  UNION ALL
+  SELECT 't_eq_null', count(*), sum(id) FROM gstore_dict WHERE t = NULL
+  UNION ALL
+  SELECT 'b_eq', count(*), sum(id) FROM gstore_dict WHERE b = '\x7f'
+  UNION ALL
+  SELECT 'b_lt', count(*), sum(id) FROM gstore_dict WHERE b < '\x10'
+  UNION ALL
+  SELECT 'b_null', count(*), sum(id) FROM gstore_dict WHERE b IS NULL;
+SELECT * FROM gstore_dict_v ORDER BY q COLLATE "C";
+
+-- read-write buffer has no sorted dictionary, so evaluated by CPU
+BEGIN;
+INSERT INTO gstore_dict VALUES (10001, 'k123', '\x7f');
+SELECT * FROM gstore_dict_v ORDER BY q COLLATE "C";
+ROLLBACK;
+DROP VIEW gstore_dict_v;
+DROP FOREIGN TABLE gstore_dict;
+
+-- sharding over the GPU and host memory
+CREATE FOREIGN TABLE gstore_shard (
+  id     int,
+  x      float8,
+  label  text
+) SERVER gstore_fdw OPTIONS (pinning '0,host', shard_nrows '300000');
+INSERT INTO gstore_shard (
+  SELECT i, i::float8 / 7.0, 'label_' || (i % 100)
+    FROM generate_series(1,1000000) i);
+
+SELECT shard_id, device, nitems
+  FROM pgstrom.gstore_fdw_shard_info
+ WHERE table_oid = 'gstore_shard'::regclass
+ ORDER BY shard_id;
+
+SELECT count(*) nrows, sum(id) sum_id, min(id) min_id, max(id) max_id
+  FROM gstore_shard WHERE label = 'label_7';
+
+SELECT id, label FROM gstore_shard
+ WHERE id % 100000 = 0 ORDER BY id DESC;
+
+DROP FOREIGN TABLE gstore_shard;
+
+-- sharding over the host memory only
+CREATE FOREIGN TABLE gstore_hshard (
+  id     int,
+  x      float8,
+  label  text
+) SERVER gstore_fdw OPTIONS (pinning 'host', shard_nrows '400000');
+INSERT INTO gstore_hshard (
+  SELECT i, i::float8 / 7.0, 'label_' || (i % 100)
+    FROM generate_series(1,1000000) i);
+
+SELECT shard_id, device, nitems
+  FROM pgstrom.gstore_fdw_shard_info
+ WHERE table_oid = 'gstore_hshard'::regclass
+ ORDER BY shard_id;
+
+SELECT count(*) nrows, sum(id) sum_id, min(id) min_id, max(id) max_id
+  FROM gstore_hshard WHERE label = 'label_7';
+
+DROP FOREIGN TABLE gstore_hshard;
+
+-- number of shards is limited
+CREATE FOREIGN TABLE gstore_xshard (
+  id     int
+) SERVER gstore_fdw OPTIONS (pinning 'host', shard_nrows '1000');
+INSERT INTO gstore_xshard (SELECT i FROM generate_series(1,100000) i);
+SELECT count(*) FROM gstore_xshard;
+DROP FOREIGN TABLE gstore_xshard;
+
+-- small updates are kept as delta image, then merged by compaction
+CREATE FOREIGN TABLE gstore_delta (
+  id     int,
+  x      float8,
+  label  text
+) SERVER gstore_fdw OPTIONS (pinning '0');
+INSERT INTO gstore_delta (
+  SELECT i, i::float8 / 7.0, 'label_' || (i % 100)
+    FROM generate_series(1,100000) i);
+UPDATE gstore_delta SET label = 'updated', x = -x WHERE id % 1000 = 0;
+DELETE FROM gstore_delta WHERE id % 1000 = 1;
+
+SELECT shard_id, device, nitems
+  FROM pgstrom.gstore_fdw_shard_info
+ WHERE table_oid = 'gstore_delta'::regclass;
+SELECT gstore_export_ipchandle('gstore_delta') IS NOT NULL exported;
+SELECT count(*) nrows, sum(id) sum_id,
+       count(*) FILTER (WHERE label = 'updated') nupdated,
+       count(*) FILTER (WHERE x < 0.0) nnegative
+  FROM gstore_delta;
+
+SELECT gstore_fdw_compaction('gstore_delta');
+SELECT shard_id, device, nitems
+  FROM pgstrom.gstore_fdw_shard_info
+ WHERE table_oid = 'gstore_delta'::regclass;
+SELECT gstore_export_ipchandle('gstore_delta') IS NOT NULL exported;
+SELECT count(*) nrows, sum(id) sum_id,
+       count(*) FILTER (WHERE label = 'updated') nupdated,
+       count(*) FILTER (WHERE x < 0.0) nnegative
+  FROM gstore_delta;
+-- nothing to be merged any more
+SELECT gstore_fdw_compaction('gstore_delta');
+
+-- delta image is disabled, so the main image is rebuilt
+SET pg_strom.gstore_delta_ratio = 0;
+DELETE FROM gstore_delta WHERE id % 1000 = 2;
+SELECT shard_id, device, nitems
+  FROM pgstrom.gstore_fdw_shard_info
+ WHERE table_oid = 'gstore_delta'::regclass;
+SELECT gstore_export_ipchandle('gstore_delta') IS NOT NULL exported;
+RESET pg_strom.gstore_delta_ratio;
+
+-- only superuser can change the ratio
+CREATE ROLE regress_gstore_user;
+SET ROLE regress_gstore_user;
+SET pg_strom.gstore_delta_ratio = 0.5;
+SET pg_strom.gstore_snapshot = on;
+RESET ROLE;
+DROP ROLE regress_gstore_user;
+
+DROP FOREIGN TABLE gstore_delta;
+
+-- restore from the snapshot file
+SET pg_strom.gstore_snapshot = on;
+SHOW pg_strom.gstore_snapshot;
+
+CREATE FOREIGN TABLE gstore_snap (
+  id     int,
+  x      float8,
+  label  text
+) SERVER gstore_fdw OPTIONS (pinning '0');
+INSERT INTO gstore_snap (
+  SELECT i, i::float8 / 7.0, 'label_' || (i % 100)
+    FROM generate_series(1,100000) i);
+
+SELECT gstore_fdw_reload('gstore_snap');
+-- restored image is visible to everybody, without XID
+SELECT xmin, xmax, nitems
+  FROM pgstrom.gstore_fdw_chunk_info
+ WHERE table_oid = 'gstore_snap'::regclass;
+SELECT count(*) nrows, sum(id) sum_id, count(distinct label) nlabels,
+       sum(x)::numeric(20,3) sum_x
+  FROM gstore_snap;
+
+-- delta image on top of the main image is also restored
+UPDATE gstore_snap SET label = 'updated' WHERE id % 1000 = 0;
+DELETE FROM gstore_snap WHERE id % 1000 = 1;
+SELECT gstore_fdw_reload('gstore_snap');
+SELECT count(*) nrows, sum(id) sum_id,
+       count(*) FILTER (WHERE label = 'updated') nupdated
+  FROM gstore_snap;
+
+DROP FOREIGN TABLE gstore_snap;
+RESET pg_strom.gstore_snapshot;
@@ -0,0 +1,61 @@
+---
+--- Test cases for the shared cache of GPU programs
+---
+CREATE TABLE program_cache_t AS
+  SELECT x id, (x % 100) a, md5(x::text) memo
+    FROM generate_series(1,100000) x;
+ANALYZE program_cache_t;
+
+RESET pg_strom.enabled;
+SET enable_seqscan = off;
+SET max_parallel_workers_per_gather = 0;
+SELECT pgstrom.program_cache_reset();
+SELECT lookups, hits, varlena_misses, num_builds
+  FROM pgstrom.program_cache_info;
+
+-- queries which differ only by constants share the same GPU program
+SELECT count(*) FROM program_cache_t WHERE a < 10 AND memo <> 'abc';
+SELECT count(*) FROM program_cache_t WHERE a < 20 AND memo <> 'abcdefgh';
+SELECT count(*) FROM program_cache_t
+ WHERE a < 30 AND memo <> 'abcdefghijklmnopqrstuvwxyz0123456789';
+SELECT lookups >= 3 lookups, hits >= 2 hits,
+       hit_ratio = hits::float8 / lookups::float8 hit_ratio,
+       varlena_misses, num_builds <= 1 num_builds
+  FROM pgstrom.program_cache_info;
+
+-- PREPARE of the statement without parameters kicks build of GPU programs
+SELECT pgstrom.program_cache_reset();
+PREPARE p1 AS SELECT count(*) FROM program_cache_t WHERE a < 40 AND memo <> 'x';
+SELECT lookups >= 1 lookups FROM pgstrom.program_cache_info;
+SELECT lookups AS lookups_p1 FROM pgstrom.program_cache_info \gset
+EXECUTE p1;
+SELECT lookups > :lookups_p1 lookups, hits >= 1 hits
+  FROM pgstrom.program_cache_info;
+SELECT lookups AS lookups_p1 FROM pgstrom.program_cache_info \gset
+-- the statement with parameters is pre-compiled by its generic plan, and
+-- the custom plans share the GPU program because of the same source
+PREPARE p2(int) AS SELECT count(*) FROM program_cache_t WHERE a < $1;
+SELECT lookups > :lookups_p1 lookups FROM pgstrom.program_cache_info;
+SELECT lookups AS lookups_p2, hits AS hits_p2
+  FROM pgstrom.program_cache_info \gset
+EXECUTE p2(60);
+SELECT lookups > :lookups_p2 lookups, hits > :hits_p2 hits
+  FROM pgstrom.program_cache_info;
+SELECT lookups AS lookups_p1 FROM pgstrom.program_cache_info \gset
+SET pg_strom.precompile_on_prepare = off;
+PREPARE p3 AS SELECT count(*) FROM program_cache_t WHERE a < 50 AND memo <> 'y';
+SELECT lookups = :lookups_p1 lookups FROM pgstrom.program_cache_info;
+RESET pg_strom.precompile_on_prepare;
+DEALLOCATE ALL;
+RESET enable_seqscan;
+RESET max_parallel_workers_per_gather;
+
+-- only superuser can reset the statistics
+CREATE ROLE regress_program_cache_user;
+GRANT USAGE ON SCHEMA pgstrom TO regress_program_cache_user;
+SET ROLE regress_program_cache_user;
+SELECT pgstrom.program_cache_reset();
+RESET ROLE;
+REVOKE USAGE ON SCHEMA pgstrom FROM regress_program_cache_user;
+DROP ROLE regress_program_cache_user;
+DROP TABLE program_cache_t;
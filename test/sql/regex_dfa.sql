@@ -0,0 +1,52 @@
+---
+--- Test cases for regular expression compiled to DFA
+---
+CREATE TABLE regex_dfa_t AS
+  SELECT x id, md5(x::text) v FROM generate_series(1,20000) x;
+
+-- DFA matcher must be consistent to the built-in regular expression
+SELECT id, pattern, icase,
+       nstates IS NOT NULL AS supported,
+       nmatched_dfa = nmatched_pg AS consistent
+  FROM (VALUES (1, 'abc', false),
+               (2, '^[0-9]+[a-f]', false),
+               (3, '(ab|cd)+e$', false),
+               (4, 'a{2,3}[^0-9]{2}', false),
+               (5, '^\d{3}\w*ff$', false),
+               (6, '[[:xdigit:]]{8}0(?:12|3)?', false),
+               (7, 'A.B.C', true),
+               (8, '^(?:e|F)*.[[:alpha:]]', true),
+               (9, '(a)\1', false),
+               (10, 'a(?=b)', false),
+               (11, '\mab', false)) p(id, pattern, icase),
+       LATERAL pgstrom.regex_dfa_bench(ARRAY(SELECT v FROM regex_dfa_t),
+                                       pattern COLLATE "C", icase)
+ ORDER BY id;
+
+-- GPU execution of regular expression operators
+RESET pg_strom.enabled;
+SELECT id, v
+  INTO pg_temp.test_r01a
+  FROM regex_dfa_t
+ WHERE v ~ '^[0-9]+[a-f]' COLLATE "C" AND v !~ '(ab|cd)+e$';
+SELECT id, v
+  INTO pg_temp.test_r02a
+  FROM regex_dfa_t
+ WHERE v ~* 'A.B.C' COLLATE "C" OR v SIMILAR TO '%(00|ff)%';
+SET pg_strom.enabled = off;
+SELECT id, v
+  INTO pg_temp.test_r01b
+  FROM regex_dfa_t
+ WHERE v ~ '^[0-9]+[a-f]' COLLATE "C" AND v !~ '(ab|cd)+e$';
+SELECT id, v
+  INTO pg_temp.test_r02b
+  FROM regex_dfa_t
+ WHERE v ~* 'A.B.C' COLLATE "C" OR v SIMILAR TO '%(00|ff)%';
+RESET pg_strom.enabled;
+
+(SELECT * FROM pg_temp.test_r01a EXCEPT ALL SELECT * FROM pg_temp.test_r01b);
+(SELECT * FROM pg_temp.test_r01b EXCEPT ALL SELECT * FROM pg_temp.test_r01a);
+(SELECT * FROM pg_temp.test_r02a EXCEPT ALL SELECT * FROM pg_temp.test_r02b);
+(SELECT * FROM pg_temp.test_r02b EXCEPT ALL SELECT * FROM pg_temp.test_r02a);
+
+DROP TABLE regex_dfa_t;
@@ -0,0 +1,16 @@
+---
+--- Test cases for the statistics of GPU devices
+---
+SELECT now() before_reset \gset
+SELECT pgstrom.stat_reset();
+SELECT count(*) > 0 devices, bool_and(stats_reset >= :'before_reset') reset
+  FROM pgstrom.stat_device;
+
+-- only superuser can reset the statistics
+CREATE ROLE regress_stat_device_user;
+GRANT USAGE ON SCHEMA pgstrom TO regress_stat_device_user;
+SET ROLE regress_stat_device_user;
+SELECT pgstrom.stat_reset();
+RESET ROLE;
+REVOKE USAGE ON SCHEMA pgstrom FROM regress_stat_device_user;
+DROP ROLE regress_stat_device_user;
@@ -0,0 +1,423 @@
+/*
+ * array_matrix_accum_bench.c
+ *
+ * CPU benchmark to compare the state management of array_matrix()
+ * aggregate; the former one which copies every input vector and keeps
+ * them in a List then transposes them at the final function, and the
+ * current one which writes the input vector into the column-major buffer
+ * in place. It follows the logic of array_matrix_accum() and
+ * array_matrix_final_*() in matrix.c (before and after the in-place
+ * buffer), with a simple emulation of palloc() and lappend(), and also
+ * checks whether both implementations produce identical matrices.
+ * ----
+ * Copyright 2011-2019 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2019 (C) The PG-Strom Development Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#define Max(a,b)	((a) > (b) ? (a) : (b))
+
+static const char  *cmdname;
+
+static void usage(void)
+{
+	fprintf(stderr,
+			"usage: %s [options...]\n"
+			"  options:\n"
+			"    -r <nrows>    : number of input vectors (default: 4000000)\n"
+			"    -c <width>    : width of the input vector (default: 4)\n"
+			"    -l <loops>    : number of iterations (default: 3)\n"
+			"    -h            : print this message and exit\n",
+			cmdname);
+	exit(1);
+}
+
+/*
+ * simple emulation of palloc() on AllocSet; a chunk header and the size
+ * rounded up to power of 2, carved from the blocks of the memory context
+ */
+#define ALLOC_CHUNKHDRSZ	16
+#define ALLOC_BLOCKSZ		(8UL << 20)
+
+typedef struct
+{
+	char	   *pos;
+	char	   *tail;
+	void	  **blocks;
+	size_t		nblocks;
+	size_t		nrooms;
+} memcxt;
+
+static void *
+cxt_alloc(memcxt *cxt, size_t sz)
+{
+	size_t		chunksz = 8;
+	void	   *ptr;
+
+	while (chunksz < sz)
+		chunksz *= 2;
+	chunksz += ALLOC_CHUNKHDRSZ;
+	if (cxt->pos + chunksz > cxt->tail)
+	{
+		if (cxt->nblocks == cxt->nrooms)
+		{
+			cxt->nrooms = Max(2 * cxt->nrooms, 64);
+			cxt->blocks = realloc(cxt->blocks, sizeof(void *) * cxt->nrooms);
+		}
+		cxt->pos = malloc(ALLOC_BLOCKSZ);
+		if (!cxt->blocks || !cxt->pos)
+		{
+			fprintf(stderr, "out of memory\n");
+			exit(1);
+		}
+		cxt->tail = cxt->pos + ALLOC_BLOCKSZ;
+		cxt->blocks[cxt->nblocks++] = cxt->pos;
+	}
+	ptr = cxt->pos + ALLOC_CHUNKHDRSZ;
+	cxt->pos += chunksz;
+	return ptr;
+}
+
+static void
+cxt_reset(memcxt *cxt)
+{
+	while (cxt->nblocks > 0)
+		free(cxt->blocks[--cxt->nblocks]);
+	cxt->pos = cxt->tail = NULL;
+}
+
+/*
+ * vector-like array; same layout as the 1-dimensional ArrayType
+ */
+typedef struct
+{
+	int32_t		vl_len_;
+	int32_t		ndim;
+	int32_t		dataoffset;
+	uint32_t	elemtype;
+	int32_t		dim1;
+	int32_t		lbound1;
+	char		values[];
+} vector_t;
+
+#define VECTOR_SIZE(unitsz,width)	(sizeof(vector_t) + (unitsz) * (width))
+
+/*
+ * List of the supplied vectors; copied in the aggregate context then
+ * chained by lappend(), as PostgreSQL 11 or prior.
+ */
+typedef struct list_cell
+{
+	void			   *data;
+	struct list_cell   *next;
+} list_cell;
+
+typedef struct
+{
+	size_t		length;
+	list_cell  *head;
+	list_cell  *tail;
+} list_t;
+
+typedef struct
+{
+	size_t		width;
+	list_t	   *rows;
+} list_state;
+
+static void
+list_accum(memcxt *cxt, list_state *state, const vector_t *V, int unitsz)
+{
+	size_t		length = VECTOR_SIZE(unitsz, V->dim1);
+	vector_t   *copy = cxt_alloc(cxt, length);
+	list_cell  *cell;
+
+	/* PG_GETARG_ARRAYTYPE_P_COPY */
+	memcpy(copy, V, length);
+	state->width = Max(state->width, (size_t)V->dim1);
+	/* lappend */
+	if (!state->rows)
+	{
+		state->rows = cxt_alloc(cxt, sizeof(list_t));
+		state->rows->length = 0;
+		state->rows->head = NULL;
+		state->rows->tail = NULL;
+	}
+	cell = cxt_alloc(cxt, sizeof(list_cell));
+	cell->data = copy;
+	cell->next = NULL;
+	if (state->rows->tail)
+		state->rows->tail->next = cell;
+	else
+		state->rows->head = cell;
+	state->rows->tail = cell;
+	state->rows->length++;
+}
+
+#define LIST_FINAL_TEMPLATE(R,state,BASETYPE)							\
+	do {																\
+		size_t		height = (state)->rows->length;						\
+		size_t		row_index = 0;										\
+		list_cell  *lc;													\
+																		\
+		for (lc = (state)->rows->head; lc; lc = lc->next)				\
+		{																\
+			vector_t   *V = lc->data;									\
+			size_t		i, nitems = V->dim1;							\
+			BASETYPE   *src = (BASETYPE *)V->values;					\
+			BASETYPE   *dst = (BASETYPE *)(R) + row_index;				\
+																		\
+			for (i=0; i < nitems; i++, src++, dst += height)			\
+				*dst = *src;											\
+			row_index++;												\
+		}																\
+	} while(0)
+
+static void
+list_final(char *R, list_state *state, int unitsz)
+{
+	if (unitsz == sizeof(uint32_t))
+		LIST_FINAL_TEMPLATE(R, state, uint32_t);
+	else
+		LIST_FINAL_TEMPLATE(R, state, uint64_t);
+}
+
+/*
+ * column-major buffer written in place; same as matrix.c
+ */
+#define ARRAY_MATRIX_STATE_MIN_NROOMS		256
+
+typedef struct
+{
+	size_t		typlen;
+	size_t		width;
+	size_t		height;
+	size_t		nrooms;
+	char	   *values;
+} inplace_state;
+
+static void
+inplace_expand(inplace_state *state, size_t width, size_t height)
+{
+	size_t		typlen = state->typlen;
+	size_t		nrooms = state->nrooms;
+	char	   *values;
+	size_t		i;
+
+	if (width <= state->width && height <= state->nrooms)
+		return;
+	if (height > state->nrooms)
+		nrooms = Max(Max(ARRAY_MATRIX_STATE_MIN_NROOMS, 2 * nrooms), height);
+	width = Max(width, state->width);
+
+	/* AllocSet allocates the chunks larger than 8kB by malloc() */
+	values = malloc(typlen * nrooms * width);
+	if (!values)
+	{
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+	for (i=0; i < state->width; i++)
+		memcpy(values + typlen * nrooms * i,
+			   state->values + typlen * state->nrooms * i,
+			   typlen * state->height);
+	free(state->values);
+	for (i=state->width; i < width; i++)
+		memset(values + typlen * nrooms * i, 0, typlen * state->height);
+	state->width = width;
+	state->nrooms = nrooms;
+	state->values = values;
+}
+
+#define INPLACE_APPEND_TEMPLATE(state,src,nitems,BASETYPE)				\
+	do {																\
+		BASETYPE   *__src = (BASETYPE *)(src);							\
+		BASETYPE   *__dst = ((BASETYPE *)(state)->values +				\
+							 (state)->height);							\
+		size_t		__i;												\
+																		\
+		for (__i=0; __i < (nitems); __i++, __dst += (state)->nrooms)	\
+			*__dst = __src[__i];										\
+		for (; __i < (state)->width; __i++, __dst += (state)->nrooms)	\
+			*__dst = 0;													\
+	} while(0)
+
+static void
+inplace_accum(inplace_state *state, const vector_t *V)
+{
+	inplace_expand(state, V->dim1, state->height + 1);
+	if (state->typlen == sizeof(uint32_t))
+		INPLACE_APPEND_TEMPLATE(state, V->values, V->dim1, uint32_t);
+	else
+		INPLACE_APPEND_TEMPLATE(state, V->values, V->dim1, uint64_t);
+	state->height++;
+}
+
+static void
+inplace_final(char *R, inplace_state *state)
+{
+	size_t		typlen = state->typlen;
+	size_t		i;
+
+	if (state->nrooms == state->height)
+		memcpy(R, state->values, typlen * state->height * state->width);
+	else
+	{
+		for (i=0; i < state->width; i++)
+			memcpy(R + typlen * state->height * i,
+				   state->values + typlen * state->nrooms * i,
+				   typlen * state->height);
+	}
+}
+
+static double
+elapsed_ms(struct timespec *tv1, struct timespec *tv2)
+{
+	return ((double)(tv2->tv_sec - tv1->tv_sec) * 1000.0 +
+			(double)(tv2->tv_nsec - tv1->tv_nsec) / 1000000.0);
+}
+
+int main(int argc, char *argv[])
+{
+	size_t		nrows = 4000000;
+	size_t		width = 4;
+	int			nloops = 3;
+	int			unitsz;
+	char	   *input;
+	char	   *R[2];
+	double		best[2][2];
+	struct timespec tv1, tv2, tv3;
+	size_t		i, vsize, length;
+	int			c, j, k;
+
+	cmdname = argv[0];
+	while ((c = getopt(argc, argv, "r:c:l:h")) >= 0)
+	{
+		switch (c)
+		{
+			case 'r':
+				nrows = atol(optarg);
+				break;
+			case 'c':
+				width = atol(optarg);
+				break;
+			case 'l':
+				nloops = atoi(optarg);
+				break;
+			default:
+				usage();
+				break;
+		}
+	}
+	if (nrows < 1 || width < 1 || nloops < 1)
+		usage();
+
+	printf("nrows=%zu width=%zu nloops=%d\n", nrows, width, nloops);
+	printf("%-8s %-8s %12s %12s %12s %14s\n",
+		   "unitsz", "state", "accum[ms]", "final[ms]", "total[ms]",
+		   "Mrows/sec");
+	for (unitsz = sizeof(uint32_t); unitsz <= sizeof(uint64_t); unitsz *= 2)
+	{
+		/* input vectors, as if they are fetched from the tuples */
+		vsize = (VECTOR_SIZE(unitsz, width) + 7) & ~7UL;
+		input = malloc(vsize * nrows);
+		length = unitsz * nrows * width;
+		R[0] = malloc(length);
+		R[1] = malloc(length);
+		if (!input || !R[0] || !R[1])
+		{
+			fprintf(stderr, "out of memory\n");
+			return 1;
+		}
+		for (i=0; i < nrows; i++)
+		{
+			vector_t   *V = (vector_t *)(input + vsize * i);
+
+			V->vl_len_ = VECTOR_SIZE(unitsz, width);
+			V->ndim = 1;
+			V->dataoffset = 0;
+			V->elemtype = (unitsz == sizeof(uint32_t) ? 700 : 701);
+			V->dim1 = width;
+			V->lbound1 = 1;
+			for (j=0; j < unitsz * width; j++)
+				V->values[j] = (char)(i * 7 + j * 13 + (i >> 8));
+		}
+		memset(R[0], 0, length);
+		memset(R[1], 0, length);
+
+		for (k=0; k < 2; k++)
+			best[k][0] = best[k][1] = -1.0;
+		for (j=0; j < nloops; j++)
+		{
+			memcxt		cxt;
+			list_state	lstate;
+			inplace_state istate;
+
+			/* List of the copied vectors, then transpose */
+			memset(&cxt, 0, sizeof(memcxt));
+			memset(&lstate, 0, sizeof(list_state));
+			clock_gettime(CLOCK_MONOTONIC, &tv1);
+			for (i=0; i < nrows; i++)
+				list_accum(&cxt, &lstate,
+						   (vector_t *)(input + vsize * i), unitsz);
+			clock_gettime(CLOCK_MONOTONIC, &tv2);
+			list_final(R[0], &lstate, unitsz);
+			clock_gettime(CLOCK_MONOTONIC, &tv3);
+			cxt_reset(&cxt);
+			if (best[0][0] < 0.0 ||
+				elapsed_ms(&tv1, &tv3) < best[0][0] + best[0][1])
+			{
+				best[0][0] = elapsed_ms(&tv1, &tv2);
+				best[0][1] = elapsed_ms(&tv2, &tv3);
+			}
+
+			/* column-major buffer written in place */
+			memset(&istate, 0, sizeof(inplace_state));
+			istate.typlen = unitsz;
+			clock_gettime(CLOCK_MONOTONIC, &tv1);
+			for (i=0; i < nrows; i++)
+				inplace_accum(&istate, (vector_t *)(input + vsize * i));
+			clock_gettime(CLOCK_MONOTONIC, &tv2);
+			inplace_final(R[1], &istate);
+			clock_gettime(CLOCK_MONOTONIC, &tv3);
+			free(istate.values);
+			if (best[1][0] < 0.0 ||
+				elapsed_ms(&tv1, &tv3) < best[1][0] + best[1][1])
+			{
+				best[1][0] = elapsed_ms(&tv1, &tv2);
+				best[1][1] = elapsed_ms(&tv2, &tv3);
+			}
+		}
+		for (k=0; k < 2; k++)
+		{
+			printf("%-8d %-8s %12.2f %12.2f %12.2f %14.2f\n",
+				   unitsz, k == 0 ? "list" : "inplace",
+				   best[k][0], best[k][1], best[k][0] + best[k][1],
+				   (double)nrows / (best[k][0] + best[k][1]) / 1000.0);
+		}
+		/* both implementations must produce identical matrices */
+		if (memcmp(R[0], R[1], length) != 0)
+		{
+			fprintf(stderr, "matrix mismatch (unitsz=%d)\n", unitsz);
+			return 1;
+		}
+		free(input);
+		free(R[0]);
+		free(R[1]);
+	}
+	return 0;
+}
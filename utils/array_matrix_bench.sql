@@ -0,0 +1,64 @@
+--
+-- Throughput benchmark of the array_matrix aggregate
+-- (make array_matrix_bench)
+--
+-- It runs array_matrix() on the same table with 0, 1, 2 and 4 parallel
+-- workers, and reports the best execution time of the loops. With the
+-- parallel workers, each worker builds a partial matrix, then the leader
+-- merges them by array_matrix_combine through the serialized states.
+-- Comparison with the former List-based state is done by
+-- array_matrix_accum_bench (make array_matrix_accum_bench), because it
+-- cannot coexist with the current one in the same installation.
+--
+-- usage: psql -v nrows=<number of rows> -v nloops=<number of loops> \
+--             -f array_matrix_bench.sql [dbname]
+--
+SET client_min_messages = warning;
+DROP TABLE IF EXISTS pgstrom_array_matrix_bench;
+RESET client_min_messages;
+CREATE UNLOGGED TABLE pgstrom_array_matrix_bench AS
+  SELECT x id, random()::real a, random()::real b,
+               random()::real c, random()::real d
+    FROM generate_series(1, :nrows) x;
+ALTER TABLE pgstrom_array_matrix_bench SET (parallel_workers = 4);
+VACUUM ANALYZE pgstrom_array_matrix_bench;
+
+SET pg_strom.enabled = off;
+SET parallel_setup_cost = 0;
+SET parallel_tuple_cost = 0;
+
+-- EXPLAIN ANALYZE is planned with parallel query even if invoked by PL/pgSQL
+CREATE FUNCTION pg_temp.array_matrix_bench(nworkers int, nloops int,
+                                           OUT workers int,
+                                           OUT launched int,
+                                           OUT partial_mode text,
+                                           OUT best_ms float8)
+AS $$
+DECLARE
+  plan  json;
+  ms    float8;
+  i     int;
+BEGIN
+  PERFORM set_config('max_parallel_workers_per_gather', nworkers::text, true);
+  workers := nworkers;
+  FOR i IN 1 .. nloops LOOP
+    EXECUTE 'EXPLAIN (ANALYZE, TIMING off, FORMAT JSON) '
+            'SELECT array_matrix(a, b, c, d) FROM pgstrom_array_matrix_bench'
+       INTO plan;
+    ms := (plan->0->>'Execution Time')::float8;
+    IF best_ms IS NULL OR ms < best_ms THEN
+      best_ms := ms;
+    END IF;
+  END LOOP;
+  partial_mode := plan->0->'Plan'->>'Partial Mode';
+  launched := coalesce((plan->0->'Plan'->'Plans'->0->>'Workers Launched')::int, 0);
+END;
+$$ LANGUAGE plpgsql;
+
+SELECT workers, launched, partial_mode,
+       round(best_ms::numeric, 2) best_ms,
+       round((:nrows / best_ms / 1000.0)::numeric, 2) mrows_per_sec
+  FROM unnest(ARRAY[0,1,2,4]) w,
+       LATERAL pg_temp.array_matrix_bench(w, :nloops);
+
+DROP TABLE pgstrom_array_matrix_bench;
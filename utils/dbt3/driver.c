@@ -62,6 +62,7 @@
 #include <stdlib.h>
 #if (defined(_POSIX_)||!defined(WIN32))		/* Change for Windows NT */
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/wait.h>
 #endif /* WIN32 */
 #include <stdio.h>				/* */
@@ -113,6 +114,8 @@ void	gen_tbl (int tnum, DSS_HUGE start, DSS_HUGE count, long upd_num);
 int		pr_drange (int tbl, DSS_HUGE min, DSS_HUGE cnt, long num);
 int		set_files (int t, int pload);
 int		partial (int, int);
+void	skip_rows (int tnum, DSS_HUGE count);
+int		pgen_tbl (int tnum, DSS_HUGE start, DSS_HUGE count);
 
 
 extern int optind, opterr;
@@ -128,6 +131,16 @@ extern seed_t Seed[];
 #endif
 static int bTableSet = 0;
 int print_to_stdout = 1;
+static long workers = 1;
+
+/*
+* number of rows per chunk of parallel generation (-j); each worker
+* generates every <workers>-th chunk
+*/
+#ifndef PGEN_CHUNK_ROWS
+#define PGEN_CHUNK_ROWS		10000
+#endif
+#define PGEN_BUFFER_SIZE	(4 << 20)
 
 /*
 * general table descriptions. See dss.h for details on structure
@@ -388,6 +401,7 @@ usage (void)
 	fprintf (stderr, "-C <n> -- separate data set into <n> chunks (requires -S, default: 1)\n");
 	fprintf (stderr, "-f     -- force. Overwrite existing files\n");
 	fprintf (stderr, "-h     -- display this message\n");
+	fprintf (stderr, "-j <n> -- generate data by <n> worker processes (default: 1)\n");
 	fprintf (stderr, "-q     -- enable QUIET mode\n");
 	fprintf (stderr, "-s <n> -- set Scale Factor (SF) to  <n> (default: 1) \n");
 	fprintf (stderr, "-S <n> -- build the <n>th step of the data/update set (used with -C or -U)\n");
@@ -446,6 +460,169 @@ partial (int tbl, int s)
 	return (0);
 }
 
+/*
+* void skip_rows(int tbl, DSS_HUGE count) -- advance the RNG streams of the
+* named table as if <count> rows were generated
+*/
+void
+skip_rows (int tnum, DSS_HUGE count)
+{
+	if (count <= 0)
+		return;
+	if (tnum == LINE)	/* special case for shared seeds */
+		tdefs[tnum].gen_seed(1, count);
+	else
+		tdefs[tnum].gen_seed(0, count);
+	if (tdefs[tnum].child != NONE)
+		tdefs[tdefs[tnum].child].gen_seed(0, count);
+}
+
+/*
+* int pgen_tbl(int tbl, DSS_HUGE start, DSS_HUGE count) -- generate the
+* named table by <workers> processes, and write out a single stream
+*
+* The rows are split into chunks of PGEN_CHUNK_ROWS, and the k-th chunk is
+* generated by the (k % workers)-th worker, after advancing the RNG streams
+* to the head of the chunk. So, the output is identical to the serial one.
+* Each worker writes out a chunk followed by '\0' to its own pipe, and the
+* parent process relays the chunks in order.
+*/
+typedef struct
+{
+	int		fdesc;
+	size_t	pos;
+	size_t	len;
+	char	buf[PGEN_BUFFER_SIZE];
+} pgen_worker;
+
+int
+pgen_tbl (int tnum, DSS_HUGE start, DSS_HUGE count)
+{
+	DSS_HUGE nchunks = (count + PGEN_CHUNK_ROWS - 1) / PGEN_CHUNK_ROWS;
+	DSS_HUGE k;
+	pid_t  *pids;
+	pgen_worker *pw;
+	char	temp[2];
+	int		c, w, status, rv = 0;
+
+	pids = (pid_t *) malloc (sizeof (pid_t) * workers);
+	pw = (pgen_worker *) malloc (sizeof (pgen_worker) * workers);
+	MALLOC_CHECK (pids);
+	MALLOC_CHECK (pw);
+
+	/* build the text pool once, prior to fork; P_RCST_SD is unused */
+	dbg_text (temp, 1, 1, P_RCST_SD);
+
+	fflush (stdout);
+	for (w = 0; w < workers; w++)
+	{
+		int		pfd[2];
+
+		if (pipe (pfd) != 0)
+		{
+			perror ("pipe");
+			exit (1);
+		}
+#ifdef F_SETPIPE_SZ
+		fcntl (pfd[1], F_SETPIPE_SZ, 1 << 20);
+#endif
+		pids[w] = fork ();
+		if (pids[w] < 0)
+		{
+			perror ("Worker process not created");
+			exit (1);
+		}
+		else if (pids[w] == 0)	/* WORKER */
+		{
+			DSS_HUGE curr = 0;
+
+			for (c = 0; c < w; c++)
+				close (pw[c].fdesc);
+			close (pfd[0]);
+			if (dup2 (pfd[1], 1) < 0)
+			{
+				perror ("dup2");
+				exit (1);
+			}
+			close (pfd[1]);
+			setvbuf (stdout, pw[w].buf, _IOFBF, PGEN_BUFFER_SIZE);
+			verbose = 0;
+			for (k = w; k < nchunks; k += workers)
+			{
+				DSS_HUGE head = k * PGEN_CHUNK_ROWS;
+				DSS_HUGE nrows = count - head;
+
+				if (nrows > PGEN_CHUNK_ROWS)
+					nrows = PGEN_CHUNK_ROWS;
+				skip_rows (tnum, head - curr);
+				gen_tbl (tnum, start + head, nrows, upd_num);
+				fputc ('\0', stdout);
+				fflush (stdout);
+				curr = head + nrows;
+			}
+			exit (ferror (stdout) ? 1 : 0);
+		}
+		close (pfd[1]);
+		pw[w].fdesc = pfd[0];
+		pw[w].pos = 0;
+		pw[w].len = 0;
+	}
+
+	/* relay the chunks in order */
+	for (k = 0; k < nchunks; k++)
+	{
+		pgen_worker *curr = &pw[k % workers];
+
+		for (;;)
+		{
+			char   *tail;
+			ssize_t	nbytes;
+
+			if (curr->pos < curr->len)
+			{
+				tail = memchr (curr->buf + curr->pos, '\0',
+							   curr->len - curr->pos);
+				if (tail)
+				{
+					fwrite (curr->buf + curr->pos, 1,
+							tail - (curr->buf + curr->pos), stdout);
+					curr->pos = tail - curr->buf + 1;
+					break;
+				}
+				fwrite (curr->buf + curr->pos, 1,
+						curr->len - curr->pos, stdout);
+			}
+			curr->pos = curr->len = 0;
+			nbytes = read (curr->fdesc, curr->buf, PGEN_BUFFER_SIZE);
+			if (nbytes < 0 && errno == EINTR)
+				continue;
+			if (nbytes <= 0)
+			{
+				fprintf (stderr, "worker %d terminated unexpectedly\n",
+						 (int)(k % workers));
+				exit (1);
+			}
+			curr->len = nbytes;
+		}
+	}
+	fflush (stdout);
+
+	for (w = 0; w < workers; w++)
+	{
+		close (pw[w].fdesc);
+		if (waitpid (pids[w], &status, 0) < 0 ||
+			!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+		{
+			fprintf (stderr, "worker %d failed\n", w);
+			rv = 1;
+		}
+	}
+	free (pw);
+	free (pids);
+
+	return (rv);
+}
+
 void
 process_options (int count, char **vector)
 {
@@ -453,7 +630,7 @@ process_options (int count, char **vector)
 	FILE *pF;
 	
 	while ((option = getopt (count, vector,
-		"b:C:d:fi:hO:P:qs:S:T:U:vX")) != -1)
+		"b:C:d:fi:hj:O:P:qs:S:T:U:vX")) != -1)
 	switch (option)
 	{
 		case 'b':				/* load distributions from named file */
@@ -481,6 +658,14 @@ process_options (int count, char **vector)
 		case 'i':
 			insert_segments = atoi (optarg);
 			break;
+		case 'j':
+			workers = atoi (optarg);
+			if (workers < 1)
+			{
+				fprintf (stderr, "ERROR: -j must be 1 or larger\n");
+				exit (1);
+			}
+			break;
 		case 'q':				/* all prompts disabled */
 			verbose = -1;
 			break;
@@ -665,6 +850,12 @@ void validate_options(void)
 		exit(-1);
 	}
 
+	if (workers > 1 && (children != 1 || updates != 0))
+	{
+		fprintf(stderr, "ERROR: -j is not valid with -C or -U\n");
+		exit(-1);
+	}
+
 	return;
 }
 
@@ -808,7 +999,13 @@ main (int ac, char **av)
 					rowcnt = tdefs[i].base;
 				if (verbose > 0)
 					fprintf (stderr, "Generating data for %s", tdefs[i].comment);
-				gen_tbl ((int)i, minrow, rowcnt, upd_num);
+				if (workers > 1 && i < NATION)
+				{
+					if (pgen_tbl ((int)i, minrow, rowcnt) != 0)
+						exit (1);
+				}
+				else
+					gen_tbl ((int)i, minrow, rowcnt, upd_num);
 				if (verbose > 0)
 					fprintf (stderr, "done.\n");
 			}
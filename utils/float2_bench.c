@@ -0,0 +1,505 @@
+/*
+ * float2_bench.c
+ *
+ * CPU benchmark to compare the scalar and F16C/AVX2 implementations of
+ * the batched float2 array routines; conversion between float2[] and
+ * float4[], dot-product and L2-distance. It follows the logic of the
+ * float2_array_* kernels in float2.c, and also checks whether both
+ * implementations produce identical results.
+ * ----
+ * Copyright 2011-2019 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2019 (C) The PG-Strom Development Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+#include <cpuid.h>
+#include <immintrin.h>
+
+typedef uint16_t	half_t;
+
+static const char  *cmdname;
+
+static void usage(void)
+{
+	fprintf(stderr,
+			"usage: %s [options...]\n"
+			"  options:\n"
+			"    -n <nitems>   : number of items per array (default: 1024)\n"
+			"    -l <loops>    : number of iterations (default: 100000)\n"
+			"    -s <seed>     : seed of random values\n"
+			"    -h            : print this message and exit\n",
+			cmdname);
+	exit(1);
+}
+
+static inline uint32_t
+float_as_int(float fval)
+{
+	union { float fval; uint32_t ival; } u;
+
+	u.fval = fval;
+	return u.ival;
+}
+
+static inline float
+int_as_float(uint32_t ival)
+{
+	union { float fval; uint32_t ival; } u;
+
+	u.ival = ival;
+	return u.fval;
+}
+
+/* same as fp32_to_fp16_rn() in float2.c */
+static inline half_t
+fp32_to_fp16_rn(uint32_t fp32val)
+{
+	uint32_t	sign = ((fp32val >> 16) & 0x8000);
+	uint32_t	absv = (fp32val & 0x7fffffffU);
+	uint32_t	frac, rem, half;
+	int			shift;
+
+	if (absv >= 0x7f800000U)
+	{
+		if (absv == 0x7f800000U)
+			return sign | 0x7c00;
+		return sign | 0x7e00 | ((absv >> 13) & 0x03ff);
+	}
+	if (absv >= 0x477ff000U)
+		return sign | 0x7c00;
+	if (absv >= 0x38800000U)
+	{
+		absv += 0x0fff + ((absv >> 13) & 1);
+		return sign | ((absv - 0x38000000U) >> 13);
+	}
+	if (absv <= 0x33000000U)
+		return sign;
+	shift = 126 - (absv >> 23);
+	frac = (absv & 0x007fffffU) | 0x00800000U;
+	rem = frac & ((1U << shift) - 1);
+	half = (1U << (shift - 1));
+	frac >>= shift;
+	if (rem > half || (rem == half && (frac & 1) != 0))
+		frac++;
+	return sign | frac;
+}
+
+/* same as fp16_to_fp32() in float2.c */
+static inline float
+fp16_to_fp32(half_t fp16val)
+{
+	uint32_t	sign = ((uint32_t)(fp16val & 0x8000) << 16);
+	int32_t		expo = ((fp16val & 0x7c00) >> 10);
+	int32_t		frac = ((fp16val & 0x03ff));
+	uint32_t	result;
+
+	if (expo == 0x1f)
+	{
+		if (frac == 0)
+			result = (sign | 0x7f800000);
+		else
+			result = (sign | 0x7fc00000 | (frac << 13));
+	}
+	else if (expo == 0 && frac == 0)
+		result = sign;
+	else
+	{
+		if (expo == 0)
+		{
+			expo = -14;
+			while ((frac & 0x400) == 0)
+			{
+				frac <<= 1;
+				expo--;
+			}
+			frac &= 0x3ff;
+		}
+		else
+			expo -= 15;
+
+		expo += 127;
+		result = (sign | (expo << 23) | (frac << 13));
+	}
+	return int_as_float(result);
+}
+
+#define FP32_IS_FP16_OVERFLOW(fp32val)							\
+	(((fp32val) & 0x7fffffffU) - 0x477ff000U < 0x7f800000U - 0x477ff000U)
+
+static inline double
+float2_array_sum_lanes(const double *lanes)
+{
+	return (((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+			((lanes[4] + lanes[5]) + (lanes[6] + lanes[7])));
+}
+
+/*
+ * scalar kernels
+ */
+static void
+float2_array_to_float4_scalar(float *dst, const half_t *src, size_t nitems)
+{
+	size_t		i;
+
+	for (i=0; i < nitems; i++)
+		dst[i] = fp16_to_fp32(src[i]);
+}
+
+static size_t
+float4_array_to_float2_scalar(half_t *dst, const float *src, size_t nitems)
+{
+	size_t		i;
+
+	for (i=0; i < nitems; i++)
+	{
+		uint32_t	fp32val = float_as_int(src[i]);
+
+		if (FP32_IS_FP16_OVERFLOW(fp32val))
+			break;
+		dst[i] = fp32_to_fp16_rn(fp32val);
+	}
+	return i;
+}
+
+static double
+float2_array_dot_scalar(const half_t *x, const half_t *y, size_t nitems)
+{
+	double		lanes[8] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+	size_t		i;
+
+	for (i=0; i < nitems; i++)
+		lanes[i & 7] += (double)(fp16_to_fp32(x[i]) * fp16_to_fp32(y[i]));
+	return float2_array_sum_lanes(lanes);
+}
+
+static double
+float2_array_l2_scalar(const half_t *x, const half_t *y, size_t nitems)
+{
+	double		lanes[8] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+	double		d;
+	size_t		i;
+
+	for (i=0; i < nitems; i++)
+	{
+		d = (double)fp16_to_fp32(x[i]) - (double)fp16_to_fp32(y[i]);
+		lanes[i & 7] += d * d;
+	}
+	return float2_array_sum_lanes(lanes);
+}
+
+/*
+ * F16C/AVX2 kernels
+ */
+__attribute__((target("avx2,f16c")))
+static void
+float2_array_to_float4_f16c(float *dst, const half_t *src, size_t nitems)
+{
+	size_t		i;
+
+	for (i=0; i + 8 <= nitems; i += 8)
+	{
+		__m128i		h = _mm_loadu_si128((const __m128i *)(src + i));
+
+		_mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+	}
+	for (; i < nitems; i++)
+		dst[i] = fp16_to_fp32(src[i]);
+}
+
+__attribute__((target("avx2,f16c")))
+static size_t
+float4_array_to_float2_f16c(half_t *dst, const float *src, size_t nitems)
+{
+	const __m256 absmask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+	const __m256 ovflow = _mm256_castsi256_ps(_mm256_set1_epi32(0x477ff000));
+	const __m256 infval = _mm256_castsi256_ps(_mm256_set1_epi32(0x7f800000));
+	size_t		i;
+
+	for (i=0; i + 8 <= nitems; i += 8)
+	{
+		__m256		v = _mm256_loadu_ps(src + i);
+		__m256		a = _mm256_and_ps(v, absmask);
+
+		if (_mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(a, ovflow, _CMP_GE_OQ),
+											 _mm256_cmp_ps(a, infval, _CMP_LT_OQ))))
+			break;
+		_mm_storeu_si128((__m128i *)(dst + i),
+						 _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+	}
+	for (; i < nitems; i++)
+	{
+		uint32_t	fp32val = float_as_int(src[i]);
+
+		if (FP32_IS_FP16_OVERFLOW(fp32val))
+			break;
+		dst[i] = fp32_to_fp16_rn(fp32val);
+	}
+	return i;
+}
+
+__attribute__((target("avx2,f16c")))
+static double
+float2_array_dot_f16c(const half_t *x, const half_t *y, size_t nitems)
+{
+	__m256d		sum_lo = _mm256_setzero_pd();
+	__m256d		sum_hi = _mm256_setzero_pd();
+	double		lanes[8];
+	size_t		i;
+
+	for (i=0; i + 8 <= nitems; i += 8)
+	{
+		__m256	xv = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(x + i)));
+		__m256	yv = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(y + i)));
+		__m256	pv = _mm256_mul_ps(xv, yv);
+
+		sum_lo = _mm256_add_pd(sum_lo, _mm256_cvtps_pd(_mm256_castps256_ps128(pv)));
+		sum_hi = _mm256_add_pd(sum_hi, _mm256_cvtps_pd(_mm256_extractf128_ps(pv, 1)));
+	}
+	_mm256_storeu_pd(lanes, sum_lo);
+	_mm256_storeu_pd(lanes + 4, sum_hi);
+	for (; i < nitems; i++)
+		lanes[i & 7] += (double)(fp16_to_fp32(x[i]) * fp16_to_fp32(y[i]));
+	return float2_array_sum_lanes(lanes);
+}
+
+__attribute__((target("avx2,f16c")))
+static double
+float2_array_l2_f16c(const half_t *x, const half_t *y, size_t nitems)
+{
+	__m256d		sum_lo = _mm256_setzero_pd();
+	__m256d		sum_hi = _mm256_setzero_pd();
+	double		lanes[8];
+	double		d;
+	size_t		i;
+
+	for (i=0; i + 8 <= nitems; i += 8)
+	{
+		__m256	xv = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(x + i)));
+		__m256	yv = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(y + i)));
+		__m256d	d_lo = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(xv)),
+									 _mm256_cvtps_pd(_mm256_castps256_ps128(yv)));
+		__m256d	d_hi = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(xv, 1)),
+									 _mm256_cvtps_pd(_mm256_extractf128_ps(yv, 1)));
+
+		sum_lo = _mm256_add_pd(sum_lo, _mm256_mul_pd(d_lo, d_lo));
+		sum_hi = _mm256_add_pd(sum_hi, _mm256_mul_pd(d_hi, d_hi));
+	}
+	_mm256_storeu_pd(lanes, sum_lo);
+	_mm256_storeu_pd(lanes + 4, sum_hi);
+	for (; i < nitems; i++)
+	{
+		d = (double)fp16_to_fp32(x[i]) - (double)fp16_to_fp32(y[i]);
+		lanes[i & 7] += d * d;
+	}
+	return float2_array_sum_lanes(lanes);
+}
+
+static int
+cpu_has_f16c(void)
+{
+	unsigned int	eax, ebx, ecx, edx;
+
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || (ecx & bit_F16C) == 0)
+		return 0;
+	return __builtin_cpu_supports("avx2");
+}
+
+static double
+elapsed_ms(struct timespec *tv1, struct timespec *tv2)
+{
+	return ((double)(tv2->tv_sec - tv1->tv_sec) * 1000.0 +
+			(double)(tv2->tv_nsec - tv1->tv_nsec) / 1000000.0);
+}
+
+/*
+ * check_conversion - all the 2^32 patterns of float4 and 2^16 patterns of
+ * float2 must be converted to the identical results by both kernels.
+ */
+__attribute__((target("avx2,f16c")))
+static void
+check_conversion(void)
+{
+	static float	fbuf[65536];
+	static float	fres[2][65536];
+	static half_t	hbuf[65536];
+	static half_t	hres[2][65536];
+	uint64_t		base;
+	uint32_t		i, n0, n1;
+
+	for (i=0; i < 65536; i++)
+		hbuf[i] = i;
+	float2_array_to_float4_scalar(fres[0], hbuf, 65536);
+	float2_array_to_float4_f16c(fres[1], hbuf, 65536);
+	if (memcmp(fres[0], fres[1], sizeof(float) * 65536) != 0)
+	{
+		fprintf(stderr, "float2 -> float4 mismatch\n");
+		exit(1);
+	}
+
+	for (base=0; base < (1UL << 32); base += 65536)
+	{
+		for (i=0; i < 65536; i++)
+			fbuf[i] = int_as_float((uint32_t)(base + i));
+		n0 = float4_array_to_float2_scalar(hres[0], fbuf, 65536);
+		n1 = float4_array_to_float2_f16c(hres[1], fbuf, 65536);
+		if (n0 != n1 || memcmp(hres[0], hres[1], sizeof(half_t) * n0) != 0)
+		{
+			fprintf(stderr, "float4 -> float2 mismatch at 0x%08lx\n", base);
+			exit(1);
+		}
+		/* skip the out of range values */
+		if (n0 < 65536)
+		{
+			for (i=n0; i < 65536; i++)
+			{
+				uint32_t	fp32val = (uint32_t)(base + i);
+
+				if (FP32_IS_FP16_OVERFLOW(fp32val))
+					continue;
+				if (fp32_to_fp16_rn(fp32val) !=
+					_cvtss_sh(int_as_float(fp32val), _MM_FROUND_TO_NEAREST_INT))
+				{
+					fprintf(stderr, "float4 -> float2 mismatch at 0x%08x\n",
+							fp32val);
+					exit(1);
+				}
+			}
+		}
+	}
+	printf("conversion check: ok\n");
+}
+
+int main(int argc, char *argv[])
+{
+	int			nitems = 1024;
+	int			nloops = 100000;
+	long		seed = time(NULL);
+	half_t	   *x, *y, *h;
+	float	   *f;
+	double		r0, r1, dummy = 0.0;
+	struct timespec tv1, tv2;
+	int			c, i, k;
+
+	cmdname = argv[0];
+	while ((c = getopt(argc, argv, "n:l:s:h")) >= 0)
+	{
+		switch (c)
+		{
+			case 'n':
+				nitems = atoi(optarg);
+				break;
+			case 'l':
+				nloops = atoi(optarg);
+				break;
+			case 's':
+				seed = atol(optarg);
+				break;
+			default:
+				usage();
+				break;
+		}
+	}
+	if (nitems < 1 || nloops < 1)
+		usage();
+	if (!cpu_has_f16c())
+	{
+		fprintf(stderr, "this CPU does not support F16C/AVX2\n");
+		return 1;
+	}
+	check_conversion();
+
+	srand48(seed);
+	x = malloc(sizeof(half_t) * nitems);
+	y = malloc(sizeof(half_t) * nitems);
+	h = malloc(sizeof(half_t) * nitems);
+	f = malloc(sizeof(float) * nitems);
+	if (!x || !y || !h || !f)
+	{
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	for (i=0; i < nitems; i++)
+	{
+		x[i] = fp32_to_fp16_rn(float_as_int((float)(drand48() * 2.0 - 1.0)));
+		y[i] = fp32_to_fp16_rn(float_as_int((float)(drand48() * 2.0 - 1.0)));
+	}
+	r0 = float2_array_dot_scalar(x, y, nitems);
+	r1 = float2_array_dot_f16c(x, y, nitems);
+	if (r0 != r1)
+		printf("dot-product mismatch: %.17g %.17g\n", r0, r1);
+	r0 = float2_array_l2_scalar(x, y, nitems);
+	r1 = float2_array_l2_f16c(x, y, nitems);
+	if (r0 != r1)
+		printf("l2-distance mismatch: %.17g %.17g\n", r0, r1);
+
+	printf("nitems=%d nloops=%d\n", nitems, nloops);
+	printf("%-16s %12s %12s\n", "kernel", "scalar [ms]", "f16c [ms]");
+	for (k=0; k < 4; k++)
+	{
+		const char *label = NULL;
+		double		ms[2];
+		int			j;
+
+		for (j=0; j < 2; j++)
+		{
+			clock_gettime(CLOCK_MONOTONIC, &tv1);
+			for (i=0; i < nloops; i++)
+			{
+				switch (k)
+				{
+					case 0:
+						label = "float2->float4";
+						if (j == 0)
+							float2_array_to_float4_scalar(f, x, nitems);
+						else
+							float2_array_to_float4_f16c(f, x, nitems);
+						dummy += f[i % nitems];
+						break;
+					case 1:
+						label = "float4->float2";
+						if (j == 0)
+							float4_array_to_float2_scalar(h, f, nitems);
+						else
+							float4_array_to_float2_f16c(h, f, nitems);
+						dummy += h[i % nitems];
+						break;
+					case 2:
+						label = "dot-product";
+						if (j == 0)
+							dummy += float2_array_dot_scalar(x, y, nitems);
+						else
+							dummy += float2_array_dot_f16c(x, y, nitems);
+						break;
+					default:
+						label = "l2-distance";
+						if (j == 0)
+							dummy += float2_array_l2_scalar(x, y, nitems);
+						else
+							dummy += float2_array_l2_f16c(x, y, nitems);
+						break;
+				}
+			}
+			clock_gettime(CLOCK_MONOTONIC, &tv2);
+			ms[j] = elapsed_ms(&tv1, &tv2);
+		}
+		printf("%-16s %12.2f %12.2f\n", label, ms[0], ms[1]);
+	}
+	/* prevent optimization */
+	if (dummy == 0.123456789)
+		printf("%f\n", dummy);
+	return 0;
+}
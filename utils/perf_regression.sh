@@ -0,0 +1,220 @@
+#!/bin/bash
+#
+# perf_regression.sh - performance regression test using DBT-3 and SSBM
+#
+# It loads the DBT-3 and/or SSBM dataset of the given scale factor using
+# dbgen-dbt3 / dbgen-ssbm, then runs the queries in test/sql under the
+# modes below, and writes out the elapsed time and the counters of
+# EXPLAIN ANALYZE to the CSV report.
+#
+#   gpu      ... pg_strom.enabled = on
+#   cpu      ... pg_strom.enabled = off
+#   fallback ... pg_strom.enabled = on, pg_strom.cpu_fallback = on,
+#                pg_strom.debug_force_cpu_fallback = on
+#
+# If a baseline report is given, the result is compared to the baseline
+# and the script exits with 1 if any query got slower than the threshold.
+# "make perf_baseline PERF_BASELINE=<file>" records the baseline on the
+# reference host, then "make perf_regression PERF_BASELINE=<file>" compares
+# to it. Queries not in the baseline are reported as 'new'.
+#
+# The dataset is kept in the database named <prefix>_<workload>_sf<scale>,
+# and reused on the next run unless -L is given.
+#
+UTILS_DIR=`dirname "$0"`
+QUERY_DIR="$UTILS_DIR/../test/sql"
+PSQL=${PSQL:-psql}
+SCALE=1
+NLOOPS=3
+WORKLOADS="dbt3 ssbm"
+MODES="gpu cpu fallback"
+DBPREFIX=pgstrom_perf
+REPORT=perf_report.csv
+BASELINE=
+THRESHOLD=10
+MIN_DIFF=100
+RELOAD=0
+JOBS=1
+
+usage()
+{
+    cat <<EOF
+usage: $0 [options]
+  -s SCALE      scale factor of the dataset (default: $SCALE)
+  -n NLOOPS     number of runs per query, except for warm-up (default: $NLOOPS)
+  -w WORKLOADS  workloads to run (default: "$WORKLOADS")
+  -m MODES      modes to run (default: "$MODES")
+  -q QUERIES    names of queries to run, like "dbt3-01 ssbm-11" (default: all)
+  -d PREFIX     prefix of the database name (default: $DBPREFIX)
+  -o REPORT     CSV file to write the result (default: $REPORT)
+  -b BASELINE   CSV file of the baseline to be compared
+  -t PERCENT    threshold of regression in percentage (default: $THRESHOLD)
+  -D MSEC       ignore difference less than MSEC (default: $MIN_DIFF)
+  -B DIR        directory of dbgen-* and DDL files (default: $UTILS_DIR)
+  -Q DIR        directory of the query files (default: $QUERY_DIR)
+  -j JOBS       number of dbgen worker processes (default: $JOBS)
+  -L            drop and reload the dataset
+  -h            print this message
+EOF
+    exit 1
+}
+
+while getopts "s:n:w:m:q:d:o:b:t:D:B:Q:j:Lh" opt
+do
+    case "$opt" in
+        s) SCALE="$OPTARG" ;;
+        n) NLOOPS="$OPTARG" ;;
+        w) WORKLOADS="$OPTARG" ;;
+        m) MODES="$OPTARG" ;;
+        q) QUERIES="$OPTARG" ;;
+        d) DBPREFIX="$OPTARG" ;;
+        o) REPORT="$OPTARG" ;;
+        b) BASELINE="$OPTARG" ;;
+        t) THRESHOLD="$OPTARG" ;;
+        D) MIN_DIFF="$OPTARG" ;;
+        B) UTILS_DIR="$OPTARG" ;;
+        Q) QUERY_DIR="$OPTARG" ;;
+        j) JOBS="$OPTARG" ;;
+        L) RELOAD=1 ;;
+        *) usage ;;
+    esac
+done
+
+if [ -n "$BASELINE" -a ! -r "$BASELINE" ]; then
+    echo "baseline report \"$BASELINE\" is not readable" >&2
+    exit 1
+fi
+
+run_sql()
+{
+    local db="$1"
+    shift
+    $PSQL -X -q -v ON_ERROR_STOP=1 -d "$db" "$@" || exit 1
+}
+
+#
+# load_dbt3 / load_ssbm - load the dataset using dbgen
+#
+load_dbt3()
+{
+    local db="$1"
+    local dbgen="$UTILS_DIR/dbgen-dbt3"
+
+    run_sql "$db" -f "$UTILS_DIR/dbt3-ddl.sql"
+    for x in c:customer L:lineitem n:nation O:orders \
+             P:part S:partsupp s:supplier r:region
+    do
+        echo "loading ${x#*:} ..."
+        run_sql "$db" -c "\\copy ${x#*:} FROM PROGRAM '$dbgen -s $SCALE -j $JOBS -T ${x%%:*}' DELIMITER '|'"
+    done
+    run_sql "$db" <<EOF
+CREATE INDEX lineitem_shipdate_brin ON lineitem USING brin (l_shipdate);
+CREATE INDEX orders_orderdate_brin ON orders USING brin (o_orderdate);
+EOF
+}
+
+load_ssbm()
+{
+    local db="$1"
+    local dbgen="$UTILS_DIR/dbgen-ssbm"
+
+    run_sql "$db" -f "$UTILS_DIR/ssbm-ddl.sql"
+    for x in c:customer d:date1 l:lineorder p:part s:supplier
+    do
+        echo "loading ${x#*:} ..."
+        run_sql "$db" -c "\\copy ${x#*:} FROM PROGRAM '$dbgen -s $SCALE -j $JOBS -X -T ${x%%:*}' DELIMITER '|'"
+    done
+    run_sql "$db" <<EOF
+CREATE INDEX lineorder_orderdate_brin ON lineorder USING brin (lo_orderdate);
+EOF
+}
+
+#
+# query_text - query to run; comments and EXPLAIN are removed, and the
+# parameters left in the DBT-3 queries are replaced by the values for
+# validation.
+#
+query_text()
+{
+    sed -e '/^[[:space:]]*--/d' \
+        -e '/^[[:space:]]*explain[[:space:]]*$/Id' \
+        -e "s/':1 days'/'90 days'/" \
+        -e "s/':3'/'CANADA'/" "$1"
+}
+
+rm -f "$REPORT"
+EXIT_CODE=0
+for wl in $WORKLOADS
+do
+    case "$wl" in
+        dbt3|ssbm) ;;
+        *) echo "unknown workload \"$wl\"" >&2; exit 1 ;;
+    esac
+    db="${DBPREFIX}_${wl}_sf`echo $SCALE | tr . _`"
+
+    #
+    # Setup the dataset, if not loaded yet
+    #
+    LOADED=`$PSQL -X -At -d postgres \
+            -c "SELECT 1 FROM pg_database WHERE datname = '$db'"`
+    if [ "$LOADED" = "1" -a "$RELOAD" = "0" ]; then
+        LOADED=`$PSQL -X -At -d "$db" \
+                -c "SELECT 1 FROM pg_tables WHERE tablename = 'pgstrom_perf_loaded'"`
+    fi
+    if [ "$LOADED" != "1" -o "$RELOAD" != "0" ]; then
+        echo "setting up $db (scale factor: $SCALE)"
+        run_sql postgres -c "DROP DATABASE IF EXISTS $db"
+        run_sql postgres -c "CREATE DATABASE $db"
+        run_sql "$db" -c "CREATE EXTENSION pg_strom"
+        load_$wl "$db"
+        run_sql "$db" -c "VACUUM ANALYZE"
+        run_sql "$db" -c "CREATE TABLE pgstrom_perf_loaded AS SELECT $SCALE scale"
+    fi
+    run_sql "$db" -f "$UTILS_DIR/perf_regression.sql"
+
+    #
+    # Run the queries
+    #
+    for qfile in "$QUERY_DIR"/$wl-*.sql
+    do
+        qname=`basename "$qfile" .sql`
+        if [ -n "$QUERIES" ] && ! echo " $QUERIES " | grep -q " $qname "; then
+            continue
+        fi
+        qtext=`query_text "$qfile"`
+        for mode in $MODES
+        do
+            run_sql "$db" -v wl="$wl" -v qname="$qname" -v mode="$mode" \
+                          -v qtext="$qtext" -v nloops="$NLOOPS" <<'EOF'
+SELECT pgstrom_perf.run(:'wl', :'qname', :'mode', :'qtext', :nloops);
+EOF
+            $PSQL -X -At -F ' ' -d "$db" -c "
+SELECT query, mode, round(median_ms::numeric, 2) || 'ms',
+       CASE WHEN ok THEN '' ELSE '(error)' END
+  FROM pgstrom_perf.summary
+ WHERE query = '$qname' AND mode = '$mode'"
+        done
+    done
+
+    #
+    # Write out the report, and compare to the baseline
+    #
+    if [ -s "$REPORT" ]; then
+        HEADER=
+    else
+        HEADER=HEADER
+    fi
+    run_sql "$db" -c "\\copy (SELECT * FROM pgstrom_perf.results ORDER BY workload, query, mode, loop) TO STDOUT CSV $HEADER" >> "$REPORT"
+    if [ -n "$BASELINE" ]; then
+        run_sql "$db" -c "\\copy pgstrom_perf.baseline FROM '$BASELINE' CSV HEADER"
+        run_sql "$db" -P footer=off \
+                -c "SELECT * FROM pgstrom_perf.compare($THRESHOLD, $MIN_DIFF)"
+        NBAD=`$PSQL -X -At -d "$db" -c "SELECT count(*) FROM pgstrom_perf.compare($THRESHOLD, $MIN_DIFF) WHERE verdict IN ('slower','fallback','error')"`
+        if [ "$NBAD" != "0" ]; then
+            echo "$wl: $NBAD queries regressed towards $BASELINE"
+            EXIT_CODE=1
+        fi
+    fi
+done
+echo "report: $REPORT"
+exit $EXIT_CODE
@@ -0,0 +1,176 @@
+--
+-- Support routines of the performance regression test
+-- (utils/perf_regression.sh)
+--
+SET client_min_messages = warning;
+DROP SCHEMA IF EXISTS pgstrom_perf CASCADE;
+RESET client_min_messages;
+CREATE SCHEMA pgstrom_perf;
+
+--
+-- results / baseline - one row per execution of the query.
+-- loop = 0 is the warm-up run; it is not used for the summary.
+--
+CREATE TABLE pgstrom_perf.results (
+    workload        text,
+    query           text,
+    mode            text,       -- one of 'gpu', 'cpu' or 'fallback'
+    loop            int,
+    elapsed_ms      float8,     -- wall clock time including planning
+    planning_ms     float8,
+    execution_ms    float8,
+    nrows           bigint,
+    cpu_fallbacks   bigint,
+    brin_skipped    bigint,
+    brin_fetched    bigint,
+    chunks          bigint,
+    nvme_blocks     bigint,
+    status          text        -- 'ok' or error message
+);
+CREATE TABLE pgstrom_perf.baseline (LIKE pgstrom_perf.results);
+
+--
+-- plan_counter - sum of the numeric property in the JSON plan
+--
+CREATE FUNCTION pgstrom_perf.plan_counter(plan jsonb, key text)
+RETURNS bigint
+AS $$
+  WITH RECURSIVE nodes(v) AS (
+    SELECT plan
+    UNION ALL
+    SELECT c
+      FROM nodes,
+           LATERAL (SELECT value
+                      FROM jsonb_each(CASE WHEN jsonb_typeof(v) = 'object'
+                                           THEN v ELSE '{}' END)
+                    UNION ALL
+                    SELECT value
+                      FROM jsonb_array_elements(CASE WHEN jsonb_typeof(v) = 'array'
+                                                     THEN v ELSE '[]' END)) x(c)
+     WHERE jsonb_typeof(c) IN ('object', 'array')
+  )
+  SELECT coalesce(sum((v->>key)::numeric), 0)::bigint
+    FROM nodes
+   WHERE jsonb_typeof(v) = 'object'
+     AND jsonb_typeof(v->key) = 'number';
+$$ LANGUAGE sql IMMUTABLE STRICT;
+
+--
+-- run - runs the query (nloops + 1) times under the given mode
+--
+-- qtext may contain multiple statements separated by semicolons, like
+-- CREATE VIEW of the DBT-3 Q15. SELECT statement is run with EXPLAIN
+-- ANALYZE, and the others are executed as is.
+--
+CREATE FUNCTION pgstrom_perf.run(workload text, query text, mode text,
+                                 qtext text, nloops int)
+RETURNS void
+AS $$
+DECLARE
+    plan    jsonb;
+    stmt    text;
+    t0      timestamptz;
+    status  text;
+BEGIN
+    IF mode NOT IN ('gpu', 'cpu', 'fallback') THEN
+        RAISE EXCEPTION 'unknown mode "%"', mode;
+    END IF;
+    PERFORM set_config('pg_strom.enabled',
+                       CASE WHEN mode = 'cpu' THEN 'off' ELSE 'on' END, true);
+    PERFORM set_config('pg_strom.cpu_fallback',
+                       CASE WHEN mode = 'fallback' THEN 'on' ELSE 'off' END, true);
+    PERFORM set_config('pg_strom.debug_force_cpu_fallback',
+                       CASE WHEN mode = 'fallback' THEN 'on' ELSE 'off' END, true);
+    FOR i IN 0 .. nloops LOOP
+        t0 := clock_timestamp();
+        BEGIN
+            FOREACH stmt IN ARRAY regexp_split_to_array(qtext, ';\s*(\n|$)')
+            LOOP
+                CONTINUE WHEN stmt ~ '^\s*$';
+                IF stmt ~* '^\s*(select|with)\M' THEN
+                    EXECUTE 'EXPLAIN (ANALYZE, FORMAT JSON) ' || stmt INTO plan;
+                ELSE
+                    EXECUTE stmt;
+                END IF;
+            END LOOP;
+            status := 'ok';
+        EXCEPTION WHEN OTHERS THEN
+            plan := NULL;
+            status := SQLERRM;
+        END;
+        INSERT INTO pgstrom_perf.results
+            VALUES (workload, query, mode, i,
+                    1000.0 * extract(epoch FROM clock_timestamp() - t0),
+                    (plan->0->>'Planning Time')::float8,
+                    (plan->0->>'Execution Time')::float8,
+                    (plan->0->'Plan'->>'Actual Rows')::bigint,
+                    pgstrom_perf.plan_counter(plan, 'CPU fallbacks'),
+                    pgstrom_perf.plan_counter(plan, 'BRIN skipped'),
+                    pgstrom_perf.plan_counter(plan, 'BRIN fetched'),
+                    pgstrom_perf.plan_counter(plan, 'Processed chunks'),
+                    pgstrom_perf.plan_counter(plan, 'NVMe-Strom Load Blocks'),
+                    status);
+    END LOOP;
+END;
+$$ LANGUAGE plpgsql;
+
+--
+-- summary - median of the execution time, and counters
+--
+CREATE VIEW pgstrom_perf.summary AS
+SELECT workload, query, mode,
+       count(*)                 nloops,
+       percentile_cont(0.5) WITHIN GROUP (ORDER BY elapsed_ms) median_ms,
+       min(elapsed_ms)          min_ms,
+       max(cpu_fallbacks)       cpu_fallbacks,
+       max(brin_skipped)        brin_skipped,
+       max(chunks)              chunks,
+       bool_and(status = 'ok')  ok
+  FROM pgstrom_perf.results
+ WHERE loop > 0
+ GROUP BY workload, query, mode;
+
+CREATE VIEW pgstrom_perf.baseline_summary AS
+SELECT workload, query, mode,
+       count(*)                 nloops,
+       percentile_cont(0.5) WITHIN GROUP (ORDER BY elapsed_ms) median_ms,
+       min(elapsed_ms)          min_ms,
+       max(cpu_fallbacks)       cpu_fallbacks,
+       max(brin_skipped)        brin_skipped,
+       max(chunks)              chunks,
+       bool_and(status = 'ok')  ok
+  FROM pgstrom_perf.baseline
+ WHERE loop > 0
+ GROUP BY workload, query, mode;
+
+--
+-- compare - checks the results towards the baseline
+--
+-- A query is 'slower' if its median time is longer than the baseline by
+-- more than threshold_pct percent and min_diff_ms milliseconds. GPU runs
+-- which newly fell back to CPU, or which got errors, are also reported.
+--
+CREATE FUNCTION pgstrom_perf.compare(threshold_pct float8, min_diff_ms float8)
+RETURNS TABLE (workload text, query text, mode text,
+               base_ms numeric, curr_ms numeric, ratio numeric,
+               verdict text)
+AS $$
+  SELECT c.workload, c.query, c.mode,
+         round(b.median_ms::numeric, 2),
+         round(c.median_ms::numeric, 2),
+         round((c.median_ms / nullif(b.median_ms, 0))::numeric, 3),
+         CASE WHEN NOT c.ok THEN 'error'
+              WHEN b.workload IS NULL THEN 'new'
+              WHEN c.mode <> 'fallback' AND
+                   c.cpu_fallbacks > coalesce(b.cpu_fallbacks, 0) THEN 'fallback'
+              WHEN c.median_ms > b.median_ms * (1.0 + threshold_pct / 100.0) AND
+                   c.median_ms - b.median_ms > min_diff_ms THEN 'slower'
+              WHEN b.median_ms > c.median_ms * (1.0 + threshold_pct / 100.0) AND
+                   b.median_ms - c.median_ms > min_diff_ms THEN 'faster'
+              ELSE 'ok'
+         END
+    FROM pgstrom_perf.summary c
+         LEFT JOIN pgstrom_perf.baseline_summary b
+                ON (c.workload, c.query, c.mode) = (b.workload, b.query, b.mode)
+   ORDER BY c.workload, c.query, c.mode;
+$$ LANGUAGE sql;
@@ -0,0 +1,292 @@
+/*
+ * saop_bench.c
+ *
+ * CPU benchmark to compare the strategies to evaluate ScalarArrayOpExpr
+ * with a constant array (IN-list); linear search, binary search on the
+ * sorted array, and hash-set with open-addressing. It follows the logic
+ * of PG_SCALAR_ARRAY_OP and PG_SCALAR_ARRAY_HASHED in cuda_varlena.h, to
+ * determine the threshold of pg_strom.scalar_array_op_hashed_threshold.
+ * The binary search is kept for comparison only; it is slower than the
+ * hash-set at any length, so the device code does not use it.
+ * ----
+ * Copyright 2011-2018 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2018 (C) The PG-Strom Development Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+static const char  *cmdname;
+
+static void usage(void)
+{
+	fprintf(stderr,
+			"usage: %s [options...]\n"
+			"  options:\n"
+			"    -n <nrows>    : number of rows to be evaluated (default: 10000000)\n"
+			"    -l <length>   : length of the IN-list; multiple times (default: 4..65536)\n"
+			"    -s <seed>     : seed of random values\n"
+			"    -h            : print this message and exit\n",
+			cmdname);
+	exit(1);
+}
+
+static uint32_t
+array_hashset_hash(int64_t value)
+{
+	uint64_t	k = (uint64_t) value;
+
+	/* finalizer of MurmurHash3; same as cuda_common.h */
+	k ^= k >> 33;
+	k *= 0xff51afd7ed558ccdUL;
+	k ^= k >> 33;
+	k *= 0xc4ceb9fe1a85ec53UL;
+	k ^= k >> 33;
+
+	return (uint32_t) k;
+}
+
+static int
+int64_compare(const void *__a, const void *__b)
+{
+	int64_t		a = *((const int64_t *) __a);
+	int64_t		b = *((const int64_t *) __b);
+
+	if (a < b)
+		return -1;
+	if (a > b)
+		return 1;
+	return 0;
+}
+
+static double
+elapsed_ms(struct timespec *tv1, struct timespec *tv2)
+{
+	return ((double)(tv2->tv_sec - tv1->tv_sec) * 1000.0 +
+			(double)(tv2->tv_nsec - tv1->tv_nsec) / 1000000.0);
+}
+
+static size_t
+bench_linear(const int32_t *rows, size_t nrows,
+			 const int64_t *items, int nitems)
+{
+	size_t		count = 0;
+	size_t		i;
+	int			j;
+
+	for (i=0; i < nrows; i++)
+	{
+		for (j=0; j < nitems; j++)
+		{
+			if (items[j] == rows[i])
+			{
+				count++;
+				break;
+			}
+		}
+	}
+	return count;
+}
+
+static size_t
+bench_sorted(const int32_t *rows, size_t nrows,
+			 const int64_t *items, int nitems)
+{
+	size_t		count = 0;
+	size_t		i;
+
+	for (i=0; i < nrows; i++)
+	{
+		int64_t		value = rows[i];
+		int			head = 0;
+		int			tail = nitems;
+		int			curr;
+
+		while (head < tail)
+		{
+			curr = head + (tail - head) / 2;
+			if (items[curr] < value)
+				head = curr + 1;
+			else
+				tail = curr;
+		}
+		if (head < nitems && items[head] == value)
+			count++;
+	}
+	return count;
+}
+
+static size_t
+bench_hashed(const int32_t *rows, size_t nrows,
+			 const int64_t *slots, uint32_t nslots, int64_t empty)
+{
+	size_t		count = 0;
+	uint32_t	mask = nslots - 1;
+	uint32_t	k;
+	size_t		i;
+
+	for (i=0; i < nrows; i++)
+	{
+		int64_t		value = rows[i];
+
+		for (k = array_hashset_hash(value) & mask;
+			 slots[k] != empty;
+			 k = (k + 1) & mask)
+		{
+			if (slots[k] == value)
+			{
+				count++;
+				break;
+			}
+		}
+	}
+	return count;
+}
+
+static void
+run_bench(const int32_t *rows, size_t nrows, int nitems)
+{
+	int64_t	   *items = malloc(sizeof(int64_t) * nitems);
+	int64_t	   *slots;
+	uint32_t	nslots = 8;
+	int64_t		empty = INT64_MIN;
+	struct timespec tv1, tv2, tv3, tv4;
+	size_t		c1, c2, c3;
+	uint32_t	j;
+	int			i, n;
+
+	if (!items)
+	{
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+	/* IN-list; a half of the values hit the rows */
+	for (i=0; i < nitems; i++)
+		items[i] = (random() % (2 * nitems)) * 16;
+	/* sorted array of the distinct elements */
+	qsort(items, nitems, sizeof(int64_t), int64_compare);
+	for (i=1, n=1; i < nitems; i++)
+	{
+		if (items[i] != items[n-1])
+			items[n++] = items[i];
+	}
+	/* hash-set of the distinct elements */
+	while (nslots < 2 * (uint32_t) n)
+		nslots <<= 1;
+	slots = malloc(sizeof(int64_t) * nslots);
+	if (!slots)
+	{
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+	for (i=0; i < n && items[i] == empty; i++)
+		empty++;
+	for (j=0; j < nslots; j++)
+		slots[j] = empty;
+	for (i=0; i < n; i++)
+	{
+		uint32_t	k = array_hashset_hash(items[i]) & (nslots - 1);
+
+		while (slots[k] != empty)
+			k = (k + 1) & (nslots - 1);
+		slots[k] = items[i];
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &tv1);
+	c1 = bench_linear(rows, nrows, items, n);
+	clock_gettime(CLOCK_MONOTONIC, &tv2);
+	c2 = bench_sorted(rows, nrows, items, n);
+	clock_gettime(CLOCK_MONOTONIC, &tv3);
+	c3 = bench_hashed(rows, nrows, slots, nslots, empty);
+	clock_gettime(CLOCK_MONOTONIC, &tv4);
+
+	if (c1 != c2 || c1 != c3)
+	{
+		fprintf(stderr, "results mismatch: linear=%zu sorted=%zu hashed=%zu\n",
+				c1, c2, c3);
+		exit(1);
+	}
+	printf("%8d | %8d | %10zu | %12.2f | %12.2f | %12.2f\n",
+		   nitems, n, c1,
+		   elapsed_ms(&tv1, &tv2),
+		   elapsed_ms(&tv2, &tv3),
+		   elapsed_ms(&tv3, &tv4));
+	free(slots);
+	free(items);
+}
+
+int main(int argc, char *argv[])
+{
+	size_t		nrows = 10000000;
+	int			lengths[64];
+	int			nlengths = 0;
+	unsigned int seed = 20180401;
+	int32_t	   *rows;
+	size_t		i;
+	int			c;
+
+	cmdname = argv[0];
+	while ((c = getopt(argc, argv, "n:l:s:h")) >= 0)
+	{
+		switch (c)
+		{
+			case 'n':
+				nrows = atol(optarg);
+				break;
+			case 'l':
+				if (nlengths >= 64)
+					usage();
+				lengths[nlengths++] = atoi(optarg);
+				if (lengths[nlengths-1] <= 0)
+					usage();
+				break;
+			case 's':
+				seed = atoi(optarg);
+				break;
+			default:
+				usage();
+				break;
+		}
+	}
+	if (optind != argc || nrows == 0)
+		usage();
+	if (nlengths == 0)
+	{
+		for (c=4; c <= 65536; c *= 2)
+			lengths[nlengths++] = c;
+	}
+
+	srandom(seed);
+	rows = malloc(sizeof(int32_t) * nrows);
+	if (!rows)
+	{
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	printf("  nitems | distinct |  nmatched  |  linear [ms] |  sorted [ms] |  hashed [ms]\n"
+		   "---------+----------+------------+--------------+--------------+--------------\n");
+	for (c=0; c < nlengths; c++)
+	{
+		int		nitems = lengths[c];
+
+		for (i=0; i < nrows; i++)
+			rows[i] = (random() % (4 * nitems)) * 8;
+		run_bench(rows, nrows, nitems);
+	}
+	free(rows);
+
+	return 0;
+}
@@ -10,6 +10,7 @@
 #if (defined(_POSIX_)||!defined(WIN32))		/* Change for Windows NT */
 #ifndef DOS
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/wait.h>
 #endif
 
@@ -68,11 +69,25 @@ void	gen_tbl (int tnum, long start, long count, long upd_num);
 int		pr_drange (int tbl, long min, long cnt, long num);
 int		set_files (int t, int pload);
 int		partial (int, int);
+void	skip_rows (int tnum, long count);
+int		pgen_tbl (int tnum, long start, long count);
 
 
 extern int optind, opterr;
 extern char *optarg;
+extern seed_t Seed[];
+void	NthElement (long, long *);
 long rowcnt = 0, minrow = 0, upd_num = 0;
+static long workers = 1;
+
+/*
+* number of rows per chunk of parallel generation (-j); each worker
+* generates every <workers>-th chunk
+*/
+#ifndef PGEN_CHUNK_ROWS
+#define PGEN_CHUNK_ROWS		10000
+#endif
+#define PGEN_BUFFER_SIZE	(4 << 20)
 double flt_scale;
 #if (defined(WIN32)&&!defined(_POSIX_))
 char *spawn_args[25];
@@ -546,6 +561,7 @@ usage (void)
 	fprintf (stderr, "-F     -- generate flat files output\n");
 	fprintf (stderr, "-h     -- display this message\n");
 	fprintf (stderr, "-i <n> -- split inserts between <n> files\n");
+	fprintf (stderr, "-j <n> -- generate data by <n> worker processes (requires -X)\n");
 	fprintf (stderr, "-n <s> -- inline load into database <s>\n");
 	fprintf (stderr, "-O d   -- generate SQL syntax for deletes\n");
 	fprintf (stderr, "-O f   -- over-ride default output file names\n");
@@ -692,13 +708,206 @@ pload (int tbl)
 #endif
 
 
+/*
+* void skip_rows(int tbl, long count) -- advance the RNG streams of the
+* named table as if <count> rows were generated
+*
+* Unlike set_state(), the sd_* routines are not used here, because they do
+* not follow the generators modified for SSBM. Every row consumes exactly
+* 'boundary' values of the streams owned by the table, as row_stop() does,
+* and a fixed number of values of the streams listed below, which belong to
+* other tables but are drawn by the mk_* routines. Note that P_CAT_SD and
+* the stream of gen_city() are out of range, so UnifInt() draws them from
+* the stream 0 (P_MFG_SD) instead.
+*/
+static struct
+{
+	int		table;
+	int		stream;
+	long	draws;
+} skip_extra[] =
+{
+	{PART, P_MFG_SD, 1},		/* P_CAT_SD */
+	{SUPP, P_MFG_SD, 1},		/* gen_city() */
+	{SUPP, C_PHNE_SD, 3},		/* gen_phone() of mk_supp() */
+	{CUST, P_MFG_SD, 1},		/* gen_city() */
+	{LINE, O_ODATE_SD, 1},		/* mk_order() */
+	{LINE, O_CKEY_SD, 1},
+	{LINE, O_PRIO_SD, 1},
+	{LINE, O_CLRK_SD, 1},
+	{LINE, O_LCNT_SD, 1},
+	{-1, -1, 0}
+};
+
+void
+skip_rows (int tnum, long count)
+{
+	int		i;
+
+	if (count <= 0)
+		return;
+	for (i = 0; i <= MAX_STREAM; i++)
+	{
+		if (Seed[i].table == tnum || Seed[i].table == tdefs[tnum].child)
+			NthElement (Seed[i].boundary * count, &Seed[i].value);
+	}
+	for (i = 0; skip_extra[i].table >= 0; i++)
+	{
+		if (skip_extra[i].table == tnum)
+			NthElement (skip_extra[i].draws * count,
+						&Seed[skip_extra[i].stream].value);
+	}
+}
+
+/*
+* int pgen_tbl(int tbl, long start, long count) -- generate the
+* named table by <workers> processes, and write out a single stream
+*
+* The rows are split into chunks of PGEN_CHUNK_ROWS, and the k-th chunk is
+* generated by the (k % workers)-th worker, after advancing the RNG streams
+* to the head of the chunk. So, the output is identical to the serial one.
+* Each worker writes out a chunk followed by '\0' to its own pipe, and the
+* parent process relays the chunks in order.
+*/
+typedef struct
+{
+	int		fdesc;
+	size_t	pos;
+	size_t	len;
+	char	buf[PGEN_BUFFER_SIZE];
+} pgen_worker;
+
+int
+pgen_tbl (int tnum, long start, long count)
+{
+	long nchunks = (count + PGEN_CHUNK_ROWS - 1) / PGEN_CHUNK_ROWS;
+	long k;
+	pid_t  *wpids;
+	pgen_worker *pw;
+	int		c, w, status, rv = 0;
+
+	wpids = (pid_t *) malloc (sizeof (pid_t) * workers);
+	pw = (pgen_worker *) malloc (sizeof (pgen_worker) * workers);
+	MALLOC_CHECK (wpids);
+	MALLOC_CHECK (pw);
+
+	fflush (stdout);
+	for (w = 0; w < workers; w++)
+	{
+		int		pfd[2];
+
+		if (pipe (pfd) != 0)
+		{
+			perror ("pipe");
+			exit (1);
+		}
+#ifdef F_SETPIPE_SZ
+		fcntl (pfd[1], F_SETPIPE_SZ, 1 << 20);
+#endif
+		wpids[w] = fork ();
+		if (wpids[w] < 0)
+		{
+			perror ("Worker process not created");
+			exit (1);
+		}
+		else if (wpids[w] == 0)	/* WORKER */
+		{
+			long curr = 0;
+
+			for (c = 0; c < w; c++)
+				close (pw[c].fdesc);
+			close (pfd[0]);
+			if (dup2 (pfd[1], 1) < 0)
+			{
+				perror ("dup2");
+				exit (1);
+			}
+			close (pfd[1]);
+			setvbuf (stdout, pw[w].buf, _IOFBF, PGEN_BUFFER_SIZE);
+			verbose = 0;
+			for (k = w; k < nchunks; k += workers)
+			{
+				long head = k * PGEN_CHUNK_ROWS;
+				long nrows = count - head;
+
+				if (nrows > PGEN_CHUNK_ROWS)
+					nrows = PGEN_CHUNK_ROWS;
+				skip_rows (tnum, head - curr);
+				gen_tbl (tnum, start + head, nrows, upd_num);
+				fputc ('\0', stdout);
+				fflush (stdout);
+				curr = head + nrows;
+			}
+			exit (ferror (stdout) ? 1 : 0);
+		}
+		close (pfd[1]);
+		pw[w].fdesc = pfd[0];
+		pw[w].pos = 0;
+		pw[w].len = 0;
+	}
+
+	/* relay the chunks in order */
+	for (k = 0; k < nchunks; k++)
+	{
+		pgen_worker *curr = &pw[k % workers];
+
+		for (;;)
+		{
+			char   *tail;
+			ssize_t	nbytes;
+
+			if (curr->pos < curr->len)
+			{
+				tail = memchr (curr->buf + curr->pos, '\0',
+							   curr->len - curr->pos);
+				if (tail)
+				{
+					fwrite (curr->buf + curr->pos, 1,
+							tail - (curr->buf + curr->pos), stdout);
+					curr->pos = tail - curr->buf + 1;
+					break;
+				}
+				fwrite (curr->buf + curr->pos, 1,
+						curr->len - curr->pos, stdout);
+			}
+			curr->pos = curr->len = 0;
+			nbytes = read (curr->fdesc, curr->buf, PGEN_BUFFER_SIZE);
+			if (nbytes < 0 && errno == EINTR)
+				continue;
+			if (nbytes <= 0)
+			{
+				fprintf (stderr, "worker %d terminated unexpectedly\n",
+						 (int)(k % workers));
+				exit (1);
+			}
+			curr->len = nbytes;
+		}
+	}
+	fflush (stdout);
+
+	for (w = 0; w < workers; w++)
+	{
+		close (pw[w].fdesc);
+		if (waitpid (wpids[w], &status, 0) < 0 ||
+			!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+		{
+			fprintf (stderr, "worker %d failed\n", w);
+			rv = 1;
+		}
+	}
+	free (pw);
+	free (wpids);
+
+	return (rv);
+}
+
 void
 process_options (int count, char **vector)
 {
 	int option;
 	
 	while ((option = getopt (count, vector,
-		"b:C:Dd:Ffi:hn:O:P:qr:s:S:T:XU:v")) != -1)
+		"b:C:Dd:Ffi:hj:n:O:P:qr:s:S:T:XU:v")) != -1)
 	switch (option)
 		{
 		case 'b':				/* load distributions from named file */
@@ -715,6 +924,14 @@ process_options (int count, char **vector)
 		case 'd':
 			delete_segments = atoi (optarg);
 			break;
+		case 'j':
+			workers = atoi (optarg);
+			if (workers < 1)
+				{
+				fprintf (stderr, "ERROR: -j must be 1 or larger\n");
+				exit (1);
+				}
+			break;
 	  case 'S':				/* generate a particular STEP */
 		  step = atoi (optarg);
 		  break;
@@ -897,6 +1114,11 @@ process_options (int count, char **vector)
 		if ((table & (table - 1)) != 0)
 			fprintf(stderr, "-X must be used towards single -T option\n");
 	}
+	if (workers > 1 && (!print_to_stdout || children != 1 || updates != 0))
+	{
+		fprintf(stderr, "ERROR: -j must be used with -X, and not with -C or -U\n");
+		exit(1);
+	}
 
 #ifndef DOS
 	if (children != 1 && step == -1)
@@ -1129,7 +1351,13 @@ main (int ac, char **av)
 					if (verbose > 0)
 						fprintf (stderr, "%s data for %s [pid: %u]",
 						(validate)?"Validating":"Generating", tdefs[i].comment, DSS_PROC);
-					gen_tbl (i, minrow, rowcnt, upd_num);
+					if (workers > 1 && i != DATE)
+					{
+						if (pgen_tbl (i, minrow, rowcnt) != 0)
+							exit (1);
+					}
+					else
+						gen_tbl (i, minrow, rowcnt, upd_num);
 					if (verbose > 0)
 						fprintf (stderr, "done.\n");
 				}
@@ -0,0 +1,409 @@
+/*
+ * transpose_bench.c
+ *
+ * CPU benchmark to compare the implementations of transpose() on the
+ * array-based matrix; the element-by-element loop, the cache-blocked
+ * tiles, and the tiles with SSE2 or AVX2 block transpose. It follows
+ * the logic of the matrix_transpose_* routines in matrix.c, and also
+ * checks whether all the implementations produce identical results.
+ * ----
+ * Copyright 2011-2019 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2019 (C) The PG-Strom Development Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <immintrin.h>
+
+#define Min(a,b)	((a) < (b) ? (a) : (b))
+
+static const char  *cmdname;
+
+static void usage(void)
+{
+	fprintf(stderr,
+			"usage: %s [options...]\n"
+			"  options:\n"
+			"    -r <height>   : height of the matrix (default: 4096)\n"
+			"    -c <width>    : width of the matrix (default: 4096)\n"
+			"    -l <loops>    : number of iterations (default: 10)\n"
+			"    -h            : print this message and exit\n",
+			cmdname);
+	exit(1);
+}
+
+/*
+ * element-by-element loop; transpose() before the cache-blocking
+ */
+#define MATRIX_TRANSPOSE_NAIVE_TEMPLATE(NAME,BASETYPE)					\
+	static void															\
+	transpose_naive_##NAME(BASETYPE *T, const BASETYPE *M,				\
+						   size_t height, size_t width)					\
+	{																	\
+		size_t	i, nitems = width * height;								\
+																		\
+		for (i=0; i < nitems; i++)										\
+			T[(i % height) * width + (i / height)] = M[i];				\
+	}
+MATRIX_TRANSPOSE_NAIVE_TEMPLATE(4b,uint32_t)
+MATRIX_TRANSPOSE_NAIVE_TEMPLATE(8b,uint64_t)
+
+/*
+ * cache-blocked tiles; same as matrix.c
+ */
+#define MATRIX_TRANSPOSE_TILESZ		32
+
+#define MATRIX_TRANSPOSE_SCALAR(BASETYPE,T,M,height,width,r0,r1,c0,c1)	\
+	do {																\
+		size_t	__r, __c;												\
+																		\
+		for (__r=(r0); __r < (r1); __r++)								\
+		{																\
+			BASETYPE	   *__dst = (T) + __r * (width);				\
+			const BASETYPE *__src = (M) + __r;							\
+																		\
+			for (__c=(c0); __c < (c1); __c++)							\
+				__dst[__c] = __src[__c * (height)];						\
+		}																\
+	} while(0)
+
+#define MATRIX_TRANSPOSE_TILED_TEMPLATE(NAME,BASETYPE)					\
+	static void															\
+	transpose_tiled_##NAME(BASETYPE *T, const BASETYPE *M,				\
+						   size_t height, size_t width)					\
+	{																	\
+		size_t	rb, re, cb, ce;											\
+																		\
+		for (cb=0; cb < width; cb += MATRIX_TRANSPOSE_TILESZ)			\
+		{																\
+			ce = Min(cb + MATRIX_TRANSPOSE_TILESZ, width);				\
+			for (rb=0; rb < height; rb += MATRIX_TRANSPOSE_TILESZ)		\
+			{															\
+				re = Min(rb + MATRIX_TRANSPOSE_TILESZ, height);			\
+				MATRIX_TRANSPOSE_SCALAR(BASETYPE,T,M,height,width,		\
+										rb,re,cb,ce);					\
+			}															\
+		}																\
+	}
+MATRIX_TRANSPOSE_TILED_TEMPLATE(4b,uint32_t)
+MATRIX_TRANSPOSE_TILED_TEMPLATE(8b,uint64_t)
+
+/*
+ * SSE2 block transpose in the tiles; same as matrix.c
+ */
+static void
+transpose_sse2_4b(uint32_t *T, const uint32_t *M, size_t height, size_t width)
+{
+	size_t		rb, re, r4, r;
+	size_t		cb, ce, c4, c;
+	__m128i		a0, a1, a2, a3;
+	__m128i		t0, t1, t2, t3;
+
+	for (cb=0; cb < width; cb += MATRIX_TRANSPOSE_TILESZ)
+	{
+		ce = Min(cb + MATRIX_TRANSPOSE_TILESZ, width);
+		c4 = cb + ((ce - cb) & ~3UL);
+		for (rb=0; rb < height; rb += MATRIX_TRANSPOSE_TILESZ)
+		{
+			re = Min(rb + MATRIX_TRANSPOSE_TILESZ, height);
+			r4 = rb + ((re - rb) & ~3UL);
+			for (c=cb; c < c4; c += 4)
+			{
+				for (r=rb; r < r4; r += 4)
+				{
+					a0 = _mm_loadu_si128((const __m128i *)(M + (c+0) * height + r));
+					a1 = _mm_loadu_si128((const __m128i *)(M + (c+1) * height + r));
+					a2 = _mm_loadu_si128((const __m128i *)(M + (c+2) * height + r));
+					a3 = _mm_loadu_si128((const __m128i *)(M + (c+3) * height + r));
+					t0 = _mm_unpacklo_epi32(a0, a1);
+					t1 = _mm_unpackhi_epi32(a0, a1);
+					t2 = _mm_unpacklo_epi32(a2, a3);
+					t3 = _mm_unpackhi_epi32(a2, a3);
+					_mm_storeu_si128((__m128i *)(T + (r+0) * width + c),
+									 _mm_unpacklo_epi64(t0, t2));
+					_mm_storeu_si128((__m128i *)(T + (r+1) * width + c),
+									 _mm_unpackhi_epi64(t0, t2));
+					_mm_storeu_si128((__m128i *)(T + (r+2) * width + c),
+									 _mm_unpacklo_epi64(t1, t3));
+					_mm_storeu_si128((__m128i *)(T + (r+3) * width + c),
+									 _mm_unpackhi_epi64(t1, t3));
+				}
+			}
+			MATRIX_TRANSPOSE_SCALAR(uint32_t,T,M,height,width,rb,r4,c4,ce);
+			MATRIX_TRANSPOSE_SCALAR(uint32_t,T,M,height,width,r4,re,cb,ce);
+		}
+	}
+}
+
+static void
+transpose_sse2_8b(uint64_t *T, const uint64_t *M, size_t height, size_t width)
+{
+	size_t		rb, re, r2, r;
+	size_t		cb, ce, c2, c;
+	__m128i		a0, a1;
+
+	for (cb=0; cb < width; cb += MATRIX_TRANSPOSE_TILESZ)
+	{
+		ce = Min(cb + MATRIX_TRANSPOSE_TILESZ, width);
+		c2 = cb + ((ce - cb) & ~1UL);
+		for (rb=0; rb < height; rb += MATRIX_TRANSPOSE_TILESZ)
+		{
+			re = Min(rb + MATRIX_TRANSPOSE_TILESZ, height);
+			r2 = rb + ((re - rb) & ~1UL);
+			for (c=cb; c < c2; c += 2)
+			{
+				for (r=rb; r < r2; r += 2)
+				{
+					a0 = _mm_loadu_si128((const __m128i *)(M + (c+0) * height + r));
+					a1 = _mm_loadu_si128((const __m128i *)(M + (c+1) * height + r));
+					_mm_storeu_si128((__m128i *)(T + (r+0) * width + c),
+									 _mm_unpacklo_epi64(a0, a1));
+					_mm_storeu_si128((__m128i *)(T + (r+1) * width + c),
+									 _mm_unpackhi_epi64(a0, a1));
+				}
+			}
+			MATRIX_TRANSPOSE_SCALAR(uint64_t,T,M,height,width,rb,r2,c2,ce);
+			MATRIX_TRANSPOSE_SCALAR(uint64_t,T,M,height,width,r2,re,cb,ce);
+		}
+	}
+}
+
+/*
+ * AVX2 block transpose in the tiles; 8x8 (4-bytes) or 4x4 (8-bytes)
+ */
+__attribute__((target("avx2")))
+static void
+transpose_avx2_4b(uint32_t *T, const uint32_t *M, size_t height, size_t width)
+{
+	size_t		rb, re, r8, r;
+	size_t		cb, ce, c8, c;
+	__m256		a[8], t[8];
+	int			k;
+
+	for (cb=0; cb < width; cb += MATRIX_TRANSPOSE_TILESZ)
+	{
+		ce = Min(cb + MATRIX_TRANSPOSE_TILESZ, width);
+		c8 = cb + ((ce - cb) & ~7UL);
+		for (rb=0; rb < height; rb += MATRIX_TRANSPOSE_TILESZ)
+		{
+			re = Min(rb + MATRIX_TRANSPOSE_TILESZ, height);
+			r8 = rb + ((re - rb) & ~7UL);
+			for (c=cb; c < c8; c += 8)
+			{
+				for (r=rb; r < r8; r += 8)
+				{
+					for (k=0; k < 8; k++)
+						a[k] = _mm256_loadu_ps((const float *)(M + (c+k) * height + r));
+					t[0] = _mm256_unpacklo_ps(a[0], a[1]);
+					t[1] = _mm256_unpackhi_ps(a[0], a[1]);
+					t[2] = _mm256_unpacklo_ps(a[2], a[3]);
+					t[3] = _mm256_unpackhi_ps(a[2], a[3]);
+					t[4] = _mm256_unpacklo_ps(a[4], a[5]);
+					t[5] = _mm256_unpackhi_ps(a[4], a[5]);
+					t[6] = _mm256_unpacklo_ps(a[6], a[7]);
+					t[7] = _mm256_unpackhi_ps(a[6], a[7]);
+					a[0] = _mm256_shuffle_ps(t[0], t[2], 0x44);
+					a[1] = _mm256_shuffle_ps(t[0], t[2], 0xee);
+					a[2] = _mm256_shuffle_ps(t[1], t[3], 0x44);
+					a[3] = _mm256_shuffle_ps(t[1], t[3], 0xee);
+					a[4] = _mm256_shuffle_ps(t[4], t[6], 0x44);
+					a[5] = _mm256_shuffle_ps(t[4], t[6], 0xee);
+					a[6] = _mm256_shuffle_ps(t[5], t[7], 0x44);
+					a[7] = _mm256_shuffle_ps(t[5], t[7], 0xee);
+					for (k=0; k < 4; k++)
+					{
+						_mm256_storeu_ps((float *)(T + (r+k) * width + c),
+										 _mm256_permute2f128_ps(a[k], a[k+4], 0x20));
+						_mm256_storeu_ps((float *)(T + (r+k+4) * width + c),
+										 _mm256_permute2f128_ps(a[k], a[k+4], 0x31));
+					}
+				}
+			}
+			MATRIX_TRANSPOSE_SCALAR(uint32_t,T,M,height,width,rb,r8,c8,ce);
+			MATRIX_TRANSPOSE_SCALAR(uint32_t,T,M,height,width,r8,re,cb,ce);
+		}
+	}
+}
+
+__attribute__((target("avx2")))
+static void
+transpose_avx2_8b(uint64_t *T, const uint64_t *M, size_t height, size_t width)
+{
+	size_t		rb, re, r4, r;
+	size_t		cb, ce, c4, c;
+	__m256d		a0, a1, a2, a3;
+	__m256d		t0, t1, t2, t3;
+
+	for (cb=0; cb < width; cb += MATRIX_TRANSPOSE_TILESZ)
+	{
+		ce = Min(cb + MATRIX_TRANSPOSE_TILESZ, width);
+		c4 = cb + ((ce - cb) & ~3UL);
+		for (rb=0; rb < height; rb += MATRIX_TRANSPOSE_TILESZ)
+		{
+			re = Min(rb + MATRIX_TRANSPOSE_TILESZ, height);
+			r4 = rb + ((re - rb) & ~3UL);
+			for (c=cb; c < c4; c += 4)
+			{
+				for (r=rb; r < r4; r += 4)
+				{
+					a0 = _mm256_loadu_pd((const double *)(M + (c+0) * height + r));
+					a1 = _mm256_loadu_pd((const double *)(M + (c+1) * height + r));
+					a2 = _mm256_loadu_pd((const double *)(M + (c+2) * height + r));
+					a3 = _mm256_loadu_pd((const double *)(M + (c+3) * height + r));
+					t0 = _mm256_unpacklo_pd(a0, a1);
+					t1 = _mm256_unpackhi_pd(a0, a1);
+					t2 = _mm256_unpacklo_pd(a2, a3);
+					t3 = _mm256_unpackhi_pd(a2, a3);
+					_mm256_storeu_pd((double *)(T + (r+0) * width + c),
+									 _mm256_permute2f128_pd(t0, t2, 0x20));
+					_mm256_storeu_pd((double *)(T + (r+1) * width + c),
+									 _mm256_permute2f128_pd(t1, t3, 0x20));
+					_mm256_storeu_pd((double *)(T + (r+2) * width + c),
+									 _mm256_permute2f128_pd(t0, t2, 0x31));
+					_mm256_storeu_pd((double *)(T + (r+3) * width + c),
+									 _mm256_permute2f128_pd(t1, t3, 0x31));
+				}
+			}
+			MATRIX_TRANSPOSE_SCALAR(uint64_t,T,M,height,width,rb,r4,c4,ce);
+			MATRIX_TRANSPOSE_SCALAR(uint64_t,T,M,height,width,r4,re,cb,ce);
+		}
+	}
+}
+
+static double
+elapsed_ms(struct timespec *tv1, struct timespec *tv2)
+{
+	return ((double)(tv2->tv_sec - tv1->tv_sec) * 1000.0 +
+			(double)(tv2->tv_nsec - tv1->tv_nsec) / 1000000.0);
+}
+
+#define NUM_KERNELS		4
+static const char *kernel_labels[NUM_KERNELS] = {
+	"naive", "tiled", "sse2", "avx2"
+};
+
+static void
+run_transpose(int unitsz, int k, void *T, const void *M,
+			  size_t height, size_t width)
+{
+	if (unitsz == sizeof(uint32_t))
+	{
+		switch (k)
+		{
+			case 0: transpose_naive_4b(T, M, height, width); break;
+			case 1: transpose_tiled_4b(T, M, height, width); break;
+			case 2: transpose_sse2_4b(T, M, height, width); break;
+			default: transpose_avx2_4b(T, M, height, width); break;
+		}
+	}
+	else
+	{
+		switch (k)
+		{
+			case 0: transpose_naive_8b(T, M, height, width); break;
+			case 1: transpose_tiled_8b(T, M, height, width); break;
+			case 2: transpose_sse2_8b(T, M, height, width); break;
+			default: transpose_avx2_8b(T, M, height, width); break;
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	size_t		height = 4096;
+	size_t		width = 4096;
+	int			nloops = 10;
+	int			nkernels = NUM_KERNELS;
+	int			unitsz;
+	char	   *M, *T[NUM_KERNELS];
+	struct timespec tv1, tv2;
+	size_t		i, length;
+	int			c, j, k;
+
+	cmdname = argv[0];
+	while ((c = getopt(argc, argv, "r:c:l:h")) >= 0)
+	{
+		switch (c)
+		{
+			case 'r':
+				height = atol(optarg);
+				break;
+			case 'c':
+				width = atol(optarg);
+				break;
+			case 'l':
+				nloops = atoi(optarg);
+				break;
+			default:
+				usage();
+				break;
+		}
+	}
+	if (height < 1 || width < 1 || nloops < 1)
+		usage();
+	if (!__builtin_cpu_supports("avx2"))
+	{
+		fprintf(stderr, "this CPU does not support AVX2, skip avx2 kernel\n");
+		nkernels--;
+	}
+
+	printf("height=%zu width=%zu nloops=%d\n", height, width, nloops);
+	printf("%-8s", "unitsz");
+	for (k=0; k < nkernels; k++)
+		printf(" %10s[ms]", kernel_labels[k]);
+	putchar('\n');
+	for (unitsz = sizeof(uint32_t); unitsz <= sizeof(uint64_t); unitsz *= 2)
+	{
+		length = unitsz * height * width;
+		M = malloc(length);
+		for (k=0; k < nkernels; k++)
+			T[k] = malloc(length);
+		if (!M || !T[0] || !T[1] || !T[2] || !T[nkernels-1])
+		{
+			fprintf(stderr, "out of memory\n");
+			return 1;
+		}
+		for (i=0; i < length; i++)
+			M[i] = (char)(i * 7 + (i >> 8));
+		/* page faults on the destination are not a part of the kernel */
+		for (k=0; k < nkernels; k++)
+			memset(T[k], 0, length);
+
+		printf("%-8d", unitsz);
+		for (k=0; k < nkernels; k++)
+		{
+			clock_gettime(CLOCK_MONOTONIC, &tv1);
+			for (j=0; j < nloops; j++)
+				run_transpose(unitsz, k, T[k], M, height, width);
+			clock_gettime(CLOCK_MONOTONIC, &tv2);
+			printf(" %14.2f", elapsed_ms(&tv1, &tv2) / (double)nloops);
+		}
+		putchar('\n');
+		/* all the kernels must produce identical results */
+		for (k=1; k < nkernels; k++)
+		{
+			if (memcmp(T[0], T[k], length) != 0)
+			{
+				fprintf(stderr, "%s kernel mismatch (unitsz=%d)\n",
+						kernel_labels[k], unitsz);
+				return 1;
+			}
+		}
+		free(M);
+		for (k=0; k < nkernels; k++)
+			free(T[k]);
+	}
+	return 0;
+}